@@ -0,0 +1,30 @@
+/*
+ * crc.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+/* Exported macro constants --------------------------------------------------*/
+#define CRC16_CCITT_INIT	0xFFFFU
+#define CRC8_INIT			0x00U		// poly 0x07 (KISS esc telemetry)
+
+/* Exported functions prototypes ---------------------------------------------*/
+uint16_t crc16_ccitt_update(uint16_t crc, const uint8_t *data, size_t len);
+
+uint8_t crc8_update(uint8_t crc, const uint8_t *data, size_t len);
+
+/* Exported static inline functions ------------------------------------------*/
+static inline uint16_t crc16_ccitt(const uint8_t *data, size_t len) {
+	return crc16_ccitt_update(CRC16_CCITT_INIT, data, len);
+}
+
+static inline uint8_t crc8(const uint8_t *data, size_t len) {
+	return crc8_update(CRC8_INIT, data, len);
+}
@@ -0,0 +1,61 @@
+/*
+ * cycles.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+#ifndef SITL
+#include "stm32f4xx_hal.h"
+#else
+#include <time.h>
+#endif
+
+/*
+ * CPU Cycle Counter (DWT CYCCNT, 32 bit, wraps every ~25 s at 168 MHz)
+ *
+ * Differences of two readings are wrap-safe as long as the measured span is
+ * shorter than one wrap. Host builds (SITL) count nanoseconds of the monotonic
+ * clock instead; cycles_hz() gives the rate either way.
+ */
+
+/* Exported static inline functions ------------------------------------------*/
+/**
+  * @brief enables the cycle counter (idempotent)
+  */
+static inline void cycles_init(void) {
+#ifndef SITL
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0U;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/**
+  * @brief current cycle count
+  */
+static inline uint32_t cycles_now(void) {
+#ifndef SITL
+	return DWT->CYCCNT;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t) ((uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec);
+#endif
+}
+
+/**
+  * @brief cycle counter rate (hz)
+  */
+static inline uint32_t cycles_hz(void) {
+#ifndef SITL
+	return SystemCoreClock;
+#else
+	return 1000000000U;
+#endif
+}
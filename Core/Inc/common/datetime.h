@@ -0,0 +1,45 @@
+/*
+ * datetime.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Calendar conversions (UTC, proleptic Gregorian, no leap seconds) between
+ * unix time, broken-down date/time and the FAT timestamp format. Pure integer
+ * code, shared by the rtc driver and host tools.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define DATETIME_UNIX_2000		946684800U		// 2000-01-01 00:00:00
+#define DATETIME_UNIX_2100		4102444800U		// 2100-01-01 00:00:00
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Date / Time Type
+  */
+typedef struct {
+	uint16_t year;			// 1970..2106
+	uint8_t month;			// 1..12
+	uint8_t day;			// 1..31
+	uint8_t hour;			// 0..23
+	uint8_t minute;			// 0..59
+	uint8_t second;			// 0..59
+	uint8_t weekday;		// 1..7, monday first (rtc convention)
+} datetime_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void datetime_from_unix(uint32_t unix_s, datetime_t *out);
+
+uint32_t datetime_to_unix(const datetime_t *dt);
+
+bool datetime_is_valid(const datetime_t *dt);
+
+uint32_t datetime_to_fattime(const datetime_t *dt);
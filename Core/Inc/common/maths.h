@@ -9,6 +9,7 @@
 
 /* Includes ---------------------------------------------------------------------*/
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /* Exported macro constants -----------------------------------------------------*/
@@ -74,7 +75,7 @@ static inline float constrainf(float val, float min, float max) {
 	}
 }
 
-static inline float constrain_u32(uint32_t val, uint32_t min, uint32_t max) {
+static inline uint32_t constrain_u32(uint32_t val, uint32_t min, uint32_t max) {
 	if (val < min) {
         return min;
 	} else if (val > max) {
@@ -0,0 +1,42 @@
+/*
+ * memory.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include "common/settings.h"
+
+/*
+ * Memory Placement (see STM32F405RGTX_FLASH.ld)
+ *
+ *   CCM_DATA	initialized data in CCM RAM (.ccmram, copied at startup)
+ *   CCM_BSS	zeroed data in CCM RAM (.ccmbss, zeroed at startup)
+ *   RAM_FUNC	code copied to SRAM at startup (.RamFunc, part of .data)
+ *
+ * CCM RAM has no wait states and sits on the CPU D-bus only, so it never
+ * contends with DMA, but DMA cannot reach it and code cannot run from it.
+ * Never place DMA buffers (SDIO, USB, I2C/SPI transfers) or anything a DMA
+ * descriptor points at in CCM.
+ *
+ * SRAM code avoids flash wait states (LATENCY_5 at 168 MHz) and ART misses.
+ * Calls between flash and SRAM are out of BL range and go through linker
+ * veneers, so only place leaf kernels that run every loop.
+ *
+ * Host builds (SITL) and CONFIG_FAST_MEMORY == DISABLED leave placement to
+ * the default sections (before/after loop cycle comparison).
+ */
+
+/* Exported macros -----------------------------------------------------------*/
+#if (CONFIG_FAST_MEMORY == ENABLED) && !defined(SITL)
+#define CCM_DATA			__attribute__((section(".ccmram")))
+#define CCM_BSS				__attribute__((section(".ccmbss")))
+#define RAM_FUNC			__attribute__((section(".RamFunc"), noinline))
+#else
+#define CCM_DATA
+#define CCM_BSS
+#define RAM_FUNC
+#endif
@@ -19,9 +19,48 @@
 -----------------------------------------------------------------------------------*/
 #define CONFIG_DEVICE_BOOT_TIME_MS					20U
 
+// HEALTH---------------------------------------------------------------------
+#define CONFIG_HEALTH_REPORT_USB					ENABLED
+#define CONFIG_HEALTH_REPORT_INTERVAL_MS			1000U
+#define CONFIG_HEALTH_PERSIST_SD					ENABLED
+
+// MEMORY---------------------------------------------------------------------
+#define CONFIG_FAST_MEMORY							ENABLED	// hot state in CCM, kernels in SRAM (common/memory.h)
+
+// INTERRUPTS-----------------------------------------------------------------
+#define CONFIG_IRQ_LATENCY_TEST						DISABLED	// timestamp isr entry vs event (MSG_IRQ_LATENCY, system/irq.h)
+#define CONFIG_IRQ_LATENCY_INJECT_INTERVAL_MS		10U		// software-triggered exti events (latency test only)
+
+// BENCHMARKS-----------------------------------------------------------------
+#define CONFIG_BENCH								DISABLED	// time flight kernels at boot (MSG_BENCH_GET, system/bench.h)
+
+// CLOCK----------------------------------------------------------------------
+#define CONFIG_RTC_LSE								DISABLED	// 32.768 kHz crystal fitted (else rtc runs on LSI, system/rtc.h)
+#define CONFIG_RTC_LSE_STARTUP_MS					2000U	// crystal start-up limit before falling back to LSI
+
+// LOGGING--------------------------------------------------------------------
+#define CONFIG_LOG_FILE								ENABLED	// flight log on the sd card while armed (storage/log_file.h)
+#define CONFIG_LOG_FILE_PREALLOC_MB					256U	// contiguous run reserved at arm time
+#define CONFIG_BLACKBOX_KEYFRAME_INTERVAL			32U		// frames per keyframe (resync after a dropped frame)
+#define CONFIG_MSC_READ_ONLY						DISABLED	// host may not write the card in usb mass storage mode (comms/usb_msc.h)
+
+// TELEMETRY------------------------------------------------------------------
+#define CONFIG_TELEMETRY_RATE_MAX_HZ				500U
+#define CONFIG_TELEMETRY_BATCH_MS					20U		// max age of a sample waiting for its batch to fill (comms/telemetry.h)
+
+// PARAMETERS-----------------------------------------------------------------
+#define STM32_FLASH_PARAM_STORAGE_ID				0U
+#define RAM_PARAM_STORAGE_ID						1U	// host simulator only
+#define CONFIG_PARAM_STORAGE						STM32_FLASH_PARAM_STORAGE_ID
+
 /* FLIGHT CONFIG SETTINGS----------------------------------------------------------
 |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
 -----------------------------------------------------------------------------------*/
+/*
+ * NOTE: tunables below (gains, limits, ESC/RC ranges) are only the defaults of
+ * the runtime parameter registry (params/params.c); persisted values override
+ * them at boot and can be changed over the USB link without reflashing.
+ */
 // RC INPUT-------------------------------------------------------------------
 #define CONFIG_ROLL_MAX_DEG	 	 					10.0f
 #define CONFIG_ROLL_MIN_DEG							-CONFIG_ROLL_MAX_DEG
@@ -39,6 +78,8 @@
 
 #define CONFIG_THROTTLE_IDLE_TOLERANCE_PCT			2.0f
 
+#define CONFIG_RC_MODE_SWITCH_HIGH					2U			// mode on the high switch position (2 rate, 3 alt hold)
+
 // ATTITUDE-------------------------------------------------------------------
 #define COMP_FILT_ID								0U
 #define CONFIG_ATTITUDE_FILT						COMP_FILT_ID
@@ -84,6 +125,39 @@
 #define CONFIG_YAW_RATE_CMD_LIM_PCT					5.0f
 #define CONFIG_YAW_RATE_I_CMD_LIM_PCT				CONFIG_YAW_RATE_CMD_LIM_PCT * 0.3
 
+// ALTITUDE-------------------------------------------------------------------
+#define CONFIG_ALT_FILT_TAU_S						2.0f		// baro / accel crossover time constant
+#define CONFIG_ALT_BARO_ZERO_SAMPLES				25U			// baro samples averaged into the ground reference
+
+#define CONFIG_ALT_HOLD_RATE_HZ						50U			// altitude / climb rate cascade (decimated flight loop)
+#define CONFIG_ALT_HOLD_STICK_DEADBAND_PCT			5.0f		// either side of center: throttle stick holds altitude
+#define CONFIG_ALT_HOLD_EXIT_BLEND_S				0.5f		// throttle blends back to the stick on leaving alt hold
+#define CONFIG_ALT_CLIMB_MAX_MPS					1.5f		// climb / descent rate at full stick
+#define CONFIG_ALT_CLIMB_ACCEL_MPS2					3.0f		// climb rate request slew (no throttle steps on stick moves)
+#define CONFIG_ALT_HOVER_THROTTLE_PCT				40.0f		// until learned in flight
+#define CONFIG_ALT_HOVER_LEARN_TAU_S				2.0f
+
+#define CONFIG_ALT_POS_P_GAIN						1.0f
+#define CONFIG_ALT_POS_I_GAIN						0.0f
+#define CONFIG_ALT_POS_D_GAIN						0.0f
+#define CONFIG_ALT_POS_D_LPF_CUTOFF_FREQ_HZ			5.0f
+#define CONFIG_ALT_POS_CMD_LIM_MPS					CONFIG_ALT_CLIMB_MAX_MPS
+#define CONFIG_ALT_POS_I_CMD_LIM_MPS				CONFIG_ALT_POS_CMD_LIM_MPS * 0.3
+
+#define CONFIG_ALT_VEL_P_GAIN						8.0f
+#define CONFIG_ALT_VEL_I_GAIN						4.0f
+#define CONFIG_ALT_VEL_D_GAIN						0.0f
+#define CONFIG_ALT_VEL_D_LPF_CUTOFF_FREQ_HZ			5.0f
+#define CONFIG_ALT_VEL_CMD_LIM_PCT					30.0f		// throttle around hover
+#define CONFIG_ALT_VEL_I_CMD_LIM_PCT				CONFIG_ALT_VEL_CMD_LIM_PCT * 0.3
+
+// POSITION-------------------------------------------------------------------
+#define CONFIG_POS_FILT_TAU_S						1.0f		// gps / accel crossover time constant
+#define CONFIG_POS_GPS_MIN_SATS						6U			// solutions with fewer satellites are not fused
+#define CONFIG_POS_GPS_MAX_HACC_M					5.0f		// ..nor less accurate ones
+#define CONFIG_POS_GPS_TIMEOUT_MS					500U		// estimate invalid without a fused solution
+#define CONFIG_POS_HEADING_ALIGN_DV_MPS				1.0f		// velocity change gps and imu must both see to align heading
+
 // MIXER----------------------------------------------------------------------
 #define CONFIG_THRUST_COMP							ENABLED
 
@@ -91,18 +165,98 @@
 |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
 -----------------------------------------------------------------------------------*/
 // IMU------------------------------------------------------------------------
-#define LSM6DSOX_DEVICE_ID							0U
-#define CONFIG_IMU_DEVICE							LSM6DSOX_DEVICE_ID
-
+// device bound at boot by WHO_AM_I (system/driver_registry.h)
 #define IMU_I2C_PROTOCOL_ID							0U
 #define CONFIG_IMU_COMM_PROTOCOL					IMU_I2C_PROTOCOL_ID
 
+/*
+ * The imu odr, on-chip gyro / accel filters and fifo batch rate are derived
+ * from the loop rate; the cutoffs below set the on-chip bands (the gyro's
+ * capped at the loop nyquist frequency) and the digital filters, if enabled.
+ */
+#define CONFIG_IMU_LOOP_RATE_HZ						417U		// flight loop rate the imu is configured for
+
 #define CONFIG_GY_LPF								DISABLED
 #define CONFIG_GY_LPF_CUTOFF_FREQ_HZ 				500.0f
 
 #define CONFIG_XL_LPF								DISABLED
 #define CONFIG_XL_LPF_CUTOFF_FREQ_HZ 				40.0f
 
+/*
+ * Redundant imus are voted into one sample (sensors/imu/imu_vote.h): a stuck,
+ * diverging or unreadable one is dropped and the others carry on in the same
+ * loop. The second lsm6dsox sits at SA0 high on the imu bus.
+ */
+#define CONFIG_IMU_COUNT							1U			// fitted (1..2)
+#define CONFIG_IMU_VOTE_GY_TOL_DPS					15.0f		// deviation allowed from the voted rates..
+#define CONFIG_IMU_VOTE_XL_TOL_G					0.5f		// ..and accels
+#define CONFIG_IMU_VOTE_FAULT_MS					100U		// failed reads / divergence in a row to drop an imu
+#define CONFIG_IMU_STUCK_MS							50U			// bit-identical samples in a row to drop an imu
+
+/*
+ * Crash detection runs in the imu's finite state machine (sensors/imu/crash.h):
+ * an impact or a tumble pulls INT1 (PB0) and its isr disarms at once. The
+ * programs are hand-assembled, so check them on the bench before enabling.
+ */
+#define CONFIG_CRASH_DETECT							DISABLED
+#define CONFIG_CRASH_IMPACT_G						8.0f		// accel norm above (full scale is 16 g)
+#define CONFIG_CRASH_TUMBLE_DPS						720.0f		// gyro norm held above (4x the commanded rate limits)..
+#define CONFIG_CRASH_TUMBLE_MS						250U		// ..for this long
+#define CONFIG_CRASH_FREEFALL_G						0.35f		// accel norm held below..
+#define CONFIG_CRASH_FREEFALL_MS					150U		// ..for this long
+#define CONFIG_CRASH_FREEFALL_DISARM				DISABLED	// reported only: a throttle cut dive reads the same
+
+// BARO-----------------------------------------------------------------------
+#define BMP3XX_DEVICE_ID							0U
+#define CONFIG_BARO_DEVICE							BMP3XX_DEVICE_ID
+
+#define BARO_I2C_PROTOCOL_ID						0U
+#define CONFIG_BARO_COMM_PROTOCOL					BARO_I2C_PROTOCOL_ID
+
+/*
+ * One conversion (~2 ms per pressure sample) plus two flight loops must fit in
+ * the 1 / rate period, else conversions slip (x8 at 50 Hz gives ~46 Hz).
+ */
+#define CONFIG_BARO_RATE_HZ							50U			// forced conversions per second
+#define CONFIG_BARO_PRESS_OSR						4U			// pressure oversampling (1, 2, 4, 8, 16, 32)
+
+// GPS------------------------------------------------------------------------
+#define UBLOX_DEVICE_ID								0U			// configured for UBX NAV-PVT at init
+#define NMEA_DEVICE_ID								1U			// any NMEA 0183 receiver (GGA + RMC), not configured
+#define CONFIG_GPS_DEVICE							UBLOX_DEVICE_ID
+
+#define CONFIG_GPS_BAUD								115200U
+#define CONFIG_GPS_RATE_HZ							10U			// navigation solutions per second (ublox only)
+#define CONFIG_GPS_DELAY_MS							100U		// solution age once its last byte is in (receiver + transfer)
+#define CONFIG_GPS_NMEA_UERE_M						2.5f		// nmea horizontal accuracy per unit of hdop
+
+// MAG------------------------------------------------------------------------
+#define LIS2MDL_DEVICE_ID							0U			// on the lsm6dsox sensor hub (aux i2c)
+#define MAG_SIM_DEVICE_ID							1U			// host simulator only
+#define CONFIG_MAG_DEVICE							LIS2MDL_DEVICE_ID
+
+#define CONFIG_MAG_HEADING_TAU_S					5.0f		// gyro / magnetometer heading crossover time constant
+#define CONFIG_MAG_DECLINATION_DEG					0.0f		// true = magnetic + declination (east positive)
+#define CONFIG_MAG_FIELD_TOL_PCT					20.0f		// samples off the average field strength are not fused
+#define CONFIG_MAG_CAL_DURATION_S					60U			// default calibration session length
+
+// BATTERY--------------------------------------------------------------------
+#define ADC_BATTERY_DEVICE_ID						0U			// voltage divider + current sensor on ADC1 (PC4, PC5)
+#define BATTERY_SIM_DEVICE_ID						1U			// host simulator only
+#define CONFIG_BATTERY_DEVICE						ADC_BATTERY_DEVICE_ID
+
+#define CONFIG_BATT_ADC_VREF_V						3.3f		// ADC reference (VDDA)
+#define CONFIG_BATT_VOLT_SCALE						11.0f		// pack volts per pin volt (divider ratio)
+#define CONFIG_BATT_CURR_SCALE_A_PER_V				40.0f		// current sensor (25 mV/A)
+#define CONFIG_BATT_CURR_OFFSET_V					0.0f		// current sensor output at 0 A
+#define CONFIG_BATT_PERIOD_MS						20U			// monitor update period (adc averaged over it)
+#define CONFIG_BATT_CELLS							0U			// 0: detected from the resting voltage
+#define CONFIG_BATT_CELL_MAX_V						4.35f		// charged cell (LiHV); sets the cell count detection
+#define CONFIG_BATT_PRESENT_MIN_V					3.0f		// below: no pack (board on usb power)
+#define CONFIG_BATT_DETECT_MS						500U		// pack voltage settle time before cell detection
+#define CONFIG_BATT_SAG_TAU_S						2.0f		// resting voltage low-pass time constant
+#define CONFIG_BATT_RES_TAU_S						20.0f		// pack resistance estimate averaging time
+
 /* PROTOCOL CONFIG SETTINGS--------------------------------------------------------
 |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
 -----------------------------------------------------------------------------------*/
@@ -116,25 +270,22 @@
 #define PWM_PULSE_VALID_MIN_US						950U
 #define PWM_PULSE_VALID_MAX_US						2050U
 
-/* RX CONFIG SETTINGS--------------------------------------------------------------
-|||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
------------------------------------------------------------------------------------*/
-// PROTOCOL-------------------------------------------------------------------
-#define RX_PWM_PROTOCOL_ID							0U
-#define CONFIG_RX_PROTOCOL							RX_PWM_PROTOCOL_ID
-
 /* ESC CONFIG SETTINGS-------------------------------------------------------------
 |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
 -----------------------------------------------------------------------------------*/
-// PROTOCOL-------------------------------------------------------------------
-#define ESC_PWM_PROTOCOL_ID							0U
-#define CONFIG_ESC_PROTOCOL							ESC_PWM_PROTOCOL_ID
-
 // COMMANDS-------------------------------------------------------------------
 #define CONFIG_ESC_CMD_IDLE_PCT						18.0f
 #define CONFIG_ESC_CMD_LIFTOFF_PCT					24.0f
 #define CONFIG_ESC_CMD_LIMIT_PCT					100.0f // Max is 100% (this would unlock full motor potential)
 
+// TELEMETRY------------------------------------------------------------------
+#define CONFIG_ESC_TELEMETRY						DISABLED	// KISS / BLHeli32 serial telemetry on USART2 rx (esc/esc_telemetry.h); needs a protocol that can request it
+#define CONFIG_ESC_TLM_BAUD							115200U
+#define CONFIG_ESC_TLM_TIMEOUT_US					3000U		// request to complete frame, else the next motor is requested
+#define CONFIG_ESC_TLM_STALE_MS						100U		// motor telemetry invalid without a frame for this long
+#define CONFIG_ESC_TLM_TEMP_MAX_C					100U		// hotter escs are reported (health warning)
+#define CONFIG_ESC_MOTOR_POLES						14U			// magnet poles (rpm = erpm / pole pairs)
+
 /*
  * On Full Charged Battery
  *
@@ -143,3 +294,31 @@
  * 3650 (liftoff cmd)
  *
  */
+
+/* SITL CONFIG OVERRIDES-----------------------------------------------------------
+|||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||
+-----------------------------------------------------------------------------------*/
+/*
+ * The host simulator (Sim/, built with -DSITL) swaps hardware-bound drivers for
+ * the physics model. imu.c, baro.c, gps.c and esc_telemetry.c are replaced
+ * wholesale by the simulator (their device layers are bound to the I2C / UART
+ * hardware); the rx and esc protocols are bound at boot, and the sim build links
+ * only the sim drivers; everything else selects a sim driver here. ESC
+ * telemetry is enabled because the sim esc can request it.
+ */
+#ifdef SITL
+#undef CONFIG_ESC_TELEMETRY
+#define CONFIG_ESC_TELEMETRY						ENABLED
+
+#undef CONFIG_MAG_DEVICE
+#define CONFIG_MAG_DEVICE							MAG_SIM_DEVICE_ID
+
+#undef CONFIG_BATTERY_DEVICE
+#define CONFIG_BATTERY_DEVICE						BATTERY_SIM_DEVICE_ID
+
+#undef CONFIG_PARAM_STORAGE
+#define CONFIG_PARAM_STORAGE						RAM_PARAM_STORAGE_ID
+
+#undef CONFIG_BENCH
+#define CONFIG_BENCH								ENABLED			// aqc_bench
+#endif
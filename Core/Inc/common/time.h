@@ -21,3 +21,5 @@ void stop_timer(TIM_HandleTypeDef *htim);
 void delay_ms(uint32_t ms);
 
 uint32_t millis(void);
+
+uint64_t micros(void);
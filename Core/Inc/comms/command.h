@@ -0,0 +1,14 @@
+/*
+ * command.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include "comms/frame.h"
+
+/* Exported functions prototypes ---------------------------------------------*/
+void command_handle(const frame_t *frame);
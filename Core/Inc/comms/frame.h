@@ -0,0 +1,79 @@
+/*
+ * frame.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Frame Layout (before COBS encoding):
+ *
+ *   | msg_id (1) | seq (1) | payload (0..FRAME_PAYLOAD_MAX) | crc16 (2, LE) |
+ *
+ * The crc covers msg_id..payload. The raw frame is COBS encoded so it contains
+ * no zero bytes, then terminated with a single 0x00 delimiter.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define FRAME_DELIMITER			0x00U
+#define FRAME_HEADER_SIZE		2U
+#define FRAME_CRC_SIZE			2U
+#define FRAME_PAYLOAD_MAX		240U
+#define FRAME_RAW_MAX			(FRAME_HEADER_SIZE + FRAME_PAYLOAD_MAX + FRAME_CRC_SIZE)
+#define FRAME_ENCODED_MAX		(FRAME_RAW_MAX + (FRAME_RAW_MAX / 254U) + 2U)	// + cobs overhead + delimiter
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Frame Decode Status Type
+  */
+typedef enum {
+	FRAME_INCOMPLETE		= 0x00U,
+	FRAME_OK				= 0x01U,
+	FRAME_ERROR_CRC			= 0x02U,
+	FRAME_ERROR_OVERFLOW	= 0x03U,
+	FRAME_ERROR_SHORT		= 0x04U
+} frame_status_t;
+
+/**
+  * @brief  Decoded Frame Type
+  */
+typedef struct {
+	uint8_t msg_id;
+	uint8_t seq;
+	uint16_t len;
+	const uint8_t *payload;
+} frame_t;
+
+/**
+  * @brief  Incremental Frame Decoder Handle
+  */
+typedef struct {
+	uint8_t buf[FRAME_RAW_MAX];
+	uint16_t len;
+	uint8_t code;
+	uint8_t remaining;
+	bool overflow;
+} frame_decoder_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+size_t frame_encode(uint8_t *dst, uint32_t mask, uint32_t pos, uint8_t msg_id, uint8_t seq, const void *payload, uint16_t len);
+
+void frame_decoder_reset(frame_decoder_t *dec);
+
+frame_status_t frame_decoder_push(frame_decoder_t *dec, uint8_t byte, frame_t *out);
+
+/* Exported static inline functions ------------------------------------------*/
+/**
+  * @brief worst-case encoded size of a frame carrying len payload bytes
+  */
+static inline size_t frame_encoded_size_max(uint16_t len) {
+	size_t raw = FRAME_HEADER_SIZE + len + FRAME_CRC_SIZE;
+	return raw + (raw / 254U) + 2U;
+}
@@ -0,0 +1,52 @@
+/*
+ * link.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Link Status Type
+  */
+typedef enum {
+	LINK_OK				= 0x00U,
+	LINK_ERROR_WARN		= 0x01U,
+	LINK_ERROR_FATAL	= 0x02U
+} link_status_t;
+
+/**
+  * @brief  Link Statistics Type
+  */
+typedef struct {
+	uint32_t tx_frames;
+	uint32_t tx_bytes;
+	uint32_t tx_dropped;
+	uint32_t rx_frames;
+	uint32_t rx_bytes;
+	uint32_t rx_errors;
+	uint32_t rx_overruns;
+} link_stats_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void link_init(void);
+
+bool link_is_connected(void);
+
+link_status_t link_send(uint8_t msg_id, const void *payload, uint16_t len);
+
+uint32_t link_tx_free(void);
+
+void link_service(void);
+
+void link_get_stats(link_stats_t *out);
+
+void link_receive_isr(const uint8_t *buf, uint32_t len);
+
+void link_transmit_complete_isr(void);
@@ -0,0 +1,319 @@
+/*
+ * messages.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macro constants --------------------------------------------------*/
+#define MSG_PARAM_NAME_LEN		16U
+#define MSG_BENCH_NAME_LEN		32U
+
+#define MSG_TIME_FLAG_SET		(1U << 0)	// rtc holds a wall time
+#define MSG_TIME_FLAG_LSE		(1U << 1)	// rtc runs on the crystal (else LSI)
+
+/*
+ * Wire format: all multi-byte fields are little-endian, floats are IEEE-754
+ * single precision. Payload structs are packed and copied as-is.
+ */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Message ID Type
+  */
+typedef enum {
+	/* Commands (host -> fc) */
+	MSG_PING				= 0x01U,
+	MSG_STREAM_START		= 0x10U,
+	MSG_STREAM_STOP			= 0x11U,
+	MSG_PARAM_GET			= 0x20U,
+	MSG_PARAM_SET			= 0x21U,
+	MSG_PARAM_SAVE			= 0x23U,
+	MSG_PARAM_DESC_GET		= 0x24U,
+	MSG_MAG_CAL_START		= 0x26U,	// start a magnetometer calibration session (disarmed)
+	MSG_MAG_CAL_GET			= 0x27U,
+	MSG_STATS_GET			= 0x30U,
+	MSG_IRQ_LATENCY_GET		= 0x32U,
+	MSG_BENCH_GET			= 0x34U,
+	MSG_SD_STATS_GET		= 0x36U,
+	MSG_TIME_SET			= 0x38U,
+	MSG_TIME_GET			= 0x39U,
+	MSG_MSC_START			= 0x3BU,	// switch usb to mass storage (disarmed; eject to return)
+	MSG_TLM_STATS_GET		= 0x3CU,
+	MSG_IMU_HEALTH_GET		= 0x3EU,
+
+	/* Replies (fc -> host) */
+	MSG_ACK					= 0x02U,
+	MSG_PARAM_VALUE			= 0x22U,
+	MSG_PARAM_DESC			= 0x25U,
+	MSG_MAG_CAL				= 0x28U,
+	MSG_STATS				= 0x31U,
+	MSG_IRQ_LATENCY			= 0x33U,
+	MSG_BENCH				= 0x35U,
+	MSG_SD_STATS			= 0x37U,
+	MSG_TIME				= 0x3AU,
+	MSG_TLM_STATS			= 0x3DU,
+	MSG_IMU_HEALTH			= 0x3FU,
+
+	/* Telemetry Topics (fc -> host) */
+	MSG_TLM_IMU				= 0x40U,
+	MSG_TLM_ATTITUDE		= 0x41U,
+	MSG_TLM_RC				= 0x42U,
+	MSG_TLM_MOTORS			= 0x43U,
+	MSG_TLM_BATCH			= 0x44U,	// samples of one topic (msg_tlm_batch_t)
+	MSG_TLM_BATTERY			= 0x45U,
+	MSG_TLM_ESC				= 0x46U,
+
+	/* Health (fc -> host) */
+	MSG_HEALTH_SUMMARY		= 0x50U,
+	MSG_HEALTH_EVENTS		= 0x51U
+} msg_id_t;
+
+/**
+  * @brief  Command Result Type (carried in MSG_ACK)
+  */
+typedef enum {
+	ACK_OK					= 0x00U,
+	ACK_INVALID				= 0x01U,
+	ACK_UNSUPPORTED			= 0x02U,
+	ACK_REJECTED			= 0x03U
+} ack_result_t;
+
+/**
+  * @brief  Command / Reply Payloads
+  */
+typedef struct __attribute__((packed)) {
+	uint8_t msg_id;
+	uint8_t result;
+} msg_ack_t;
+
+typedef struct __attribute__((packed)) {
+	uint8_t topic;
+	uint16_t rate_hz;
+} msg_stream_start_t;
+
+typedef struct __attribute__((packed)) {
+	uint8_t topic;
+} msg_stream_stop_t;
+
+typedef struct __attribute__((packed)) {
+	uint16_t id;
+} msg_param_get_t;
+
+typedef struct __attribute__((packed)) {
+	uint16_t id;
+	float value;
+} msg_param_value_t;
+
+typedef struct __attribute__((packed)) {
+	uint16_t id;
+	uint8_t type;
+	uint8_t group;
+	uint8_t flags;
+	float min;
+	float max;
+	float def;
+	char name[MSG_PARAM_NAME_LEN];	// NUL padded, not terminated at full length
+} msg_param_desc_t;
+
+typedef struct __attribute__((packed)) {
+	uint16_t duration_s;			// 0: default length
+} msg_mag_cal_start_t;
+
+typedef struct __attribute__((packed)) {
+	uint8_t state;					// mag_cal_state_t
+	uint8_t result;					// mag_cal_result_t of the last fit
+	uint32_t samples;
+	float offset_mgauss[3];
+	float soft_iron[6];				// xx, xy, xz, yy, yz, zz (symmetric)
+	float field_mgauss;
+	float fit_error_pct;
+	float axis_ratio;
+} msg_mag_cal_t;
+
+typedef struct __attribute__((packed)) {
+	uint32_t uptime_ms;
+	uint32_t tx_frames;
+	uint32_t tx_bytes;
+	uint32_t tx_dropped;
+	uint32_t rx_frames;
+	uint32_t rx_bytes;
+	uint32_t rx_errors;
+	uint32_t rx_overruns;
+	uint32_t health_dropped;
+	uint32_t loop_cycles_avg;		// flight_update, cpu cycles
+	uint32_t loop_cycles_max;
+	uint32_t control_cycles_avg;	// estimator -> controller -> mixer, cpu cycles
+	uint32_t control_cycles_max;
+	uint32_t log_cycles_avg;		// blackbox encode and log write, cpu cycles
+	uint32_t log_cycles_max;
+} msg_stats_t;
+
+typedef struct __attribute__((packed)) {
+	uint8_t reset;					// clear statistics after replying
+} msg_irq_latency_get_t;
+
+typedef struct __attribute__((packed)) {
+	uint32_t count;
+	uint32_t avg_cycles;			// event -> isr entry, cpu cycles
+	uint32_t max_cycles;
+} msg_irq_latency_source_t;
+
+typedef struct __attribute__((packed)) {
+	uint8_t source_count;
+	msg_irq_latency_source_t sources[];	// indexed by irq_source_t
+} msg_irq_latency_t;
+
+typedef struct __attribute__((packed)) {
+	uint8_t id;						// bench_id_t
+	uint8_t count;					// results in this reply sequence
+	uint32_t clock_hz;				// cycle counter rate
+	uint32_t calls;					// calls per batch
+	uint32_t batches;
+	uint32_t min_cycles;			// per batch
+	uint32_t avg_cycles;
+	uint32_t max_cycles;
+	uint32_t budget_cycles;			// per call
+	char name[MSG_BENCH_NAME_LEN];	// function timed, NUL padded
+} msg_bench_t;
+
+typedef struct __attribute__((packed)) {
+	uint32_t bytes_written;			// since the stream was opened
+	uint32_t bytes_dropped;
+	uint32_t transfers;				// multi-block writes
+	uint32_t errors;
+	uint32_t latency_avg_us;		// write start -> transfer complete
+	uint32_t latency_max_us;
+	uint32_t throughput_kbps;		// KB/s while transferring
+} msg_sd_stats_t;
+
+typedef struct __attribute__((packed)) {
+	uint32_t unix_s;				// utc, years 2000..2099
+} msg_time_set_t;
+
+typedef struct __attribute__((packed)) {
+	uint32_t boot_id;
+	uint32_t unix_s;				// 0 if not set
+	uint32_t unix_us;
+	uint64_t clock_us;				// micros() at unix_s.unix_us
+	uint8_t flags;					// MSG_TIME_FLAG_*
+} msg_time_t;
+
+typedef struct __attribute__((packed)) {
+	uint16_t rate_hz;				// 0 when stream is stopped
+	uint32_t samples;				// since the stream was started
+	uint32_t dropped;
+	uint32_t batches;
+} msg_tlm_topic_stats_t;
+
+typedef struct __attribute__((packed)) {
+	uint8_t topic_count;
+	msg_tlm_topic_stats_t topics[];	// indexed by telemetry_topic_t
+} msg_tlm_stats_t;
+
+typedef struct __attribute__((packed)) {
+	uint8_t state;					// imu_instance_state_t
+	uint8_t fault;					// imu_instance_fault_t (last seen)
+	uint32_t reads;
+	uint32_t read_errors;
+	uint32_t disagreements;			// samples off the voted output beyond tolerance
+	float gy_dev_max_mdps;			// largest deviation from the voted output
+	float xl_dev_max_mg;
+} msg_imu_instance_t;
+
+typedef struct __attribute__((packed)) {
+	uint8_t instance_count;
+	uint8_t primary;
+	uint32_t failovers;
+	msg_imu_instance_t instances[];	// indexed by instance
+} msg_imu_health_t;
+
+/**
+  * @brief  Telemetry Payloads
+  */
+typedef struct __attribute__((packed)) {
+	uint32_t timestamp_ms;
+	float accel_mg[3];
+	float rate_mdps[3];
+	uint32_t dt;
+} msg_tlm_imu_t;
+
+typedef struct __attribute__((packed)) {
+	uint32_t timestamp_ms;
+	float roll_deg;
+	float pitch_deg;
+	float roll_rate_dps;
+	float pitch_rate_dps;
+	float yaw_rate_dps;
+} msg_tlm_attitude_t;
+
+typedef struct __attribute__((packed)) {
+	uint32_t timestamp_ms;
+	float roll_deg;
+	float pitch_deg;
+	float roll_rate_dps;
+	float pitch_rate_dps;
+	float yaw_rate_dps;
+	float throttle_pct;
+	uint8_t mode;			// mode_status_t
+	uint8_t armed;			// esc armed (motor commands applied)
+} msg_tlm_rc_t;
+
+typedef struct __attribute__((packed)) {
+	uint32_t timestamp_ms;
+	float mtr[4];
+} msg_tlm_motors_t;
+
+typedef struct __attribute__((packed)) {
+	uint32_t timestamp_ms;
+	float voltage_v;
+	float current_a;
+	float rest_voltage_v;	// sag compensated
+	float consumed_mah;
+	float energy_wh;
+	uint8_t cells;			// 0: not detected
+} msg_tlm_battery_t;
+
+typedef struct __attribute__((packed)) {
+	uint32_t timestamp_ms;
+	float rpm[4];			// mechanical
+	float current_a[4];
+	float voltage_v[4];
+	uint8_t temperature_c[4];
+	uint8_t valid;			// bit per motor (fields of invalid motors are stale)
+} msg_tlm_esc_t;
+
+typedef struct __attribute__((packed)) {
+	uint8_t msg_id;			// sample type (MSG_TLM_IMU, ...)
+	uint8_t count;
+	uint16_t seq;			// sequence number of the first sample (gaps are dropped samples)
+	uint8_t samples[];		// count samples of the type, back to back
+} msg_tlm_batch_t;
+
+/**
+  * @brief  Health Payloads
+  */
+typedef struct __attribute__((packed)) {
+	uint32_t warn_count;
+	uint32_t fatal_count;
+	uint16_t last_code;
+} msg_health_module_t;
+
+typedef struct __attribute__((packed)) {
+	uint32_t timestamp_ms;
+	uint32_t dropped;
+	uint8_t module_count;
+	msg_health_module_t modules[];
+} msg_health_summary_t;
+
+typedef struct __attribute__((packed)) {
+	uint32_t timestamp_ms;
+	uint8_t module;
+	uint8_t severity;
+	uint16_t code;
+} msg_health_event_t;
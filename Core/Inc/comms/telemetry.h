@@ -0,0 +1,81 @@
+/*
+ * telemetry.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensors/imu/imu.h"
+#include "flight/attitude.h"
+#include "flight/rc_input.h"
+#include "esc/esc.h"
+#include "sensors/battery/battery.h"
+#include "esc/esc_telemetry.h"
+
+/*
+ * Telemetry Streams
+ *
+ * Each topic is sampled in telemetry_service (once per flight loop) at its
+ * own rate, decimated from the loop rate: a sample is taken on the first loop
+ * of each period, so rates at or above the loop rate give one sample per
+ * loop. Samples of a topic are packed into one MSG_TLM_BATCH frame until
+ * the frame is full or CONFIG_TELEMETRY_BATCH_MS old, so a USB transfer
+ * carries several samples instead of one frame each.
+ *
+ * A batch the link ring cannot take is held and retried next loop; while it
+ * is held (full), further samples of that topic are dropped and counted. The
+ * batch sequence number counts dropped samples too, so the host sees every
+ * gap. Nothing here waits on the USB link.
+ */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Telemetry Topic Type
+  */
+typedef enum {
+	TELEMETRY_TOPIC_IMU			= 0x00U,
+	TELEMETRY_TOPIC_ATTITUDE	= 0x01U,
+	TELEMETRY_TOPIC_RC			= 0x02U,
+	TELEMETRY_TOPIC_MOTORS		= 0x03U,
+	TELEMETRY_TOPIC_BATTERY		= 0x04U,
+	TELEMETRY_TOPIC_ESC			= 0x05U,
+	TELEMETRY_TOPIC_COUNT
+} telemetry_topic_t;
+
+/**
+  * @brief  Telemetry Data Sources Handle (main-owned flight data)
+  */
+typedef struct {
+	const imu_6D_t *imu;
+	const attitude_est_t *est;
+	const rc_reqs_t *req;
+	const mtr_cmds_t *mcmd;
+	const battery_data_t *batt;
+	const esc_tlm_data_t *esc_tlm;
+} telemetry_sources_t;
+
+/**
+  * @brief  Telemetry Topic Statistics Type (since the stream was started)
+  */
+typedef struct {
+	uint16_t rate_hz;			// 0 when stream is stopped
+	uint32_t samples;			// sent in batches
+	uint32_t dropped;			// batch full while the link was busy, or no host
+	uint32_t batches;
+} telemetry_stats_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void telemetry_init(const telemetry_sources_t *src);
+
+bool telemetry_set_rate(telemetry_topic_t topic, uint16_t rate_hz);
+
+void telemetry_stop_all(void);
+
+void telemetry_service(void);
+
+bool telemetry_get_stats(telemetry_topic_t topic, telemetry_stats_t *out);
@@ -0,0 +1,36 @@
+/*
+ * usb_msc.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include "storage/msc.h"
+
+/*
+ * USB Mass Storage Mode
+ *
+ * Swaps the usb device from the CDC link to a mass storage class serving the
+ * sd card (storage/msc.h), so logs can be copied off without removing the
+ * card. The two classes never run together: the device detaches and comes
+ * back with its own product id, and the host ejecting the drive brings the
+ * CDC link back (the ground station reconnects).
+ *
+ *   usb_msc_request();		// MSG_MSC_START, disarmed only
+ *   usb_msc_service();		// main loop: switches, serves the card
+ *   usb_msc_is_active();	// arming refused while true
+ *
+ * FatFs is unmounted for the whole mode and remounted on the way out (the
+ * host may have changed the volume).
+ */
+
+/* Exported functions prototypes ---------------------------------------------*/
+bool usb_msc_request(void);
+
+msc_status_t usb_msc_service(void);
+
+bool usb_msc_is_active(void);
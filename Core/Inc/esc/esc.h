@@ -11,6 +11,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/* Exported macro constants --------------------------------------------------*/
+#define ESC_COUNT			4U
+
 /* Exported types ------------------------------------------------------------*/
 typedef struct {
 	float mtr1;
@@ -40,6 +43,7 @@ typedef struct {
     void (*arm)(uint32_t);
     void (*disarm)(uint32_t);
     void (*set_commands)(const esc_cmds_t*);
+    void (*request_telemetry)(uint8_t);		// optional: flag one esc (0-based) to send a telemetry frame
 } esc_protocol_interface_t;
 
 typedef struct {
@@ -63,8 +67,14 @@ esc_status_t esc_arm(void);
 
 esc_status_t esc_disarm(void);
 
+esc_status_t esc_lock(void);
+
+void esc_unlock(void);
+
 bool esc_is_armed(void);
 
 esc_status_t esc_set_motor_commands(const mtr_cmds_t *mcmd);
 
 void esc_get_command_properties(esc_cmd_props_t *out);
+
+esc_status_t esc_request_telemetry(uint8_t esc);
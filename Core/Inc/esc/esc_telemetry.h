@@ -0,0 +1,88 @@
+/*
+ * esc_telemetry.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "esc/esc.h"
+
+/*
+ * ESC serial telemetry interface (KISS / BLHeli32).
+ *
+ * The telemetry outputs of all escs share one wire into USART2 rx (PA3),
+ * received into a circular DMA buffer (DMA1 stream 5), so reception needs no
+ * interrupt and no cpu time. Only one esc may talk at a time, so frames are
+ * requested one motor after the other (esc_request_telemetry): the next
+ * request goes out once the frame of the last one completed, or after
+ * CONFIG_ESC_TLM_TIMEOUT_US without it. esc_telemetry_read is called once per
+ * flight loop: it hands the bytes that arrived straight from the DMA buffer
+ * to the frame parser (esc_telemetry_parser.h), then issues the next request.
+ *
+ * A frame carries the voltage, current, consumed charge, electrical rpm and
+ * temperature of its esc; the motor rpm is the erpm over the pole pairs
+ * (CONFIG_ESC_MOTOR_POLES). A motor's data stays valid for
+ * CONFIG_ESC_TLM_STALE_MS after its last frame. The read reports WARN on
+ * corrupted or missing frames and on escs above CONFIG_ESC_TLM_TEMP_MAX_C, so
+ * a failing esc or telemetry wire shows up in the health summary.
+ *
+ * Telemetry is optional (CONFIG_ESC_TELEMETRY) and needs an esc protocol
+ * that can request frames; pwm cannot, so it is disabled by default.
+ */
+
+/* Exported macros -----------------------------------------------------------*/
+#define ESC_TLM_OK				ESC_OK
+#define ESC_TLM_ERROR_WARN		ESC_ERROR_WARN
+#define ESC_TLM_ERROR_FATAL		ESC_ERROR_FATAL
+
+/* Exported aliases ----------------------------------------------------------*/
+typedef esc_status_t esc_tlm_status_t;
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Motor Telemetry Type (as of the last frame of its esc)
+  */
+typedef struct {
+	float voltage_v;			// esc supply (pack at the esc)
+	float current_a;
+	float rpm;					// mechanical (erpm / pole pairs)
+	uint32_t erpm;				// electrical
+	uint16_t consumption_mah;	// since esc power-up
+	uint8_t temperature_c;
+	bool valid;					// frame within CONFIG_ESC_TLM_STALE_MS
+} esc_motor_tlm_t;
+
+/**
+  * @brief  ESC Telemetry Data Type
+  */
+typedef struct {
+	esc_motor_tlm_t motor[ESC_COUNT];
+	float current_a;			// sum over the valid motors
+	uint8_t fresh;				// bit per motor: its frame completed on this read
+} esc_tlm_data_t;
+
+/**
+  * @brief  ESC Telemetry Stream Statistics Type
+  */
+typedef struct {
+	uint32_t bytes;
+	uint32_t frames;			// complete frames with a valid crc
+	uint32_t crc_errors;		// frame windows failing the crc (parser resynced)
+	uint32_t timeouts;			// requests without a complete frame
+	uint32_t stray_bytes;		// bytes with no request outstanding (dropped)
+	uint32_t overruns;			// reads too late for the dma buffer (bytes lost)
+} esc_tlm_stats_t;
+
+/* Exported functions --------------------------------------------------------*/
+esc_tlm_status_t esc_telemetry_init(void);
+
+esc_tlm_status_t esc_telemetry_deinit(void);
+
+esc_tlm_status_t esc_telemetry_read(esc_tlm_data_t *data);
+
+void esc_telemetry_get_stats(esc_tlm_stats_t *out);
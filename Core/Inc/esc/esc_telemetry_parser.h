@@ -0,0 +1,70 @@
+/*
+ * esc_telemetry_parser.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "esc/esc_telemetry.h"
+
+/*
+ * KISS / BLHeli32 telemetry frame parser and request scheduler (no hardware
+ * access).
+ *
+ * A frame is 10 bytes, big-endian, with no sync byte:
+ *
+ *   temperature (1, C) | voltage (2, 10 mV) | current (2, 10 mA) |
+ *   consumption (2, mAh) | erpm / 100 (2) | crc8 (1, poly 0x07)
+ *
+ * and is sent by the esc last requested. Bytes are consumed one at a time,
+ * wherever they lie (e.g. in place in the dma buffer), into a frame window;
+ * a window failing the crc drops its first byte, so the parser resyncs on
+ * the next valid frame after line noise. Bytes arriving with no request
+ * outstanding are dropped. A reply later than the request timeout is taken
+ * for the next esc's, so the timeout must exceed the esc reply time.
+ *
+ * Per flight loop: feed what arrived, then poll, which expires the request
+ * and the motors' data and returns the esc to request next.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define ESC_TLM_FRAME_LEN		10U
+#define ESC_TLM_NO_REQUEST		0xFFU		// poll: a frame is still awaited
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  ESC Telemetry Parser State Type (owned by the caller)
+  */
+typedef struct {
+	uint8_t window[ESC_TLM_FRAME_LEN];
+	uint8_t len;
+	uint8_t motor;				// esc last requested
+	bool pending;				// its frame is awaited
+	uint64_t request_us;
+	uint64_t frame_us[ESC_COUNT];	// last frame per motor
+	uint8_t seen;				// bit per motor: a frame was received
+	uint32_t timeout_us;
+	uint32_t stale_us;
+	float pole_pairs;
+	esc_tlm_stats_t stats;
+} esc_tlm_parser_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void esc_telemetry_parser_init(esc_tlm_parser_t *p, uint32_t timeout_us, uint32_t stale_us, uint8_t motor_poles);
+
+uint32_t esc_telemetry_parser_feed(esc_tlm_parser_t *p, const uint8_t *buf, uint32_t len, uint64_t now_us,
+								   esc_tlm_data_t *out);
+
+uint32_t esc_telemetry_parser_feed_ring(esc_tlm_parser_t *p, const uint8_t *ring, uint32_t size, uint32_t *tail,
+										uint32_t head, uint64_t now_us, esc_tlm_data_t *out);
+
+uint8_t esc_telemetry_parser_poll(esc_tlm_parser_t *p, uint64_t now_us, esc_tlm_data_t *out);
+
+bool esc_telemetry_decode(const uint8_t *frame, float pole_pairs, esc_motor_tlm_t *out);
+
+uint32_t esc_telemetry_frame(const esc_motor_tlm_t *in, uint8_t *out);
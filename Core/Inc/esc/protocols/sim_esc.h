@@ -0,0 +1,19 @@
+/*
+ * sim_esc.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include "esc/esc.h"
+
+/*
+ * Implemented by the host simulator (Sim/src/sim_esc.c); never linked into
+ * the firmware image.
+ */
+
+/* External variables --------------------------------------------------------*/
+extern const esc_protocol_interface_t sim_esc_driver;
@@ -0,0 +1,92 @@
+/*
+ * altitude.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensors/imu/imu.h"
+#include "sensors/baro/baro.h"
+#include "flight/attitude.h"
+#include "flight/rc_input.h"
+
+/*
+ * Vertical state estimator (third-order complementary filter).
+ *
+ * The accelerometer is rotated into the earth frame with the roll/pitch
+ * estimate and integrated to climb rate and altitude every loop; the
+ * barometric altitude corrects position, velocity and an accelerometer bias
+ * state with gains 3/tau, 3/tau^2 and 1/tau^3 (all three poles at -1/tau).
+ * Below tau the accelerometer dominates (no baro noise or lag), above it the
+ * barometer does (no drift). Between 50 Hz baro samples the last one is held.
+ *
+ * Altitude is relative to a ground reference averaged over the first
+ * CONFIG_ALT_BARO_ZERO_SAMPLES baro samples, and re-zeroed when the esc arms.
+ * The vehicle is taken to be at rest meanwhile, so the accelerometer bias state
+ * starts from the average vertical acceleration instead of converging in
+ * flight. The estimate is invalid until then (e.g. no barometer fitted).
+ *
+ * Altitude hold (ALT_HOLD_MODE) drives the throttle with a cascade run at
+ * CONFIG_ALT_HOLD_RATE_HZ: an altitude PID sets the climb rate, and a climb
+ * rate PID adds to the hover throttle. Around center the throttle stick holds
+ * the altitude; outside it commands climb rate. The hover throttle is learned
+ * whenever the vehicle hovers, in any mode, so alt hold engages close to it.
+ * An idle throttle stick always passes straight through (ground, arming).
+ */
+
+/* Exported Types ------------------------------------------------------------*/
+/**
+  * @brief  Altitude Estimator Status Type
+  */
+typedef enum {
+	ALTITUDE_OK,
+	ALTITUDE_ERROR_WARN,
+	ALTITUDE_ERROR_FATAL
+} altitude_status_t;
+
+/**
+  * @brief  Altitude / Climb Rate Estimate Type (also holds the filter state)
+  */
+typedef struct {
+	float altitude_m;			// above the ground reference
+	float climb_rate_mps;
+	float accel_bias_mps2;		// vertical accelerometer bias estimate
+	float baro_alt_m;			// last baro altitude above the ground reference
+	float ref_alt_m;			// ground reference (pressure altitude)
+	float ref_sum_m;			// ground reference accumulator
+	uint32_t ref_count;			// baro samples in the ground reference
+	bool valid;
+} altitude_est_t;
+
+/**
+  * @brief  Altitude Hold Command Type (collective throttle into the mixer)
+  */
+typedef struct {
+	float throttle;				// applied throttle (%): stick, blend or altitude hold
+	float target_alt_m;			// held altitude (above the ground reference)
+	float climb_rate_req_mps;	// climb rate PID setpoint
+	float hover_throttle;		// learned hover throttle (%)
+	bool engaged;				// altitude hold in control of the throttle
+} altitude_cmd_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+altitude_status_t altitude_estimator_update(const imu_6D_t *imu, const attitude_est_t *att,
+											const baro_data_t *baro, altitude_est_t *est);
+
+void altitude_estimator_rezero(altitude_est_t *est);
+
+float altitude_from_pressure(float pressure_pa);
+
+float altitude_vertical_accel(const imu_6D_t *imu, const attitude_est_t *att);
+
+altitude_status_t altitude_controller_update(altitude_cmd_t *cmd, const rc_reqs_t *req, const altitude_est_t *est,
+											 mode_status_t mode, float dt);
+
+void altitude_controller_reset(altitude_cmd_t *cmd);
+
+void altitude_controller_init(void);
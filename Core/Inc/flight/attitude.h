@@ -10,6 +10,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include <stdbool.h>
 #include "sensors/imu/imu.h"
+#include "sensors/mag/mag.h"
 #include "flight/rc_input.h"
 #include "flight/pid.h"
 
@@ -32,6 +33,10 @@ typedef struct {
 	float roll_rate_dps;
 	float pitch_rate_dps;
 	float yaw_rate_dps;
+	float heading_deg;				// clockwise from north (0..360), gyro / magnetometer
+	bool heading_valid;				// set by the first fused magnetometer sample
+	float mag_field_avg_mgauss;		// running field strength (disturbance check)
+	float mag_dt_s;					// time since the last fused sample
 } attitude_est_t;
 
 /**
@@ -46,6 +51,8 @@ typedef struct {
 /* Exported functions prototypes ---------------------------------------------*/
 attitude_status_t attitude_estimator_update(const imu_6D_t *imu, attitude_est_t *est);
 
+attitude_status_t attitude_heading_update(const imu_6D_t *imu, const mag_data_t *mag, attitude_est_t *est);
+
 attitude_status_t attitude_controller_update(attitude_cmd_t *cmd, const rc_reqs_t *req, const attitude_est_t *est, float dt);
 
 void attitude_controller_init(void);
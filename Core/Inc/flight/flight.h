@@ -0,0 +1,83 @@
+/*
+ * flight.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include "flight/rc_input.h"
+#include "flight/attitude.h"
+#include "flight/altitude.h"
+#include "flight/position.h"
+#include "sensors/imu/imu.h"
+#include "sensors/baro/baro.h"
+#include "sensors/gps/gps.h"
+#include "sensors/mag/mag.h"
+#include "sensors/battery/battery.h"
+#include "esc/esc.h"
+#include "esc/esc_telemetry.h"
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Flight Phase Type (drives the status LED)
+  */
+typedef enum {
+	FLIGHT_PHASE_DISARMED	= 0x00U,	// arm switch off
+	FLIGHT_PHASE_WAITING	= 0x01U,	// arm switch on, not ready to fly
+	FLIGHT_PHASE_READY		= 0x02U,	// arm switch on, ready (esc arms once switch was reset)
+	FLIGHT_PHASE_FLYING		= 0x03U		// esc armed, motor commands applied
+} flight_phase_t;
+
+/**
+  * @brief  Flight Loop Data Handle (owned by the caller, e.g. main or the simulator)
+  */
+typedef struct {
+	rc_reqs_t req;
+	imu_6D_t imu;
+	baro_data_t baro;
+	gps_data_t gps;
+	mag_data_t mag;
+	battery_data_t batt;
+	esc_tlm_data_t esc_tlm;		// per-motor rpm, current, temperature (logging, failsafe, rpm filtering)
+	attitude_est_t est;
+	altitude_est_t alt;
+	position_est_t pos;
+	attitude_cmd_t cmd;
+	altitude_cmd_t alt_cmd;
+	mtr_cmds_t mcmd;
+	bool arm_reset;
+	bool arm_inhibit;		// set by the caller: arming refused (e.g. usb mass storage mode, mag calibration)
+	bool arm_hold;			// set by the caller: arming deferred, ready kept (e.g. log file preallocation)
+	bool kill;				// set by the caller: motors off while set, even if armed (e.g. a crash)
+} flight_data_t;
+
+/**
+  * @brief  Flight Loop Status Handle (module statuses of one iteration)
+  */
+typedef struct {
+	rc_req_status_t rc;
+	imu_status_t imu;
+	baro_status_t baro;
+	gps_status_t gps;
+	mag_status_t mag;
+	battery_status_t battery;
+	esc_tlm_status_t esc_tlm;
+	attitude_status_t estimator;
+	altitude_status_t altitude;
+	position_status_t position;
+	attitude_status_t controller;
+	altitude_status_t alt_hold;
+	esc_status_t esc;
+	flight_phase_t phase;
+	bool disarmed;		// esc was disarmed during this iteration
+	uint32_t control_cycles;	// estimator -> mixer cpu cycles (0 on host)
+} flight_status_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void flight_init(flight_data_t *fd);
+
+void flight_update(flight_data_t *fd, flight_status_t *status);
@@ -20,3 +20,5 @@ void mixer_update(mtr_cmds_t *mcmd, const attitude_cmd_t *acmd, float throttle_r
 void thrust_compensate(mtr_cmds_t *mcmd, const attitude_est_t *est);
 
 float map_pct_to_mtr_cmd(float pct);
+
+float map_pct_to_mtr_span(float pct);
@@ -41,6 +41,8 @@ float pid_update(pid_ctrl_t *pid, float measurement, float setpoint, float dt);
 
 void pid_init(pid_ctrl_t *ctrl, const pid_config_t *config);
 
+void pid_configure(pid_ctrl_t *ctrl, const pid_config_t *config);
+
 void pid_resync(pid_ctrl_t *pid, float measurement, float setpoint);
 
 void pid_reset(pid_ctrl_t *pid);
@@ -0,0 +1,117 @@
+/*
+ * position.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensors/imu/imu.h"
+#include "sensors/gps/gps.h"
+#include "flight/attitude.h"
+
+/*
+ * Horizontal position / velocity estimator (complementary filter, north/east).
+ *
+ * The accelerometer is rotated into the earth frame with the roll/pitch
+ * estimate and the heading, and integrated to velocity and position every
+ * loop. GPS corrects velocity and an accelerometer bias state (two poles at
+ * -1/tau from the velocity error) and position (one pole from the position
+ * error); without a gps velocity the position error drives all three, as in
+ * the altitude estimator. Between solutions the last errors are held.
+ *
+ * A solution is CONFIG_GPS_DELAY_MS old when it arrives, so it is compared with
+ * the estimate of that time, taken from a history of the inertial states, and
+ * the error is applied to the current state (corrections made since are not
+ * counted twice: they are kept apart from the history).
+ *
+ * The heading is the attitude estimator's (gyro / magnetometer) once it has a
+ * magnetometer fix. Without one it is integrated from the gyro here and
+ * aligned with gps: over each second with enough horizontal acceleration the
+ * velocity change gps saw is compared with the one the rotated accelerometer
+ * gave. Until the first alignment the accelerometer is left out and the
+ * estimate follows gps alone.
+ *
+ * Positions are relative to the first accepted fix. The estimate is invalid
+ * until then, and again after CONFIG_POS_GPS_TIMEOUT_MS without one. Altitude
+ * stays with the barometer (altitude.h).
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define POSITION_HISTORY_LEN	128U		// loops (~300 ms at 417 Hz; covers CONFIG_GPS_DELAY_MS)
+
+/* Exported Types ------------------------------------------------------------*/
+/**
+  * @brief  Position Estimator Status Type
+  */
+typedef enum {
+	POSITION_OK,
+	POSITION_ERROR_WARN,
+	POSITION_ERROR_FATAL
+} position_status_t;
+
+/**
+  * @brief  Inertial State History Entry Type
+  */
+typedef struct {
+	uint32_t time_us;			// estimator clock (sum of imu dt)
+	float pos_m[2];				// inertial position, corrections excluded
+	float vel_mps[2];			// inertial velocity, corrections excluded
+	float dv_mps[2];			// integral of the rotated acceleration (heading alignment)
+} position_hist_t;
+
+/**
+  * @brief  Position / Velocity Estimate Type (also holds the filter state)
+  */
+typedef struct {
+	float pos_m[2];				// north, east of the origin
+	float vel_mps[2];			// north, east
+	float heading_deg;			// clockwise from north (0..360)
+	float accel_bias_mps2[2];	// earth frame accelerometer bias estimate
+
+	/* Filter State */
+	float pos_base_m[2];		// inertial integration
+	float pos_corr_m[2];		// gps corrections
+	float vel_base_mps[2];
+	float vel_corr_mps[2];
+	float dv_mps[2];
+	float pos_err_m[2];			// held errors of the last solution
+	float vel_err_mps[2];
+	bool vel_aided;				// last solution had a velocity
+
+	/* Heading Alignment Window */
+	float align_dv_mps[2];		// dv at the window start
+	float align_vel_mps[2];		// gps velocity at the window start
+	uint32_t align_start_us;
+	uint32_t align_count;		// alignments so far
+	bool align_started;
+	bool heading_aligned;
+	bool heading_mag;			// heading taken from the attitude estimate (magnetometer)
+
+	/* GPS Origin and Delay */
+	int32_t origin_lat_e7;
+	int32_t origin_lon_e7;
+	float lon_scale;			// cos(origin latitude)
+	bool origin_set;
+	uint32_t delay_us;			// solution age on arrival (0: no compensation)
+	uint32_t gps_age_us;		// since the last accepted solution
+
+	uint32_t time_us;
+	uint32_t hist_head;
+	uint32_t hist_count;
+	position_hist_t hist[POSITION_HISTORY_LEN];
+
+	bool valid;
+} position_est_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void position_estimator_init(position_est_t *est, uint32_t gps_delay_us);
+
+position_status_t position_estimator_update(const imu_6D_t *imu, const attitude_est_t *att,
+											const gps_data_t *gps, position_est_t *est);
+
+void position_gps_to_ne(const position_est_t *est, int32_t lat_e7, int32_t lon_e7, float ne[2]);
@@ -23,7 +23,8 @@ typedef enum {
 typedef enum {
 	INVALID_MODE	= 0x00U,
 	ANGLE_MODE		= 0x01U,
-	RATE_MODE		= 0x02U
+	RATE_MODE		= 0x02U,
+	ALT_HOLD_MODE	= 0x03U		// angle mode with altitude hold on the throttle stick
 } mode_status_t;
 
 /**
@@ -0,0 +1,20 @@
+/*
+ * ram_param_flash.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include "params/param_storage.h"
+
+/*
+ * RAM-backed flash emulator (erase sets 0xFF, program can only clear bits).
+ * Implemented by the host simulator (Sim/src/ram_param_flash.c); never linked
+ * into the firmware image.
+ */
+
+/* External variables --------------------------------------------------------*/
+extern const param_flash_interface_t ram_param_flash;
@@ -0,0 +1,14 @@
+/*
+ * stm32_param_flash.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include "params/param_storage.h"
+
+/* External variables --------------------------------------------------------*/
+extern const param_flash_interface_t stm32_param_flash;
@@ -0,0 +1,73 @@
+/*
+ * param_storage.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Storage Layout (per bank, two banks used in ping-pong):
+ *
+ *   | header (16) | record (8) | record (8) | ... | erased (0xFF) |
+ *
+ * Each parameter change is appended as a {key, crc16, value} record, so a
+ * bank absorbs thousands of writes before it has to be erased. When a bank
+ * fills up, the live values are compacted into the other bank, whose header
+ * is programmed last with a higher sequence number; a power loss mid-compaction
+ * therefore leaves the previous bank valid. The newest valid bank wins at boot
+ * and records replay in order (last write wins).
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define PARAM_STORAGE_VERSION		2U		// bump on semantic changes only (see migrate_record)
+#define PARAM_STORAGE_BANK_COUNT	2U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Parameter Storage Status Type
+  */
+typedef enum {
+	PARAM_STORAGE_OK			= 0x00U,
+	PARAM_STORAGE_ERROR_WARN	= 0x01U,
+	PARAM_STORAGE_ERROR_FATAL	= 0x02U
+} param_storage_status_t;
+
+/**
+  * @brief  Parameter Flash Interface Type
+  * 		NOTE: banks must be memory-mapped for reads; programming granularity
+  * 		is one 32-bit word and bits can only be cleared between erases
+  */
+typedef struct {
+	uint32_t bank_size;
+	const uint8_t *(*bank_addr)(uint8_t bank);
+	bool (*erase)(uint8_t bank);
+	bool (*program)(uint8_t bank, uint32_t offset, const uint32_t *words, uint32_t count);
+} param_flash_interface_t;
+
+/**
+  * @brief  Persisted Parameter Entry Type
+  */
+typedef struct {
+	uint16_t key;
+	uint32_t value;
+} param_entry_t;
+
+/**
+  * @brief  Record Apply Callback Type
+  * 		(returns false if a known key carries a rejected value)
+  */
+typedef bool (*param_apply_t)(uint16_t key, uint32_t value);
+
+/* Exported functions prototypes ---------------------------------------------*/
+param_storage_status_t param_storage_init(const param_flash_interface_t *flash);
+
+param_storage_status_t param_storage_load(param_apply_t apply);
+
+param_storage_status_t param_storage_save(const param_entry_t *changed, uint32_t changed_count,
+										  const param_entry_t *live, uint32_t live_count);
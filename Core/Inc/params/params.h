@@ -0,0 +1,201 @@
+/*
+ * params.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Parameter Status Type
+  */
+typedef enum {
+	PARAM_OK				= 0x00U,
+	PARAM_ERROR_WARN		= 0x01U,
+	PARAM_ERROR_FATAL		= 0x02U
+} param_status_t;
+
+/**
+  * @brief  Parameter ID Type (index into the registry, O(1) lookup)
+  * 		NOTE: each PID block follows pid_config_t field order
+  * 		(P, I, D, D LPF cutoff, command limit, integrator limit)
+  */
+typedef enum {
+	/* Attitude Estimation */
+	PARAM_COMP_FILT_GAIN_XL = 0,
+	PARAM_ROLL_TAKEOFF_LIMIT_DEG,
+	PARAM_PITCH_TAKEOFF_LIMIT_DEG,
+
+	/* Attitude PIDs */
+	PARAM_ROLL_ANGLE_P,
+	PARAM_ROLL_ANGLE_I,
+	PARAM_ROLL_ANGLE_D,
+	PARAM_ROLL_ANGLE_D_LPF_HZ,
+	PARAM_ROLL_ANGLE_CMD_LIM,
+	PARAM_ROLL_ANGLE_I_CMD_LIM,
+
+	PARAM_PITCH_ANGLE_P,
+	PARAM_PITCH_ANGLE_I,
+	PARAM_PITCH_ANGLE_D,
+	PARAM_PITCH_ANGLE_D_LPF_HZ,
+	PARAM_PITCH_ANGLE_CMD_LIM,
+	PARAM_PITCH_ANGLE_I_CMD_LIM,
+
+	PARAM_ROLL_RATE_P,
+	PARAM_ROLL_RATE_I,
+	PARAM_ROLL_RATE_D,
+	PARAM_ROLL_RATE_D_LPF_HZ,
+	PARAM_ROLL_RATE_CMD_LIM,
+	PARAM_ROLL_RATE_I_CMD_LIM,
+
+	PARAM_PITCH_RATE_P,
+	PARAM_PITCH_RATE_I,
+	PARAM_PITCH_RATE_D,
+	PARAM_PITCH_RATE_D_LPF_HZ,
+	PARAM_PITCH_RATE_CMD_LIM,
+	PARAM_PITCH_RATE_I_CMD_LIM,
+
+	PARAM_YAW_RATE_P,
+	PARAM_YAW_RATE_I,
+	PARAM_YAW_RATE_D,
+	PARAM_YAW_RATE_D_LPF_HZ,
+	PARAM_YAW_RATE_CMD_LIM,
+	PARAM_YAW_RATE_I_CMD_LIM,
+
+	/* Altitude Hold PIDs */
+	PARAM_ALT_POS_P,
+	PARAM_ALT_POS_I,
+	PARAM_ALT_POS_D,
+	PARAM_ALT_POS_D_LPF_HZ,
+	PARAM_ALT_POS_CMD_LIM,
+	PARAM_ALT_POS_I_CMD_LIM,
+
+	PARAM_ALT_VEL_P,
+	PARAM_ALT_VEL_I,
+	PARAM_ALT_VEL_D,
+	PARAM_ALT_VEL_D_LPF_HZ,
+	PARAM_ALT_VEL_CMD_LIM,
+	PARAM_ALT_VEL_I_CMD_LIM,
+
+	/* Altitude Hold */
+	PARAM_ALT_CLIMB_MAX_MPS,
+	PARAM_ALT_HOVER_THROTTLE_PCT,
+
+	/* Magnetometer (calibration written by a calibration session, see mag.h) */
+	PARAM_MAG_OFFSET_X,
+	PARAM_MAG_OFFSET_Y,
+	PARAM_MAG_OFFSET_Z,
+	PARAM_MAG_SOFT_XX,
+	PARAM_MAG_SOFT_XY,
+	PARAM_MAG_SOFT_XZ,
+	PARAM_MAG_SOFT_YY,
+	PARAM_MAG_SOFT_YZ,
+	PARAM_MAG_SOFT_ZZ,
+	PARAM_MAG_DECLINATION_DEG,
+	PARAM_MAG_HEADING_TAU_S,
+
+	/* Battery Monitor */
+	PARAM_BATT_VOLT_SCALE,
+	PARAM_BATT_CURR_SCALE,
+	PARAM_BATT_CURR_OFFSET_V,
+	PARAM_BATT_CELLS,
+
+	/* ESC Commands */
+	PARAM_ESC_CMD_IDLE_PCT,
+	PARAM_ESC_CMD_LIFTOFF_PCT,
+	PARAM_ESC_CMD_LIMIT_PCT,
+
+	/* RC Input */
+	PARAM_RC_PULSE_MIN_US,
+	PARAM_RC_PULSE_MAX_US,
+	PARAM_RC_ROLL_MAX_DEG,
+	PARAM_RC_ROLL_MAX_DPS,
+	PARAM_RC_PITCH_MAX_DEG,
+	PARAM_RC_PITCH_MAX_DPS,
+	PARAM_RC_YAW_MAX_DPS,
+	PARAM_RC_THROTTLE_IDLE_TOL_PCT,
+	PARAM_RC_MODE_SWITCH_HIGH,
+
+	/* System */
+	PARAM_SYS_BOOT_COUNT,
+
+	PARAM_COUNT
+} param_id_t;
+
+/**
+  * @brief  Parameter Value Type
+  */
+typedef enum {
+	PARAM_TYPE_FLOAT		= 0x00U,
+	PARAM_TYPE_U32			= 0x01U
+} param_type_t;
+
+/**
+  * @brief  Parameter Group Type (bitmask, used to route change notifications)
+  */
+typedef enum {
+	PARAM_GROUP_ATTITUDE	= (1U << 0),
+	PARAM_GROUP_PID			= (1U << 1),
+	PARAM_GROUP_ESC			= (1U << 2),
+	PARAM_GROUP_RC			= (1U << 3),
+	PARAM_GROUP_SYSTEM		= (1U << 4),
+	PARAM_GROUP_ALTITUDE	= (1U << 5),
+	PARAM_GROUP_MAG			= (1U << 6),
+	PARAM_GROUP_BATTERY		= (1U << 7)
+} param_group_t;
+
+/**
+  * @brief  Parameter Name Length (short keys: sent in MSG_PARAM_DESC and
+  * 		matched whole by name, so longer names are rejected at build time)
+  */
+#define PARAM_NAME_LEN_MAX			16U
+
+/**
+  * @brief  Parameter Flags
+  */
+#define PARAM_FLAG_DISARMED_ONLY	(1U << 0)	// may only change while disarmed
+#define PARAM_FLAG_READONLY			(1U << 1)	// maintained by the firmware, rejected over the link
+
+/**
+  * @brief  Parameter Definition Type
+  * 		NOTE: key is the stable id written to flash; it must never be reused
+  * 		for a different meaning, so ids can be reordered freely
+  */
+typedef struct {
+	const char *name;
+	uint16_t key;
+	uint8_t type;
+	uint8_t group;
+	uint8_t flags;
+	float min;
+	float max;
+	float def;
+} param_def_t;
+
+/**
+  * @brief  Parameter Change Listener Type (called after the new value is stored)
+  */
+typedef void (*param_listener_t)(param_id_t id);
+
+/* Exported functions prototypes ---------------------------------------------*/
+param_status_t params_init(void);
+
+const param_def_t *params_get_def(param_id_t id);
+
+float params_get_float(param_id_t id);
+
+uint32_t params_get_u32(param_id_t id);
+
+param_status_t params_set(param_id_t id, float value);
+
+param_status_t params_subscribe(uint32_t group_mask, param_listener_t listener);
+
+param_status_t params_save(void);
+
+bool params_is_dirty(void);
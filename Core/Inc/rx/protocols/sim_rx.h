@@ -0,0 +1,19 @@
+/*
+ * sim_rx.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include "rx/rx.h"
+
+/*
+ * Implemented by the host simulator (Sim/src/sim_rx.c); never linked into
+ * the firmware image.
+ */
+
+/* External variables --------------------------------------------------------*/
+extern const rx_protocol_interface_t sim_rx_driver;
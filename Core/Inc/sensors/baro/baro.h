@@ -0,0 +1,54 @@
+/*
+ * baro.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "stm32f4xx_hal.h"
+#include "sensors/sensor.h"
+
+/*
+ * Barometer interface.
+ *
+ * baro_read is called once per flight loop and never waits on the device:
+ * the driver triggers a conversion at CONFIG_BARO_RATE_HZ, lets the sensor
+ * convert while the loop runs, and fetches the result on the first loop after
+ * the conversion time. At most one short bus transaction happens per call;
+ * loops in between return at once with fresh cleared.
+ */
+
+/* Exported macros -----------------------------------------------------------*/
+#define BARO_OK				SENSOR_OK
+#define BARO_ERROR_WARN		SENSOR_ERROR_WARN
+#define BARO_ERROR_FATAL	SENSOR_ERROR_FATAL
+
+/* Exported aliases ----------------------------------------------------------*/
+typedef sensor_status_t baro_status_t;
+typedef sensor_interface_t baro_interface_t;
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Barometer Sample Type (compensated, fixed-point)
+  */
+typedef struct {
+	uint32_t pressure_cpa;		// pressure (0.01 Pa)
+	int32_t temperature_cdeg;	// die temperature (0.01 degC)
+	bool fresh;					// set on the read that delivered a new conversion
+} baro_data_t;
+
+/* External variables --------------------------------------------------------*/
+extern const I2C_HandleTypeDef* baro_phi2c;
+extern const void* baro_platform_handle;
+
+/* Exported functions --------------------------------------------------------*/
+baro_status_t baro_init(void);
+
+baro_status_t baro_deinit(void);
+
+baro_status_t baro_read(void *data);
@@ -0,0 +1,84 @@
+/*
+ * bmp3xx.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+#include "sensors/baro/baro.h"
+
+/*
+ * Bosch BMP388 / BMP390 barometer in forced mode.
+ *
+ * Each conversion is triggered by one register write and fetched by one 7-byte
+ * burst (status + pressure + temperature) once its datasheet conversion time
+ * has elapsed, measured with micros(); the loop never waits on the sensor.
+ * Compensation is the Bosch fixed-point variant (64-bit integer arithmetic,
+ * 0.01 Pa / 0.01 degC), exported for host tests.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define BMP3XX_I2C_ADD			(0x76U << 1)	// SDO low
+#define BMP388_CHIP_ID			0x50U
+#define BMP390_CHIP_ID			0x60U
+
+#define BMP3XX_REG_CHIP_ID		0x00U
+#define BMP3XX_REG_ERR			0x02U
+#define BMP3XX_REG_STATUS		0x03U			// followed by pressure and temperature data
+#define BMP3XX_REG_PWR_CTRL		0x1BU
+#define BMP3XX_REG_OSR			0x1CU
+#define BMP3XX_REG_CONFIG		0x1FU
+#define BMP3XX_REG_CALIB		0x31U
+#define BMP3XX_REG_CMD			0x7EU
+
+#define BMP3XX_CALIB_SIZE		21U
+#define BMP3XX_DATA_SIZE		7U				// status, pressure (3), temperature (3)
+
+#define BMP3XX_STATUS_DRDY_PRESS	0x20U
+#define BMP3XX_STATUS_DRDY_TEMP		0x40U
+#define BMP3XX_PWR_CTRL_FORCED		0x13U		// press_en | temp_en | forced mode
+#define BMP3XX_CMD_SOFT_RESET		0xB6U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Bus Override Type (register access in place of the platform bus,
+  * 		e.g. a fake register file for host tests)
+  */
+typedef struct {
+	int32_t (*read)(uint8_t reg, uint8_t *bufp, uint16_t len);
+	int32_t (*write)(uint8_t reg, const uint8_t *bufp, uint16_t len);
+} bmp3xx_bus_t;
+
+/**
+  * @brief  Calibration Coefficients Type (NVM integers, as stored)
+  */
+typedef struct {
+	uint16_t t1;
+	uint16_t t2;
+	int8_t t3;
+	int16_t p1;
+	int16_t p2;
+	int8_t p3;
+	int8_t p4;
+	uint16_t p5;
+	uint16_t p6;
+	int8_t p7;
+	int8_t p8;
+	int16_t p9;
+	int8_t p10;
+	int8_t p11;
+} bmp3xx_calib_t;
+
+/* External variables --------------------------------------------------------*/
+extern const baro_interface_t bmp3xx_driver;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void bmp3xx_set_bus(const bmp3xx_bus_t *bus);
+
+void bmp3xx_parse_calib(const uint8_t nvm[BMP3XX_CALIB_SIZE], bmp3xx_calib_t *cal);
+
+void bmp3xx_compensate(const bmp3xx_calib_t *cal, uint32_t raw_press, uint32_t raw_temp, baro_data_t *out);
+
+uint32_t bmp3xx_conversion_time_us(void);
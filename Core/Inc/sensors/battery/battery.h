@@ -0,0 +1,57 @@
+/*
+ * battery.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensors/sensor.h"
+#include "sensors/battery/battery_monitor.h"
+
+/*
+ * Battery interface.
+ *
+ * The device samples pack voltage and current continuously on its own (adc
+ * in circular dma); battery_read is called once per flight loop, never waits,
+ * and every CONFIG_BATT_PERIOD_MS takes the average of what was sampled and
+ * runs it through the monitor (battery_monitor.h): consumed charge, sag
+ * compensated resting voltage and the cell count. Between updates the last
+ * state is returned unchanged.
+ *
+ * Scaling is held in the BATT_* parameters; BATT_CELLS fixes the cell count
+ * (0: detected).
+ */
+
+/* Exported macros -----------------------------------------------------------*/
+#define BATTERY_OK				SENSOR_OK
+#define BATTERY_ERROR_WARN		SENSOR_ERROR_WARN
+#define BATTERY_ERROR_FATAL		SENSOR_ERROR_FATAL
+
+/* Exported aliases ----------------------------------------------------------*/
+typedef sensor_status_t battery_status_t;
+typedef sensor_interface_t battery_interface_t;
+typedef battery_state_t battery_data_t;
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Battery Scaling Type (device pin volts to pack volts / amps)
+  */
+typedef struct {
+	float volt_scale;			// pack volts per pin volt
+	float curr_scale;			// amps per pin volt
+	float curr_offset_v;		// pin volts at 0 A
+} battery_scaling_t;
+
+/* Exported functions --------------------------------------------------------*/
+battery_status_t battery_init(void);
+
+battery_status_t battery_deinit(void);
+
+battery_status_t battery_read(void *data);
+
+const battery_scaling_t *battery_get_scaling(void);
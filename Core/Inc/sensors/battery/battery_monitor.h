@@ -0,0 +1,89 @@
+/*
+ * battery_monitor.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Battery state from pack voltage and current samples (no hardware access).
+ *
+ * Under load the pack voltage sags by current x internal resistance, so the
+ * raw voltage says little about the charge left. The resistance (pack plus
+ * wiring) is estimated online from how the voltage follows current changes:
+ * both are high-passed, which removes the slow discharge, and the regression
+ * of one on the other is averaged over CONFIG_BATT_RES_TAU_S. The resting
+ * voltage, voltage + current x resistance, is low-passed over
+ * CONFIG_BATT_SAG_TAU_S and is what the cell voltage is taken from.
+ *
+ * The cell count is detected once, from the resting voltage after the pack
+ * has been present for CONFIG_BATT_DETECT_MS: the fewest cells that hold it
+ * at CONFIG_BATT_CELL_MAX_V each. That is exact up to 6S above ~3.63 V per
+ * cell; a 6S pack below that reads as 5S, so fix the count in BATT_CELLS for
+ * packs connected discharged. Consumed charge and energy are integrated
+ * (trapezoidal) from the first sample on.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define BATT_RES_HP_TAU_S			1.0f		// high-pass of the resistance regression
+#define BATT_RES_MIN_EXCITATION_A2	0.25f		// current variance needed to update the estimate
+#define BATT_RES_MAX_OHM			0.5f
+#define BATT_DT_MAX_S				0.1f		// longer gaps are integrated as this
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Battery Monitor Config Type
+  */
+typedef struct {
+	uint8_t cells;				// 0: detect
+	float cell_max_v;
+	float present_min_v;
+	uint32_t detect_ms;
+	float sag_tau_s;
+	float res_tau_s;
+} battery_monitor_config_t;
+
+/**
+  * @brief  Battery State Type
+  */
+typedef struct {
+	float voltage_v;			// pack, as measured
+	float current_a;
+	float rest_voltage_v;		// sag compensated, low-passed
+	float cell_voltage_v;		// rest voltage per cell (0 until the cell count is known)
+	float resistance_mohm;		// pack + wiring estimate (0 until excited)
+	float consumed_mah;
+	float energy_wh;
+	uint8_t cells;				// 0 until detected
+	bool present;				// voltage above the present threshold
+} battery_state_t;
+
+/**
+  * @brief  Battery Monitor Type
+  */
+typedef struct {
+	battery_monitor_config_t cfg;
+	float v_hp_lpf;				// regression high-pass states
+	float i_hp_lpf;
+	float var_i;				// averaged high-passed current variance..
+	float cov_vi;				// ..and voltage / current covariance
+	float resistance_ohm;
+	float rest_v;
+	float prev_current_a;
+	uint32_t present_ms;		// time the pack has been present (detection)
+	bool started;
+	battery_state_t state;
+} battery_monitor_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void battery_monitor_init(battery_monitor_t *m, const battery_monitor_config_t *cfg);
+
+void battery_monitor_set_cells(battery_monitor_t *m, uint8_t cells);
+
+void battery_monitor_update(battery_monitor_t *m, float voltage_v, float current_a, float dt_s);
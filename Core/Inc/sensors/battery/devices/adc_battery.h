@@ -0,0 +1,29 @@
+/*
+ * adc_battery.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include "sensors/battery/battery.h"
+
+/*
+ * Pack voltage divider on PC4 (ADC1 IN14) and current sensor output on PC5
+ * (ADC1 IN15).
+ *
+ * ADC1 scans both channels continuously (480 cycle sampling at 21 MHz: ~21k
+ * scans/s) into a ring in circular dma (DMA2 stream 0 channel 0); nothing is
+ * serviced per conversion. adc_battery_read averages the whole ring, ~256
+ * scans over the last ~12 ms: the F405 adc has no oversampling unit, so this
+ * takes its place, and averages out the esc switching ripple with it.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define ADC_BATTERY_RING_SCANS	256U
+#define ADC_BATTERY_FULL_SCALE	4095.0f
+
+/* External variables --------------------------------------------------------*/
+extern const battery_interface_t adc_battery_driver;
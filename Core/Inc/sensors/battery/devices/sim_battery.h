@@ -0,0 +1,19 @@
+/*
+ * sim_battery.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include "sensors/battery/battery.h"
+
+/*
+ * Implemented by the host simulator (Sim/src/sim_battery.c); never linked
+ * into the firmware image.
+ */
+
+/* External variables --------------------------------------------------------*/
+extern const battery_interface_t sim_battery_driver;
@@ -0,0 +1,87 @@
+/*
+ * gps.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensors/sensor.h"
+
+/*
+ * GPS receiver interface.
+ *
+ * The receiver streams into a circular DMA buffer on USART1 (PA9 TX, PA10 RX,
+ * DMA2 stream 2), so reception needs no interrupt and no cpu time. gps_read is
+ * called once per flight loop: it hands the bytes that arrived since the last
+ * call straight from the DMA buffer to the incremental parser (gps_parser.h)
+ * and returns with fresh set when a navigation solution completed.
+ *
+ * A u-blox receiver is switched to CONFIG_GPS_BAUD and UBX NAV-PVT at
+ * CONFIG_GPS_RATE_HZ at init; any other receiver is read as NMEA (GGA + RMC) at
+ * CONFIG_GPS_BAUD. The receiver is optional: without one no solution is ever
+ * fresh, and the position estimate stays invalid.
+ */
+
+/* Exported macros -----------------------------------------------------------*/
+#define GPS_OK				SENSOR_OK
+#define GPS_ERROR_WARN		SENSOR_ERROR_WARN
+#define GPS_ERROR_FATAL		SENSOR_ERROR_FATAL
+
+/* Exported aliases ----------------------------------------------------------*/
+typedef sensor_status_t gps_status_t;
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  GPS Fix Type
+  */
+typedef enum {
+	GPS_FIX_NONE	= 0x00U,
+	GPS_FIX_2D		= 0x02U,
+	GPS_FIX_3D		= 0x03U
+} gps_fix_t;
+
+/**
+  * @brief  GPS Navigation Solution Type (fixed-point, as the receiver reports it)
+  * 		NOTE: nmea has no accuracy estimates (h_acc is hdop * CONFIG_GPS_NMEA_UERE_M,
+  * 		the others 0) and no vertical velocity (0)
+  */
+typedef struct {
+	int32_t lat_e7;				// latitude (1e-7 deg)
+	int32_t lon_e7;				// longitude (1e-7 deg)
+	int32_t alt_msl_mm;			// height above mean sea level
+	int32_t vel_ned_mms[3];		// north, east, down
+	uint32_t h_acc_mm;			// horizontal position accuracy
+	uint32_t v_acc_mm;			// vertical position accuracy
+	uint32_t s_acc_mms;			// speed accuracy
+	uint32_t time_ms;			// ubx: gps time of week, nmea: utc time of day
+	uint8_t fix;				// gps_fix_t
+	uint8_t num_sv;				// satellites used
+	bool vel_valid;				// velocity belongs to this solution
+	bool fresh;					// set on the read that completed a new solution
+} gps_data_t;
+
+/**
+  * @brief  GPS Stream Statistics Type
+  */
+typedef struct {
+	uint32_t bytes;
+	uint32_t messages;			// complete messages with a valid checksum (any type)
+	uint32_t solutions;
+	uint32_t checksum_errors;
+	uint32_t framing_errors;	// oversized or malformed messages (parser resynced)
+	uint32_t overruns;			// reads too late for the dma buffer (bytes lost)
+} gps_stats_t;
+
+/* Exported functions --------------------------------------------------------*/
+gps_status_t gps_init(void);
+
+gps_status_t gps_deinit(void);
+
+gps_status_t gps_read(void *data);
+
+void gps_get_stats(gps_stats_t *out);
@@ -0,0 +1,95 @@
+/*
+ * gps_parser.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensors/gps/gps.h"
+
+/*
+ * Incremental UBX / NMEA parser.
+ *
+ * Bytes are consumed one at a time, wherever they lie (e.g. in place in the
+ * dma buffer), and decoded as they arrive: UBX NAV-PVT payload words land in
+ * the solution at their offsets, NMEA fields are accumulated digit by digit.
+ * No message or sentence is ever buffered, so a message split across any
+ * number of reads decodes the same as one fed whole. Both protocols may be
+ * interleaved on one stream; a solution is only published once its checksum
+ * verified.
+ *
+ * NMEA epochs publish on GGA (position, fix, satellites, hdop) and take the
+ * velocity from the RMC of the same time of day (RMC comes first on common
+ * receivers); a GGA fix is reported as 3D.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define UBX_SYNC1				0xB5U
+#define UBX_SYNC2				0x62U
+#define UBX_FRAME_OVERHEAD		8U			// sync (2), class, id, length (2), checksum (2)
+
+#define UBX_CLASS_NAV			0x01U
+#define UBX_CLASS_ACK			0x05U
+#define UBX_CLASS_CFG			0x06U
+#define UBX_ID_NAV_PVT			0x07U
+#define UBX_ID_CFG_PRT			0x00U
+#define UBX_ID_CFG_MSG			0x01U
+#define UBX_ID_CFG_RATE			0x08U
+
+#define UBX_NAV_PVT_LEN			92U
+#define UBX_PAYLOAD_MAX			1024U		// longer frames are taken as a lost sync
+#define NMEA_SENTENCE_MAX		96U			// 82 by the standard, some receivers run over
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  GPS Parser State Type (owned by the caller)
+  */
+typedef struct {
+	uint8_t state;
+	uint8_t ck_a;				// ubx fletcher checksum / nmea xor checksum
+	uint8_t ck_b;
+	uint8_t msg_class;
+	uint8_t msg_id;
+	uint16_t length;			// ubx payload length / nmea sentence length so far
+	uint16_t offset;			// ubx payload offset
+	uint32_t word;				// ubx little-endian word being assembled
+
+	/* NMEA Field Accumulator */
+	uint8_t sentence;			// sentence type (GGA, RMC, other)
+	uint8_t field;				// field index (0 is the talker / sentence id)
+	uint32_t tag;				// last three characters of the sentence id
+	int32_t mantissa;			// field digits, decimal point removed
+	uint8_t frac_digits;		// digits after the decimal point (kept)
+	bool fraction;				// past the decimal point
+	bool negative;
+	bool digits;				// field has digits
+	char first;					// first character of the field
+
+	/* NMEA Epoch Staging (RMC velocity, GGA hdop) */
+	uint32_t rmc_time_ms;
+	int32_t rmc_speed;			// knots, 3 fraction digits
+	int32_t rmc_course;			// deg, 2 fraction digits
+	bool rmc_valid;
+	bool rmc_ok;				// last RMC verified (velocity usable)
+	uint32_t rmc_ok_time_ms;
+	int32_t rmc_vel_ne_mms[2];
+	uint32_t hdop_c;			// hdop (0.01)
+
+	gps_data_t work;			// solution being decoded (published on a valid checksum)
+	gps_stats_t stats;
+} gps_parser_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void gps_parser_init(gps_parser_t *p);
+
+uint32_t gps_parser_feed(gps_parser_t *p, const uint8_t *buf, uint32_t len, gps_data_t *out);
+
+uint32_t gps_parser_feed_ring(gps_parser_t *p, const uint8_t *ring, uint32_t size, uint32_t *tail,
+							  uint32_t head, gps_data_t *out);
+
+uint32_t ubx_frame(uint8_t msg_class, uint8_t msg_id, const uint8_t *payload, uint16_t len, uint8_t *out);
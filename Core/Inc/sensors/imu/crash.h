@@ -0,0 +1,75 @@
+/*
+ * crash.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensors/imu/imu.h"
+
+/*
+ * Crash detection in the imu (LSM6DSOX finite state machine).
+ *
+ * Three fsm programs (lsm6dsox_fsm.h) watch the sensor at 104 Hz with no MCU
+ * load:
+ *
+ *   - impact: accel norm above CONFIG_CRASH_IMPACT_G
+ *   - tumble: gyro norm above CONFIG_CRASH_TUMBLE_DPS for CONFIG_CRASH_TUMBLE_MS
+ *   - free-fall: accel norm below CONFIG_CRASH_FREEFALL_G for
+ *     CONFIG_CRASH_FREEFALL_MS
+ *
+ * Impact and tumble (and free-fall if CONFIG_CRASH_FREEFALL_DISARM) pull the
+ * imu INT1 pin (PB0, EXTI0 at the top priority); the isr disarms the escs
+ * right away if they are armed and latches the crash. It locks them
+ * (esc_lock), so a motor command write the interrupt landed in is undone and
+ * no arming gets through before the flight loop sees the latch; the loop
+ * then keeps the motors off (flight_data_t.kill) until the arm switch is
+ * reset, which releases the lock. Free-fall is otherwise only reported: a throttle cut dive reads the
+ * same. crash_service reads which program fired (a bus read, so not in the
+ * isr) right after an interrupt and every 100 ms otherwise, and reports
+ * WARN for each detection.
+ *
+ * Detection is optional (CONFIG_CRASH_DETECT) and disabled by default: the
+ * programs are hand-assembled, so check them on the bench (drop, knock and
+ * spin the board disarmed, watch the health events) before enabling it.
+ */
+
+/* Exported macros -----------------------------------------------------------*/
+#define CRASH_OK				IMU_OK
+#define CRASH_ERROR_WARN		IMU_ERROR_WARN
+#define CRASH_ERROR_FATAL		IMU_ERROR_FATAL
+
+/**
+  * @brief  Crash Events (fsm program order; bit n is program n)
+  */
+#define CRASH_EVENT_IMPACT		0x0001U
+#define CRASH_EVENT_TUMBLE		0x0002U
+#define CRASH_EVENT_FREEFALL	0x0004U
+
+/* Exported aliases ----------------------------------------------------------*/
+typedef imu_status_t crash_status_t;
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Crash State Type
+  */
+typedef struct {
+	bool latched;				// motors cut by a crash: kept off until the arm switch is reset
+	bool disarmed;				// the isr disarmed the escs since the last service
+	uint16_t events;			// CRASH_EVENT_* seen since init
+	uint32_t detections;		// program firings since init
+	uint32_t disarms;			// isr disarms since init
+	uint32_t disarm_cycles;		// last isr disarm: entry to motors stopped (cpu cycles)
+} crash_state_t;
+
+/* Exported functions --------------------------------------------------------*/
+crash_status_t crash_init(void);
+
+crash_status_t crash_service(bool arm_switch_off, crash_state_t *state);
+
+void crash_irq_handler(void);
@@ -7,7 +7,91 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include "sensors/imu/imu.h"
+#include "sensors/imu/devices/lsm6dsox_config.h"
+#include "sensors/imu/devices/lsm6dsox_fsm.h"
+
+/*
+ * Samples are read from the FIFO: accel, gyro and a timestamp are batched at
+ * the output data rate and fetched with one status read plus one burst per
+ * loop. The sensor hub master can read an external sensor on the aux i2c bus
+ * by itself (lsm6dsox_hub_attach); its bytes arrive in the same FIFO burst, so
+ * they cost the flight loop no bus transaction of their own.
+ *
+ * The output data rate, the on-chip gyro and accel filters and the FIFO
+ * batch rate are derived from the flight loop rate at init
+ * (lsm6dsox_config.h), so the anti-aliasing is done in the sensor.
+ *
+ * Finite state machine programs (lsm6dsox_fsm.h) can be loaded into the
+ * embedded functions (lsm6dsox_fsm_load); they run on the sensor's samples
+ * without the MCU and can pull the INT1 pin.
+ *
+ * Up to LSM6DSOX_INSTANCES sensors are driven, each with its own bus, fifo and
+ * timestamp state (the bus it was bound on, lsm6dsox_set_platform or
+ * lsm6dsox_set_instance_bus; the secondary is SA0 high by default). The sensor hub and the finite state
+ * machine run on the primary instance only.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define LSM6DSOX_HUB_DATA_LEN	6U		// bytes per sensor hub fifo word (slave 0)
+#define LSM6DSOX_INSTANCES		2U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Device Instance Type
+  */
+typedef enum {
+	LSM6DSOX_PRIMARY = 0U,
+	LSM6DSOX_SECONDARY = 1U
+} lsm6dsox_instance_t;
+
+/**
+  * @brief  Bus Override Type (register access in place of the platform bus,
+  * 		e.g. a fake register file for benchmarks)
+  */
+typedef struct {
+	int32_t (*read)(uint8_t reg, uint8_t *bufp, uint16_t len);
+	int32_t (*write)(uint8_t reg, const uint8_t *bufp, uint16_t len);
+} lsm6dsox_bus_t;
+
+/**
+  * @brief  Sensor Hub Slave Type (read by the hub master at its own rate)
+  */
+typedef struct {
+	uint8_t addr;		// 7-bit i2c address
+	uint8_t reg;		// first register (read with auto-increment)
+	uint8_t len;		// bytes (1..LSM6DSOX_HUB_DATA_LEN)
+} lsm6dsox_hub_slave_t;
 
 /* External variables --------------------------------------------------------*/
 extern const imu_interface_t lsm6dsox_driver;
+extern const imu_interface_t lsm6dsox_secondary_driver;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void lsm6dsox_set_bus(const lsm6dsox_bus_t *bus);
+
+void lsm6dsox_set_instance_bus(lsm6dsox_instance_t instance, const lsm6dsox_bus_t *bus);
+
+void lsm6dsox_set_platform(lsm6dsox_instance_t instance, const void *handle, uint8_t i2c_addr);
+
+imu_status_t lsm6dsox_set_loop_rate(uint32_t loop_hz);
+
+const lsm6dsox_config_t* lsm6dsox_get_config(void);
+
+imu_status_t lsm6dsox_hub_write(uint8_t addr, uint8_t reg, uint8_t value);
+
+imu_status_t lsm6dsox_hub_read(uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len);
+
+imu_status_t lsm6dsox_hub_attach(const lsm6dsox_hub_slave_t *slave);
+
+void lsm6dsox_hub_detach(void);
+
+bool lsm6dsox_hub_get(uint8_t buf[LSM6DSOX_HUB_DATA_LEN]);
+
+uint32_t lsm6dsox_hub_errors(void);
+
+imu_status_t lsm6dsox_fsm_load(const lsm6dsox_fsm_program_t *programs, uint8_t count, lsm6dsox_fsm_odr_t odr,
+							   uint16_t int1_mask);
+
+imu_status_t lsm6dsox_fsm_status(uint16_t *fired);
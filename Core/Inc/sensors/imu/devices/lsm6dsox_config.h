@@ -0,0 +1,64 @@
+/*
+ * lsm6dsox_config.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "lsm6dsox_reg.h"
+
+/*
+ * LSM6DSOX output data rate, on-chip filter and FIFO configuration derived
+ * from the flight loop rate (no hardware access).
+ *
+ * The flight loop takes one gyro and one accel sample per iteration, so the
+ * loop rate is the rate the signal is finally sampled at; anything above its
+ * Nyquist frequency that reaches the loop aliases into the control band. The
+ * FIFO batches at the lowest batch data rate (BDR) at or above the loop rate,
+ * from filters running at the output data rate (ODR), so the on-chip filters
+ * are the anti-alias filter of the decimation and the MCU filters nothing:
+ *
+ *   - gyro: the ODR (at or above the loop rate) and LPF1 bandwidth giving the
+ *     widest band below both the loop Nyquist frequency and the requested
+ *     cutoff (CONFIG_GY_LPF_CUTOFF_FREQ_HZ); the lowest such ODR
+ *   - accel: LPF1 + LPF2 path, the ODR divider closest to the requested
+ *     cutoff (CONFIG_XL_LPF_CUTOFF_FREQ_HZ), kept below the loop Nyquist
+ *     frequency
+ *   - FIFO watermark: the gyro, accel and timestamp words of one loop
+ *
+ * Bandwidths are the typical -3 dB figures of the datasheet.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define LSM6DSOX_LOOP_HZ_MIN		12U			// slowest loop the fifo can batch for
+#define LSM6DSOX_LOOP_HZ_MAX		6667U		// fastest (the top batch rate)
+#define LSM6DSOX_FIFO_WORDS_MAX		24U			// fifo words a read may take (4 loops at 2 batches per loop)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  LSM6DSOX Derived Configuration Type
+  */
+typedef struct {
+	uint32_t loop_hz;
+	lsm6dsox_odr_g_t odr_gy;			// gyro and accel run at the same odr
+	lsm6dsox_odr_xl_t odr_xl;
+	float odr_hz;
+	lsm6dsox_bdr_gy_t bdr_gy;			// fifo batch data rate
+	lsm6dsox_bdr_xl_t bdr_xl;
+	float bdr_hz;
+	bool gy_lpf1;						// false: no choice at this odr (fixed bandwidth)
+	lsm6dsox_ftype_t gy_ftype;
+	float gy_bw_hz;
+	lsm6dsox_hp_slope_xl_en_t xl_lpf2;
+	float xl_bw_hz;
+	uint16_t fifo_watermark;			// words per loop
+	uint16_t fifo_max_words;			// more unread is taken for a stall (the fifo is restarted)
+} lsm6dsox_config_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+bool lsm6dsox_derive_config(uint32_t loop_hz, float gy_cutoff_hz, float xl_cutoff_hz, lsm6dsox_config_t *cfg);
@@ -0,0 +1,61 @@
+/*
+ * lsm6dsox_fsm.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * LSM6DSOX finite state machine (FSM) program encoding (no hardware access).
+ *
+ * The FSM runs up to 16 small programs inside the sensor at its own rate
+ * (FSM ODR, up to 104 Hz) on the accel or gyro samples; a program that
+ * reaches its CONT instruction raises its status bit and, if routed, the
+ * INT1 pin (lsm6dsox_fsm_load). The layout follows ST AN5273: a fixed part
+ * (CONFIG_A, CONFIG_B, SIZE, SETTINGS, reset and program pointers), the
+ * variable data the instructions use (thresholds as half precision floats
+ * in g or dps, masks, timers), then one byte per instruction (reset
+ * condition in the high nibble, next condition in the low one).
+ *
+ * The one program built here watches the norm of a sensor's vector (axis V):
+ *
+ *   - wait for the norm to cross the threshold (above or below)
+ *   - hold it there for a number of samples, else back to the wait
+ *   - CONT: status bit and interrupt, then wait again
+ *
+ * which is a free-fall (accel norm below ~0.3 g), an impact (accel norm above
+ * a few g) or a tumble (gyro norm above the commanded rates, held).
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define LSM6DSOX_FSM_PROGRAMS_MAX	16U
+#define LSM6DSOX_FSM_PROGRAM_MAX	16U			// bytes per program built here
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  FSM Input Type (SETTINGS IN_SEL)
+  */
+typedef enum {
+	LSM6DSOX_FSM_IN_XL		= 0x00U,		// g
+	LSM6DSOX_FSM_IN_GY		= 0x01U			// dps
+} lsm6dsox_fsm_input_t;
+
+/**
+  * @brief  FSM Program Type
+  */
+typedef struct {
+	uint8_t bytes[LSM6DSOX_FSM_PROGRAM_MAX];
+	uint8_t len;
+} lsm6dsox_fsm_program_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+uint16_t lsm6dsox_fsm_half(float value);
+
+bool lsm6dsox_fsm_norm_program(lsm6dsox_fsm_program_t *prog, lsm6dsox_fsm_input_t input, bool above,
+							   float threshold, uint8_t samples);
@@ -8,6 +8,7 @@
 #pragma once
 
 /* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
 #include <stdint.h>
 #include "stm32f4xx_hal.h"
 #include "sensors/sensor.h"
@@ -32,6 +33,8 @@ typedef struct imuSixDOF {
 	uint32_t dt;
 } imu_6D_t;
 
+struct imuInstanceStats;		// imu_instance_stats_t (sensors/imu/imu_vote.h)
+
 /* External variables --------------------------------------------------------*/
 extern const I2C_HandleTypeDef* phi2c;
 // extern const SPI_HandleTypeDef* phspi;
@@ -43,3 +46,11 @@ imu_status_t imu_init(void);
 imu_status_t imu_deinit(void);
 
 imu_status_t imu_read(void *data);
+
+uint8_t imu_get_count(void);
+
+uint8_t imu_get_primary(void);
+
+uint32_t imu_get_failovers(void);
+
+bool imu_get_stats(uint8_t instance, struct imuInstanceStats *out);
@@ -0,0 +1,110 @@
+/*
+ * imu_vote.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensors/imu/imu.h"
+
+/*
+ * Redundant imu samples voted into one (no hardware access).
+ *
+ * Each loop every instance's sample and read status go in:
+ *
+ *   - a failed read is skipped that loop; CONFIG_IMU_VOTE_FAULT_MS of them in
+ *     a row fail the instance (READ)
+ *   - a sample repeated bit for bit on all six axes for CONFIG_IMU_STUCK_MS
+ *     fails it (STUCK; sensor noise alone never repeats that long)
+ *   - with three usable instances the output is the per-axis median; one off
+ *     the median by more than the tolerance for CONFIG_IMU_VOTE_FAULT_MS
+ *     fails (DIVERGED)
+ *   - with two it is their mean while they agree; when they disagree there
+ *     is no telling which is wrong, so the primary alone is used and the
+ *     disagreement only counted
+ *   - with one it is passed through
+ *
+ * The primary (dt source, tie-break) is the lowest instance not failed and
+ * stays so until it fails. Failures latch until init. The last instance left
+ * is never failed: its faults are counted but it is still used, there being
+ * nothing to fail over to.
+ *
+ * Failover costs no loop: the other instances are read every loop, so the
+ * output switches to them in the same update, by at most the tolerance the
+ * voting held them to.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define IMU_VOTE_INSTANCES_MAX		3U
+#define IMU_VOTE_AXES				6U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Instance State Type
+  */
+typedef enum {
+	IMU_INSTANCE_OFFLINE = 0U,		// not fitted, or its init failed
+	IMU_INSTANCE_OK = 1U,
+	IMU_INSTANCE_FAILED = 2U		// latched until init
+} imu_instance_state_t;
+
+/**
+  * @brief  Instance Fault Type (last fault seen)
+  */
+typedef enum {
+	IMU_FAULT_NONE = 0U,
+	IMU_FAULT_READ = 1U,
+	IMU_FAULT_STUCK = 2U,
+	IMU_FAULT_DIVERGED = 3U
+} imu_instance_fault_t;
+
+/**
+  * @brief  IMU Vote Config Type
+  */
+typedef struct {
+	float gy_tol_mdps;			// deviation allowed from the voted rates..
+	float xl_tol_mg;			// ..and accels (any axis)
+	uint32_t fault_loops;		// failed reads / divergent samples in a row to fail
+	uint32_t stuck_loops;		// repeated samples in a row to fail
+} imu_vote_config_t;
+
+/**
+  * @brief  Instance Stats Type
+  */
+typedef struct imuInstanceStats {
+	imu_instance_state_t state;
+	imu_instance_fault_t fault;
+	uint32_t reads;
+	uint32_t read_errors;
+	uint32_t disagreements;		// samples off the voted output beyond tolerance
+	float gy_dev_mdps;			// last deviation from the voted output (largest axis)
+	float xl_dev_mg;
+	float gy_dev_max_mdps;		// since init
+	float xl_dev_max_mg;
+} imu_instance_stats_t;
+
+/**
+  * @brief  IMU Vote Type
+  */
+typedef struct {
+	imu_vote_config_t cfg;
+	uint8_t count;
+	uint8_t primary;
+	uint32_t failovers;			// primary changes since init
+	imu_6D_t prev[IMU_VOTE_INSTANCES_MAX];			// stuck detection
+	uint32_t error_run[IMU_VOTE_INSTANCES_MAX];
+	uint32_t stuck_run[IMU_VOTE_INSTANCES_MAX];
+	uint32_t diverge_run[IMU_VOTE_INSTANCES_MAX];
+	bool have_prev[IMU_VOTE_INSTANCES_MAX];
+	imu_instance_stats_t stats[IMU_VOTE_INSTANCES_MAX];
+} imu_vote_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void imu_vote_init(imu_vote_t *v, const imu_vote_config_t *cfg, uint8_t count, uint32_t online_mask);
+
+imu_status_t imu_vote_update(imu_vote_t *v, const imu_6D_t samples[], const imu_status_t status[], imu_6D_t *out);
@@ -0,0 +1,40 @@
+/*
+ * lis2mdl.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+#include "sensors/mag/mag.h"
+
+/*
+ * ST LIS2MDL magnetometer on the LSM6DSOX aux i2c bus (sensor hub slave 0).
+ *
+ * Set up through one-shot hub transactions at init (the imu must be up), then
+ * read by the hub at 104 Hz in continuous mode (100 Hz output data rate) and
+ * batched into the imu fifo: lis2mdl_read only picks up what the last imu read
+ * brought along. Mounted with its axes along the imu's.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define LIS2MDL_I2C_ADD_7BIT	0x1EU
+#define LIS2MDL_ID				0x40U
+
+#define LIS2MDL_REG_WHO_AM_I	0x4FU
+#define LIS2MDL_REG_CFG_A		0x60U
+#define LIS2MDL_REG_CFG_B		0x61U
+#define LIS2MDL_REG_CFG_C		0x62U
+#define LIS2MDL_REG_OUTX_L		0x68U			// x, y, z (little-endian)
+
+#define LIS2MDL_CFG_A_SOFT_RST	0x20U
+#define LIS2MDL_CFG_A_VALUE		0x8CU			// temperature compensation, 100 Hz, continuous
+#define LIS2MDL_CFG_B_VALUE		0x02U			// offset cancellation
+#define LIS2MDL_CFG_C_VALUE		0x10U			// block data update
+
+#define LIS2MDL_DATA_SIZE		6U
+#define LIS2MDL_MGAUSS_PER_LSB	1.5f
+
+/* External variables --------------------------------------------------------*/
+extern const mag_interface_t lis2mdl_driver;
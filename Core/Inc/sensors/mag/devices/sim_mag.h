@@ -0,0 +1,19 @@
+/*
+ * sim_mag.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include "sensors/mag/mag.h"
+
+/*
+ * Implemented by the host simulator (Sim/src/sim_mag.c); never linked into
+ * the firmware image.
+ */
+
+/* External variables --------------------------------------------------------*/
+extern const mag_interface_t sim_mag_driver;
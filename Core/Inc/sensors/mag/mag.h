@@ -0,0 +1,79 @@
+/*
+ * mag.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensors/sensor.h"
+#include "sensors/mag/mag_cal.h"
+
+/*
+ * Magnetometer interface.
+ *
+ * mag_read is called once per flight loop after imu_read and never touches a
+ * bus: the device sits behind the imu's sensor hub, which reads it on its own
+ * and hands the bytes over with the imu fifo. Readings are corrected with the
+ * hard / soft-iron calibration held in the MAG_* parameters (mag_cal.h).
+ *
+ * A calibration session (mag_calibration_start, disarmed only) collects the
+ * raw readings while the craft is turned through all orientations, fits them
+ * when the time is up, and stores the result in the parameters if the fit is
+ * good (MSG_PARAM_SAVE persists it).
+ */
+
+/* Exported macros -----------------------------------------------------------*/
+#define MAG_OK				SENSOR_OK
+#define MAG_ERROR_WARN		SENSOR_ERROR_WARN
+#define MAG_ERROR_FATAL		SENSOR_ERROR_FATAL
+
+/* Exported aliases ----------------------------------------------------------*/
+typedef sensor_status_t mag_status_t;
+typedef sensor_interface_t mag_interface_t;
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Magnetometer Sample Type (body frame, as the imu)
+  */
+typedef struct {
+	float field_mgauss[3];		// calibrated
+	float raw_mgauss[3];
+	bool fresh;					// set on the read that delivered a new sample
+} mag_data_t;
+
+/**
+  * @brief  Calibration Session State Type
+  */
+typedef enum {
+	MAG_CAL_STATE_IDLE			= 0x00U,
+	MAG_CAL_STATE_RUNNING		= 0x01U,
+	MAG_CAL_STATE_DONE			= 0x02U,	// fit stored in the parameters
+	MAG_CAL_STATE_FAILED		= 0x03U		// see result
+} mag_cal_state_t;
+
+/**
+  * @brief  Calibration Session Report Type
+  */
+typedef struct {
+	mag_cal_state_t state;
+	mag_cal_result_t result;	// of the last fit
+	mag_cal_fit_t fit;
+} mag_cal_report_t;
+
+/* Exported functions --------------------------------------------------------*/
+mag_status_t mag_init(void);
+
+mag_status_t mag_deinit(void);
+
+mag_status_t mag_read(void *data);
+
+bool mag_calibration_start(uint32_t duration_s);
+
+bool mag_calibration_is_running(void);
+
+void mag_calibration_get(mag_cal_report_t *out);
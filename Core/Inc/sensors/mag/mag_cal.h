@@ -0,0 +1,102 @@
+/*
+ * mag_cal.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Hard / soft-iron calibration fit.
+ *
+ * Raw readings of a constant field, taken while the craft is turned through
+ * all orientations, lie on an ellipsoid: shifted by the hard-iron offset and
+ * stretched by soft iron. A general quadric
+ *
+ *   a x^2 + b y^2 + c z^2 + 2d xy + 2e xz + 2f yz + 2g x + 2h y + 2i z = 1
+ *
+ * is least-squares fitted to them. Only power sums of the readings are kept
+ * (no samples are stored), so a session can run as long as needed; the fit is
+ * made about the middle of the readings, which keeps the origin inside the
+ * ellipsoid however large the offset. Its center is the offset, and the
+ * matrix that maps the ellipsoid back onto a sphere (of the geometric mean
+ * radius, keeping the field strength) is the soft-iron correction:
+ *
+ *   calibrated = soft_iron * (raw - offset)
+ *
+ * The fit is refused when the samples do not span all three axes, when the
+ * quadric is no ellipsoid, or when it is too eccentric or too poor to trust.
+ * Sums are in double precision with the readings in gauss: fourth powers of
+ * a float in mG lose the residual.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define MAG_CAL_MIN_SAMPLES			100U
+#define MAG_CAL_MIN_SPAN			0.4f		// per-axis sample spread, share of the widest axis spread
+#define MAG_CAL_MAX_AXIS_RATIO		2.0f		// longest / shortest ellipsoid axis
+#define MAG_CAL_MAX_FIT_ERROR_PCT	5.0f		// rms radial residual
+#define MAG_CAL_MIN_FIELD_MGAUSS	100.0f		// earth's field is 250..650 mG
+#define MAG_CAL_MAX_FIELD_MGAUSS	1500.0f
+
+#define MAG_CAL_TERMS				9U
+#define MAG_CAL_ORDER				5U			// power sums up to the fourth
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Calibration Fit Result Type
+  */
+typedef enum {
+	MAG_CAL_OK					= 0x00U,
+	MAG_CAL_TOO_FEW_SAMPLES		= 0x01U,
+	MAG_CAL_POOR_COVERAGE		= 0x02U,	// an axis was not turned through
+	MAG_CAL_SINGULAR			= 0x03U,
+	MAG_CAL_NOT_ELLIPSOID		= 0x04U,
+	MAG_CAL_DISTORTED			= 0x05U,	// axis ratio above MAG_CAL_MAX_AXIS_RATIO
+	MAG_CAL_POOR_FIT			= 0x06U,
+	MAG_CAL_FIELD_RANGE			= 0x07U
+} mag_cal_result_t;
+
+/**
+  * @brief  Calibration Type (calibrated = soft_iron * (raw - offset))
+  */
+typedef struct {
+	float offset_mgauss[3];
+	float soft_iron[3][3];		// symmetric
+} mag_calibration_t;
+
+/**
+  * @brief  Calibration Fit Type
+  */
+typedef struct {
+	mag_calibration_t cal;
+	float field_mgauss;			// radius after calibration
+	float fit_error_pct;
+	float axis_ratio;
+	uint32_t samples;
+} mag_cal_fit_t;
+
+/**
+  * @brief  Calibration Accumulator Type
+  */
+typedef struct {
+	double sums[MAG_CAL_ORDER][MAG_CAL_ORDER][MAG_CAL_ORDER];	// sum of x^i y^j z^k (gauss), i + j + k <= 4
+	float min_mgauss[3];
+	float max_mgauss[3];
+	uint32_t samples;
+} mag_cal_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void mag_cal_reset(mag_cal_t *cal);
+
+void mag_cal_add(mag_cal_t *cal, const float raw_mgauss[3]);
+
+mag_cal_result_t mag_cal_solve(const mag_cal_t *cal, mag_cal_fit_t *fit);
+
+void mag_cal_apply(const mag_calibration_t *cal, const float raw_mgauss[3], float out_mgauss[3]);
+
+void mag_cal_identity(mag_calibration_t *cal);
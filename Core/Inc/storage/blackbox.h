@@ -0,0 +1,89 @@
+/*
+ * blackbox.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "sensors/imu/imu.h"
+#include "flight/attitude.h"
+#include "flight/rc_input.h"
+#include "esc/esc.h"
+
+/*
+ * Blackbox Frame Encoder
+ *
+ * Compresses one flight loop record per frame. Every field is quantized to an
+ * integer with a fixed scale (imu fields at the sensor resolution, so they
+ * round-trip exactly), then written as
+ *
+ *   I frame (keyframe, every BLACKBOX_KEYFRAME_INTERVAL frames): 'I', values
+ *   P frame: 'P', value minus prediction per field
+ *
+ * Predictions are the previous value, or a straight line through the last two
+ * (2 * prev - prev2) for fields that change at a steady rate, like the loop
+ * time. Residuals are zigzag mapped (0, -1, 1, -2 .. -> 0, 1, 2, 3 ..) and
+ * written as LEB128 varints (7 bits per byte), so a quiet field costs one
+ * byte instead of four. Arithmetic wraps modulo 2^32, so any value decodes
+ * exactly.
+ *
+ * The field definitions are written once, ahead of the first frame
+ * (little endian):
+ *
+ *   | "AQCB" | version u8 | field count u8 | keyframe interval u16 |
+ *   | per field: predictor u8 | type u8 | scale f32 (units per count) | name, NUL |
+ *
+ * Encoding is one pass over the fields with at most 5 bytes per field, so a
+ * frame costs a fixed number of cycles (budget: BENCH_BLACKBOX_ENCODE). If a
+ * frame cannot be written whole, drop it and call blackbox_reset: the next
+ * frame is a keyframe, so the decoder never predicts from a lost frame.
+ * Tools/blackbox_decode.py turns a log into CSV or columns.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define BLACKBOX_MAGIC			"AQCB"
+#define BLACKBOX_VERSION		1U
+#define BLACKBOX_FRAME_I		'I'
+#define BLACKBOX_FRAME_P		'P'
+#define BLACKBOX_FIELD_COUNT	23U
+#define BLACKBOX_FRAME_MAX		(1U + BLACKBOX_FIELD_COUNT * 5U)	// marker, 32 bit varints
+#define BLACKBOX_HEADER_MAX		512U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Blackbox Predictor Type (P frames)
+  */
+typedef enum {
+	BLACKBOX_PREDICT_PREVIOUS	= 0x00U,
+	BLACKBOX_PREDICT_LINEAR		= 0x01U		// 2 * prev - prev2
+} blackbox_predictor_t;
+
+/**
+  * @brief  Blackbox Field Type (how the decoder reads the counts)
+  */
+typedef enum {
+	BLACKBOX_TYPE_SIGNED		= 0x00U,	// float, quantized to signed counts of scale
+	BLACKBOX_TYPE_UNSIGNED		= 0x01U		// uint32 as is (wraps, e.g. time)
+} blackbox_type_t;
+
+/**
+  * @brief  Blackbox Record Type (one per armed loop iteration)
+  */
+typedef struct {
+	uint32_t time_us;		// micros(), low word (log header clock_us maps it to wall time)
+	imu_6D_t imu;
+	attitude_est_t est;
+	rc_reqs_t req;
+	mtr_cmds_t mcmd;
+} blackbox_record_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void blackbox_reset(void);
+
+uint32_t blackbox_write_header(uint8_t *out, uint32_t size);
+
+uint32_t blackbox_encode(const blackbox_record_t *rec, uint8_t *out);
@@ -0,0 +1,21 @@
+/*
+ * sim_sd_card.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include "storage/sd_stream.h"
+
+/*
+ * RAM-backed sd card with a timing model (command overhead, per-block write
+ * time, erase cost unless pre-erased, occasional long busy periods).
+ * Implemented by the host simulator (Sim/src/sim_sd_card.c); never linked
+ * into the firmware image.
+ */
+
+/* External variables --------------------------------------------------------*/
+extern const sd_card_interface_t sim_sd_card;
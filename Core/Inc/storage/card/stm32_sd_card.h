@@ -0,0 +1,21 @@
+/*
+ * stm32_sd_card.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include "storage/sd_stream.h"
+#include "storage/msc.h"
+
+/* External variables --------------------------------------------------------*/
+extern const sd_card_interface_t stm32_sd_card;
+extern const msc_disk_interface_t stm32_sd_disk;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void stm32_sd_card_tx_complete(void);
+
+void stm32_sd_card_rx_complete(void);
@@ -0,0 +1,81 @@
+/*
+ * log_file.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "storage/sd_stream.h"
+#include "system/rtc.h"
+
+/*
+ * Flight Log Files
+ *
+ * One file per armed period (LOG00001.BIN, LOG00002.BIN, ..). Before arming the
+ * file is preallocated as one contiguous cluster run (f_expand) and synced, so
+ * the directory entry and FAT are final before takeoff. Its cluster map is
+ * read once with FatFs fast seek and the data region is handed to sd_stream,
+ * which writes it block-direct: no FAT or directory update while armed. On
+ * disarm the stream is drained and the file is truncated to the bytes written
+ * and closed, i.e. one FAT/directory update per flight.
+ *
+ * Every log starts with a log_file_header_t: the boot id, the wall time (if
+ * the rtc was set) and micros() at the same instant, so the microsecond
+ * timestamps of the records map to wall time and logs of one boot can be
+ * ordered even without a wall clock (see rtc.h).
+ *
+ *   log_file_start(&stm32_sd_card, size, &ref);	// before arm (blocking, file system access)
+ *   log_file_write(data, len);				// flight loop (whole records)
+ *   log_file_service();					// flight loop
+ *   log_file_stop();						// disarm (blocking, file system access)
+ *
+ * The volume must be mounted; nothing else may use the file system between
+ * start and stop.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define LOG_FILE_NAME_LEN	13U		// 8.3 name and terminator (no lfn)
+#define LOG_FILE_MAGIC		"AQCL"
+#define LOG_FILE_VERSION	1U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Log File Status Type
+  */
+typedef enum {
+	LOG_FILE_OK				= 0x00U,
+	LOG_FILE_ERROR_WARN		= 0x01U,	// bytes dropped, file full or preallocation shortened
+	LOG_FILE_ERROR_FATAL	= 0x02U		// no file (file system or card error)
+} log_file_status_t;
+
+/**
+  * @brief  Log File Header Type (first bytes of every log, little endian)
+  */
+typedef struct __attribute__((packed)) {
+	char magic[4];			// LOG_FILE_MAGIC
+	uint16_t version;		// LOG_FILE_VERSION
+	uint16_t header_size;	// sizeof(log_file_header_t), records follow
+	uint32_t log_index;		// LOGnnnnn.BIN
+	uint32_t boot_id;
+	uint32_t unix_s;		// wall time (0 if the rtc was not set)
+	uint32_t unix_us;
+	uint64_t clock_us;		// micros() at unix_s.unix_us
+} log_file_header_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+log_file_status_t log_file_start(const sd_card_interface_t *card, uint32_t size, const rtc_time_ref_t *ref);
+
+uint32_t log_file_write(const void *data, uint32_t len);
+
+log_file_status_t log_file_service(void);
+
+log_file_status_t log_file_stop(void);
+
+bool log_file_is_open(void);
+
+const char *log_file_name(void);
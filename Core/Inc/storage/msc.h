@@ -0,0 +1,115 @@
+/*
+ * msc.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * USB Mass Storage (Bulk-Only Transport, SCSI transparent command set)
+ *
+ * Serves one logical unit (the sd card) to a usb host. The engine only sees
+ * two interfaces: a pair of bulk endpoints (msc_usb_interface_t, the usb class
+ * in comms/usb_msc.c) and a block device (msc_disk_interface_t, the sdio
+ * driver in storage/card/stm32_sd_card.c), so the host simulator runs it
+ * unmodified against a ram disk (Sim/src/msc_main.c).
+ *
+ * READ(10) / WRITE(10) move data through two SRAM buffers of MSC_BUFFER_BLOCKS
+ * blocks each: one multi-block dma transfer fills a buffer while the other is
+ * on the bus, so the card and the usb endpoint overlap instead of taking turns.
+ * Both sides complete from their isrs and only set flags; all state advances
+ * in msc_service, which never waits on either side.
+ *
+ *   msc_open(&usb, &stm32_sd_disk, read_only);
+ *   msc_service();					// main loop
+ *   msc_ejected();					// host sent START STOP UNIT (eject)
+ *   msc_close();
+ *
+ * Nothing else may access the card (FatFs, sd_stream) between open and close.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define MSC_BLOCK_SIZE			512U
+#define MSC_BUFFER_BLOCKS		16U		// 8 KB per card / usb transfer
+#define MSC_BUFFER_COUNT		2U		// double buffered (SRAM: the sdio dma cannot reach CCM)
+#define MSC_BUFFER_SIZE			(MSC_BUFFER_BLOCKS * MSC_BLOCK_SIZE)
+#define MSC_PACKET_SIZE			64U		// full speed bulk endpoint
+#define MSC_CBW_LENGTH			31U
+#define MSC_CSW_LENGTH			13U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  MSC Status Type
+  */
+typedef enum {
+	MSC_OK				= 0x00U,
+	MSC_ERROR_WARN		= 0x01U,	// phase error (host and device disagree on a transfer)
+	MSC_ERROR_FATAL		= 0x02U		// card transfer error, or no card
+} msc_status_t;
+
+/**
+  * @brief  MSC USB Interface Type (bulk-only endpoint pair)
+  * 		NOTE: send / receive start one transfer of up to len bytes (a short
+  * 		packet ends a receive early); the class reports their end with
+  * 		msc_usb_sent / msc_usb_received (isr context allowed). stall halts
+  * 		the in or out endpoint until the host clears it.
+  */
+typedef struct {
+	bool (*send)(const uint8_t *buf, uint32_t len);
+	bool (*receive)(uint8_t *buf, uint32_t len);
+	void (*stall)(bool in);
+} msc_usb_interface_t;
+
+/**
+  * @brief  MSC Disk Interface Type
+  * 		NOTE: read / write start an asynchronous transfer of count blocks
+  * 		to / from a word-aligned buffer; the driver reports its end with
+  * 		msc_disk_done (isr context allowed). ready must not block and is
+  * 		false while the card is busy. poll is optional, for drivers without
+  * 		a completion interrupt.
+  */
+typedef struct {
+	bool (*ready)(void);
+	uint32_t (*block_count)(void);		// 0 if no card
+	bool (*read)(uint32_t *buf, uint32_t block, uint32_t count);
+	bool (*write)(const uint32_t *buf, uint32_t block, uint32_t count);
+	void (*poll)(void);					// NULL if completion is interrupt driven
+} msc_disk_interface_t;
+
+/**
+  * @brief  MSC Statistics Type (since msc_open)
+  */
+typedef struct {
+	uint32_t commands;
+	uint32_t failed;			// check condition or phase error
+	uint32_t bytes_read;		// card -> host
+	uint32_t bytes_written;		// host -> card
+	uint32_t overlapped;		// buffers filled while the other was in flight
+} msc_stats_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+msc_status_t msc_open(const msc_usb_interface_t *usb, const msc_disk_interface_t *disk, bool read_only);
+
+void msc_close(void);
+
+msc_status_t msc_service(void);
+
+bool msc_ejected(void);
+
+void msc_get_stats(msc_stats_t *out);
+
+void msc_usb_sent(void);
+
+void msc_usb_received(uint32_t len);
+
+void msc_usb_halt_cleared(bool in);
+
+void msc_usb_reset(void);		// interface configured, or bulk-only mass storage reset
+
+void msc_disk_done(bool ok);
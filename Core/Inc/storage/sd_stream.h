@@ -0,0 +1,99 @@
+/*
+ * sd_stream.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * SD Streaming Writer
+ *
+ * Appends a byte stream to a contiguous run of card blocks, bypassing FatFs
+ * for the data itself. Bytes are copied into a ring of block-aligned segments;
+ * full segments are queued and written by sd_stream_service with one
+ * pre-erased (ACMD23) multi-block write (CMD25) per run of adjacent segments.
+ * The transfer runs on DMA and completes from the card driver's callback, so
+ * neither sd_stream_write nor sd_stream_service ever waits on the card. When
+ * the ring is full, new bytes are dropped and counted instead of blocking the
+ * flight loop.
+ *
+ *   sd_stream_open(&stm32_sd_card, first_block, block_count);
+ *   sd_stream_write(data, len);				// any context but isrs
+ *   sd_stream_service();						// main loop
+ *   sd_stream_close(); while (!sd_stream_idle()) sd_stream_service();
+ *
+ * The region must be owned by the caller (e.g. a preallocated file), and
+ * FatFs must not access the card while a transfer is in flight.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define SD_BLOCK_SIZE				512U
+#define SD_STREAM_SEGMENT_BLOCKS	16U		// 8 KB per segment
+#define SD_STREAM_SEGMENT_COUNT		4U		// ring of 32 KB (SRAM: the sdio dma cannot reach CCM)
+#define SD_STREAM_SEGMENT_SIZE		(SD_STREAM_SEGMENT_BLOCKS * SD_BLOCK_SIZE)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  SD Stream Status Type
+  */
+typedef enum {
+	SD_STREAM_OK			= 0x00U,
+	SD_STREAM_ERROR_WARN	= 0x01U,	// bytes dropped (ring full) or region full
+	SD_STREAM_ERROR_FATAL	= 0x02U		// card error, stream stopped
+} sd_stream_status_t;
+
+/**
+  * @brief  SD Card Interface Type
+  * 		NOTE: write starts an asynchronous transfer of count blocks from a
+  * 		word-aligned buffer, pre-erasing count blocks first; the driver
+  * 		reports its end with sd_stream_write_done (isr context allowed).
+  * 		ready must not block and is false while the card is programming.
+  * 		poll is optional, for drivers without a completion interrupt.
+  */
+typedef struct {
+	bool (*ready)(void);
+	bool (*write)(const uint32_t *buf, uint32_t block, uint32_t count);
+	void (*poll)(void);			// NULL if completion is interrupt driven
+} sd_card_interface_t;
+
+/**
+  * @brief  SD Stream Statistics Type (since sd_stream_open)
+  */
+typedef struct {
+	uint32_t bytes_written;		// bytes on the card (incl. flush padding)
+	uint32_t bytes_dropped;		// ring full or region full
+	uint32_t transfers;			// multi-block writes completed
+	uint32_t errors;
+	uint32_t latency_avg_us;	// write start -> transfer complete
+	uint32_t latency_max_us;
+	uint32_t throughput_kbps;	// bytes written per second of transfer time (KB/s)
+} sd_stream_stats_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+sd_stream_status_t sd_stream_open(const sd_card_interface_t *card, uint32_t first_block, uint32_t block_count);
+
+uint32_t sd_stream_write(const void *data, uint32_t len);
+
+uint32_t sd_stream_space(void);
+
+void sd_stream_discard(uint32_t len);
+
+sd_stream_status_t sd_stream_service(void);
+
+void sd_stream_flush(void);
+
+void sd_stream_close(void);
+
+bool sd_stream_idle(void);
+
+uint32_t sd_stream_position(void);
+
+void sd_stream_get_stats(sd_stream_stats_t *out);
+
+void sd_stream_write_done(bool ok);
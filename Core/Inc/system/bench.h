@@ -0,0 +1,85 @@
+/*
+ * bench.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Flight Kernel Benchmarks
+ *
+ * Times each per-loop kernel in batches of calls with the cycle counter
+ * (DWT on target, nanoseconds on the host; see common/cycles.h). Kernels
+ * that are static to their module are timed through their only caller:
+ *
+ *   complementary_filter			-> attitude_estimator_update
+ *   map_pulse_to_state_request		-> rc_get_requests (4 channels per call)
+ *
+ * lsm6dsox_read runs against a fake register file (lsm6dsox_set_bus), so
+ * it measures the driver, not the i2c transfer; each call drains a gyro,
+ * accel and timestamp word from the fake fifo. esc_set_motor_commands is
+ * fed the minimum command, so motors stay stopped. altitude_controller_update
+ * runs engaged in altitude hold, so its cost per call is the cascade averaged
+ * over the loops it is decimated from; it is reset afterwards.
+ * gps_parser_feed is fed a canned NAV-PVT stream in 28 byte chunks (about
+ * what arrives per loop at 115200 baud). position_estimator_update runs
+ * aligned, with a gps solution every 42nd call (10 Hz at the loop rate).
+ * attitude_heading_update gets a magnetometer sample every 4th call (the
+ * sensor hub rate). crc8 checks one esc telemetry frame per call;
+ * esc_telemetry_parser_feed is polled and fed one frame per call (one motor
+ * answering per loop), so each call includes the request bookkeeping.
+ *
+ * Each kernel has a cycle budget per call (F405 cycles, bench.c). aqc_bench
+ * fails when the best batch exceeds it; on the host, where a cycle is a
+ * nanosecond, the budgets only catch gross regressions.
+ *
+ * Requires every flight module to be initialized and the esc started. On
+ * target, enable CONFIG_BENCH and read the results with MSG_BENCH_GET; on
+ * the host, run Sim/build/aqc_bench.
+ */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Benchmarked Kernel Type
+  */
+typedef enum {
+	BENCH_PID_UPDATE				= 0x00U,
+	BENCH_COMPLEMENTARY_FILTER		= 0x01U,
+	BENCH_MIXER_UPDATE				= 0x02U,
+	BENCH_THRUST_COMPENSATE			= 0x03U,
+	BENCH_MAP_PULSE_TO_STATE_REQUEST	= 0x04U,
+	BENCH_ESC_SET_MOTOR_COMMANDS	= 0x05U,
+	BENCH_LSM6DSOX_READ				= 0x06U,
+	BENCH_BLACKBOX_ENCODE			= 0x07U,
+	BENCH_ALTITUDE_CONTROLLER		= 0x08U,
+	BENCH_GPS_PARSER_FEED			= 0x09U,
+	BENCH_POSITION_ESTIMATOR		= 0x0AU,
+	BENCH_HEADING_UPDATE			= 0x0BU,
+	BENCH_CRC8						= 0x0CU,
+	BENCH_ESC_TLM_PARSER_FEED		= 0x0DU,
+	BENCH_COUNT
+} bench_id_t;
+
+/**
+  * @brief  Benchmark Result Type (cycles per batch of calls)
+  */
+typedef struct {
+	const char *name;		// function timed
+	uint32_t calls;			// calls per batch
+	uint32_t batches;
+	uint32_t min;
+	uint32_t avg;
+	uint32_t max;
+	uint32_t budget;		// cycles per call
+} bench_result_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void bench_run(void);
+
+bool bench_get(bench_id_t id, bench_result_t *out);
@@ -0,0 +1,87 @@
+/*
+ * driver_registry.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/*
+ * Device drivers bound at boot instead of selected at compile time.
+ *
+ * Each driver registers an entry (DRIVER_REGISTER) next to its interface: a
+ * class, a probe, a bind hook and its const interface per device instance.
+ * The entries are collected by the linker into the aqc_drivers section (the
+ * firmware linker scripts keep it in flash), so no table lists them and
+ * linking a driver in is all it takes.
+ *
+ * At init each module binds its class with driver_bind: every entry of the
+ * class is probed on the module's bus and the highest score wins (the first
+ * linked on a tie). A probe reads an identity off the device and writes
+ * nothing (a WHO_AM_I register), not even to its own driver's state; the
+ * winner alone is handed the bus through its bind hook. A driver that
+ * cannot be detected has no probe and is bound as the fallback. The module
+ * then calls the interface it got, so a bound driver costs what a
+ * compile-time selected one did.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define DRIVER_SECTION				"aqc_drivers"
+#define DRIVER_INSTANCES_MAX		2U
+
+#define DRIVER_SCORE_NONE			0U		// not on the bus
+#define DRIVER_SCORE_FALLBACK		1U		// no probe: bound if nothing is detected
+#define DRIVER_SCORE_DETECTED		100U	// identity read back
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Driver Class Type
+  */
+typedef enum {
+	DRIVER_CLASS_IMU = 0U,		// imu_interface_t
+	DRIVER_CLASS_RX = 1U,		// rx_protocol_interface_t
+	DRIVER_CLASS_ESC = 2U,		// esc_protocol_interface_t
+	DRIVER_CLASS_COUNT
+} driver_class_t;
+
+/**
+  * @brief  Probe Bus Type
+  */
+typedef struct {
+	const void *handle;			// platform bus handle (NULL: none)
+	uint8_t address;			// device address on it (0: the driver's default)
+	uint8_t instance;			// device instance to bind
+} driver_bus_t;
+
+/**
+  * @brief  Driver Entry Type
+  */
+typedef struct {
+	const char *name;
+	driver_class_t cls;
+	uint8_t instances;										// interfaces below (1..DRIVER_INSTANCES_MAX)
+	uint8_t (*probe)(const driver_bus_t *bus);				// score (NULL: DRIVER_SCORE_FALLBACK)
+	void (*bind)(const driver_bus_t *bus);					// takes the bus once bound (NULL: nothing to set)
+	const void *interfaces[DRIVER_INSTANCES_MAX];			// const interface per instance
+} driver_entry_t;
+
+/* Exported macro functions --------------------------------------------------*/
+/**
+  * @brief  Registers a driver entry (define it at file scope):
+  * 		DRIVER_REGISTER(name_entry) = {.name = ..., .cls = ..., ...};
+  * 		NOTE: aligned to its type so the compiler pads nothing between entries
+  */
+#define DRIVER_REGISTER(ident) \
+	static const driver_entry_t ident \
+	__attribute__((used, section(DRIVER_SECTION), aligned(__alignof__(driver_entry_t))))
+
+/* Exported functions prototypes ---------------------------------------------*/
+uint32_t driver_count(void);
+
+const driver_entry_t* driver_get(uint32_t index);
+
+const driver_entry_t* driver_bind(driver_class_t cls, const driver_bus_t *bus);
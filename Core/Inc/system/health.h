@@ -0,0 +1,108 @@
+/*
+ * health.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "system/error.h"
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Health Reporting Module Type (event source)
+  */
+typedef enum {
+	HEALTH_MODULE_SYSTEM	= 0x00U,
+	HEALTH_MODULE_RX		= 0x01U,
+	HEALTH_MODULE_RC		= 0x02U,
+	HEALTH_MODULE_IMU		= 0x03U,
+	HEALTH_MODULE_ATTITUDE	= 0x04U,
+	HEALTH_MODULE_ESC		= 0x05U,
+	HEALTH_MODULE_STORAGE	= 0x06U,
+	HEALTH_MODULE_PARAMS	= 0x07U,
+	HEALTH_MODULE_BARO		= 0x08U,
+	HEALTH_MODULE_GPS		= 0x09U,
+	HEALTH_MODULE_MAG		= 0x0AU,
+	HEALTH_MODULE_BATTERY	= 0x0BU,
+	HEALTH_MODULE_ESC_TLM	= 0x0CU,
+	HEALTH_MODULE_CRASH		= 0x0DU,
+	HEALTH_MODULE_CONTROL	= 0x0EU,	// attitude controller (HEALTH_MODULE_ATTITUDE: estimator)
+	HEALTH_MODULE_ALTITUDE	= 0x0FU,
+	HEALTH_MODULE_POSITION	= 0x10U,
+	HEALTH_MODULE_ALT_HOLD	= 0x11U,
+	HEALTH_MODULE_COUNT
+} health_module_t;
+
+/**
+  * @brief  Health Event Severity Type (matches module status values)
+  */
+typedef enum {
+	HEALTH_SEVERITY_INFO	= STATUS_OK,
+	HEALTH_SEVERITY_WARN	= STATUS_ERROR_WARN,
+	HEALTH_SEVERITY_FATAL	= STATUS_ERROR_FATAL
+} health_severity_t;
+
+/**
+  * @brief  Health Event Code Type
+  */
+typedef enum {
+	HEALTH_CODE_NONE				= 0x0000U,
+	HEALTH_CODE_STATUS				= 0x0001U,	// module API returned a non-OK status
+	HEALTH_CODE_ISR_UNEXPECTED_IC	= 0x0002U,	// input capture on unsupported TIMx/channel
+	HEALTH_CODE_ISR_UNEXPECTED_EXTI	= 0x0003U,	// external interrupt on unsupported pin
+	HEALTH_CODE_EVENTS_DROPPED		= 0x0004U,	// event ring overflowed
+	HEALTH_CODE_PERSIST_FAILED		= 0x0005U	// summary could not be written to storage
+} health_code_t;
+
+/**
+  * @brief  Health Event Type (8 bytes, copied by value through the event ring)
+  */
+typedef struct {
+	uint32_t timestamp_ms;
+	uint8_t module;
+	uint8_t severity;
+	uint16_t code;
+} health_event_t;
+
+/**
+  * @brief  Per-Module Health Counters Type (counts include dropped events; the
+  * 		last code and time are of the last event drained, as one pair)
+  */
+typedef struct {
+	uint32_t warn_count;
+	uint32_t fatal_count;
+	uint16_t last_code;
+	uint32_t last_timestamp_ms;
+} health_counters_t;
+
+/* Exported macro functions --------------------------------------------------*/
+/**
+  * @brief  records a non-OK module status then applies the fatal error check
+  */
+#define HEALTH_CHECK(module, status) \
+	do { \
+		health_report((module), (uint32_t)(status)); \
+		CHECK(status); \
+	} while (0)
+
+/* Exported functions prototypes ---------------------------------------------*/
+void health_init(void);
+
+bool health_record(health_module_t module, health_severity_t severity, health_code_t code);
+
+void health_report(health_module_t module, uint32_t status);
+
+void health_get_counters(health_module_t module, health_counters_t *out);
+
+uint32_t health_get_dropped(void);
+
+uint32_t health_read_events(uint32_t *cursor, health_event_t *out, uint32_t max);
+
+void health_service(void);
+
+void health_persist(void);
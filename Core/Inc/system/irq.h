@@ -0,0 +1,100 @@
+/*
+ * irq.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx_hal.h"
+#include "common/settings.h"
+
+/*
+ * Interrupt Priority Map (NVIC_PRIORITYGROUP_4: 16 preemption levels, no
+ * sub-priorities; lower number preempts higher)
+ *
+ *   1  EXTI0				imu INT1: crash detection, disarms in the isr
+ *   2  SysTick				millis(), hal timeouts
+ *   3  TIM2 / TIM3			rx pulse input capture
+ *   4  EXTI2 / EXTI3		rx arm / mode switches
+ *   8  SDIO				sd card transfer state
+ *   9  DMA2 Stream3 / 6	sd card rx / tx dma
+ *  10  OTG_FS				usb link
+ *
+ * Everything the flight loop depends on preempts storage and usb, so an sd
+ * transfer completing can no longer delay an rx edge or the tick. Level 0 is
+ * left free. irq_init applies this table at boot; the .ioc NVIC page (and the
+ * code it generates) mirrors it so regeneration does not disagree.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define IRQ_PRIORITY_GROUP			NVIC_PRIORITYGROUP_4
+
+#define IRQ_PRIO_IMU_INT			1U
+#define IRQ_PRIO_TICK				2U
+#define IRQ_PRIO_RX_CAPTURE			3U
+#define IRQ_PRIO_RX_SWITCH			4U
+#define IRQ_PRIO_SD					8U
+#define IRQ_PRIO_SD_DMA				9U
+#define IRQ_PRIO_USB				10U
+
+#define IRQ_LATENCY_TEST			CONFIG_IRQ_LATENCY_TEST
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Latency Test Source Type (sources with a measurable event time)
+  */
+typedef enum {
+	IRQ_SRC_TICK		= 0x00U,	// systick reload, cycle accurate
+	IRQ_SRC_RX_TIM2		= 0x01U,	// input capture edge, timer tick (1 us) resolution
+	IRQ_SRC_RX_TIM3		= 0x02U,
+	IRQ_SRC_RX_EXTI2	= 0x03U,	// software-triggered line, cycle accurate
+	IRQ_SRC_RX_EXTI3	= 0x04U,
+	IRQ_SRC_COUNT
+} irq_source_t;
+
+/**
+  * @brief  Latency Statistics Type (event -> isr entry, cpu cycles)
+  */
+typedef struct {
+	uint32_t count;
+	uint32_t avg;
+	uint32_t max;
+} irq_latency_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void irq_init(void);
+
+bool irq_latency_get(irq_source_t src, irq_latency_t *out);
+
+void irq_latency_reset(void);
+
+#if (IRQ_LATENCY_TEST == ENABLED)
+void irq_latency_tick(void);
+
+void irq_latency_timer_enter(const TIM_TypeDef *tim);
+
+void irq_latency_capture(const TIM_TypeDef *tim, uint32_t ccr);
+
+void irq_latency_exti(uint16_t pin);
+
+void irq_latency_service(void);
+#else
+/* Exported static inline functions ------------------------------------------*/
+/**
+  * @brief isr hooks compile away unless the latency test is enabled
+  */
+static inline void irq_latency_tick(void) {}
+
+static inline void irq_latency_timer_enter(const TIM_TypeDef *tim) { (void) tim; }
+
+static inline void irq_latency_capture(const TIM_TypeDef *tim, uint32_t ccr) { (void) tim; (void) ccr; }
+
+static inline void irq_latency_exti(uint16_t pin) { (void) pin; }
+
+static inline void irq_latency_service(void) {}
+#endif
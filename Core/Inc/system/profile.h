@@ -0,0 +1,41 @@
+/*
+ * profile.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Profiled Section Type
+  */
+typedef enum {
+	PROFILE_LOOP		= 0x00U,	// whole flight_update (incl. rc and imu reads)
+	PROFILE_CONTROL		= 0x01U,	// estimator -> controller -> mixer
+	PROFILE_LOG			= 0x02U,	// blackbox encode and log write (armed only)
+	PROFILE_COUNT
+} profile_id_t;
+
+/**
+  * @brief  Cycle Statistics Type (since boot or last reset)
+  */
+typedef struct {
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+	uint32_t avg;
+} profile_stats_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void profile_init(void);
+
+void profile_reset(void);
+
+void profile_record(profile_id_t id, uint32_t cycles);
+
+void profile_get(profile_id_t id, profile_stats_t *out);
@@ -0,0 +1,73 @@
+/*
+ * rtc.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Real-Time Clock, Boot Counter and Time References
+ *
+ * The rtc holds UTC wall time once it was set over the link (MSG_TIME_SET).
+ * It runs on the LSE crystal if one is fitted (CONFIG_RTC_LSE), else on LSI
+ * (about +-5%, enough to order and correlate flights), and keeps counting
+ * across resets while the backup domain stays powered. The boot counter is
+ * persisted with the parameters (SYS_BOOT_COUNT), so it survives power loss.
+ *
+ * A time reference pairs wall time with micros() at one instant, so
+ * microsecond timestamps recorded after it map to wall time:
+ *
+ *   wall_us = unix_s * 1000000 + unix_us + (t_us - clock_us)
+ */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  RTC Status Type
+  */
+typedef enum {
+	RTC_OK				= 0x00U,
+	RTC_ERROR_WARN		= 0x01U,	// boot count not persisted
+	RTC_ERROR_FATAL		= 0x02U		// no rtc clock (wall time unavailable)
+} rtc_status_t;
+
+/**
+  * @brief  RTC Clock Source Type
+  */
+typedef enum {
+	RTC_SOURCE_NONE		= 0x00U,
+	RTC_SOURCE_LSE		= 0x01U,
+	RTC_SOURCE_LSI		= 0x02U
+} rtc_source_t;
+
+/**
+  * @brief  Time Reference Type
+  */
+typedef struct {
+	uint32_t boot_id;		// boot counter
+	uint32_t unix_s;		// wall time (0 if the rtc was never set)
+	uint32_t unix_us;		// sub-second part (rtc resolution ~4 ms)
+	uint64_t clock_us;		// micros() at the same instant
+} rtc_time_ref_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+rtc_status_t rtc_init(void);
+
+bool rtc_is_set(void);
+
+rtc_source_t rtc_get_source(void);
+
+rtc_status_t rtc_set_unix(uint32_t unix_s);
+
+uint32_t rtc_get_unix(uint32_t *unix_us);
+
+uint32_t rtc_boot_id(void);
+
+void rtc_get_time_ref(rtc_time_ref_t *out);
+
+uint32_t rtc_get_fattime(void);
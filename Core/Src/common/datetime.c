@@ -0,0 +1,117 @@
+/*
+ * datetime.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include "common/datetime.h"
+
+/**
+  * @brief  Calendar Constants
+  */
+#define SECONDS_PER_DAY			86400U
+#define DAYS_PER_ERA			146097U		// 400 gregorian years
+#define DAYS_0000_TO_1970		719468U		// from 0000-03-01 (era origin) to 1970-01-01
+#define WEEKDAY_1970			4U			// thursday (monday = 1)
+
+#define FAT_YEAR_MIN			1980U
+#define FAT_YEAR_MAX			2107U
+
+
+/**
+  * @brief helper function to check for a leap year
+  *
+  * @retval boolean
+  */
+static inline bool is_leap(uint32_t year) {
+	return ((year % 4U) == 0U) && (((year % 100U) != 0U) || ((year % 400U) == 0U));
+}
+
+/**
+  * @brief helper function to get the length of a month
+  *
+  * @retval days
+  */
+static inline uint8_t month_days(uint32_t year, uint32_t month) {
+	static const uint8_t days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+	return ((month == 2U) && is_leap(year)) ? 29U : days[month - 1U];
+}
+
+/**
+  * @brief converts unix time to date and time
+  * 	   NOTE: eras start on march 1st, so the leap day ends a year
+  *
+  * @param  unix_s	seconds since 1970-01-01 00:00:00
+  * @param	out		date / time buffer to be filled
+  *
+  * @retval None
+  */
+void datetime_from_unix(uint32_t unix_s, datetime_t *out) {
+	uint32_t days = unix_s / SECONDS_PER_DAY;
+	uint32_t secs = unix_s % SECONDS_PER_DAY;
+	uint32_t z = days + DAYS_0000_TO_1970;
+	uint32_t era = z / DAYS_PER_ERA;
+	uint32_t doe = z - era * DAYS_PER_ERA;
+	uint32_t yoe = (doe - doe / 1460U + doe / 36524U - doe / 146096U) / 365U;
+	uint32_t doy = doe - (365U * yoe + yoe / 4U - yoe / 100U);
+	uint32_t mp = (5U * doy + 2U) / 153U;
+	uint32_t month = (mp < 10U) ? mp + 3U : mp - 9U;
+
+	out->year = (uint16_t) (yoe + era * 400U + ((month <= 2U) ? 1U : 0U));
+	out->month = (uint8_t) month;
+	out->day = (uint8_t) (doy - (153U * mp + 2U) / 5U + 1U);
+	out->hour = (uint8_t) (secs / 3600U);
+	out->minute = (uint8_t) ((secs / 60U) % 60U);
+	out->second = (uint8_t) (secs % 60U);
+	out->weekday = (uint8_t) ((days + WEEKDAY_1970 - 1U) % 7U + 1U);
+}
+
+/**
+  * @brief converts date and time to unix time (weekday is ignored)
+  *
+  * @param  dt		read-only pointer to a valid date / time
+  * @retval seconds since 1970-01-01 00:00:00
+  */
+uint32_t datetime_to_unix(const datetime_t *dt) {
+	uint32_t year = dt->year - ((dt->month <= 2U) ? 1U : 0U);
+	uint32_t era = year / 400U;
+	uint32_t yoe = year - era * 400U;
+	uint32_t doy = (153U * ((dt->month > 2U) ? dt->month - 3U : dt->month + 9U) + 2U) / 5U + dt->day - 1U;
+	uint32_t doe = yoe * 365U + yoe / 4U - yoe / 100U + doy;
+	uint32_t days = era * DAYS_PER_ERA + doe - DAYS_0000_TO_1970;
+
+	return days * SECONDS_PER_DAY + dt->hour * 3600U + dt->minute * 60U + dt->second;
+}
+
+/**
+  * @brief determines if a date / time exists (years 1970..2105)
+  *
+  * @param  dt		read-only pointer to date / time
+  * @retval boolean
+  */
+bool datetime_is_valid(const datetime_t *dt) {
+	if ((dt->year < 1970U) || (dt->year > 2105U) || (dt->month < 1U) || (dt->month > 12U))
+		return false;
+
+	if ((dt->day < 1U) || (dt->day > month_days(dt->year, dt->month)))
+		return false;
+
+	return (dt->hour < 24U) && (dt->minute < 60U) && (dt->second < 60U);
+}
+
+/**
+  * @brief packs date and time into a FAT timestamp (2 s resolution)
+  *
+  * @param  dt		read-only pointer to a valid date / time
+  * @retval fat date (high half) and time (low half); 0 outside 1980..2107
+  */
+uint32_t datetime_to_fattime(const datetime_t *dt) {
+	if ((dt->year < FAT_YEAR_MIN) || (dt->year > FAT_YEAR_MAX))
+		return 0U;
+
+	return ((uint32_t) (dt->year - FAT_YEAR_MIN) << 25) | ((uint32_t) dt->month << 21) |
+		   ((uint32_t) dt->day << 16) | ((uint32_t) dt->hour << 11) |
+		   ((uint32_t) dt->minute << 5) | ((uint32_t) dt->second >> 1);
+}
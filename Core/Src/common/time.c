@@ -115,3 +115,24 @@ void delay_ms(uint32_t ms) {
 uint32_t millis(void) {
 	return HAL_GetTick();
 }
+
+/*
+ * @brief  provides a monotonic microsecond clock (tick count + elapsed
+ *         systick counts), for timestamps that outlive the cycle counter
+ *
+ * @param  None
+ * @retval microseconds since boot
+ * @note   thread context only: the tick interrupt must be able to run
+ */
+uint64_t micros(void) {
+	uint32_t load = SysTick->LOAD + 1U;
+	uint32_t ms, val;
+
+	/* Re-read if the tick advanced in between (val then belongs to the new ms) */
+	do {
+		ms = HAL_GetTick();
+		val = SysTick->VAL;
+	} while (ms != HAL_GetTick());
+
+	return (uint64_t) ms * 1000ULL + (uint64_t) (load - val) * 1000ULL / load;
+}
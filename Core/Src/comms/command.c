@@ -0,0 +1,564 @@
+/*
+ * command.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "comms/command.h"
+#include "comms/link.h"
+#include "comms/messages.h"
+#include "comms/telemetry.h"
+#include "comms/usb_msc.h"
+#include "params/params.h"
+#include "esc/esc.h"
+#include "system/health.h"
+#include "system/profile.h"
+#include "system/irq.h"
+#include "system/bench.h"
+#include "storage/sd_stream.h"
+#include "system/rtc.h"
+#include "sensors/mag/mag.h"
+#include "sensors/imu/imu_vote.h"
+#include "common/cycles.h"
+#include "common/time.h"
+
+_Static_assert(PARAM_NAME_LEN_MAX <= MSG_PARAM_NAME_LEN, "parameter names must fit MSG_PARAM_DESC");
+
+
+/**
+  * @brief helper function to reply with a command result
+  *
+  * @param  msg_id	id of the command being acknowledged
+  * @param	result	command result
+  *
+  * @retval None
+  */
+static void send_ack(uint8_t msg_id, ack_result_t result) {
+	msg_ack_t ack = {.msg_id = msg_id, .result = (uint8_t) result};
+	link_send(MSG_ACK, &ack, sizeof(ack));
+}
+
+/**
+  * @brief handle stream start command
+  *
+  * @retval command result
+  */
+static ack_result_t handle_stream_start(const frame_t *frame) {
+	msg_stream_start_t cmd;
+
+	if (frame->len != sizeof(cmd))
+		return ACK_INVALID;
+
+	memcpy(&cmd, frame->payload, sizeof(cmd));
+
+	return telemetry_set_rate((telemetry_topic_t) cmd.topic, cmd.rate_hz) ? ACK_OK : ACK_INVALID;
+}
+
+/**
+  * @brief handle stream stop command
+  *
+  * @retval command result
+  */
+static ack_result_t handle_stream_stop(const frame_t *frame) {
+	msg_stream_stop_t cmd;
+
+	if (frame->len != sizeof(cmd))
+		return ACK_INVALID;
+
+	memcpy(&cmd, frame->payload, sizeof(cmd));
+
+	return telemetry_set_rate((telemetry_topic_t) cmd.topic, 0U) ? ACK_OK : ACK_INVALID;
+}
+
+/**
+  * @brief helper function to reply with a parameter's current value
+  *
+  * @retval None
+  */
+static void send_param_value(param_id_t id) {
+	msg_param_value_t msg = {.id = (uint16_t) id, .value = params_get_float(id)};
+	link_send(MSG_PARAM_VALUE, &msg, sizeof(msg));
+}
+
+/**
+  * @brief handle parameter get command (replies with MSG_PARAM_VALUE)
+  *
+  * @retval command result (only acked on failure)
+  */
+static ack_result_t handle_param_get(const frame_t *frame) {
+	msg_param_get_t cmd;
+
+	if (frame->len != sizeof(cmd))
+		return ACK_INVALID;
+
+	memcpy(&cmd, frame->payload, sizeof(cmd));
+
+	if (!params_get_def((param_id_t) cmd.id))
+		return ACK_INVALID;
+
+	send_param_value((param_id_t) cmd.id);
+	return ACK_OK;
+}
+
+/**
+  * @brief handle parameter set command (replies with the value now in effect)
+  *
+  * @retval command result (only acked on failure)
+  */
+static ack_result_t handle_param_set(const frame_t *frame) {
+	msg_param_value_t cmd;
+	const param_def_t *def;
+
+	if (frame->len != sizeof(cmd))
+		return ACK_INVALID;
+
+	memcpy(&cmd, frame->payload, sizeof(cmd));
+
+	def = params_get_def((param_id_t) cmd.id);
+	if (!def)
+		return ACK_INVALID;
+
+	if ((def->flags & PARAM_FLAG_READONLY) || ((def->flags & PARAM_FLAG_DISARMED_ONLY) && esc_is_armed()))
+		return ACK_REJECTED;
+
+	if (params_set((param_id_t) cmd.id, cmd.value) != PARAM_OK)
+		return ACK_INVALID;
+
+	send_param_value((param_id_t) cmd.id);
+	return ACK_OK;
+}
+
+/**
+  * @brief handle parameter save command (flash write stalls the cpu, so
+  * 	   only allowed while disarmed)
+  *
+  * @retval command result
+  */
+static ack_result_t handle_param_save(void) {
+	param_status_t status;
+
+	if (esc_is_armed())
+		return ACK_REJECTED;
+
+	status = params_save();
+	health_report(HEALTH_MODULE_PARAMS, status);
+
+	return (status == PARAM_OK) ? ACK_OK : ACK_REJECTED;
+}
+
+/**
+  * @brief handle parameter descriptor request (replies with MSG_PARAM_DESC)
+  *
+  * @retval command result (only acked on failure)
+  */
+static ack_result_t handle_param_desc_get(const frame_t *frame) {
+	msg_param_get_t cmd;
+	msg_param_desc_t msg = {0};
+	const param_def_t *def;
+
+	if (frame->len != sizeof(cmd))
+		return ACK_INVALID;
+
+	memcpy(&cmd, frame->payload, sizeof(cmd));
+
+	def = params_get_def((param_id_t) cmd.id);
+	if (!def)
+		return ACK_INVALID;
+
+	msg.id = cmd.id;
+	msg.type = def->type;
+	msg.group = def->group;
+	msg.flags = def->flags;
+	msg.min = def->min;
+	msg.max = def->max;
+	msg.def = def->def;
+	strncpy(msg.name, def->name, sizeof(msg.name));
+
+	link_send(MSG_PARAM_DESC, &msg, sizeof(msg));
+	return ACK_OK;
+}
+
+/**
+  * @brief handle stats request (replies with MSG_STATS instead of an ack)
+  *
+  * @retval None
+  */
+static void handle_stats_get(void) {
+	link_stats_t ls;
+	profile_stats_t loop, control, blackbox;
+	msg_stats_t msg;
+
+	link_get_stats(&ls);
+	profile_get(PROFILE_LOOP, &loop);
+	profile_get(PROFILE_CONTROL, &control);
+	profile_get(PROFILE_LOG, &blackbox);
+
+	msg.uptime_ms = millis();
+	msg.tx_frames = ls.tx_frames;
+	msg.tx_bytes = ls.tx_bytes;
+	msg.tx_dropped = ls.tx_dropped;
+	msg.rx_frames = ls.rx_frames;
+	msg.rx_bytes = ls.rx_bytes;
+	msg.rx_errors = ls.rx_errors;
+	msg.rx_overruns = ls.rx_overruns;
+	msg.health_dropped = health_get_dropped();
+	msg.loop_cycles_avg = loop.avg;
+	msg.loop_cycles_max = loop.max;
+	msg.control_cycles_avg = control.avg;
+	msg.control_cycles_max = control.max;
+	msg.log_cycles_avg = blackbox.avg;
+	msg.log_cycles_max = blackbox.max;
+
+	link_send(MSG_STATS, &msg, sizeof(msg));
+}
+
+/**
+  * @brief handle interrupt latency request (replies with MSG_IRQ_LATENCY)
+  *
+  * @retval command result (only acked on failure)
+  */
+static ack_result_t handle_irq_latency_get(const frame_t *frame) {
+	uint8_t buffer[sizeof(msg_irq_latency_t) + IRQ_SRC_COUNT * sizeof(msg_irq_latency_source_t)];
+	msg_irq_latency_t *msg = (msg_irq_latency_t *) buffer;
+	msg_irq_latency_get_t cmd;
+	irq_latency_t lat;
+
+	if (frame->len != sizeof(cmd))
+		return ACK_INVALID;
+
+	memcpy(&cmd, frame->payload, sizeof(cmd));
+
+	msg->source_count = IRQ_SRC_COUNT;
+	for (uint32_t src = 0; src < IRQ_SRC_COUNT; ++src) {
+		if (!irq_latency_get((irq_source_t) src, &lat))
+			return ACK_UNSUPPORTED;		// latency test not built in
+
+		msg->sources[src].count = lat.count;
+		msg->sources[src].avg_cycles = lat.avg;
+		msg->sources[src].max_cycles = lat.max;
+	}
+
+	if (cmd.reset)
+		irq_latency_reset();
+
+	link_send(MSG_IRQ_LATENCY, buffer, sizeof(buffer));
+	return ACK_OK;
+}
+
+/**
+  * @brief handle benchmark results request (replies with one MSG_BENCH per
+  * 	   kernel that was run)
+  *
+  * @retval command result (only acked on failure)
+  */
+static ack_result_t handle_bench_get(void) {
+	bench_result_t res;
+	msg_bench_t msg;
+	uint8_t count = 0U;
+
+	for (uint32_t id = 0; id < BENCH_COUNT; ++id)
+		count += bench_get((bench_id_t) id, &res) ? 1U : 0U;
+
+	if (!count)
+		return ACK_UNSUPPORTED;		// not built in (CONFIG_BENCH)
+
+	for (uint32_t id = 0; id < BENCH_COUNT; ++id) {
+		if (!bench_get((bench_id_t) id, &res))
+			continue;
+
+		memset(&msg, 0, sizeof(msg));
+		msg.id = (uint8_t) id;
+		msg.count = count;
+		msg.clock_hz = cycles_hz();
+		msg.calls = res.calls;
+		msg.batches = res.batches;
+		msg.min_cycles = res.min;
+		msg.avg_cycles = res.avg;
+		msg.max_cycles = res.max;
+		msg.budget_cycles = res.budget;
+		strncpy(msg.name, res.name, sizeof(msg.name));
+
+		link_send(MSG_BENCH, &msg, sizeof(msg));
+	}
+
+	return ACK_OK;
+}
+
+/**
+  * @brief handle sd stream statistics request (replies with MSG_SD_STATS)
+  *
+  * @retval None
+  */
+static void handle_sd_stats_get(void) {
+	sd_stream_stats_t st;
+	msg_sd_stats_t msg;
+
+	sd_stream_get_stats(&st);
+
+	msg.bytes_written = st.bytes_written;
+	msg.bytes_dropped = st.bytes_dropped;
+	msg.transfers = st.transfers;
+	msg.errors = st.errors;
+	msg.latency_avg_us = st.latency_avg_us;
+	msg.latency_max_us = st.latency_max_us;
+	msg.throughput_kbps = st.throughput_kbps;
+
+	link_send(MSG_SD_STATS, &msg, sizeof(msg));
+}
+
+/**
+  * @brief handle wall time set command (calendar init stops the rtc briefly,
+  * 	   so only allowed while disarmed)
+  *
+  * @retval command result
+  */
+static ack_result_t handle_time_set(const frame_t *frame) {
+	msg_time_set_t cmd;
+	rtc_status_t status;
+
+	if (frame->len != sizeof(cmd))
+		return ACK_INVALID;
+
+	if (esc_is_armed())
+		return ACK_REJECTED;
+
+	memcpy(&cmd, frame->payload, sizeof(cmd));
+
+	status = rtc_set_unix(cmd.unix_s);
+	if (status == RTC_ERROR_FATAL)
+		health_report(HEALTH_MODULE_SYSTEM, status);
+
+	return (status == RTC_OK) ? ACK_OK : (status == RTC_ERROR_WARN) ? ACK_INVALID : ACK_REJECTED;
+}
+
+/**
+  * @brief handle wall time request (replies with MSG_TIME)
+  *
+  * @retval None
+  */
+static void handle_time_get(void) {
+	rtc_time_ref_t ref;
+	msg_time_t msg;
+
+	rtc_get_time_ref(&ref);
+
+	msg.boot_id = ref.boot_id;
+	msg.unix_s = ref.unix_s;
+	msg.unix_us = ref.unix_us;
+	msg.clock_us = ref.clock_us;
+	msg.flags = (rtc_is_set() ? MSG_TIME_FLAG_SET : 0U) |
+				((rtc_get_source() == RTC_SOURCE_LSE) ? MSG_TIME_FLAG_LSE : 0U);
+
+	link_send(MSG_TIME, &msg, sizeof(msg));
+}
+
+/**
+  * @brief handle telemetry statistics request (replies with MSG_TLM_STATS)
+  *
+  * @retval None
+  */
+static void handle_tlm_stats_get(void) {
+	uint8_t buffer[sizeof(msg_tlm_stats_t) + TELEMETRY_TOPIC_COUNT * sizeof(msg_tlm_topic_stats_t)];
+	msg_tlm_stats_t *msg = (msg_tlm_stats_t *) buffer;
+	telemetry_stats_t st;
+
+	msg->topic_count = TELEMETRY_TOPIC_COUNT;
+	for (uint32_t topic = 0; topic < TELEMETRY_TOPIC_COUNT; ++topic) {
+		(void) telemetry_get_stats((telemetry_topic_t) topic, &st);
+
+		msg->topics[topic].rate_hz = st.rate_hz;
+		msg->topics[topic].samples = st.samples;
+		msg->topics[topic].dropped = st.dropped;
+		msg->topics[topic].batches = st.batches;
+	}
+
+	link_send(MSG_TLM_STATS, buffer, sizeof(buffer));
+}
+
+/**
+  * @brief handle imu health request (replies with MSG_IMU_HEALTH instead of
+  * 	   an ack)
+  *
+  * @retval None
+  */
+static void handle_imu_health_get(void) {
+	uint8_t buffer[sizeof(msg_imu_health_t) + IMU_VOTE_INSTANCES_MAX * sizeof(msg_imu_instance_t)];
+	msg_imu_health_t *msg = (msg_imu_health_t *) buffer;
+	imu_instance_stats_t st;
+	uint8_t count = imu_get_count();
+
+	msg->instance_count = count;
+	msg->primary = imu_get_primary();
+	msg->failovers = imu_get_failovers();
+	for (uint8_t i = 0; i < count; ++i) {
+		(void) imu_get_stats(i, &st);
+
+		msg->instances[i].state = (uint8_t) st.state;
+		msg->instances[i].fault = (uint8_t) st.fault;
+		msg->instances[i].reads = st.reads;
+		msg->instances[i].read_errors = st.read_errors;
+		msg->instances[i].disagreements = st.disagreements;
+		msg->instances[i].gy_dev_max_mdps = st.gy_dev_max_mdps;
+		msg->instances[i].xl_dev_max_mg = st.xl_dev_max_mg;
+	}
+
+	link_send(MSG_IMU_HEALTH, buffer, sizeof(msg_imu_health_t) + count * sizeof(msg_imu_instance_t));
+}
+
+/**
+  * @brief handle usb mass storage request (the link drops once the ack left,
+  * 	   and comes back when the host ejects the drive)
+  *
+  * @retval command result
+  */
+static ack_result_t handle_msc_start(void) {
+	if (esc_is_armed())
+		return ACK_REJECTED;
+
+	return usb_msc_request() ? ACK_OK : ACK_REJECTED;
+}
+
+/**
+  * @brief handle magnetometer calibration start (the session runs in the
+  * 	   flight loop and keeps the craft from arming until it is done)
+  *
+  * @retval command result
+  */
+static ack_result_t handle_mag_cal_start(const frame_t *frame) {
+	msg_mag_cal_start_t cmd;
+
+	if (frame->len != sizeof(cmd))
+		return ACK_INVALID;
+
+	if (esc_is_armed())
+		return ACK_REJECTED;
+
+	memcpy(&cmd, frame->payload, sizeof(cmd));
+
+	return mag_calibration_start(cmd.duration_s) ? ACK_OK : ACK_REJECTED;
+}
+
+/**
+  * @brief handle magnetometer calibration request (replies with MSG_MAG_CAL)
+  *
+  * @retval None
+  */
+static void handle_mag_cal_get(void) {
+	mag_cal_report_t report;
+	msg_mag_cal_t msg;
+	const float (*w)[3];
+
+	mag_calibration_get(&report);
+	w = report.fit.cal.soft_iron;
+
+	msg.state = (uint8_t) report.state;
+	msg.result = (uint8_t) report.result;
+	msg.samples = report.fit.samples;
+	memcpy(msg.offset_mgauss, report.fit.cal.offset_mgauss, sizeof(msg.offset_mgauss));
+	msg.soft_iron[0] = w[0][0];
+	msg.soft_iron[1] = w[0][1];
+	msg.soft_iron[2] = w[0][2];
+	msg.soft_iron[3] = w[1][1];
+	msg.soft_iron[4] = w[1][2];
+	msg.soft_iron[5] = w[2][2];
+	msg.field_mgauss = report.fit.field_mgauss;
+	msg.fit_error_pct = report.fit.fit_error_pct;
+	msg.axis_ratio = report.fit.axis_ratio;
+
+	link_send(MSG_MAG_CAL, &msg, sizeof(msg));
+}
+
+/**
+  * @brief dispatches one decoded command frame
+  *
+  * @param  frame	read-only pointer to decoded frame
+  * @retval None
+  */
+void command_handle(const frame_t *frame) {
+	ack_result_t result;
+
+	switch (frame->msg_id) {
+		case MSG_PING:
+			send_ack(frame->msg_id, ACK_OK);
+			break;
+
+		case MSG_STREAM_START:
+			send_ack(frame->msg_id, handle_stream_start(frame));
+			break;
+
+		case MSG_STREAM_STOP:
+			send_ack(frame->msg_id, handle_stream_stop(frame));
+			break;
+
+		case MSG_STATS_GET:
+			handle_stats_get();
+			break;
+
+		case MSG_BENCH_GET:
+			if ((result = handle_bench_get()) != ACK_OK)
+				send_ack(frame->msg_id, result);
+			break;
+
+		case MSG_SD_STATS_GET:
+			handle_sd_stats_get();
+			break;
+
+		case MSG_TIME_SET:
+			send_ack(frame->msg_id, handle_time_set(frame));
+			break;
+
+		case MSG_TIME_GET:
+			handle_time_get();
+			break;
+
+		case MSG_TLM_STATS_GET:
+			handle_tlm_stats_get();
+			break;
+
+		case MSG_IMU_HEALTH_GET:
+			handle_imu_health_get();
+			break;
+
+		case MSG_MSC_START:
+			send_ack(frame->msg_id, handle_msc_start());
+			break;
+
+		case MSG_IRQ_LATENCY_GET:
+			if ((result = handle_irq_latency_get(frame)) != ACK_OK)
+				send_ack(frame->msg_id, result);
+			break;
+
+		case MSG_PARAM_GET:
+			if ((result = handle_param_get(frame)) != ACK_OK)
+				send_ack(frame->msg_id, result);
+			break;
+
+		case MSG_PARAM_SET:
+			if ((result = handle_param_set(frame)) != ACK_OK)
+				send_ack(frame->msg_id, result);
+			break;
+
+		case MSG_PARAM_SAVE:
+			send_ack(frame->msg_id, handle_param_save());
+			break;
+
+		case MSG_MAG_CAL_START:
+			send_ack(frame->msg_id, handle_mag_cal_start(frame));
+			break;
+
+		case MSG_MAG_CAL_GET:
+			handle_mag_cal_get();
+			break;
+
+		case MSG_PARAM_DESC_GET:
+			if ((result = handle_param_desc_get(frame)) != ACK_OK)
+				send_ack(frame->msg_id, result);
+			break;
+
+		default:
+			send_ack(frame->msg_id, ACK_UNSUPPORTED);
+			break;
+	}
+}
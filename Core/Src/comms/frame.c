@@ -0,0 +1,194 @@
+/*
+ * frame.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include "comms/frame.h"
+#include "common/crc.h"
+
+/**
+  * @brief  Streaming COBS Encoder State
+  * 		NOTE: writes go to dst[(start + idx) & mask], so the same encoder can
+  * 		target a linear buffer (mask = UINT32_MAX) or wrap inside a ring
+  */
+typedef struct {
+	uint8_t *dst;
+	uint32_t mask;
+	uint32_t start;
+	uint32_t idx;
+	uint32_t code_idx;
+	uint8_t code;
+} cobs_encoder_t;
+
+
+/**
+  * @brief helper function to start a COBS block sequence
+  *
+  * @retval None
+  */
+static inline void cobs_begin(cobs_encoder_t *enc, uint8_t *dst, uint32_t mask, uint32_t start) {
+	enc->dst = dst;
+	enc->mask = mask;
+	enc->start = start;
+	enc->code_idx = 0U;
+	enc->idx = 1U;	// reserve first code byte
+	enc->code = 1U;
+}
+
+/**
+  * @brief helper function to COBS encode one byte
+  *
+  * @retval None
+  */
+static inline void cobs_put(cobs_encoder_t *enc, uint8_t byte) {
+	if (byte != 0U) {
+		enc->dst[(enc->start + enc->idx++) & enc->mask] = byte;
+		enc->code++;
+	}
+
+	/* Close block on zero byte or max block length */
+	if ((byte == 0U) || (enc->code == 0xFFU)) {
+		enc->dst[(enc->start + enc->code_idx) & enc->mask] = enc->code;
+		enc->code_idx = enc->idx++;
+		enc->code = 1U;
+	}
+}
+
+/**
+  * @brief helper function to close the last COBS block and append the delimiter
+  *
+  * @retval encoded length (including delimiter)
+  */
+static inline size_t cobs_end(cobs_encoder_t *enc) {
+	enc->dst[(enc->start + enc->code_idx) & enc->mask] = enc->code;
+	enc->dst[(enc->start + enc->idx++) & enc->mask] = FRAME_DELIMITER;
+	return enc->idx;
+}
+
+/**
+  * @brief encodes a complete frame (header + payload + crc, COBS, delimiter)
+  * 	   directly into the destination, without an intermediate frame buffer
+  *
+  * @param  dst		destination buffer (linear or ring)
+  * @param  mask	index mask (ring size - 1, or UINT32_MAX for linear buffers)
+  * @param	pos		start index within dst
+  * @param	msg_id	message id
+  * @param	seq		sequence number
+  * @param	payload	read-only pointer to payload (may be NULL if len is 0)
+  * @param	len		payload length (<= FRAME_PAYLOAD_MAX)
+  *
+  * @retval encoded length in bytes (0 if payload too large)
+  */
+size_t frame_encode(uint8_t *dst, uint32_t mask, uint32_t pos, uint8_t msg_id, uint8_t seq, const void *payload, uint16_t len) {
+	const uint8_t *p = (const uint8_t*) payload;
+	const uint8_t header[FRAME_HEADER_SIZE] = {msg_id, seq};
+	cobs_encoder_t enc;
+	uint16_t crc;
+
+	if (len > FRAME_PAYLOAD_MAX)
+		return 0U;
+
+	crc = crc16_ccitt_update(CRC16_CCITT_INIT, header, FRAME_HEADER_SIZE);
+	crc = crc16_ccitt_update(crc, p, len);
+
+	cobs_begin(&enc, dst, mask, pos);
+
+	cobs_put(&enc, msg_id);
+	cobs_put(&enc, seq);
+
+	for (uint16_t i = 0; i < len; ++i) {
+		cobs_put(&enc, p[i]);
+	}
+
+	cobs_put(&enc, (uint8_t)(crc & 0xFFU));
+	cobs_put(&enc, (uint8_t)(crc >> 8));
+
+	return cobs_end(&enc);
+}
+
+/**
+  * @brief reset frame decoder to wait for the next frame
+  *
+  * @param  dec		pointer to frame decoder handle
+  * @retval None
+  */
+void frame_decoder_reset(frame_decoder_t *dec) {
+	dec->len = 0U;
+	dec->code = 0xFFU;	// no implied zero before first block
+	dec->remaining = 0U;
+	dec->overflow = false;
+}
+
+/**
+  * @brief helper function to append a decoded byte
+  *
+  * @retval None
+  */
+static inline void decoder_emit(frame_decoder_t *dec, uint8_t byte) {
+	if (dec->len < FRAME_RAW_MAX) {
+		dec->buf[dec->len++] = byte;
+	} else {
+		dec->overflow = true;
+	}
+}
+
+/**
+  * @brief feeds one received byte into the incremental frame decoder
+  *
+  * @param  dec		pointer to frame decoder handle
+  * @param	byte	received byte
+  * @param	out		decoded frame (valid only when FRAME_OK is returned, and
+  * 				only until the next push)
+  *
+  * @retval frame status
+  */
+frame_status_t frame_decoder_push(frame_decoder_t *dec, uint8_t byte, frame_t *out) {
+	frame_status_t status;
+	uint16_t crc_rx, crc;
+
+	/* Delimiter: validate collected frame */
+	if (byte == FRAME_DELIMITER) {
+		if (dec->overflow || (dec->remaining != 0U)) {
+			status = FRAME_ERROR_OVERFLOW;
+
+		} else if (dec->len < (FRAME_HEADER_SIZE + FRAME_CRC_SIZE)) {
+			status = (dec->len == 0U) ? FRAME_INCOMPLETE : FRAME_ERROR_SHORT;	// back-to-back delimiters are idle
+
+		} else {
+			uint16_t body = dec->len - FRAME_CRC_SIZE;
+			crc_rx = (uint16_t)(dec->buf[body] | (dec->buf[body + 1U] << 8));
+			crc = crc16_ccitt(dec->buf, body);
+
+			if (crc != crc_rx) {
+				status = FRAME_ERROR_CRC;
+			} else {
+				out->msg_id = dec->buf[0];
+				out->seq = dec->buf[1];
+				out->len = body - FRAME_HEADER_SIZE;
+				out->payload = &dec->buf[FRAME_HEADER_SIZE];
+				status = FRAME_OK;
+			}
+		}
+
+		frame_decoder_reset(dec);
+		return status;
+	}
+
+	/* Data byte inside current block */
+	if (dec->remaining != 0U) {
+		decoder_emit(dec, byte);
+		dec->remaining--;
+		return FRAME_INCOMPLETE;
+	}
+
+	/* Code byte: previous short block implied a zero */
+	if (dec->code != 0xFFU)
+		decoder_emit(dec, 0U);
+
+	dec->code = byte;
+	dec->remaining = byte - 1U;
+
+	return FRAME_INCOMPLETE;
+}
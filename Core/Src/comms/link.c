@@ -0,0 +1,247 @@
+/*
+ * link.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "comms/link.h"
+#include "comms/frame.h"
+#include "comms/command.h"
+#include "usbd_cdc_if.h"
+
+/**
+  * @brief  Link Ring Sizes (must be powers of 2)
+  */
+#define LINK_TX_RING_SIZE		4096U
+#define LINK_TX_RING_MASK		(LINK_TX_RING_SIZE - 1U)
+#define LINK_RX_RING_SIZE		512U
+#define LINK_RX_RING_MASK		(LINK_RX_RING_SIZE - 1U)
+
+_Static_assert((LINK_TX_RING_SIZE & LINK_TX_RING_MASK) == 0U, "link tx ring size must be a power of 2");
+_Static_assert((LINK_RX_RING_SIZE & LINK_RX_RING_MASK) == 0U, "link rx ring size must be a power of 2");
+
+/**
+  * @brief  TX Ring
+  * 		NOTE: frames are encoded in place at tx_head (main loop) and handed to
+  * 		the CDC class straight out of the ring as contiguous spans, so no frame
+  * 		is ever copied after encoding. tx_tail only moves in the USB ISR.
+  */
+static uint8_t tx_ring[LINK_TX_RING_SIZE];
+static uint32_t tx_head;
+static volatile uint32_t tx_tail;
+static volatile uint32_t tx_in_flight;
+static uint8_t tx_seq;
+
+/**
+  * @brief  RX Ring (filled in the USB ISR, decoded in the main loop)
+  */
+static uint8_t rx_ring[LINK_RX_RING_SIZE];
+static volatile uint32_t rx_head;
+static uint32_t rx_tail;
+
+/**
+  * @brief  Frame Decoder Handle
+  */
+static frame_decoder_t decoder;
+
+/**
+  * @brief  Link Statistics
+  */
+static link_stats_t stats;
+
+/**
+  * @brief  USB Device Handle
+  */
+extern USBD_HandleTypeDef hUsbDeviceFS;
+
+
+/**
+  * @brief init link state (rings, decoder, statistics)
+  *
+  * @retval None
+  */
+void link_init(void) {
+	tx_head = 0U;
+	tx_tail = 0U;
+	tx_in_flight = 0U;
+	tx_seq = 0U;
+
+	rx_head = 0U;
+	rx_tail = 0U;
+
+	frame_decoder_reset(&decoder);
+	memset(&stats, 0, sizeof(stats));
+}
+
+/**
+  * @brief checks whether the USB CDC interface is enumerated
+  *
+  * @retval boolean
+  */
+bool link_is_connected(void) {
+	return (hUsbDeviceFS.dev_state == USBD_STATE_CONFIGURED) && (hUsbDeviceFS.pClassData != NULL);
+}
+
+/**
+  * @brief queues one framed message for transmission (never blocks)
+  * 	   NOTE: main loop context only
+  *
+  * @param  msg_id	message id
+  * @param	payload	read-only pointer to payload
+  * @param	len		payload length
+  *
+  * @retval link status (WARN if dropped due to a full ring or no host)
+  */
+link_status_t link_send(uint8_t msg_id, const void *payload, uint16_t len) {
+	uint32_t used, needed;
+
+	if (len > FRAME_PAYLOAD_MAX)
+		return LINK_ERROR_FATAL;
+
+	if (!link_is_connected()) {
+		stats.tx_dropped++;
+		return LINK_ERROR_WARN;
+	}
+
+	used = tx_head - tx_tail;
+	needed = frame_encoded_size_max(len);
+
+	if ((LINK_TX_RING_SIZE - used) < needed) {
+		stats.tx_dropped++;
+		return LINK_ERROR_WARN;
+	}
+
+	/* Encode directly into the ring */
+	tx_head += frame_encode(tx_ring, LINK_TX_RING_MASK, tx_head, msg_id, tx_seq++, payload, len);
+
+	stats.tx_frames++;
+	return LINK_OK;
+}
+
+/**
+  * @brief free space in the tx ring (lets producers hold data instead of
+  * 	   having it dropped; compare with frame_encoded_size_max)
+  * 	   NOTE: main loop context only
+  *
+  * @retval bytes (0 while no host is connected)
+  */
+uint32_t link_tx_free(void) {
+	if (!link_is_connected())
+		return 0U;
+
+	return LINK_TX_RING_SIZE - (tx_head - tx_tail);
+}
+
+/**
+  * @brief helper function to start the next contiguous ring transfer (if idle)
+  *
+  * @retval None
+  */
+static void kick_transmit(void) {
+	uint32_t tail, start, span;
+
+	if (tx_in_flight != 0U)
+		return;
+
+	tail = tx_tail;
+	if (tx_head == tail)
+		return;
+
+	/* Send up to the end of the ring; the wrapped part goes next transfer */
+	start = tail & LINK_TX_RING_MASK;
+	span = tx_head - tail;
+	if (span > (LINK_TX_RING_SIZE - start))
+		span = LINK_TX_RING_SIZE - start;
+
+	tx_in_flight = span;
+	if (CDC_Transmit_FS(&tx_ring[start], (uint16_t) span) != USBD_OK) {
+		tx_in_flight = 0U;	// retry next service call
+		return;
+	}
+
+	stats.tx_bytes += span;
+}
+
+/**
+  * @brief link main loop service: decodes received frames, dispatches
+  * 	   commands and starts pending transmissions
+  *
+  * @retval None
+  */
+void link_service(void) {
+	frame_status_t status;
+	frame_t frame;
+
+	/* Host gone: discard queued data (no completion will arrive) */
+	if (!link_is_connected()) {
+		tx_in_flight = 0U;
+		tx_tail = tx_head;
+		rx_tail = rx_head;
+		frame_decoder_reset(&decoder);
+		return;
+	}
+
+	/* Decode received bytes */
+	while (rx_tail != rx_head) {
+		status = frame_decoder_push(&decoder, rx_ring[rx_tail & LINK_RX_RING_MASK], &frame);
+		rx_tail++;
+
+		if (status == FRAME_OK) {
+			stats.rx_frames++;
+			command_handle(&frame);
+
+		} else if (status != FRAME_INCOMPLETE) {
+			stats.rx_errors++;
+		}
+	}
+
+	kick_transmit();
+}
+
+/**
+  * @brief fetches link statistics
+  *
+  * @param	out		link statistics buffer to be filled
+  * @retval None
+  */
+void link_get_stats(link_stats_t *out) {
+	*out = stats;
+}
+
+/**
+  * @brief CDC receive hook: copies a received USB packet into the rx ring
+  * 	   NOTE: USB ISR context
+  *
+  * @param  buf		read-only pointer to received data
+  * @param	len		number of bytes received
+  *
+  * @retval None
+  */
+void link_receive_isr(const uint8_t *buf, uint32_t len) {
+	uint32_t head = rx_head;
+
+	for (uint32_t i = 0; i < len; ++i) {
+		if ((head - rx_tail) >= LINK_RX_RING_SIZE) {
+			stats.rx_overruns += len - i;
+			break;
+		}
+		rx_ring[head & LINK_RX_RING_MASK] = buf[i];
+		head++;
+	}
+
+	stats.rx_bytes += len;
+	rx_head = head;
+}
+
+/**
+  * @brief CDC transmit complete hook: releases the transferred ring span
+  * 	   NOTE: USB ISR context
+  *
+  * @retval None
+  */
+void link_transmit_complete_isr(void) {
+	tx_tail += tx_in_flight;
+	tx_in_flight = 0U;
+}
@@ -0,0 +1,331 @@
+/*
+ * telemetry.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "comms/telemetry.h"
+#include "comms/link.h"
+#include "comms/frame.h"
+#include "comms/messages.h"
+#include "common/time.h"
+#include "common/settings.h"
+
+/**
+  * @brief  Telemetry Config Settings
+  */
+#define TELEMETRY_RATE_MAX_HZ		CONFIG_TELEMETRY_RATE_MAX_HZ
+#define TELEMETRY_BATCH_MS			CONFIG_TELEMETRY_BATCH_MS
+#define TELEMETRY_LINK_HEADROOM		512U		// tx ring bytes left to acks, replies and health
+
+/**
+  * @brief  Batch Layout
+  */
+#define BATCH_HEADER_SIZE			sizeof(msg_tlm_batch_t)
+#define BATCH_SIZE_MAX				FRAME_PAYLOAD_MAX
+
+_Static_assert(BATCH_HEADER_SIZE + sizeof(msg_tlm_rc_t) <= BATCH_SIZE_MAX, "telemetry batch must hold a sample");
+
+/**
+  * @brief  Topic Stream State Type
+  */
+typedef struct {
+	uint32_t period_us;		// 0 when stream is stopped
+	uint64_t next_us;		// next sample due
+	uint16_t seq;			// next sample sequence number (dropped samples included)
+	uint32_t batch_ms;		// first sample of the pending batch
+	uint8_t count;			// samples in the pending batch
+	uint8_t batch[BATCH_SIZE_MAX] __attribute__((aligned(4)));
+	telemetry_stats_t stats;
+} topic_stream_t;
+
+/**
+  * @brief  Topic Sample Types (indexed by telemetry_topic_t)
+  */
+static const struct {
+	uint8_t msg_id;
+	uint8_t size;
+} topic_types[TELEMETRY_TOPIC_COUNT] = {
+	[TELEMETRY_TOPIC_IMU]		= {MSG_TLM_IMU, sizeof(msg_tlm_imu_t)},
+	[TELEMETRY_TOPIC_ATTITUDE]	= {MSG_TLM_ATTITUDE, sizeof(msg_tlm_attitude_t)},
+	[TELEMETRY_TOPIC_RC]		= {MSG_TLM_RC, sizeof(msg_tlm_rc_t)},
+	[TELEMETRY_TOPIC_MOTORS]	= {MSG_TLM_MOTORS, sizeof(msg_tlm_motors_t)},
+	[TELEMETRY_TOPIC_BATTERY]	= {MSG_TLM_BATTERY, sizeof(msg_tlm_battery_t)},
+	[TELEMETRY_TOPIC_ESC]		= {MSG_TLM_ESC, sizeof(msg_tlm_esc_t)}
+};
+
+/**
+  * @brief  Topic Streams and Data Sources
+  */
+static topic_stream_t streams[TELEMETRY_TOPIC_COUNT];
+static telemetry_sources_t sources;
+
+
+/**
+  * @brief init telemetry (all streams stopped)
+  *
+  * @param  src		read-only pointer to main-owned data sources
+  * @retval None
+  */
+void telemetry_init(const telemetry_sources_t *src) {
+	sources = *src;
+	telemetry_stop_all();
+}
+
+/**
+  * @brief sets stream rate of a topic (0 stops the stream); restarts the
+  * 	   topic's batch and statistics
+  *
+  * @param  topic		telemetry topic
+  * @param	rate_hz		stream rate (hz, capped at the loop rate)
+  *
+  * @retval boolean (false if topic or rate is invalid)
+  */
+bool telemetry_set_rate(telemetry_topic_t topic, uint16_t rate_hz) {
+	topic_stream_t *s;
+
+	if ((topic >= TELEMETRY_TOPIC_COUNT) || (rate_hz > TELEMETRY_RATE_MAX_HZ))
+		return false;
+
+	s = &streams[topic];
+
+	s->period_us = (rate_hz == 0U) ? 0U : (1000000U / rate_hz);
+	s->next_us = micros();
+	s->seq = 0U;
+	s->count = 0U;
+
+	memset(&s->stats, 0, sizeof(s->stats));
+	s->stats.rate_hz = rate_hz;
+
+	return true;
+}
+
+/**
+  * @brief stops all telemetry streams
+  *
+  * @retval None
+  */
+void telemetry_stop_all(void) {
+	for (uint32_t i = 0; i < TELEMETRY_TOPIC_COUNT; ++i) {
+		(void) telemetry_set_rate((telemetry_topic_t) i, 0U);
+	}
+}
+
+/**
+  * @brief helper function to serialize one topic sample
+  *
+  * @param  topic	telemetry topic
+  * @param	now		current time (ms)
+  * @param	dst		sample buffer (topic_types[topic].size bytes)
+  *
+  * @retval None
+  */
+static void serialize_topic(telemetry_topic_t topic, uint32_t now, uint8_t *dst) {
+	switch (topic) {
+		case TELEMETRY_TOPIC_IMU: {
+			msg_tlm_imu_t msg = {
+				.timestamp_ms = now,
+				.accel_mg = {sources.imu->accel_x, sources.imu->accel_y, sources.imu->accel_z},
+				.rate_mdps = {sources.imu->rate_x, sources.imu->rate_y, sources.imu->rate_z},
+				.dt = sources.imu->dt
+			};
+			memcpy(dst, &msg, sizeof(msg));
+			break;
+		}
+
+		case TELEMETRY_TOPIC_ATTITUDE: {
+			msg_tlm_attitude_t msg = {
+				.timestamp_ms = now,
+				.roll_deg = sources.est->roll_angle_deg,
+				.pitch_deg = sources.est->pitch_angle_deg,
+				.roll_rate_dps = sources.est->roll_rate_dps,
+				.pitch_rate_dps = sources.est->pitch_rate_dps,
+				.yaw_rate_dps = sources.est->yaw_rate_dps
+			};
+			memcpy(dst, &msg, sizeof(msg));
+			break;
+		}
+
+		case TELEMETRY_TOPIC_RC: {
+			msg_tlm_rc_t msg = {
+				.timestamp_ms = now,
+				.roll_deg = sources.req->roll_angle,
+				.pitch_deg = sources.req->pitch_angle,
+				.roll_rate_dps = sources.req->roll_rate,
+				.pitch_rate_dps = sources.req->pitch_rate,
+				.yaw_rate_dps = sources.req->yaw_rate,
+				.throttle_pct = sources.req->throttle,
+				.mode = (uint8_t) rc_get_flight_mode(),
+				.armed = esc_is_armed() ? 1U : 0U
+			};
+			memcpy(dst, &msg, sizeof(msg));
+			break;
+		}
+
+		case TELEMETRY_TOPIC_MOTORS: {
+			msg_tlm_motors_t msg = {
+				.timestamp_ms = now,
+				.mtr = {sources.mcmd->mtr1, sources.mcmd->mtr2, sources.mcmd->mtr3, sources.mcmd->mtr4}
+			};
+			memcpy(dst, &msg, sizeof(msg));
+			break;
+		}
+
+		case TELEMETRY_TOPIC_BATTERY: {
+			msg_tlm_battery_t msg = {
+				.timestamp_ms = now,
+				.voltage_v = sources.batt->voltage_v,
+				.current_a = sources.batt->current_a,
+				.rest_voltage_v = sources.batt->rest_voltage_v,
+				.consumed_mah = sources.batt->consumed_mah,
+				.energy_wh = sources.batt->energy_wh,
+				.cells = sources.batt->cells
+			};
+			memcpy(dst, &msg, sizeof(msg));
+			break;
+		}
+
+		case TELEMETRY_TOPIC_ESC: {
+			msg_tlm_esc_t msg = {.timestamp_ms = now};
+			for (uint32_t m = 0; m < ESC_COUNT; ++m) {
+				const esc_motor_tlm_t *esc = &sources.esc_tlm->motor[m];
+
+				msg.rpm[m] = esc->rpm;
+				msg.current_a[m] = esc->current_a;
+				msg.voltage_v[m] = esc->voltage_v;
+				msg.temperature_c[m] = esc->temperature_c;
+				msg.valid |= (uint8_t) (esc->valid ? (1U << m) : 0U);
+			}
+			memcpy(dst, &msg, sizeof(msg));
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+/**
+  * @brief helper function to check if the pending batch has room for no
+  * 	   further sample
+  *
+  * @retval boolean
+  */
+static inline bool batch_full(const topic_stream_t *s, uint8_t size) {
+	return (BATCH_HEADER_SIZE + (s->count + 1U) * size) > BATCH_SIZE_MAX;
+}
+
+/**
+  * @brief helper function to hand the pending batch to the link (kept for
+  * 	   the next loop if the tx ring is short of room; discarded if no host)
+  *
+  * @param  topic	telemetry topic
+  * @retval None
+  */
+static void flush_batch(telemetry_topic_t topic) {
+	topic_stream_t *s = &streams[topic];
+	msg_tlm_batch_t *batch = (msg_tlm_batch_t *) s->batch;
+	uint16_t len = (uint16_t) (BATCH_HEADER_SIZE + s->count * topic_types[topic].size);
+
+	if (!link_is_connected()) {
+		s->stats.dropped += s->count;
+		s->count = 0U;
+		return;
+	}
+
+	if (link_tx_free() < (frame_encoded_size_max(len) + TELEMETRY_LINK_HEADROOM))
+		return;
+
+	batch->count = s->count;
+	if (link_send(MSG_TLM_BATCH, batch, len) != LINK_OK)
+		return;
+
+	s->stats.samples += s->count;
+	s->stats.batches++;
+	s->count = 0U;
+}
+
+/**
+  * @brief helper function to add one sample to the pending batch of a topic
+  *
+  * @param  topic	telemetry topic
+  * @param	now		current time (ms)
+  *
+  * @retval None
+  */
+static void sample_topic(telemetry_topic_t topic, uint32_t now) {
+	topic_stream_t *s = &streams[topic];
+	msg_tlm_batch_t *batch = (msg_tlm_batch_t *) s->batch;
+	uint8_t size = topic_types[topic].size;
+
+	/* Full batch refused earlier: retry, else drop this sample */
+	if (batch_full(s, size)) {
+		flush_batch(topic);
+
+		if (batch_full(s, size)) {
+			s->stats.dropped++;
+			s->seq++;
+			return;
+		}
+	}
+
+	if (s->count == 0U) {
+		batch->msg_id = topic_types[topic].msg_id;
+		batch->seq = s->seq;
+		s->batch_ms = now;
+	}
+
+	serialize_topic(topic, now, &batch->samples[s->count * size]);
+	s->count++;
+	s->seq++;
+}
+
+/**
+  * @brief telemetry main loop service: samples due topics and sends full or
+  * 	   aged batches (never blocks)
+  *
+  * @retval None
+  */
+void telemetry_service(void) {
+	uint64_t now_us = micros();
+	uint32_t now = millis();
+
+	for (uint32_t i = 0; i < TELEMETRY_TOPIC_COUNT; ++i) {
+		topic_stream_t *s = &streams[i];
+
+		if (s->period_us == 0U)
+			continue;
+
+		/* Sample on the first loop of each period (no burst after a stall) */
+		if (now_us >= s->next_us) {
+			s->next_us += s->period_us;
+			if (s->next_us <= now_us)
+				s->next_us = now_us + s->period_us;
+
+			sample_topic((telemetry_topic_t) i, now);
+		}
+
+		/* Send once no further sample fits, or the oldest one is due */
+		if ((s->count != 0U) && (batch_full(s, topic_types[i].size) || ((now - s->batch_ms) >= TELEMETRY_BATCH_MS)))
+			flush_batch((telemetry_topic_t) i);
+	}
+}
+
+/**
+  * @brief fetches stream statistics of a topic
+  *
+  * @param  topic	telemetry topic
+  * @param	out		statistics buffer to be filled
+  *
+  * @retval boolean (false if topic is invalid)
+  */
+bool telemetry_get_stats(telemetry_topic_t topic, telemetry_stats_t *out) {
+	if (topic >= TELEMETRY_TOPIC_COUNT)
+		return false;
+
+	*out = streams[topic].stats;
+	return true;
+}
@@ -0,0 +1,376 @@
+/*
+ * usb_msc.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "comms/usb_msc.h"
+#include "storage/card/stm32_sd_card.h"
+#include "esc/esc.h"
+#include "common/time.h"
+#include "common/settings.h"
+#include "usbd_core.h"
+#include "usbd_ctlreq.h"
+#include "usbd_desc.h"
+#include "usbd_cdc.h"
+#include "usbd_cdc_if.h"
+#include "fatfs.h"
+
+/**
+  * @brief  Mass Storage Class Settings
+  */
+#define USB_MSC_READ_ONLY			CONFIG_MSC_READ_ONLY
+#define USB_MSC_PID					22314U		// st mass storage product id (the CDC link uses 22336)
+#define USB_MSC_PRODUCT_STRING		"AQC-1 Flight Logs"
+#define USB_MSC_EP_IN				0x81U
+#define USB_MSC_EP_OUT				0x01U
+#define USB_MSC_CONFIG_DESC_SIZE	32U
+#define USB_MSC_STR_DESC_SIZE		64U
+
+#define USB_MSC_REQ_GET_MAX_LUN		0xFEU
+#define USB_MSC_REQ_RESET			0xFFU
+
+/**
+  * @brief  Mode Switch Timing
+  */
+#define USB_MSC_SWITCH_DELAY_MS		50U			// let the MSG_ACK leave over the link first
+#define USB_MSC_DETACH_MS			100U		// host sees the device leave before it comes back
+
+/* External variables --------------------------------------------------------*/
+extern USBD_HandleTypeDef hUsbDeviceFS;
+
+/**
+  * @brief  Descriptors (device descriptor copied from the CDC one, class and pid changed)
+  */
+static uint8_t device_desc[USB_LEN_DEV_DESC] __attribute__((aligned(4)));
+static uint8_t str_desc[USB_MSC_STR_DESC_SIZE] __attribute__((aligned(4)));
+static USBD_DescriptorsTypeDef msc_desc;
+
+static uint8_t config_desc[USB_MSC_CONFIG_DESC_SIZE] __attribute__((aligned(4))) = {
+	/* Configuration */
+	0x09U, USB_DESC_TYPE_CONFIGURATION, USB_MSC_CONFIG_DESC_SIZE, 0x00U,
+	0x01U,					// interfaces
+	0x01U,					// configuration value
+	0x00U,					// no string
+	0xC0U,					// self powered
+	0x32U,					// 100 mA
+	/* Interface: mass storage, SCSI transparent, bulk-only */
+	0x09U, USB_DESC_TYPE_INTERFACE, 0x00U, 0x00U, 0x02U, 0x08U, 0x06U, 0x50U, 0x00U,
+	/* Bulk in / out endpoints */
+	0x07U, USB_DESC_TYPE_ENDPOINT, USB_MSC_EP_IN, USBD_EP_TYPE_BULK, LOBYTE(MSC_PACKET_SIZE), HIBYTE(MSC_PACKET_SIZE), 0x00U,
+	0x07U, USB_DESC_TYPE_ENDPOINT, USB_MSC_EP_OUT, USBD_EP_TYPE_BULK, LOBYTE(MSC_PACKET_SIZE), HIBYTE(MSC_PACKET_SIZE), 0x00U
+};
+
+/**
+  * @brief  Mode State
+  */
+static uint8_t max_lun = 0U;
+static bool pending = false;
+static bool active = false;
+static uint32_t pending_since;
+
+
+/**
+  * @brief class callback: host set the configuration (opens the endpoints)
+  *
+  * @retval usbd status
+  */
+static uint8_t class_init(USBD_HandleTypeDef *pdev, uint8_t cfgidx) {
+	(void) cfgidx;
+
+	(void) USBD_LL_OpenEP(pdev, USB_MSC_EP_IN, USBD_EP_TYPE_BULK, MSC_PACKET_SIZE);
+	pdev->ep_in[USB_MSC_EP_IN & 0x0FU].is_used = 1U;
+	(void) USBD_LL_OpenEP(pdev, USB_MSC_EP_OUT, USBD_EP_TYPE_BULK, MSC_PACKET_SIZE);
+	pdev->ep_out[USB_MSC_EP_OUT & 0x0FU].is_used = 1U;
+
+	msc_usb_reset();
+
+	return (uint8_t) USBD_OK;
+}
+
+/**
+  * @brief class callback: configuration cleared or device stopped
+  *
+  * @retval usbd status
+  */
+static uint8_t class_deinit(USBD_HandleTypeDef *pdev, uint8_t cfgidx) {
+	(void) cfgidx;
+
+	(void) USBD_LL_CloseEP(pdev, USB_MSC_EP_IN);
+	pdev->ep_in[USB_MSC_EP_IN & 0x0FU].is_used = 0U;
+	(void) USBD_LL_CloseEP(pdev, USB_MSC_EP_OUT);
+	pdev->ep_out[USB_MSC_EP_OUT & 0x0FU].is_used = 0U;
+
+	return (uint8_t) USBD_OK;
+}
+
+/**
+  * @brief class callback: class requests (GET MAX LUN, bulk-only reset),
+  * 	   interface requests and endpoint halts cleared by the host
+  *
+  * @retval usbd status
+  */
+static uint8_t class_setup(USBD_HandleTypeDef *pdev, USBD_SetupReqTypedef *req) {
+	static uint8_t alt_setting = 0U;
+	static uint16_t status_info = 0U;
+
+	switch (req->bmRequest & USB_REQ_TYPE_MASK) {
+		case USB_REQ_TYPE_CLASS:
+			if ((req->bRequest == USB_MSC_REQ_GET_MAX_LUN) && !req->wValue && (req->wLength == 1U) &&
+				(req->bmRequest & 0x80U)) {
+				(void) USBD_CtlSendData(pdev, &max_lun, 1U);
+				return (uint8_t) USBD_OK;
+			}
+
+			if ((req->bRequest == USB_MSC_REQ_RESET) && !req->wValue && !req->wLength &&
+				!(req->bmRequest & 0x80U)) {
+				(void) USBD_LL_FlushEP(pdev, USB_MSC_EP_IN);
+				(void) USBD_LL_FlushEP(pdev, USB_MSC_EP_OUT);
+				(void) USBD_LL_ClearStallEP(pdev, USB_MSC_EP_IN);
+				(void) USBD_LL_ClearStallEP(pdev, USB_MSC_EP_OUT);
+				msc_usb_reset();
+				return (uint8_t) USBD_OK;
+			}
+			break;
+
+		case USB_REQ_TYPE_STANDARD:
+			switch (req->bRequest) {
+				case USB_REQ_GET_STATUS:
+					(void) USBD_CtlSendData(pdev, (uint8_t*) &status_info, 2U);
+					return (uint8_t) USBD_OK;
+
+				case USB_REQ_GET_INTERFACE:
+					(void) USBD_CtlSendData(pdev, &alt_setting, 1U);
+					return (uint8_t) USBD_OK;
+
+				case USB_REQ_SET_INTERFACE:
+					if (!req->wValue)
+						return (uint8_t) USBD_OK;
+					break;
+
+				/* Routed here by the core after it cleared the halt */
+				case USB_REQ_CLEAR_FEATURE:
+					(void) USBD_LL_FlushEP(pdev, (uint8_t) req->wIndex);
+					msc_usb_halt_cleared((req->wIndex & 0x80U) != 0U);
+					return (uint8_t) USBD_OK;
+
+				default:
+					break;
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	USBD_CtlError(pdev, req);
+	return (uint8_t) USBD_FAIL;
+}
+
+/**
+  * @brief class callbacks: bulk in / out transfer complete
+  *
+  * @retval usbd status
+  */
+static uint8_t class_data_in(USBD_HandleTypeDef *pdev, uint8_t epnum) {
+	(void) pdev;
+	(void) epnum;
+
+	msc_usb_sent();
+	return (uint8_t) USBD_OK;
+}
+
+static uint8_t class_data_out(USBD_HandleTypeDef *pdev, uint8_t epnum) {
+	msc_usb_received(USBD_LL_GetRxDataSize(pdev, epnum));
+	return (uint8_t) USBD_OK;
+}
+
+/**
+  * @brief class callback: configuration descriptor (full speed only)
+  *
+  * @retval descriptor
+  */
+static uint8_t *class_config_desc(uint16_t *length) {
+	*length = (uint16_t) sizeof(config_desc);
+	return config_desc;
+}
+
+/**
+  * @brief mass storage usb class
+  */
+static USBD_ClassTypeDef usb_msc_class = {
+	.Init = class_init,
+	.DeInit = class_deinit,
+	.Setup = class_setup,
+	.DataIn = class_data_in,
+	.DataOut = class_data_out,
+	.GetHSConfigDescriptor = class_config_desc,
+	.GetFSConfigDescriptor = class_config_desc,
+	.GetOtherSpeedConfigDescriptor = class_config_desc
+};
+
+/**
+  * @brief descriptor callbacks: device descriptor and product string of the
+  * 	   mass storage device (the other strings are the CDC ones)
+  *
+  * @retval descriptor
+  */
+static uint8_t *msc_device_desc(USBD_SpeedTypeDef speed, uint16_t *length) {
+	(void) speed;
+
+	*length = (uint16_t) sizeof(device_desc);
+	return device_desc;
+}
+
+static uint8_t *msc_product_desc(USBD_SpeedTypeDef speed, uint16_t *length) {
+	(void) speed;
+
+	USBD_GetString((uint8_t*) USB_MSC_PRODUCT_STRING, str_desc, length);
+	return str_desc;
+}
+
+/**
+  * @brief endpoint pair for the scsi layer (msc_usb_interface_t)
+  */
+static bool usb_send(const uint8_t *buf, uint32_t len) {
+	return USBD_LL_Transmit(&hUsbDeviceFS, USB_MSC_EP_IN, (uint8_t*) buf, len) == USBD_OK;
+}
+
+static bool usb_receive(uint8_t *buf, uint32_t len) {
+	return USBD_LL_PrepareReceive(&hUsbDeviceFS, USB_MSC_EP_OUT, buf, len) == USBD_OK;
+}
+
+static void usb_stall(bool in) {
+	(void) USBD_LL_StallEP(&hUsbDeviceFS, in ? USB_MSC_EP_IN : USB_MSC_EP_OUT);
+}
+
+static const msc_usb_interface_t usb_interface = {
+	.send = usb_send,
+	.receive = usb_receive,
+	.stall = usb_stall
+};
+
+/**
+  * @brief helper function to restart the usb device with another class
+  * 	   NOTE: blocking (detach time)
+  *
+  * @param  cls		class to register
+  * @param	desc	device descriptors
+  *
+  * @retval boolean
+  */
+static bool switch_class(USBD_ClassTypeDef *cls, USBD_DescriptorsTypeDef *desc) {
+	(void) USBD_DeInit(&hUsbDeviceFS);
+	delay_ms(USB_MSC_DETACH_MS);
+
+	if ((USBD_Init(&hUsbDeviceFS, desc, DEVICE_FS) != USBD_OK) ||
+		(USBD_RegisterClass(&hUsbDeviceFS, cls) != USBD_OK))
+		return false;
+
+	if ((cls == &USBD_CDC) && (USBD_CDC_RegisterInterface(&hUsbDeviceFS, &USBD_Interface_fops_FS) != USBD_OK))
+		return false;
+
+	return USBD_Start(&hUsbDeviceFS) == USBD_OK;
+}
+
+/**
+  * @brief helper function to enter mass storage mode
+  *
+  * @retval msc status (FATAL if there is no card or the device did not restart)
+  */
+static msc_status_t start(void) {
+	uint16_t len;
+
+	pending = false;
+
+	if (esc_is_armed() || (msc_open(&usb_interface, &stm32_sd_disk, USB_MSC_READ_ONLY == ENABLED) != MSC_OK))
+		return MSC_ERROR_FATAL;
+
+	/* Same strings and vendor as the CDC device; class at interface level, own pid */
+	msc_desc = FS_Desc;
+	msc_desc.GetDeviceDescriptor = msc_device_desc;
+	msc_desc.GetProductStrDescriptor = msc_product_desc;
+
+	memcpy(device_desc, FS_Desc.GetDeviceDescriptor(USBD_SPEED_FULL, &len), sizeof(device_desc));
+	device_desc[4] = 0x00U;
+	device_desc[5] = 0x00U;
+	device_desc[6] = 0x00U;
+	device_desc[10] = LOBYTE(USB_MSC_PID);
+	device_desc[11] = HIBYTE(USB_MSC_PID);
+
+	/* The host owns the volume now */
+	(void) f_mount(NULL, SDPath, 0);
+
+	active = true;
+
+	if (!switch_class(&usb_msc_class, &msc_desc))
+		return MSC_ERROR_FATAL;
+
+	return MSC_OK;
+}
+
+/**
+  * @brief helper function to leave mass storage mode (CDC link back, volume
+  * 	   registered again and mounted on next access)
+  *
+  * @retval msc status (FATAL if the device did not restart)
+  */
+static msc_status_t stop(void) {
+	bool ok;
+
+	msc_close();
+	ok = switch_class(&USBD_CDC, &FS_Desc);
+
+	(void) f_mount(&SDFatFS, SDPath, 0);
+	active = false;
+
+	return ok ? MSC_OK : MSC_ERROR_FATAL;
+}
+
+/**
+  * @brief requests mass storage mode (switches after the next MSG_ACK left)
+  * 	   NOTE: disarmed only; arming is refused from here until the host
+  * 	   ejects the drive
+  *
+  * @retval boolean (false if armed or already requested)
+  */
+bool usb_msc_request(void) {
+	if (esc_is_armed() || pending || active)
+		return false;
+
+	pending = true;
+	pending_since = millis();
+
+	return true;
+}
+
+/**
+  * @brief switches modes when due and serves the card while in mass storage
+  * 	   mode (call every loop)
+  * 	   NOTE: blocking while switching (device detach, card init)
+  *
+  * @retval msc status
+  */
+msc_status_t usb_msc_service(void) {
+	if (pending && ((millis() - pending_since) >= USB_MSC_SWITCH_DELAY_MS))
+		return start();
+
+	if (!active)
+		return MSC_OK;
+
+	if (msc_ejected())
+		return stop();
+
+	return msc_service();
+}
+
+/**
+  * @brief determines if mass storage mode is on or about to be
+  *
+  * @retval boolean
+  */
+bool usb_msc_is_active(void) {
+	return pending || active;
+}
@@ -7,21 +7,10 @@
 
 #include <stddef.h>
 #include "esc/esc.h"
-#include "esc/protocols/pwm_esc.h"
+#include "params/params.h"
 #include "common/maths.h"
 #include "common/settings.h"
-
-/**
-  * @brief  ESC Protocol Setting
-  */
-#define ESC_PROTOCOL			CONFIG_ESC_PROTOCOL
-
-/**
-  * @brief  ESC Command Settings
-  */
-#define ESC_CMD_IDLE_PCT		CONFIG_ESC_CMD_IDLE_PCT
-#define ESC_CMD_LIFTOFF_PCT		CONFIG_ESC_CMD_LIFTOFF_PCT
-#define ESC_CMD_LIMIT_PCT		CONFIG_ESC_CMD_LIMIT_PCT
+#include "system/driver_registry.h"
 
 /**
   * @brief  ESC Commands Handle
@@ -38,6 +27,11 @@ static esc_cmd_props_t cmd_props;
   */
 static const esc_protocol_interface_t *esc_driver = NULL;
 
+/**
+  * @brief  ESC Lock (set by esc_lock, from interrupts too)
+  */
+static volatile bool locked;
+
 
 /**
   * @brief fetches esc command properties
@@ -59,6 +53,24 @@ static inline uint32_t map_pct_to_esc_cmd(float pct) {
 	return (uint32_t) ((cmd_props.max - cmd_props.min) * (pct / 100.0f) + cmd_props.min);
 }
 
+/**
+  * @brief helper function to convert a motor command to an esc command
+  * 	   NOTE: the float to integer cast is undefined for NaN and values out
+  * 	   of range, so those saturate here (and are caught by sanitizing)
+  *
+  * @param  mtr		motor command
+  * @retval esc command
+  */
+static inline uint32_t mtr_to_esc_command(float mtr) {
+	if (!(mtr > 0.0f))
+		return 0U;
+
+	if (mtr >= 4294967296.0f)
+		return UINT32_MAX;
+
+	return (uint32_t) mtr;
+}
+
 /**
   * @brief helper function to validate/constrain esc command
   *
@@ -90,19 +102,69 @@ static bool valid_esc_driver(const esc_protocol_interface_t *driver) {
 			driver->set_commands);
 }
 
+/**
+  * @brief helper function to set the motor outputs to the minimum command
+  *
+  * @retval None
+  */
+static void disarm_outputs(void) {
+	esc_driver->disarm(cmd_props.min);
+
+	/* Track disarmed state (see esc_is_armed) */
+	cmd.esc1 = cmd_props.min;
+	cmd.esc2 = cmd_props.min;
+	cmd.esc3 = cmd_props.min;
+	cmd.esc4 = cmd_props.min;
+}
+
+/**
+  * @brief helper function to compute idle/liftoff/limit commands from their
+  * 	   percentage parameters
+  *
+  * @retval esc status
+  */
+static esc_status_t update_command_properties(void) {
+	cmd_props.idle = map_pct_to_esc_cmd(params_get_float(PARAM_ESC_CMD_IDLE_PCT));
+	if (!inrange_u32(cmd_props.idle, cmd_props.min, cmd_props.max))
+		return ESC_ERROR_FATAL;
+
+	cmd_props.liftoff = map_pct_to_esc_cmd(params_get_float(PARAM_ESC_CMD_LIFTOFF_PCT));
+	if (!inrange_u32(cmd_props.liftoff, cmd_props.min, cmd_props.max))
+		return ESC_ERROR_FATAL;
+
+	cmd_props.limit = map_pct_to_esc_cmd(params_get_float(PARAM_ESC_CMD_LIMIT_PCT));
+	if (!inrange_u32(cmd_props.limit, cmd_props.min, cmd_props.max))
+		return ESC_ERROR_FATAL;
+
+	return ESC_OK;
+}
+
+/**
+  * @brief parameter change listener: recomputes esc command properties
+  * 	   NOTE: ESC parameters are disarmed-only, so no command is in flight
+  *
+  * @param  id		changed parameter id
+  * @retval None
+  */
+static void on_param_change(param_id_t id) {
+	(void) id;
+	update_command_properties();
+}
+
 /**
   * @brief esc API call to init esc protocol driver interface
   *
   * @retval esc status
   */
 esc_status_t esc_init(void) {
-	/* Use pre-processor conditionals based on configured protocol to initialize esc_driver.
-	 * NOTE: hot-swaps would require ESC_PROTOCOL to be a modifiable variable */
-	#if ESC_PROTOCOL == ESC_PWM_PROTOCOL_ID
-		esc_driver = &pwm_esc_driver;
-	#else
-		#error "Invalid ESC protocol configuration"
-	#endif
+	/* Bind the protocol detected on the motor outputs (the one linked in
+	 * without a probe if none is).
+	 * NOTE: bound once; hot-swaps would need the outputs stopped and rebound */
+	const driver_bus_t bus = {.handle = NULL, .address = 0U, .instance = 0U};
+	const driver_entry_t *entry = driver_bind(DRIVER_CLASS_ESC, &bus);
+
+	esc_driver = entry ? entry->interfaces[0] : NULL;
+	locked = false;
 
 	if (!valid_esc_driver(esc_driver))
 		return ESC_ERROR_FATAL;
@@ -110,17 +172,11 @@ esc_status_t esc_init(void) {
 	esc_status_t status = esc_driver->init(&cmd_props.min, &cmd_props.max);
 
 	/* Init remaining motor command properties */
-	cmd_props.idle = map_pct_to_esc_cmd(ESC_CMD_IDLE_PCT);
-	if (!inrange_u32(cmd_props.idle, cmd_props.min, cmd_props.max))
+	if (update_command_properties() != ESC_OK)
 		return ESC_ERROR_FATAL;
 
-	cmd_props.liftoff = map_pct_to_esc_cmd(ESC_CMD_LIFTOFF_PCT);
-	if (!inrange_u32(cmd_props.liftoff, cmd_props.min, cmd_props.max))
-		return ESC_ERROR_FATAL;
-
-	cmd_props.limit = map_pct_to_esc_cmd(ESC_CMD_LIMIT_PCT);
-	if (!inrange_u32(cmd_props.limit, cmd_props.min, cmd_props.max))
-		return ESC_ERROR_FATAL;
+	/* Registered first so mixer/attitude listeners see the new properties */
+	params_subscribe(PARAM_GROUP_ESC, on_param_change);
 
 	/* Init motor command variables */
 	cmd.esc1 = cmd_props.min;
@@ -155,6 +211,7 @@ esc_status_t esc_deinit(void) {
 
 	esc_status_t status = esc_driver->deinit();
 	esc_driver = NULL;
+	locked = false;
 
 	return status;
 }
@@ -192,8 +249,24 @@ esc_status_t esc_arm(void) {
 	if (!esc_driver)
 		return ESC_ERROR_FATAL;
 
+	/* Refuse While Locked (see esc_lock) */
+	if (locked)
+		return ESC_ERROR_WARN;
+
 	esc_driver->arm(cmd_props.idle);
 
+	/* Track armed state (see esc_is_armed) */
+	cmd.esc1 = cmd_props.idle;
+	cmd.esc2 = cmd_props.idle;
+	cmd.esc3 = cmd_props.idle;
+	cmd.esc4 = cmd_props.idle;
+
+	/* Undo if Locked Meanwhile (the lock's disarm may have been overwritten) */
+	if (locked) {
+		disarm_outputs();
+		return ESC_ERROR_WARN;
+	}
+
 	return ESC_OK;
 }
 
@@ -206,11 +279,38 @@ esc_status_t esc_disarm(void) {
 	if (!esc_driver)
 		return ESC_ERROR_FATAL;
 
-	esc_driver->disarm(cmd_props.min);
+	disarm_outputs();
 
 	return ESC_OK;
 }
 
+/**
+  * @brief esc API call to disarm and hold the motors off until esc_unlock:
+  * 	   arming and motor commands are refused meanwhile, and a command write
+  * 	   this call interrupted is undone by the writer
+  * 	   NOTE: interrupt safe (the crash isr cuts the motors with it)
+  *
+  * @retval esc status
+  */
+esc_status_t esc_lock(void) {
+	if (!esc_driver)
+		return ESC_ERROR_FATAL;
+
+	locked = true;		// before the disarm: an interrupted write sees it once it lands
+	disarm_outputs();
+
+	return ESC_OK;
+}
+
+/**
+  * @brief esc API call to release the lock of esc_lock (motors stay disarmed)
+  *
+  * @retval None
+  */
+void esc_unlock(void) {
+	locked = false;
+}
+
 /**
   * @brief esc API call to check whether esc is armed
   *
@@ -241,11 +341,15 @@ bool esc_is_armed(void) {
 esc_status_t esc_set_motor_commands(const mtr_cmds_t *mcmd) {
 	esc_status_t status = ESC_OK;
 
-	/* Cast to Integral Type */
-	cmd.esc1 = (uint32_t) mcmd->mtr1;
-	cmd.esc2 = (uint32_t) mcmd->mtr2;
-	cmd.esc3 = (uint32_t) mcmd->mtr3;
-	cmd.esc4 = (uint32_t) mcmd->mtr4;
+	/* Refuse While Locked (see esc_lock) */
+	if (locked)
+		return ESC_ERROR_WARN;
+
+	/* Convert to Integral Type */
+	cmd.esc1 = mtr_to_esc_command(mcmd->mtr1);
+	cmd.esc2 = mtr_to_esc_command(mcmd->mtr2);
+	cmd.esc3 = mtr_to_esc_command(mcmd->mtr3);
+	cmd.esc4 = mtr_to_esc_command(mcmd->mtr4);
 
 	/* Validate Motor Commands */
 	if (sanitize_esc_command(&cmd.esc1) != ESC_OK)
@@ -265,5 +369,31 @@ esc_status_t esc_set_motor_commands(const mtr_cmds_t *mcmd) {
 
 	esc_driver->set_commands(&cmd);
 
+	/* Undo if Locked Meanwhile (the commands may have landed after the lock's
+	 * disarm, e.g. an interrupt between the check above and the write) */
+	if (locked) {
+		disarm_outputs();
+		return ESC_ERROR_WARN;
+	}
+
 	return status;
 }
+
+/**
+  * @brief esc API call to request a telemetry frame from one esc (sent with
+  * 	   its next command by protocols that carry a request; see esc_telemetry.h)
+  *
+  * @param  esc		esc index (0-based)
+  * @retval esc status (WARN if the protocol cannot request telemetry)
+  */
+esc_status_t esc_request_telemetry(uint8_t esc) {
+	if (!esc_driver)
+		return ESC_ERROR_FATAL;
+
+	if (!esc_driver->request_telemetry || (esc >= ESC_COUNT))
+		return ESC_ERROR_WARN;
+
+	esc_driver->request_telemetry(esc);
+
+	return ESC_OK;
+}
@@ -0,0 +1,213 @@
+/*
+ * esc_telemetry.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include "stm32f4xx_hal.h"
+#include "esc/esc_telemetry.h"
+#include "esc/esc_telemetry_parser.h"
+#include "common/time.h"
+#include "common/settings.h"
+
+/*
+ * Register-level driver: the HAL uart module is not part of this project.
+ */
+
+/**
+  * @brief  ESC Telemetry Config Settings
+  */
+#define ESC_TLM					CONFIG_ESC_TELEMETRY
+#define ESC_TLM_BAUD			CONFIG_ESC_TLM_BAUD
+#define ESC_TLM_TIMEOUT_US		CONFIG_ESC_TLM_TIMEOUT_US
+#define ESC_TLM_STALE_US		(CONFIG_ESC_TLM_STALE_MS * 1000U)
+#define ESC_TLM_TEMP_MAX_C		CONFIG_ESC_TLM_TEMP_MAX_C
+#define ESC_MOTOR_POLES			CONFIG_ESC_MOTOR_POLES
+
+/**
+  * @brief  ESC Telemetry Peripherals (USART2 rx on PA3, DMA1 stream 5 channel 4)
+  */
+#define ESC_TLM_USART			USART2
+#define ESC_TLM_GPIO_PORT		GPIOA
+#define ESC_TLM_RX_PIN			GPIO_PIN_3
+#define ESC_TLM_DMA_STREAM		DMA1_Stream5
+#define ESC_TLM_DMA_CHANNEL		DMA_SxCR_CHSEL_2		// channel 4
+#define ESC_TLM_DMA_FLAGS		(DMA_HIFCR_CFEIF5 | DMA_HIFCR_CDMEIF5 | DMA_HIFCR_CTEIF5 | DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTCIF5)
+
+/**
+  * @brief  Receive Ring (~22 ms of data at 115200 baud; must not be in CCM)
+  */
+#define ESC_TLM_RX_RING_SIZE	256U
+#define ESC_TLM_RX_RING_US		((uint64_t) ESC_TLM_RX_RING_SIZE * 10U * 1000000U / ESC_TLM_BAUD)
+
+/**
+  * @brief  ESC Telemetry State
+  */
+static uint8_t rx_ring[ESC_TLM_RX_RING_SIZE];
+static uint32_t rx_tail;
+static uint64_t last_read_us;
+static esc_tlm_parser_t parser;
+static uint32_t overruns;
+static bool running;
+
+
+/**
+  * @brief helper function to get the dma write index into the receive ring
+  *
+  * @retval ring index
+  */
+static inline uint32_t rx_head(void) {
+	return (ESC_TLM_RX_RING_SIZE - ESC_TLM_DMA_STREAM->NDTR) % ESC_TLM_RX_RING_SIZE;
+}
+
+/**
+  * @brief helper function to check the motors' temperatures
+  *
+  * @param  data	read-only pointer to esc telemetry data
+  * @retval boolean (true if a valid motor's esc is too hot)
+  */
+static bool overheated(const esc_tlm_data_t *data) {
+	for (uint32_t m = 0; m < ESC_COUNT; ++m) {
+		if (data->motor[m].valid && (data->motor[m].temperature_c > ESC_TLM_TEMP_MAX_C))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * @brief esc telemetry API call to init the uart, start circular dma
+ * 		  reception and request the first frame
+ * 		  NOTE: call after esc init (requests go through the esc protocol)
+ *
+ * @retval esc telemetry status type (WARN if the esc protocol cannot request
+ * 		   telemetry; reception is then left stopped)
+ */
+esc_tlm_status_t esc_telemetry_init(void) {
+	running = false;
+	overruns = 0U;
+	esc_telemetry_parser_init(&parser, ESC_TLM_TIMEOUT_US, ESC_TLM_STALE_US, ESC_MOTOR_POLES);
+
+#if (ESC_TLM == ENABLED)
+	GPIO_InitTypeDef gpio = {0};
+	esc_tlm_data_t unused;
+
+	__HAL_RCC_GPIOA_CLK_ENABLE();
+	__HAL_RCC_USART2_CLK_ENABLE();
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	gpio.Pin = ESC_TLM_RX_PIN;
+	gpio.Mode = GPIO_MODE_AF_PP;
+	gpio.Pull = GPIO_PULLUP;
+	gpio.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	gpio.Alternate = GPIO_AF7_USART2;
+	HAL_GPIO_Init(ESC_TLM_GPIO_PORT, &gpio);
+
+	/* Receive only (16x oversampling): the escs share the line, requests go with the esc commands */
+	ESC_TLM_USART->CR1 = 0U;
+	ESC_TLM_USART->CR2 = 0U;
+	ESC_TLM_USART->CR3 = 0U;
+	ESC_TLM_USART->BRR = (HAL_RCC_GetPCLK1Freq() + ESC_TLM_BAUD / 2U) / ESC_TLM_BAUD;
+	ESC_TLM_USART->CR1 = USART_CR1_RE | USART_CR1_UE;
+
+	/* Circular Reception: the parser reads the ring in place, behind the dma */
+	ESC_TLM_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+	while (ESC_TLM_DMA_STREAM->CR & DMA_SxCR_EN);
+	DMA1->HIFCR = ESC_TLM_DMA_FLAGS;
+
+	ESC_TLM_DMA_STREAM->PAR = (uint32_t) &ESC_TLM_USART->DR;
+	ESC_TLM_DMA_STREAM->M0AR = (uint32_t) rx_ring;
+	ESC_TLM_DMA_STREAM->NDTR = ESC_TLM_RX_RING_SIZE;
+	ESC_TLM_DMA_STREAM->FCR = 0U;		// direct mode
+	ESC_TLM_DMA_STREAM->CR = ESC_TLM_DMA_CHANNEL | DMA_SxCR_PL_0 | DMA_SxCR_MINC | DMA_SxCR_CIRC;
+
+	(void) ESC_TLM_USART->SR;
+	(void) ESC_TLM_USART->DR;
+	ESC_TLM_USART->CR3 |= USART_CR3_DMAR;
+	ESC_TLM_DMA_STREAM->CR |= DMA_SxCR_EN;
+
+	rx_tail = rx_head();
+	last_read_us = micros();
+
+	if (esc_request_telemetry(esc_telemetry_parser_poll(&parser, last_read_us, &unused)) != ESC_OK) {
+		esc_telemetry_deinit();
+		return ESC_TLM_ERROR_WARN;
+	}
+
+	running = true;
+#endif
+
+	return ESC_TLM_OK;
+}
+
+/*
+ * @brief esc telemetry API call to stop reception
+ *
+ * @retval esc telemetry status type
+ */
+esc_tlm_status_t esc_telemetry_deinit(void) {
+#if (ESC_TLM == ENABLED)
+	ESC_TLM_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+	ESC_TLM_USART->CR3 &= ~USART_CR3_DMAR;
+	ESC_TLM_USART->CR1 = 0U;
+#endif
+
+	if (!running)
+		return ESC_TLM_ERROR_WARN;
+
+	running = false;
+
+	return ESC_TLM_OK;
+}
+
+/*
+ * @brief esc telemetry API call to parse what arrived since the last call and
+ * 		  request the next frame (non-blocking; see esc_telemetry.h)
+ * 		  NOTE: a call later than one ring period has lost bytes to the dma
+ * 		  (counted; the parser resyncs on the next frame)
+ *
+ * @param  data		pointer to esc telemetry data handle
+ * @retval esc telemetry status type (WARN on lost, corrupted or missing
+ * 		   frames and on an overheated esc)
+ */
+esc_tlm_status_t esc_telemetry_read(esc_tlm_data_t *data) {
+	esc_tlm_status_t status = ESC_TLM_OK;
+	uint32_t errors;
+	uint64_t now;
+	uint8_t motor;
+
+	data->fresh = 0U;
+	if (!running)
+		return ESC_TLM_OK;
+
+	now = micros();
+	if ((now - last_read_us) > ESC_TLM_RX_RING_US) {
+		overruns++;
+		status = ESC_TLM_ERROR_WARN;
+	}
+	last_read_us = now;
+
+	errors = parser.stats.crc_errors + parser.stats.timeouts;
+	(void) esc_telemetry_parser_feed_ring(&parser, rx_ring, ESC_TLM_RX_RING_SIZE, &rx_tail, rx_head(), now, data);
+
+	motor = esc_telemetry_parser_poll(&parser, now, data);
+	if ((motor != ESC_TLM_NO_REQUEST) && (esc_request_telemetry(motor) != ESC_OK))
+		status = ESC_TLM_ERROR_WARN;
+
+	if (((parser.stats.crc_errors + parser.stats.timeouts) != errors) || overheated(data))
+		status = ESC_TLM_ERROR_WARN;
+
+	return status;
+}
+
+/**
+  * @brief gets the stream statistics since init
+  *
+  * @param  out		stats buffer to be filled
+  * @retval None
+  */
+void esc_telemetry_get_stats(esc_tlm_stats_t *out) {
+	*out = parser.stats;
+	out->overruns = overruns;
+}
@@ -0,0 +1,236 @@
+/*
+ * esc_telemetry_parser.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "esc/esc_telemetry_parser.h"
+#include "common/crc.h"
+
+/**
+  * @brief  Frame Layout (byte offsets, big-endian fields)
+  */
+#define FRAME_TEMPERATURE		0U
+#define FRAME_VOLTAGE			1U
+#define FRAME_CURRENT			3U
+#define FRAME_CONSUMPTION		5U
+#define FRAME_ERPM				7U
+#define FRAME_CRC				9U
+
+/**
+  * @brief  Frame Units
+  */
+#define VOLT_PER_LSB			0.01f
+#define AMP_PER_LSB				0.01f
+#define ERPM_PER_LSB			100U
+
+
+/**
+  * @brief resets the parser (no request outstanding, no motor data; the
+  * 	   first poll requests esc 0)
+  *
+  * @param  p				pointer to parser handle
+  * @param	timeout_us		request to complete frame, else the next esc is requested
+  * @param	stale_us		motor data invalid without a frame for this long
+  * @param	motor_poles		magnet poles (rpm conversion)
+  *
+  * @retval None
+  */
+void esc_telemetry_parser_init(esc_tlm_parser_t *p, uint32_t timeout_us, uint32_t stale_us, uint8_t motor_poles) {
+	memset(p, 0, sizeof(*p));
+	p->motor = ESC_COUNT - 1U;
+	p->timeout_us = timeout_us;
+	p->stale_us = stale_us;
+	p->pole_pairs = (motor_poles >= 2U) ? (float) (motor_poles / 2U) : 1.0f;
+}
+
+/**
+  * @brief helper function to read a big-endian field
+  *
+  * @retval field value
+  */
+static inline uint16_t get_u16(const uint8_t *buf, uint32_t offset) {
+	return (uint16_t) (((uint16_t) buf[offset] << 8) | buf[offset + 1U]);
+}
+
+/**
+  * @brief helper function to store a big-endian field
+  *
+  * @retval None
+  */
+static inline void put_u16(uint8_t *buf, uint32_t offset, uint16_t value) {
+	buf[offset] = (uint8_t) (value >> 8);
+	buf[offset + 1U] = (uint8_t) value;
+}
+
+/**
+  * @brief decodes one frame (crc checked)
+  *
+  * @param  frame		read-only pointer to frame (ESC_TLM_FRAME_LEN bytes)
+  * @param	pole_pairs	motor pole pairs (rpm conversion)
+  * @param	out			motor telemetry buffer (filled if the crc is valid; valid
+  * 					flag untouched)
+  *
+  * @retval boolean (false on a crc mismatch)
+  */
+bool esc_telemetry_decode(const uint8_t *frame, float pole_pairs, esc_motor_tlm_t *out) {
+	if (crc8(frame, FRAME_CRC) != frame[FRAME_CRC])
+		return false;
+
+	out->temperature_c = frame[FRAME_TEMPERATURE];
+	out->voltage_v = (float) get_u16(frame, FRAME_VOLTAGE) * VOLT_PER_LSB;
+	out->current_a = (float) get_u16(frame, FRAME_CURRENT) * AMP_PER_LSB;
+	out->consumption_mah = get_u16(frame, FRAME_CONSUMPTION);
+	out->erpm = (uint32_t) get_u16(frame, FRAME_ERPM) * ERPM_PER_LSB;
+	out->rpm = (float) out->erpm / pole_pairs;
+
+	return true;
+}
+
+/**
+  * @brief builds a frame (as an esc sends it; fields saturate at their range)
+  *
+  * @param  in		read-only pointer to motor telemetry (rpm and valid unused)
+  * @param	out		frame buffer (ESC_TLM_FRAME_LEN bytes)
+  *
+  * @retval frame length
+  */
+uint32_t esc_telemetry_frame(const esc_motor_tlm_t *in, uint8_t *out) {
+	float voltage = in->voltage_v / VOLT_PER_LSB + 0.5f;
+	float current = in->current_a / AMP_PER_LSB + 0.5f;
+	uint32_t erpm = (in->erpm + ERPM_PER_LSB / 2U) / ERPM_PER_LSB;
+
+	out[FRAME_TEMPERATURE] = in->temperature_c;
+	put_u16(out, FRAME_VOLTAGE, (voltage >= 65535.0f) ? 0xFFFFU : (voltage > 0.0f) ? (uint16_t) voltage : 0U);
+	put_u16(out, FRAME_CURRENT, (current >= 65535.0f) ? 0xFFFFU : (current > 0.0f) ? (uint16_t) current : 0U);
+	put_u16(out, FRAME_CONSUMPTION, in->consumption_mah);
+	put_u16(out, FRAME_ERPM, (erpm > 0xFFFFU) ? 0xFFFFU : (uint16_t) erpm);
+	out[FRAME_CRC] = crc8(out, FRAME_CRC);
+
+	return ESC_TLM_FRAME_LEN;
+}
+
+/**
+  * @brief helper function to take one byte into the frame window
+  *
+  * @retval boolean (true if it completed a valid frame)
+  */
+static bool parse_byte(esc_tlm_parser_t *p, uint8_t b, uint64_t now_us, esc_tlm_data_t *out) {
+	if (!p->pending) {
+		p->stats.stray_bytes++;
+		return false;
+	}
+
+	p->window[p->len++] = b;
+	if (p->len < ESC_TLM_FRAME_LEN)
+		return false;
+
+	/* Resync: slide the window by one byte */
+	if (!esc_telemetry_decode(p->window, p->pole_pairs, &out->motor[p->motor])) {
+		p->stats.crc_errors++;
+		memmove(p->window, &p->window[1], ESC_TLM_FRAME_LEN - 1U);
+		p->len = ESC_TLM_FRAME_LEN - 1U;
+		return false;
+	}
+
+	out->motor[p->motor].valid = true;
+	out->fresh |= (uint8_t) (1U << p->motor);
+	p->seen |= (uint8_t) (1U << p->motor);
+	p->frame_us[p->motor] = now_us;
+	p->pending = false;
+	p->len = 0U;
+	p->stats.frames++;
+
+	return true;
+}
+
+/**
+  * @brief feeds bytes through the parser
+  * 	   NOTE: fresh bits are only ever set here; the caller clears them
+  *
+  * @param  p		pointer to parser handle
+  * @param	buf		read-only pointer to bytes
+  * @param	len		number of bytes
+  * @param	now_us	arrival time (at most the time of the read)
+  * @param	out		telemetry buffer (the requested motor filled when its frame completes)
+  *
+  * @retval frames completed
+  */
+uint32_t esc_telemetry_parser_feed(esc_tlm_parser_t *p, const uint8_t *buf, uint32_t len, uint64_t now_us,
+								   esc_tlm_data_t *out) {
+	uint32_t frames = 0U;
+
+	p->stats.bytes += len;
+
+	for (uint32_t i = 0; i < len; ++i) {
+		if (parse_byte(p, buf[i], now_us, out))
+			frames++;
+	}
+
+	return frames;
+}
+
+/**
+  * @brief feeds the new bytes of a circular receive buffer (e.g. dma) through
+  * 	   the parser, in place
+  *
+  * @param  p		pointer to parser handle
+  * @param	ring	read-only pointer to circular buffer
+  * @param	size	circular buffer size
+  * @param	tail	pointer to the read index (advanced to head)
+  * @param	head	write index (next byte the writer fills)
+  * @param	now_us	time of the read
+  * @param	out		telemetry buffer (see esc_telemetry_parser_feed)
+  *
+  * @retval frames completed
+  */
+uint32_t esc_telemetry_parser_feed_ring(esc_tlm_parser_t *p, const uint8_t *ring, uint32_t size, uint32_t *tail,
+										uint32_t head, uint64_t now_us, esc_tlm_data_t *out) {
+	uint32_t frames = 0U;
+
+	if (head < *tail) {
+		frames += esc_telemetry_parser_feed(p, &ring[*tail], size - *tail, now_us, out);
+		*tail = 0U;
+	}
+
+	frames += esc_telemetry_parser_feed(p, &ring[*tail], head - *tail, now_us, out);
+	*tail = head;
+
+	return frames;
+}
+
+/**
+  * @brief expires the outstanding request and stale motor data, and picks the
+  * 	   esc to request next (round-robin)
+  *
+  * @param  p		pointer to parser handle
+  * @param	now_us	current time
+  * @param	out		telemetry buffer (valid flags and total current updated)
+  *
+  * @retval esc to request now (ESC_TLM_NO_REQUEST while a frame is awaited)
+  */
+uint8_t esc_telemetry_parser_poll(esc_tlm_parser_t *p, uint64_t now_us, esc_tlm_data_t *out) {
+	out->current_a = 0.0f;
+
+	for (uint8_t m = 0; m < ESC_COUNT; ++m) {
+		out->motor[m].valid = ((p->seen >> m) & 1U) && ((now_us - p->frame_us[m]) < p->stale_us);
+		if (out->motor[m].valid)
+			out->current_a += out->motor[m].current_a;
+	}
+
+	if (p->pending) {
+		if ((now_us - p->request_us) < p->timeout_us)
+			return ESC_TLM_NO_REQUEST;
+
+		p->stats.timeouts++;
+	}
+
+	p->motor = (uint8_t) ((p->motor + 1U) % ESC_COUNT);
+	p->pending = true;
+	p->request_us = now_us;
+	p->len = 0U;
+
+	return p->motor;
+}
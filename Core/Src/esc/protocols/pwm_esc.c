@@ -13,6 +13,7 @@
 #include "common/maths.h"
 #include "common/hardware.h"
 #include "common/settings.h"
+#include "system/driver_registry.h"
 
 /**
   * @brief  PWM Config Settings
@@ -49,10 +50,10 @@ typedef esc_status_t pwm_esc_status_t;
   * @brief  Timer Handle Pointers
   * 		NOTE: Adjust based on PWM Output Timer Config!
   */
-static const TIM_HandleTypeDef* phtim_esc1 = NULL;
-static const TIM_HandleTypeDef* phtim_esc2 = NULL;
-static const TIM_HandleTypeDef* phtim_esc3 = NULL;
-static const TIM_HandleTypeDef* phtim_esc4 = NULL;
+static TIM_HandleTypeDef* phtim_esc1 = NULL;
+static TIM_HandleTypeDef* phtim_esc2 = NULL;
+static TIM_HandleTypeDef* phtim_esc3 = NULL;
+static TIM_HandleTypeDef* phtim_esc4 = NULL;
 
 /**
   * @brief  PWM Output Timer Clock Reference Freq
@@ -325,6 +326,7 @@ static void pwm_esc_set_commands(const esc_cmds_t *cmd) {
 
 /**
   * @brief pwm esc driver initialization
+  * 	   NOTE: pwm has no way to request esc telemetry (request_telemetry unset)
   */
 const esc_protocol_interface_t pwm_esc_driver = {
 	.init = pwm_esc_init,
@@ -335,3 +337,15 @@ const esc_protocol_interface_t pwm_esc_driver = {
     .disarm = pwm_esc_disarm,
 	.set_commands = pwm_esc_set_commands
 };
+
+/**
+  * @brief pwm esc driver registration (no probe: pwm escs answer nothing, so
+  * 	   it is bound when nothing is detected)
+  */
+DRIVER_REGISTER(pwm_esc_entry) = {
+	.name = "pwm",
+	.cls = DRIVER_CLASS_ESC,
+	.instances = 1U,
+	.probe = NULL,
+	.interfaces = {&pwm_esc_driver}
+};
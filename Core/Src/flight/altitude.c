@@ -0,0 +1,506 @@
+/*
+ * altitude.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include "flight/altitude.h"
+#include "esc/esc.h"
+#include "params/params.h"
+#include "common/maths.h"
+#include "common/memory.h"
+#include "common/settings.h"
+
+/**
+  * @brief  Altitude Estimator Config Settings
+  */
+#define ALT_FILT_TAU_S				CONFIG_ALT_FILT_TAU_S
+#define ALT_BARO_ZERO_SAMPLES		CONFIG_ALT_BARO_ZERO_SAMPLES
+
+/**
+  * @brief  Complementary Filter Gains (triple pole at -1/tau)
+  */
+#define ALT_GAIN_POS				(3.0f / ALT_FILT_TAU_S)
+#define ALT_GAIN_VEL				(3.0f / (ALT_FILT_TAU_S * ALT_FILT_TAU_S))
+#define ALT_GAIN_BIAS				(1.0f / (ALT_FILT_TAU_S * ALT_FILT_TAU_S * ALT_FILT_TAU_S))
+
+#define ALT_ACCEL_BIAS_MAX_MPS2		2.0f		// ~200 mg
+#define ALT_BIAS_INIT_TAU_S			0.1f		// accel averaging while the ground reference is taken
+#define ALT_DT_MAX_S				0.05f		// longer steps (stalls) are not integrated
+
+/**
+  * @brief  Altitude Hold Config Settings
+  */
+#define ALT_HOLD_PERIOD_S			(1.0f / (float) CONFIG_ALT_HOLD_RATE_HZ)
+#define ALT_HOLD_STICK_DEADBAND_PCT	CONFIG_ALT_HOLD_STICK_DEADBAND_PCT
+#define ALT_HOLD_EXIT_BLEND_S		CONFIG_ALT_HOLD_EXIT_BLEND_S
+#define ALT_CLIMB_ACCEL_MPS2		CONFIG_ALT_CLIMB_ACCEL_MPS2
+#define ALT_HOVER_LEARN_TAU_S		CONFIG_ALT_HOVER_LEARN_TAU_S
+
+#define ALT_STICK_CENTER_PCT		(0.5f * (THROTTLE_MIN_PCT + THROTTLE_MAX_PCT))
+#define ALT_HOVER_LEARN_CLIMB_MPS	0.3f		// hovering: slower than this..
+#define ALT_HOVER_LEARN_ALT_M		0.5f		// ..and clear of the ground
+
+/**
+  * @brief  International Standard Atmosphere (troposphere)
+  */
+#define ISA_PRESSURE_PA				101325.0f
+#define ISA_SCALE_M					44330.77f
+#define ISA_EXPONENT				0.190263f
+
+#define GRAVITY_MPS2				9.80665f
+
+/**
+  * @brief  Runtime Parameter Cache (refreshed on change notification)
+  */
+static float climb_max_mps CCM_BSS;
+
+/*
+ * @brief Altitude Hold PIDs and State
+ */
+static pid_ctrl_t alt_pos_pid CCM_BSS;
+static pid_ctrl_t alt_vel_pid CCM_BSS;
+static float hover_throttle_pct CCM_BSS;
+static float cascade_phase_s CCM_BSS;		// time into the current cascade period
+static float cascade_dt_s CCM_BSS;			// time since the last cascade update
+static float exit_blend_s CCM_BSS;			// blend time left after leaving alt hold
+static float exit_throttle_pct CCM_BSS;		// throttle when alt hold was left
+static bool stick_released CCM_BSS;			// stick was centered since engaging
+
+/*
+ * @brief PID Controller -> Parameter Block Map
+ */
+static const struct {
+	pid_ctrl_t *ctrl;
+	param_id_t first;
+} pid_params[] = {
+	{&alt_pos_pid, PARAM_ALT_POS_P},
+	{&alt_vel_pid, PARAM_ALT_VEL_P}
+};
+
+#define PID_PARAM_COUNT		(sizeof(pid_params) / sizeof(pid_params[0]))
+#define PID_PARAM_BLOCK		6U	// fields per PID parameter block
+
+
+/**
+  * @brief converts static pressure to pressure altitude (standard atmosphere)
+  *
+  * @param  pressure_pa		static pressure (Pa)
+  * @retval pressure altitude (m)
+  */
+float altitude_from_pressure(float pressure_pa) {
+	return ISA_SCALE_M * (1.0f - powf(pressure_pa / ISA_PRESSURE_PA, ISA_EXPONENT));
+}
+
+/**
+  * @brief gets vertical (earth frame, up) acceleration from the body frame
+  * 	   accelerometer and the roll/pitch estimate
+  * 	   NOTE: inverse of the tilt the attitude estimator derives from gravity,
+  * 	   f_body = g * (-sin(pitch), sin(roll)cos(pitch), cos(roll)cos(pitch))
+  *
+  * @param  imu		read-only pointer to imu 6d sensor handle (mg)
+  * @param	att		read-only pointer to attitude estimate
+  *
+  * @retval vertical acceleration, gravity removed (m/s^2)
+  */
+float altitude_vertical_accel(const imu_6D_t *imu, const attitude_est_t *att) {
+	float sr = sinf(DEG_TO_RAD(att->roll_angle_deg));
+	float cr = cosf(DEG_TO_RAD(att->roll_angle_deg));
+	float sp = sinf(DEG_TO_RAD(att->pitch_angle_deg));
+	float cp = cosf(DEG_TO_RAD(att->pitch_angle_deg));
+
+	float up_mg = -sp * imu->accel_x + sr * cp * imu->accel_y + cr * cp * imu->accel_z;
+
+	return (up_mg - 1000.0f) * (GRAVITY_MPS2 / 1000.0f);
+}
+
+/**
+  * @brief helper function to take a fresh baro sample (averaged into the
+  * 	   ground reference until it is complete)
+  *
+  * @param  baro	read-only pointer to baro sample
+  * @param	est		pointer to altitude estimate handle
+  *
+  * @retval altitude status type
+  */
+static altitude_status_t baro_update(const baro_data_t *baro, altitude_est_t *est) {
+	if (baro->pressure_cpa == 0U)
+		return ALTITUDE_ERROR_WARN;
+
+	float alt_m = altitude_from_pressure((float) baro->pressure_cpa * 0.01f);
+
+	if (est->ref_count < ALT_BARO_ZERO_SAMPLES) {
+		est->ref_sum_m += alt_m;
+		if (++est->ref_count < ALT_BARO_ZERO_SAMPLES)
+			return ALTITUDE_OK;
+
+		/* Reference complete: start the filter at rest on the ground */
+		est->ref_alt_m = est->ref_sum_m / (float) ALT_BARO_ZERO_SAMPLES;
+		est->baro_alt_m = alt_m - est->ref_alt_m;
+		est->altitude_m = est->baro_alt_m;
+		est->climb_rate_mps = 0.0f;
+		est->valid = true;
+		return ALTITUDE_OK;
+	}
+
+	est->baro_alt_m = alt_m - est->ref_alt_m;
+	return ALTITUDE_OK;
+}
+
+/**
+  * @brief updates altitude and climb rate estimates (every loop)
+  *
+  * @param  imu		read-only pointer to imu 6d sensor handle
+  * @param	att		read-only pointer to attitude estimate
+  * @param	baro	read-only pointer to baro sample (used if fresh)
+  * @param	est		pointer to altitude estimate handle
+  *
+  * @retval altitude status type
+  */
+altitude_status_t altitude_estimator_update(const imu_6D_t *imu, const attitude_est_t *att,
+											const baro_data_t *baro, altitude_est_t *est) {
+	altitude_status_t status = ALTITUDE_OK;
+
+	if (baro->fresh)
+		status = baro_update(baro, est);
+
+	/* imu dt is integral us */
+	float dt = USEC_TO_SEC((float) imu->dt);
+	if ((dt <= 0.0f) || (dt > ALT_DT_MAX_S))
+		return status;
+
+	/* At rest until the ground reference is complete: seed the bias state */
+	if (!est->valid) {
+		float bias = constrainf(-altitude_vertical_accel(imu, att), -ALT_ACCEL_BIAS_MAX_MPS2, ALT_ACCEL_BIAS_MAX_MPS2);
+		est->accel_bias_mps2 += (bias - est->accel_bias_mps2) * fminf(dt / ALT_BIAS_INIT_TAU_S, 1.0f);
+		return status;
+	}
+
+	/* Baro correction of position, velocity and accelerometer bias */
+	float err = est->baro_alt_m - est->altitude_m;
+
+	est->accel_bias_mps2 = constrainf(est->accel_bias_mps2 + ALT_GAIN_BIAS * err * dt,
+									  -ALT_ACCEL_BIAS_MAX_MPS2, ALT_ACCEL_BIAS_MAX_MPS2);
+
+	/* Inertial prediction */
+	float accel = altitude_vertical_accel(imu, att) + est->accel_bias_mps2;
+
+	est->climb_rate_mps += (accel + ALT_GAIN_VEL * err) * dt;
+	est->altitude_m += (est->climb_rate_mps + ALT_GAIN_POS * err) * dt;
+
+	return status;
+}
+
+/**
+  * @brief moves the ground reference to the current altitude estimate (e.g. on
+  * 	   arming, so altitude reads zero at takeoff)
+  *
+  * @param  est		pointer to altitude estimate handle
+  * @retval None
+  */
+void altitude_estimator_rezero(altitude_est_t *est) {
+	if (!est->valid)
+		return;
+
+	est->ref_alt_m += est->altitude_m;
+	est->baro_alt_m -= est->altitude_m;
+	est->altitude_m = 0.0f;
+}
+
+/**
+  * @brief helper function to map the throttle stick to a climb rate request
+  * 	   (zero within the deadband around center)
+  *
+  * @param  throttle	throttle stick request (%)
+  * @retval climb rate request (m/s)
+  */
+static float stick_climb_rate(float throttle) {
+	float dev = throttle - ALT_STICK_CENTER_PCT;
+	float span = ALT_STICK_CENTER_PCT - ALT_HOLD_STICK_DEADBAND_PCT;
+
+	if (fabsf(dev) <= ALT_HOLD_STICK_DEADBAND_PCT)
+		return 0.0f;
+
+	return copysignf((fabsf(dev) - ALT_HOLD_STICK_DEADBAND_PCT) / span, dev) * climb_max_mps;
+}
+
+/**
+  * @brief helper function to learn the hover throttle from the applied
+  * 	   throttle while hovering (armed, clear of the ground, not climbing)
+  * 	   NOTE: throttle is tilt compensated by the mixer, so any attitude counts
+  *
+  * @param  throttle	applied throttle (%)
+  * @param	est			read-only pointer to altitude estimate handle
+  * @param	dt			timestep
+  *
+  * @retval change of the hover throttle (%)
+  */
+static float learn_hover_throttle(float throttle, const altitude_est_t *est, float dt) {
+	float prev = hover_throttle_pct;
+
+	if (!esc_is_armed() || !est->valid || (est->altitude_m < ALT_HOVER_LEARN_ALT_M) ||
+		(fabsf(est->climb_rate_mps) > ALT_HOVER_LEARN_CLIMB_MPS))
+		return 0.0f;
+
+	hover_throttle_pct += (throttle - hover_throttle_pct) * (dt / (ALT_HOVER_LEARN_TAU_S + dt));
+	hover_throttle_pct = constrainf(hover_throttle_pct, params_get_def(PARAM_ALT_HOVER_THROTTLE_PCT)->min,
+									params_get_def(PARAM_ALT_HOVER_THROTTLE_PCT)->max);
+
+	return hover_throttle_pct - prev;
+}
+
+/**
+  * @brief helper function to hand the throttle to altitude hold without a
+  * 	   step: holds the current altitude, and the climb rate integrator takes
+  * 	   up the difference between the current and the hover throttle
+  *
+  * @param  cmd		pointer to altitude hold command handle
+  * @param	est		read-only pointer to altitude estimate handle
+  *
+  * @retval None
+  */
+static void engage(altitude_cmd_t *cmd, const altitude_est_t *est) {
+	cmd->engaged = true;
+	cmd->target_alt_m = est->altitude_m;
+	cmd->climb_rate_req_mps = 0.0f;
+
+	pid_resync(&alt_pos_pid, cmd->target_alt_m, est->altitude_m);
+	pid_resync(&alt_vel_pid, 0.0f, est->climb_rate_mps);
+
+	if (alt_vel_pid.Ki > 0.0f)
+		alt_vel_pid.integrator = constrainf((cmd->throttle - hover_throttle_pct) / alt_vel_pid.Ki,
+											-alt_vel_pid.integrator_limit, alt_vel_pid.integrator_limit);
+
+	/* Stick is ignored until centered once (e.g. engaged at the manual hover throttle) */
+	stick_released = false;
+	exit_blend_s = 0.0f;
+
+	/* Run the cascade on the next update */
+	cascade_phase_s = ALT_HOLD_PERIOD_S;
+	cascade_dt_s = 0.0f;
+}
+
+/**
+  * @brief helper function to hand the throttle back to the stick
+  *
+  * @param  cmd		pointer to altitude hold command handle
+  * @param	blend	whether to blend from the last altitude hold throttle
+  *
+  * @retval None
+  */
+static void disengage(altitude_cmd_t *cmd, bool blend) {
+	cmd->engaged = false;
+	cmd->climb_rate_req_mps = 0.0f;
+	exit_throttle_pct = cmd->throttle;
+	exit_blend_s = blend ? ALT_HOLD_EXIT_BLEND_S : 0.0f;
+}
+
+/**
+  * @brief helper function to engage/leave altitude hold on flight mode switch
+  * 	   (an idle stick does not engage it, a lost estimate leaves it)
+  *
+  * @param  cmd		pointer to altitude hold command handle
+  * @param	req		read-only pointer to rc requests handle
+  * @param	est		read-only pointer to altitude estimate handle
+  * @param	mode	current flight mode
+  *
+  * @retval None
+  */
+static void flight_mode_switch_check(altitude_cmd_t *cmd, const rc_reqs_t *req, const altitude_est_t *est,
+									 mode_status_t mode) {
+	bool alt_hold = (mode == ALT_HOLD_MODE);
+
+	if (!cmd->engaged) {
+		if (alt_hold && est->valid && !rc_is_throttle_idle(req->throttle))
+			engage(cmd, est);
+
+	} else if (!alt_hold || !est->valid) {
+		disengage(cmd, true);
+	}
+}
+
+/**
+  * @brief helper function to run the altitude -> climb rate -> throttle cascade
+  *
+  * @param  cmd		pointer to altitude hold command handle
+  * @param	req		read-only pointer to rc requests handle
+  * @param	est		read-only pointer to altitude estimate handle
+  * @param	dt		time since the last cascade update
+  *
+  * @retval None
+  */
+static void alt_hold_cascade(altitude_cmd_t *cmd, const rc_reqs_t *req, const altitude_est_t *est, float dt) {
+	float climb_req = stick_climb_rate(req->throttle);
+
+	/* Hold Until the Stick was Centered Once */
+	if (!stick_released) {
+		stick_released = (climb_req == 0.0f);
+		climb_req = 0.0f;
+	}
+
+	if (climb_req != 0.0f) {
+		/* Pilot Climb: target follows the estimate */
+		cmd->target_alt_m = est->altitude_m;
+		pid_resync(&alt_pos_pid, cmd->target_alt_m, est->altitude_m);
+	} else {
+		/* Hold Target Altitude */
+		climb_req = pid_update(&alt_pos_pid, cmd->target_alt_m, est->altitude_m, dt);
+	}
+
+	/* Slew Climb Rate Request (velocity P would turn a stick step into a throttle step) */
+	float max_step = ALT_CLIMB_ACCEL_MPS2 * dt;
+	climb_req = constrainf(climb_req, cmd->climb_rate_req_mps - max_step, cmd->climb_rate_req_mps + max_step);
+	cmd->climb_rate_req_mps = climb_req;
+
+	/* Climb Rate PID Around the Hover Throttle */
+	float throttle = hover_throttle_pct + pid_update(&alt_vel_pid, climb_req, est->climb_rate_mps, dt);
+	cmd->throttle = constrainf(throttle, THROTTLE_MIN_PCT, THROTTLE_MAX_PCT);
+
+	/* Learn Hover Throttle (moved out of the integrator, so the throttle is unchanged) */
+	float delta = learn_hover_throttle(cmd->throttle, est, dt);
+	if (alt_vel_pid.Ki > 0.0f)
+		alt_vel_pid.integrator = constrainf(alt_vel_pid.integrator - delta / alt_vel_pid.Ki,
+											-alt_vel_pid.integrator_limit, alt_vel_pid.integrator_limit);
+}
+
+/**
+  * @brief updates the throttle: the stick, or altitude hold (cascade at
+  * 	   CONFIG_ALT_HOLD_RATE_HZ, throttle held in between)
+  *
+  * @param  cmd		pointer to altitude hold command handle
+  * @param	req		read-only pointer to rc requests handle
+  * @param	est		read-only pointer to altitude estimate handle
+  * @param	mode	current flight mode
+  * @param	dt		timestep
+  *
+  * @retval altitude status type (WARN if alt hold is selected without an estimate)
+  */
+altitude_status_t altitude_controller_update(altitude_cmd_t *cmd, const rc_reqs_t *req, const altitude_est_t *est,
+											 mode_status_t mode, float dt) {
+	altitude_status_t status = ALTITUDE_OK;
+
+	/* Detect Mode Change and Handle Transition */
+	flight_mode_switch_check(cmd, req, est, mode);
+
+	if (!cmd->engaged) {
+		if ((mode == ALT_HOLD_MODE) && !est->valid)
+			status = ALTITUDE_ERROR_WARN;
+
+		/* Stick Throttle (blended in after leaving alt hold; idle passes straight through) */
+		cmd->throttle = req->throttle;
+		if (rc_is_throttle_idle(req->throttle))
+			exit_blend_s = 0.0f;
+
+		if (exit_blend_s > 0.0f) {
+			float w = exit_blend_s / ALT_HOLD_EXIT_BLEND_S;
+			cmd->throttle = w * exit_throttle_pct + (1.0f - w) * req->throttle;
+			exit_blend_s -= dt;
+		}
+
+		learn_hover_throttle(cmd->throttle, est, dt);
+		cmd->hover_throttle = hover_throttle_pct;
+		return status;
+	}
+
+	/* Landed: full descent requested, throttle at its floor, not moving */
+	if (rc_is_throttle_idle(req->throttle) && (alt_vel_pid.out <= -alt_vel_pid.limit) &&
+		(fabsf(est->climb_rate_mps) < ALT_HOVER_LEARN_CLIMB_MPS)) {
+		disengage(cmd, false);
+		cmd->throttle = req->throttle;
+		return status;
+	}
+
+	/* Run Cascade on the First Loop of Each Period */
+	cascade_phase_s += dt;
+	cascade_dt_s += dt;
+	if (cascade_phase_s < ALT_HOLD_PERIOD_S)
+		return status;
+
+	cascade_phase_s -= ALT_HOLD_PERIOD_S;
+	if (cascade_phase_s >= ALT_HOLD_PERIOD_S)
+		cascade_phase_s = 0.0f;		// late (stall): restart the period
+
+	alt_hold_cascade(cmd, req, est, cascade_dt_s);
+	cascade_dt_s = 0.0f;
+	cmd->hover_throttle = hover_throttle_pct;
+
+	return status;
+}
+
+/**
+  * @brief resets altitude hold (stick throttle, no blend), e.g. on arming
+  * 	   after the ground reference moved
+  *
+  * @param  cmd		pointer to altitude hold command handle
+  * @retval None
+  */
+void altitude_controller_reset(altitude_cmd_t *cmd) {
+	disengage(cmd, false);
+	pid_reset(&alt_pos_pid);
+	pid_reset(&alt_vel_pid);
+}
+
+/**
+  * @brief helper function to load a PID config from its parameter block
+  *
+  * @param  idx		index into PID parameter map
+  * @param	config	pid config buffer to be filled
+  *
+  * @retval None
+  */
+static void load_pid_config(uint32_t idx, pid_config_t *config) {
+	param_id_t first = pid_params[idx].first;
+
+	config->Kp = params_get_float(first + 0);
+	config->Ki = params_get_float(first + 1);
+	config->Kd = params_get_float(first + 2);
+	config->Wc = params_get_float(first + 3);
+	config->limit = params_get_float(first + 4);
+	config->integrator_limit = params_get_float(first + 5);
+}
+
+/**
+  * @brief parameter change listener: reconfigures only the affected PID
+  * 	   (state is kept), or refreshes cached values
+  * 	   NOTE: a new hover throttle replaces the learned one
+  *
+  * @param  id		changed parameter id
+  * @retval None
+  */
+static void on_param_change(param_id_t id) {
+	pid_config_t config;
+
+	for (uint32_t i = 0; i < PID_PARAM_COUNT; ++i) {
+		if ((id >= pid_params[i].first) && (id < (pid_params[i].first + PID_PARAM_BLOCK))) {
+			load_pid_config(i, &config);
+			pid_configure(pid_params[i].ctrl, &config);
+		}
+	}
+
+	if (id == PARAM_ALT_HOVER_THROTTLE_PCT)
+		hover_throttle_pct = params_get_float(PARAM_ALT_HOVER_THROTTLE_PCT);
+
+	climb_max_mps = params_get_float(PARAM_ALT_CLIMB_MAX_MPS);
+}
+
+/**
+  * @brief init altitude hold PID controllers
+  *
+  * @retval None
+  */
+void altitude_controller_init(void) {
+	pid_config_t config;
+
+	climb_max_mps = params_get_float(PARAM_ALT_CLIMB_MAX_MPS);
+	hover_throttle_pct = params_get_float(PARAM_ALT_HOVER_THROTTLE_PCT);
+	exit_blend_s = 0.0f;
+
+	for (uint32_t i = 0; i < PID_PARAM_COUNT; ++i) {
+		load_pid_config(i, &config);
+		pid_init(pid_params[i].ctrl, &config);
+	}
+
+	params_subscribe(PARAM_GROUP_ALTITUDE | PARAM_GROUP_PID, on_param_change);
+}
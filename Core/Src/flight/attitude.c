@@ -9,7 +9,9 @@
 #include "flight/attitude.h"
 #include "flight/mixer.h"
 #include "esc/esc.h"
+#include "params/params.h"
 #include "common/maths.h"
+#include "common/memory.h"
 #include "common/settings.h"
 
 /**
@@ -18,103 +20,55 @@
 #define ATTITUDE_FILT						CONFIG_ATTITUDE_FILT
 
 /**
-  * @brief  Complementary Filter Settings
+  * @brief  Runtime Parameter Cache (refreshed on change notification)
   */
-#define COMP_FILT_GAIN_XL	 				CONFIG_COMP_FILT_GAIN_XL
-#define COMP_FILT_GAIN_GYRO	 				CONFIG_COMP_FILT_GAIN_GYRO
+static float comp_filt_gain_xl CCM_BSS;
+static float comp_filt_gain_gyro CCM_BSS;
+static float roll_takeoff_limit_deg CCM_BSS;
+static float pitch_takeoff_limit_deg CCM_BSS;
+static float esc_cmd_liftoff_pct CCM_BSS;
+static float mag_declination_deg CCM_BSS;
+static float mag_heading_tau_s CCM_BSS;
 
 /**
-  * @brief  Attitude Angle Take-off Limit Settings
+  * @brief  Heading Fusion Settings
   */
-#define ROLL_TAKEOFF_LIMIT_DEG				CONFIG_ROLL_TAKEOFF_LIMIT_DEG
-#define PITCH_TAKEOFF_LIMIT_DEG				CONFIG_PITCH_TAKEOFF_LIMIT_DEG
+#define MAG_FIELD_TOL						(CONFIG_MAG_FIELD_TOL_PCT / 100.0f)
+#define MAG_MIN_TILT_COS					0.5f		// no fusion beyond 60 deg of tilt
 
 /*
- * @brief Attitude PID Controller Settings
+ * @brief Attitude PID Controllers (read and written every loop)
  */
-#define ROLL_ANGLE_P_GAIN					CONFIG_ROLL_ANGLE_P_GAIN
-#define ROLL_ANGLE_I_GAIN					CONFIG_ROLL_ANGLE_I_GAIN
-#define ROLL_ANGLE_D_GAIN					CONFIG_ROLL_ANGLE_D_GAIN
-#define ROLL_ANGLE_D_LPF_CUTOFF_FREQ_HZ		CONFIG_ROLL_ANGLE_D_LPF_CUTOFF_FREQ_HZ
-#define ROLL_ANGLE_CMD_LIM_DPS				CONFIG_ROLL_ANGLE_CMD_LIM_DPS
-#define ROLL_ANGLE_I_CMD_LIM_DPS			CONFIG_ROLL_ANGLE_I_CMD_LIM_DPS
-
-#define PID_CONFIG_ROLL_ANGLE				{ROLL_ANGLE_P_GAIN, \
-											 ROLL_ANGLE_I_GAIN, \
-											 ROLL_ANGLE_D_GAIN, \
-											 ROLL_ANGLE_D_LPF_CUTOFF_FREQ_HZ, \
-											 ROLL_ANGLE_CMD_LIM_DPS, \
-											 ROLL_ANGLE_I_CMD_LIM_DPS}
-
-#define PITCH_ANGLE_P_GAIN					CONFIG_PITCH_ANGLE_P_GAIN
-#define PITCH_ANGLE_I_GAIN					CONFIG_PITCH_ANGLE_I_GAIN
-#define PITCH_ANGLE_D_GAIN					CONFIG_PITCH_ANGLE_D_GAIN
-#define PITCH_ANGLE_D_LPF_CUTOFF_FREQ_HZ	CONFIG_PITCH_ANGLE_D_LPF_CUTOFF_FREQ_HZ
-#define PITCH_ANGLE_CMD_LIM_DPS				CONFIG_PITCH_ANGLE_CMD_LIM_DPS
-#define PITCH_ANGLE_I_CMD_LIM_DPS			CONFIG_PITCH_ANGLE_I_CMD_LIM_DPS
-
-#define PID_CONFIG_PITCH_ANGLE				{PITCH_ANGLE_P_GAIN, \
-											 PITCH_ANGLE_I_GAIN, \
-											 PITCH_ANGLE_D_GAIN, \
-											 PITCH_ANGLE_D_LPF_CUTOFF_FREQ_HZ, \
-											 PITCH_ANGLE_CMD_LIM_DPS, \
-											 PITCH_ANGLE_I_CMD_LIM_DPS}
-
-#define ROLL_RATE_P_GAIN					CONFIG_ROLL_RATE_P_GAIN
-#define ROLL_RATE_I_GAIN					CONFIG_ROLL_RATE_I_GAIN
-#define ROLL_RATE_D_GAIN					CONFIG_ROLL_RATE_D_GAIN
-#define ROLL_RATE_D_LPF_CUTOFF_FREQ_HZ		CONFIG_ROLL_RATE_D_LPF_CUTOFF_FREQ_HZ
-#define ROLL_RATE_CMD_LIM_PCT				CONFIG_ROLL_RATE_CMD_LIM_PCT
-#define ROLL_RATE_I_CMD_LIM_PCT				CONFIG_ROLL_RATE_I_CMD_LIM_PCT
-
-#define PID_CONFIG_ROLL_RATE				{ROLL_RATE_P_GAIN, \
-											 ROLL_RATE_I_GAIN, \
-											 ROLL_RATE_D_GAIN, \
-											 ROLL_RATE_D_LPF_CUTOFF_FREQ_HZ, \
-											 ROLL_RATE_CMD_LIM_PCT, \
-											 ROLL_RATE_I_CMD_LIM_PCT}
-
-#define PITCH_RATE_P_GAIN					CONFIG_PITCH_RATE_P_GAIN
-#define PITCH_RATE_I_GAIN					CONFIG_PITCH_RATE_I_GAIN
-#define PITCH_RATE_D_GAIN					CONFIG_PITCH_RATE_D_GAIN
-#define PITCH_RATE_D_LPF_CUTOFF_FREQ_HZ		CONFIG_PITCH_RATE_D_LPF_CUTOFF_FREQ_HZ
-#define PITCH_RATE_CMD_LIM_PCT				CONFIG_PITCH_RATE_CMD_LIM_PCT
-#define PITCH_RATE_I_CMD_LIM_PCT			CONFIG_PITCH_RATE_I_CMD_LIM_PCT
-
-#define PID_CONFIG_PITCH_RATE				{PITCH_RATE_P_GAIN, \
-											 PITCH_RATE_I_GAIN, \
-											 PITCH_RATE_D_GAIN, \
-											 PITCH_RATE_D_LPF_CUTOFF_FREQ_HZ, \
-											 PITCH_RATE_CMD_LIM_PCT, \
-											 PITCH_RATE_I_CMD_LIM_PCT}
-
-#define YAW_RATE_P_GAIN						CONFIG_YAW_RATE_P_GAIN
-#define YAW_RATE_I_GAIN						CONFIG_YAW_RATE_I_GAIN
-#define YAW_RATE_D_GAIN						CONFIG_YAW_RATE_D_GAIN
-#define YAW_RATE_D_LPF_CUTOFF_FREQ_HZ		CONFIG_YAW_RATE_D_LPF_CUTOFF_FREQ_HZ
-#define YAW_RATE_CMD_LIM_PCT				CONFIG_YAW_RATE_CMD_LIM_PCT
-#define YAW_RATE_I_CMD_LIM_PCT				CONFIG_YAW_RATE_I_CMD_LIM_PCT
-
-#define PID_CONFIG_YAW_RATE					{YAW_RATE_P_GAIN, \
-											 YAW_RATE_I_GAIN, \
-											 YAW_RATE_D_GAIN, \
-											 YAW_RATE_D_LPF_CUTOFF_FREQ_HZ, \
-											 YAW_RATE_CMD_LIM_PCT, \
-											 YAW_RATE_I_CMD_LIM_PCT}
+static pid_ctrl_t roll_angle_pid CCM_BSS;
+static pid_ctrl_t pitch_angle_pid CCM_BSS;
+static pid_ctrl_t roll_rate_pid CCM_BSS;
+static pid_ctrl_t pitch_rate_pid CCM_BSS;
+static pid_ctrl_t yaw_rate_pid CCM_BSS;
 
 /*
- * @brief ESC Command Settings
+ * @brief PID Controller -> Parameter Block Map
+ * 		  NOTE: rate PID limits are given in % and scaled to motor commands
  */
-#define ESC_CMD_LIFTOFF_PCT					CONFIG_ESC_CMD_LIFTOFF_PCT
+static const struct {
+	pid_ctrl_t *ctrl;
+	param_id_t first;
+	bool motor_scaled;
+} pid_params[] = {
+	{&roll_angle_pid,  PARAM_ROLL_ANGLE_P,  false},
+	{&pitch_angle_pid, PARAM_PITCH_ANGLE_P, false},
+	{&roll_rate_pid,   PARAM_ROLL_RATE_P,   true},
+	{&pitch_rate_pid,  PARAM_PITCH_RATE_P,  true},
+	{&yaw_rate_pid,    PARAM_YAW_RATE_P,    true}
+};
+
+#define PID_PARAM_COUNT		(sizeof(pid_params) / sizeof(pid_params[0]))
+#define PID_PARAM_BLOCK		6U	// fields per PID parameter block
 
 /*
- * @brief Attitude PID Controllers
+ * @brief Controller Transition Tracking (reset by attitude_controller_init)
  */
-static pid_ctrl_t roll_angle_pid;
-static pid_ctrl_t pitch_angle_pid;
-static pid_ctrl_t roll_rate_pid;
-static pid_ctrl_t pitch_rate_pid;
-static pid_ctrl_t yaw_rate_pid;
+static mode_status_t prev_mode CCM_DATA = ANGLE_MODE;
+static bool prev_integrator_hold CCM_DATA = false;
 
 
 #if ATTITUDE_FILT == COMP_FILT_ID
@@ -126,7 +80,7 @@ static pid_ctrl_t yaw_rate_pid;
   *
   * @retval None
   */
-static void complementary_filter(const imu_6D_t *imu, attitude_est_t *est) {
+RAM_FUNC static void complementary_filter(const imu_6D_t *imu, attitude_est_t *est) {
 	/*
 	 * No Inf check needed due to bounded xl data
 	 * No NaN check needed due to guaranteed valid xl data
@@ -136,13 +90,14 @@ static void complementary_filter(const imu_6D_t *imu, attitude_est_t *est) {
 	float xl_roll_est_deg = RAD_TO_DEG(atan2f(imu->accel_y, sqrtf(sq(imu->accel_z) + sq(imu->accel_x))));
 	float xl_pitch_est_deg = RAD_TO_DEG(atan2f(-(imu->accel_x), sqrtf(sq(imu->accel_z) + sq(imu->accel_y))));
 
-	/* Convert gyro data to roll and pitch angle estimates */
-	float gyro_roll_est_deg = (est->roll_rate_dps * USEC_TO_SEC(imu->dt)) + est->roll_angle_deg;
-	float gyro_pitch_est_deg = (est->pitch_rate_dps * USEC_TO_SEC(imu->dt)) + est->pitch_angle_deg;
+	/* Convert gyro data to roll and pitch angle estimates (imu dt is integral us) */
+	float dt = USEC_TO_SEC((float) imu->dt);
+	float gyro_roll_est_deg = (est->roll_rate_dps * dt) + est->roll_angle_deg;
+	float gyro_pitch_est_deg = (est->pitch_rate_dps * dt) + est->pitch_angle_deg;
 
 	/* Apply complementary filter to get combined estimates */
-	est->roll_angle_deg = (COMP_FILT_GAIN_GYRO) * gyro_roll_est_deg + (COMP_FILT_GAIN_XL) * xl_roll_est_deg;
-	est->pitch_angle_deg = (COMP_FILT_GAIN_GYRO) * gyro_pitch_est_deg + (COMP_FILT_GAIN_XL) * xl_pitch_est_deg;
+	est->roll_angle_deg = comp_filt_gain_gyro * gyro_roll_est_deg + comp_filt_gain_xl * xl_roll_est_deg;
+	est->pitch_angle_deg = comp_filt_gain_gyro * gyro_pitch_est_deg + comp_filt_gain_xl * xl_pitch_est_deg;
 }
 #endif
 
@@ -168,6 +123,93 @@ attitude_status_t attitude_estimator_update(const imu_6D_t *imu, attitude_est_t
 	return ATTITUDE_OK;
 }
 
+/**
+  * @brief helper function to wrap an angle to -180..180
+  *
+  * @param  deg		angle (deg)
+  * @retval wrapped angle (deg)
+  */
+static inline float wrap_180(float deg) {
+	deg = fmodf(deg, 360.0f);
+	if (deg > 180.0f)
+		deg -= 360.0f;
+	else if (deg < -180.0f)
+		deg += 360.0f;
+
+	return deg;
+}
+
+/**
+  * @brief updates the heading: integrates the gyro every loop and pulls it
+  * 	   toward the tilt compensated magnetometer heading (gain dt / tau) on
+  * 	   each fresh sample
+  * 	   NOTE: samples taken steeply tilted, or with a field strength off the
+  * 	   running average (motor currents, nearby iron), are not fused; without
+  * 	   a magnetometer heading_valid stays false
+  *
+  * @param  imu		read-only pointer to imu 6d sensor handle (mdps)
+  * @param	mag		read-only pointer to mag sample (used if fresh)
+  * @param	est		pointer to attitude handle (roll / pitch already updated)
+  *
+  * @retval attitude status type
+  */
+attitude_status_t attitude_heading_update(const imu_6D_t *imu, const mag_data_t *mag, attitude_est_t *est) {
+	float sr = sinf(DEG_TO_RAD(est->roll_angle_deg));
+	float cr = cosf(DEG_TO_RAD(est->roll_angle_deg));
+	float sp = sinf(DEG_TO_RAD(est->pitch_angle_deg));
+	float cp = cosf(DEG_TO_RAD(est->pitch_angle_deg));
+	float dt = USEC_TO_SEC((float) imu->dt);	// imu dt is integral us
+
+	/* Gyro: body rates to heading rate (yaw is counter-clockwise positive about z up) */
+	est->heading_deg -= (MDPS_TO_DPS(sr * imu->rate_y + cr * imu->rate_z) / fmaxf(cp, 0.1f)) * dt;
+	est->mag_dt_s += dt;
+
+	if (mag->fresh && (cp >= MAG_MIN_TILT_COS)) {
+		const float *m = mag->field_mgauss;
+		float field = sqrtf(sq(m[0]) + sq(m[1]) + sq(m[2]));
+
+		if (est->mag_field_avg_mgauss <= 0.0f)
+			est->mag_field_avg_mgauss = field;
+
+		bool undisturbed = fabsf(field - est->mag_field_avg_mgauss) <= (MAG_FIELD_TOL * est->mag_field_avg_mgauss);
+
+		/* Field strength average follows slow changes (same time constant) */
+		est->mag_field_avg_mgauss += fminf(est->mag_dt_s / mag_heading_tau_s, 1.0f) * (field - est->mag_field_avg_mgauss);
+
+		if (undisturbed) {
+			/* Level frame: forward, left; north lies at the heading counter-clockwise from forward */
+			float fwd = cp * m[0] + sp * (sr * m[1] + cr * m[2]);
+			float left = cr * m[1] - sr * m[2];
+			float mag_heading_deg = RAD_TO_DEG(atan2f(left, fwd)) + mag_declination_deg;
+
+			if (!est->heading_valid) {
+				est->heading_deg = mag_heading_deg;
+				est->heading_valid = true;
+			} else {
+				float gain = fminf(est->mag_dt_s / mag_heading_tau_s, 1.0f);
+				est->heading_deg += gain * wrap_180(mag_heading_deg - est->heading_deg);
+			}
+			est->mag_dt_s = 0.0f;
+		}
+	}
+
+	est->heading_deg = fmodf(est->heading_deg, 360.0f);
+	if (est->heading_deg < 0.0f)
+		est->heading_deg += 360.0f;
+
+	return ATTITUDE_OK;
+}
+
+/**
+  * @brief helper function to check whether a flight mode runs the angle PIDs
+  *
+  * @param  mode	flight mode
+  * @retval boolean
+  */
+static inline bool is_self_leveling(mode_status_t mode) {
+	return (mode == ANGLE_MODE) || (mode == ALT_HOLD_MODE);
+}
+
 /**
   * @brief helper function to resync pid controllers on flight mode switch
   *
@@ -178,16 +220,15 @@ attitude_status_t attitude_estimator_update(const imu_6D_t *imu, attitude_est_t
   * @retval None
   */
 static void flight_mode_switch_check(const rc_reqs_t *req, const attitude_est_t *est, mode_status_t curr_mode) {
-	static mode_status_t prev_mode = ANGLE_MODE;
-
 	if (curr_mode != prev_mode) {
-		if (curr_mode == ANGLE_MODE) {
+		if (is_self_leveling(curr_mode) && !is_self_leveling(prev_mode)) {
 			/* Resync angle PIDs to current attitude on mode switch */
 			pid_resync(&roll_angle_pid, req->roll_angle, est->roll_angle_deg);
 			pid_resync(&pitch_angle_pid, req->pitch_angle, est->pitch_angle_deg);
 
 		}
 		/* RATE mode: no reset needed; rate PIDs continue running */
+		/* ANGLE <-> ALT_HOLD: angle PIDs continue running (throttle handled by altitude.c) */
 		prev_mode = curr_mode;
 	}
 }
@@ -199,8 +240,7 @@ static void flight_mode_switch_check(const rc_reqs_t *req, const attitude_est_t
   * @retval None
   */
 static void integrator_hold_check(float throttle) {
-	static bool prev_integrator_hold = false;
-	bool low_throttle = (throttle < ESC_CMD_LIFTOFF_PCT);
+	bool low_throttle = (throttle < esc_cmd_liftoff_pct);
 	bool armed = esc_is_armed();
 	bool integrator_hold =  low_throttle || !armed;
 
@@ -270,8 +310,8 @@ attitude_status_t attitude_controller_update(attitude_cmd_t *cmd, const rc_reqs_
 	float roll_rate_req = req->roll_rate;
 	float pitch_rate_req = req->pitch_rate;
 
-	/* Update Roll/Pitch Rate Requests (if in Angle Mode) */
-	if (flight_mode == ANGLE_MODE) {
+	/* Update Roll/Pitch Rate Requests (if in Angle or Altitude Hold Mode) */
+	if (is_self_leveling(flight_mode)) {
 		/* Apply Angle PIDs */
 		roll_rate_req = pid_update(&roll_angle_pid, req->roll_angle, est->roll_angle_deg, dt);
 		pitch_rate_req = pid_update(&pitch_angle_pid, req->pitch_angle, est->pitch_angle_deg, dt);
@@ -285,28 +325,91 @@ attitude_status_t attitude_controller_update(attitude_cmd_t *cmd, const rc_reqs_
 	return ATTITUDE_OK;
 }
 
+/**
+  * @brief helper function to load a PID config from its parameter block
+  *
+  * @param  idx		index into PID parameter map
+  * @param	config	pid config buffer to be filled
+  *
+  * @retval None
+  */
+static void load_pid_config(uint32_t idx, pid_config_t *config) {
+	param_id_t first = pid_params[idx].first;
+
+	config->Kp = params_get_float(first + 0);
+	config->Ki = params_get_float(first + 1);
+	config->Kd = params_get_float(first + 2);
+	config->Wc = params_get_float(first + 3);
+	config->limit = params_get_float(first + 4);
+	config->integrator_limit = params_get_float(first + 5);
+
+	if (pid_params[idx].motor_scaled) {
+		config->limit = map_pct_to_mtr_span(config->limit);
+		config->integrator_limit = map_pct_to_mtr_span(config->integrator_limit);
+	}
+}
+
+/**
+  * @brief helper function to refresh cached estimator / take-off parameters
+  *
+  * @retval None
+  */
+static void load_attitude_params(void) {
+	comp_filt_gain_xl = params_get_float(PARAM_COMP_FILT_GAIN_XL);
+	comp_filt_gain_gyro = 1.0f - comp_filt_gain_xl;
+	roll_takeoff_limit_deg = params_get_float(PARAM_ROLL_TAKEOFF_LIMIT_DEG);
+	pitch_takeoff_limit_deg = params_get_float(PARAM_PITCH_TAKEOFF_LIMIT_DEG);
+	esc_cmd_liftoff_pct = params_get_float(PARAM_ESC_CMD_LIFTOFF_PCT);
+	mag_declination_deg = params_get_float(PARAM_MAG_DECLINATION_DEG);
+	mag_heading_tau_s = params_get_float(PARAM_MAG_HEADING_TAU_S);
+}
+
+/**
+  * @brief parameter change listener: reconfigures only the affected PID
+  * 	   (state is kept), or refreshes cached values
+  *
+  * @param  id		changed parameter id
+  * @retval None
+  */
+static void on_param_change(param_id_t id) {
+	pid_config_t config;
+	bool esc_changed = (params_get_def(id)->group == PARAM_GROUP_ESC);
+
+	for (uint32_t i = 0; i < PID_PARAM_COUNT; ++i) {
+		bool in_block = (id >= pid_params[i].first) && (id < (pid_params[i].first + PID_PARAM_BLOCK));
+
+		/* ESC range changes rescale the motor-scaled limits */
+		if (in_block || (esc_changed && pid_params[i].motor_scaled)) {
+			load_pid_config(i, &config);
+			pid_configure(pid_params[i].ctrl, &config);
+		}
+	}
+
+	load_attitude_params();
+}
+
 /**
   * @brief init attitude PID controllers
+  * 	   NOTE: call after mixer_init (rate PID limits map through the mixer)
   *
   * @retval None
   */
 void attitude_controller_init(void) {
-	/* Init Angle PIDs */
-	pid_init(&roll_angle_pid, &(pid_config_t)PID_CONFIG_ROLL_ANGLE);
-	pid_init(&pitch_angle_pid, &(pid_config_t)PID_CONFIG_PITCH_ANGLE);
-
-	/* Init Rate PIDs */
-	pid_init(&roll_rate_pid, &(pid_config_t)PID_CONFIG_ROLL_RATE);
-	roll_rate_pid.limit = map_pct_to_mtr_cmd(roll_rate_pid.limit);
-	roll_rate_pid.integrator_limit = map_pct_to_mtr_cmd(roll_rate_pid.integrator_limit);
-
-	pid_init(&pitch_rate_pid, &(pid_config_t)PID_CONFIG_PITCH_RATE);
-	pitch_rate_pid.limit = map_pct_to_mtr_cmd(pitch_rate_pid.limit);
-	pitch_rate_pid.integrator_limit = map_pct_to_mtr_cmd(pitch_rate_pid.integrator_limit);
-
-	pid_init(&yaw_rate_pid, &(pid_config_t)PID_CONFIG_YAW_RATE);
-	yaw_rate_pid.limit = map_pct_to_mtr_cmd(yaw_rate_pid.limit);
-	yaw_rate_pid.integrator_limit = map_pct_to_mtr_cmd(yaw_rate_pid.integrator_limit);
+	pid_config_t config;
+
+	load_attitude_params();
+
+	/* Match PID init state (integrators enabled, angle mode) */
+	prev_mode = ANGLE_MODE;
+	prev_integrator_hold = false;
+
+	/* Init Angle and Rate PIDs */
+	for (uint32_t i = 0; i < PID_PARAM_COUNT; ++i) {
+		load_pid_config(i, &config);
+		pid_init(pid_params[i].ctrl, &config);
+	}
+
+	params_subscribe(PARAM_GROUP_ATTITUDE | PARAM_GROUP_PID | PARAM_GROUP_ESC | PARAM_GROUP_MAG, on_param_change);
 }
 
 /**
@@ -328,5 +431,5 @@ bool attitude_is_right_side_up(float accel_z) {
   */
 bool attitude_within_limits(const attitude_est_t *est) {
 	/* Check roll & pitch angles are within tolerance */
-	return (fabs(est->roll_angle_deg) < ROLL_TAKEOFF_LIMIT_DEG) && (fabs(est->pitch_angle_deg) < PITCH_TAKEOFF_LIMIT_DEG);
+	return (fabs(est->roll_angle_deg) < roll_takeoff_limit_deg) && (fabs(est->pitch_angle_deg) < pitch_takeoff_limit_deg);
 }
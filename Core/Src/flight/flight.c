@@ -0,0 +1,157 @@
+/*
+ * flight.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "flight/flight.h"
+#include "flight/mixer.h"
+#include "system/system.h"
+#include "common/maths.h"
+#include "common/cycles.h"
+#include "common/settings.h"
+
+/**
+  * @brief Thrust Compensation Config Setting
+  */
+#define THRUST_COMP			CONFIG_THRUST_COMP
+
+
+/**
+  * @brief init flight loop data
+  *
+  * @param  fd		pointer to flight loop data handle
+  * @retval None
+  */
+void flight_init(flight_data_t *fd) {
+	memset(fd, 0, sizeof(*fd));
+	position_estimator_init(&fd->pos, CONFIG_GPS_DELAY_MS * 1000U);
+	fd->arm_reset = true;
+}
+
+/**
+  * @brief one flight loop iteration: rc -> imu/mag/baro/gps/battery/esc telemetry -> estimators -> controllers ->
+  * 	   mixer -> arm logic -> esc
+  * 	   NOTE: shared by the firmware main loop and the host simulator, so it
+  * 	   must not touch HAL, storage or the USB link directly
+  *
+  * @param  fd		pointer to flight loop data handle
+  * @param	status	flight loop status buffer to be filled
+  *
+  * @retval None
+  */
+void flight_update(flight_data_t *fd, flight_status_t *status) {
+	uint32_t control_start;
+	float dt;
+
+	status->esc = ESC_OK;
+	status->disarmed = false;
+
+	/* Get Remote Control Input */
+	status->rc = rc_get_requests(&fd->req);
+
+	/* Read IMU */
+	status->imu = imu_read(&fd->imu);
+	dt = USEC_TO_SEC((float) fd->imu.dt);	// imu dt is in us
+
+	/* Get Magnetometer Sample (delivered with the imu read; fresh at its own rate) */
+	status->mag = mag_read(&fd->mag);
+
+	/* Service Barometer (non-blocking; fresh only when a conversion was fetched) */
+	status->baro = baro_read(&fd->baro);
+
+	/* Service GPS (non-blocking; fresh only when a solution completed) */
+	status->gps = gps_read(&fd->gps);
+
+	/* Get Battery State (non-blocking; updated at its own period) */
+	status->battery = battery_read(&fd->batt);
+
+	/* Service ESC Telemetry (non-blocking; the next frame is requested with the coming motor commands) */
+	status->esc_tlm = esc_telemetry_read(&fd->esc_tlm);
+
+	/* Update Attitude Estimation */
+	control_start = cycles_now();
+	status->estimator = attitude_estimator_update(&fd->imu, &fd->est);
+	if (status->estimator == ATTITUDE_OK)
+		status->estimator = attitude_heading_update(&fd->imu, &fd->mag, &fd->est);
+
+	/* Update Altitude Estimation (accel rotated by the attitude just estimated) */
+	status->altitude = altitude_estimator_update(&fd->imu, &fd->est, &fd->baro, &fd->alt);
+
+	/* Update Position Estimation (horizontal; delayed gps fused against the history) */
+	status->position = position_estimator_update(&fd->imu, &fd->est, &fd->gps, &fd->pos);
+
+	/* Update Altitude Hold (throttle: stick, or altitude / climb rate cascade) */
+	status->alt_hold = altitude_controller_update(&fd->alt_cmd, &fd->req, &fd->alt, rc_get_flight_mode(), dt);
+
+	/* Update Attitude PID Controllers */
+	status->controller = attitude_controller_update(&fd->cmd, &fd->req, &fd->est, dt);
+
+	/* Apply Motor Mixing */
+	mixer_update(&fd->mcmd, &fd->cmd, fd->alt_cmd.throttle);
+
+	#if THRUST_COMP == ENABLED
+	/* Apply Thrust Compensation */
+	thrust_compensate(&fd->mcmd, &fd->est);
+	#endif
+
+	status->control_cycles = cycles_now() - control_start;
+
+	/* Keep Motors Off on Kill (a crash isr may have disarmed already; arm switch must be reset after) */
+	if (fd->kill) {
+		if (esc_is_armed()) {
+			status->esc = esc_disarm();
+			status->disarmed = true;
+		}
+
+		status->phase = FLIGHT_PHASE_DISARMED;
+		fd->arm_reset = false;
+
+	/* Check if Remote Control is Armed */
+	} else if (rc_is_armed()) {
+		/* Set Motor Commands */
+		if (esc_is_armed()) {
+			status->esc = esc_set_motor_commands(&fd->mcmd);
+
+			/* Flying unless a crash isr locked the escs during the write */
+			status->phase = esc_is_armed() ? FLIGHT_PHASE_FLYING : FLIGHT_PHASE_DISARMED;
+
+		/* Refuse Arming While Inhibited by Caller (arm switch must be reset after) */
+		} else if (fd->arm_inhibit) {
+			status->phase = FLIGHT_PHASE_WAITING;
+			fd->arm_reset = false;
+
+		/* Arm ESC (if ready) */
+		} else {
+			/* Check if Ready to Fly */
+			if (ready_to_fly(fd->imu.accel_z, &fd->est, fd->req.throttle)) {
+				status->phase = FLIGHT_PHASE_READY;
+
+				/* Check if Arm Switch was Reset and Arming not Held (altitude reads zero at takeoff) */
+				if (fd->arm_reset && !fd->arm_hold) {
+					status->esc = esc_arm();
+					if (esc_is_armed()) {
+						altitude_estimator_rezero(&fd->alt);
+						altitude_controller_reset(&fd->alt_cmd);
+					}
+				}
+
+			} else {
+				status->phase = FLIGHT_PHASE_WAITING;
+				fd->arm_reset = false;
+			}
+		}
+
+	} else {
+		/* Disarm ESC (if not already) */
+		if (esc_is_armed()) {
+			status->esc = esc_disarm();
+			status->disarmed = true;
+		}
+
+		status->phase = FLIGHT_PHASE_DISARMED;
+		fd->arm_reset = true;
+	}
+}
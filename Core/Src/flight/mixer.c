@@ -7,7 +7,9 @@
 
 #include <math.h>
 #include "flight/mixer.h"
+#include "params/params.h"
 #include "common/maths.h"
+#include "common/memory.h"
 #include "common/settings.h"
 
 /**
@@ -15,18 +17,11 @@
   */
 #define THRUST_COMP			CONFIG_THRUST_COMP
 
-/**
-  * @brief Angular Rate Command Limit Config Settings
-  */
-#define ROLL_CMD_MAX_PCT	CONFIG_ROLL_RATE_CMD_LIM_PCT
-#define PITCH_CMD_MAX_PCT	CONFIG_PITCH_RATE_CMD_LIM_PCT
-#define YAW_CMD_MAX_PCT		CONFIG_YAW_RATE_CMD_LIM_PCT
-
 /**
   * @brief Throttle Command Limits
   */
-static float THROTTLE_CMD_MIN;
-static float THROTTLE_CMD_MAX;
+static float THROTTLE_CMD_MIN CCM_BSS;
+static float THROTTLE_CMD_MAX CCM_BSS;
 
 /**
   * @brief Motor Command Properties Type
@@ -42,7 +37,7 @@ typedef struct {
 /**
   * @brief Motor Command Properties Handle
   */
-static mtr_cmd_props_t mtr_cmd_props;
+static mtr_cmd_props_t mtr_cmd_props CCM_BSS;
 
 
 /**
@@ -56,11 +51,23 @@ float map_pct_to_mtr_cmd(float pct) {
 }
 
 /**
-  * @brief init motor mixer
+  * @brief calculates mtr cmd span (offset-free) based on pct, for limits on
+  * 	   commands that are added to the throttle command
+  *
+  * @param  pct		percentage of the mtr command range
+  * @retval mtr command span
+  */
+float map_pct_to_mtr_span(float pct) {
+	return (mtr_cmd_props.max - mtr_cmd_props.min) * (pct / 100.0f);
+}
+
+/**
+  * @brief helper function to (re)compute motor command properties and
+  * 	   throttle command limits from the ESC and rate command limits
   *
   * @retval None
   */
-void mixer_init(void) {
+static void update_command_limits(void) {
 	esc_cmd_props_t esc_cmd_props;
 	esc_get_command_properties(&esc_cmd_props);
 
@@ -72,15 +79,42 @@ void mixer_init(void) {
 	mtr_cmd_props.limit = (float)esc_cmd_props.limit;
 
 	/* Compute Max Commands for Roll/Pitch/Yaw */
-	float roll_cmd_max = map_pct_to_mtr_cmd(ROLL_CMD_MAX_PCT);
-	float pitch_cmd_max = map_pct_to_mtr_cmd(PITCH_CMD_MAX_PCT);
-	float yaw_cmd_max = map_pct_to_mtr_cmd(YAW_CMD_MAX_PCT);
+	float roll_cmd_max = map_pct_to_mtr_span(params_get_float(PARAM_ROLL_RATE_CMD_LIM));
+	float pitch_cmd_max = map_pct_to_mtr_span(params_get_float(PARAM_PITCH_RATE_CMD_LIM));
+	float yaw_cmd_max = map_pct_to_mtr_span(params_get_float(PARAM_YAW_RATE_CMD_LIM));
 
 	/* Compute and Init Limits for Throttle Commands */
 	THROTTLE_CMD_MIN = mtr_cmd_props.idle;
 	THROTTLE_CMD_MAX = mtr_cmd_props.limit - (roll_cmd_max + pitch_cmd_max + yaw_cmd_max);
 }
 
+/**
+  * @brief parameter change listener: recomputes limits when the ESC range
+  * 	   or a rate command limit changes
+  *
+  * @param  id		changed parameter id
+  * @retval None
+  */
+static void on_param_change(param_id_t id) {
+	if ((params_get_def(id)->group == PARAM_GROUP_ESC) ||
+		(id == PARAM_ROLL_RATE_CMD_LIM) ||
+		(id == PARAM_PITCH_RATE_CMD_LIM) ||
+		(id == PARAM_YAW_RATE_CMD_LIM)) {
+		update_command_limits();
+	}
+}
+
+/**
+  * @brief init motor mixer
+  * 	   NOTE: call after esc_init (limits derive from ESC command properties)
+  *
+  * @retval None
+  */
+void mixer_init(void) {
+	update_command_limits();
+	params_subscribe(PARAM_GROUP_ESC | PARAM_GROUP_PID, on_param_change);
+}
+
 /**
   * @brief motor mixing algorithm
   *
@@ -90,7 +124,7 @@ void mixer_init(void) {
   *
   * @retval None
   */
-void mixer_update(mtr_cmds_t *mcmd, const attitude_cmd_t *acmd, float throttle_req_pct) {
+RAM_FUNC void mixer_update(mtr_cmds_t *mcmd, const attitude_cmd_t *acmd, float throttle_req_pct) {
 	float roll_cmd = acmd->roll;
 	float pitch_cmd = acmd->pitch;
 	float yaw_cmd = acmd->yaw;
@@ -114,7 +148,7 @@ void mixer_update(mtr_cmds_t *mcmd, const attitude_cmd_t *acmd, float throttle_r
   *
   * @retval None
   */
-void thrust_compensate(mtr_cmds_t *mcmd, const attitude_est_t *est) {
+RAM_FUNC void thrust_compensate(mtr_cmds_t *mcmd, const attitude_est_t *est) {
 	float thrust_ratio = 1.0f / (cosf(DEG_TO_RAD(est->roll_angle_deg)) * cosf(DEG_TO_RAD(est->pitch_angle_deg)));
 
 	mcmd->mtr1 = thrust_ratio * (mcmd->mtr1) - mtr_cmd_props.min * (thrust_ratio - 1);
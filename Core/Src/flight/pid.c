@@ -8,6 +8,7 @@
 #include <math.h>
 #include "flight/pid.h"
 #include "common/maths.h"
+#include "common/memory.h"
 
 /**
   * @brief pid controller update
@@ -19,10 +20,15 @@
   *
   * @retval pid controller output (constrained)
   */
-float pid_update(pid_ctrl_t *pid, float setpoint, float measurement, float dt) {
+RAM_FUNC float pid_update(pid_ctrl_t *pid, float setpoint, float measurement, float dt) {
 	/* Error Signal */
     float error = setpoint - measurement;
 
+    /* Hold on a non-finite input or timestep (a faulted estimate must not
+     * poison the integrator or differentiator state) */
+    if (!isfinite(error) || !isfinite(measurement) || !(dt > 0.0f) || !isfinite(dt))
+    	return constrainf(pid->out, -pid->limit, pid->limit);
+
     /* Integrator (with hold detection anti-windup clamp) */
     if (pid->integrator_enable) {
 		/* Command Saturation Check */
@@ -43,11 +49,15 @@ float pid_update(pid_ctrl_t *pid, float setpoint, float measurement, float dt) {
     pid->differentiator = (2.0f * (pid->prev_measurement - measurement)
     				    + (2.0f * pid->tau - dt) * pid->differentiator)
     					/ (2.0f * pid->tau + dt);
+    if (!isfinite(pid->differentiator))
+    	pid->differentiator = 0.0f;		// measurement step beyond float range
 
     /* Compute PID Output */
     pid->out = pid->Kp * error
              + pid->Ki * pid->integrator
              + pid->Kd * pid->differentiator;
+    if (isnan(pid->out))
+    	pid->out = 0.0f;				// opposing terms both overflowed
 
     /* Cache Error and Measurement */
     pid->prev_error = error;
@@ -58,6 +68,33 @@ float pid_update(pid_ctrl_t *pid, float setpoint, float measurement, float dt) {
 }
 
 
+/**
+  * @brief (re)configure pid controller gains and limits, keeping its state
+  * 	   so gains can change in flight without a transient
+  *
+  * @param  ctrl	pointer pid controller handle
+  * @param  config	pointer to pid config handle
+  *
+  * @retval None
+  */
+void pid_configure(pid_ctrl_t *ctrl, const pid_config_t *config) {
+	/* Non-finite gains and limits drop the term (limits are magnitudes) */
+	ctrl->Kp = isfinite(config->Kp) ? config->Kp : 0.0f;
+	ctrl->Ki = isfinite(config->Ki) ? config->Ki : 0.0f;
+	ctrl->Kd = isfinite(config->Kd) ? config->Kd : 0.0f;
+	ctrl->limit = isfinite(config->limit) ? fabsf(config->limit) : 0.0f;
+	ctrl->integrator_limit = isfinite(config->integrator_limit) ? fabsf(config->integrator_limit) : 0.0f;
+
+	/* Differentiator unfiltered without a valid cutoff */
+	if ((config->Wc > 0.0f) && isfinite(config->Wc))
+		ctrl->tau = RAD_PER_SEC_TO_INTERVAL(HZ_TO_RAD_PER_SEC(config->Wc));
+	else
+		ctrl->tau = 0.0f;
+
+	/* Keep integrator inside the (possibly reduced) limit */
+	ctrl->integrator = constrainf(ctrl->integrator, -ctrl->integrator_limit, ctrl->integrator_limit);
+}
+
 /**
   * @brief init pid controller
   *
@@ -67,16 +104,11 @@ float pid_update(pid_ctrl_t *pid, float setpoint, float measurement, float dt) {
   * @retval None
   */
 void pid_init(pid_ctrl_t *ctrl, const pid_config_t *config) {
-	ctrl->Kp = config->Kp;
-	ctrl->Ki = config->Ki;
-	ctrl->Kd = config->Kd;
-	ctrl->limit = config->limit;
-	ctrl->integrator_limit = config->integrator_limit;
-	ctrl->tau = RAD_PER_SEC_TO_INTERVAL(HZ_TO_RAD_PER_SEC(config->Wc));
+	ctrl->integrator = 0.0f;
+	pid_configure(ctrl, config);
 
 	ctrl->prev_error = 0.0f;
 	ctrl->prev_measurement = 0.0f;
-	ctrl->integrator = 0.0f;
 	ctrl->integrator_enable = true;
 	ctrl->differentiator = 0.0f;
 	ctrl->out = 0.0f;
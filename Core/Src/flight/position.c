@@ -0,0 +1,396 @@
+/*
+ * position.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <string.h>
+#include "flight/position.h"
+#include "common/maths.h"
+#include "common/settings.h"
+
+/**
+  * @brief  Position Estimator Config Settings
+  */
+#define POS_FILT_TAU_S				CONFIG_POS_FILT_TAU_S
+#define POS_GPS_MIN_SATS			CONFIG_POS_GPS_MIN_SATS
+#define POS_GPS_MAX_HACC_MM			((uint32_t) (CONFIG_POS_GPS_MAX_HACC_M * 1000.0f))
+#define POS_GPS_TIMEOUT_US			((uint32_t) CONFIG_POS_GPS_TIMEOUT_MS * 1000U)
+#define POS_HEADING_ALIGN_DV_MPS	CONFIG_POS_HEADING_ALIGN_DV_MPS
+
+/**
+  * @brief  Complementary Filter Gains
+  * 		velocity aided: double pole at -1/tau on velocity and bias, position
+  * 		position only: triple pole at -1/tau (as the altitude estimator)
+  */
+#define POS_GAIN_VEL				(2.0f / POS_FILT_TAU_S)
+#define POS_GAIN_VEL_BIAS			(1.0f / (POS_FILT_TAU_S * POS_FILT_TAU_S))
+#define POS_GAIN_VEL_POS			(1.0f / POS_FILT_TAU_S)
+
+#define POS_GAIN_POS				(3.0f / POS_FILT_TAU_S)
+#define POS_GAIN_POS_VEL			(3.0f / (POS_FILT_TAU_S * POS_FILT_TAU_S))
+#define POS_GAIN_POS_BIAS			(1.0f / (POS_FILT_TAU_S * POS_FILT_TAU_S * POS_FILT_TAU_S))
+
+#define POS_ACCEL_BIAS_MAX_MPS2		2.0f		// ~200 mg
+#define POS_DT_MAX_S				0.05f		// longer steps (stalls) are not integrated
+
+/**
+  * @brief  Heading Alignment
+  */
+#define POS_ALIGN_WINDOW_US			1000000U	// velocity change compared over (at least) this
+#define POS_ALIGN_RATIO_MAX			2.0f		// imu and gps velocity changes must agree in size
+#define POS_ALIGN_GAIN				0.3f		// share of the angle applied once settled
+
+/**
+  * @brief  WGS-84 Equatorial Radius (1e-7 deg of latitude in m)
+  */
+#define EARTH_RADIUS_M				6378137.0f
+#define POS_M_PER_DEG_E7			(EARTH_RADIUS_M * RAD * 1e-7f)
+
+#define GRAVITY_MPS2				9.80665f
+
+
+/**
+  * @brief init position estimate (invalid until the first accepted fix)
+  *
+  * @param  est				pointer to position estimate handle
+  * @param	gps_delay_us	solution age on arrival (0: solutions are taken as current)
+  *
+  * @retval None
+  */
+void position_estimator_init(position_est_t *est, uint32_t gps_delay_us) {
+	memset(est, 0, sizeof(*est));
+	est->delay_us = gps_delay_us;
+	est->lon_scale = 1.0f;
+}
+
+/**
+  * @brief converts a gps position to north / east of the estimator origin
+  * 	   (equirectangular: within a few km of the origin)
+  *
+  * @param  est		read-only pointer to position estimate handle
+  * @param	lat_e7	latitude (1e-7 deg)
+  * @param	lon_e7	longitude (1e-7 deg)
+  * @param	ne		north / east buffer to be filled (m)
+  *
+  * @retval None
+  */
+void position_gps_to_ne(const position_est_t *est, int32_t lat_e7, int32_t lon_e7, float ne[2]) {
+	int64_t dlon = (int64_t) lon_e7 - est->origin_lon_e7;
+
+	/* Across the antimeridian */
+	if (dlon > 1800000000LL)
+		dlon -= 3600000000LL;
+	else if (dlon < -1800000000LL)
+		dlon += 3600000000LL;
+
+	ne[0] = (float) ((int64_t) lat_e7 - est->origin_lat_e7) * POS_M_PER_DEG_E7;
+	ne[1] = (float) dlon * POS_M_PER_DEG_E7 * est->lon_scale;
+}
+
+/**
+  * @brief helper function to rotate the body frame accelerometer into the
+  * 	   horizontal earth frame (north / east) with the roll/pitch estimate and
+  * 	   the heading
+  * 	   NOTE: gravity has no horizontal component, nothing to remove
+  *
+  * @param  imu		read-only pointer to imu 6d sensor handle (mg)
+  * @param	att		read-only pointer to attitude estimate
+  * @param	heading	heading (rad, clockwise from north)
+  * @param	ne		north / east acceleration buffer to be filled (m/s^2)
+  *
+  * @retval None
+  */
+static void horizontal_accel(const imu_6D_t *imu, const attitude_est_t *att, float heading, float ne[2]) {
+	float sr = sinf(DEG_TO_RAD(att->roll_angle_deg));
+	float cr = cosf(DEG_TO_RAD(att->roll_angle_deg));
+	float sp = sinf(DEG_TO_RAD(att->pitch_angle_deg));
+	float cp = cosf(DEG_TO_RAD(att->pitch_angle_deg));
+
+	/* Level frame: forward, left */
+	float fwd = cp * imu->accel_x + sp * (sr * imu->accel_y + cr * imu->accel_z);
+	float left = cr * imu->accel_y - sr * imu->accel_z;
+
+	float sh = sinf(heading);
+	float ch = cosf(heading);
+
+	ne[0] = (fwd * ch + left * sh) * (GRAVITY_MPS2 / 1000.0f);
+	ne[1] = (fwd * sh - left * ch) * (GRAVITY_MPS2 / 1000.0f);
+}
+
+/**
+  * @brief helper function to integrate the heading from the gyro
+  * 	   NOTE: body rates to euler yaw rate; yaw is counter-clockwise positive
+  * 	   about z up, heading clockwise from north
+  *
+  * @param  imu		read-only pointer to imu 6d sensor handle (mdps)
+  * @param	att		read-only pointer to attitude estimate
+  * @param	est		pointer to position estimate handle
+  * @param	dt		timestep
+  *
+  * @retval None
+  */
+static void heading_update(const imu_6D_t *imu, const attitude_est_t *att, position_est_t *est, float dt) {
+	float sr = sinf(DEG_TO_RAD(att->roll_angle_deg));
+	float cr = cosf(DEG_TO_RAD(att->roll_angle_deg));
+	float cp = cosf(DEG_TO_RAD(att->pitch_angle_deg));
+
+	if (fabsf(cp) < 0.1f)
+		cp = copysignf(0.1f, cp);
+
+	est->heading_deg -= (MDPS_TO_DPS(sr * imu->rate_y + cr * imu->rate_z) / cp) * dt;
+	est->heading_deg = fmodf(est->heading_deg, 360.0f);
+	if (est->heading_deg < 0.0f)
+		est->heading_deg += 360.0f;
+}
+
+/**
+  * @brief helper function to get the inertial state at a past time (newest
+  * 	   entry not after it; the oldest if the history does not reach back)
+  *
+  * @param  est		read-only pointer to position estimate handle
+  * @param	age_us	how far back
+  *
+  * @retval read-only pointer to history entry (NULL if empty)
+  */
+static const position_hist_t* history_lookup(const position_est_t *est, uint32_t age_us) {
+	const position_hist_t *entry = NULL;
+	uint32_t idx = est->hist_head;
+
+	for (uint32_t i = 0; i < est->hist_count; ++i) {
+		idx = (idx + POSITION_HISTORY_LEN - 1U) % POSITION_HISTORY_LEN;
+		entry = &est->hist[idx];
+		if ((est->time_us - entry->time_us) >= age_us)
+			break;
+	}
+
+	return entry;
+}
+
+/**
+  * @brief helper function to record the current inertial state
+  *
+  * @param  est		pointer to position estimate handle
+  * @retval None
+  */
+static void history_push(position_est_t *est) {
+	position_hist_t *entry = &est->hist[est->hist_head];
+
+	entry->time_us = est->time_us;
+	entry->pos_m[0] = est->pos_base_m[0];
+	entry->pos_m[1] = est->pos_base_m[1];
+	entry->vel_mps[0] = est->vel_base_mps[0];
+	entry->vel_mps[1] = est->vel_base_mps[1];
+	entry->dv_mps[0] = est->dv_mps[0];
+	entry->dv_mps[1] = est->dv_mps[1];
+
+	est->hist_head = (est->hist_head + 1U) % POSITION_HISTORY_LEN;
+	if (est->hist_count < POSITION_HISTORY_LEN)
+		est->hist_count++;
+}
+
+/**
+  * @brief helper function to align the heading: compares the velocity change
+  * 	   gps saw over the last window with the one the rotated accelerometer
+  * 	   gave (both at the time of the solution)
+  *
+  * @param  gps_vel		gps velocity (north / east)
+  * @param	then		read-only pointer to inertial state at the solution time
+  * @param	est			pointer to position estimate handle
+  *
+  * @retval None
+  */
+static void heading_align(const float gps_vel[2], const position_hist_t *then, position_est_t *est) {
+	if (!est->align_started) {
+		est->align_started = true;
+		est->align_start_us = then->time_us;
+		est->align_dv_mps[0] = then->dv_mps[0];
+		est->align_dv_mps[1] = then->dv_mps[1];
+		est->align_vel_mps[0] = gps_vel[0];
+		est->align_vel_mps[1] = gps_vel[1];
+		return;
+	}
+
+	if ((then->time_us - est->align_start_us) < POS_ALIGN_WINDOW_US)
+		return;
+
+	float dv_ins[2] = {then->dv_mps[0] - est->align_dv_mps[0], then->dv_mps[1] - est->align_dv_mps[1]};
+	float dv_gps[2] = {gps_vel[0] - est->align_vel_mps[0], gps_vel[1] - est->align_vel_mps[1]};
+	float mag_ins = sqrtf(dv_ins[0] * dv_ins[0] + dv_ins[1] * dv_ins[1]);
+	float mag_gps = sqrtf(dv_gps[0] * dv_gps[0] + dv_gps[1] * dv_gps[1]);
+
+	/* Next window starts here */
+	est->align_started = false;
+
+	if ((mag_ins < POS_HEADING_ALIGN_DV_MPS) || (mag_gps < POS_HEADING_ALIGN_DV_MPS) ||
+		(mag_ins > POS_ALIGN_RATIO_MAX * mag_gps) || (mag_gps > POS_ALIGN_RATIO_MAX * mag_ins))
+		return;
+
+	/* Angle from the imu to the gps velocity change (positive: clockwise) */
+	float angle = RAD_TO_DEG(atan2f(dv_ins[0] * dv_gps[1] - dv_ins[1] * dv_gps[0],
+									dv_ins[0] * dv_gps[0] + dv_ins[1] * dv_gps[1]));
+
+	/* Average the first alignments (1/n), then track the gyro drift */
+	est->align_count++;
+	est->heading_deg += fmaxf(1.0f / (float) est->align_count, POS_ALIGN_GAIN) * angle;
+	est->heading_deg = fmodf(est->heading_deg + 360.0f, 360.0f);
+	est->heading_aligned = true;
+}
+
+/**
+  * @brief helper function to take a fresh gps solution: gates it, converts
+  * 	   it to the origin and holds its error against the estimate of its time
+  * 	   (the first fix, or the first after a timeout, resets the estimate to it)
+  *
+  * @param  gps		read-only pointer to gps solution
+  * @param	est		pointer to position estimate handle
+  *
+  * @retval None
+  */
+static void gps_update(const gps_data_t *gps, position_est_t *est) {
+	const position_hist_t *then;
+	position_hist_t now;
+	float pos[2];
+	float vel[2];
+
+	if ((gps->fix != GPS_FIX_3D) || (gps->num_sv < POS_GPS_MIN_SATS) || (gps->h_acc_mm > POS_GPS_MAX_HACC_MM))
+		return;
+
+	if (!est->origin_set) {
+		est->origin_lat_e7 = gps->lat_e7;
+		est->origin_lon_e7 = gps->lon_e7;
+		est->lon_scale = cosf(DEG_TO_RAD((float) gps->lat_e7 * 1e-7f));
+		est->origin_set = true;
+	}
+
+	position_gps_to_ne(est, gps->lat_e7, gps->lon_e7, pos);
+	vel[0] = (float) gps->vel_ned_mms[0] * 0.001f;
+	vel[1] = (float) gps->vel_ned_mms[1] * 0.001f;
+
+	/* Inertial State at the Solution Time */
+	then = (est->delay_us > 0U) ? history_lookup(est, est->delay_us) : NULL;
+	if (then == NULL) {
+		now.time_us = est->time_us;
+		memcpy(now.pos_m, est->pos_base_m, sizeof(now.pos_m));
+		memcpy(now.vel_mps, est->vel_base_mps, sizeof(now.vel_mps));
+		memcpy(now.dv_mps, est->dv_mps, sizeof(now.dv_mps));
+		then = &now;
+	}
+
+	est->vel_aided = gps->vel_valid;
+
+	if (!est->valid) {
+		/* (Re)start at the solution */
+		for (uint32_t i = 0; i < 2U; ++i) {
+			est->pos_corr_m[i] = pos[i] - then->pos_m[i];
+			est->vel_corr_mps[i] = (gps->vel_valid ? vel[i] : 0.0f) - then->vel_mps[i];
+			est->pos_err_m[i] = 0.0f;
+			est->vel_err_mps[i] = 0.0f;
+		}
+		est->align_started = false;
+		est->valid = true;
+
+	} else {
+		for (uint32_t i = 0; i < 2U; ++i) {
+			est->pos_err_m[i] = pos[i] - (then->pos_m[i] + est->pos_corr_m[i]);
+			est->vel_err_mps[i] = gps->vel_valid ? (vel[i] - (then->vel_mps[i] + est->vel_corr_mps[i])) : 0.0f;
+		}
+	}
+
+	if (gps->vel_valid && !est->heading_mag)
+		heading_align(vel, then, est);
+
+	est->gps_age_us = 0U;
+}
+
+/**
+  * @brief updates horizontal position and velocity estimates (every loop)
+  *
+  * @param  imu		read-only pointer to imu 6d sensor handle
+  * @param	att		read-only pointer to attitude estimate
+  * @param	gps		read-only pointer to gps solution (used if fresh)
+  * @param	est		pointer to position estimate handle
+  *
+  * @retval position status type (WARN when the estimate is lost)
+  */
+position_status_t position_estimator_update(const imu_6D_t *imu, const attitude_est_t *att,
+											const gps_data_t *gps, position_est_t *est) {
+	position_status_t status = POSITION_OK;
+	float accel[2];
+
+	est->heading_mag = att->heading_valid;
+
+	if (gps->fresh)
+		gps_update(gps, est);
+
+	/* imu dt is integral us */
+	float dt = USEC_TO_SEC((float) imu->dt);
+	if ((dt <= 0.0f) || (dt > POS_DT_MAX_S))
+		return status;
+
+	est->time_us += imu->dt;
+	if (est->heading_mag) {
+		est->heading_deg = att->heading_deg;
+		est->heading_aligned = true;
+	} else {
+		heading_update(imu, att, est, dt);
+	}
+
+	/* Rotated, Bias Corrected Accelerometer (heading alignment sees it before the heading is known) */
+	horizontal_accel(imu, att, DEG_TO_RAD(est->heading_deg), accel);
+	for (uint32_t i = 0; i < 2U; ++i) {
+		accel[i] += est->accel_bias_mps2[i];
+		est->dv_mps[i] += accel[i] * dt;
+	}
+
+	/* Timeout: stop correcting, restart at the next fix */
+	if (est->valid) {
+		est->gps_age_us += imu->dt;
+		if (est->gps_age_us > POS_GPS_TIMEOUT_US) {
+			est->valid = false;
+			status = POSITION_ERROR_WARN;
+		}
+	}
+
+	if (est->valid) {
+		float kp = est->vel_aided ? POS_GAIN_VEL_POS : POS_GAIN_POS;
+
+		for (uint32_t i = 0; i < 2U; ++i) {
+			float vel_corr;
+			float bias;
+
+			if (est->vel_aided) {
+				vel_corr = POS_GAIN_VEL * est->vel_err_mps[i];
+				bias = POS_GAIN_VEL_BIAS * est->vel_err_mps[i];
+			} else {
+				vel_corr = POS_GAIN_POS_VEL * est->pos_err_m[i];
+				bias = POS_GAIN_POS_BIAS * est->pos_err_m[i];
+			}
+
+			/* Bias is only observable once the accelerometer is in use */
+			if (est->heading_aligned)
+				est->accel_bias_mps2[i] = constrainf(est->accel_bias_mps2[i] + bias * dt,
+													 -POS_ACCEL_BIAS_MAX_MPS2, POS_ACCEL_BIAS_MAX_MPS2);
+
+			est->vel_corr_mps[i] += vel_corr * dt;
+			est->pos_corr_m[i] += (est->vel_corr_mps[i] + kp * est->pos_err_m[i]) * dt;
+		}
+	}
+
+	/* Inertial Prediction (corrections kept apart, see position.h) */
+	if (!est->heading_aligned)
+		accel[0] = accel[1] = 0.0f;
+
+	for (uint32_t i = 0; i < 2U; ++i) {
+		est->vel_base_mps[i] += accel[i] * dt;
+		est->pos_base_m[i] += est->vel_base_mps[i] * dt;
+		est->vel_mps[i] = est->vel_base_mps[i] + est->vel_corr_mps[i];
+		est->pos_m[i] = est->pos_base_m[i] + est->pos_corr_m[i];
+	}
+
+	history_push(est);
+
+	return status;
+}
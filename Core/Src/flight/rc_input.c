@@ -10,35 +10,23 @@
 #include <stdbool.h>
 #include "flight/rc_input.h"
 #include "rx/rx.h"
+#include "params/params.h"
 #include "common/maths.h"
 #include "common/settings.h"
 
 /**
-  * @brief  Rx Protocol Setting
+  * @brief  Runtime Parameter Cache (refreshed on change notification)
   */
-#define RX_PROTOCOL					CONFIG_RX_PROTOCOL
-
-/**
-  * @brief  PWM Config Settings
-  */
-#define PWM_PULSE_MIN_US    		CONFIG_PWM_PULSE_MIN_US
-#define PWM_PULSE_MAX_US    		CONFIG_PWM_PULSE_MAX_US
-
-/**
-  * @brief  RC Input Config Settings
-  */
-#define ROLL_MIN_DEG				CONFIG_ROLL_MIN_DEG
-#define ROLL_MAX_DEG	 			CONFIG_ROLL_MAX_DEG
-#define ROLL_MIN_DPS				CONFIG_ROLL_MIN_DPS
-#define ROLL_MAX_DPS				CONFIG_ROLL_MAX_DPS
-#define PITCH_MIN_DEG				CONFIG_PITCH_MIN_DEG
-#define PITCH_MAX_DEG	 			CONFIG_PITCH_MAX_DEG
-#define PITCH_MIN_DPS				CONFIG_PITCH_MIN_DPS
-#define PITCH_MAX_DPS	 			CONFIG_PITCH_MAX_DPS
-#define YAW_MIN_DPS					CONFIG_YAW_MIN_DPS
-#define YAW_MAX_DPS	 	 			CONFIG_YAW_MAX_DPS
-
-#define THROTTLE_IDLE_TOLERANCE_PCT	CONFIG_THROTTLE_IDLE_TOLERANCE_PCT
+static uint32_t pwm_pulse_min_us;
+static uint32_t pwm_pulse_max_us;
+static uint32_t pwm_pulse_med_us;
+static float roll_max_deg;
+static float roll_max_dps;
+static float pitch_max_deg;
+static float pitch_max_dps;
+static float yaw_max_dps;
+static float throttle_idle_tolerance_pct;
+static mode_status_t mode_switch_high;
 
 /**
   * @brief  AETR RC Channel Type (describes map to rx channel)
@@ -83,31 +71,31 @@ static rc_req_status_t map_pulse_to_state_request(const aetr_rc_channel_t ch, ui
 	/* Sanitize Pulse Width */
 	if (!inrange_u32(val, PWM_PULSE_VALID_MIN_US, PWM_PULSE_VALID_MAX_US)) {
 		req_status = RC_REQ_ERROR_WARN;
-		val = (ch == THROTTLE_CHANNEL) ? PWM_PULSE_MIN_US : PWM_PULSE_MED_US; // set pulse width to neutral state
+		val = (ch == THROTTLE_CHANNEL) ? pwm_pulse_min_us : pwm_pulse_med_us; // set pulse width to neutral state
 
-	} else if (!inrange_u32(val, PWM_PULSE_MIN_US, PWM_PULSE_MAX_US)) {
-		val = constrain_u32(val, PWM_PULSE_MIN_US, PWM_PULSE_MAX_US);
+	} else if (!inrange_u32(val, pwm_pulse_min_us, pwm_pulse_max_us)) {
+		val = constrain_u32(val, pwm_pulse_min_us, pwm_pulse_max_us);
 
 	}
 
 	/* Map Pulse Width and Update Request */
 	switch (ch) {
 		case ROLL_CHANNEL:
-			req->roll_angle = mapf((float) val, PWM_PULSE_MIN_US, PWM_PULSE_MAX_US, ROLL_MIN_DEG, ROLL_MAX_DEG);
-			req->roll_rate = mapf((float) val, PWM_PULSE_MIN_US, PWM_PULSE_MAX_US, ROLL_MIN_DPS, ROLL_MAX_DPS);
+			req->roll_angle = mapf((float) val, pwm_pulse_min_us, pwm_pulse_max_us, -roll_max_deg, roll_max_deg);
+			req->roll_rate = mapf((float) val, pwm_pulse_min_us, pwm_pulse_max_us, -roll_max_dps, roll_max_dps);
 			break;
 
 		case PITCH_CHANNEL:
-			req->pitch_angle = mapf((float) val, PWM_PULSE_MIN_US, PWM_PULSE_MAX_US, PITCH_MIN_DEG, PITCH_MAX_DEG);
-			req->pitch_rate = mapf((float) val, PWM_PULSE_MIN_US, PWM_PULSE_MAX_US, PITCH_MIN_DPS, PITCH_MAX_DPS);
+			req->pitch_angle = mapf((float) val, pwm_pulse_min_us, pwm_pulse_max_us, -pitch_max_deg, pitch_max_deg);
+			req->pitch_rate = mapf((float) val, pwm_pulse_min_us, pwm_pulse_max_us, -pitch_max_dps, pitch_max_dps);
 			break;
 
 		case (THROTTLE_CHANNEL):
-			req->throttle = mapf((float) val, PWM_PULSE_MIN_US, PWM_PULSE_MAX_US, THROTTLE_MIN_PCT, THROTTLE_MAX_PCT);
+			req->throttle = mapf((float) val, pwm_pulse_min_us, pwm_pulse_max_us, THROTTLE_MIN_PCT, THROTTLE_MAX_PCT);
 			break;
 
 		case (YAW_CHANNEL):
-			req ->yaw_rate = mapf((float) val, PWM_PULSE_MIN_US, PWM_PULSE_MAX_US, YAW_MIN_DPS, YAW_MAX_DPS);
+			req ->yaw_rate = mapf((float) val, pwm_pulse_min_us, pwm_pulse_max_us, -yaw_max_dps, yaw_max_dps);
 			break;
 
 		default:	// Error: unexpected channel mapping
@@ -118,21 +106,50 @@ static rc_req_status_t map_pulse_to_state_request(const aetr_rc_channel_t ch, ui
 	return req_status;
 }
 
+/**
+  * @brief helper function to refresh cached rc input parameters
+  *
+  * @retval None
+  */
+static void load_rc_params(void) {
+	pwm_pulse_min_us = params_get_u32(PARAM_RC_PULSE_MIN_US);
+	pwm_pulse_max_us = params_get_u32(PARAM_RC_PULSE_MAX_US);
+	pwm_pulse_med_us = (pwm_pulse_min_us + pwm_pulse_max_us) / 2U;
+	roll_max_deg = params_get_float(PARAM_RC_ROLL_MAX_DEG);
+	roll_max_dps = params_get_float(PARAM_RC_ROLL_MAX_DPS);
+	pitch_max_deg = params_get_float(PARAM_RC_PITCH_MAX_DEG);
+	pitch_max_dps = params_get_float(PARAM_RC_PITCH_MAX_DPS);
+	yaw_max_dps = params_get_float(PARAM_RC_YAW_MAX_DPS);
+	throttle_idle_tolerance_pct = params_get_float(PARAM_RC_THROTTLE_IDLE_TOL_PCT);
+	mode_switch_high = (mode_status_t) params_get_u32(PARAM_RC_MODE_SWITCH_HIGH);
+}
+
+/**
+  * @brief parameter change listener
+  *
+  * @param  id		changed parameter id
+  * @retval None
+  */
+static void on_param_change(param_id_t id) {
+	(void) id;
+	load_rc_params();
+}
+
 /**
   * @brief initialize rc input mapping function
   *
   * @retval rc request status
   */
 rc_req_status_t rc_init(void) {
-	#if RX_PROTOCOL == RX_PWM_PROTOCOL_ID
-		map_channel_to_state_request = map_pulse_to_state_request;
-	#else
-		#error "Invalid Rx Protocol Configuration"
-	#endif
+	/* Every rx driver reports channels as pulse widths (us) */
+	map_channel_to_state_request = map_pulse_to_state_request;
 
 	if (map_channel_to_state_request == NULL)
 		return RC_REQ_ERROR_FATAL;
 
+	load_rc_params();
+	params_subscribe(PARAM_GROUP_RC, on_param_change);
+
 	return RC_REQ_OK;
 }
 
@@ -181,11 +198,21 @@ rc_req_status_t rc_get_requests(rc_reqs_t *req) {
 
 /**
   * @brief gets current flight mode request from rc
+  * 	   NOTE: the mode switch has two positions; low is angle mode, high is
+  * 	   the mode set by PARAM_RC_MODE_SWITCH_HIGH (rate or altitude hold)
   *
-  * @retval flight mode
+  * @retval flight mode (INVALID_MODE for any other channel value)
   */
 mode_status_t rc_get_flight_mode(void) {
-	return (mode_status_t) rx_get_channel(MODE_CHANNEL);
+	mode_status_t mode = (mode_status_t) rx_get_channel(MODE_CHANNEL);
+
+	if (mode == RATE_MODE)
+		return mode_switch_high;
+
+	if (mode == ANGLE_MODE)
+		return ANGLE_MODE;
+
+	return INVALID_MODE;
 }
 
 /**
@@ -217,5 +244,5 @@ bool rc_is_armed(void) {
   */
 bool rc_is_throttle_idle(const float throttle_req) {
 	/* Determine if throttle is within idle tolerance */
-	return (throttle_req <= THROTTLE_IDLE_TOLERANCE_PCT);
+	return (throttle_req <= throttle_idle_tolerance_pct);
 }
@@ -30,17 +30,37 @@
 #include <math.h>
 #include "usbd_cdc_if.h"
 
-#include "system/system.h"
 #include "system/error.h"
+#include "system/health.h"
+#include "params/params.h"
+#include "comms/link.h"
+#include "comms/telemetry.h"
+#include "comms/usb_msc.h"
 #include "esc/esc.h"
+#include "esc/esc_telemetry.h"
 #include "rx/rx.h"
 #include "flight/rc_input.h"
 #include "sensors/imu/imu.h"
+#include "sensors/imu/crash.h"
+#include "sensors/baro/baro.h"
+#include "sensors/gps/gps.h"
+#include "sensors/mag/mag.h"
+#include "sensors/battery/battery.h"
 #include "flight/attitude.h"
 #include "flight/mixer.h"
+#include "flight/flight.h"
 #include "common/time.h"
 #include "common/led.h"
+#include "common/cycles.h"
+#include "common/memory.h"
 #include "common/settings.h"
+#include "system/profile.h"
+#include "system/irq.h"
+#include "system/bench.h"
+#include "storage/log_file.h"
+#include "storage/blackbox.h"
+#include "storage/card/stm32_sd_card.h"
+#include "system/rtc.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -52,7 +72,8 @@
 /* USER CODE BEGIN PD */
 
 #define DEVICE_BOOT_TIME_MS		CONFIG_DEVICE_BOOT_TIME_MS
-#define THRUST_COMP				CONFIG_THRUST_COMP
+#define LOG_FILE				CONFIG_LOG_FILE
+#define LOG_FILE_PREALLOC_BYTES	(CONFIG_LOG_FILE_PREALLOC_MB * 1024U * 1024U)
 
 /* USER CODE END PD */
 
@@ -74,8 +95,11 @@ TIM_HandleTypeDef htim4;
 TIM_HandleTypeDef htim8;
 
 /* USER CODE BEGIN PV */
+/* Flight Loop Data (cpu access only, so it may live in CCM) */
+static flight_data_t flight CCM_BSS;
 
-static uint8_t tx_buffer[1000];	// DEBUG
+/* Blackbox Frame Buffer (copied into the sd stream ring, so it may live in CCM) */
+static uint8_t log_buf[BLACKBOX_HEADER_MAX] CCM_BSS;
 
 /* USER CODE END PV */
 
@@ -106,19 +130,17 @@ int main(void)
 {
   /* USER CODE BEGIN 1 */
   /* Declare or Initialize Private Variables */
-  bool arm_reset = true;
-
   rx_status_t rx_status;
   esc_status_t esc_status;
   rc_req_status_t rc_status;
   imu_status_t imu_status;
-  attitude_status_t att_status;
 
-  rc_reqs_t rcReqs = {0.0};
-  imu_6D_t imu = {0};
-  attitude_est_t attEst = {0.0};
-  attitude_cmd_t attCmds = {0.0};
-  mtr_cmds_t mtrCmds = {0.0};
+  flight_status_t flight_status;
+  crash_state_t crash = {0};
+  uint32_t loop_start;
+  bool log_started = false;
+  rtc_time_ref_t time_ref;
+  uint32_t log_len, log_start;
 
   /* USER CODE END 1 */
 
@@ -151,35 +173,85 @@ int main(void)
   MX_TIM8_Init();
   /* USER CODE BEGIN 2 */
 
+  /* Apply Interrupt Priority Map (flight-critical sources preempt SD and USB) */
+  irq_init();
+
   /* Wait for Devices to Boot */
   delay_ms(DEVICE_BOOT_TIME_MS);
 
+  /* Initialize Health Reporting (before any module can report) */
+  health_init();
+
+  /* Load Runtime Parameters (defaults + persisted values) before Module Init */
+  HEALTH_CHECK(HEALTH_MODULE_PARAMS, params_init());
+
+  /* Start Wall Clock and Count Boot (after Params: boot counter is persisted there) */
+  health_report(HEALTH_MODULE_SYSTEM, rtc_init());
+
+  /* Initialize Flight Loop Data */
+  flight_init(&flight);
+
+  /* Initialize USB Link and Telemetry Streams (all stopped until requested) */
+  link_init();
+  telemetry_init(&(telemetry_sources_t){.imu = &flight.imu, .est = &flight.est, .req = &flight.req, .mcmd = &flight.mcmd,
+                                        .batt = &flight.batt, .esc_tlm = &flight.esc_tlm});
+
+  /* Register SD Card Volume (mounted lazily on first file access) */
+  f_mount(&SDFatFS, SDPath, 0);
+
   /* Initialize ESC and Start Comms */
   esc_status = esc_init();
-  CHECK(esc_status);
+  HEALTH_CHECK(HEALTH_MODULE_ESC, esc_status);
   esc_status = esc_start();
-  CHECK(esc_status);
+  HEALTH_CHECK(HEALTH_MODULE_ESC, esc_status);
+
+  /* Initialize ESC Telemetry (optional, after ESC: frames are requested through its protocol) */
+  health_report(HEALTH_MODULE_ESC_TLM, esc_telemetry_init());
 
   /* Initialize Rx Interface and Start Comms */
   rx_status = rx_init();
-  CHECK(rx_status);
+  HEALTH_CHECK(HEALTH_MODULE_RX, rx_status);
   rx_status = rx_start();
-  CHECK(rx_status);
+  HEALTH_CHECK(HEALTH_MODULE_RX, rx_status);
 
   /* Initialize RC Interface */
   rc_status = rc_init();
-  CHECK(rc_status);
+  HEALTH_CHECK(HEALTH_MODULE_RC, rc_status);
 
   /* Initialize IMU Interface */
   imu_status = imu_init();
-  CHECK(imu_status);
+  HEALTH_CHECK(HEALTH_MODULE_IMU, imu_status);
 
-  /* Initialize Attitude Controller */
-  attitude_controller_init();
+  /* Load Crash Detection into the IMU (optional, after IMU: runs in its state machine, disarms from INT1) */
+  health_report(HEALTH_MODULE_CRASH, crash_init());
+
+  /* Initialize Barometer (optional: the altitude estimate stays invalid without it) */
+  health_report(HEALTH_MODULE_BARO, baro_init());
+
+  /* Initialize GPS (optional: the position estimate stays invalid without it) */
+  health_report(HEALTH_MODULE_GPS, gps_init());
 
-  /* Initialize Motor Mixer */
+  /* Initialize Magnetometer (optional, behind the IMU sensor hub: the heading stays gyro / gps aligned without it) */
+  health_report(HEALTH_MODULE_MAG, mag_init());
+
+  /* Initialize Battery Monitor (optional: the battery state reads not present without it) */
+  health_report(HEALTH_MODULE_BATTERY, battery_init());
+
+  /* Initialize Motor Mixer (after ESC: limits derive from ESC command range) */
   mixer_init();
 
+  /* Initialize Attitude Controller (after Mixer: rate limits map to motor commands) */
+  attitude_controller_init();
+
+  /* Initialize Altitude Hold Controller */
+  altitude_controller_init();
+
+  /* Start Loop Profiling (cycle counts reported in MSG_STATS) */
+  profile_init();
+
+  /* Time Flight Kernels (no-op unless CONFIG_BENCH; results via MSG_BENCH_GET) */
+  bench_run();
+
   /* Signal Flight Ready Status with LED */
   led_set_status(LED_READY);
 
@@ -189,56 +261,91 @@ int main(void)
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-		/* Get Remote Control Input */
-		rc_get_requests(&rcReqs);
+		/* Keep Motors Off After a Crash (disarmed by the IMU interrupt; until the arm switch is reset) */
+		health_report(HEALTH_MODULE_CRASH, crash_service(!rc_is_armed(), &crash));
+		flight.kill = crash.latched;
+
+		/* Run One Flight Loop Iteration */
+		loop_start = cycles_now();
+		flight.arm_inhibit = usb_msc_is_active() || mag_calibration_is_running();
+		#if LOG_FILE == ENABLED
+		flight.arm_hold = !log_started;		// until the flight log is preallocated (below, motors off)
+		#endif
+		flight_update(&flight, &flight_status);
+		if (crash.disarmed)
+			flight_status.disarmed = true;
+		profile_record(PROFILE_LOOP, cycles_now() - loop_start);
+		profile_record(PROFILE_CONTROL, flight_status.control_cycles);
+
+		health_report(HEALTH_MODULE_RC, flight_status.rc);
+		health_report(HEALTH_MODULE_IMU, flight_status.imu);
+		health_report(HEALTH_MODULE_BARO, flight_status.baro);
+		health_report(HEALTH_MODULE_GPS, flight_status.gps);
+		health_report(HEALTH_MODULE_MAG, flight_status.mag);
+		health_report(HEALTH_MODULE_BATTERY, flight_status.battery);
+		health_report(HEALTH_MODULE_ESC_TLM, flight_status.esc_tlm);
+		health_report(HEALTH_MODULE_ATTITUDE, flight_status.estimator);
+		health_report(HEALTH_MODULE_CONTROL, flight_status.controller);
+		health_report(HEALTH_MODULE_ALTITUDE, flight_status.altitude);
+		health_report(HEALTH_MODULE_POSITION, flight_status.position);
+		health_report(HEALTH_MODULE_ALT_HOLD, flight_status.alt_hold);
+		health_report(HEALTH_MODULE_ESC, flight_status.esc);
+
+		/* Signal Flight Status with LED (unchanged while flying) */
+		if (flight_status.phase == FLIGHT_PHASE_READY) {
+			led_set_status(LED_READY);
+		} else if (flight_status.phase != FLIGHT_PHASE_FLYING) {
+			led_set_status(LED_WAITING);
+		}
 
-		/* Read IMU */
-		imu_read(&imu);
+		#if LOG_FILE == ENABLED
+		/* Start Flight Log When Ready (blocking file system access with motors off; arming held until then) */
+		if ((flight_status.phase == FLIGHT_PHASE_READY) && !log_started) {
+			log_started = true;
+			rtc_get_time_ref(&time_ref);
+			health_report(HEALTH_MODULE_STORAGE, log_file_start(&stm32_sd_card, LOG_FILE_PREALLOC_BYTES, &time_ref));
+
+			/* Field definitions once, then frames starting with a keyframe */
+			blackbox_reset();
+			log_len = blackbox_write_header(log_buf, sizeof(log_buf));
+			log_file_write(log_buf, log_len);
+		}
 
-		/* Update Attitude Estimation */
-		attitude_estimator_update(&imu, &attEst);
+		/* Log Armed Flight (no file system access in flight) */
+		if (flight_status.phase == FLIGHT_PHASE_FLYING) {
+			/* Encode and Queue One Frame (a dropped frame forces a keyframe) */
+			log_start = cycles_now();
+			log_len = blackbox_encode(&(blackbox_record_t){.time_us = (uint32_t) micros(), .imu = flight.imu,
+														   .est = flight.est, .req = flight.req, .mcmd = flight.mcmd}, log_buf);
+			if (log_file_write(log_buf, log_len) != log_len)
+				blackbox_reset();
+			profile_record(PROFILE_LOG, cycles_now() - log_start);
+		}
+		health_report(HEALTH_MODULE_STORAGE, log_file_service());
 
-		/* Update Attitude PID Controllers */
-		attitude_controller_update(&attCmds, &rcReqs, &attEst, imu.dt);
+		/* Close Flight Log on Disarm, or Arm Switch Off Before Arming (before any other file system access) */
+		if (log_started && (flight_status.phase == FLIGHT_PHASE_DISARMED)) {
+			log_started = false;
+			health_report(HEALTH_MODULE_STORAGE, log_file_stop());
+		}
+		#endif
 
-		/* Apply Motor Mixing */
-		mixer_update(&mtrCmds, &attCmds, rcReqs.throttle);
+		/* Persist Flight Health Summary on Disarm */
+		if (flight_status.disarmed)
+			health_persist();
 
-		#if THRUST_COMP == ENABLED
-		/* Apply Thrust Compensation */
-		thrust_compensate(&mtrCmds, &attEst);
-		#endif
+		/* Drain Health Events and Send Rate-Limited Summary */
+		health_service();
 
-		/* Check if Remote Control is Armed */
-		if (rc_is_armed()) {
-			/* Set Motor Commands */
-			if (esc_is_armed()) {
-				esc_set_motor_commands(&mtrCmds);
-
-			/* Arm ESC (if ready) */
-			} else {
-				/* Check if Ready to Fly */
-				if (ready_to_fly(imu.accel_z, &attEst, rcReqs.throttle)) {
-					led_set_status(LED_READY);
-
-					/* Check if Arm Switch was Reset */
-					if (arm_reset)
-						esc_arm();
-
-				} else {
-					led_set_status(LED_WAITING);
-					arm_reset = false;
-				}
-			}
-
-		} else {
-			/* Disarm ESC (if not already) */
-			if (esc_is_armed())
-				esc_disarm();
+		/* Queue Due Telemetry, Handle Commands and Flush USB Link */
+		telemetry_service();
+		link_service();
 
-			led_set_status(LED_WAITING);
-			arm_reset = true;
-		}
+		/* Switch USB Modes and Serve the Card in Mass Storage Mode (disarmed only) */
+		health_report(HEALTH_MODULE_STORAGE, usb_msc_service());
+
+		/* Trigger Latency Test Events (no-op unless CONFIG_IRQ_LATENCY_TEST) */
+		irq_latency_service();
 
     /* USER CODE END WHILE */
 
@@ -631,10 +738,10 @@ static void MX_DMA_Init(void)
 
   /* DMA interrupt init */
   /* DMA2_Stream3_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(DMA2_Stream3_IRQn, 0, 0);
+  HAL_NVIC_SetPriority(DMA2_Stream3_IRQn, 9, 0);
   HAL_NVIC_EnableIRQ(DMA2_Stream3_IRQn);
   /* DMA2_Stream6_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(DMA2_Stream6_IRQn, 0, 0);
+  HAL_NVIC_SetPriority(DMA2_Stream6_IRQn, 9, 0);
   HAL_NVIC_EnableIRQ(DMA2_Stream6_IRQn);
 
 }
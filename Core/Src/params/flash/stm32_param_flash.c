@@ -0,0 +1,103 @@
+/*
+ * stm32_param_flash.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx_hal.h"
+#include "params/flash/stm32_param_flash.h"
+
+/**
+  * @brief  Parameter Bank Sectors
+  * 		NOTE: must match the PARAMS region in the linker script (sectors
+  * 		10-11 are excluded from FLASH so code never lands in them)
+  */
+#define PARAM_BANK_SIZE				(128U * 1024U)
+#define PARAM_BANK0_ADDR			0x080C0000UL
+#define PARAM_BANK0_SECTOR			FLASH_SECTOR_10
+#define PARAM_BANK1_ADDR			0x080E0000UL
+#define PARAM_BANK1_SECTOR			FLASH_SECTOR_11
+
+
+/**
+  * @brief helper function to get the flash address of a parameter bank
+  *
+  * @param  bank	bank index
+  * @retval bank start address
+  */
+static inline uint32_t bank_base(uint8_t bank) {
+	return (bank == 0U) ? PARAM_BANK0_ADDR : PARAM_BANK1_ADDR;
+}
+
+/**
+  * @brief get memory-mapped address of a parameter bank
+  *
+  * @param  bank	bank index
+  * @retval read-only pointer to bank start
+  */
+static const uint8_t *stm32_param_flash_bank_addr(uint8_t bank) {
+	return (const uint8_t*) bank_base(bank);
+}
+
+/**
+  * @brief erase a parameter bank
+  * 	   NOTE: a 128K sector erase stalls flash reads (and so the cpu) for ~1-2s
+  *
+  * @param  bank	bank index
+  * @retval boolean
+  */
+static bool stm32_param_flash_erase(uint8_t bank) {
+	FLASH_EraseInitTypeDef erase = {0};
+	uint32_t sector_error = 0U;
+	HAL_StatusTypeDef status;
+
+	erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+	erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+	erase.Sector = (bank == 0U) ? PARAM_BANK0_SECTOR : PARAM_BANK1_SECTOR;
+	erase.NbSectors = 1U;
+
+	HAL_FLASH_Unlock();
+	status = HAL_FLASHEx_Erase(&erase, &sector_error);
+	HAL_FLASH_Lock();
+
+	return (status == HAL_OK) && (sector_error == 0xFFFFFFFFU);
+}
+
+/**
+  * @brief program words into a parameter bank
+  *
+  * @param  bank	bank index
+  * @param	offset	byte offset within bank (word aligned)
+  * @param	words	read-only pointer to words to program
+  * @param	count	number of words
+  *
+  * @retval boolean
+  */
+static bool stm32_param_flash_program(uint8_t bank, uint32_t offset, const uint32_t *words, uint32_t count) {
+	uint32_t addr = bank_base(bank) + offset;
+	bool ok = true;
+
+	if (((offset & 0x3U) != 0U) || ((offset + count * sizeof(uint32_t)) > PARAM_BANK_SIZE))
+		return false;
+
+	HAL_FLASH_Unlock();
+	for (uint32_t i = 0; (i < count) && ok; ++i) {
+		ok = (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr + i * sizeof(uint32_t), words[i]) == HAL_OK);
+	}
+	HAL_FLASH_Lock();
+
+	return ok;
+}
+
+/**
+  * @brief  STM32 Internal Flash Parameter Storage Interface
+  */
+const param_flash_interface_t stm32_param_flash = {
+	.bank_size = PARAM_BANK_SIZE,
+	.bank_addr = stm32_param_flash_bank_addr,
+	.erase = stm32_param_flash_erase,
+	.program = stm32_param_flash_program
+};
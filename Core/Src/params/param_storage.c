@@ -0,0 +1,337 @@
+/*
+ * param_storage.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "params/param_storage.h"
+#include "common/crc.h"
+
+/**
+  * @brief  Storage Format Constants
+  */
+#define STORAGE_MAGIC			0x50435141UL	// "AQCP"
+#define STORAGE_HEADER_SIZE		16U
+#define STORAGE_RECORD_SIZE		8U
+#define STORAGE_ERASED_WORD		0xFFFFFFFFUL
+#define STORAGE_KEY_INVALID		0xFFFFU
+
+/**
+  * @brief  Migrated Keys (params.c definitions)
+  */
+#define KEY_ESC_CMD_LIFTOFF_PCT		0x0301U
+#define V2_ESC_CMD_LIFTOFF_PCT_MAX	50.0f		// was 60, could exceed ESC_LIMIT_PCT (>= 50)
+
+/**
+  * @brief  Bank Header Type (programmed last, marks a bank as valid)
+  */
+typedef struct {
+	uint32_t magic;
+	uint32_t seq;
+	uint16_t version;
+	uint16_t crc;
+	uint32_t reserved;
+} storage_header_t;
+
+/**
+  * @brief  Parameter Record Type
+  */
+typedef struct {
+	uint16_t key;
+	uint16_t crc;
+	uint32_t value;
+} storage_record_t;
+
+_Static_assert(sizeof(storage_header_t) == STORAGE_HEADER_SIZE, "param storage header size mismatch");
+_Static_assert(sizeof(storage_record_t) == STORAGE_RECORD_SIZE, "param storage record size mismatch");
+
+/**
+  * @brief  Flash Driver Pointer
+  */
+static const param_flash_interface_t *flash = NULL;
+
+/**
+  * @brief  Active Bank State
+  */
+static bool has_active;
+static uint8_t active_bank;
+static uint32_t active_seq;
+static uint16_t active_version;
+static uint32_t write_offset;
+
+
+/**
+  * @brief helper function to validate flash driver initialization
+  *
+  * @param  driver	pointer to flash driver
+  * @retval boolean
+  */
+static bool valid_flash_driver(const param_flash_interface_t *driver) {
+	return (driver &&
+			driver->bank_addr &&
+			driver->erase &&
+			driver->program &&
+			(driver->bank_size > STORAGE_HEADER_SIZE));
+}
+
+/**
+  * @brief helper function to compute header crc (over magic, seq, version)
+  *
+  * @retval crc
+  */
+static uint16_t header_crc(const storage_header_t *hdr) {
+	return crc16_ccitt((const uint8_t*) hdr, offsetof(storage_header_t, crc));
+}
+
+/**
+  * @brief helper function to compute record crc (over key and value)
+  *
+  * @retval crc
+  */
+static uint16_t record_crc(uint16_t key, uint32_t value) {
+	const uint8_t buf[6] = {(uint8_t) key, (uint8_t)(key >> 8),
+							(uint8_t) value, (uint8_t)(value >> 8),
+							(uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+	return crc16_ccitt(buf, sizeof(buf));
+}
+
+/**
+  * @brief helper function to read a bank header
+  *
+  * @retval boolean (true if the bank holds a valid, readable header)
+  */
+static bool read_header(uint8_t bank, storage_header_t *hdr) {
+	memcpy(hdr, flash->bank_addr(bank), sizeof(*hdr));
+
+	if (hdr->magic != STORAGE_MAGIC)
+		return false;
+
+	if (hdr->crc != header_crc(hdr))
+		return false;
+
+	/* Written by newer firmware: layout unknown, leave it alone */
+	if (hdr->version > PARAM_STORAGE_VERSION)
+		return false;
+
+	return true;
+}
+
+/**
+  * @brief helper function to read the record at a bank offset
+  *
+  * @retval boolean (false if the slot is erased)
+  */
+static bool read_record(uint8_t bank, uint32_t offset, storage_record_t *rec) {
+	uint32_t words[2];
+
+	memcpy(words, flash->bank_addr(bank) + offset, sizeof(words));
+
+	if ((words[0] == STORAGE_ERASED_WORD) && (words[1] == STORAGE_ERASED_WORD))
+		return false;
+
+	memcpy(rec, words, sizeof(*rec));
+	return true;
+}
+
+/**
+  * @brief helper function to program one record at a bank offset
+  *
+  * @retval boolean
+  */
+static bool program_record(uint8_t bank, uint32_t offset, uint16_t key, uint32_t value) {
+	const uint32_t words[2] = {(uint32_t) key | ((uint32_t) record_crc(key, value) << 16), value};
+	return flash->program(bank, offset, words, 2U);
+}
+
+/**
+  * @brief helper function to upgrade a record from an older storage version
+  * 	   NOTE: keys are stable, so adding or removing parameters never needs a
+  * 	   version bump; only changes in meaning or units of an existing key do,
+  * 	   and get a case here keyed on the version they were introduced in
+  *
+  * @param  from_version	storage version the record was written with
+  * @param	key				pointer to record key (may be remapped)
+  * @param	value			pointer to record value (may be converted)
+  *
+  * @retval boolean (false drops the record)
+  */
+static bool migrate_record(uint16_t from_version, uint16_t *key, uint32_t *value) {
+	float f;
+
+	/* v2: liftoff capped at the lowest limit; clamp a higher value rather than
+	 * have it rejected and fall back to the default (a NaN is still rejected) */
+	if ((from_version < 2U) && (*key == KEY_ESC_CMD_LIFTOFF_PCT)) {
+		memcpy(&f, value, sizeof(f));
+		if (f > V2_ESC_CMD_LIFTOFF_PCT_MAX) {
+			f = V2_ESC_CMD_LIFTOFF_PCT_MAX;
+			memcpy(value, &f, sizeof(f));
+		}
+	}
+
+	return true;
+}
+
+/**
+  * @brief init parameter storage: selects the newest valid bank and locates
+  * 	   the append position
+  *
+  * @param  driver	pointer to flash driver
+  * @retval storage status
+  */
+param_storage_status_t param_storage_init(const param_flash_interface_t *driver) {
+	storage_header_t hdr;
+	storage_record_t rec;
+
+	if (!valid_flash_driver(driver))
+		return PARAM_STORAGE_ERROR_FATAL;
+
+	flash = driver;
+	has_active = false;
+
+	for (uint8_t bank = 0; bank < PARAM_STORAGE_BANK_COUNT; ++bank) {
+		if (!read_header(bank, &hdr))
+			continue;
+
+		/* Sequence comparison tolerates wrap-around */
+		if (!has_active || ((int32_t)(hdr.seq - active_seq) > 0)) {
+			has_active = true;
+			active_bank = bank;
+			active_seq = hdr.seq;
+			active_version = hdr.version;
+		}
+	}
+
+	if (!has_active)
+		return PARAM_STORAGE_OK;	// blank storage: defaults until first save
+
+	/* Append position is the first fully erased record slot */
+	write_offset = STORAGE_HEADER_SIZE;
+	while (((write_offset + STORAGE_RECORD_SIZE) <= flash->bank_size) &&
+			read_record(active_bank, write_offset, &rec)) {
+		write_offset += STORAGE_RECORD_SIZE;
+	}
+
+	return PARAM_STORAGE_OK;
+}
+
+/**
+  * @brief replays the active bank records in write order (last write wins)
+  *
+  * @param  apply	record apply callback
+  * @retval storage status (WARN if any record was corrupt or rejected)
+  */
+param_storage_status_t param_storage_load(param_apply_t apply) {
+	param_storage_status_t status = PARAM_STORAGE_OK;
+	storage_record_t rec;
+	uint16_t key;
+	uint32_t value;
+
+	if (!flash || !apply)
+		return PARAM_STORAGE_ERROR_FATAL;
+
+	if (!has_active)
+		return PARAM_STORAGE_OK;
+
+	for (uint32_t offset = STORAGE_HEADER_SIZE; offset < write_offset; offset += STORAGE_RECORD_SIZE) {
+		if (!read_record(active_bank, offset, &rec))
+			break;
+
+		/* Torn or corrupt write: skip it, older value stays in effect */
+		if ((rec.key == STORAGE_KEY_INVALID) || (rec.crc != record_crc(rec.key, rec.value))) {
+			status = PARAM_STORAGE_ERROR_WARN;
+			continue;
+		}
+
+		key = rec.key;
+		value = rec.value;
+
+		if ((active_version < PARAM_STORAGE_VERSION) && !migrate_record(active_version, &key, &value))
+			continue;
+
+		if (!apply(key, value))
+			status = PARAM_STORAGE_ERROR_WARN;
+	}
+
+	return status;
+}
+
+/**
+  * @brief helper function to rewrite the live set into the inactive bank and
+  * 	   switch over to it (header programmed last)
+  *
+  * @retval storage status
+  */
+static param_storage_status_t compact(const param_entry_t *live, uint32_t live_count) {
+	storage_header_t hdr;
+	uint8_t target = has_active ? (uint8_t)((active_bank + 1U) % PARAM_STORAGE_BANK_COUNT) : 0U;
+	uint32_t offset = STORAGE_HEADER_SIZE;
+
+	if ((STORAGE_HEADER_SIZE + live_count * STORAGE_RECORD_SIZE) > flash->bank_size)
+		return PARAM_STORAGE_ERROR_FATAL;
+
+	if (!flash->erase(target))
+		return PARAM_STORAGE_ERROR_WARN;
+
+	for (uint32_t i = 0; i < live_count; ++i) {
+		if (!program_record(target, offset, live[i].key, live[i].value))
+			return PARAM_STORAGE_ERROR_WARN;
+		offset += STORAGE_RECORD_SIZE;
+	}
+
+	hdr.magic = STORAGE_MAGIC;
+	hdr.seq = has_active ? (active_seq + 1U) : 1U;
+	hdr.version = PARAM_STORAGE_VERSION;
+	hdr.crc = header_crc(&hdr);
+	hdr.reserved = STORAGE_ERASED_WORD;
+
+	if (!flash->program(target, 0U, (const uint32_t*) &hdr, sizeof(hdr) / sizeof(uint32_t)))
+		return PARAM_STORAGE_ERROR_WARN;
+
+	has_active = true;
+	active_bank = target;
+	active_seq = hdr.seq;
+	active_version = hdr.version;
+	write_offset = offset;
+
+	return PARAM_STORAGE_OK;
+}
+
+/**
+  * @brief persists parameter changes: appends the changed entries to the
+  * 	   active bank, or compacts the live set into the other bank when the
+  * 	   active bank is full, blank or from an older storage version
+  * 	   NOTE: flash erase/program stalls the cpu, never call while armed
+  *
+  * @param  changed			entries changed since the last save
+  * @param	changed_count	number of changed entries
+  * @param	live			entries that differ from their defaults
+  * @param	live_count		number of live entries
+  *
+  * @retval storage status
+  */
+param_storage_status_t param_storage_save(const param_entry_t *changed, uint32_t changed_count,
+										  const param_entry_t *live, uint32_t live_count) {
+	if (!flash)
+		return PARAM_STORAGE_ERROR_FATAL;
+
+	if (changed_count == 0U)
+		return PARAM_STORAGE_OK;
+
+	bool room = (write_offset + changed_count * STORAGE_RECORD_SIZE) <= flash->bank_size;
+
+	if (!has_active || (active_version != PARAM_STORAGE_VERSION) || !room)
+		return compact(live, live_count);
+
+	for (uint32_t i = 0; i < changed_count; ++i) {
+		bool ok = program_record(active_bank, write_offset, changed[i].key, changed[i].value);
+		write_offset += STORAGE_RECORD_SIZE;	// a failed slot is burnt either way
+
+		if (!ok)
+			return PARAM_STORAGE_ERROR_WARN;
+	}
+
+	return PARAM_STORAGE_OK;
+}
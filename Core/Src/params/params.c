@@ -0,0 +1,470 @@
+/*
+ * params.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include "params/params.h"
+#include "params/param_storage.h"
+#include "params/flash/stm32_param_flash.h"
+#include "params/flash/ram_param_flash.h"
+#include "common/settings.h"
+
+/**
+  * @brief  Parameter Storage Setting
+  */
+#define PARAM_STORAGE				CONFIG_PARAM_STORAGE
+
+/**
+  * @brief  Change Listener Capacity
+  */
+#define PARAM_LISTENERS_MAX			8U
+
+/**
+  * @brief  Dirty Bitmap Size (words)
+  */
+#define PARAM_DIRTY_WORDS			((PARAM_COUNT + 31U) / 32U)
+
+/**
+  * @brief  Parameter Name Helper (a string literal; fails the build if it is
+  * 		longer than PARAM_NAME_LEN_MAX)
+  */
+#define PARAM_NAME(_name) \
+	((_name) + 0U * sizeof(struct { \
+		_Static_assert(sizeof(_name) - 1U <= PARAM_NAME_LEN_MAX, "parameter name too long: " _name); int unused; }))
+
+/**
+  * @brief  Parameter Definition Helpers
+  */
+#define PARAM_FLOAT(_name, _key, _group, _flags, _min, _max, _def) \
+	{.name = PARAM_NAME(_name), .key = (_key), .type = PARAM_TYPE_FLOAT, .group = (_group), .flags = (_flags), \
+	 .min = (_min), .max = (_max), .def = (_def)}
+
+#define PARAM_U32(_name, _key, _group, _flags, _min, _max, _def) \
+	{.name = PARAM_NAME(_name), .key = (_key), .type = PARAM_TYPE_U32, .group = (_group), .flags = (_flags), \
+	 .min = (_min), .max = (_max), .def = (_def)}
+
+#define PARAM_PID(_prefix, _stem, _key, _p, _i, _d, _wc, _lim, _ilim, _lim_max) \
+	[_prefix##_P]			= PARAM_FLOAT(_stem "_P",		(_key) + 0U, PARAM_GROUP_PID, 0U, 0.0f, 50.0f, (_p)), \
+	[_prefix##_I]			= PARAM_FLOAT(_stem "_I",		(_key) + 1U, PARAM_GROUP_PID, 0U, 0.0f, 50.0f, (_i)), \
+	[_prefix##_D]			= PARAM_FLOAT(_stem "_D",		(_key) + 2U, PARAM_GROUP_PID, 0U, 0.0f, 10.0f, (_d)), \
+	[_prefix##_D_LPF_HZ]	= PARAM_FLOAT(_stem "_D_LPF",	(_key) + 3U, PARAM_GROUP_PID, 0U, 1.0f, 500.0f, (_wc)), \
+	[_prefix##_CMD_LIM]		= PARAM_FLOAT(_stem "_LIM",		(_key) + 4U, PARAM_GROUP_PID, 0U, 0.0f, (_lim_max), (_lim)), \
+	[_prefix##_I_CMD_LIM]	= PARAM_FLOAT(_stem "_I_LIM",	(_key) + 5U, PARAM_GROUP_PID, 0U, 0.0f, (_lim_max), (_ilim))
+
+/**
+  * @brief  Parameter Definitions (defaults come from settings.h)
+  * 		NOTE: keys are persisted, never renumber or reuse them
+  */
+static const param_def_t defs[PARAM_COUNT] = {
+	/* Attitude Estimation */
+	[PARAM_COMP_FILT_GAIN_XL]			= PARAM_FLOAT("COMP_GAIN_XL", 0x0100U, PARAM_GROUP_ATTITUDE, 0U, 0.0f, 1.0f, CONFIG_COMP_FILT_GAIN_XL),
+	[PARAM_ROLL_TAKEOFF_LIMIT_DEG]		= PARAM_FLOAT("ROLL_TKOFF_LIM", 0x0101U, PARAM_GROUP_ATTITUDE, 0U, 0.0f, 45.0f, CONFIG_ROLL_TAKEOFF_LIMIT_DEG),
+	[PARAM_PITCH_TAKEOFF_LIMIT_DEG]		= PARAM_FLOAT("PITCH_TKOFF_LIM", 0x0102U, PARAM_GROUP_ATTITUDE, 0U, 0.0f, 45.0f, CONFIG_PITCH_TAKEOFF_LIMIT_DEG),
+
+	/* Attitude PIDs (angle limits in dps, rate limits in % of motor command range) */
+	PARAM_PID(PARAM_ROLL_ANGLE, "ROLL_ANG", 0x0200U,
+			  CONFIG_ROLL_ANGLE_P_GAIN, CONFIG_ROLL_ANGLE_I_GAIN, CONFIG_ROLL_ANGLE_D_GAIN,
+			  CONFIG_ROLL_ANGLE_D_LPF_CUTOFF_FREQ_HZ, CONFIG_ROLL_ANGLE_CMD_LIM_DPS, CONFIG_ROLL_ANGLE_I_CMD_LIM_DPS, 1000.0f),
+	PARAM_PID(PARAM_PITCH_ANGLE, "PITCH_ANG", 0x0210U,
+			  CONFIG_PITCH_ANGLE_P_GAIN, CONFIG_PITCH_ANGLE_I_GAIN, CONFIG_PITCH_ANGLE_D_GAIN,
+			  CONFIG_PITCH_ANGLE_D_LPF_CUTOFF_FREQ_HZ, CONFIG_PITCH_ANGLE_CMD_LIM_DPS, CONFIG_PITCH_ANGLE_I_CMD_LIM_DPS, 1000.0f),
+	PARAM_PID(PARAM_ROLL_RATE, "ROLL_RATE", 0x0220U,
+			  CONFIG_ROLL_RATE_P_GAIN, CONFIG_ROLL_RATE_I_GAIN, CONFIG_ROLL_RATE_D_GAIN,
+			  CONFIG_ROLL_RATE_D_LPF_CUTOFF_FREQ_HZ, CONFIG_ROLL_RATE_CMD_LIM_PCT, CONFIG_ROLL_RATE_I_CMD_LIM_PCT, 25.0f),
+	PARAM_PID(PARAM_PITCH_RATE, "PITCH_RATE", 0x0230U,
+			  CONFIG_PITCH_RATE_P_GAIN, CONFIG_PITCH_RATE_I_GAIN, CONFIG_PITCH_RATE_D_GAIN,
+			  CONFIG_PITCH_RATE_D_LPF_CUTOFF_FREQ_HZ, CONFIG_PITCH_RATE_CMD_LIM_PCT, CONFIG_PITCH_RATE_I_CMD_LIM_PCT, 25.0f),
+	PARAM_PID(PARAM_YAW_RATE, "YAW_RATE", 0x0240U,
+			  CONFIG_YAW_RATE_P_GAIN, CONFIG_YAW_RATE_I_GAIN, CONFIG_YAW_RATE_D_GAIN,
+			  CONFIG_YAW_RATE_D_LPF_CUTOFF_FREQ_HZ, CONFIG_YAW_RATE_CMD_LIM_PCT, CONFIG_YAW_RATE_I_CMD_LIM_PCT, 25.0f),
+
+	/* Altitude Hold PIDs (position limits in m/s, velocity limits in % throttle around hover) */
+	PARAM_PID(PARAM_ALT_POS, "ALT_POS", 0x0250U,
+			  CONFIG_ALT_POS_P_GAIN, CONFIG_ALT_POS_I_GAIN, CONFIG_ALT_POS_D_GAIN,
+			  CONFIG_ALT_POS_D_LPF_CUTOFF_FREQ_HZ, CONFIG_ALT_POS_CMD_LIM_MPS, CONFIG_ALT_POS_I_CMD_LIM_MPS, 5.0f),
+	PARAM_PID(PARAM_ALT_VEL, "ALT_VEL", 0x0260U,
+			  CONFIG_ALT_VEL_P_GAIN, CONFIG_ALT_VEL_I_GAIN, CONFIG_ALT_VEL_D_GAIN,
+			  CONFIG_ALT_VEL_D_LPF_CUTOFF_FREQ_HZ, CONFIG_ALT_VEL_CMD_LIM_PCT, CONFIG_ALT_VEL_I_CMD_LIM_PCT, 50.0f),
+
+	/* Altitude Hold (hover throttle is the starting point, learned in flight) */
+	[PARAM_ALT_CLIMB_MAX_MPS]			= PARAM_FLOAT("ALT_CLIMB_MAX", 0x0600U, PARAM_GROUP_ALTITUDE, 0U, 0.2f, 5.0f, CONFIG_ALT_CLIMB_MAX_MPS),
+	[PARAM_ALT_HOVER_THROTTLE_PCT]		= PARAM_FLOAT("ALT_HOVER_THR", 0x0601U, PARAM_GROUP_ALTITUDE, 0U, 10.0f, 80.0f, CONFIG_ALT_HOVER_THROTTLE_PCT),
+
+	/* Magnetometer (identity calibration until one is fitted) */
+	[PARAM_MAG_OFFSET_X]				= PARAM_FLOAT("MAG_OFS_X", 0x0700U, PARAM_GROUP_MAG, 0U, -5000.0f, 5000.0f, 0.0f),
+	[PARAM_MAG_OFFSET_Y]				= PARAM_FLOAT("MAG_OFS_Y", 0x0701U, PARAM_GROUP_MAG, 0U, -5000.0f, 5000.0f, 0.0f),
+	[PARAM_MAG_OFFSET_Z]				= PARAM_FLOAT("MAG_OFS_Z", 0x0702U, PARAM_GROUP_MAG, 0U, -5000.0f, 5000.0f, 0.0f),
+	[PARAM_MAG_SOFT_XX]					= PARAM_FLOAT("MAG_SOFT_XX", 0x0703U, PARAM_GROUP_MAG, 0U, 0.2f, 5.0f, 1.0f),
+	[PARAM_MAG_SOFT_XY]					= PARAM_FLOAT("MAG_SOFT_XY", 0x0704U, PARAM_GROUP_MAG, 0U, -2.0f, 2.0f, 0.0f),
+	[PARAM_MAG_SOFT_XZ]					= PARAM_FLOAT("MAG_SOFT_XZ", 0x0705U, PARAM_GROUP_MAG, 0U, -2.0f, 2.0f, 0.0f),
+	[PARAM_MAG_SOFT_YY]					= PARAM_FLOAT("MAG_SOFT_YY", 0x0706U, PARAM_GROUP_MAG, 0U, 0.2f, 5.0f, 1.0f),
+	[PARAM_MAG_SOFT_YZ]					= PARAM_FLOAT("MAG_SOFT_YZ", 0x0707U, PARAM_GROUP_MAG, 0U, -2.0f, 2.0f, 0.0f),
+	[PARAM_MAG_SOFT_ZZ]					= PARAM_FLOAT("MAG_SOFT_ZZ", 0x0708U, PARAM_GROUP_MAG, 0U, 0.2f, 5.0f, 1.0f),
+	[PARAM_MAG_DECLINATION_DEG]			= PARAM_FLOAT("MAG_DECL_DEG", 0x0709U, PARAM_GROUP_MAG, 0U, -180.0f, 180.0f, CONFIG_MAG_DECLINATION_DEG),
+	[PARAM_MAG_HEADING_TAU_S]			= PARAM_FLOAT("MAG_HDG_TAU", 0x070AU, PARAM_GROUP_MAG, 0U, 0.5f, 60.0f, CONFIG_MAG_HEADING_TAU_S),
+
+	/* Battery Monitor (sensor scaling of the board; cells 0: detected) */
+	[PARAM_BATT_VOLT_SCALE]				= PARAM_FLOAT("BATT_V_SCALE", 0x0800U, PARAM_GROUP_BATTERY, 0U, 1.0f, 100.0f, CONFIG_BATT_VOLT_SCALE),
+	[PARAM_BATT_CURR_SCALE]				= PARAM_FLOAT("BATT_I_SCALE", 0x0801U, PARAM_GROUP_BATTERY, 0U, 0.0f, 1000.0f, CONFIG_BATT_CURR_SCALE_A_PER_V),
+	[PARAM_BATT_CURR_OFFSET_V]			= PARAM_FLOAT("BATT_I_OFS_V", 0x0802U, PARAM_GROUP_BATTERY, 0U, -3.3f, 3.3f, CONFIG_BATT_CURR_OFFSET_V),
+	[PARAM_BATT_CELLS]					= PARAM_U32("BATT_CELLS", 0x0803U, PARAM_GROUP_BATTERY, PARAM_FLAG_DISARMED_ONLY, 0.0f, 12.0f, CONFIG_BATT_CELLS),
+
+	/* ESC Commands (ranges keep idle and liftoff at or below limit, orders keep
+	 * idle below liftoff; liftoff was capped at 60 before storage version 2,
+	 * see migrate_record) */
+	[PARAM_ESC_CMD_IDLE_PCT]			= PARAM_FLOAT("ESC_IDLE_PCT", 0x0300U, PARAM_GROUP_ESC, PARAM_FLAG_DISARMED_ONLY, 0.0f, 40.0f, CONFIG_ESC_CMD_IDLE_PCT),
+	[PARAM_ESC_CMD_LIFTOFF_PCT]			= PARAM_FLOAT("ESC_LIFTOFF_PCT", 0x0301U, PARAM_GROUP_ESC, PARAM_FLAG_DISARMED_ONLY, 0.0f, 50.0f, CONFIG_ESC_CMD_LIFTOFF_PCT),
+	[PARAM_ESC_CMD_LIMIT_PCT]			= PARAM_FLOAT("ESC_LIMIT_PCT", 0x0302U, PARAM_GROUP_ESC, PARAM_FLAG_DISARMED_ONLY, 50.0f, 100.0f, CONFIG_ESC_CMD_LIMIT_PCT),
+
+	/* RC Input (pulse ranges keep min below max) */
+	[PARAM_RC_PULSE_MIN_US]				= PARAM_U32("RC_PULSE_MIN", 0x0400U, PARAM_GROUP_RC, PARAM_FLAG_DISARMED_ONLY, PWM_PULSE_VALID_MIN_US, 1200.0f, CONFIG_PWM_PULSE_MIN_US),
+	[PARAM_RC_PULSE_MAX_US]				= PARAM_U32("RC_PULSE_MAX", 0x0401U, PARAM_GROUP_RC, PARAM_FLAG_DISARMED_ONLY, 1800.0f, PWM_PULSE_VALID_MAX_US, CONFIG_PWM_PULSE_MAX_US),
+	[PARAM_RC_ROLL_MAX_DEG]				= PARAM_FLOAT("RC_ROLL_MAX_DEG", 0x0402U, PARAM_GROUP_RC, 0U, 1.0f, 60.0f, CONFIG_ROLL_MAX_DEG),
+	[PARAM_RC_ROLL_MAX_DPS]				= PARAM_FLOAT("RC_ROLL_MAX_DPS", 0x0403U, PARAM_GROUP_RC, 0U, 10.0f, 1000.0f, CONFIG_ROLL_MAX_DPS),
+	[PARAM_RC_PITCH_MAX_DEG]			= PARAM_FLOAT("RC_PITCH_MAX_DEG", 0x0404U, PARAM_GROUP_RC, 0U, 1.0f, 60.0f, CONFIG_PITCH_MAX_DEG),
+	[PARAM_RC_PITCH_MAX_DPS]			= PARAM_FLOAT("RC_PITCH_MAX_DPS", 0x0405U, PARAM_GROUP_RC, 0U, 10.0f, 1000.0f, CONFIG_PITCH_MAX_DPS),
+	[PARAM_RC_YAW_MAX_DPS]				= PARAM_FLOAT("RC_YAW_MAX_DPS", 0x0406U, PARAM_GROUP_RC, 0U, 10.0f, 1000.0f, CONFIG_YAW_MAX_DPS),
+	[PARAM_RC_THROTTLE_IDLE_TOL_PCT]	= PARAM_FLOAT("RC_THR_IDLE_TOL", 0x0407U, PARAM_GROUP_RC, 0U, 0.0f, 20.0f, CONFIG_THROTTLE_IDLE_TOLERANCE_PCT),
+	[PARAM_RC_MODE_SWITCH_HIGH]			= PARAM_U32("RC_MODE_SW_HIGH", 0x0408U, PARAM_GROUP_RC, PARAM_FLAG_DISARMED_ONLY, 2.0f, 3.0f, CONFIG_RC_MODE_SWITCH_HIGH),
+
+	/* System (u32 values stay exact up to 2^24) */
+	[PARAM_SYS_BOOT_COUNT]				= PARAM_U32("SYS_BOOT_COUNT", 0x0500U, PARAM_GROUP_SYSTEM, PARAM_FLAG_READONLY, 0.0f, 16777215.0f, 0.0f)
+};
+
+/**
+  * @brief  Parameter Orders (pairs whose ranges overlap or may come to: the low
+  * 		one must stay below the high one, or the esc idle / liftoff commands
+  * 		and the rc pulse span invert)
+  */
+typedef struct {
+	param_id_t low;
+	param_id_t high;
+} param_order_t;
+
+static const param_order_t orders[] = {
+	{PARAM_ESC_CMD_IDLE_PCT, PARAM_ESC_CMD_LIFTOFF_PCT},
+	{PARAM_RC_PULSE_MIN_US, PARAM_RC_PULSE_MAX_US}
+};
+
+/**
+  * @brief  Parameter Values (raw 32-bit encoding of each definition's type)
+  */
+static uint32_t values[PARAM_COUNT];
+
+/**
+  * @brief  Parameters Changed Since Last Save
+  */
+static uint32_t dirty[PARAM_DIRTY_WORDS];
+
+/**
+  * @brief  Change Listeners
+  */
+static struct {
+	uint32_t group_mask;
+	param_listener_t fn;
+} listeners[PARAM_LISTENERS_MAX];
+static uint32_t listener_count;
+
+/**
+  * @brief  Flash Driver Pointer for Storage Interface
+  */
+static const param_flash_interface_t *flash_driver = NULL;
+
+
+/**
+  * @brief helper function to encode a value in a definition's raw type
+  *
+  * @retval raw value
+  */
+static inline uint32_t encode(const param_def_t *def, float value) {
+	uint32_t raw;
+
+	if (def->type == PARAM_TYPE_U32)
+		return (uint32_t) value;
+
+	memcpy(&raw, &value, sizeof(raw));
+	return raw;
+}
+
+/**
+  * @brief helper function to decode a raw value as float
+  *
+  * @retval value
+  */
+static inline float decode(const param_def_t *def, uint32_t raw) {
+	float value;
+
+	if (def->type == PARAM_TYPE_U32)
+		return (float) raw;
+
+	memcpy(&value, &raw, sizeof(value));
+	return value;
+}
+
+/**
+  * @brief helper function to validate a value against a definition
+  *
+  * @retval boolean
+  */
+static bool valid_value(const param_def_t *def, float value) {
+	if (!isfinite(value))
+		return false;
+
+	if ((def->type == PARAM_TYPE_U32) && (value != floorf(value)))
+		return false;
+
+	return (value >= def->min) && (value <= def->max);
+}
+
+/**
+  * @brief helper function to check a value against the orders its parameter
+  * 	   is in (the other side at its current value)
+  *
+  * @retval boolean
+  */
+static bool ordered_value(param_id_t id, float value) {
+	for (uint32_t i = 0; i < sizeof(orders) / sizeof(orders[0]); ++i) {
+		if ((id == orders[i].low) && !(value < params_get_float(orders[i].high)))
+			return false;
+
+		if ((id == orders[i].high) && !(params_get_float(orders[i].low) < value))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief helper function to restore the defaults of any pair loaded out of
+  * 	   order (each record was only checked alone)
+  *
+  * @retval boolean (false if a pair was restored)
+  */
+static bool restore_orders(void) {
+	bool ordered = true;
+
+	for (uint32_t i = 0; i < sizeof(orders) / sizeof(orders[0]); ++i) {
+		const param_order_t *o = &orders[i];
+
+		if (params_get_float(o->low) < params_get_float(o->high))
+			continue;
+
+		values[o->low] = encode(&defs[o->low], defs[o->low].def);
+		values[o->high] = encode(&defs[o->high], defs[o->high].def);
+		ordered = false;
+	}
+
+	return ordered;
+}
+
+/**
+  * @brief helper function to apply one persisted record during load
+  * 	   (unknown keys belong to removed parameters and are ignored)
+  *
+  * @retval boolean (false if a known key carries an invalid value)
+  */
+static bool apply_record(uint16_t key, uint32_t raw) {
+	for (uint32_t id = 0; id < PARAM_COUNT; ++id) {
+		if (defs[id].key != key)
+			continue;
+
+		if (!valid_value(&defs[id], decode(&defs[id], raw)))
+			return false;
+
+		values[id] = raw;
+		return true;
+	}
+
+	return true;
+}
+
+/**
+  * @brief init parameter registry: loads defaults then replays persisted values
+  * 	   NOTE: call before any module init that reads parameters
+  *
+  * @retval param status (WARN if storage was unreadable or partly corrupt;
+  * 		defaults remain in effect for anything not restored)
+  */
+param_status_t params_init(void) {
+	/* Use pre-processor conditionals based on configured storage to initialize flash_driver */
+	#if PARAM_STORAGE == STM32_FLASH_PARAM_STORAGE_ID
+		flash_driver = &stm32_param_flash;
+	#elif PARAM_STORAGE == RAM_PARAM_STORAGE_ID
+		flash_driver = &ram_param_flash;
+	#else
+		#error "Invalid parameter storage configuration"
+	#endif
+
+	for (uint32_t id = 0; id < PARAM_COUNT; ++id) {
+		values[id] = encode(&defs[id], defs[id].def);
+	}
+
+	memset(dirty, 0, sizeof(dirty));
+	listener_count = 0U;
+
+	if (param_storage_init(flash_driver) != PARAM_STORAGE_OK)
+		return PARAM_ERROR_FATAL;
+
+	if (param_storage_load(apply_record) != PARAM_STORAGE_OK) {
+		restore_orders();
+		return PARAM_ERROR_WARN;
+	}
+
+	return restore_orders() ? PARAM_OK : PARAM_ERROR_WARN;
+}
+
+/**
+  * @brief fetches a parameter definition
+  *
+  * @param  id		parameter id
+  * @retval read-only pointer to definition (NULL if id is invalid)
+  */
+const param_def_t *params_get_def(param_id_t id) {
+	if ((uint32_t) id >= PARAM_COUNT)
+		return NULL;
+
+	return &defs[id];
+}
+
+/**
+  * @brief fetches a parameter value as float
+  *
+  * @param  id		parameter id (must be valid)
+  * @retval parameter value
+  */
+float params_get_float(param_id_t id) {
+	return decode(&defs[id], values[id]);
+}
+
+/**
+  * @brief fetches a parameter value as unsigned integer
+  *
+  * @param  id		parameter id (must be valid)
+  * @retval parameter value
+  */
+uint32_t params_get_u32(param_id_t id) {
+	if (defs[id].type == PARAM_TYPE_U32)
+		return values[id];
+
+	return (uint32_t) decode(&defs[id], values[id]);
+}
+
+/**
+  * @brief sets a parameter and notifies listeners of its group
+  * 	   NOTE: main loop context only (listeners run synchronously)
+  *
+  * @param  id		parameter id
+  * @param	value	new value (must be finite, within bounds, integral for u32,
+  * 				and keep its orders: e.g. idle below liftoff)
+  *
+  * @retval param status (WARN if rejected; value left unchanged)
+  */
+param_status_t params_set(param_id_t id, float value) {
+	const param_def_t *def = params_get_def(id);
+	uint32_t raw;
+
+	if (!def || !valid_value(def, value) || !ordered_value(id, value))
+		return PARAM_ERROR_WARN;
+
+	raw = encode(def, value);
+	if (raw == values[id])
+		return PARAM_OK;
+
+	values[id] = raw;
+	dirty[id / 32U] |= (1UL << (id % 32U));
+
+	for (uint32_t i = 0; i < listener_count; ++i) {
+		if (listeners[i].group_mask & def->group)
+			listeners[i].fn(id);
+	}
+
+	return PARAM_OK;
+}
+
+/**
+  * @brief registers a change listener for one or more parameter groups
+  * 	   NOTE: listeners run in registration order, so modules whose derived
+  * 	   values depend on another module must register after it; a listener
+  * 	   registered again (a module re-initialized) keeps its place and takes
+  * 	   the new mask, so re-inits do not use up the table
+  *
+  * @param  group_mask	bitmask of param_group_t
+  * @param	listener	change listener
+  *
+  * @retval param status
+  */
+param_status_t params_subscribe(uint32_t group_mask, param_listener_t listener) {
+	if (!listener)
+		return PARAM_ERROR_FATAL;
+
+	for (uint32_t i = 0; i < listener_count; ++i) {
+		if (listeners[i].fn == listener) {
+			listeners[i].group_mask = group_mask;
+			return PARAM_OK;
+		}
+	}
+
+	if (listener_count >= PARAM_LISTENERS_MAX)
+		return PARAM_ERROR_FATAL;
+
+	listeners[listener_count].group_mask = group_mask;
+	listeners[listener_count].fn = listener;
+	listener_count++;
+
+	return PARAM_OK;
+}
+
+/**
+  * @brief persists parameters changed since the last save
+  * 	   NOTE: may erase a flash sector (cpu stalls ~1-2s), never call while armed
+  *
+  * @retval param status
+  */
+param_status_t params_save(void) {
+	param_entry_t changed[PARAM_COUNT];
+	param_entry_t live[PARAM_COUNT];
+	uint32_t changed_count = 0U;
+	uint32_t live_count = 0U;
+	param_storage_status_t status;
+
+	for (uint32_t id = 0; id < PARAM_COUNT; ++id) {
+		if (dirty[id / 32U] & (1UL << (id % 32U))) {
+			changed[changed_count].key = defs[id].key;
+			changed[changed_count].value = values[id];
+			changed_count++;
+		}
+
+		/* Only values that differ from their default survive compaction */
+		if (values[id] != encode(&defs[id], defs[id].def)) {
+			live[live_count].key = defs[id].key;
+			live[live_count].value = values[id];
+			live_count++;
+		}
+	}
+
+	status = param_storage_save(changed, changed_count, live, live_count);
+	if (status != PARAM_STORAGE_OK)
+		return (param_status_t) status;
+
+	memset(dirty, 0, sizeof(dirty));
+	return PARAM_OK;
+}
+
+/**
+  * @brief checks whether any parameter changed since the last save
+  *
+  * @retval boolean
+  */
+bool params_is_dirty(void) {
+	for (uint32_t i = 0; i < PARAM_DIRTY_WORDS; ++i) {
+		if (dirty[i] != 0U)
+			return true;
+	}
+
+	return false;
+}
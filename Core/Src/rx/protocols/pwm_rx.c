@@ -13,6 +13,9 @@
 #include "common/maths.h"
 #include "common/hardware.h"
 #include "common/settings.h"
+#include "system/health.h"
+#include "system/irq.h"
+#include "system/driver_registry.h"
 
 /**
   * @brief  PWM Config Settings
@@ -52,6 +55,12 @@
 #define RX_CH6_GPIO_PORT				GPIOC
 #define RX_CH6_GPIO_PIN					GPIO_PIN_3
 
+/**
+  * @brief  Rx Channel -> EXTI IRQ Aliases
+  */
+#define RX_CH5_EXTI_IRQn				EXTI2_IRQn
+#define RX_CH6_EXTI_IRQn				EXTI3_IRQn
+
 /**
   * @brief  Rx Status Type Aliases
   */
@@ -119,11 +128,6 @@ static const TIM_HandleTypeDef* phtim_rx_ch4 = NULL;
 static uint32_t IC_TIMx_REF_ARR;
 static uint32_t IC_TIMxClkRefFreqMHz; // NOTE: Keep at 1MHz to avoid unnecessary division calcs \
 										  Otherwise this should be a FLOAT to avoid precision loss!
-/**
-  * @brief  ISR Callback Error Flag
-  */
-static bool ISR_Callback_Error_Flag;
-
 /**
   * @brief  wraps HAL_TIM_IC_Start_IT function
   *
@@ -198,12 +202,14 @@ static void update_pulse_edge(TIM_HandleTypeDef *htim, uint32_t channel, pulse_t
 	/* Check if Pulse is Rising or Falling */
 	if (pul->is_rising) {
 		pul->ic_val_r = HAL_TIM_ReadCapturedValue(htim, channel);
+		irq_latency_capture(htim->Instance, pul->ic_val_r);
 		Configure_IC_Polarity(htim, channel, TIM_INPUTCHANNELPOLARITY_FALLING);
 		pul->is_rising = false; // reset rising edge flag
 		pul->is_updated = false; // reset update flag
 
 	} else {
 		pul->ic_val_f = HAL_TIM_ReadCapturedValue(htim, channel);
+		irq_latency_capture(htim->Instance, pul->ic_val_f);
 		Configure_IC_Polarity(htim, channel, TIM_INPUTCHANNELPOLARITY_RISING);
 		pul->is_rising = true; // set rising edge flag
 		pul->is_updated = true; // set update flag
@@ -232,7 +238,7 @@ void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim) {
 
 	} else {
 		/* Unexpected input capture on unsupported TIMx/Channel combo */
-		ISR_Callback_Error_Flag = true;
+		health_record(HEALTH_MODULE_RX, HEALTH_SEVERITY_WARN, HEALTH_CODE_ISR_UNEXPECTED_IC);
 		return;
 	}
 }
@@ -257,7 +263,7 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
 
     } else {
 		/* Unexpected input on unsupported GPIO */
-    	ISR_Callback_Error_Flag = true;
+    	health_record(HEALTH_MODULE_RX, HEALTH_SEVERITY_WARN, HEALTH_CODE_ISR_UNEXPECTED_EXTI);
 		return;
     }
 }
@@ -443,6 +449,10 @@ static pwm_rx_status_t pwm_rx_start(void) {
 	if (IC_Start_Channel_IT(phtim_rx_ch4, RX_CH4_IC_TIM_CHANNEL) != HAL_OK)
 		return PWM_RX_ERROR_FATAL;
 
+	/* Enable Switch Interrupts (priority set by irq_init) */
+	HAL_NVIC_EnableIRQ(RX_CH5_EXTI_IRQn);
+	HAL_NVIC_EnableIRQ(RX_CH6_EXTI_IRQn);
+
 	return PWM_RX_OK;
 }
 
@@ -452,6 +462,10 @@ static pwm_rx_status_t pwm_rx_start(void) {
   * @retval pwm rx status
   */
 static pwm_rx_status_t pwm_rx_stop(void) {
+	/* Disable Switch Interrupts */
+	HAL_NVIC_DisableIRQ(RX_CH5_EXTI_IRQn);
+	HAL_NVIC_DisableIRQ(RX_CH6_EXTI_IRQn);
+
 	/* Stop Input Capture Interrupts */
 	if (IC_Stop_Channel_IT(phtim_rx_ch1, RX_CH1_IC_TIM_CHANNEL) != HAL_OK)
 		return PWM_RX_ERROR_FATAL;
@@ -520,3 +534,15 @@ const rx_protocol_interface_t pwm_rx_driver = {
 		.stop = pwm_rx_stop,
 		.get_channel = pwm_rx_get_channel,
 };
+
+/**
+  * @brief pwm rx driver registration (no probe: pwm inputs cannot be told
+  * 	   apart from an idle line, so it is bound when nothing is detected)
+  */
+DRIVER_REGISTER(pwm_rx_entry) = {
+	.name = "pwm",
+	.cls = DRIVER_CLASS_RX,
+	.instances = 1U,
+	.probe = NULL,
+	.interfaces = {&pwm_rx_driver}
+};
@@ -7,13 +7,7 @@
 
 #include <stddef.h>
 #include "rx/rx.h"
-#include "rx/protocols/pwm_rx.h"
-#include "common/settings.h"
-
-/**
-  * @brief  Rx Protocol Setting
-  */
-#define RX_PROTOCOL	CONFIG_RX_PROTOCOL
+#include "system/driver_registry.h"
 
 /**
   * @brief  rx driver pointer for protocol interface
@@ -42,13 +36,12 @@ static bool valid_rx_driver(const rx_protocol_interface_t *driver) {
   * @retval rx status
   */
 rx_status_t rx_init(void) {
-	/* NOTE: use pre-processor conditionals based
-	* on configured protocol to initialize rx_driver */
-	#if RX_PROTOCOL == RX_PWM_PROTOCOL_ID
-		rx_driver = &pwm_rx_driver;
-	#else
-		#error "Invalid Rx Protocol Configuration"
-	#endif
+	/* Bind the protocol detected on the receiver input (the one linked in
+	 * without a probe if none is) */
+	const driver_bus_t bus = {.handle = NULL, .address = 0U, .instance = 0U};
+	const driver_entry_t *entry = driver_bind(DRIVER_CLASS_RX, &bus);
+
+	rx_driver = entry ? entry->interfaces[0] : NULL;
 
 	if (!valid_rx_driver(rx_driver))
 		return RX_ERROR_FATAL;
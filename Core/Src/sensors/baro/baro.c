@@ -0,0 +1,128 @@
+/*
+ * baro.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include "sensors/baro/baro.h"
+#include "sensors/baro/devices/bmp3xx.h"
+#include "common/hardware.h"
+#include "common/settings.h"
+
+/*
+ * @brief  Baro Device Config Setting(s)
+ */
+#define BARO_DEVICE				CONFIG_BARO_DEVICE
+
+/*
+ * @brief  Baro Comm Protocol Config Settings
+ */
+#define BARO_COMM_PROTOCOL		CONFIG_BARO_COMM_PROTOCOL
+
+/*
+ * @brief  Baro Comm Peripheral(s) (shares the imu bus)
+ */
+#define BARO_I2C_PERIPHERAL		I2C1
+
+/**
+  * @brief  Baro Comm Peripheral Handle Pointers
+  */
+const I2C_HandleTypeDef* baro_phi2c = NULL;
+
+const void* baro_platform_handle = NULL;
+
+/**
+  * @brief  baro driver pointer for baro device interface
+  */
+static const baro_interface_t *baro_driver = NULL;
+
+
+/**
+  * @brief helper function to get the appropriate comm handle based on hardware config
+  *
+  * @param  i2c		pointer to i2c type handle
+  * @retval pointer to i2c handle type (NULL otherwise)
+  */
+static I2C_HandleTypeDef* Get_Baro_I2C_Handle(I2C_TypeDef* i2c) {
+	#if HI2C1 == CONFIGURED
+	if (i2c == I2C1)
+		return &hi2c1;
+	#endif
+
+	// add more as needed
+
+	return NULL;
+}
+
+/*
+ * @brief baro API call to init baro interface (protocol + device)
+ *
+ * @retval baro status type
+ */
+baro_status_t baro_init(void) {
+	const baro_interface_t *driver;
+	baro_status_t status;
+
+	baro_driver = NULL;
+
+	#if BARO_COMM_PROTOCOL == BARO_I2C_PROTOCOL_ID
+		baro_phi2c = Get_Baro_I2C_Handle(BARO_I2C_PERIPHERAL);
+		baro_platform_handle = baro_phi2c;
+	#else
+		#error "Invalid Baro Communication Protocol Configuration"
+	#endif
+
+	#if BARO_DEVICE == BMP3XX_DEVICE_ID
+		driver = &bmp3xx_driver;
+	#else
+		#error "Invalid Baro Device Configuration"
+	#endif
+
+	if (baro_platform_handle == NULL)
+		return BARO_ERROR_FATAL;
+
+	if (!valid_sensor_driver(driver))
+		return BARO_ERROR_FATAL;
+
+	/* Absent or failed device is reported once, here; reads then stay empty */
+	status = driver->init();
+	if (status == BARO_OK)
+		baro_driver = driver;
+
+	return status;
+}
+
+/*
+ * @brief baro API call to deinit baro interface (protocol + device)
+ *
+ * @retval baro status type
+ */
+baro_status_t baro_deinit(void) {
+	if (!baro_driver)
+		return BARO_ERROR_WARN;
+
+	baro_platform_handle = NULL;
+
+	baro_driver->deinit();
+	baro_driver = NULL;
+
+	return BARO_OK;
+}
+
+/*
+ * @brief baro API call to service the sensor (non-blocking; see baro.h)
+ * 		  NOTE: without an initialized device no sample is ever fresh, so the
+ * 		  altitude estimate stays invalid (the barometer is optional)
+ *
+ * @param  data		generic pointer to baro data handle
+ * @retval baro status type
+ */
+baro_status_t baro_read(void *data) {
+	if (!baro_driver) {
+		((baro_data_t*) data)->fresh = false;
+		return BARO_OK;
+	}
+
+	return baro_driver->read(data);
+}
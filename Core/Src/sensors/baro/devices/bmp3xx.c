@@ -0,0 +1,330 @@
+/*
+ * bmp3xx.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include "sensors/baro/devices/bmp3xx.h"
+#include "common/time.h"
+#include "common/settings.h"
+
+/*
+ * @brief  Conversion Config Settings
+ */
+#define BARO_RATE_HZ			CONFIG_BARO_RATE_HZ
+#define BARO_PRESS_OSR			CONFIG_BARO_PRESS_OSR
+
+#define BMP3XX_PERIOD_US		(1000000U / BARO_RATE_HZ)
+#define BMP3XX_TEMP_OSR			1U
+
+/*
+ * @brief  Oversampling Register Codes (log2 of the sample count)
+ */
+#define BMP3XX_OSR_CODE(n)		(((n) >= 32U) ? 5U : ((n) >= 16U) ? 4U : ((n) >= 8U) ? 3U : ((n) >= 4U) ? 2U : ((n) >= 2U) ? 1U : 0U)
+#define BMP3XX_OSR_VALUE		(BMP3XX_OSR_CODE(BARO_PRESS_OSR) | (BMP3XX_OSR_CODE(BMP3XX_TEMP_OSR) << 3))
+
+/*
+ * @brief  Maximum Conversion Time (datasheet: 234 + 392 + 163 us + 2020 us per sample)
+ */
+#define BMP3XX_CONV_US			(234U + (392U + BARO_PRESS_OSR * 2020U) + (163U + BMP3XX_TEMP_OSR * 2020U))
+
+_Static_assert(BMP3XX_CONV_US < BMP3XX_PERIOD_US, "baro conversion must finish within one period");
+
+/*
+ * @brief  Soft Reset Time (ms, init only)
+ */
+#define BMP3XX_RESET_MS			3U
+
+/*
+ * @brief  Baro Status Type Alias
+ */
+#define BMP3XX_OK				BARO_OK
+#define BMP3XX_ERROR_WARN		BARO_ERROR_WARN
+#define BMP3XX_ERROR_FATAL		BARO_ERROR_FATAL
+
+typedef baro_status_t bmp3xx_interface_status_t;
+
+/*
+ * @brief  Conversion State Type
+ */
+typedef enum {
+	BMP3XX_IDLE,				// waiting for the next period
+	BMP3XX_CONVERTING			// conversion triggered, result pending
+} bmp3xx_state_t;
+
+/*
+ * @brief  Device State
+ */
+static bmp3xx_calib_t calib;
+static bmp3xx_state_t state;
+static uint64_t next_us;		// next conversion trigger
+static uint64_t ready_us;		// pending conversion complete
+
+/*
+ * @brief  Bus Override (NULL: platform bus)
+ */
+static const bmp3xx_bus_t *bus_override = NULL;
+
+
+/*
+ * @brief  Write device register (platform dependent)
+ *
+ * @param  reg       register to write
+ * @param  bufp      pointer to data to write in register reg
+ * @param  len       number of consecutive register to write
+ *
+ * @retval 0 on success
+ */
+static int32_t platform_write(uint8_t reg, const uint8_t *bufp, uint16_t len) {
+	if (bus_override)
+		return bus_override->write(reg, bufp, len);
+
+	if (baro_platform_handle == baro_phi2c)
+		return (int32_t) HAL_I2C_Mem_Write((I2C_HandleTypeDef*) baro_phi2c, BMP3XX_I2C_ADD, reg, I2C_MEMADD_SIZE_8BIT,
+										   (uint8_t*) bufp, len, 10);
+
+	return -1;
+}
+
+/*
+ * @brief  Read device register (platform dependent)
+ *
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of consecutive register to read
+ *
+ * @retval 0 on success
+ */
+static int32_t platform_read(uint8_t reg, uint8_t *bufp, uint16_t len) {
+	if (bus_override)
+		return bus_override->read(reg, bufp, len);
+
+	if (baro_platform_handle == baro_phi2c)
+		return (int32_t) HAL_I2C_Mem_Read((I2C_HandleTypeDef*) baro_phi2c, BMP3XX_I2C_ADD, reg, I2C_MEMADD_SIZE_8BIT,
+										  bufp, len, 10);
+
+	return -1;
+}
+
+/*
+ * @brief  Write a single device register
+ *
+ * @retval 0 on success
+ */
+static inline int32_t write_reg(uint8_t reg, uint8_t value) {
+	return platform_write(reg, &value, 1U);
+}
+
+/**
+  * @brief unpacks the NVM calibration block (BMP3XX_REG_CALIB onwards)
+  *
+  * @param  nvm		read-only calibration bytes
+  * @param	cal		calibration coefficients to be filled
+  *
+  * @retval None
+  */
+void bmp3xx_parse_calib(const uint8_t nvm[BMP3XX_CALIB_SIZE], bmp3xx_calib_t *cal) {
+	cal->t1 = (uint16_t)(nvm[0] | (nvm[1] << 8));
+	cal->t2 = (uint16_t)(nvm[2] | (nvm[3] << 8));
+	cal->t3 = (int8_t) nvm[4];
+	cal->p1 = (int16_t)(nvm[5] | (nvm[6] << 8));
+	cal->p2 = (int16_t)(nvm[7] | (nvm[8] << 8));
+	cal->p3 = (int8_t) nvm[9];
+	cal->p4 = (int8_t) nvm[10];
+	cal->p5 = (uint16_t)(nvm[11] | (nvm[12] << 8));
+	cal->p6 = (uint16_t)(nvm[13] | (nvm[14] << 8));
+	cal->p7 = (int8_t) nvm[15];
+	cal->p8 = (int8_t) nvm[16];
+	cal->p9 = (int16_t)(nvm[17] | (nvm[18] << 8));
+	cal->p10 = (int8_t) nvm[19];
+	cal->p11 = (int8_t) nvm[20];
+}
+
+/**
+  * @brief compensates raw conversion results (Bosch fixed-point variant: the
+  * 	   datasheet polynomials with each coefficient scaled to an integer, so
+  * 	   t_lin carries 16 fractional bits and pressure 42 before the final scale)
+  *
+  * @param  cal			read-only calibration coefficients
+  * @param	raw_press	24-bit pressure conversion
+  * @param	raw_temp	24-bit temperature conversion
+  * @param	out			sample to be filled (pressure and temperature only)
+  *
+  * @retval None
+  */
+void bmp3xx_compensate(const bmp3xx_calib_t *cal, uint32_t raw_press, uint32_t raw_temp, baro_data_t *out) {
+	int64_t pd1, pd2, pd3, pd4, pd5, pd6, t_lin, offset, sensitivity;
+	int64_t up = (int64_t) raw_press;
+
+	/* Linearized temperature (degC * 2^16) */
+	pd1 = (int64_t) raw_temp - ((int64_t) 256 * cal->t1);
+	pd2 = (int64_t) cal->t2 * pd1;
+	pd3 = pd1 * pd1;
+	pd4 = pd3 * cal->t3;
+	pd5 = (pd2 * 262144) + pd4;
+	t_lin = pd5 / 4294967296;
+
+	out->temperature_cdeg = (int32_t)((t_lin * 25) / 16384);
+
+	/* Offset (Pa * 2^44) */
+	pd1 = t_lin * t_lin;
+	pd2 = pd1 / 64;
+	pd3 = (pd2 * t_lin) / 256;
+	pd4 = (cal->p8 * pd3) / 32;
+	pd5 = (cal->p7 * pd1) * 16;
+	pd6 = (cal->p6 * t_lin) * 4194304;
+	offset = ((int64_t) cal->p5 * 140737488355328) + pd4 + pd5 + pd6;
+
+	/* Sensitivity (2^66) */
+	pd2 = (cal->p4 * pd3) / 32;
+	pd4 = (cal->p3 * pd1) * 4;
+	pd5 = ((int64_t) cal->p2 - 16384) * t_lin * 2097152;
+	sensitivity = (((int64_t) cal->p1 - 16384) * 70368744177664) + pd2 + pd4 + pd5;
+
+	/* Pressure (Pa * 2^42): offset + linear, quadratic and cubic terms */
+	pd1 = (sensitivity / 16777216) * up;
+	pd2 = cal->p10 * t_lin;
+	pd3 = pd2 + ((int64_t) 65536 * cal->p9);
+	pd4 = (pd3 * up) / 8192;
+	pd5 = ((up * (pd4 / 10)) / 512) * 10;		// pre-scaled by 10 to stay within 64 bits
+	pd6 = up * up;
+	pd2 = (cal->p11 * pd6) / 65536;
+	pd3 = (pd2 * up) / 128;
+	pd4 = (offset / 4) + pd1 + pd5 + pd3;
+
+	out->pressure_cpa = (uint32_t)(((uint64_t) pd4 * 25) / 1099511627776);
+}
+
+/**
+  * @brief gets worst-case conversion time of the configured oversampling
+  *
+  * @retval conversion time (us)
+  */
+uint32_t bmp3xx_conversion_time_us(void) {
+	return BMP3XX_CONV_US;
+}
+
+/**
+  * @brief bmp3xx configuration & setup (the only place the driver waits)
+  *
+  * @retval bmp3xx status type
+  */
+static bmp3xx_interface_status_t bmp3xx_init(void) {
+	uint8_t id;
+	uint8_t nvm[BMP3XX_CALIB_SIZE];
+
+	/* Check device ID */
+	if ((platform_read(BMP3XX_REG_CHIP_ID, &id, 1U) != 0) || ((id != BMP388_CHIP_ID) && (id != BMP390_CHIP_ID)))
+		return BMP3XX_ERROR_FATAL;
+
+	/* Restore default configuration (sleep mode) */
+	if (write_reg(BMP3XX_REG_CMD, BMP3XX_CMD_SOFT_RESET) != 0)
+		return BMP3XX_ERROR_FATAL;
+	HAL_Delay(BMP3XX_RESET_MS);
+
+	/* Read calibration coefficients */
+	if (platform_read(BMP3XX_REG_CALIB, nvm, BMP3XX_CALIB_SIZE) != 0)
+		return BMP3XX_ERROR_FATAL;
+	bmp3xx_parse_calib(nvm, &calib);
+
+	/* Set oversampling; IIR filter off (the altitude estimator filters) */
+	if ((write_reg(BMP3XX_REG_OSR, BMP3XX_OSR_VALUE) != 0) || (write_reg(BMP3XX_REG_CONFIG, 0x00U) != 0))
+		return BMP3XX_ERROR_FATAL;
+
+	state = BMP3XX_IDLE;
+	next_us = micros();
+
+	return BMP3XX_OK;
+}
+
+/**
+  * @brief bmp3xx deinit
+  *
+  * @retval bmp3xx status type
+  */
+static bmp3xx_interface_status_t bmp3xx_deinit(void) {
+	/* Restore default configuration */
+	(void) write_reg(BMP3XX_REG_CMD, BMP3XX_CMD_SOFT_RESET);
+
+	state = BMP3XX_IDLE;
+
+	return BMP3XX_OK;
+}
+
+/*
+ * @brief	services the conversion schedule: triggers a forced conversion each
+ * 			period and fetches it once converted (one bus transaction at most)
+ *
+ * @param	data	generic sensor handle pointer to store updated measurements
+ * @retval	bmp3xx status type
+ */
+static bmp3xx_interface_status_t bmp3xx_read(void *data) {
+	baro_data_t *baro = (baro_data_t*) data;
+	uint8_t buf[BMP3XX_DATA_SIZE];
+	uint64_t now = micros();
+
+	baro->fresh = false;
+
+	if (state == BMP3XX_CONVERTING) {
+		if (now < ready_us)
+			return BMP3XX_OK;
+
+		if (platform_read(BMP3XX_REG_STATUS, buf, BMP3XX_DATA_SIZE) != 0) {
+			state = BMP3XX_IDLE;
+			return BMP3XX_ERROR_WARN;
+		}
+
+		/* Not converted yet: retry next loop, give up after one more period */
+		if ((buf[0] & (BMP3XX_STATUS_DRDY_PRESS | BMP3XX_STATUS_DRDY_TEMP)) != (BMP3XX_STATUS_DRDY_PRESS | BMP3XX_STATUS_DRDY_TEMP)) {
+			if ((now - ready_us) < BMP3XX_PERIOD_US)
+				return BMP3XX_OK;
+
+			state = BMP3XX_IDLE;
+			return BMP3XX_ERROR_WARN;
+		}
+
+		bmp3xx_compensate(&calib, (uint32_t) buf[1] | ((uint32_t) buf[2] << 8) | ((uint32_t) buf[3] << 16),
+								  (uint32_t) buf[4] | ((uint32_t) buf[5] << 8) | ((uint32_t) buf[6] << 16), baro);
+		baro->fresh = true;
+		state = BMP3XX_IDLE;
+
+		return BMP3XX_OK;
+	}
+
+	/* Trigger on the first loop of each period (no burst after a stall) */
+	if (now >= next_us) {
+		next_us += BMP3XX_PERIOD_US;
+		if (next_us <= now)
+			next_us = now + BMP3XX_PERIOD_US;
+
+		if (write_reg(BMP3XX_REG_PWR_CTRL, BMP3XX_PWR_CTRL_FORCED) != 0)
+			return BMP3XX_ERROR_WARN;
+
+		ready_us = now + BMP3XX_CONV_US;
+		state = BMP3XX_CONVERTING;
+	}
+
+	return BMP3XX_OK;
+}
+
+/**
+  * @brief routes register access to a bus override instead of the platform
+  * 	   bus (pass NULL to restore it)
+  * 	   NOTE: not while the flight loop reads the barometer
+  *
+  * @param  bus		read-only pointer to bus override
+  * @retval None
+  */
+void bmp3xx_set_bus(const bmp3xx_bus_t *bus) {
+	bus_override = bus;
+}
+
+/*
+ * @brief  BMP3xx Baro Interface Driver
+ */
+const baro_interface_t bmp3xx_driver = {
+	.init = bmp3xx_init,
+	.deinit = bmp3xx_deinit,
+	.read = bmp3xx_read
+};
@@ -0,0 +1,182 @@
+/*
+ * battery.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "sensors/battery/battery.h"
+#include "params/params.h"
+#include "common/memory.h"
+#include "common/time.h"
+#include "common/settings.h"
+
+/*
+ * @brief  Battery Device Config Setting(s)
+ */
+#define BATTERY_DEVICE			CONFIG_BATTERY_DEVICE
+#define BATTERY_PERIOD_MS		CONFIG_BATT_PERIOD_MS
+
+#if BATTERY_DEVICE == ADC_BATTERY_DEVICE_ID
+	#include "sensors/battery/devices/adc_battery.h"
+#elif BATTERY_DEVICE == BATTERY_SIM_DEVICE_ID
+	#include "sensors/battery/devices/sim_battery.h"
+#endif
+
+/**
+  * @brief  battery driver pointer for battery device interface
+  */
+static const battery_interface_t *battery_driver = NULL;
+
+/**
+  * @brief  Runtime Parameter Cache (refreshed on change notification)
+  */
+static battery_scaling_t scaling CCM_BSS;
+
+/**
+  * @brief  Monitor State
+  */
+static battery_monitor_t monitor CCM_BSS;
+static uint32_t next_update_ms CCM_BSS;
+static uint32_t last_update_ms CCM_BSS;
+
+
+/**
+  * @brief helper function to refresh the cached scaling (and the cell count
+  * 	   when it changed)
+  *
+  * @retval None
+  */
+static void load_battery_params(void) {
+	uint8_t cells = (uint8_t) params_get_u32(PARAM_BATT_CELLS);
+
+	scaling.volt_scale = params_get_float(PARAM_BATT_VOLT_SCALE);
+	scaling.curr_scale = params_get_float(PARAM_BATT_CURR_SCALE);
+	scaling.curr_offset_v = params_get_float(PARAM_BATT_CURR_OFFSET_V);
+
+	if (cells != monitor.cfg.cells)
+		battery_monitor_set_cells(&monitor, cells);
+}
+
+/**
+  * @brief parameter change listener
+  *
+  * @param  id		changed parameter id
+  * @retval None
+  */
+static void on_param_change(param_id_t id) {
+	(void) id;
+	load_battery_params();
+}
+
+/*
+ * @brief battery API call to init battery interface (device starts sampling;
+ * 		  scaling and cell count from the parameters)
+ *
+ * @retval battery status type
+ */
+battery_status_t battery_init(void) {
+	const battery_monitor_config_t cfg = {
+		.cells = (uint8_t) params_get_u32(PARAM_BATT_CELLS),
+		.cell_max_v = CONFIG_BATT_CELL_MAX_V,
+		.present_min_v = CONFIG_BATT_PRESENT_MIN_V,
+		.detect_ms = CONFIG_BATT_DETECT_MS,
+		.sag_tau_s = CONFIG_BATT_SAG_TAU_S,
+		.res_tau_s = CONFIG_BATT_RES_TAU_S
+	};
+	const battery_interface_t *driver;
+	battery_status_t status;
+
+	battery_driver = NULL;
+	battery_monitor_init(&monitor, &cfg);
+
+	load_battery_params();
+	params_subscribe(PARAM_GROUP_BATTERY, on_param_change);
+
+	#if BATTERY_DEVICE == ADC_BATTERY_DEVICE_ID
+		driver = &adc_battery_driver;
+	#elif BATTERY_DEVICE == BATTERY_SIM_DEVICE_ID
+		driver = &sim_battery_driver;
+	#else
+		#error "Invalid Battery Device Configuration"
+	#endif
+
+	if (!valid_sensor_driver(driver))
+		return BATTERY_ERROR_FATAL;
+
+	status = driver->init();
+	if (status == BATTERY_OK) {
+		battery_driver = driver;
+		next_update_ms = millis();
+		last_update_ms = next_update_ms;
+	}
+
+	return status;
+}
+
+/*
+ * @brief battery API call to deinit battery interface
+ *
+ * @retval battery status type
+ */
+battery_status_t battery_deinit(void) {
+	if (!battery_driver)
+		return BATTERY_ERROR_WARN;
+
+	battery_driver->deinit();
+	battery_driver = NULL;
+
+	return BATTERY_OK;
+}
+
+/*
+ * @brief battery API call to get the battery state (no waiting; the monitor
+ * 		  runs every CONFIG_BATT_PERIOD_MS, see battery.h)
+ * 		  NOTE: without an initialized device the state stays empty (not
+ * 		  present)
+ *
+ * @param  data		generic pointer to battery data handle
+ * @retval battery status type
+ */
+battery_status_t battery_read(void *data) {
+	battery_data_t *batt = (battery_data_t*) data;
+	battery_data_t sample;
+	battery_status_t status;
+	uint32_t now = millis();
+	uint32_t elapsed_ms;
+
+	if (!battery_driver) {
+		memset(batt, 0, sizeof(*batt));
+		return BATTERY_OK;
+	}
+
+	if ((int32_t) (now - next_update_ms) < 0) {
+		*batt = monitor.state;
+		return BATTERY_OK;
+	}
+
+	/* Fixed cadence; restarted from now if the loop fell a period behind */
+	next_update_ms += BATTERY_PERIOD_MS;
+	if ((int32_t) (now - next_update_ms) >= 0)
+		next_update_ms = now + BATTERY_PERIOD_MS;
+
+	elapsed_ms = now - last_update_ms;
+	last_update_ms = now;
+	status = battery_driver->read(&sample);
+	if (status == BATTERY_OK)
+		battery_monitor_update(&monitor, sample.voltage_v, sample.current_a, (float) elapsed_ms * 1e-3f);
+
+	*batt = monitor.state;
+
+	return status;
+}
+
+/**
+  * @brief gets the scaling from device pin volts (for the device drivers)
+  *
+  * @retval read-only pointer to scaling
+  */
+const battery_scaling_t *battery_get_scaling(void) {
+	return &scaling;
+}
@@ -0,0 +1,146 @@
+/*
+ * battery_monitor.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <string.h>
+#include "sensors/battery/battery_monitor.h"
+#include "common/maths.h"
+
+/*
+ * @brief  Unit Conversions
+ */
+#define AS_PER_MAH				3.6f
+#define S_PER_H					3600.0f
+
+
+/**
+  * @brief init a battery monitor (no pack seen yet)
+  *
+  * @param  m		pointer to battery monitor
+  * @param	cfg		read-only pointer to config
+  *
+  * @retval None
+  */
+void battery_monitor_init(battery_monitor_t *m, const battery_monitor_config_t *cfg) {
+	memset(m, 0, sizeof(*m));
+	m->cfg = *cfg;
+	m->state.cells = cfg->cells;
+}
+
+/**
+  * @brief sets the cell count (0: detect again)
+  *
+  * @param  m		pointer to battery monitor
+  * @param	cells	cell count
+  *
+  * @retval None
+  */
+void battery_monitor_set_cells(battery_monitor_t *m, uint8_t cells) {
+	m->cfg.cells = cells;
+	m->state.cells = cells;
+	m->present_ms = 0U;
+}
+
+/**
+  * @brief helper function to update the resistance estimate: regression of
+  * 	   the high-passed voltage on the high-passed current
+  *
+  * @retval None
+  */
+static void update_resistance(battery_monitor_t *m, float voltage_v, float current_a, float dt_s) {
+	float hp = dt_s / (BATT_RES_HP_TAU_S + dt_s);
+	float avg = dt_s / (m->cfg.res_tau_s + dt_s);
+	float v, i;
+
+	m->v_hp_lpf += hp * (voltage_v - m->v_hp_lpf);
+	m->i_hp_lpf += hp * (current_a - m->i_hp_lpf);
+	v = voltage_v - m->v_hp_lpf;
+	i = current_a - m->i_hp_lpf;
+
+	m->var_i += avg * (i * i - m->var_i);
+	m->cov_vi += avg * (v * i - m->cov_vi);
+
+	/* Needs current changes to see the sag; kept while hovering steadily */
+	if (m->var_i > BATT_RES_MIN_EXCITATION_A2)
+		m->resistance_ohm = constrainf(-m->cov_vi / m->var_i, 0.0f, BATT_RES_MAX_OHM);
+}
+
+/**
+  * @brief helper function to detect the cell count once the pack settled
+  *
+  * @retval None
+  */
+static void detect_cells(battery_monitor_t *m, float dt_s) {
+	battery_state_t *s = &m->state;
+
+	if (!s->present) {
+		m->present_ms = 0U;
+		if (m->cfg.cells == 0U)
+			s->cells = 0U;
+		return;
+	}
+
+	if (s->cells != 0U)
+		return;
+
+	m->present_ms += (uint32_t) (dt_s * 1000.0f + 0.5f);
+	if (m->present_ms >= m->cfg.detect_ms)
+		s->cells = (uint8_t) ceilf(m->rest_v / m->cfg.cell_max_v);
+}
+
+/**
+  * @brief updates the battery state with one sample
+  *
+  * @param  m			pointer to battery monitor
+  * @param	voltage_v	pack voltage
+  * @param	current_a	pack current (discharge positive)
+  * @param	dt_s		time since the last sample
+  *
+  * @retval None
+  */
+void battery_monitor_update(battery_monitor_t *m, float voltage_v, float current_a, float dt_s) {
+	battery_state_t *s = &m->state;
+
+	if (dt_s > BATT_DT_MAX_S)
+		dt_s = BATT_DT_MAX_S;
+
+	if (!m->started) {
+		m->v_hp_lpf = voltage_v;
+		m->i_hp_lpf = current_a;
+		m->rest_v = voltage_v;
+		m->prev_current_a = current_a;
+		m->started = true;
+		dt_s = 0.0f;
+	}
+
+	s->voltage_v = voltage_v;
+	s->current_a = current_a;
+
+	/* Pack plugged in: filters restart from its voltage */
+	if ((voltage_v >= m->cfg.present_min_v) && !s->present) {
+		m->v_hp_lpf = voltage_v;
+		m->rest_v = voltage_v;
+	}
+	s->present = voltage_v >= m->cfg.present_min_v;
+
+	/* Consumed charge and energy */
+	s->consumed_mah += 0.5f * (current_a + m->prev_current_a) * dt_s / AS_PER_MAH;
+	s->energy_wh += voltage_v * current_a * dt_s / S_PER_H;
+	m->prev_current_a = current_a;
+
+	/* Sag: resting voltage from the estimated resistance */
+	if (dt_s > 0.0f) {
+		update_resistance(m, voltage_v, current_a, dt_s);
+		m->rest_v += (dt_s / (m->cfg.sag_tau_s + dt_s)) * (voltage_v + current_a * m->resistance_ohm - m->rest_v);
+	}
+
+	detect_cells(m, dt_s);
+
+	s->rest_voltage_v = m->rest_v;
+	s->resistance_mohm = m->resistance_ohm * 1000.0f;
+	s->cell_voltage_v = (s->cells != 0U) ? (m->rest_v / (float) s->cells) : 0.0f;
+}
@@ -0,0 +1,154 @@
+/*
+ * adc_battery.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include "stm32f4xx_hal.h"
+#include "sensors/battery/devices/adc_battery.h"
+#include "common/settings.h"
+
+/*
+ * @brief  ADC Reference Config Setting
+ */
+#define ADC_VREF_V				CONFIG_BATT_ADC_VREF_V
+
+/**
+  * @brief  Battery Peripherals (ADC1 IN14 / IN15 on PC4 / PC5, DMA2 stream 0 channel 0)
+  */
+#define BATT_ADC				ADC1
+#define BATT_GPIO_PORT			GPIOC
+#define BATT_VOLT_PIN			GPIO_PIN_4
+#define BATT_CURR_PIN			GPIO_PIN_5
+#define BATT_VOLT_CHANNEL		14U
+#define BATT_CURR_CHANNEL		15U
+#define BATT_DMA_STREAM			DMA2_Stream0
+#define BATT_DMA_CHANNEL		0U						// channel 0
+#define BATT_DMA_FLAGS			(DMA_LIFCR_CFEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CTEIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTCIF0)
+
+/**
+  * @brief  Conversion Timing (pclk2 84 MHz / 4, 480 cycle sampling on both channels)
+  */
+#define BATT_ADC_PRESCALER		ADC_CCR_ADCPRE_0		// pclk2 / 4
+#define BATT_ADC_SMP_480		0x7U
+#define BATT_ADC_SCAN_LEN		2U
+
+/**
+  * @brief  Sample Ring (written by the dma; not in ccm, which the dma cannot reach)
+  */
+static volatile uint16_t ring[ADC_BATTERY_RING_SCANS * BATT_ADC_SCAN_LEN];
+static bool running;
+
+
+/**
+  * @brief inits the adc and starts continuous scanning into the ring
+  *
+  * @retval battery status
+  */
+static battery_status_t adc_battery_init(void) {
+	GPIO_InitTypeDef gpio = {0};
+
+	running = false;
+
+	__HAL_RCC_GPIOC_CLK_ENABLE();
+	__HAL_RCC_ADC1_CLK_ENABLE();
+	__HAL_RCC_DMA2_CLK_ENABLE();
+
+	gpio.Pin = BATT_VOLT_PIN | BATT_CURR_PIN;
+	gpio.Mode = GPIO_MODE_ANALOG;
+	gpio.Pull = GPIO_NOPULL;
+	HAL_GPIO_Init(BATT_GPIO_PORT, &gpio);
+
+	/* Scan IN14, IN15 continuously; the dma keeps requesting (circular) */
+	BATT_ADC->CR2 = 0U;
+	ADC->CCR = (ADC->CCR & ~ADC_CCR_ADCPRE) | BATT_ADC_PRESCALER;
+	BATT_ADC->CR1 = ADC_CR1_SCAN;
+	BATT_ADC->SMPR1 = (BATT_ADC_SMP_480 << ADC_SMPR1_SMP14_Pos) | (BATT_ADC_SMP_480 << ADC_SMPR1_SMP15_Pos);
+	BATT_ADC->SQR1 = (BATT_ADC_SCAN_LEN - 1U) << ADC_SQR1_L_Pos;
+	BATT_ADC->SQR2 = 0U;
+	BATT_ADC->SQR3 = (BATT_VOLT_CHANNEL << ADC_SQR3_SQ1_Pos) | (BATT_CURR_CHANNEL << ADC_SQR3_SQ2_Pos);
+
+	BATT_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+	while (BATT_DMA_STREAM->CR & DMA_SxCR_EN);
+	DMA2->LIFCR = BATT_DMA_FLAGS;
+
+	BATT_DMA_STREAM->PAR = (uint32_t) &BATT_ADC->DR;
+	BATT_DMA_STREAM->M0AR = (uint32_t) ring;
+	BATT_DMA_STREAM->NDTR = ADC_BATTERY_RING_SCANS * BATT_ADC_SCAN_LEN;
+	BATT_DMA_STREAM->FCR = 0U;		// direct mode
+	BATT_DMA_STREAM->CR = (BATT_DMA_CHANNEL << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_PL_0 | DMA_SxCR_MSIZE_0 |
+						  DMA_SxCR_PSIZE_0 | DMA_SxCR_MINC | DMA_SxCR_CIRC;
+	BATT_DMA_STREAM->CR |= DMA_SxCR_EN;
+
+	BATT_ADC->CR2 = ADC_CR2_ADON | ADC_CR2_CONT | ADC_CR2_DMA | ADC_CR2_DDS;
+	HAL_Delay(1U);					// adc power up (t_stab: 3 us)
+	BATT_ADC->CR2 |= ADC_CR2_SWSTART;
+
+	running = true;
+
+	return BATTERY_OK;
+}
+
+/**
+  * @brief stops scanning
+  *
+  * @retval battery status
+  */
+static battery_status_t adc_battery_deinit(void) {
+	if (!running)
+		return BATTERY_ERROR_WARN;
+
+	BATT_ADC->CR2 = 0U;
+	BATT_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+	running = false;
+
+	return BATTERY_OK;
+}
+
+/**
+  * @brief averages the ring (see adc_battery.h) and scales it to pack volts
+  * 	   and amps
+  * 	   NOTE: an overrun stops the adc's dma requests; it is restarted here
+  * 	   and the read reported as a warning
+  *
+  * @param  data	pointer to battery data handle (voltage and current filled)
+  * @retval battery status
+  */
+static battery_status_t adc_battery_read(void *data) {
+	battery_data_t *batt = (battery_data_t*) data;
+	const battery_scaling_t *scaling = battery_get_scaling();
+	uint32_t sum_v = 0U, sum_i = 0U;
+	float pin_v, pin_i;
+
+	if (BATT_ADC->SR & ADC_SR_OVR) {
+		BATT_ADC->SR &= ~ADC_SR_OVR;
+		BATT_ADC->CR2 &= ~ADC_CR2_DMA;
+		BATT_ADC->CR2 |= ADC_CR2_DMA;
+		BATT_ADC->CR2 |= ADC_CR2_SWSTART;
+		return BATTERY_ERROR_WARN;
+	}
+
+	/* The dma keeps writing meanwhile; a mix of old and new scans averages the same */
+	for (uint32_t i = 0; i < ADC_BATTERY_RING_SCANS; ++i) {
+		sum_v += ring[i * BATT_ADC_SCAN_LEN];
+		sum_i += ring[i * BATT_ADC_SCAN_LEN + 1U];
+	}
+
+	pin_v = ((float) sum_v / ADC_BATTERY_RING_SCANS) * (ADC_VREF_V / ADC_BATTERY_FULL_SCALE);
+	pin_i = ((float) sum_i / ADC_BATTERY_RING_SCANS) * (ADC_VREF_V / ADC_BATTERY_FULL_SCALE);
+
+	batt->voltage_v = pin_v * scaling->volt_scale;
+	batt->current_a = (pin_i - scaling->curr_offset_v) * scaling->curr_scale;
+
+	return BATTERY_OK;
+}
+
+/**
+  * @brief adc battery driver initialization
+  */
+const battery_interface_t adc_battery_driver = {
+	.init = adc_battery_init,
+	.deinit = adc_battery_deinit,
+	.read = adc_battery_read
+};
@@ -0,0 +1,304 @@
+/*
+ * gps.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include "sensors/gps/gps.h"
+#include "sensors/gps/gps_parser.h"
+#include "common/time.h"
+#include "common/settings.h"
+
+/*
+ * Register-level driver: the HAL uart module is not part of this project.
+ */
+
+/**
+  * @brief  GPS Config Settings
+  */
+#define GPS_DEVICE				CONFIG_GPS_DEVICE
+#define GPS_BAUD				CONFIG_GPS_BAUD
+#define GPS_RATE_HZ				CONFIG_GPS_RATE_HZ
+
+/**
+  * @brief  GPS Peripherals (USART1 on PA9 / PA10, rx on DMA2 stream 2 channel 4)
+  */
+#define GPS_USART				USART1
+#define GPS_GPIO_PORT			GPIOA
+#define GPS_TX_PIN				GPIO_PIN_9
+#define GPS_RX_PIN				GPIO_PIN_10
+#define GPS_DMA_STREAM			DMA2_Stream2
+#define GPS_DMA_CHANNEL			DMA_SxCR_CHSEL_2		// channel 4
+#define GPS_DMA_FLAGS			(DMA_LIFCR_CFEIF2 | DMA_LIFCR_CDMEIF2 | DMA_LIFCR_CTEIF2 | DMA_LIFCR_CHTIF2 | DMA_LIFCR_CTCIF2)
+
+/**
+  * @brief  Receive Ring (~89 ms of data at 115200 baud; must not be in CCM)
+  */
+#define GPS_RX_RING_SIZE		1024U
+#define GPS_RX_RING_US			((uint64_t) GPS_RX_RING_SIZE * 10U * 1000000U / GPS_BAUD)
+
+/**
+  * @brief  u-blox Setup
+  */
+#define UBLOX_DEFAULT_BAUD		9600U
+#define UBLOX_PORT_UART1		0x01U
+#define UBLOX_MODE_8N1			0x000008D0U
+#define UBLOX_PROTO_UBX			0x0001U
+#define UBLOX_PROTO_NMEA		0x0002U
+#define UBLOX_TIME_REF_GPS		0x0001U
+#define UBLOX_SWITCH_MS			20U			// receiver applies a new baud rate after replying
+#define GPS_TX_TIMEOUT_MS		100U
+
+/**
+  * @brief  GPS State
+  */
+static uint8_t rx_ring[GPS_RX_RING_SIZE];
+static uint32_t rx_tail;
+static uint64_t last_read_us;
+static gps_parser_t parser;
+static uint32_t overruns;
+static bool running;
+
+
+/**
+  * @brief helper function to set the uart baud rate (16x oversampling)
+  *
+  * @param  baud	baud rate
+  * @retval None
+  */
+static void set_baud(uint32_t baud) {
+	uint32_t pclk = HAL_RCC_GetPCLK2Freq();
+
+	GPS_USART->CR1 &= ~USART_CR1_UE;
+	GPS_USART->BRR = (pclk + baud / 2U) / baud;
+	GPS_USART->CR1 |= USART_CR1_UE;
+}
+
+/**
+  * @brief helper function to transmit bytes (polled; init only)
+  *
+  * @param  buf		read-only pointer to bytes
+  * @param	len		number of bytes
+  *
+  * @retval boolean (false on timeout)
+  */
+static bool transmit(const uint8_t *buf, uint32_t len) {
+	uint32_t start = millis();
+
+	for (uint32_t i = 0; i < len; ++i) {
+		while (!(GPS_USART->SR & USART_SR_TXE)) {
+			if ((millis() - start) > GPS_TX_TIMEOUT_MS)
+				return false;
+		}
+		GPS_USART->DR = buf[i];
+	}
+
+	while (!(GPS_USART->SR & USART_SR_TC)) {
+		if ((millis() - start) > GPS_TX_TIMEOUT_MS)
+			return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief helper function to send a ubx message
+  *
+  * @retval boolean
+  */
+static bool send_ubx(uint8_t msg_class, uint8_t msg_id, const uint8_t *payload, uint16_t len) {
+	uint8_t frame[32];
+
+	return transmit(frame, ubx_frame(msg_class, msg_id, payload, len, frame));
+}
+
+/**
+  * @brief helper function to build a CFG-PRT payload for uart1 (8N1, ubx and
+  * 	   nmea in, ubx out)
+  *
+  * @param  baud	baud rate
+  * @param	out		payload buffer (20 bytes)
+  *
+  * @retval None
+  */
+static void cfg_prt_payload(uint32_t baud, uint8_t out[20]) {
+	memset(out, 0, 20U);
+	out[0] = UBLOX_PORT_UART1;
+	out[4] = (uint8_t) UBLOX_MODE_8N1;
+	out[5] = (uint8_t) (UBLOX_MODE_8N1 >> 8);
+	out[8] = (uint8_t) baud;
+	out[9] = (uint8_t) (baud >> 8);
+	out[10] = (uint8_t) (baud >> 16);
+	out[11] = (uint8_t) (baud >> 24);
+	out[12] = (uint8_t) (UBLOX_PROTO_UBX | UBLOX_PROTO_NMEA);
+	out[14] = (uint8_t) UBLOX_PROTO_UBX;
+}
+
+/**
+  * @brief helper function to configure a u-blox receiver: baud rate (from the
+  * 	   factory default or already set), NAV-PVT only at GPS_RATE_HZ
+  * 	   NOTE: not persisted on the receiver, so this runs on every boot
+  *
+  * @retval boolean (false if a transmission timed out)
+  */
+static bool configure_ublox(void) {
+	const uint16_t meas_ms = 1000U / GPS_RATE_HZ;
+	const uint8_t rate[6] = {(uint8_t) meas_ms, (uint8_t) (meas_ms >> 8), 0x01U, 0x00U,
+							 (uint8_t) UBLOX_TIME_REF_GPS, (uint8_t) (UBLOX_TIME_REF_GPS >> 8)};
+	const uint8_t msg[3] = {UBX_CLASS_NAV, UBX_ID_NAV_PVT, 0x01U};
+	uint8_t prt[20];
+	bool ok;
+
+	cfg_prt_payload(GPS_BAUD, prt);
+
+	/* Switch from the factory default, then again at the target rate (already switched) */
+	set_baud(UBLOX_DEFAULT_BAUD);
+	ok = send_ubx(UBX_CLASS_CFG, UBX_ID_CFG_PRT, prt, sizeof(prt));
+	delay_ms(UBLOX_SWITCH_MS);
+
+	set_baud(GPS_BAUD);
+	ok &= send_ubx(UBX_CLASS_CFG, UBX_ID_CFG_PRT, prt, sizeof(prt));
+	delay_ms(UBLOX_SWITCH_MS);
+
+	ok &= send_ubx(UBX_CLASS_CFG, UBX_ID_CFG_RATE, rate, sizeof(rate));
+	ok &= send_ubx(UBX_CLASS_CFG, UBX_ID_CFG_MSG, msg, sizeof(msg));
+
+	return ok;
+}
+
+/**
+  * @brief helper function to get the dma write index into the receive ring
+  *
+  * @retval ring index
+  */
+static inline uint32_t rx_head(void) {
+	return (GPS_RX_RING_SIZE - GPS_DMA_STREAM->NDTR) % GPS_RX_RING_SIZE;
+}
+
+/*
+ * @brief gps API call to init the uart, configure the receiver and start
+ * 		  circular dma reception
+ *
+ * @retval gps status type (WARN if the receiver could not be configured)
+ */
+gps_status_t gps_init(void) {
+	GPIO_InitTypeDef gpio = {0};
+	gps_status_t status = GPS_OK;
+
+	running = false;
+	overruns = 0U;
+	gps_parser_init(&parser);
+
+	__HAL_RCC_GPIOA_CLK_ENABLE();
+	__HAL_RCC_USART1_CLK_ENABLE();
+	__HAL_RCC_DMA2_CLK_ENABLE();
+
+	gpio.Pin = GPS_TX_PIN | GPS_RX_PIN;
+	gpio.Mode = GPIO_MODE_AF_PP;
+	gpio.Pull = GPIO_PULLUP;
+	gpio.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+	gpio.Alternate = GPIO_AF7_USART1;
+	HAL_GPIO_Init(GPS_GPIO_PORT, &gpio);
+
+	GPS_USART->CR1 = USART_CR1_TE | USART_CR1_RE;
+	GPS_USART->CR2 = 0U;
+	GPS_USART->CR3 = 0U;
+	set_baud(GPS_BAUD);
+
+	#if GPS_DEVICE == UBLOX_DEVICE_ID
+		if (!configure_ublox())
+			status = GPS_ERROR_WARN;
+	#elif GPS_DEVICE == NMEA_DEVICE_ID
+		// receiver runs as set up
+	#else
+		#error "Invalid GPS Device Configuration"
+	#endif
+
+	/* Circular Reception: the parser reads the ring in place, behind the dma */
+	GPS_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+	while (GPS_DMA_STREAM->CR & DMA_SxCR_EN);
+	DMA2->LIFCR = GPS_DMA_FLAGS;
+
+	GPS_DMA_STREAM->PAR = (uint32_t) &GPS_USART->DR;
+	GPS_DMA_STREAM->M0AR = (uint32_t) rx_ring;
+	GPS_DMA_STREAM->NDTR = GPS_RX_RING_SIZE;
+	GPS_DMA_STREAM->FCR = 0U;		// direct mode
+	GPS_DMA_STREAM->CR = GPS_DMA_CHANNEL | DMA_SxCR_PL_0 | DMA_SxCR_MINC | DMA_SxCR_CIRC;
+
+	(void) GPS_USART->SR;
+	(void) GPS_USART->DR;
+	GPS_USART->CR3 |= USART_CR3_DMAR;
+	GPS_DMA_STREAM->CR |= DMA_SxCR_EN;
+
+	rx_tail = rx_head();
+	last_read_us = micros();
+	running = true;
+
+	return status;
+}
+
+/*
+ * @brief gps API call to stop reception
+ *
+ * @retval gps status type
+ */
+gps_status_t gps_deinit(void) {
+	if (!running)
+		return GPS_ERROR_WARN;
+
+	GPS_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+	GPS_USART->CR3 &= ~USART_CR3_DMAR;
+	GPS_USART->CR1 = 0U;
+	running = false;
+
+	return GPS_OK;
+}
+
+/*
+ * @brief gps API call to parse what arrived since the last call (non-blocking;
+ * 		  see gps.h)
+ * 		  NOTE: a call later than one ring period has lost bytes to the dma
+ * 		  (counted; the parser resyncs on the next message)
+ *
+ * @param  data		generic pointer to gps data handle
+ * @retval gps status type (WARN on lost or corrupted data)
+ */
+gps_status_t gps_read(void *data) {
+	gps_data_t *gps = (gps_data_t*) data;
+	gps_status_t status = GPS_OK;
+	uint32_t errors;
+	uint64_t now;
+
+	gps->fresh = false;
+	if (!running)
+		return GPS_OK;
+
+	now = micros();
+	if ((now - last_read_us) > GPS_RX_RING_US) {
+		overruns++;
+		status = GPS_ERROR_WARN;
+	}
+	last_read_us = now;
+
+	errors = parser.stats.checksum_errors + parser.stats.framing_errors;
+	(void) gps_parser_feed_ring(&parser, rx_ring, GPS_RX_RING_SIZE, &rx_tail, rx_head(), gps);
+
+	if ((parser.stats.checksum_errors + parser.stats.framing_errors) != errors)
+		status = GPS_ERROR_WARN;
+
+	return status;
+}
+
+/**
+  * @brief gets the stream statistics since init
+  *
+  * @param  out		stats buffer to be filled
+  * @retval None
+  */
+void gps_get_stats(gps_stats_t *out) {
+	*out = parser.stats;
+	out->overruns = overruns;
+}
@@ -0,0 +1,634 @@
+/*
+ * gps_parser.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <string.h>
+#include "sensors/gps/gps_parser.h"
+#include "common/maths.h"
+#include "common/settings.h"
+
+/**
+  * @brief  NMEA Config Settings
+  */
+#define NMEA_UERE_M				CONFIG_GPS_NMEA_UERE_M
+
+/**
+  * @brief  Parser States
+  */
+#define PARSE_IDLE				0U
+#define PARSE_UBX_SYNC2			1U
+#define PARSE_UBX_CLASS			2U
+#define PARSE_UBX_ID			3U
+#define PARSE_UBX_LEN1			4U
+#define PARSE_UBX_LEN2			5U
+#define PARSE_UBX_PAYLOAD		6U
+#define PARSE_UBX_CK_A			7U
+#define PARSE_UBX_CK_B			8U
+#define PARSE_NMEA_BODY			9U
+#define PARSE_NMEA_CK1			10U
+#define PARSE_NMEA_CK2			11U
+
+/**
+  * @brief  NMEA Sentences and Fields
+  */
+#define NMEA_START				'$'
+#define NMEA_CK_START			'*'
+#define NMEA_SEPARATOR			','
+
+#define NMEA_OTHER				0U
+#define NMEA_GGA				1U
+#define NMEA_RMC				2U
+
+#define NMEA_TAG(a, b, c)		(((uint32_t) (a) << 16) | ((uint32_t) (b) << 8) | (uint32_t) (c))
+
+#define NMEA_FRAC_MAX			5U			// fraction digits kept (1e-5 min ~ 2 cm)
+#define NMEA_MANTISSA_MAX		200000000	// further digits would overflow
+
+#define GGA_TIME				1U
+#define GGA_LAT					2U
+#define GGA_NS					3U
+#define GGA_LON					4U
+#define GGA_EW					5U
+#define GGA_QUALITY				6U
+#define GGA_NUM_SV				7U
+#define GGA_HDOP				8U
+#define GGA_ALT					9U
+
+#define RMC_TIME				1U
+#define RMC_STATUS				2U
+#define RMC_SPEED				7U
+#define RMC_COURSE				8U
+
+#define KNOT_TO_MMS				0.514444f	// knots (1e-3) to mm/s
+
+/**
+  * @brief  UBX NAV-PVT Payload Words (offset / 4)
+  */
+#define PVT_ITOW				0U
+#define PVT_FIX					5U			// fixType, flags, flags2, numSV
+#define PVT_LON					6U
+#define PVT_LAT					7U
+#define PVT_HMSL				9U
+#define PVT_HACC				10U
+#define PVT_VACC				11U
+#define PVT_VELN				12U
+#define PVT_VELE				13U
+#define PVT_VELD				14U
+#define PVT_SACC				17U
+
+#define PVT_FLAGS_FIX_OK		0x01U
+#define PVT_FIX_TYPE_2D			0x02U
+#define PVT_FIX_TYPE_3D			0x03U
+#define PVT_FIX_TYPE_GNSS_DR	0x04U
+
+
+/**
+  * @brief resets the parser (waits for the next message start)
+  *
+  * @param  p		pointer to parser handle
+  * @retval None
+  */
+void gps_parser_init(gps_parser_t *p) {
+	memset(p, 0, sizeof(*p));
+}
+
+/**
+  * @brief helper function to publish the decoded solution
+  *
+  * @param  p		pointer to parser handle
+  * @param	out		solution buffer to be filled
+  *
+  * @retval None
+  */
+static void publish(gps_parser_t *p, gps_data_t *out) {
+	*out = p->work;
+	out->fresh = true;
+	p->stats.solutions++;
+}
+
+/*
+ * UBX ------------------------------------------------------------------------
+ */
+/**
+  * @brief helper function to check for the one decoded ubx message
+  */
+static inline bool is_nav_pvt(const gps_parser_t *p) {
+	return (p->msg_class == UBX_CLASS_NAV) && (p->msg_id == UBX_ID_NAV_PVT) && (p->length == UBX_NAV_PVT_LEN);
+}
+
+/**
+  * @brief helper function to decode one NAV-PVT payload byte (fields are
+  * 	   stored as their last byte arrives)
+  *
+  * @param  p		pointer to parser handle
+  * @param	b		payload byte
+  *
+  * @retval None
+  */
+static void nav_pvt_byte(gps_parser_t *p, uint8_t b) {
+	gps_data_t *w = &p->work;
+	uint32_t shift = 8U * (p->offset & 3U);
+
+	p->word |= (uint32_t) b << shift;
+	if (shift != 24U)
+		return;
+
+	switch (p->offset >> 2) {
+		case PVT_ITOW:
+			w->time_ms = p->word;
+			break;
+
+		case PVT_FIX: {
+			uint8_t type = (uint8_t) p->word;
+			bool ok = ((p->word >> 8) & PVT_FLAGS_FIX_OK) != 0U;
+
+			if (ok && ((type == PVT_FIX_TYPE_3D) || (type == PVT_FIX_TYPE_GNSS_DR)))
+				w->fix = GPS_FIX_3D;
+			else if (ok && (type == PVT_FIX_TYPE_2D))
+				w->fix = GPS_FIX_2D;
+			else
+				w->fix = GPS_FIX_NONE;
+
+			w->num_sv = (uint8_t) (p->word >> 24);
+			break;
+		}
+
+		case PVT_LON:	w->lon_e7 = (int32_t) p->word;			break;
+		case PVT_LAT:	w->lat_e7 = (int32_t) p->word;			break;
+		case PVT_HMSL:	w->alt_msl_mm = (int32_t) p->word;		break;
+		case PVT_HACC:	w->h_acc_mm = p->word;					break;
+		case PVT_VACC:	w->v_acc_mm = p->word;					break;
+		case PVT_VELN:	w->vel_ned_mms[0] = (int32_t) p->word;	break;
+		case PVT_VELE:	w->vel_ned_mms[1] = (int32_t) p->word;	break;
+		case PVT_VELD:	w->vel_ned_mms[2] = (int32_t) p->word;	break;
+		case PVT_SACC:	w->s_acc_mms = p->word;					break;
+		default:												break;
+	}
+
+	p->word = 0U;
+}
+
+/**
+  * @brief helper function to run the ubx fletcher checksum over one byte
+  */
+static inline void ubx_checksum(gps_parser_t *p, uint8_t b) {
+	p->ck_a += b;
+	p->ck_b += p->ck_a;
+}
+
+/*
+ * NMEA -----------------------------------------------------------------------
+ */
+/**
+  * @brief helper function to start the next nmea field
+  */
+static inline void nmea_field_reset(gps_parser_t *p) {
+	p->mantissa = 0;
+	p->frac_digits = 0U;
+	p->fraction = false;
+	p->negative = false;
+	p->digits = false;
+	p->first = '\0';
+}
+
+/**
+  * @brief helper function to get the field value with a given number of
+  * 	   fraction digits (e.g. 2 turns "1.5" into 150)
+  *
+  * @param  p			read-only pointer to parser handle
+  * @param	digits		fraction digits of the result
+  *
+  * @retval fixed-point value
+  */
+static int32_t nmea_fixed(const gps_parser_t *p, uint8_t digits) {
+	int32_t v = p->mantissa;
+
+	for (uint8_t i = p->frac_digits; i < digits; ++i)
+		v *= 10;
+	for (uint8_t i = digits; i < p->frac_digits; ++i)
+		v /= 10;
+
+	return p->negative ? -v : v;
+}
+
+/**
+  * @brief helper function to convert hhmmss.sss to ms of the day
+  */
+static uint32_t nmea_time_ms(const gps_parser_t *p) {
+	uint32_t v = (uint32_t) nmea_fixed(p, 3U);
+	uint32_t hh = v / 10000000U;
+	uint32_t mm = (v / 100000U) % 100U;
+
+	return (hh * 60U + mm) * 60000U + v % 100000U;
+}
+
+/**
+  * @brief helper function to convert (d)ddmm.mmmmm to 1e-7 deg
+  */
+static int32_t nmea_angle_e7(const gps_parser_t *p) {
+	int32_t v = nmea_fixed(p, NMEA_FRAC_MAX);
+	int32_t deg = v / 10000000;
+	int32_t min_e5 = v % 10000000;
+
+	return deg * 10000000 + (min_e5 * 5 + 1) / 3;		// 1e5 min -> 1e7 deg
+}
+
+/**
+  * @brief helper function to store a complete GGA / RMC field
+  *
+  * @param  p		pointer to parser handle
+  * @retval None
+  */
+static void nmea_field_end(gps_parser_t *p) {
+	gps_data_t *w = &p->work;
+
+	if (p->field == 0U) {
+		if (p->tag == NMEA_TAG('G', 'G', 'A')) {
+			p->sentence = NMEA_GGA;
+			memset(w, 0, sizeof(*w));
+			p->hdop_c = 0U;
+		} else if (p->tag == NMEA_TAG('R', 'M', 'C')) {
+			p->sentence = NMEA_RMC;
+			p->rmc_valid = false;
+			p->rmc_speed = 0;
+			p->rmc_course = 0;
+		} else {
+			p->sentence = NMEA_OTHER;
+		}
+		return;
+	}
+
+	if (p->sentence == NMEA_GGA) {
+		switch (p->field) {
+			case GGA_TIME:		w->time_ms = nmea_time_ms(p);						break;
+			case GGA_LAT:		w->lat_e7 = nmea_angle_e7(p);						break;
+			case GGA_NS:		w->lat_e7 = (p->first == 'S') ? -w->lat_e7 : w->lat_e7;	break;
+			case GGA_LON:		w->lon_e7 = nmea_angle_e7(p);						break;
+			case GGA_EW:		w->lon_e7 = (p->first == 'W') ? -w->lon_e7 : w->lon_e7;	break;
+			case GGA_NUM_SV:	w->num_sv = (uint8_t) nmea_fixed(p, 0U);			break;
+			case GGA_HDOP:		p->hdop_c = (uint32_t) nmea_fixed(p, 2U);			break;
+			case GGA_ALT:		w->alt_msl_mm = nmea_fixed(p, 3U);					break;
+
+			/* 1 gps, 2 dgps, 4 rtk fixed, 5 rtk float (6 is dead reckoning) */
+			case GGA_QUALITY: {
+				int32_t q = nmea_fixed(p, 0U);
+				w->fix = ((q >= 1) && (q <= 5) && (q != 3)) ? GPS_FIX_3D : GPS_FIX_NONE;
+				break;
+			}
+
+			default:																break;
+		}
+
+	} else if (p->sentence == NMEA_RMC) {
+		switch (p->field) {
+			case RMC_TIME:		p->rmc_time_ms = nmea_time_ms(p);					break;
+			case RMC_STATUS:	p->rmc_valid = (p->first == 'A');					break;
+			case RMC_SPEED:		p->rmc_speed = nmea_fixed(p, 3U);					break;
+			case RMC_COURSE:	p->rmc_course = nmea_fixed(p, 2U);					break;
+			default:																break;
+		}
+	}
+}
+
+/**
+  * @brief helper function to act on a verified GGA / RMC sentence
+  *
+  * @param  p		pointer to parser handle
+  * @param	out		solution buffer (filled on GGA)
+  *
+  * @retval solutions published (0 or 1)
+  */
+static uint32_t nmea_sentence_end(gps_parser_t *p, gps_data_t *out) {
+	gps_data_t *w = &p->work;
+
+	if (p->sentence == NMEA_RMC) {
+		float speed_mms = (float) p->rmc_speed * KNOT_TO_MMS;
+		float course = DEG_TO_RAD((float) p->rmc_course * 0.01f);
+
+		p->rmc_ok = p->rmc_valid;
+		p->rmc_ok_time_ms = p->rmc_time_ms;
+		p->rmc_vel_ne_mms[0] = (int32_t) lroundf(speed_mms * cosf(course));
+		p->rmc_vel_ne_mms[1] = (int32_t) lroundf(speed_mms * sinf(course));
+		return 0U;
+	}
+
+	if (p->sentence != NMEA_GGA)
+		return 0U;
+
+	w->h_acc_mm = (uint32_t) ((float) p->hdop_c * (NMEA_UERE_M * 10.0f));
+	w->vel_valid = p->rmc_ok && (p->rmc_ok_time_ms == w->time_ms);
+	if (w->vel_valid) {
+		w->vel_ned_mms[0] = p->rmc_vel_ne_mms[0];
+		w->vel_ned_mms[1] = p->rmc_vel_ne_mms[1];
+	}
+
+	publish(p, out);
+	return 1U;
+}
+
+/**
+  * @brief helper function to accumulate one nmea body character
+  *
+  * @param  p		pointer to parser handle
+  * @param	c		character (printable)
+  *
+  * @retval None
+  */
+static void nmea_char(gps_parser_t *p, char c) {
+	if (!p->first)
+		p->first = c;
+
+	if (p->field == 0U) {
+		p->tag = ((p->tag << 8) | (uint8_t) c) & 0x00FFFFFFU;
+		return;
+	}
+
+	if ((c >= '0') && (c <= '9')) {
+		p->digits = true;
+		if (p->fraction && (p->frac_digits >= NMEA_FRAC_MAX))
+			return;
+		if (p->mantissa >= NMEA_MANTISSA_MAX)
+			return;
+
+		p->mantissa = p->mantissa * 10 + (c - '0');
+		if (p->fraction)
+			p->frac_digits++;
+
+	} else if (c == '.') {
+		p->fraction = true;
+	} else if (c == '-') {
+		p->negative = true;
+	}
+}
+
+/**
+  * @brief helper function to get a hex digit value (-1 if not one)
+  */
+static inline int32_t hex_value(uint8_t c) {
+	if ((c >= '0') && (c <= '9'))
+		return c - '0';
+	if ((c >= 'A') && (c <= 'F'))
+		return c - 'A' + 10;
+	if ((c >= 'a') && (c <= 'f'))
+		return c - 'a' + 10;
+	return -1;
+}
+
+/*
+ * Stream ---------------------------------------------------------------------
+ */
+/**
+  * @brief helper function to look for a message start
+  *
+  * @param  p		pointer to parser handle
+  * @param	b		byte
+  *
+  * @retval None
+  */
+static void parse_idle(gps_parser_t *p, uint8_t b) {
+	if (b == UBX_SYNC1) {
+		p->state = PARSE_UBX_SYNC2;
+
+	} else if (b == NMEA_START) {
+		p->state = PARSE_NMEA_BODY;
+		p->ck_a = 0U;
+		p->length = 0U;
+		p->field = 0U;
+		p->tag = 0U;
+		p->sentence = NMEA_OTHER;
+		nmea_field_reset(p);
+	}
+}
+
+/**
+  * @brief feeds received bytes through the parser
+  *
+  * @param  p		pointer to parser handle
+  * @param	buf		read-only pointer to received bytes
+  * @param	len		number of bytes
+  * @param	out		solution buffer (filled when a solution completes; left
+  * 					untouched otherwise)
+  *
+  * @retval solutions completed
+  */
+uint32_t gps_parser_feed(gps_parser_t *p, const uint8_t *buf, uint32_t len, gps_data_t *out) {
+	uint32_t solutions = 0U;
+
+	p->stats.bytes += len;
+
+	for (uint32_t i = 0; i < len; ++i) {
+		uint8_t b = buf[i];
+
+		switch (p->state) {
+			case PARSE_IDLE:
+				parse_idle(p, b);
+				break;
+
+			/* UBX: sync, class, id, length, payload, checksum */
+			case PARSE_UBX_SYNC2:
+				p->state = PARSE_IDLE;
+				if (b == UBX_SYNC2) {
+					p->state = PARSE_UBX_CLASS;
+					p->ck_a = p->ck_b = 0U;
+				} else {
+					parse_idle(p, b);
+				}
+				break;
+
+			case PARSE_UBX_CLASS:
+				p->msg_class = b;
+				ubx_checksum(p, b);
+				p->state = PARSE_UBX_ID;
+				break;
+
+			case PARSE_UBX_ID:
+				p->msg_id = b;
+				ubx_checksum(p, b);
+				p->state = PARSE_UBX_LEN1;
+				break;
+
+			case PARSE_UBX_LEN1:
+				p->length = b;
+				ubx_checksum(p, b);
+				p->state = PARSE_UBX_LEN2;
+				break;
+
+			case PARSE_UBX_LEN2:
+				p->length |= (uint16_t) b << 8;
+				ubx_checksum(p, b);
+				p->offset = 0U;
+				p->word = 0U;
+
+				if (p->length > UBX_PAYLOAD_MAX) {
+					p->stats.framing_errors++;
+					p->state = PARSE_IDLE;
+					break;
+				}
+
+				if (is_nav_pvt(p)) {
+					memset(&p->work, 0, sizeof(p->work));
+					p->work.vel_valid = true;
+				}
+				p->state = p->length ? PARSE_UBX_PAYLOAD : PARSE_UBX_CK_A;
+				break;
+
+			case PARSE_UBX_PAYLOAD:
+				ubx_checksum(p, b);
+				if (is_nav_pvt(p))
+					nav_pvt_byte(p, b);
+
+				if (++p->offset == p->length)
+					p->state = PARSE_UBX_CK_A;
+				break;
+
+			case PARSE_UBX_CK_A:
+				if (b != p->ck_a) {
+					p->stats.checksum_errors++;
+					p->state = PARSE_IDLE;
+					break;
+				}
+				p->state = PARSE_UBX_CK_B;
+				break;
+
+			case PARSE_UBX_CK_B:
+				p->state = PARSE_IDLE;
+				if (b != p->ck_b) {
+					p->stats.checksum_errors++;
+					break;
+				}
+
+				p->stats.messages++;
+				if (is_nav_pvt(p)) {
+					publish(p, out);
+					solutions++;
+				}
+				break;
+
+			/* NMEA: $body*hh (fields decoded as they arrive) */
+			case PARSE_NMEA_BODY:
+				if ((b < 0x20U) || (b > 0x7EU) || (++p->length > NMEA_SENTENCE_MAX)) {
+					/* Binary (e.g. a ubx frame) or an overlong line: resync on this byte */
+					p->stats.framing_errors++;
+					p->state = PARSE_IDLE;
+					parse_idle(p, b);
+					break;
+				}
+
+				if (b == NMEA_CK_START) {
+					nmea_field_end(p);
+					p->state = PARSE_NMEA_CK1;
+					break;
+				}
+
+				p->ck_a ^= b;
+				if (b == NMEA_SEPARATOR) {
+					nmea_field_end(p);
+					p->field++;
+					nmea_field_reset(p);
+				} else {
+					nmea_char(p, (char) b);
+				}
+				break;
+
+			case PARSE_NMEA_CK1:
+			case PARSE_NMEA_CK2: {
+				int32_t v = hex_value(b);
+
+				if (v < 0) {
+					p->stats.framing_errors++;
+					p->state = PARSE_IDLE;
+					parse_idle(p, b);
+					break;
+				}
+
+				if (p->state == PARSE_NMEA_CK1) {
+					p->ck_b = (uint8_t) (v << 4);
+					p->state = PARSE_NMEA_CK2;
+					break;
+				}
+
+				p->state = PARSE_IDLE;
+				if ((uint8_t) (p->ck_b | v) != p->ck_a) {
+					p->stats.checksum_errors++;
+					break;
+				}
+
+				p->stats.messages++;
+				solutions += nmea_sentence_end(p, out);
+				break;
+			}
+
+			default:
+				p->state = PARSE_IDLE;
+				break;
+		}
+	}
+
+	return solutions;
+}
+
+/**
+  * @brief feeds the new bytes of a circular receive buffer (e.g. dma) through
+  * 	   the parser, in place
+  *
+  * @param  p		pointer to parser handle
+  * @param	ring	read-only pointer to circular buffer
+  * @param	size	circular buffer size
+  * @param	tail	pointer to the read index (advanced to head)
+  * @param	head	write index (next byte the writer fills)
+  * @param	out		solution buffer (filled when a solution completes)
+  *
+  * @retval solutions completed
+  */
+uint32_t gps_parser_feed_ring(gps_parser_t *p, const uint8_t *ring, uint32_t size, uint32_t *tail,
+							  uint32_t head, gps_data_t *out) {
+	uint32_t solutions = 0U;
+
+	if (head < *tail) {
+		solutions += gps_parser_feed(p, &ring[*tail], size - *tail, out);
+		*tail = 0U;
+	}
+
+	solutions += gps_parser_feed(p, &ring[*tail], head - *tail, out);
+	*tail = head;
+
+	return solutions;
+}
+
+/**
+  * @brief builds a ubx frame (e.g. a configuration message)
+  *
+  * @param  msg_class	message class
+  * @param	msg_id		message id
+  * @param	payload		read-only pointer to payload (may be NULL if len is 0)
+  * @param	len			payload length
+  * @param	out			frame buffer (len + UBX_FRAME_OVERHEAD bytes)
+  *
+  * @retval frame length
+  */
+uint32_t ubx_frame(uint8_t msg_class, uint8_t msg_id, const uint8_t *payload, uint16_t len, uint8_t *out) {
+	uint8_t ck_a = 0U, ck_b = 0U;
+
+	out[0] = UBX_SYNC1;
+	out[1] = UBX_SYNC2;
+	out[2] = msg_class;
+	out[3] = msg_id;
+	out[4] = (uint8_t) len;
+	out[5] = (uint8_t) (len >> 8);
+	if (len)
+		memcpy(&out[6], payload, len);
+
+	for (uint32_t i = 2U; i < 6U + len; ++i) {
+		ck_a += out[i];
+		ck_b += ck_a;
+	}
+
+	out[6U + len] = ck_a;
+	out[7U + len] = ck_b;
+
+	return len + UBX_FRAME_OVERHEAD;
+}
@@ -0,0 +1,204 @@
+/*
+ * crash.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include "stm32f4xx_hal.h"
+#include "sensors/imu/crash.h"
+#include "sensors/imu/devices/lsm6dsox.h"
+#include "sensors/imu/devices/lsm6dsox_fsm.h"
+#include "esc/esc.h"
+#include "common/cycles.h"
+#include "common/time.h"
+#include "common/settings.h"
+
+/**
+  * @brief  Crash Detection Config Settings
+  */
+#define CRASH_DETECT			CONFIG_CRASH_DETECT
+#define CRASH_IMPACT_G			CONFIG_CRASH_IMPACT_G
+#define CRASH_TUMBLE_DPS		CONFIG_CRASH_TUMBLE_DPS
+#define CRASH_TUMBLE_MS			CONFIG_CRASH_TUMBLE_MS
+#define CRASH_FREEFALL_G		CONFIG_CRASH_FREEFALL_G
+#define CRASH_FREEFALL_MS		CONFIG_CRASH_FREEFALL_MS
+#define CRASH_FREEFALL_DISARM	CONFIG_CRASH_FREEFALL_DISARM
+
+/**
+  * @brief  FSM Rate and Status Polling
+  */
+#define CRASH_FSM_ODR			LSM6DSOX_ODR_FSM_104Hz
+#define CRASH_FSM_HZ			104U
+#define CRASH_PROGRAMS			3U
+#define CRASH_POLL_MS			100U		// status read without an interrupt (events not routed to INT1)
+
+/**
+  * @brief  IMU INT1 Line (PB0, EXTI0; rising edge, priority set by irq_init)
+  */
+#define CRASH_INT_GPIO_PORT		GPIOB
+#define CRASH_INT_PIN			GPIO_PIN_0
+#define CRASH_INT_IRQN			EXTI0_IRQn
+
+/**
+  * @brief  Crash Detection State (the volatile part is written by the isr)
+  */
+static volatile bool latched;
+static volatile bool pending;				// status to read (interrupt since the last read)
+static volatile uint32_t disarms;
+static volatile uint32_t disarm_cycles;
+static uint32_t disarms_seen;
+static uint32_t last_poll_ms;
+static bool running;
+
+
+/**
+  * @brief helper function to convert a duration to fsm samples
+  *
+  * @param  ms		duration
+  * @retval samples (1..255)
+  */
+static uint8_t fsm_samples(uint32_t ms) {
+	uint32_t samples = (ms * CRASH_FSM_HZ + 500U) / 1000U;
+
+	if (samples == 0U)
+		return 1U;
+
+	return (samples > 255U) ? 255U : (uint8_t) samples;
+}
+
+/*
+ * @brief crash detection API call to load the fsm programs into the imu and
+ * 		  enable the INT1 line
+ * 		  NOTE: call after imu init (the programs live in the imu)
+ *
+ * @retval crash status type (FATAL if the imu refused the programs; detection
+ * 		   is then off)
+ */
+crash_status_t crash_init(void) {
+	running = false;
+	latched = false;
+	pending = false;
+	disarms = 0U;
+	disarms_seen = 0U;
+
+#if (CRASH_DETECT == ENABLED)
+	lsm6dsox_fsm_program_t programs[CRASH_PROGRAMS];
+	GPIO_InitTypeDef gpio = {0};
+#if (CRASH_FREEFALL_DISARM == ENABLED)
+	uint16_t int1 = CRASH_EVENT_IMPACT | CRASH_EVENT_TUMBLE | CRASH_EVENT_FREEFALL;
+#else
+	uint16_t int1 = CRASH_EVENT_IMPACT | CRASH_EVENT_TUMBLE;
+#endif
+
+	/* Programs in CRASH_EVENT_* bit order */
+	if (!lsm6dsox_fsm_norm_program(&programs[0], LSM6DSOX_FSM_IN_XL, true, CRASH_IMPACT_G, 0U) ||
+		!lsm6dsox_fsm_norm_program(&programs[1], LSM6DSOX_FSM_IN_GY, true, CRASH_TUMBLE_DPS, fsm_samples(CRASH_TUMBLE_MS)) ||
+		!lsm6dsox_fsm_norm_program(&programs[2], LSM6DSOX_FSM_IN_XL, false, CRASH_FREEFALL_G, fsm_samples(CRASH_FREEFALL_MS)))
+		return CRASH_ERROR_FATAL;
+
+	if (lsm6dsox_fsm_load(programs, CRASH_PROGRAMS, CRASH_FSM_ODR, int1) != IMU_OK)
+		return CRASH_ERROR_FATAL;
+
+	__HAL_RCC_GPIOB_CLK_ENABLE();
+
+	gpio.Pin = CRASH_INT_PIN;
+	gpio.Mode = GPIO_MODE_IT_RISING;
+	gpio.Pull = GPIO_PULLDOWN;
+	HAL_GPIO_Init(CRASH_INT_GPIO_PORT, &gpio);
+
+	__HAL_GPIO_EXTI_CLEAR_IT(CRASH_INT_PIN);
+	HAL_NVIC_EnableIRQ(CRASH_INT_IRQN);
+
+	last_poll_ms = millis();
+	pending = true;			// a status latched before the line was enabled
+	running = true;
+#endif
+
+	return CRASH_OK;
+}
+
+/**
+  * @brief crash detection API call to read what fired, take the isr's
+  * 	   disarms and clear the latch (once per flight loop, before
+  * 	   flight_update)
+  *
+  * @param  arm_switch_off	true while the arm switch is off (clears the latch)
+  * @param	state			pointer to crash state handle
+  *
+  * @retval crash status type (WARN on a detection, an isr disarm or a failed
+  * 		status read)
+  */
+crash_status_t crash_service(bool arm_switch_off, crash_state_t *state) {
+	crash_status_t status = CRASH_OK;
+	uint32_t now = millis();
+	uint32_t count;
+	uint16_t fired;
+
+	state->disarmed = false;
+
+	if (!running) {
+		state->latched = false;
+		return CRASH_OK;
+	}
+
+	/* Which program fired (the read releases the INT1 pin) */
+	if (pending || ((now - last_poll_ms) >= CRASH_POLL_MS)) {
+		pending = false;
+		last_poll_ms = now;
+
+		if (lsm6dsox_fsm_status(&fired) != IMU_OK) {
+			status = CRASH_ERROR_WARN;
+
+		} else if (fired) {
+			state->events |= fired;
+			state->detections++;
+			status = CRASH_ERROR_WARN;
+		}
+	}
+
+	/* Disarms by the isr since the last call (counter written by the isr only) */
+	count = disarms;
+	if (count != disarms_seen) {
+		disarms_seen = count;
+		state->disarmed = true;
+		state->disarms = count;
+		state->disarm_cycles = disarm_cycles;
+		status = CRASH_ERROR_WARN;
+	}
+
+	/* Pilot acknowledged the crash (the escs may arm again) */
+	if (arm_switch_off) {
+		latched = false;
+		esc_unlock();
+	}
+
+	state->latched = latched;
+
+	return status;
+}
+
+/**
+  * @brief imu INT1 interrupt: disarms the escs at once if armed, and locks
+  * 	   them so a command write it interrupted cannot spin them up again
+  * 	   NOTE: call from EXTI0_IRQHandler
+  *
+  * @retval None
+  */
+void crash_irq_handler(void) {
+	uint32_t start = cycles_now();
+
+	__HAL_GPIO_EXTI_CLEAR_IT(CRASH_INT_PIN);
+
+	if (!running)
+		return;
+
+	if (esc_is_armed()) {
+		esc_lock();
+		disarm_cycles = cycles_now() - start;
+		latched = true;
+		disarms++;
+	}
+
+	pending = true;
+}
@@ -7,7 +7,19 @@
 
 #include <string.h>
 #include "sensors/imu/devices/lsm6dsox.h"
+#include "sensors/imu/devices/lsm6dsox_config.h"
+#include "sensors/imu/devices/lsm6dsox_fsm.h"
 #include "lsm6dsox_reg.h"
+#include "common/settings.h"
+#include "system/driver_registry.h"
+
+/*
+ * @brief  Loop Rate & Filter Config Settings (odr, on-chip filters and fifo
+ * 		   are derived from these; see lsm6dsox_config.h)
+ */
+#define IMU_LOOP_RATE_HZ		CONFIG_IMU_LOOP_RATE_HZ
+#define GY_BW_HZ				CONFIG_GY_LPF_CUTOFF_FREQ_HZ
+#define XL_BW_HZ				CONFIG_XL_LPF_CUTOFF_FREQ_HZ
 
 /*
  * @brief  XL Scale Factor & Non-Orthogonality Corrections
@@ -32,6 +44,25 @@
 #define XL_YBIASOFFSET_MG		-20.213588f
 #define XL_ZBIASOFFSET_MG		1.963071f
 
+/*
+ * @brief  FIFO (one word: tag byte + 6 data bytes)
+ */
+#define FIFO_WORD_LEN			7U
+#define FIFO_TAG_SHIFT			3U
+#define FIFO_LEVEL_HIGH_MASK	0x03U		// FIFO_STATUS2 diff_fifo[9:8]
+#define FIFO_OVERRUN			0x40U		// FIFO_STATUS2 fifo_ovr_ia
+#define TIMESTAMP_LSB_US		25U			// nominal (internal oscillator trim not applied)
+
+/*
+ * @brief  Sensor Hub (one-shot transactions at init)
+ */
+#define HUB_ENDOP_TIMEOUT_MS	50U
+
+/*
+ * @brief  Finite State Machine (program memory from FSM_START_ADD)
+ */
+#define FSM_START_ADDRESS		0x0400U
+
 /*
  * @brief  IMU Status Type Alias
  */
@@ -42,15 +73,50 @@
 typedef imu_status_t lsm6dsox_interface_status_t;
 
 /*
- * @brief  STM Device Context Handle
+ * @brief  Device Instance Type (the stm device context handle points back to it)
+ */
+typedef struct {
+	stmdev_ctx_t ctx;
+	const void *handle;				// platform bus handle (i2c)
+	uint8_t i2c_addr;
+	const lsm6dsox_bus_t *bus;		// bus override (NULL: platform bus)
+	lsm6dsox_config_t config;		// derived configuration (applied by init)
+	uint32_t prev_timestamp;		// fifo read state
+	bool have_timestamp;
+	bool fifo_synced;				// a read has kept up since the last (re)start
+} lsm6dsox_dev_t;
+
+/*
+ * @brief  Device Instances (SA0 low / high until set by lsm6dsox_set_platform)
  */
-static stmdev_ctx_t dev_ctx;
+static lsm6dsox_dev_t devs[LSM6DSOX_INSTANCES] = {
+	[LSM6DSOX_PRIMARY]		= {.i2c_addr = LSM6DSOX_I2C_ADD_L},
+	[LSM6DSOX_SECONDARY]	= {.i2c_addr = LSM6DSOX_I2C_ADD_H}
+};
+
+/*
+ * @brief  Primary Device Context (sensor hub and finite state machine)
+ */
+static stmdev_ctx_t *const dev_ctx = &devs[LSM6DSOX_PRIMARY].ctx;
+
+/*
+ * @brief  Loop Rate (shared by the instances)
+ */
+static uint32_t loop_rate_hz = IMU_LOOP_RATE_HZ;
+
+/*
+ * @brief  Sensor Hub State (latest slave 0 bytes from the fifo)
+ */
+static uint8_t hub_data[LSM6DSOX_HUB_DATA_LEN];
+static bool hub_fresh;
+static bool hub_attached;
+static uint32_t hub_errors;
 
 
 /*
  * @brief  Write generic device register (platform dependent)
  *
- * @param  handle    pointer to sensor bus handler
+ * @param  handle    pointer to device instance
  *
  * @param  reg       register to write
  * @param  bufp      pointer to data to write in register reg
@@ -59,8 +125,14 @@ static stmdev_ctx_t dev_ctx;
  * @retval 0
  */
 static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp, uint16_t len) {
-	if (handle == phi2c) {
-		HAL_I2C_Mem_Write(handle, LSM6DSOX_I2C_ADD_L, reg, I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+	const lsm6dsox_dev_t *d = handle;
+
+	if (d->bus) {
+		return d->bus->write(reg, bufp, len);
+
+	} else if (d->handle) {
+		/* HAL takes a mutable buffer but only reads from it on a write */
+		HAL_I2C_Mem_Write((I2C_HandleTypeDef*) d->handle, d->i2c_addr, reg, I2C_MEMADD_SIZE_8BIT, (uint8_t*) bufp, len, 1000);
 
 	} /* else if (handle == phspi) {
 	  HAL_SPI_Transmit();
@@ -73,7 +145,7 @@ static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp, ui
 /*
  * @brief  Read generic device register (platform dependent)
  *
- * @param  handle    pointer to sensor bus handler
+ * @param  handle    pointer to device instance
  *
  * @param  reg       register to read
  * @param  bufp      pointer to buffer that store the data read
@@ -82,8 +154,13 @@ static int32_t platform_write(void *handle, uint8_t reg, const uint8_t *bufp, ui
  * @retval 0
  */
 static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp, uint16_t len) {
-	if (handle == phi2c) {
-		HAL_I2C_Mem_Read(handle, LSM6DSOX_I2C_ADD_L, reg, I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
+	const lsm6dsox_dev_t *d = handle;
+
+	if (d->bus) {
+		return d->bus->read(reg, bufp, len);
+
+	} else if (d->handle) {
+		HAL_I2C_Mem_Read((I2C_HandleTypeDef*) d->handle, d->i2c_addr, reg, I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
 
 	} /* else if (handle == phspi) {
 	  HAL_SPI_Receive_DMA();
@@ -106,76 +183,102 @@ static void platform_delay(uint32_t ms) {
 /**
   * @brief lsm6dsox configuration & setup
   *
+  * @param  d		pointer to device instance
   * @retval lsm6dsox status type
   */
-static lsm6dsox_interface_status_t lsm6dsox_init(void) {
+static lsm6dsox_interface_status_t lsm6dsox_init(lsm6dsox_dev_t *d) {
 	#if !defined(LSM6DSOX_REGS_H)
 		#error "No Device Driver Found for LSM6DSOX"
 	#endif
 
-	uint8_t whoamI, rst;
+	stmdev_ctx_t *ctx = &d->ctx;
+	lsm6dsox_config_t *config = &d->config;
+	uint8_t whoamI = 0U, rst;
 
 	/* Initialize mems driver interface */
-	dev_ctx.write_reg = platform_write;
-	dev_ctx.read_reg = platform_read;
-	dev_ctx.mdelay = platform_delay;
-	dev_ctx.handle = platform_handle;
+	ctx->write_reg = platform_write;
+	ctx->read_reg = platform_read;
+	ctx->mdelay = platform_delay;
+	ctx->handle = d;
 
 	/* Check device ID */
-	lsm6dsox_device_id_get(&dev_ctx, &whoamI);
+	lsm6dsox_device_id_get(ctx, &whoamI);
 	if (whoamI != LSM6DSOX_ID)
 	  return LSM6DSOX_ERROR_FATAL;
 
+	if (!lsm6dsox_derive_config(loop_rate_hz, GY_BW_HZ, XL_BW_HZ, config))
+	  return LSM6DSOX_ERROR_FATAL;
+
 	/* Restore default configuration */
-	lsm6dsox_reset_set(&dev_ctx, PROPERTY_ENABLE);
+	lsm6dsox_reset_set(ctx, PROPERTY_ENABLE);
 	do {
-	  lsm6dsox_reset_get(&dev_ctx, &rst);
+	  lsm6dsox_reset_get(ctx, &rst);
 	} while (rst);
 
 	/* Disable I3C interface */
-	lsm6dsox_i3c_disable_set(&dev_ctx, LSM6DSOX_I3C_DISABLE);
+	lsm6dsox_i3c_disable_set(ctx, LSM6DSOX_I3C_DISABLE);
 
 	/* Enable Block Data Update */
-	lsm6dsox_block_data_update_set(&dev_ctx, PROPERTY_ENABLE);
-
-	// FIFO?
+	lsm6dsox_block_data_update_set(ctx, PROPERTY_ENABLE);
 
 	/* Set Power Mode */
-	lsm6dsox_xl_power_mode_set(&dev_ctx, LSM6DSOX_HIGH_PERFORMANCE_MD);
-	lsm6dsox_gy_power_mode_set(&dev_ctx, LSM6DSOX_GY_HIGH_PERFORMANCE);
+	lsm6dsox_xl_power_mode_set(ctx, LSM6DSOX_HIGH_PERFORMANCE_MD);
+	lsm6dsox_gy_power_mode_set(ctx, LSM6DSOX_GY_HIGH_PERFORMANCE);
 
-	/* Set Output Data Rate */
-	lsm6dsox_xl_data_rate_set(&dev_ctx, LSM6DSOX_XL_ODR_417Hz);
-	lsm6dsox_gy_data_rate_set(&dev_ctx, LSM6DSOX_GY_ODR_417Hz);
+	/* Set Output Data Rate (the on-chip filters run at it) */
+	lsm6dsox_xl_data_rate_set(ctx, config->odr_xl);
+	lsm6dsox_gy_data_rate_set(ctx, config->odr_gy);
 
-	/* Set full scale */
-	lsm6dsox_xl_full_scale_set(&dev_ctx, LSM6DSOX_2g);
-	lsm6dsox_gy_full_scale_set(&dev_ctx, LSM6DSOX_2000dps);
+	/* Set full scale (16 g: crash impacts stay in range for the fsm) */
+	lsm6dsox_xl_full_scale_set(ctx, LSM6DSOX_16g);
+	lsm6dsox_gy_full_scale_set(ctx, LSM6DSOX_2000dps);
 
 	/* Enable Time Stamp */
-	lsm6dsox_timestamp_set(&dev_ctx, PROPERTY_ENABLE);
+	lsm6dsox_timestamp_set(ctx, PROPERTY_ENABLE);
+
+	/* FIFO: accel, gyro and a timestamp batched at the loop rate (decimated from the odr), read in one burst */
+	lsm6dsox_fifo_xl_batch_set(ctx, config->bdr_xl);
+	lsm6dsox_fifo_gy_batch_set(ctx, config->bdr_gy);
+	lsm6dsox_fifo_timestamp_decimation_set(ctx, LSM6DSOX_DEC_1);
+	lsm6dsox_fifo_watermark_set(ctx, config->fifo_watermark);
+	lsm6dsox_fifo_mode_set(ctx, LSM6DSOX_STREAM_MODE);
+
+	d->have_timestamp = false;
+	d->fifo_synced = false;
+	if (d == &devs[LSM6DSOX_PRIMARY]) {
+		hub_attached = false;
+		hub_fresh = false;
+		hub_errors = 0U;
+	}
 
 	/*
-	 * Configure filtering chain (No aux interface)
+	 * Configure filtering chain (No aux interface): the anti-alias filters
+	 * of the fifo decimation, so the flight loop filters nothing
 	 *
+	 * Gyroscope - LPF1 (bandwidth selectable from 417 Hz odr up)
 	 * Accelerometer - LPF1 + LPF2 path
 	 */
-	lsm6dsox_xl_hp_path_on_out_set(&dev_ctx, LSM6DSOX_LP_ODR_DIV_10);
-	lsm6dsox_xl_filter_lp2_set(&dev_ctx, PROPERTY_ENABLE);
+	if (config->gy_lpf1) {
+		lsm6dsox_gy_lp1_bandwidth_set(ctx, config->gy_ftype);
+		lsm6dsox_gy_filter_lp1_set(ctx, PROPERTY_ENABLE);
+	}
+
+	lsm6dsox_xl_hp_path_on_out_set(ctx, config->xl_lpf2);
+	lsm6dsox_xl_filter_lp2_set(ctx, PROPERTY_ENABLE);
 
 	/*
 	 * uint8_t offset[3] = {};
 	 *
 	 * Weight of XL user offset
-	 * lsm6dsox_xl_offset_weight_set(&dev_ctx, LSM6DSOX_LSb_1mg);
+	 * lsm6dsox_xl_offset_weight_set(ctx, LSM6DSOX_LSb_1mg);
 	 *
 	 * Accelerometer X,Y,Z axis user offset correction expressed
 	 * in two’s complement.
 	 *
-	 lsm6dsox_xl_usr_offset_x_set(&dev_ctx, &offset[0]);
-	 lsm6dsox_xl_usr_offset_y_set(&dev_ctx, &offset[1]);
-	 lsm6dsox_xl_usr_offset_z_set(&dev_ctx, &offset[2]);
-	 lsm6dsox_xl_usr_offset_set(&dev_ctx, PROPERTY_ENABLE);
+	 lsm6dsox_xl_usr_offset_x_set(ctx, &offset[0]);
+	 lsm6dsox_xl_usr_offset_y_set(ctx, &offset[1]);
+	 lsm6dsox_xl_usr_offset_z_set(ctx, &offset[2]);
+	 lsm6dsox_xl_usr_offset_set(ctx, PROPERTY_ENABLE);
 	 */
 
 	return LSM6DSOX_OK;
@@ -184,76 +287,555 @@ static lsm6dsox_interface_status_t lsm6dsox_init(void) {
 /**
   * @brief lsm6dsox deinit
   *
+  * @param  d		pointer to device instance
   * @retval lsm6dsox status type
   */
-static lsm6dsox_interface_status_t lsm6dsox_deinit(void) {
+static lsm6dsox_interface_status_t lsm6dsox_deinit(lsm6dsox_dev_t *d) {
 	/* Restore default configuration */
-	lsm6dsox_reset_set(&dev_ctx, PROPERTY_ENABLE);
+	lsm6dsox_reset_set(&d->ctx, PROPERTY_ENABLE);
 
 	/* Reset mems driver interface */
-	dev_ctx.write_reg = NULL;
-	dev_ctx.read_reg = NULL;
-	dev_ctx.mdelay = NULL;
-	dev_ctx.handle = NULL;
+	d->ctx.write_reg = NULL;
+	d->ctx.read_reg = NULL;
+	d->ctx.mdelay = NULL;
+	d->ctx.handle = NULL;
 
 	return LSM6DSOX_OK;
 }
 
+/**
+  * @brief helper function to drop the fifo contents (bypass, then stream again)
+  *
+  * @param  d		pointer to device instance
+  * @retval None
+  */
+static void fifo_restart(lsm6dsox_dev_t *d) {
+	lsm6dsox_fifo_mode_set(&d->ctx, LSM6DSOX_BYPASS_MODE);
+	lsm6dsox_fifo_mode_set(&d->ctx, LSM6DSOX_STREAM_MODE);
+	d->have_timestamp = false;
+	d->fifo_synced = false;
+}
+
+/**
+  * @brief helper function to get a little-endian 16-bit word
+  *
+  * @retval signed word
+  */
+static inline int16_t get_i16(const uint8_t *buf) {
+	return (int16_t) ((uint16_t) buf[0] | ((uint16_t) buf[1] << 8));
+}
+
 /*
- * @brief	get IMU data in engineering units
+ * @brief	get IMU data in engineering units (newest fifo sample; unchanged
+ * 			if none arrived since the last call)
+ * 			NOTE: the fifo output address rolls over from 0x7E to 0x78, so all
+ * 			words come in one burst
  *
+ * @param	d		pointer to device instance
  * @param	data	generic sensor handle pointer to store updated measurements
- * @retval	lsm6dsox status type
+ * @retval	lsm6dsox status type (WARN when the fifo fell behind and was dropped)
  */
-static lsm6dsox_interface_status_t lsm6dsox_read(void *data) {
-	lsm6dsox_reg_t reg;
-	int16_t data_raw_acceleration[3];
-	int16_t data_raw_angular_rate[3];
+static lsm6dsox_interface_status_t lsm6dsox_read(lsm6dsox_dev_t *d, void *data) {
+	uint8_t words[LSM6DSOX_FIFO_WORDS_MAX * FIFO_WORD_LEN];
+	uint8_t fifo_status[2];
+	const uint8_t *xl = NULL;
+	const uint8_t *gy = NULL;
+	const uint8_t *ts = NULL;
 	imu_6D_t *imu = (imu_6D_t*) data;
+	uint32_t level;
+
+	/* Unread words */
+	if (lsm6dsox_read_reg(&d->ctx, LSM6DSOX_FIFO_STATUS1, fifo_status, sizeof(fifo_status)) != 0)
+		return LSM6DSOX_ERROR_WARN;
+
+	level = ((uint32_t) (fifo_status[1] & FIFO_LEVEL_HIGH_MASK) << 8) | fifo_status[0];
+
+	/* Fell behind (a stall, or the first read after init): drop the backlog, the next odr period refills it */
+	if ((level > d->config.fifo_max_words) || (fifo_status[1] & FIFO_OVERRUN)) {
+		bool synced = d->fifo_synced;
+
+		fifo_restart(d);
+		return synced ? LSM6DSOX_ERROR_WARN : LSM6DSOX_OK;
+	}
+
+	if (level == 0U)
+		return LSM6DSOX_OK;
+
+	if (lsm6dsox_read_reg(&d->ctx, LSM6DSOX_FIFO_DATA_OUT_TAG, words, (uint16_t) (level * FIFO_WORD_LEN)) != 0)
+		return LSM6DSOX_ERROR_WARN;
+
+	d->fifo_synced = true;
+
+	/* Keep the newest word of each kind */
+	for (uint32_t i = 0; i < level; ++i) {
+		const uint8_t *word = &words[i * FIFO_WORD_LEN];
+
+		switch (word[0] >> FIFO_TAG_SHIFT) {
+			case LSM6DSOX_XL_NC_TAG:
+				xl = &word[1];
+				break;
 
-    /* Read output only if new data is available */
-	lsm6dsox_status_reg_get(&dev_ctx, &reg.status_reg);
-
-    if (reg.status_reg.xlda || reg.status_reg.gda) {
-    	static uint32_t prev_timestamp;
-
-    	/* Read time stamp value */
-    	uint32_t curr_timestamp;
-    	lsm6dsox_timestamp_raw_get(&dev_ctx, &curr_timestamp);
-
-    	/* Compute time step */
-    	imu->dt = curr_timestamp - prev_timestamp;
-
-    	/* Store current time stamp in previous */
-    	prev_timestamp = curr_timestamp;
-    }
-
-    if (reg.status_reg.xlda) {
-    	/* Read acceleration field data */
-		memset(data_raw_acceleration, 0x00, 3 * sizeof(int16_t));
-		lsm6dsox_acceleration_raw_get(&dev_ctx, data_raw_acceleration);
-		imu->accel_x = lsm6dsox_from_fs2_to_mg(data_raw_acceleration[0]);
-		imu->accel_y = lsm6dsox_from_fs2_to_mg(data_raw_acceleration[1]);
-		imu->accel_z = lsm6dsox_from_fs2_to_mg(data_raw_acceleration[2]);
-    }
-
-    if (reg.status_reg.gda) {
-		/* Read angular rate field data */
-		memset(data_raw_angular_rate, 0x00, 3 * sizeof(int16_t));
-		lsm6dsox_angular_rate_raw_get(&dev_ctx, data_raw_angular_rate);
-		imu->rate_x = lsm6dsox_from_fs2000_to_mdps(data_raw_angular_rate[0]);
-		imu->rate_y = lsm6dsox_from_fs2000_to_mdps(data_raw_angular_rate[1]);
-		imu->rate_z = lsm6dsox_from_fs2000_to_mdps(data_raw_angular_rate[2]);
-    }
-
-    return LSM6DSOX_OK;
+			case LSM6DSOX_GYRO_NC_TAG:
+				gy = &word[1];
+				break;
+
+			case LSM6DSOX_TIMESTAMP_TAG:
+				ts = &word[1];
+				break;
+
+			case LSM6DSOX_SENSORHUB_SLAVE0_TAG:
+				memcpy(hub_data, &word[1], LSM6DSOX_HUB_DATA_LEN);
+				hub_fresh = true;
+				break;
+
+			case LSM6DSOX_SENSORHUB_NACK_TAG:
+				hub_errors++;
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	if (ts) {
+		uint32_t curr_timestamp = (uint32_t) ts[0] | ((uint32_t) ts[1] << 8) |
+								  ((uint32_t) ts[2] << 16) | ((uint32_t) ts[3] << 24);
+
+		/* Compute time step (timestamp counts in 25 us steps) */
+		if (d->have_timestamp)
+			imu->dt = (curr_timestamp - d->prev_timestamp) * TIMESTAMP_LSB_US;
+
+		d->prev_timestamp = curr_timestamp;
+		d->have_timestamp = true;
+	}
+
+	if (xl) {
+		imu->accel_x = lsm6dsox_from_fs16_to_mg(get_i16(&xl[0]));
+		imu->accel_y = lsm6dsox_from_fs16_to_mg(get_i16(&xl[2]));
+		imu->accel_z = lsm6dsox_from_fs16_to_mg(get_i16(&xl[4]));
+	}
+
+	if (gy) {
+		imu->rate_x = lsm6dsox_from_fs2000_to_mdps(get_i16(&gy[0]));
+		imu->rate_y = lsm6dsox_from_fs2000_to_mdps(get_i16(&gy[2]));
+		imu->rate_z = lsm6dsox_from_fs2000_to_mdps(get_i16(&gy[4]));
+	}
+
+	return LSM6DSOX_OK;
+}
+
+/**
+  * @brief routes register access of the primary instance to a bus override
+  * 	   instead of the platform bus (pass NULL to restore it)
+  * 	   NOTE: not while the flight loop reads the imu
+  *
+  * @param  bus		read-only pointer to bus override
+  * @retval None
+  */
+void lsm6dsox_set_bus(const lsm6dsox_bus_t *bus) {
+	devs[LSM6DSOX_PRIMARY].bus = bus;
+}
+
+/**
+  * @brief routes register access of an instance to a bus override (pass
+  * 	   NULL to restore its platform bus)
+  *
+  * @param  instance	device instance
+  * @param	bus			read-only pointer to bus override
+  *
+  * @retval None
+  */
+void lsm6dsox_set_instance_bus(lsm6dsox_instance_t instance, const lsm6dsox_bus_t *bus) {
+	if (instance < LSM6DSOX_INSTANCES)
+		devs[instance].bus = bus;
+}
+
+/**
+  * @brief sets the platform bus of an instance (before its init)
+  *
+  * @param  instance	device instance
+  * @param	handle		platform bus handle (i2c; NULL: none)
+  * @param	i2c_addr	8-bit i2c address (LSM6DSOX_I2C_ADD_L / LSM6DSOX_I2C_ADD_H)
+  *
+  * @retval None
+  */
+void lsm6dsox_set_platform(lsm6dsox_instance_t instance, const void *handle, uint8_t i2c_addr) {
+	if (instance >= LSM6DSOX_INSTANCES)
+		return;
+
+	devs[instance].handle = handle;
+	devs[instance].i2c_addr = i2c_addr;
+}
+
+/**
+  * @brief sets the flight loop rate the next init derives the odr, on-chip
+  * 	   filters and fifo settings from (CONFIG_IMU_LOOP_RATE_HZ until set)
+  *
+  * @param  loop_hz		flight loop rate (LSM6DSOX_LOOP_HZ_MIN..LSM6DSOX_LOOP_HZ_MAX)
+  * @retval imu status type (FATAL if out of range; the rate is then unchanged)
+  */
+imu_status_t lsm6dsox_set_loop_rate(uint32_t loop_hz) {
+	if ((loop_hz < LSM6DSOX_LOOP_HZ_MIN) || (loop_hz > LSM6DSOX_LOOP_HZ_MAX))
+		return LSM6DSOX_ERROR_FATAL;
+
+	loop_rate_hz = loop_hz;
+
+	return LSM6DSOX_OK;
+}
+
+/**
+  * @brief gets the configuration applied by the last init (primary; the
+  * 	   other instances derive the same)
+  *
+  * @retval read-only pointer to configuration
+  */
+const lsm6dsox_config_t* lsm6dsox_get_config(void) {
+	return &devs[LSM6DSOX_PRIMARY].config;
+}
+
+/**
+  * @brief helper function to run one sensor hub cycle on its own (init only):
+  * 	   the hub is triggered by the accelerometer data ready, so the
+  * 	   accelerometer is restarted around it
+  *
+  * @retval lsm6dsox status type (WARN if the cycle did not end or the slave nacked)
+  */
+static lsm6dsox_interface_status_t hub_cycle(void) {
+	lsm6dsox_status_master_t master = {0};
+	uint32_t waited = 0U;
+
+	lsm6dsox_xl_data_rate_set(dev_ctx, LSM6DSOX_XL_ODR_OFF);
+	lsm6dsox_sh_master_set(dev_ctx, PROPERTY_ENABLE);
+	lsm6dsox_xl_data_rate_set(dev_ctx, devs[LSM6DSOX_PRIMARY].config.odr_xl);
+
+	do {
+		platform_delay(1U);
+		lsm6dsox_sh_status_get(dev_ctx, &master);
+	} while (!master.sens_hub_endop && (++waited < HUB_ENDOP_TIMEOUT_MS));
+
+	lsm6dsox_sh_master_set(dev_ctx, PROPERTY_DISABLE);
+
+	if (!master.sens_hub_endop || master.slave0_nack)
+		return LSM6DSOX_ERROR_WARN;
+
+	return LSM6DSOX_OK;
+}
+
+/**
+  * @brief writes one register of a sensor hub slave (init only: blocks for
+  * 	   a hub cycle)
+  *
+  * @param  addr	7-bit slave address
+  * @param	reg		slave register
+  * @param	value	value to write
+  *
+  * @retval imu status type
+  */
+imu_status_t lsm6dsox_hub_write(uint8_t addr, uint8_t reg, uint8_t value) {
+	lsm6dsox_sh_cfg_write_t cfg = {.slv0_add = addr, .slv0_subadd = reg, .slv0_data = value};
+	lsm6dsox_interface_status_t status;
+
+	if ((dev_ctx->read_reg == NULL) || hub_attached)
+		return LSM6DSOX_ERROR_FATAL;
+
+	lsm6dsox_sh_pin_mode_set(dev_ctx, LSM6DSOX_INTERNAL_PULL_UP);
+	lsm6dsox_sh_write_mode_set(dev_ctx, LSM6DSOX_ONLY_FIRST_CYCLE);
+	lsm6dsox_sh_cfg_write(dev_ctx, &cfg);
+	lsm6dsox_sh_slave_connected_set(dev_ctx, LSM6DSOX_SLV_0);
+
+	status = hub_cycle();
+
+	/* Back to reading, so the write is not repeated */
+	lsm6dsox_sh_slv0_cfg_read(dev_ctx, &(lsm6dsox_sh_cfg_read_t){.slv_add = addr, .slv_subadd = reg, .slv_len = 1U});
+
+	return status;
+}
+
+/**
+  * @brief reads registers of a sensor hub slave (init only: blocks for a hub
+  * 	   cycle)
+  *
+  * @param  addr	7-bit slave address
+  * @param	reg		first slave register
+  * @param	buf		buffer to be filled
+  * @param	len		bytes (1..LSM6DSOX_HUB_DATA_LEN)
+  *
+  * @retval imu status type
+  */
+imu_status_t lsm6dsox_hub_read(uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len) {
+	lsm6dsox_emb_sh_read_t raw;
+	lsm6dsox_interface_status_t status;
+
+	if ((dev_ctx->read_reg == NULL) || hub_attached || (len == 0U) || (len > LSM6DSOX_HUB_DATA_LEN))
+		return LSM6DSOX_ERROR_FATAL;
+
+	lsm6dsox_sh_pin_mode_set(dev_ctx, LSM6DSOX_INTERNAL_PULL_UP);
+	lsm6dsox_sh_slv0_cfg_read(dev_ctx, &(lsm6dsox_sh_cfg_read_t){.slv_add = addr, .slv_subadd = reg, .slv_len = len});
+	lsm6dsox_sh_slave_connected_set(dev_ctx, LSM6DSOX_SLV_0);
+
+	status = hub_cycle();
+	if (status != LSM6DSOX_OK)
+		return status;
+
+	lsm6dsox_sh_read_data_raw_get(dev_ctx, &raw, len);
+	memcpy(buf, &raw, len);
+
+	return LSM6DSOX_OK;
+}
+
+/**
+  * @brief starts continuous sensor hub reads of a slave, batched into the
+  * 	   fifo (LSM6DSOX_SH_ODR_104Hz; fetched by lsm6dsox_hub_get)
+  *
+  * @param  slave	read-only pointer to slave description
+  * @retval imu status type
+  */
+imu_status_t lsm6dsox_hub_attach(const lsm6dsox_hub_slave_t *slave) {
+	if ((dev_ctx->read_reg == NULL) || (slave->len == 0U) || (slave->len > LSM6DSOX_HUB_DATA_LEN))
+		return LSM6DSOX_ERROR_FATAL;
+
+	lsm6dsox_sh_pin_mode_set(dev_ctx, LSM6DSOX_INTERNAL_PULL_UP);
+	lsm6dsox_sh_slv0_cfg_read(dev_ctx, &(lsm6dsox_sh_cfg_read_t){.slv_add = slave->addr,
+																   .slv_subadd = slave->reg,
+																   .slv_len = slave->len});
+	lsm6dsox_sh_slave_connected_set(dev_ctx, LSM6DSOX_SLV_0);
+	lsm6dsox_sh_data_rate_set(dev_ctx, LSM6DSOX_SH_ODR_104Hz);
+	lsm6dsox_sh_batch_slave_0_set(dev_ctx, PROPERTY_ENABLE);
+	lsm6dsox_sh_master_set(dev_ctx, PROPERTY_ENABLE);
+
+	memset(hub_data, 0, sizeof(hub_data));
+	hub_fresh = false;
+	hub_attached = true;
+	fifo_restart(&devs[LSM6DSOX_PRIMARY]);
+
+	return LSM6DSOX_OK;
+}
+
+/**
+  * @brief stops the sensor hub reads
+  *
+  * @retval None
+  */
+void lsm6dsox_hub_detach(void) {
+	if (!hub_attached)
+		return;
+
+	lsm6dsox_sh_master_set(dev_ctx, PROPERTY_DISABLE);
+	lsm6dsox_sh_batch_slave_0_set(dev_ctx, PROPERTY_DISABLE);
+	hub_attached = false;
+	hub_fresh = false;
+}
+
+/**
+  * @brief gets the newest sensor hub bytes (taken from the fifo by the last
+  * 	   imu read; no bus access)
+  *
+  * @param  buf		buffer to be filled (LSM6DSOX_HUB_DATA_LEN bytes)
+  * @retval boolean (true if new since the last call)
+  */
+bool lsm6dsox_hub_get(uint8_t buf[LSM6DSOX_HUB_DATA_LEN]) {
+	bool fresh = hub_fresh;
+
+	memcpy(buf, hub_data, LSM6DSOX_HUB_DATA_LEN);
+	hub_fresh = false;
+
+	return fresh;
+}
+
+/**
+  * @brief gets the number of sensor hub reads the slave nacked
+  *
+  * @retval nack count since init
+  */
+uint32_t lsm6dsox_hub_errors(void) {
+	return hub_errors;
+}
+
+/**
+  * @brief loads finite state machine programs into the embedded function
+  * 	   memory and starts them (init only; replaces any loaded before)
+  * 	   NOTE: the fsm odr must not exceed the accel / gyro odr
+  *
+  * @param  programs	read-only pointer to programs (programs[n] owns status bit n)
+  * @param	count		number of programs (1..LSM6DSOX_FSM_PROGRAMS_MAX)
+  * @param	odr			fsm sample rate
+  * @param	int1_mask	programs routed to the INT1 pin (bit n: programs[n]), latched
+  * 					active high until lsm6dsox_fsm_status reads them
+  *
+  * @retval imu status type
+  */
+imu_status_t lsm6dsox_fsm_load(const lsm6dsox_fsm_program_t *programs, uint8_t count, lsm6dsox_fsm_odr_t odr,
+							   uint16_t int1_mask) {
+	lsm6dsox_emb_fsm_enable_t enable = {0};
+	lsm6dsox_pin_int1_route_t route = {0};
+	lsm6dsox_emb_sens_t emb;
+	uint8_t buf[LSM6DSOX_FSM_PROGRAM_MAX];
+	uint8_t mask[2], int1[2];
+	uint16_t address = FSM_START_ADDRESS;
+	int32_t ret;
+
+	if ((dev_ctx->read_reg == NULL) || (count == 0U) || (count > LSM6DSOX_FSM_PROGRAMS_MAX))
+		return LSM6DSOX_ERROR_FATAL;
+
+	for (uint32_t i = 0; i < count; ++i) {
+		if ((programs[i].len == 0U) || (programs[i].len > LSM6DSOX_FSM_PROGRAM_MAX))
+			return LSM6DSOX_ERROR_FATAL;
+	}
+
+	mask[0] = (uint8_t) ((1UL << count) - 1U);
+	mask[1] = (uint8_t) (((1UL << count) - 1U) >> 8);
+	int1[0] = (uint8_t) (int1_mask & mask[0]);
+	int1[1] = (uint8_t) ((int1_mask >> 8) & mask[1]);
+
+	/* Stop the fsm while its memory is written */
+	ret = lsm6dsox_embedded_sens_get(dev_ctx, &emb);
+	emb.fsm = PROPERTY_DISABLE;
+	ret += lsm6dsox_embedded_sens_set(dev_ctx, &emb);
+	ret += lsm6dsox_fsm_enable_set(dev_ctx, &enable);
+
+	/* Programs back to back from the start address */
+	for (uint32_t i = 0; i < count; ++i) {
+		memcpy(buf, programs[i].bytes, programs[i].len);
+		ret += lsm6dsox_ln_pg_write(dev_ctx, address, buf, programs[i].len);
+		address += programs[i].len;
+	}
+
+	ret += lsm6dsox_fsm_number_of_programs_set(dev_ctx, count);
+	ret += lsm6dsox_fsm_start_address_set(dev_ctx, FSM_START_ADDRESS);
+	ret += lsm6dsox_fsm_data_rate_set(dev_ctx, odr);
+
+	/* Start: fsm on, programs enabled, then initialized from their reset pointers */
+	emb.fsm = PROPERTY_ENABLE;
+	ret += lsm6dsox_embedded_sens_set(dev_ctx, &emb);
+	memcpy(&enable.fsm_enable_a, &mask[0], 1U);
+	memcpy(&enable.fsm_enable_b, &mask[1], 1U);
+	ret += lsm6dsox_fsm_enable_set(dev_ctx, &enable);
+	ret += lsm6dsox_fsm_init_set(dev_ctx, PROPERTY_ENABLE);
+
+	/* INT1: latched, so the status read tells which program fired (and releases the pin) */
+	ret += lsm6dsox_interrupt_mode_set(dev_ctx, (lsm6dsox_int_mode_t){.emb_latched = PROPERTY_ENABLE});
+	route.fsm1 = ((int1[0] | int1[1]) != 0U);		// embedded function interrupt on INT1..
+	ret += lsm6dsox_pin_int1_route_set(dev_ctx, route);
+
+	ret += lsm6dsox_mem_bank_set(dev_ctx, LSM6DSOX_EMBEDDED_FUNC_BANK);
+	ret += lsm6dsox_write_reg(dev_ctx, LSM6DSOX_FSM_INT1_A, int1, sizeof(int1));		// ..for these programs
+	ret += lsm6dsox_mem_bank_set(dev_ctx, LSM6DSOX_USER_BANK);
+
+	return (ret == 0) ? LSM6DSOX_OK : LSM6DSOX_ERROR_FATAL;
+}
+
+/**
+  * @brief reads which finite state machine programs fired since the last
+  * 	   call (clears the latched status and releases the INT1 pin)
+  *
+  * @param  fired	filled with the programs that fired (bit n: programs[n] of the load)
+  * @retval imu status type
+  */
+imu_status_t lsm6dsox_fsm_status(uint16_t *fired) {
+	uint8_t status[2];
+
+	if (dev_ctx->read_reg == NULL)
+		return LSM6DSOX_ERROR_FATAL;
+
+	if (lsm6dsox_read_reg(dev_ctx, LSM6DSOX_FSM_STATUS_A_MAINPAGE, status, sizeof(status)) != 0)
+		return LSM6DSOX_ERROR_WARN;
+
+	*fired = (uint16_t) (status[0] | ((uint16_t) status[1] << 8));
+
+	return LSM6DSOX_OK;
+}
+
+/**
+  * @brief helper function to get the address a probe bus puts an instance at
+  * 	   (address 0: the instance's own)
+  */
+static uint8_t bus_address(const driver_bus_t *bus) {
+	return (bus->address != 0U) ? bus->address : devs[bus->instance].i2c_addr;
+}
+
+/**
+  * @brief probes for an lsm6dsox on a bus (WHO_AM_I read through a temporary
+  * 	   instance; neither the device nor the instance is written)
+  *
+  * @param  bus		read-only pointer to probe bus
+  * @retval driver score
+  */
+static uint8_t lsm6dsox_probe(const driver_bus_t *bus) {
+	lsm6dsox_dev_t probe_dev = {0};
+	uint8_t whoamI = 0U;
+
+	if (bus->instance >= LSM6DSOX_INSTANCES)
+		return DRIVER_SCORE_NONE;
+
+	probe_dev.handle = bus->handle;
+	probe_dev.i2c_addr = bus_address(bus);
+	probe_dev.bus = devs[bus->instance].bus;
+	probe_dev.ctx.read_reg = platform_read;
+	probe_dev.ctx.handle = &probe_dev;
+
+	if ((lsm6dsox_device_id_get(&probe_dev.ctx, &whoamI) != 0) || (whoamI != LSM6DSOX_ID))
+		return DRIVER_SCORE_NONE;
+
+	return DRIVER_SCORE_DETECTED;
+}
+
+/**
+  * @brief sets the probed bus as the platform bus of the instance (bound)
+  *
+  * @param  bus		read-only pointer to probe bus
+  * @retval None
+  */
+static void lsm6dsox_bind(const driver_bus_t *bus) {
+	lsm6dsox_set_platform((lsm6dsox_instance_t) bus->instance, bus->handle, bus_address(bus));
 }
 
 /*
- * @brief  LSM6DSOX IMU Interface Driver
+ * @brief  Instance Entry Points (the interface carries no instance)
+ */
+static lsm6dsox_interface_status_t primary_init(void) {
+	return lsm6dsox_init(&devs[LSM6DSOX_PRIMARY]);
+}
+
+static lsm6dsox_interface_status_t primary_deinit(void) {
+	return lsm6dsox_deinit(&devs[LSM6DSOX_PRIMARY]);
+}
+
+static lsm6dsox_interface_status_t primary_read(void *data) {
+	return lsm6dsox_read(&devs[LSM6DSOX_PRIMARY], data);
+}
+
+static lsm6dsox_interface_status_t secondary_init(void) {
+	return lsm6dsox_init(&devs[LSM6DSOX_SECONDARY]);
+}
+
+static lsm6dsox_interface_status_t secondary_deinit(void) {
+	return lsm6dsox_deinit(&devs[LSM6DSOX_SECONDARY]);
+}
+
+static lsm6dsox_interface_status_t secondary_read(void *data) {
+	return lsm6dsox_read(&devs[LSM6DSOX_SECONDARY], data);
+}
+
+/*
+ * @brief  LSM6DSOX IMU Interface Drivers
  */
 const imu_interface_t lsm6dsox_driver = {
-	.init = lsm6dsox_init,
-	.deinit = lsm6dsox_deinit,
-	.read = lsm6dsox_read
+	.init = primary_init,
+	.deinit = primary_deinit,
+	.read = primary_read
+};
+
+const imu_interface_t lsm6dsox_secondary_driver = {
+	.init = secondary_init,
+	.deinit = secondary_deinit,
+	.read = secondary_read
+};
+
+DRIVER_REGISTER(lsm6dsox_entry) = {
+	.name = "lsm6dsox",
+	.cls = DRIVER_CLASS_IMU,
+	.instances = LSM6DSOX_INSTANCES,
+	.probe = lsm6dsox_probe,
+	.bind = lsm6dsox_bind,
+	.interfaces = {&lsm6dsox_driver, &lsm6dsox_secondary_driver}
 };
@@ -0,0 +1,169 @@
+/*
+ * lsm6dsox_config.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include "sensors/imu/devices/lsm6dsox_config.h"
+
+/**
+  * @brief  Output / Batch Data Rates (register codes 1..10, shared by the odr
+  * 		and fifo batch rate settings)
+  */
+#define RATE_CODES				10U
+#define RATE_CODE_LPF1			6U			// first odr with a selectable gyro lpf1 (417 Hz)
+
+static const float rate_hz[RATE_CODES + 1U] = {
+	0.0f, 12.5f, 26.0f, 52.0f, 104.0f, 208.0f, 417.0f, 833.0f, 1667.0f, 3333.0f, 6667.0f
+};
+
+/**
+  * @brief  Gyro Bandwidth (LPF1 + LPF2, -3 dB)
+  *
+  * Below 417 Hz the bandwidth follows the odr alone; from 417 Hz up it is set
+  * by FTYPE. Only FTYPE 000..011 are used: the stronger settings cut into the
+  * control band at every loop rate the fifo can serve.
+  */
+#define GY_FTYPES				4U
+
+static const float gy_fixed_bw_hz[RATE_CODE_LPF1] = {0.0f, 4.3f, 8.3f, 16.7f, 33.0f, 67.0f};
+
+static const float gy_lpf1_bw_hz[RATE_CODES - RATE_CODE_LPF1 + 1U][GY_FTYPES] = {
+	{136.6f, 130.5f, 115.3f, 137.1f},	// 417 Hz
+	{239.2f, 192.4f, 148.4f, 281.8f},	// 833 Hz
+	{304.2f, 245.2f, 166.6f, 382.5f},	// 1667 Hz
+	{328.5f, 261.3f, 173.0f, 410.8f},	// 3333 Hz
+	{335.5f, 267.8f, 174.5f, 422.5f}	// 6667 Hz
+};
+
+/**
+  * @brief  Accel LPF2 Dividers (bandwidth = odr / divider)
+  */
+#define XL_DIVIDERS				7U
+
+static const struct {
+	lsm6dsox_hp_slope_xl_en_t setting;
+	float divider;
+} xl_lpf2[XL_DIVIDERS] = {
+	{LSM6DSOX_LP_ODR_DIV_10, 10.0f},
+	{LSM6DSOX_LP_ODR_DIV_20, 20.0f},
+	{LSM6DSOX_LP_ODR_DIV_45, 45.0f},
+	{LSM6DSOX_LP_ODR_DIV_100, 100.0f},
+	{LSM6DSOX_LP_ODR_DIV_200, 200.0f},
+	{LSM6DSOX_LP_ODR_DIV_400, 400.0f},
+	{LSM6DSOX_LP_ODR_DIV_800, 800.0f}
+};
+
+/**
+  * @brief  FIFO Words per Batch (gyro, accel, timestamp)
+  */
+#define FIFO_WORDS_PER_BATCH	3U
+#define FIFO_READ_LOOPS			4U			// unread loops tolerated before a stall is assumed
+
+
+/**
+  * @brief helper function to get the widest gyro bandwidth at an odr within
+  * 	   a limit
+  *
+  * @param  code	odr register code
+  * @param	limit	bandwidth limit (hz)
+  * @param	ftype	filled with the lpf1 setting (if selectable)
+  *
+  * @retval bandwidth (hz; 0 if none within the limit)
+  */
+static float gy_best_bw(uint32_t code, float limit, lsm6dsox_ftype_t *ftype) {
+	float best = 0.0f;
+
+	if (code < RATE_CODE_LPF1)
+		return (gy_fixed_bw_hz[code] <= limit) ? gy_fixed_bw_hz[code] : 0.0f;
+
+	for (uint32_t f = 0; f < GY_FTYPES; ++f) {
+		float bw = gy_lpf1_bw_hz[code - RATE_CODE_LPF1][f];
+
+		if ((bw <= limit) && (bw > best)) {
+			best = bw;
+			*ftype = (lsm6dsox_ftype_t) f;
+		}
+	}
+
+	return best;
+}
+
+/**
+  * @brief derives the odr, on-chip filters and fifo settings for a loop rate
+  * 	   (see lsm6dsox_config.h)
+  *
+  * @param  loop_hz			flight loop rate (LSM6DSOX_LOOP_HZ_MIN..LSM6DSOX_LOOP_HZ_MAX)
+  * @param	gy_cutoff_hz	widest gyro bandwidth wanted
+  * @param	xl_cutoff_hz	accel bandwidth wanted
+  * @param	cfg				configuration buffer to be filled
+  *
+  * @retval boolean (false if the loop rate is out of range; cfg untouched)
+  */
+bool lsm6dsox_derive_config(uint32_t loop_hz, float gy_cutoff_hz, float xl_cutoff_hz, lsm6dsox_config_t *cfg) {
+	float nyquist = 0.5f * (float) loop_hz;
+	float gy_limit = fminf(nyquist, gy_cutoff_hz);
+	float xl_err = INFINITY;
+	uint32_t odr = 0U, bdr = 1U, batches;
+	lsm6dsox_ftype_t ftype = LSM6DSOX_ULTRA_LIGHT;
+
+	if ((loop_hz < LSM6DSOX_LOOP_HZ_MIN) || (loop_hz > LSM6DSOX_LOOP_HZ_MAX))
+		return false;
+
+	/* Batch at the loop rate or just above: at most two batches per loop */
+	while (rate_hz[bdr] < (float) loop_hz)
+		bdr++;
+	batches = (uint32_t) ceilf(rate_hz[bdr] / (float) loop_hz);
+
+	/* Gyro: widest band within the limit, at the lowest odr that gives it */
+	cfg->gy_bw_hz = 0.0f;
+	for (uint32_t code = bdr; code <= RATE_CODES; ++code) {
+		lsm6dsox_ftype_t f = LSM6DSOX_ULTRA_LIGHT;
+		float bw = gy_best_bw(code, gy_limit, &f);
+
+		if (bw > cfg->gy_bw_hz) {
+			cfg->gy_bw_hz = bw;
+			odr = code;
+			ftype = f;
+		}
+	}
+
+	/* Nothing within the limit (cutoff below every band): narrowest at the batch rate */
+	if (odr == 0U) {
+		odr = bdr;
+		ftype = LSM6DSOX_LIGHT;
+		cfg->gy_bw_hz = (odr < RATE_CODE_LPF1) ? gy_fixed_bw_hz[odr] : gy_lpf1_bw_hz[odr - RATE_CODE_LPF1][ftype];
+	}
+
+	/* Accel: lpf2 divider closest to the cutoff (log scale), within the loop band */
+	cfg->xl_lpf2 = xl_lpf2[XL_DIVIDERS - 1U].setting;
+	cfg->xl_bw_hz = rate_hz[odr] / xl_lpf2[XL_DIVIDERS - 1U].divider;
+	for (uint32_t d = 0; d < XL_DIVIDERS; ++d) {
+		float bw = rate_hz[odr] / xl_lpf2[d].divider;
+		float err = fabsf(logf(bw / xl_cutoff_hz));
+
+		if ((bw <= nyquist) && (err < xl_err)) {
+			xl_err = err;
+			cfg->xl_lpf2 = xl_lpf2[d].setting;
+			cfg->xl_bw_hz = bw;
+		}
+	}
+
+	cfg->loop_hz = loop_hz;
+	cfg->odr_gy = (lsm6dsox_odr_g_t) odr;
+	cfg->odr_xl = (lsm6dsox_odr_xl_t) odr;
+	cfg->odr_hz = rate_hz[odr];
+	cfg->bdr_gy = (lsm6dsox_bdr_gy_t) bdr;
+	cfg->bdr_xl = (lsm6dsox_bdr_xl_t) bdr;
+	cfg->bdr_hz = rate_hz[bdr];
+	cfg->gy_lpf1 = (odr >= RATE_CODE_LPF1);
+	cfg->gy_ftype = ftype;
+	cfg->fifo_watermark = (uint16_t) (batches * FIFO_WORDS_PER_BATCH);
+	cfg->fifo_max_words = (uint16_t) (FIFO_READ_LOOPS * cfg->fifo_watermark);
+	if (cfg->fifo_max_words > LSM6DSOX_FIFO_WORDS_MAX)
+		cfg->fifo_max_words = LSM6DSOX_FIFO_WORDS_MAX;
+
+	return true;
+}
@@ -0,0 +1,128 @@
+/*
+ * lsm6dsox_fsm.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <string.h>
+#include "sensors/imu/devices/lsm6dsox_fsm.h"
+
+/**
+  * @brief  Program Header (AN5273 fixed data)
+  */
+#define CONFIG_A_NR_THRESH_1	0x40U		// [7:6] thresholds
+#define CONFIG_A_NR_MASK_1		0x10U		// [5:4] masks
+#define CONFIG_A_NR_STIMER_1	0x01U		// [1:0] short (8-bit) timers: TIMER3
+#define FIXED_LEN				6U			// config a, config b, size, settings, reset / program pointers
+
+/**
+  * @brief  Variable Data
+  */
+#define MASK_PLUS_V				0x02U		// +X -X +Y -Y +Z -Z +V -V
+#define TMASK_NONE				0x00U
+#define TIMER_COUNT_INIT		0x00U
+
+/**
+  * @brief  Instructions (reset condition << 4 | next condition; commands are a byte of their own)
+  */
+#define COND_NOP				0x0U
+#define COND_TI3				0x3U		// TIMER3 expired
+#define COND_GNTH1				0x5U		// masked axis above THRESH1
+#define COND_LNTH1				0x7U		// masked axis at or below THRESH1
+#define CMD_CONT				0x22U		// status bit + interrupt, back to the reset pointer
+
+#define INSTR(reset, next)		((uint8_t) (((reset) << 4) | (next)))
+
+/**
+  * @brief  Half Precision Float (IEEE 754 binary16)
+  */
+#define HALF_EXP_BIAS			15
+#define HALF_EXP_MAX			31
+#define HALF_INF				0x7C00U
+#define HALF_SIGN				0x8000U
+
+
+/**
+  * @brief converts to a half precision float, as the fsm thresholds are
+  * 	   stored (rounded to nearest; values below the normal range become
+  * 	   zero, values above it and nan infinity)
+  *
+  * @param  value	single precision value
+  * @retval half precision bits
+  */
+uint16_t lsm6dsox_fsm_half(float value) {
+	uint32_t bits, mant;
+	uint16_t sign;
+	int32_t exp;
+
+	memcpy(&bits, &value, sizeof(bits));
+	sign = (uint16_t) ((bits >> 16) & HALF_SIGN);
+	exp = (int32_t) ((bits >> 23) & 0xFFU) - 127 + HALF_EXP_BIAS;
+	mant = bits & 0x007FFFFFU;
+
+	if (exp <= 0)
+		return sign;
+
+	if (exp >= HALF_EXP_MAX)
+		return (uint16_t) (sign | HALF_INF);
+
+	/* A carry out of the mantissa steps the exponent, which is the right result */
+	return (uint16_t) (sign | ((((uint32_t) exp << 10) | (mant >> 13)) + ((mant >> 12) & 0x01U)));
+}
+
+/**
+  * @brief builds a program that fires when the norm of a sensor's vector
+  * 	   crosses a threshold and stays across it (see lsm6dsox_fsm.h)
+  *
+  * @param  prog		program buffer to be filled
+  * @param	input		sensor (accel in g, gyro in dps)
+  * @param	above		true: fires above the threshold, false: at or below it
+  * @param	threshold	norm threshold (> 0)
+  * @param	samples		fsm samples the norm must stay across after the crossing
+  * 					(0: fires on the crossing sample)
+  *
+  * @retval boolean (false if the threshold is not a positive number; prog untouched)
+  */
+bool lsm6dsox_fsm_norm_program(lsm6dsox_fsm_program_t *prog, lsm6dsox_fsm_input_t input, bool above,
+							   float threshold, uint8_t samples) {
+	uint8_t enter = above ? COND_GNTH1 : COND_LNTH1;
+	uint8_t leave = above ? COND_LNTH1 : COND_GNTH1;
+	uint16_t thresh;
+	uint8_t *p = prog->bytes;
+	uint8_t len = FIXED_LEN;
+
+	if (!(threshold > 0.0f) || isinf(threshold))
+		return false;
+
+	thresh = lsm6dsox_fsm_half(threshold);
+
+	/* Variable data: THRESH1, MASKA / TMASKA, then TC and TIMER3 if held */
+	p[len++] = (uint8_t) thresh;
+	p[len++] = (uint8_t) (thresh >> 8);
+	p[len++] = MASK_PLUS_V;
+	p[len++] = TMASK_NONE;
+	if (samples) {
+		p[len++] = TIMER_COUNT_INIT;
+		p[len++] = samples;
+	}
+
+	/* Instructions: wait for the crossing, [hold it for TIMER3 (a step back resets)], fire */
+	p[len++] = INSTR(COND_NOP, enter);
+	if (samples)
+		p[len++] = INSTR(leave, COND_TI3);
+	p[len++] = CMD_CONT;
+
+	/* Fixed data: reset and program pointers start at zero (set by the fsm init) */
+	p[0] = CONFIG_A_NR_THRESH_1 | CONFIG_A_NR_MASK_1 | (samples ? CONFIG_A_NR_STIMER_1 : 0x00U);
+	p[1] = 0x00U;
+	p[2] = len;
+	p[3] = (uint8_t) input;		// MASKA, unsigned
+	p[4] = 0x00U;
+	p[5] = 0x00U;
+
+	prog->len = len;
+
+	return true;
+}
@@ -6,14 +6,30 @@
  */
 
 #include "sensors/imu/imu.h"
+#include "sensors/imu/imu_vote.h"
 #include "sensors/imu/devices/lsm6dsox.h"
+#include "lsm6dsox_reg.h"
 #include "common/hardware.h"
 #include "common/settings.h"
+#include "system/driver_registry.h"
 
 /*
- * @brief  IMU Device Config Setting(s)
+ * @brief  IMU Count Config Setting
  */
-#define IMU_DEVICE				CONFIG_IMU_DEVICE
+#define IMU_COUNT				CONFIG_IMU_COUNT
+
+/*
+ * @brief  IMU Voting Config Settings (ms in loops of the configured rate)
+ */
+#define IMU_LOOP_RATE_HZ		CONFIG_IMU_LOOP_RATE_HZ
+#define IMU_VOTE_GY_TOL_DPS		CONFIG_IMU_VOTE_GY_TOL_DPS
+#define IMU_VOTE_XL_TOL_G		CONFIG_IMU_VOTE_XL_TOL_G
+#define IMU_VOTE_FAULT_LOOPS	((CONFIG_IMU_VOTE_FAULT_MS * IMU_LOOP_RATE_HZ + 999U) / 1000U)
+#define IMU_STUCK_LOOPS			((CONFIG_IMU_STUCK_MS * IMU_LOOP_RATE_HZ + 999U) / 1000U)
+
+#if (IMU_COUNT < 1U) || (IMU_COUNT > LSM6DSOX_INSTANCES)
+	#error "Invalid IMU Count Configuration"
+#endif
 
 /*
  * @brief  LPF Config Settings
@@ -43,9 +59,42 @@ const I2C_HandleTypeDef* phi2c = NULL;
 const void* platform_handle = NULL;
 
 /**
-  * @brief  imu driver pointer for imu device interface
+  * @brief  IMU Instance Type
   */
-static const imu_interface_t *imu_driver = NULL;
+typedef struct {
+	I2C_TypeDef *i2c;
+	uint8_t i2c_addr;
+} imu_instance_t;
+
+/**
+  * @brief  IMU Instances (the primary carries the sensor hub and crash
+  * 		detection; the secondary shares its bus until a second i2c is
+  * 		set up in the .ioc)
+  */
+static const imu_instance_t instances[LSM6DSOX_INSTANCES] = {
+	{IMU_I2C_PERIPHERAL, LSM6DSOX_I2C_ADD_L},
+	{IMU_I2C_PERIPHERAL, LSM6DSOX_I2C_ADD_H}
+};
+
+/**
+  * @brief  Bound Drivers (by instance; NULL: nothing detected)
+  */
+static const imu_interface_t *drivers[IMU_COUNT];
+
+/**
+  * @brief  IMU Voting State
+  */
+static const imu_vote_config_t vote_cfg = {
+	.gy_tol_mdps = IMU_VOTE_GY_TOL_DPS * 1000.0f,
+	.xl_tol_mg = IMU_VOTE_XL_TOL_G * 1000.0f,
+	.fault_loops = IMU_VOTE_FAULT_LOOPS,
+	.stuck_loops = IMU_STUCK_LOOPS
+};
+
+static imu_vote_t vote;
+static imu_6D_t samples[IMU_COUNT];
+static uint8_t imu_count = 0U;		// instances set up by init (0: none)
+static uint8_t read_first = 0U;		// rotates the read order
 
 
 /**
@@ -85,11 +134,15 @@ static SPI_HandleTypeDef* Get_IMU_SPI_Handle(SPI_TypeDef* spi) {
  */
 
 /*
- * @brief imu API call to init imu interface (protocol + device)
+ * @brief imu API call to init imu interface (protocol + devices)
  *
- * @retval imu status type
+ * @retval imu status type (WARN if a redundant imu did not come up, FATAL if
+ * 		   none did)
  */
 imu_status_t imu_init(void) {
+	imu_status_t status = IMU_OK;
+	uint32_t online = 0U;
+
 	#if IMU_COMM_PROTOCOL == IMU_I2C_PROTOCOL_ID
 		phi2c = Get_IMU_I2C_Handle(IMU_I2C_PERIPHERAL);
 		platform_handle = phi2c;
@@ -97,19 +150,32 @@ imu_status_t imu_init(void) {
 		#error "Invalid IMU Communication Protocol Configuration"
 	#endif
 
-	#if IMU_DEVICE == LSM6DSOX_DEVICE_ID
-		imu_driver = &lsm6dsox_driver;
-	#else
-		#error "Invalid IMU Device Configuration"
-	#endif
-
 	if (platform_handle == NULL)
 		return IMU_ERROR_FATAL;
 
-	if (!valid_sensor_driver(imu_driver))
-		return IMU_ERROR_FATAL;
+	/* Bind each instance to the driver detected at its address; one with
+	 * nothing there is offline (the voter runs without it) */
+	for (uint32_t i = 0; i < IMU_COUNT; ++i) {
+		const driver_bus_t bus = {
+			.handle = Get_IMU_I2C_Handle(instances[i].i2c),
+			.address = instances[i].i2c_addr,
+			.instance = (uint8_t) i
+		};
+		const driver_entry_t *entry = driver_bind(DRIVER_CLASS_IMU, &bus);
+
+		drivers[i] = entry ? entry->interfaces[i] : NULL;
+
+		if (valid_sensor_driver(drivers[i]) && (drivers[i]->init() == IMU_OK))
+			online |= 1UL << i;
+		else
+			status = IMU_ERROR_WARN;
+	}
 
-	return imu_driver->init();
+	imu_vote_init(&vote, &vote_cfg, IMU_COUNT, online);
+	imu_count = IMU_COUNT;
+	read_first = 0U;
+
+	return (online != 0U) ? status : IMU_ERROR_FATAL;
 }
 
 /*
@@ -118,30 +184,49 @@ imu_status_t imu_init(void) {
  * @retval imu status type
  */
 imu_status_t imu_deinit(void) {
-	if (!imu_driver)
+	if (imu_count == 0U)
 		return IMU_ERROR_WARN;
 
 	platform_handle = NULL;
 
-	imu_driver->deinit();
-	imu_driver = NULL;
+	for (uint32_t i = 0; i < imu_count; ++i) {
+		if (drivers[i])
+			drivers[i]->deinit();
+		drivers[i] = NULL;
+	}
+
+	imu_count = 0U;
 
 	return IMU_OK;
 }
 
 /*
- * @brief imu API call to read values from sensor
+ * @brief imu API call to read values from sensors (voted into one)
+ * 		  NOTE: the read order rotates every call, so no instance's sample is
+ * 		  always the oldest (the sensors run on their own clocks)
  *
  * @param  data		generic pointer to sensor handle
  * @retval imu status type
  */
 imu_status_t imu_read(void *data) {
+	imu_status_t read_status[IMU_COUNT];
 	imu_status_t status;
 
-	if (!imu_driver)
+	if (imu_count == 0U)
 		return IMU_ERROR_FATAL;
 
-	status = imu_driver->read(data);
+	for (uint32_t k = 0; k < imu_count; ++k) {
+		uint32_t i = (read_first + k) % imu_count;
+
+		/* Failed and offline instances cost no bus time */
+		if (vote.stats[i].state == IMU_INSTANCE_OK)
+			read_status[i] = drivers[i]->read(&samples[i]);
+		else
+			read_status[i] = IMU_ERROR_FATAL;
+	}
+	read_first = (uint8_t) ((read_first + 1U) % imu_count);
+
+	status = imu_vote_update(&vote, samples, read_status, (imu_6D_t*) data);
 
 	/*
 	 #if IMU_CALIBRATE_DATA == ENABLED
@@ -161,3 +246,47 @@ imu_status_t imu_read(void *data) {
 
 	return status;
 }
+
+/*
+ * @brief imu API call to get the instances set up by init
+ *
+ * @retval instances (0 before init)
+ */
+uint8_t imu_get_count(void) {
+	return imu_count;
+}
+
+/*
+ * @brief imu API call to get the instance the voted dt comes from
+ *
+ * @retval instance
+ */
+uint8_t imu_get_primary(void) {
+	return vote.primary;
+}
+
+/*
+ * @brief imu API call to get the primary changes since init
+ *
+ * @retval failovers
+ */
+uint32_t imu_get_failovers(void) {
+	return vote.failovers;
+}
+
+/*
+ * @brief imu API call to get the health stats of an instance
+ *
+ * @param  instance		instance (< imu_get_count())
+ * @param  out			pointer to stats to be filled
+ *
+ * @retval boolean (false if no such instance)
+ */
+bool imu_get_stats(uint8_t instance, imu_instance_stats_t *out) {
+	if (instance >= imu_count)
+		return false;
+
+	*out = vote.stats[instance];
+
+	return true;
+}
@@ -0,0 +1,282 @@
+/*
+ * imu_vote.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <string.h>
+#include "sensors/imu/imu_vote.h"
+
+/*
+ * @brief  Axis Layout (accel x/y/z in mg, then rates x/y/z in mdps)
+ */
+#define XL_FIRST				0U
+#define GY_FIRST				3U
+
+
+/**
+  * @brief init a voter (instances in the online mask are usable, the others
+  * 	   offline)
+  *
+  * @param  v				pointer to voter
+  * @param	cfg				read-only pointer to config
+  * @param	count			instances (up to IMU_VOTE_INSTANCES_MAX)
+  * @param	online_mask		bit n set: instance n came up
+  *
+  * @retval None
+  */
+void imu_vote_init(imu_vote_t *v, const imu_vote_config_t *cfg, uint8_t count, uint32_t online_mask) {
+	memset(v, 0, sizeof(*v));
+	v->cfg = *cfg;
+	v->count = (count > IMU_VOTE_INSTANCES_MAX) ? IMU_VOTE_INSTANCES_MAX : count;
+
+	for (uint8_t i = 0; i < v->count; ++i)
+		v->stats[i].state = (online_mask & (1UL << i)) ? IMU_INSTANCE_OK : IMU_INSTANCE_OFFLINE;
+
+	for (uint8_t i = v->count; i > 0U; --i) {
+		if (v->stats[i - 1U].state == IMU_INSTANCE_OK)
+			v->primary = i - 1U;
+	}
+}
+
+/**
+  * @brief helper function to get the six axes of a sample
+  *
+  * @retval None
+  */
+static void get_axes(const imu_6D_t *s, float axes[IMU_VOTE_AXES]) {
+	axes[0] = s->accel_x;
+	axes[1] = s->accel_y;
+	axes[2] = s->accel_z;
+	axes[3] = s->rate_x;
+	axes[4] = s->rate_y;
+	axes[5] = s->rate_z;
+}
+
+/**
+  * @brief helper function to count the instances not failed or offline
+  *
+  * @retval instances
+  */
+static uint8_t instances_ok(const imu_vote_t *v) {
+	uint8_t n = 0U;
+
+	for (uint8_t i = 0; i < v->count; ++i) {
+		if (v->stats[i].state == IMU_INSTANCE_OK)
+			n++;
+	}
+
+	return n;
+}
+
+/**
+  * @brief helper function to fail an instance (the last one left is kept)
+  *
+  * @retval boolean (true if failed)
+  */
+static bool fail_instance(imu_vote_t *v, uint8_t i, imu_instance_fault_t fault) {
+	v->stats[i].fault = fault;
+
+	if (instances_ok(v) <= 1U)
+		return false;
+
+	v->stats[i].state = IMU_INSTANCE_FAILED;
+	return true;
+}
+
+/**
+  * @brief helper function to move the primary to the lowest instance left
+  * 	   once it failed
+  *
+  * @retval None
+  */
+static void select_primary(imu_vote_t *v) {
+	if (v->stats[v->primary].state == IMU_INSTANCE_OK)
+		return;
+
+	for (uint8_t i = 0; i < v->count; ++i) {
+		if (v->stats[i].state == IMU_INSTANCE_OK) {
+			v->primary = i;
+			v->failovers++;
+			return;
+		}
+	}
+}
+
+/**
+  * @brief helper function to get the usable sample of the primary (of the
+  * 	   first usable instance still in service if the primary has none)
+  *
+  * @retval index into usable
+  */
+static uint8_t primary_sample(const imu_vote_t *v, const uint8_t usable[], uint8_t n) {
+	for (uint8_t k = 0; k < n; ++k) {
+		if (usable[k] == v->primary)
+			return k;
+	}
+
+	for (uint8_t k = 0; k < n; ++k) {
+		if (v->stats[usable[k]].state == IMU_INSTANCE_OK)
+			return k;
+	}
+
+	return 0U;
+}
+
+/**
+  * @brief helper function to track repeated samples
+  *
+  * @retval boolean (true once repeated for stuck_loops)
+  */
+static bool stuck(imu_vote_t *v, uint8_t i, const imu_6D_t *s) {
+	const imu_6D_t *p = &v->prev[i];
+	bool same = v->have_prev[i] &&
+				(s->accel_x == p->accel_x) && (s->accel_y == p->accel_y) && (s->accel_z == p->accel_z) &&
+				(s->rate_x == p->rate_x) && (s->rate_y == p->rate_y) && (s->rate_z == p->rate_z);
+
+	v->prev[i] = *s;
+	v->have_prev[i] = true;
+	v->stuck_run[i] = same ? (v->stuck_run[i] + 1U) : 0U;
+
+	if (v->stuck_run[i] < v->cfg.stuck_loops)
+		return false;
+
+	v->stuck_run[i] = 0U;
+	return true;
+}
+
+/**
+  * @brief helper function to get the median of three
+  *
+  * @retval median
+  */
+static float median3(float a, float b, float c) {
+	return fmaxf(fminf(a, b), fminf(fmaxf(a, b), c));
+}
+
+/**
+  * @brief helper function to get the largest axis deviation in a range
+  *
+  * @retval deviation
+  */
+static float deviation(const float a[IMU_VOTE_AXES], const float b[IMU_VOTE_AXES], uint32_t first) {
+	float dev = 0.0f;
+
+	for (uint32_t k = first; k < first + 3U; ++k)
+		dev = fmaxf(dev, fabsf(a[k] - b[k]));
+
+	return dev;
+}
+
+/**
+  * @brief votes the instance samples of one loop into one
+  *
+  * @param  v			pointer to voter
+  * @param	samples		instance samples (indexed by instance)
+  * @param	status		instance read status (indexed by instance)
+  * @param	out			pointer to voted sample (unchanged when nothing is usable)
+  *
+  * @retval imu status type (WARN on a read error, a fault or a disagreement;
+  * 		FATAL when no instance is online)
+  */
+imu_status_t imu_vote_update(imu_vote_t *v, const imu_6D_t samples[], const imu_status_t status[], imu_6D_t *out) {
+	float axes[IMU_VOTE_INSTANCES_MAX][IMU_VOTE_AXES];
+	float voted[IMU_VOTE_AXES];
+	uint8_t usable[IMU_VOTE_INSTANCES_MAX];
+	uint8_t n = 0U;
+	uint8_t ref;
+	bool event = false;
+
+	/* Read errors and stuck samples */
+	for (uint8_t i = 0; i < v->count; ++i) {
+		imu_instance_stats_t *s = &v->stats[i];
+
+		if (s->state != IMU_INSTANCE_OK)
+			continue;
+
+		s->reads++;
+
+		if (status[i] != IMU_OK) {
+			s->read_errors++;
+			event = true;
+			if (++v->error_run[i] >= v->cfg.fault_loops) {
+				v->error_run[i] = 0U;
+				fail_instance(v, i, IMU_FAULT_READ);
+			}
+			continue;
+		}
+		v->error_run[i] = 0U;
+
+		if (stuck(v, i, &samples[i])) {
+			event = true;
+			if (fail_instance(v, i, IMU_FAULT_STUCK))
+				continue;
+		}
+
+		get_axes(&samples[i], axes[n]);
+		usable[n++] = i;
+	}
+
+	select_primary(v);
+
+	/* Nothing read this loop: the output holds (FATAL if none is left at all) */
+	if (n == 0U)
+		return (instances_ok(v) > 0U) ? IMU_ERROR_WARN : IMU_ERROR_FATAL;
+
+	/* Primary's sample if usable (tie-break) */
+	ref = primary_sample(v, usable, n);
+
+	/* Vote */
+	if (n >= 3U) {
+		for (uint32_t a = 0; a < IMU_VOTE_AXES; ++a)
+			voted[a] = median3(axes[0][a], axes[1][a], axes[2][a]);
+
+	} else if ((n == 2U) && (deviation(axes[0], axes[1], GY_FIRST) <= v->cfg.gy_tol_mdps) &&
+			   (deviation(axes[0], axes[1], XL_FIRST) <= v->cfg.xl_tol_mg)) {
+		for (uint32_t a = 0; a < IMU_VOTE_AXES; ++a)
+			voted[a] = 0.5f * (axes[0][a] + axes[1][a]);
+
+	} else {
+		memcpy(voted, axes[ref], sizeof(voted));
+	}
+
+	/* Deviations from the vote (divergence can only be told with three) */
+	for (uint8_t k = 0; k < n; ++k) {
+		uint8_t i = usable[k];
+		imu_instance_stats_t *s = &v->stats[i];
+
+		s->gy_dev_mdps = deviation(axes[k], voted, GY_FIRST);
+		s->xl_dev_mg = deviation(axes[k], voted, XL_FIRST);
+		s->gy_dev_max_mdps = fmaxf(s->gy_dev_max_mdps, s->gy_dev_mdps);
+		s->xl_dev_max_mg = fmaxf(s->xl_dev_max_mg, s->xl_dev_mg);
+
+		if ((s->gy_dev_mdps <= v->cfg.gy_tol_mdps) && (s->xl_dev_mg <= v->cfg.xl_tol_mg)) {
+			v->diverge_run[i] = 0U;
+			continue;
+		}
+
+		s->disagreements++;
+		event = true;
+
+		if ((n >= 3U) && (++v->diverge_run[i] >= v->cfg.fault_loops)) {
+			v->diverge_run[i] = 0U;
+			fail_instance(v, i, IMU_FAULT_DIVERGED);
+		}
+	}
+
+	/* Primary voted out above: dt from the one taking over */
+	select_primary(v);
+	ref = primary_sample(v, usable, n);
+
+	out->accel_x = voted[0];
+	out->accel_y = voted[1];
+	out->accel_z = voted[2];
+	out->rate_x = voted[3];
+	out->rate_y = voted[4];
+	out->rate_z = voted[5];
+	out->dt = samples[usable[ref]].dt;
+
+	return event ? IMU_ERROR_WARN : IMU_OK;
+}
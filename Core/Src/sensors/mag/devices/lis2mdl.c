@@ -0,0 +1,136 @@
+/*
+ * lis2mdl.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include "sensors/mag/devices/lis2mdl.h"
+#include "sensors/imu/devices/lsm6dsox.h"
+#include "common/time.h"
+
+/*
+ * @brief  Soft Reset Time (ms, init only)
+ */
+#define LIS2MDL_RESET_MS		5U
+
+/*
+ * @brief  Stale Data Limit (~100 ms of flight loops without a hub sample)
+ */
+#define LIS2MDL_STALE_READS		42U
+
+/*
+ * @brief  Mag Status Type Alias
+ */
+#define LIS2MDL_OK				MAG_OK
+#define LIS2MDL_ERROR_WARN		MAG_ERROR_WARN
+#define LIS2MDL_ERROR_FATAL		MAG_ERROR_FATAL
+
+typedef mag_status_t lis2mdl_interface_status_t;
+
+/*
+ * @brief  Device State
+ */
+static uint32_t stale_reads;
+static uint32_t hub_errors;
+
+
+/**
+  * @brief helper function to write a device register through the sensor hub
+  *
+  * @retval boolean
+  */
+static bool write_reg(uint8_t reg, uint8_t value) {
+	return lsm6dsox_hub_write(LIS2MDL_I2C_ADD_7BIT, reg, value) == IMU_OK;
+}
+
+/**
+  * @brief lis2mdl configuration & setup (through one-shot hub transactions),
+  * 	   then hands the device to the hub for continuous reads
+  *
+  * @retval lis2mdl status type (FATAL if absent)
+  */
+static lis2mdl_interface_status_t lis2mdl_init(void) {
+	uint8_t id = 0U;
+	bool ok;
+
+	stale_reads = 0U;
+	hub_errors = lsm6dsox_hub_errors();
+
+	/* Check device ID */
+	if ((lsm6dsox_hub_read(LIS2MDL_I2C_ADD_7BIT, LIS2MDL_REG_WHO_AM_I, &id, 1U) != IMU_OK) || (id != LIS2MDL_ID))
+		return LIS2MDL_ERROR_FATAL;
+
+	/* Restore default configuration */
+	ok = write_reg(LIS2MDL_REG_CFG_A, LIS2MDL_CFG_A_SOFT_RST);
+	delay_ms(LIS2MDL_RESET_MS);
+
+	/* Continuous conversions with temperature compensation and block data update */
+	ok &= write_reg(LIS2MDL_REG_CFG_B, LIS2MDL_CFG_B_VALUE);
+	ok &= write_reg(LIS2MDL_REG_CFG_C, LIS2MDL_CFG_C_VALUE);
+	ok &= write_reg(LIS2MDL_REG_CFG_A, LIS2MDL_CFG_A_VALUE);
+
+	if (!ok)
+		return LIS2MDL_ERROR_FATAL;
+
+	/* Output registers read by the hub into the imu fifo from here on */
+	if (lsm6dsox_hub_attach(&(lsm6dsox_hub_slave_t){.addr = LIS2MDL_I2C_ADD_7BIT,
+													.reg = LIS2MDL_REG_OUTX_L,
+													.len = LIS2MDL_DATA_SIZE}) != IMU_OK)
+		return LIS2MDL_ERROR_FATAL;
+
+	return LIS2MDL_OK;
+}
+
+/**
+  * @brief lis2mdl deinit (hub reads stop, the device keeps converting)
+  *
+  * @retval lis2mdl status type
+  */
+static lis2mdl_interface_status_t lis2mdl_deinit(void) {
+	lsm6dsox_hub_detach();
+
+	return LIS2MDL_OK;
+}
+
+/*
+ * @brief	get the newest field sample in mG (as brought by the last imu read;
+ * 			no bus access)
+ *
+ * @param	data	generic sensor handle pointer to store updated measurements
+ * @retval	lis2mdl status type (WARN on a hub nack, or once per stall)
+ */
+static lis2mdl_interface_status_t lis2mdl_read(void *data) {
+	mag_data_t *mag = (mag_data_t*) data;
+	lis2mdl_interface_status_t status = LIS2MDL_OK;
+	uint8_t raw[LSM6DSOX_HUB_DATA_LEN];
+	uint32_t errors = lsm6dsox_hub_errors();
+
+	if (errors != hub_errors) {
+		hub_errors = errors;
+		status = LIS2MDL_ERROR_WARN;
+	}
+
+	mag->fresh = lsm6dsox_hub_get(raw);
+	if (!mag->fresh) {
+		if (++stale_reads == LIS2MDL_STALE_READS)
+			status = LIS2MDL_ERROR_WARN;
+
+		return status;
+	}
+
+	stale_reads = 0U;
+	for (uint32_t i = 0; i < 3U; ++i)
+		mag->raw_mgauss[i] = (float) (int16_t) ((uint16_t) raw[2U * i] | ((uint16_t) raw[2U * i + 1U] << 8)) * LIS2MDL_MGAUSS_PER_LSB;
+
+	return status;
+}
+
+/*
+ * @brief  LIS2MDL Mag Interface Driver
+ */
+const mag_interface_t lis2mdl_driver = {
+	.init = lis2mdl_init,
+	.deinit = lis2mdl_deinit,
+	.read = lis2mdl_read
+};
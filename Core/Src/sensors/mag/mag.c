@@ -0,0 +1,262 @@
+/*
+ * mag.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "sensors/mag/mag.h"
+#include "params/params.h"
+#include "common/memory.h"
+#include "common/time.h"
+#include "common/settings.h"
+
+/*
+ * @brief  Mag Device Config Setting(s)
+ */
+#define MAG_DEVICE				CONFIG_MAG_DEVICE
+
+#if MAG_DEVICE == LIS2MDL_DEVICE_ID
+	#include "sensors/mag/devices/lis2mdl.h"	// read through the lsm6dsox sensor hub
+#elif MAG_DEVICE == MAG_SIM_DEVICE_ID
+	#include "sensors/mag/devices/sim_mag.h"
+#endif
+
+/*
+ * @brief  Calibration Session Length
+ */
+#define MAG_CAL_DURATION_S		CONFIG_MAG_CAL_DURATION_S
+#define MAG_CAL_MAX_DURATION_S	300U
+
+/**
+  * @brief  mag driver pointer for mag device interface
+  */
+static const mag_interface_t *mag_driver = NULL;
+
+/**
+  * @brief  Runtime Parameter Cache (refreshed on change notification)
+  */
+static mag_calibration_t calibration CCM_BSS;
+
+/**
+  * @brief  Calibration Session
+  */
+static mag_cal_t session;
+static mag_cal_report_t report;
+static uint32_t session_start_ms;
+static uint32_t session_duration_ms;
+
+
+/**
+  * @brief helper function to refresh the cached calibration
+  *
+  * @retval None
+  */
+static void load_mag_params(void) {
+	calibration.offset_mgauss[0] = params_get_float(PARAM_MAG_OFFSET_X);
+	calibration.offset_mgauss[1] = params_get_float(PARAM_MAG_OFFSET_Y);
+	calibration.offset_mgauss[2] = params_get_float(PARAM_MAG_OFFSET_Z);
+
+	calibration.soft_iron[0][0] = params_get_float(PARAM_MAG_SOFT_XX);
+	calibration.soft_iron[1][1] = params_get_float(PARAM_MAG_SOFT_YY);
+	calibration.soft_iron[2][2] = params_get_float(PARAM_MAG_SOFT_ZZ);
+	calibration.soft_iron[0][1] = calibration.soft_iron[1][0] = params_get_float(PARAM_MAG_SOFT_XY);
+	calibration.soft_iron[0][2] = calibration.soft_iron[2][0] = params_get_float(PARAM_MAG_SOFT_XZ);
+	calibration.soft_iron[1][2] = calibration.soft_iron[2][1] = params_get_float(PARAM_MAG_SOFT_YZ);
+}
+
+/**
+  * @brief parameter change listener
+  *
+  * @param  id		changed parameter id
+  * @retval None
+  */
+static void on_param_change(param_id_t id) {
+	(void) id;
+	load_mag_params();
+}
+
+/**
+  * @brief helper function to store a fitted calibration in the parameters
+  * 	   (the listener then loads it)
+  *
+  * @param  cal		read-only pointer to calibration
+  * @retval boolean (false if a value was out of its parameter range)
+  */
+static bool store_calibration(const mag_calibration_t *cal) {
+	const struct {
+		param_id_t id;
+		float value;
+	} values[] = {
+		{PARAM_MAG_OFFSET_X, cal->offset_mgauss[0]},
+		{PARAM_MAG_OFFSET_Y, cal->offset_mgauss[1]},
+		{PARAM_MAG_OFFSET_Z, cal->offset_mgauss[2]},
+		{PARAM_MAG_SOFT_XX, cal->soft_iron[0][0]},
+		{PARAM_MAG_SOFT_XY, cal->soft_iron[0][1]},
+		{PARAM_MAG_SOFT_XZ, cal->soft_iron[0][2]},
+		{PARAM_MAG_SOFT_YY, cal->soft_iron[1][1]},
+		{PARAM_MAG_SOFT_YZ, cal->soft_iron[1][2]},
+		{PARAM_MAG_SOFT_ZZ, cal->soft_iron[2][2]}
+	};
+
+	/* All or nothing: check the ranges first */
+	for (uint32_t i = 0; i < (sizeof(values) / sizeof(values[0])); ++i) {
+		const param_def_t *def = params_get_def(values[i].id);
+
+		if ((values[i].value < def->min) || (values[i].value > def->max))
+			return false;
+	}
+
+	for (uint32_t i = 0; i < (sizeof(values) / sizeof(values[0])); ++i)
+		params_set(values[i].id, values[i].value);
+
+	return true;
+}
+
+/**
+  * @brief helper function to run the calibration session: collects raw
+  * 	   readings, then fits and stores them once the time is up
+  *
+  * @param  mag		read-only pointer to mag data handle
+  * @retval None
+  */
+static void calibration_service(const mag_data_t *mag) {
+	if (mag->fresh)
+		mag_cal_add(&session, mag->raw_mgauss);
+
+	if ((millis() - session_start_ms) < session_duration_ms)
+		return;
+
+	report.result = mag_cal_solve(&session, &report.fit);
+	if ((report.result == MAG_CAL_OK) && store_calibration(&report.fit.cal))
+		report.state = MAG_CAL_STATE_DONE;
+	else
+		report.state = MAG_CAL_STATE_FAILED;
+}
+
+/*
+ * @brief mag API call to init mag interface (device; calibration from the
+ * 		  parameters)
+ * 		  NOTE: call after imu_init (the device sits behind the imu)
+ *
+ * @retval mag status type
+ */
+mag_status_t mag_init(void) {
+	const mag_interface_t *driver;
+	mag_status_t status;
+
+	mag_driver = NULL;
+	memset(&report, 0, sizeof(report));
+
+	load_mag_params();
+	params_subscribe(PARAM_GROUP_MAG, on_param_change);
+
+	#if MAG_DEVICE == LIS2MDL_DEVICE_ID
+		driver = &lis2mdl_driver;
+	#elif MAG_DEVICE == MAG_SIM_DEVICE_ID
+		driver = &sim_mag_driver;
+	#else
+		#error "Invalid Mag Device Configuration"
+	#endif
+
+	if (!valid_sensor_driver(driver))
+		return MAG_ERROR_FATAL;
+
+	/* Absent or failed device is reported once, here; reads then stay empty */
+	status = driver->init();
+	if (status == MAG_OK)
+		mag_driver = driver;
+
+	return status;
+}
+
+/*
+ * @brief mag API call to deinit mag interface
+ *
+ * @retval mag status type
+ */
+mag_status_t mag_deinit(void) {
+	if (!mag_driver)
+		return MAG_ERROR_WARN;
+
+	mag_driver->deinit();
+	mag_driver = NULL;
+	report.state = MAG_CAL_STATE_IDLE;
+
+	return MAG_OK;
+}
+
+/*
+ * @brief mag API call to get the newest sample, calibrated (no bus access;
+ * 		  see mag.h)
+ * 		  NOTE: without an initialized device no sample is ever fresh, so the
+ * 		  heading is left to the gyro (the magnetometer is optional)
+ *
+ * @param  data		generic pointer to mag data handle
+ * @retval mag status type
+ */
+mag_status_t mag_read(void *data) {
+	mag_data_t *mag = (mag_data_t*) data;
+	mag_status_t status;
+
+	if (!mag_driver) {
+		mag->fresh = false;
+		return MAG_OK;
+	}
+
+	status = mag_driver->read(data);
+	if (mag->fresh)
+		mag_cal_apply(&calibration, mag->raw_mgauss, mag->field_mgauss);
+
+	if (report.state == MAG_CAL_STATE_RUNNING)
+		calibration_service(mag);
+
+	return status;
+}
+
+/**
+  * @brief starts a calibration session (the caller keeps the craft disarmed
+  * 	   while it runs)
+  *
+  * @param  duration_s	session length (0: CONFIG_MAG_CAL_DURATION_S)
+  * @retval boolean (false without a device, or while a session runs)
+  */
+bool mag_calibration_start(uint32_t duration_s) {
+	if (!mag_driver || (report.state == MAG_CAL_STATE_RUNNING))
+		return false;
+
+	if (duration_s == 0U)
+		duration_s = MAG_CAL_DURATION_S;
+
+	if (duration_s > MAG_CAL_MAX_DURATION_S)
+		duration_s = MAG_CAL_MAX_DURATION_S;
+
+	mag_cal_reset(&session);
+	memset(&report, 0, sizeof(report));
+	report.state = MAG_CAL_STATE_RUNNING;
+	session_start_ms = millis();
+	session_duration_ms = duration_s * 1000U;
+
+	return true;
+}
+
+/**
+  * @brief checks whether a calibration session is running
+  *
+  * @retval boolean
+  */
+bool mag_calibration_is_running(void) {
+	return report.state == MAG_CAL_STATE_RUNNING;
+}
+
+/**
+  * @brief gets the state and last fit of the calibration session
+  *
+  * @param  out		report buffer to be filled
+  * @retval None
+  */
+void mag_calibration_get(mag_cal_report_t *out) {
+	*out = report;
+	out->fit.samples = (report.state == MAG_CAL_STATE_RUNNING) ? session.samples : report.fit.samples;
+}
@@ -0,0 +1,454 @@
+/*
+ * mag_cal.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <string.h>
+#include "sensors/mag/mag_cal.h"
+
+/**
+  * @brief  Fit Scaling and Tolerances
+  */
+#define MGAUSS_PER_GAUSS		1000.0
+#define PIVOT_MIN				1e-12		// relative to the largest diagonal term
+#define JACOBI_SWEEPS			32U
+
+
+/**
+  * @brief resets a calibration accumulator
+  *
+  * @param  cal		pointer to calibration accumulator
+  * @retval None
+  */
+void mag_cal_reset(mag_cal_t *cal) {
+	memset(cal, 0, sizeof(*cal));
+
+	for (uint32_t i = 0; i < 3U; ++i) {
+		cal->min_mgauss[i] = INFINITY;
+		cal->max_mgauss[i] = -INFINITY;
+	}
+}
+
+/**
+  * @brief  Quadric Terms (coefficient, powers of x, y, z)
+  */
+static const struct {
+	double coef;
+	uint8_t pow[3];
+} terms[MAG_CAL_TERMS] = {
+	{1.0, {2, 0, 0}}, {1.0, {0, 2, 0}}, {1.0, {0, 0, 2}},
+	{2.0, {1, 1, 0}}, {2.0, {1, 0, 1}}, {2.0, {0, 1, 1}},
+	{2.0, {1, 0, 0}}, {2.0, {0, 1, 0}}, {2.0, {0, 0, 1}}
+};
+
+
+/**
+  * @brief adds one raw reading to the fit
+  *
+  * @param  cal			pointer to calibration accumulator
+  * @param	raw_mgauss	raw field (mG)
+  *
+  * @retval None
+  */
+void mag_cal_add(mag_cal_t *cal, const float raw_mgauss[3]) {
+	double px[MAG_CAL_ORDER] = {1.0};
+	double py[MAG_CAL_ORDER] = {1.0};
+	double pz[MAG_CAL_ORDER] = {1.0};
+
+	for (uint32_t i = 1U; i < MAG_CAL_ORDER; ++i) {
+		px[i] = px[i - 1U] * (raw_mgauss[0] / MGAUSS_PER_GAUSS);
+		py[i] = py[i - 1U] * (raw_mgauss[1] / MGAUSS_PER_GAUSS);
+		pz[i] = pz[i - 1U] * (raw_mgauss[2] / MGAUSS_PER_GAUSS);
+	}
+
+	for (uint32_t i = 0; i < MAG_CAL_ORDER; ++i) {
+		for (uint32_t j = 0; (i + j) < MAG_CAL_ORDER; ++j) {
+			for (uint32_t k = 0; (i + j + k) < MAG_CAL_ORDER; ++k)
+				cal->sums[i][j][k] += px[i] * py[j] * pz[k];
+		}
+	}
+
+	for (uint32_t i = 0; i < 3U; ++i) {
+		cal->min_mgauss[i] = fminf(cal->min_mgauss[i], raw_mgauss[i]);
+		cal->max_mgauss[i] = fmaxf(cal->max_mgauss[i], raw_mgauss[i]);
+	}
+
+	cal->samples++;
+}
+
+/**
+  * @brief helper function to raise to a small integral power
+  *
+  * @retval x^n
+  */
+static inline double pow_i(double x, uint32_t n) {
+	double r = 1.0;
+
+	while (n--)
+		r *= x;
+
+	return r;
+}
+
+/**
+  * @brief helper function to get a power sum about another origin (binomial
+  * 	   expansion of sum (x - o)^a (y - o)^b (z - o)^c)
+  *
+  * @param  cal		read-only pointer to calibration accumulator
+  * @param	pow		powers of x, y, z
+  * @param	origin	origin (gauss)
+  *
+  * @retval power sum
+  */
+static double shifted_sum(const mag_cal_t *cal, const uint8_t pow[3], const double origin[3]) {
+	static const double binom[MAG_CAL_ORDER][MAG_CAL_ORDER] = {
+		{1}, {1, 1}, {1, 2, 1}, {1, 3, 3, 1}, {1, 4, 6, 4, 1}
+	};
+	double sum = 0.0;
+
+	for (uint32_t i = 0; i <= pow[0]; ++i) {
+		for (uint32_t j = 0; j <= pow[1]; ++j) {
+			for (uint32_t k = 0; k <= pow[2]; ++k) {
+				sum += binom[pow[0]][i] * pow_i(-origin[0], pow[0] - i) *
+					   binom[pow[1]][j] * pow_i(-origin[1], pow[1] - j) *
+					   binom[pow[2]][k] * pow_i(-origin[2], pow[2] - k) * cal->sums[i][j][k];
+			}
+		}
+	}
+
+	return sum;
+}
+
+/**
+  * @brief helper function to build the normal equations of the quadric fit
+  * 	   about an origin
+  *
+  * @param  cal		read-only pointer to calibration accumulator
+  * @param	origin	origin (gauss)
+  * @param	ata		normal matrix to be filled
+  * @param	atb		right-hand side to be filled
+  *
+  * @retval None
+  */
+static void normal_equations(const mag_cal_t *cal, const double origin[3],
+							 double ata[MAG_CAL_TERMS][MAG_CAL_TERMS], double atb[MAG_CAL_TERMS]) {
+	for (uint32_t i = 0; i < MAG_CAL_TERMS; ++i) {
+		for (uint32_t j = i; j < MAG_CAL_TERMS; ++j) {
+			const uint8_t pow[3] = {terms[i].pow[0] + terms[j].pow[0],
+									terms[i].pow[1] + terms[j].pow[1],
+									terms[i].pow[2] + terms[j].pow[2]};
+
+			ata[i][j] = ata[j][i] = terms[i].coef * terms[j].coef * shifted_sum(cal, pow, origin);
+		}
+
+		atb[i] = terms[i].coef * shifted_sum(cal, terms[i].pow, origin);
+	}
+}
+
+/**
+  * @brief helper function to solve the normal equations (gaussian elimination,
+  * 	   partial pivoting)
+  *
+  * @param  ata		read-only normal matrix
+  * @param	atb		read-only right-hand side
+  * @param	p		quadric coefficients to be filled
+  *
+  * @retval boolean (false if singular)
+  */
+static bool solve_normal(const double ata[MAG_CAL_TERMS][MAG_CAL_TERMS], const double atb[MAG_CAL_TERMS],
+						 double p[MAG_CAL_TERMS]) {
+	double a[MAG_CAL_TERMS][MAG_CAL_TERMS + 1U];
+	double scale = 0.0;
+
+	for (uint32_t i = 0; i < MAG_CAL_TERMS; ++i) {
+		for (uint32_t j = 0; j < MAG_CAL_TERMS; ++j)
+			a[i][j] = ata[i][j];
+
+		a[i][MAG_CAL_TERMS] = atb[i];
+		scale = fmax(scale, a[i][i]);
+	}
+
+	for (uint32_t col = 0; col < MAG_CAL_TERMS; ++col) {
+		uint32_t pivot = col;
+
+		for (uint32_t row = col + 1U; row < MAG_CAL_TERMS; ++row) {
+			if (fabs(a[row][col]) > fabs(a[pivot][col]))
+				pivot = row;
+		}
+
+		if (fabs(a[pivot][col]) <= PIVOT_MIN * scale)
+			return false;
+
+		if (pivot != col) {
+			for (uint32_t j = col; j <= MAG_CAL_TERMS; ++j) {
+				double tmp = a[col][j];
+				a[col][j] = a[pivot][j];
+				a[pivot][j] = tmp;
+			}
+		}
+
+		for (uint32_t row = col + 1U; row < MAG_CAL_TERMS; ++row) {
+			double f = a[row][col] / a[col][col];
+
+			for (uint32_t j = col; j <= MAG_CAL_TERMS; ++j)
+				a[row][j] -= f * a[col][j];
+		}
+	}
+
+	for (uint32_t i = MAG_CAL_TERMS; i-- > 0U;) {
+		double sum = a[i][MAG_CAL_TERMS];
+
+		for (uint32_t j = i + 1U; j < MAG_CAL_TERMS; ++j)
+			sum -= a[i][j] * p[j];
+
+		p[i] = sum / a[i][i];
+	}
+
+	return true;
+}
+
+/**
+  * @brief helper function to diagonalize a symmetric 3x3 matrix (cyclic jacobi)
+  *
+  * @param  a		matrix (diagonal holds the eigenvalues on return)
+  * @param	v		eigenvector buffer to be filled (columns)
+  *
+  * @retval None
+  */
+static void eigen_sym3(double a[3][3], double v[3][3]) {
+	for (uint32_t i = 0; i < 3U; ++i) {
+		for (uint32_t j = 0; j < 3U; ++j)
+			v[i][j] = (i == j) ? 1.0 : 0.0;
+	}
+
+	for (uint32_t sweep = 0; sweep < JACOBI_SWEEPS; ++sweep) {
+		double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+		double diag = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+
+		if (off <= 1e-24 * diag)
+			break;
+
+		for (uint32_t p = 0; p < 2U; ++p) {
+			for (uint32_t q = p + 1U; q < 3U; ++q) {
+				if (a[p][q] == 0.0)
+					continue;
+
+				/* Rotation zeroing a[p][q] */
+				double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+				double t = copysign(1.0, theta) / (fabs(theta) + sqrt(theta * theta + 1.0));
+				double c = 1.0 / sqrt(t * t + 1.0);
+				double s = t * c;
+
+				for (uint32_t k = 0; k < 3U; ++k) {
+					double akp = a[k][p];
+					double akq = a[k][q];
+					a[k][p] = c * akp - s * akq;
+					a[k][q] = s * akp + c * akq;
+				}
+
+				for (uint32_t k = 0; k < 3U; ++k) {
+					double apk = a[p][k];
+					double aqk = a[q][k];
+					a[p][k] = c * apk - s * aqk;
+					a[q][k] = s * apk + c * aqk;
+				}
+
+				for (uint32_t k = 0; k < 3U; ++k) {
+					double vkp = v[k][p];
+					double vkq = v[k][q];
+					v[k][p] = c * vkp - s * vkq;
+					v[k][q] = s * vkp + c * vkq;
+				}
+			}
+		}
+	}
+}
+
+/**
+  * @brief helper function to solve a 3x3 linear system (cramer's rule)
+  *
+  * @retval boolean (false if singular)
+  */
+static bool solve3(const double m[3][3], const double b[3], double x[3]) {
+	double det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+				 m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+				 m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+
+	if (det == 0.0)
+		return false;
+
+	for (uint32_t col = 0; col < 3U; ++col) {
+		double t[3][3];
+
+		memcpy(t, m, sizeof(t));
+		for (uint32_t row = 0; row < 3U; ++row)
+			t[row][col] = b[row];
+
+		x[col] = (t[0][0] * (t[1][1] * t[2][2] - t[1][2] * t[2][1]) -
+				  t[0][1] * (t[1][0] * t[2][2] - t[1][2] * t[2][0]) +
+				  t[0][2] * (t[1][0] * t[2][1] - t[1][1] * t[2][0])) / det;
+	}
+
+	return true;
+}
+
+/**
+  * @brief fits offset and soft-iron correction to the accumulated readings
+  *
+  * @param  cal		read-only pointer to calibration accumulator
+  * @param	fit		fit buffer to be filled (valid on MAG_CAL_OK; quality
+  * 				figures also on DISTORTED / POOR_FIT / FIELD_RANGE)
+  *
+  * @retval calibration fit result
+  */
+mag_cal_result_t mag_cal_solve(const mag_cal_t *cal, mag_cal_fit_t *fit) {
+	double ata[MAG_CAL_TERMS][MAG_CAL_TERMS];
+	double atb[MAG_CAL_TERMS];
+	double p[MAG_CAL_TERMS];
+	double origin[3];
+	double m[3][3];
+	double a[3][3];
+	double q[3][3];
+	double neg_v[3];
+	double center[3];
+	double k = 1.0;
+	double sse = 0.0;
+	double r_min = INFINITY;
+	double r_max = 0.0;
+	double r_prod = 1.0;
+	float span_max = 0.0f;
+
+	memset(fit, 0, sizeof(*fit));
+	mag_cal_identity(&fit->cal);
+	fit->samples = cal->samples;
+
+	if (cal->samples < MAG_CAL_MIN_SAMPLES)
+		return MAG_CAL_TOO_FEW_SAMPLES;
+
+	/* Every axis turned through (against the widest one: no fit needed yet) */
+	for (uint32_t i = 0; i < 3U; ++i)
+		span_max = fmaxf(span_max, cal->max_mgauss[i] - cal->min_mgauss[i]);
+
+	for (uint32_t i = 0; i < 3U; ++i) {
+		if ((cal->max_mgauss[i] - cal->min_mgauss[i]) < MAG_CAL_MIN_SPAN * span_max)
+			return MAG_CAL_POOR_COVERAGE;
+	}
+
+	/* Fit about the middle of the readings (inside the ellipsoid) */
+	for (uint32_t i = 0; i < 3U; ++i)
+		origin[i] = 0.5 * ((double) cal->min_mgauss[i] + (double) cal->max_mgauss[i]) / MGAUSS_PER_GAUSS;
+
+	normal_equations(cal, origin, ata, atb);
+	if (!solve_normal(ata, atb, p))
+		return MAG_CAL_SINGULAR;
+
+	/* Quadric: x'Mx + 2v'x = 1  ->  (x - c)'(M / k)(x - c) = 1, k = 1 + c'Mc */
+	m[0][0] = p[0]; m[1][1] = p[1]; m[2][2] = p[2];
+	m[0][1] = m[1][0] = p[3];
+	m[0][2] = m[2][0] = p[4];
+	m[1][2] = m[2][1] = p[5];
+	neg_v[0] = -p[6]; neg_v[1] = -p[7]; neg_v[2] = -p[8];
+
+	if (!solve3(m, neg_v, center))
+		return MAG_CAL_SINGULAR;
+
+	for (uint32_t i = 0; i < 3U; ++i) {
+		for (uint32_t j = 0; j < 3U; ++j)
+			k += center[i] * m[i][j] * center[j];
+	}
+
+	if (k == 0.0)
+		return MAG_CAL_NOT_ELLIPSOID;
+
+	for (uint32_t i = 0; i < 3U; ++i) {
+		for (uint32_t j = 0; j < 3U; ++j)
+			a[i][j] = m[i][j] / k;
+	}
+
+	/* Ellipsoid: all eigenvalues positive; semi-axes 1 / sqrt(eigenvalue) */
+	eigen_sym3(a, q);
+	for (uint32_t i = 0; i < 3U; ++i) {
+		if (a[i][i] <= 0.0)
+			return MAG_CAL_NOT_ELLIPSOID;
+
+		double r = 1.0 / sqrt(a[i][i]);
+		r_min = fmin(r_min, r);
+		r_max = fmax(r_max, r);
+		r_prod *= r;
+	}
+
+	/* Soft iron: back onto the sphere of the geometric mean radius */
+	double radius = cbrt(r_prod);
+	for (uint32_t i = 0; i < 3U; ++i) {
+		for (uint32_t j = 0; j < 3U; ++j) {
+			double w = 0.0;
+
+			for (uint32_t e = 0; e < 3U; ++e)
+				w += q[i][e] * sqrt(a[e][e]) * q[j][e];
+
+			fit->cal.soft_iron[i][j] = (float) (radius * w);
+		}
+
+		fit->cal.offset_mgauss[i] = (float) ((origin[i] + center[i]) * MGAUSS_PER_GAUSS);
+	}
+
+	/* Residual of the algebraic fit: sum (phi'p - 1)^2 = p'(A'A)p - 2p'(A'b) + n */
+	for (uint32_t i = 0; i < MAG_CAL_TERMS; ++i) {
+		for (uint32_t j = 0; j < MAG_CAL_TERMS; ++j)
+			sse += p[i] * ata[i][j] * p[j];
+
+		sse -= 2.0 * p[i] * atb[i];
+	}
+	sse = fmax(sse + (double) cal->samples, 0.0);
+
+	/* (phi'p - 1) / k is twice the relative radial error */
+	fit->field_mgauss = (float) (radius * MGAUSS_PER_GAUSS);
+	fit->axis_ratio = (float) (r_max / r_min);
+	fit->fit_error_pct = (float) (100.0 * sqrt(sse / (double) cal->samples) / (2.0 * fabs(k)));
+
+	if ((fit->field_mgauss < MAG_CAL_MIN_FIELD_MGAUSS) || (fit->field_mgauss > MAG_CAL_MAX_FIELD_MGAUSS))
+		return MAG_CAL_FIELD_RANGE;
+
+	if (fit->axis_ratio > MAG_CAL_MAX_AXIS_RATIO)
+		return MAG_CAL_DISTORTED;
+
+	if (fit->fit_error_pct > MAG_CAL_MAX_FIT_ERROR_PCT)
+		return MAG_CAL_POOR_FIT;
+
+	return MAG_CAL_OK;
+}
+
+/**
+  * @brief applies a calibration to a raw reading
+  *
+  * @param  cal			read-only pointer to calibration
+  * @param	raw_mgauss	raw field (mG)
+  * @param	out_mgauss	calibrated field buffer to be filled (mG)
+  *
+  * @retval None
+  */
+void mag_cal_apply(const mag_calibration_t *cal, const float raw_mgauss[3], float out_mgauss[3]) {
+	float d[3];
+
+	for (uint32_t i = 0; i < 3U; ++i)
+		d[i] = raw_mgauss[i] - cal->offset_mgauss[i];
+
+	for (uint32_t i = 0; i < 3U; ++i)
+		out_mgauss[i] = cal->soft_iron[i][0] * d[0] + cal->soft_iron[i][1] * d[1] + cal->soft_iron[i][2] * d[2];
+}
+
+/**
+  * @brief sets a calibration that leaves readings unchanged
+  *
+  * @param  cal		calibration buffer to be filled
+  * @retval None
+  */
+void mag_cal_identity(mag_calibration_t *cal) {
+	memset(cal, 0, sizeof(*cal));
+
+	for (uint32_t i = 0; i < 3U; ++i)
+		cal->soft_iron[i][i] = 1.0f;
+}
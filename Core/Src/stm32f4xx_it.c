@@ -22,6 +22,8 @@
 #include "stm32f4xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "system/irq.h"
+#include "sensors/imu/crash.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -188,7 +190,7 @@ void PendSV_Handler(void)
 void SysTick_Handler(void)
 {
   /* USER CODE BEGIN SysTick_IRQn 0 */
-
+  irq_latency_tick();
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
@@ -209,7 +211,7 @@ void SysTick_Handler(void)
 void TIM2_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM2_IRQn 0 */
-
+  irq_latency_timer_enter(TIM2);
   /* USER CODE END TIM2_IRQn 0 */
   HAL_TIM_IRQHandler(&htim2);
   /* USER CODE BEGIN TIM2_IRQn 1 */
@@ -223,7 +225,7 @@ void TIM2_IRQHandler(void)
 void TIM3_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM3_IRQn 0 */
-
+  irq_latency_timer_enter(TIM3);
   /* USER CODE END TIM3_IRQn 0 */
   HAL_TIM_IRQHandler(&htim3);
   /* USER CODE BEGIN TIM3_IRQn 1 */
@@ -294,6 +296,7 @@ void DMA2_Stream6_IRQHandler(void)
   */
 void EXTI2_IRQHandler(void)
 {
+    irq_latency_exti(ARM_Pin);
     HAL_GPIO_EXTI_IRQHandler(ARM_Pin);
 }
 
@@ -302,6 +305,15 @@ void EXTI2_IRQHandler(void)
   */
 void EXTI3_IRQHandler(void)
 {
+    irq_latency_exti(MODE_Pin);
     HAL_GPIO_EXTI_IRQHandler(MODE_Pin);
 }
+
+/**
+  * @brief This function handles EXTI0 global interrupt (imu INT1: crash detection).
+  */
+void EXTI0_IRQHandler(void)
+{
+    crash_irq_handler();
+}
 /* USER CODE END 1 */
@@ -0,0 +1,201 @@
+/*
+ * blackbox.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "storage/blackbox.h"
+#include "common/memory.h"
+#include "common/settings.h"
+
+/**
+  * @brief  Blackbox Config Settings
+  */
+#define BLACKBOX_KEYFRAME_INTERVAL		CONFIG_BLACKBOX_KEYFRAME_INTERVAL
+
+/**
+  * @brief  Quantizer Range (counts; keeps the float to int conversion defined)
+  */
+#define BLACKBOX_QUANT_LIMIT			1073741824.0f	// 2^30
+
+/**
+  * @brief  Field Definition
+  */
+typedef struct {
+	const char *name;
+	uint16_t offset;			// in blackbox_record_t
+	uint8_t type;
+	uint8_t predictor;
+	float scale;				// units per count
+	float inv_scale;
+} field_def_t;
+
+#define FIELD(nm, member, tp, pred, sc) \
+	{.name = (nm), .offset = offsetof(blackbox_record_t, member), .type = (tp), .predictor = (pred), \
+	 .scale = (sc), .inv_scale = 1.0f / (sc)}
+
+/**
+  * @brief  Field Table (names become the decoder's column names)
+  * 		NOTE: imu scales are the lsm6dsox lsb at 2 g / 2000 dps full scale
+  */
+static const field_def_t fields[] = {
+	FIELD("time_us",			time_us,			BLACKBOX_TYPE_UNSIGNED,	BLACKBOX_PREDICT_LINEAR,	1.0f),
+	FIELD("imu_dt_us",			imu.dt,				BLACKBOX_TYPE_UNSIGNED,	BLACKBOX_PREDICT_PREVIOUS,	1.0f),
+	FIELD("accel_x_mg",			imu.accel_x,		BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.061f),
+	FIELD("accel_y_mg",			imu.accel_y,		BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.061f),
+	FIELD("accel_z_mg",			imu.accel_z,		BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.061f),
+	FIELD("gyro_x_mdps",		imu.rate_x,			BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	70.0f),
+	FIELD("gyro_y_mdps",		imu.rate_y,			BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	70.0f),
+	FIELD("gyro_z_mdps",		imu.rate_z,			BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	70.0f),
+	FIELD("est_roll_deg",		est.roll_angle_deg,	BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_LINEAR,	0.01f),
+	FIELD("est_pitch_deg",		est.pitch_angle_deg,	BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_LINEAR,	0.01f),
+	FIELD("est_roll_rate_dps",	est.roll_rate_dps,	BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.01f),
+	FIELD("est_pitch_rate_dps",	est.pitch_rate_dps,	BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.01f),
+	FIELD("est_yaw_rate_dps",	est.yaw_rate_dps,	BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.01f),
+	FIELD("req_roll_deg",		req.roll_angle,		BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.01f),
+	FIELD("req_pitch_deg",		req.pitch_angle,	BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.01f),
+	FIELD("req_roll_rate_dps",	req.roll_rate,		BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.01f),
+	FIELD("req_pitch_rate_dps",	req.pitch_rate,		BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.01f),
+	FIELD("req_yaw_rate_dps",	req.yaw_rate,		BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.01f),
+	FIELD("req_throttle_pct",	req.throttle,		BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.01f),
+	FIELD("motor1",				mcmd.mtr1,			BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.1f),
+	FIELD("motor2",				mcmd.mtr2,			BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.1f),
+	FIELD("motor3",				mcmd.mtr3,			BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.1f),
+	FIELD("motor4",				mcmd.mtr4,			BLACKBOX_TYPE_SIGNED,	BLACKBOX_PREDICT_PREVIOUS,	0.1f)
+};
+
+_Static_assert(sizeof(fields) / sizeof(fields[0]) == BLACKBOX_FIELD_COUNT, "blackbox field table does not match BLACKBOX_FIELD_COUNT");
+_Static_assert(BLACKBOX_HEADER_MAX >= BLACKBOX_FRAME_MAX, "a header buffer must hold any frame");
+
+/**
+  * @brief  Predictor State (cpu access only)
+  */
+static uint32_t prev[BLACKBOX_FIELD_COUNT] CCM_BSS;
+static uint32_t prev2[BLACKBOX_FIELD_COUNT] CCM_BSS;
+static uint32_t since_key CCM_BSS;		// frames since the last keyframe (0: next is one)
+
+
+/**
+  * @brief helper function to quantize a float to counts (round half away
+  * 	   from zero, saturating; NaN maps to the lower limit)
+  *
+  * @retval counts (two's complement)
+  */
+static inline uint32_t quantize(float x) {
+	if (!(x > -BLACKBOX_QUANT_LIMIT))
+		x = -BLACKBOX_QUANT_LIMIT;
+	if (x > BLACKBOX_QUANT_LIMIT)
+		x = BLACKBOX_QUANT_LIMIT;
+
+	return (uint32_t) (int32_t) (x + ((x < 0.0f) ? -0.5f : 0.5f));
+}
+
+/**
+  * @brief helper function to write an unsigned LEB128 varint
+  *
+  * @retval pointer past the last byte written
+  */
+static inline uint8_t *put_varint(uint8_t *p, uint32_t v) {
+	while (v >= 0x80U) {
+		*p++ = (uint8_t) (v | 0x80U);
+		v >>= 7;
+	}
+	*p++ = (uint8_t) v;
+
+	return p;
+}
+
+/**
+  * @brief makes the next frame a keyframe (log start, or after a dropped frame)
+  *
+  * @retval None
+  */
+void blackbox_reset(void) {
+	since_key = 0U;
+}
+
+/**
+  * @brief writes the field definitions (once per log, ahead of the first frame)
+  *
+  * @param  out		buffer to be filled
+  * @param	size	buffer size (BLACKBOX_HEADER_MAX is always enough)
+  *
+  * @retval bytes written (0 if the buffer is too small)
+  */
+uint32_t blackbox_write_header(uint8_t *out, uint32_t size) {
+	uint16_t interval = BLACKBOX_KEYFRAME_INTERVAL;
+	uint32_t n = 0U, len;
+
+	if (size < 8U)
+		return 0U;
+
+	memcpy(&out[n], BLACKBOX_MAGIC, 4U);
+	n += 4U;
+	out[n++] = BLACKBOX_VERSION;
+	out[n++] = BLACKBOX_FIELD_COUNT;
+	memcpy(&out[n], &interval, sizeof(interval));
+	n += sizeof(interval);
+
+	for (uint32_t i = 0; i < BLACKBOX_FIELD_COUNT; ++i) {
+		len = (uint32_t) strlen(fields[i].name) + 1U;
+		if (n + 2U + sizeof(float) + len > size)
+			return 0U;
+
+		out[n++] = fields[i].predictor;
+		out[n++] = fields[i].type;
+		memcpy(&out[n], &fields[i].scale, sizeof(float));
+		n += sizeof(float);
+		memcpy(&out[n], fields[i].name, len);
+		n += len;
+	}
+
+	return n;
+}
+
+/**
+  * @brief encodes one record as the next frame
+  *
+  * @param  rec		record to encode
+  * @param	out		frame buffer to be filled (BLACKBOX_FRAME_MAX bytes)
+  *
+  * @retval frame length (bytes)
+  */
+RAM_FUNC uint32_t blackbox_encode(const blackbox_record_t *rec, uint8_t *out) {
+	const uint8_t *base = (const uint8_t*) rec;
+	uint8_t *p = out;
+	uint32_t v, pred, r;
+	float f;
+
+	*p++ = since_key ? BLACKBOX_FRAME_P : BLACKBOX_FRAME_I;
+
+	for (uint32_t i = 0; i < BLACKBOX_FIELD_COUNT; ++i) {
+		if (fields[i].type == BLACKBOX_TYPE_UNSIGNED) {
+			memcpy(&v, base + fields[i].offset, sizeof(v));
+		} else {
+			memcpy(&f, base + fields[i].offset, sizeof(f));
+			v = quantize(f * fields[i].inv_scale);
+		}
+
+		/* Keyframes predict 0; a line needs two values since the keyframe */
+		if (!since_key)
+			pred = 0U;
+		else if ((fields[i].predictor == BLACKBOX_PREDICT_LINEAR) && (since_key > 1U))
+			pred = 2U * prev[i] - prev2[i];
+		else
+			pred = prev[i];
+
+		/* Zigzag (residual wraps modulo 2^32) */
+		r = v - pred;
+		p = put_varint(p, (r << 1) ^ (uint32_t) ((int32_t) r >> 31));
+
+		prev2[i] = prev[i];
+		prev[i] = v;
+	}
+
+	since_key = (since_key + 1U < BLACKBOX_KEYFRAME_INTERVAL) ? since_key + 1U : 0U;
+
+	return (uint32_t) (p - out);
+}
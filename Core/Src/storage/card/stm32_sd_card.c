@@ -0,0 +1,245 @@
+/*
+ * stm32_sd_card.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx_hal.h"
+#include "bsp_driver_sd.h"
+#include "storage/card/stm32_sd_card.h"
+
+/**
+  * @brief  SD Commands and Timeouts
+  */
+#define SD_CMD_SET_WR_BLK_ERASE_COUNT	23U				// ACMD23
+#define SD_WR_BLK_ERASE_COUNT_MASK		0x007FFFFFU		// 23-bit block count
+#define SD_CARD_CMD_TIMEOUT_MS			10U
+
+/* External variables --------------------------------------------------------*/
+extern SD_HandleTypeDef hsd;
+
+/**
+  * @brief  Transfer Owner Type (fatfs transfers complete through sd_diskio only)
+  */
+typedef enum {
+	OWNER_NONE		= 0x00U,
+	OWNER_STREAM	= 0x01U,	// sd_stream write
+	OWNER_DISK		= 0x02U		// usb mass storage read / write
+} owner_t;
+
+static volatile owner_t owner = OWNER_NONE;
+
+
+/**
+  * @brief helper function to wait for and check an R1 response
+  *
+  * @param  cmd_index	command the response belongs to
+  * @retval boolean
+  */
+static bool wait_resp1(uint8_t cmd_index) {
+	uint32_t start = HAL_GetTick();
+	bool ok;
+
+	while (!__SDIO_GET_FLAG(hsd.Instance, SDIO_FLAG_CCRCFAIL | SDIO_FLAG_CMDREND | SDIO_FLAG_CTIMEOUT) ||
+		   __SDIO_GET_FLAG(hsd.Instance, SDIO_FLAG_CMDACT)) {
+		if ((HAL_GetTick() - start) > SD_CARD_CMD_TIMEOUT_MS)
+			return false;
+	}
+
+	ok = !__SDIO_GET_FLAG(hsd.Instance, SDIO_FLAG_CCRCFAIL | SDIO_FLAG_CTIMEOUT) &&
+		 (SDIO_GetCommandResponse(hsd.Instance) == cmd_index) &&
+		 !(SDIO_GetResponse(hsd.Instance, SDIO_RESP1) & SDMMC_OCR_ERRORBITS);
+
+	__SDIO_CLEAR_FLAG(hsd.Instance, SDIO_STATIC_CMD_FLAGS);
+
+	return ok;
+}
+
+/**
+  * @brief helper function to pre-erase the blocks of the next multi-block
+  * 	   write (ACMD23), so the card need not erase while data arrives
+  *
+  * @param  count	block count of the next CMD25
+  * @retval boolean
+  */
+static bool pre_erase(uint32_t count) {
+	SDIO_CmdInitTypeDef cmd = {
+		.Argument = count & SD_WR_BLK_ERASE_COUNT_MASK,
+		.CmdIndex = SD_CMD_SET_WR_BLK_ERASE_COUNT,
+		.Response = SDIO_RESPONSE_SHORT,
+		.WaitForInterrupt = SDIO_WAIT_NO,
+		.CPSM = SDIO_CPSM_ENABLE
+	};
+
+	if (SDMMC_CmdAppCommand(hsd.Instance, (uint32_t) hsd.SdCard.RelCardAdd << 16U) != HAL_SD_ERROR_NONE)
+		return false;
+
+	(void) SDIO_SendCommand(hsd.Instance, &cmd);
+
+	return wait_resp1(SD_CMD_SET_WR_BLK_ERASE_COUNT);
+}
+
+/**
+  * @brief helper function to hand a transfer end to its owner
+  *
+  * @param  ok		whether all blocks were transferred
+  * @retval None
+  */
+static void transfer_done(bool ok) {
+	owner_t o = owner;
+
+	owner = OWNER_NONE;
+
+	if (o == OWNER_STREAM)
+		sd_stream_write_done(ok);
+	else if (o == OWNER_DISK)
+		msc_disk_done(ok);
+}
+
+/**
+  * @brief determines if the card can take a new transfer (no dma in flight,
+  * 	   card back in transfer state after programming)
+  *
+  * @retval boolean
+  */
+static bool stm32_sd_card_ready(void) {
+	if ((owner != OWNER_NONE) || (HAL_SD_GetState(&hsd) != HAL_SD_STATE_READY))
+		return false;
+
+	return (HAL_SD_GetCardState(&hsd) == HAL_SD_CARD_TRANSFER);
+}
+
+/**
+  * @brief starts a pre-erased multi-block dma write
+  * 	   NOTE: the pre-erase is only a hint; a card rejecting it still takes the write
+  *
+  * @param  buf		word-aligned source (SRAM)
+  * @param	block	first block (lba)
+  * @param	count	block count
+  *
+  * @retval boolean
+  */
+static bool stm32_sd_card_write(const uint32_t *buf, uint32_t block, uint32_t count) {
+	if (count > 1U)
+		(void) pre_erase(count);
+
+	owner = OWNER_STREAM;
+
+	if (HAL_SD_WriteBlocks_DMA(&hsd, (uint8_t*) buf, block, count) != HAL_OK) {
+		owner = OWNER_NONE;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief fetches the card size, initializing the card if FatFs has not yet
+  * 	   (volume mounted lazily)
+  * 	   NOTE: blocking on first use
+  *
+  * @retval blocks (0 if there is no usable card)
+  */
+static uint32_t stm32_sd_disk_block_count(void) {
+	HAL_SD_CardInfoTypeDef info;
+
+	if ((HAL_SD_GetState(&hsd) == HAL_SD_STATE_RESET) && (BSP_SD_Init() != MSD_OK))
+		return 0U;
+
+	BSP_SD_GetCardInfo(&info);
+
+	return (info.LogBlockSize == SD_BLOCK_SIZE) ? info.LogBlockNbr : 0U;
+}
+
+/**
+  * @brief starts a multi-block dma read
+  *
+  * @param  buf		word-aligned destination (SRAM)
+  * @param	block	first block (lba)
+  * @param	count	block count
+  *
+  * @retval boolean
+  */
+static bool stm32_sd_disk_read(uint32_t *buf, uint32_t block, uint32_t count) {
+	owner = OWNER_DISK;
+
+	if (BSP_SD_ReadBlocks_DMA(buf, block, count) != MSD_OK) {
+		owner = OWNER_NONE;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief starts a pre-erased multi-block dma write
+  *
+  * @param  buf		word-aligned source (SRAM)
+  * @param	block	first block (lba)
+  * @param	count	block count
+  *
+  * @retval boolean
+  */
+static bool stm32_sd_disk_write(const uint32_t *buf, uint32_t block, uint32_t count) {
+	if (count > 1U)
+		(void) pre_erase(count);
+
+	owner = OWNER_DISK;
+
+	if (BSP_SD_WriteBlocks_DMA((uint32_t*) buf, block, count) != MSD_OK) {
+		owner = OWNER_NONE;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief sdio write / read complete hooks (called from BSP_SD_WriteCpltCallback
+  * 	   and BSP_SD_ReadCpltCallback)
+  *
+  * @retval None
+  */
+void stm32_sd_card_tx_complete(void) {
+	transfer_done(true);
+}
+
+void stm32_sd_card_rx_complete(void) {
+	transfer_done(true);
+}
+
+/**
+  * @brief sdio error / abort callbacks (override the weak HAL / BSP ones)
+  *
+  * @retval None
+  */
+void HAL_SD_ErrorCallback(SD_HandleTypeDef *phsd) {
+	(void) phsd;
+
+	transfer_done(false);
+}
+
+void BSP_SD_AbortCallback(void) {
+	HAL_SD_ErrorCallback(&hsd);
+}
+
+/**
+  * @brief stm32 sd card driver initialization
+  */
+const sd_card_interface_t stm32_sd_card = {
+	.ready = stm32_sd_card_ready,
+	.write = stm32_sd_card_write
+};
+
+/**
+  * @brief stm32 sd card as a usb mass storage disk
+  */
+const msc_disk_interface_t stm32_sd_disk = {
+	.ready = stm32_sd_card_ready,
+	.block_count = stm32_sd_disk_block_count,
+	.read = stm32_sd_disk_read,
+	.write = stm32_sd_disk_write
+};
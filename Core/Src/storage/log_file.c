@@ -0,0 +1,308 @@
+/*
+ * log_file.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "storage/log_file.h"
+#include "common/cycles.h"
+#include "ff.h"
+
+/**
+  * @brief  Log File Naming (8.3, LOG00001.BIN ..)
+  */
+#define LOG_FILE_PREFIX				"LOG"
+#define LOG_FILE_PREFIX_LEN			3U
+#define LOG_FILE_INDEX_DIGITS		5U
+#define LOG_FILE_INDEX_MAX			99999U
+#define LOG_FILE_EXT				".BIN"
+
+/**
+  * @brief  Preallocation and Drain Limits
+  */
+#define LOG_FILE_PREALLOC_MIN		(1024U * 1024U)		// halve the requested size down to this before giving up
+#define LOG_FILE_STOP_TIMEOUT_MS	1000U				// stream drain on disarm
+#define LOG_FILE_LINKMAP_SIZE		4U					// table size, one fragment (length, start), terminator
+
+/**
+  * @brief  Log File State
+  * 		NOTE: FIL holds a sector buffer the sdio dma reads into (SRAM only)
+  */
+static FIL file;
+static DWORD linkmap[LOG_FILE_LINKMAP_SIZE];
+static char name[LOG_FILE_NAME_LEN];
+static uint32_t next_index = 0U;		// 0: scan the directory first
+static bool is_open = false;
+static bool shortened;
+
+
+/**
+  * @brief helper function to parse the index of a log file name
+  *
+  * @param  fname	8.3 file name
+  * @param	index	index buffer to be filled
+  *
+  * @retval boolean (false if not a log file)
+  */
+static bool parse_index(const char *fname, uint32_t *index) {
+	uint32_t idx = 0U;
+
+	if (strncmp(fname, LOG_FILE_PREFIX, LOG_FILE_PREFIX_LEN) != 0)
+		return false;
+
+	for (uint32_t i = 0; i < LOG_FILE_INDEX_DIGITS; ++i) {
+		char c = fname[LOG_FILE_PREFIX_LEN + i];
+
+		if ((c < '0') || (c > '9'))
+			return false;
+
+		idx = idx * 10U + (uint32_t) (c - '0');
+	}
+
+	if (strcmp(&fname[LOG_FILE_PREFIX_LEN + LOG_FILE_INDEX_DIGITS], LOG_FILE_EXT) != 0)
+		return false;
+
+	*index = idx;
+	return true;
+}
+
+/**
+  * @brief helper function to find the index after the highest existing log
+  * 	   (one directory pass, instead of probing names one by one)
+  *
+  * @retval log index
+  */
+static uint32_t scan_next_index(void) {
+	uint32_t max = 0U, idx;
+	FILINFO info;
+	DIR dir;
+
+	if (f_opendir(&dir, "/") != FR_OK)
+		return 1U;
+
+	while ((f_readdir(&dir, &info) == FR_OK) && info.fname[0]) {
+		if (parse_index(info.fname, &idx) && (idx > max))
+			max = idx;
+	}
+
+	(void) f_closedir(&dir);
+
+	return max + 1U;
+}
+
+/**
+  * @brief helper function to create the next log file
+  *
+  * @retval fatfs result
+  */
+static FRESULT create_next(uint32_t *index) {
+	FRESULT res = FR_EXIST;
+
+	if (!next_index)
+		next_index = scan_next_index();
+
+	while ((res == FR_EXIST) && (next_index <= LOG_FILE_INDEX_MAX)) {
+		*index = next_index++;
+		snprintf(name, sizeof(name), LOG_FILE_PREFIX "%05lu" LOG_FILE_EXT, (unsigned long) *index);
+		res = f_open(&file, name, FA_CREATE_NEW | FA_WRITE);
+	}
+
+	return res;
+}
+
+/**
+  * @brief helper function to allocate one contiguous cluster run to the file,
+  * 	   halving the size while the volume has no free run that long
+  *
+  * @param  size	requested size (bytes)
+  * @retval allocated size (bytes, 0 on failure)
+  */
+static uint32_t preallocate(uint32_t size) {
+	FRESULT res = FR_DENIED;
+	uint32_t sz;
+
+	for (sz = size; sz >= LOG_FILE_PREALLOC_MIN; sz /= 2U) {
+		res = f_expand(&file, (FSIZE_t) sz, 1);
+		if (res != FR_DENIED)
+			break;
+	}
+
+	return (res == FR_OK) ? sz : 0U;
+}
+
+/**
+  * @brief helper function to map the file to its first card block with fast seek
+  *
+  * @retval block (lba, 0 if the file is not one contiguous run)
+  */
+static uint32_t map_first_block(void) {
+	FATFS *fs = file.obj.fs;
+
+	linkmap[0] = LOG_FILE_LINKMAP_SIZE;
+	file.cltbl = linkmap;
+
+	if (f_lseek(&file, CREATE_LINKMAP) != FR_OK)
+		return 0U;		// more than one fragment (FR_NOT_ENOUGH_CORE)
+
+	return fs->database + (linkmap[2] - 2U) * fs->csize;
+}
+
+/**
+  * @brief helper function to queue the log header
+  *
+  * @param  index	log index
+  * @param	ref		time reference
+  *
+  * @retval None
+  */
+static void write_header(uint32_t index, const rtc_time_ref_t *ref) {
+	log_file_header_t hdr = {
+		.version = LOG_FILE_VERSION,
+		.header_size = sizeof(log_file_header_t),
+		.log_index = index,
+		.boot_id = ref->boot_id,
+		.unix_s = ref->unix_s,
+		.unix_us = ref->unix_us,
+		.clock_us = ref->clock_us
+	};
+
+	memcpy(hdr.magic, LOG_FILE_MAGIC, sizeof(hdr.magic));
+	(void) sd_stream_write(&hdr, sizeof(hdr));
+}
+
+/**
+  * @brief creates and preallocates the next log file and starts streaming to it
+  * 	   NOTE: blocking (file system access); call at arm time
+  *
+  * @param  card	card the mounted volume lives on
+  * @param	size	bytes to preallocate (less if the volume has no contiguous run that long)
+  * @param	ref		time reference written to the log header
+  *
+  * @retval log file status (WARN if the preallocation was shortened)
+  */
+log_file_status_t log_file_start(const sd_card_interface_t *card, uint32_t size, const rtc_time_ref_t *ref) {
+	uint32_t first_block, allocated, index;
+
+	if (is_open)
+		return LOG_FILE_OK;
+
+	if (create_next(&index) != FR_OK)
+		return LOG_FILE_ERROR_FATAL;
+
+	/* Allocate and commit FAT + directory entry now, never while armed */
+	allocated = preallocate(size);
+	first_block = allocated ? map_first_block() : 0U;
+
+	if (!first_block || (f_sync(&file) != FR_OK) ||
+		(sd_stream_open(card, first_block, allocated / SD_BLOCK_SIZE) != SD_STREAM_OK)) {
+		(void) f_close(&file);
+		(void) f_unlink(name);
+		return LOG_FILE_ERROR_FATAL;
+	}
+
+	write_header(index, ref);
+
+	shortened = (allocated < size);
+	is_open = true;
+
+	return shortened ? LOG_FILE_ERROR_WARN : LOG_FILE_OK;
+}
+
+/**
+  * @brief appends a record to the open log, whole or not at all (a partial
+  * 	   record would misalign everything after it); never waits on the card
+  *
+  * @param  data	bytes to append
+  * @param	len		byte count
+  *
+  * @retval bytes accepted (len, or 0 if dropped or no log is open)
+  */
+uint32_t log_file_write(const void *data, uint32_t len) {
+	if (!is_open)
+		return 0U;
+
+	if (sd_stream_space() < len) {
+		sd_stream_discard(len);
+		return 0U;
+	}
+
+	return sd_stream_write(data, len);
+}
+
+/**
+  * @brief moves buffered log data to the card (call every loop; never blocks)
+  *
+  * @retval log file status (WARN if bytes were dropped or the file is full,
+  * 		FATAL after a card error)
+  */
+log_file_status_t log_file_service(void) {
+	if (!is_open)
+		return LOG_FILE_OK;
+
+	return (log_file_status_t) sd_stream_service();
+}
+
+/**
+  * @brief drains the stream, truncates the log to the bytes written and closes it
+  * 	   NOTE: blocking (file system access); call at disarm time
+  *
+  * @retval log file status (WARN if bytes were lost during the flight)
+  */
+log_file_status_t log_file_stop(void) {
+	uint32_t timeout = LOG_FILE_STOP_TIMEOUT_MS * (cycles_hz() / 1000U);
+	uint32_t start = cycles_now();
+	sd_stream_stats_t st;
+	uint32_t len;
+	FRESULT res;
+
+	if (!is_open)
+		return LOG_FILE_OK;
+
+	is_open = false;
+
+	sd_stream_close();
+	while (!sd_stream_idle() && ((cycles_now() - start) < timeout))
+		(void) sd_stream_service();
+
+	/* Transfer never completed: leave the file at its preallocated size */
+	if (!sd_stream_idle())
+		return LOG_FILE_ERROR_FATAL;
+
+	sd_stream_get_stats(&st);
+
+	/* Keep what reached the card, minus the padding of the last block */
+	len = sd_stream_position();
+	if (len > st.bytes_written)
+		len = st.bytes_written;
+
+	/* Fast seek sets the cluster without walking the chain */
+	res = f_lseek(&file, (FSIZE_t) len);
+	if (res == FR_OK)
+		res = f_truncate(&file);
+
+	if ((f_close(&file) != FR_OK) || (res != FR_OK))
+		return LOG_FILE_ERROR_FATAL;
+
+	return (st.bytes_dropped || st.errors || shortened) ? LOG_FILE_ERROR_WARN : LOG_FILE_OK;
+}
+
+/**
+  * @brief determines if a log is being written
+  *
+  * @retval boolean
+  */
+bool log_file_is_open(void) {
+	return is_open;
+}
+
+/**
+  * @brief fetches the name of the current (or last) log file
+  *
+  * @retval read-only pointer to 8.3 name (empty before the first start)
+  */
+const char *log_file_name(void) {
+	return name;
+}
@@ -0,0 +1,974 @@
+/*
+ * msc.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "storage/msc.h"
+
+/**
+  * @brief  Bulk-Only Transport Wrappers
+  */
+#define CBW_SIGNATURE				0x43425355U		// "USBC"
+#define CSW_SIGNATURE				0x53425355U		// "USBS"
+#define CBW_FLAG_IN					0x80U
+#define CBW_CB_LENGTH_MAX			16U
+
+#define CSW_PASSED					0x00U
+#define CSW_FAILED					0x01U
+#define CSW_PHASE_ERROR				0x02U
+
+/**
+  * @brief  SCSI Operation Codes
+  */
+#define SCSI_TEST_UNIT_READY		0x00U
+#define SCSI_REQUEST_SENSE			0x03U
+#define SCSI_INQUIRY				0x12U
+#define SCSI_MODE_SENSE6			0x1AU
+#define SCSI_START_STOP_UNIT		0x1BU
+#define SCSI_PREVENT_ALLOW			0x1EU
+#define SCSI_READ_FORMAT_CAPACITIES	0x23U
+#define SCSI_READ_CAPACITY10		0x25U
+#define SCSI_READ10					0x28U
+#define SCSI_WRITE10				0x2AU
+#define SCSI_VERIFY10				0x2FU
+#define SCSI_SYNCHRONIZE_CACHE10	0x35U
+#define SCSI_MODE_SENSE10			0x5AU
+
+/**
+  * @brief  SCSI Sense Keys and Additional Sense Codes
+  */
+#define SENSE_NONE					0x00U
+#define SENSE_NOT_READY				0x02U
+#define SENSE_MEDIUM_ERROR			0x03U
+#define SENSE_ILLEGAL_REQUEST		0x05U
+#define SENSE_DATA_PROTECT			0x07U
+
+#define ASC_WRITE_ERROR				0x0CU
+#define ASC_UNRECOVERED_READ_ERROR	0x11U
+#define ASC_INVALID_OPCODE			0x20U
+#define ASC_LBA_OUT_OF_RANGE		0x21U
+#define ASC_INVALID_FIELD_IN_CDB	0x24U
+#define ASC_LUN_NOT_SUPPORTED		0x25U
+#define ASC_WRITE_PROTECTED			0x27U
+#define ASC_MEDIUM_NOT_PRESENT		0x3AU
+
+/**
+  * @brief  SCSI Response Lengths and Fields
+  */
+#define INQUIRY_LENGTH				36U
+#define REQUEST_SENSE_LENGTH		18U
+#define READ_CAPACITY10_LENGTH		8U
+#define READ_FORMAT_CAP_LENGTH		12U
+#define MODE_SENSE6_LENGTH			4U
+#define MODE_SENSE10_LENGTH			8U
+#define MODE_WRITE_PROTECT			0x80U
+#define FORMAT_CAP_FORMATTED		0x02U
+
+#define INQUIRY_VENDOR				"AQC-1   "			// 8 characters
+#define INQUIRY_PRODUCT				"Flight Logs     "	// 16 characters
+#define INQUIRY_REVISION			"1.00"				// 4 characters
+
+/**
+  * @brief  Command Block Wrapper / Command Status Wrapper Types (little endian)
+  */
+typedef struct __attribute__((packed)) {
+	uint32_t signature;
+	uint32_t tag;
+	uint32_t data_length;		// bytes the host expects to move (H)
+	uint8_t flags;				// CBW_FLAG_IN: device to host
+	uint8_t lun;
+	uint8_t cb_length;
+	uint8_t cb[CBW_CB_LENGTH_MAX];
+} msc_cbw_t;
+
+typedef struct __attribute__((packed)) {
+	uint32_t signature;
+	uint32_t tag;
+	uint32_t residue;			// H minus bytes processed
+	uint8_t status;
+} msc_csw_t;
+
+_Static_assert(sizeof(msc_cbw_t) == MSC_CBW_LENGTH, "cbw layout");
+_Static_assert(sizeof(msc_csw_t) == MSC_CSW_LENGTH, "csw layout");
+_Static_assert(INQUIRY_LENGTH < MSC_PACKET_SIZE, "short responses must end with a short packet");
+
+/**
+  * @brief  Bulk-Only Transport State Type
+  */
+typedef enum {
+	BOT_OFFLINE,		// waiting for the interface to be configured
+	BOT_IDLE,			// cbw receive armed
+	BOT_DATA_IN,		// short response on the bus
+	BOT_XFER,			// READ(10) / WRITE(10) data phase
+	BOT_WAIT_HALT,		// endpoint stalled, csw follows once the host clears it
+	BOT_STATUS,			// csw on the bus
+	BOT_RECOVERY		// invalid cbw, stalled until a reset
+} bot_state_t;
+
+/**
+  * @brief  Transfer Buffers (word aligned for the sdio dma; buf[0] also holds
+  * 		short responses)
+  */
+static uint8_t buf[MSC_BUFFER_COUNT][MSC_BUFFER_SIZE] __attribute__((aligned(4)));
+static uint8_t cbw_buf[MSC_PACKET_SIZE] __attribute__((aligned(4)));
+static msc_csw_t csw __attribute__((aligned(4)));
+
+/**
+  * @brief  Interfaces and Command State
+  */
+static const msc_usb_interface_t *usb = NULL;
+static const msc_disk_interface_t *disk = NULL;
+static msc_cbw_t cbw;
+static bot_state_t state;
+static uint32_t capacity;			// blocks
+static bool read_only;
+static bool ejected;
+static bool is_open = false;
+static uint8_t sense_key, sense_asc;
+
+/**
+  * @brief  READ(10) / WRITE(10) Pipeline State
+  * 		NOTE: chunk k lives in buf[k % MSC_BUFFER_COUNT]; it is filled by the
+  * 		card (read) or the host (write) and drained by the other side
+  */
+static struct {
+	uint32_t lba;
+	uint32_t blocks;
+	uint32_t chunks;
+	uint32_t filled;			// chunks completely in a buffer
+	uint32_t drained;			// chunks completely out of a buffer
+	uint8_t result;				// CSW_FAILED / CSW_PHASE_ERROR once stopped
+	bool write;
+	bool fill_busy;
+	bool drain_busy;
+} xfer;
+
+/**
+  * @brief  Completion Flags (set in isr context)
+  */
+static volatile bool usb_tx_done;
+static volatile bool usb_rx_done;
+static volatile uint32_t usb_rx_len;
+static volatile bool disk_flag;
+static volatile bool disk_ok;
+static volatile bool reset_req;
+static volatile bool halt_cleared;
+
+/**
+  * @brief  Statistics and Errors Since the Last msc_service
+  */
+static msc_stats_t stats;
+static bool phase_errors;
+static bool disk_errors;
+
+
+/**
+  * @brief helper functions to access big endian fields
+  */
+static inline uint32_t get_be16(const uint8_t *p) {
+	return ((uint32_t) p[0] << 8) | p[1];
+}
+
+static inline uint32_t get_be32(const uint8_t *p) {
+	return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+
+static inline void put_be32(uint8_t *p, uint32_t v) {
+	p[0] = (uint8_t) (v >> 24);
+	p[1] = (uint8_t) (v >> 16);
+	p[2] = (uint8_t) (v >> 8);
+	p[3] = (uint8_t) v;
+}
+
+/**
+  * @brief helper function to arm the receive of the next cbw
+  *
+  * @retval None
+  */
+static void arm_cbw(void) {
+	usb_rx_done = false;
+	state = BOT_IDLE;
+	(void) usb->receive(cbw_buf, sizeof(cbw_buf));
+}
+
+/**
+  * @brief helper function to send the csw of the current command
+  *
+  * @param  status	CSW_PASSED / CSW_FAILED / CSW_PHASE_ERROR
+  * @param	residue	bytes the host expected but were not processed
+  *
+  * @retval None
+  */
+static void send_csw(uint8_t status, uint32_t residue) {
+	csw.signature = CSW_SIGNATURE;
+	csw.tag = cbw.tag;
+	csw.residue = residue;
+	csw.status = status;
+
+	if (status != CSW_PASSED)
+		++stats.failed;
+
+	usb_tx_done = false;
+	state = BOT_STATUS;
+	(void) usb->send((const uint8_t*) &csw, MSC_CSW_LENGTH);
+}
+
+/**
+  * @brief helper function to stall an endpoint and hold the csw until the
+  * 	   host clears it
+  *
+  * @param  in		stall the in (else out) endpoint
+  * @param	status	csw status
+  * @param	residue	csw residue
+  *
+  * @retval None
+  */
+static void stall_then_csw(bool in, uint8_t status, uint32_t residue) {
+	csw.signature = CSW_SIGNATURE;
+	csw.tag = cbw.tag;
+	csw.residue = residue;
+	csw.status = status;
+
+	if (status != CSW_PASSED)
+		++stats.failed;
+
+	state = BOT_WAIT_HALT;
+	usb->stall(in);
+}
+
+/**
+  * @brief helper function to end a command without a data phase
+  * 	   (stalls the pipe if the host expected data)
+  *
+  * @param  status	csw status
+  * @retval None
+  */
+static void complete(uint8_t status) {
+	if (cbw.data_length)
+		stall_then_csw(cbw.flags & CBW_FLAG_IN, status, cbw.data_length);
+	else
+		send_csw(status, 0U);
+}
+
+/**
+  * @brief helper function to fail a command with sense data
+  *
+  * @param  key		sense key
+  * @param	asc		additional sense code
+  *
+  * @retval None
+  */
+static void fail(uint8_t key, uint8_t asc) {
+	sense_key = key;
+	sense_asc = asc;
+	complete(CSW_FAILED);
+}
+
+/**
+  * @brief helper function to end a command whose data phase the host got
+  * 	   wrong (direction or length)
+  *
+  * @retval None
+  */
+static void phase_error(void) {
+	phase_errors = true;
+	complete(CSW_PHASE_ERROR);
+}
+
+/**
+  * @brief helper function to send a short response from buf[0], truncated to
+  * 	   what the host asked for (responses are shorter than a packet, so a
+  * 	   short packet tells the host when less than it expected follows)
+  *
+  * @param  len		response length
+  * @retval None
+  */
+static void reply(uint32_t len) {
+	uint32_t n = len;
+
+	if (!cbw.data_length && !len) {
+		send_csw(CSW_PASSED, 0U);
+		return;
+	}
+
+	if (!cbw.data_length || !(cbw.flags & CBW_FLAG_IN)) {
+		phase_error();
+		return;
+	}
+
+	if (n > cbw.data_length)
+		n = cbw.data_length;
+
+	csw.residue = cbw.data_length - n;
+
+	/* Nothing to send: stall in right away */
+	if (!n) {
+		stall_then_csw(true, CSW_PASSED, cbw.data_length);
+		return;
+	}
+
+	usb_tx_done = false;
+	state = BOT_DATA_IN;
+	(void) usb->send(buf[0], n);
+}
+
+/**
+  * @brief helper function to check the unit holds a medium
+  *
+  * @retval boolean (false after the command was failed)
+  */
+static bool medium_ready(void) {
+	if (ejected || !capacity) {
+		fail(SENSE_NOT_READY, ASC_MEDIUM_NOT_PRESENT);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief helper function to check a block range against the capacity
+  *
+  * @retval boolean (false after the command was failed)
+  */
+static bool range_valid(uint32_t lba, uint32_t blocks) {
+	if ((lba > capacity) || (blocks > capacity - lba)) {
+		fail(SENSE_ILLEGAL_REQUEST, ASC_LBA_OUT_OF_RANGE);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief helper function to build the INQUIRY response (direct access,
+  * 	   removable)
+  *
+  * @retval None
+  */
+static void scsi_inquiry(const uint8_t *cb) {
+	uint8_t *r = buf[0];
+	uint32_t alloc = get_be16(&cb[3]);
+
+	if (cb[1] & 0x01U) {
+		fail(SENSE_ILLEGAL_REQUEST, ASC_INVALID_FIELD_IN_CDB);		// no vital product data pages
+		return;
+	}
+
+	memset(r, 0, INQUIRY_LENGTH);
+	r[1] = 0x80U;			// removable
+	r[2] = 0x02U;			// SCSI-2
+	r[3] = 0x02U;			// response data format
+	r[4] = INQUIRY_LENGTH - 5U;
+	memcpy(&r[8], INQUIRY_VENDOR, 8U);
+	memcpy(&r[16], INQUIRY_PRODUCT, 16U);
+	memcpy(&r[32], INQUIRY_REVISION, 4U);
+
+	reply((alloc < INQUIRY_LENGTH) ? alloc : INQUIRY_LENGTH);
+}
+
+/**
+  * @brief helper function to build the fixed format REQUEST SENSE response
+  * 	   (reports and clears the last error)
+  *
+  * @retval None
+  */
+static void scsi_request_sense(const uint8_t *cb) {
+	uint8_t *r = buf[0];
+	uint32_t alloc = cb[4];
+
+	memset(r, 0, REQUEST_SENSE_LENGTH);
+	r[0] = 0x70U;			// current error, fixed format
+	r[2] = sense_key;
+	r[7] = REQUEST_SENSE_LENGTH - 8U;
+	r[12] = sense_asc;
+
+	sense_key = SENSE_NONE;
+	sense_asc = 0U;
+
+	reply((alloc < REQUEST_SENSE_LENGTH) ? alloc : REQUEST_SENSE_LENGTH);
+}
+
+/**
+  * @brief helper function to build a MODE SENSE(6) / (10) response: header
+  * 	   only (no pages, no block descriptors), carrying the write protect bit
+  *
+  * @retval None
+  */
+static void scsi_mode_sense(const uint8_t *cb, bool ten) {
+	uint8_t *r = buf[0];
+	uint32_t len = ten ? MODE_SENSE10_LENGTH : MODE_SENSE6_LENGTH;
+	uint32_t alloc = ten ? get_be16(&cb[7]) : cb[4];
+
+	memset(r, 0, len);
+
+	if (ten) {
+		r[1] = (uint8_t) (len - 2U);
+		r[3] = read_only ? MODE_WRITE_PROTECT : 0U;
+	} else {
+		r[0] = (uint8_t) (len - 1U);
+		r[2] = read_only ? MODE_WRITE_PROTECT : 0U;
+	}
+
+	reply((alloc < len) ? alloc : len);
+}
+
+/**
+  * @brief helper function to build the READ CAPACITY(10) response
+  *
+  * @retval None
+  */
+static void scsi_read_capacity(void) {
+	if (!medium_ready())
+		return;
+
+	put_be32(&buf[0][0], capacity - 1U);
+	put_be32(&buf[0][4], MSC_BLOCK_SIZE);
+
+	reply(READ_CAPACITY10_LENGTH);
+}
+
+/**
+  * @brief helper function to build the READ FORMAT CAPACITIES response
+  * 	   (one formatted media descriptor)
+  *
+  * @retval None
+  */
+static void scsi_read_format_capacities(const uint8_t *cb) {
+	uint8_t *r = buf[0];
+	uint32_t alloc = get_be16(&cb[7]);
+
+	if (!medium_ready())
+		return;
+
+	memset(r, 0, READ_FORMAT_CAP_LENGTH);
+	r[3] = 8U;				// capacity list length
+	put_be32(&r[4], capacity);
+	put_be32(&r[8], MSC_BLOCK_SIZE);
+	r[8] = FORMAT_CAP_FORMATTED;
+
+	reply((alloc < READ_FORMAT_CAP_LENGTH) ? alloc : READ_FORMAT_CAP_LENGTH);
+}
+
+/**
+  * @brief helper function to handle START STOP UNIT (eject / load)
+  *
+  * @retval None
+  */
+static void scsi_start_stop(const uint8_t *cb) {
+	bool load_eject = cb[4] & 0x02U;
+	bool start = cb[4] & 0x01U;
+
+	if (load_eject)
+		ejected = !start;
+
+	complete(CSW_PASSED);
+}
+
+/**
+  * @brief helper function to start a READ(10) / WRITE(10) data phase
+  *
+  * @param  cb		command block
+  * @param	write	WRITE(10) (else READ(10))
+  *
+  * @retval None
+  */
+static void scsi_read_write(const uint8_t *cb, bool write) {
+	uint32_t lba = get_be32(&cb[2]);
+	uint32_t blocks = get_be16(&cb[7]);
+
+	if (!medium_ready())
+		return;
+
+	if (write && read_only) {
+		fail(SENSE_DATA_PROTECT, ASC_WRITE_PROTECTED);
+		return;
+	}
+
+	if (!range_valid(lba, blocks))
+		return;
+
+	if (!blocks) {
+		complete(CSW_PASSED);
+		return;
+	}
+
+	/* Host and device must agree on direction and length */
+	if (((uint64_t) blocks * MSC_BLOCK_SIZE != cbw.data_length) ||
+		(!(cbw.flags & CBW_FLAG_IN) != write)) {
+		phase_error();
+		return;
+	}
+
+	memset(&xfer, 0, sizeof(xfer));
+	xfer.lba = lba;
+	xfer.blocks = blocks;
+	xfer.chunks = (blocks + MSC_BUFFER_BLOCKS - 1U) / MSC_BUFFER_BLOCKS;
+	xfer.write = write;
+
+	state = BOT_XFER;
+}
+
+/**
+  * @brief helper function to dispatch a received cbw
+  *
+  * @param  len		bytes received
+  * @retval None
+  */
+static void command(uint32_t len) {
+	const uint8_t *cb = cbw.cb;
+
+	memcpy(&cbw, cbw_buf, sizeof(cbw));
+
+	/* Not a valid cbw: stall both pipes until a reset (bot 6.6.1) */
+	if ((len != MSC_CBW_LENGTH) || (cbw.signature != CBW_SIGNATURE) ||
+		!cbw.cb_length || (cbw.cb_length > CBW_CB_LENGTH_MAX)) {
+		state = BOT_RECOVERY;
+		phase_errors = true;
+		usb->stall(true);
+		usb->stall(false);
+		return;
+	}
+
+	++stats.commands;
+
+	if (cbw.lun) {
+		fail(SENSE_ILLEGAL_REQUEST, ASC_LUN_NOT_SUPPORTED);
+		return;
+	}
+
+	switch (cb[0]) {
+		case SCSI_TEST_UNIT_READY:
+			if (medium_ready())
+				complete(CSW_PASSED);
+			break;
+
+		case SCSI_REQUEST_SENSE:
+			scsi_request_sense(cb);
+			break;
+
+		case SCSI_INQUIRY:
+			scsi_inquiry(cb);
+			break;
+
+		case SCSI_MODE_SENSE6:
+			scsi_mode_sense(cb, false);
+			break;
+
+		case SCSI_MODE_SENSE10:
+			scsi_mode_sense(cb, true);
+			break;
+
+		case SCSI_START_STOP_UNIT:
+			scsi_start_stop(cb);
+			break;
+
+		case SCSI_PREVENT_ALLOW:
+			complete(CSW_PASSED);
+			break;
+
+		case SCSI_READ_FORMAT_CAPACITIES:
+			scsi_read_format_capacities(cb);
+			break;
+
+		case SCSI_READ_CAPACITY10:
+			scsi_read_capacity();
+			break;
+
+		case SCSI_READ10:
+			scsi_read_write(cb, false);
+			break;
+
+		case SCSI_WRITE10:
+			scsi_read_write(cb, true);
+			break;
+
+		/* No byte compare; every written block is on the card before its csw */
+		case SCSI_VERIFY10:
+			if (medium_ready() && range_valid(get_be32(&cb[2]), get_be16(&cb[7])))
+				complete(CSW_PASSED);
+			break;
+
+		case SCSI_SYNCHRONIZE_CACHE10:
+			complete(CSW_PASSED);
+			break;
+
+		default:
+			fail(SENSE_ILLEGAL_REQUEST, ASC_INVALID_OPCODE);
+			break;
+	}
+}
+
+/**
+  * @brief helper function to get the block count of a chunk
+  *
+  * @retval blocks
+  */
+static inline uint32_t chunk_blocks(uint32_t k) {
+	uint32_t left = xfer.blocks - k * MSC_BUFFER_BLOCKS;
+
+	return (left < MSC_BUFFER_BLOCKS) ? left : MSC_BUFFER_BLOCKS;
+}
+
+/**
+  * @brief helper function to get the bytes of the chunks drained so far
+  *
+  * @retval bytes
+  */
+static inline uint32_t drained_bytes(void) {
+	uint32_t blocks = xfer.drained * MSC_BUFFER_BLOCKS;
+
+	return ((blocks < xfer.blocks) ? blocks : xfer.blocks) * MSC_BLOCK_SIZE;
+}
+
+/**
+  * @brief helper function to stop a transfer after a card error
+  *
+  * @retval None
+  */
+static void xfer_disk_error(void) {
+	xfer.result = CSW_FAILED;
+	sense_key = SENSE_MEDIUM_ERROR;
+	sense_asc = xfer.write ? ASC_WRITE_ERROR : ASC_UNRECOVERED_READ_ERROR;
+	disk_errors = true;
+}
+
+/**
+  * @brief helper function to retire the transfers that completed
+  *
+  * @retval None
+  */
+static void xfer_retire(void) {
+	bool disk_busy = xfer.write ? xfer.drain_busy : xfer.fill_busy;
+	bool usb_busy = xfer.write ? xfer.fill_busy : xfer.drain_busy;
+	bool usb_flag = xfer.write ? usb_rx_done : usb_tx_done;
+
+	if (disk_busy && disk_flag) {
+		disk_flag = false;
+
+		if (!disk_ok) {
+			xfer_disk_error();
+		} else if (xfer.write) {
+			stats.bytes_written += chunk_blocks(xfer.drained) * MSC_BLOCK_SIZE;
+			++xfer.drained;
+		} else {
+			++xfer.filled;
+		}
+
+		if (xfer.write)
+			xfer.drain_busy = false;
+		else
+			xfer.fill_busy = false;
+	}
+
+	if (usb_busy && usb_flag) {
+		if (xfer.write) {
+			usb_rx_done = false;
+			xfer.fill_busy = false;
+
+			/* Short packet before the announced length */
+			if (usb_rx_len != chunk_blocks(xfer.filled) * MSC_BLOCK_SIZE) {
+				xfer.result = CSW_PHASE_ERROR;
+				phase_errors = true;
+			} else {
+				++xfer.filled;
+			}
+		} else {
+			usb_tx_done = false;
+			xfer.drain_busy = false;
+			stats.bytes_read += chunk_blocks(xfer.drained) * MSC_BLOCK_SIZE;
+			++xfer.drained;
+		}
+	}
+}
+
+/**
+  * @brief helper function to fill the next free buffer (card read / host data)
+  *
+  * @retval None
+  */
+static void xfer_fill(void) {
+	uint32_t k = xfer.filled;
+	uint8_t *b = buf[k % MSC_BUFFER_COUNT];
+	uint32_t n = chunk_blocks(k);
+	bool ok;
+
+	if (xfer.write) {
+		usb_rx_done = false;
+		ok = usb->receive(b, n * MSC_BLOCK_SIZE);
+	} else {
+		if (!disk->ready())
+			return;
+
+		disk_flag = false;
+		ok = disk->read((uint32_t*) b, xfer.lba + k * MSC_BUFFER_BLOCKS, n);
+	}
+
+	if (!ok) {
+		if (xfer.write)
+			xfer.result = CSW_PHASE_ERROR;
+		else
+			xfer_disk_error();
+		return;
+	}
+
+	if (xfer.drain_busy)
+		++stats.overlapped;
+
+	xfer.fill_busy = true;
+}
+
+/**
+  * @brief helper function to drain the oldest full buffer (host data / card write)
+  *
+  * @retval None
+  */
+static void xfer_drain(void) {
+	uint32_t k = xfer.drained;
+	uint8_t *b = buf[k % MSC_BUFFER_COUNT];
+	uint32_t n = chunk_blocks(k);
+	bool ok;
+
+	if (xfer.write) {
+		if (!disk->ready())
+			return;
+
+		disk_flag = false;
+		ok = disk->write((const uint32_t*) b, xfer.lba + k * MSC_BUFFER_BLOCKS, n);
+	} else {
+		usb_tx_done = false;
+		ok = usb->send(b, n * MSC_BLOCK_SIZE);
+	}
+
+	if (!ok) {
+		if (xfer.write)
+			xfer_disk_error();
+		else
+			xfer.result = CSW_PHASE_ERROR;
+		return;
+	}
+
+	if (xfer.fill_busy)
+		++stats.overlapped;
+
+	xfer.drain_busy = true;
+}
+
+/**
+  * @brief helper function to advance the READ(10) / WRITE(10) pipeline: the
+  * 	   card and the host each work on their own buffer
+  *
+  * @retval None
+  */
+static void xfer_service(void) {
+	bool disk_busy, usb_busy;
+
+	xfer_retire();
+
+	if (xfer.result == CSW_PASSED) {
+		if (!xfer.fill_busy && (xfer.filled < xfer.chunks) && (xfer.filled - xfer.drained < MSC_BUFFER_COUNT))
+			xfer_fill();
+
+		if (!xfer.drain_busy && (xfer.drained < xfer.filled) && (xfer.result == CSW_PASSED))
+			xfer_drain();
+
+		if (xfer.drained == xfer.chunks)
+			send_csw(CSW_PASSED, 0U);
+
+		return;
+	}
+
+	/* Stopped: let the card finish (it owns a buffer) and the last packet
+	 * towards the host go out, then stall the data pipe (a receive still armed
+	 * for the host is abandoned) */
+	disk_busy = xfer.write ? xfer.drain_busy : xfer.fill_busy;
+	usb_busy = !xfer.write && xfer.drain_busy;
+
+	if (disk_busy || usb_busy)
+		return;
+
+	stall_then_csw(!xfer.write, xfer.result, cbw.data_length - drained_bytes());
+}
+
+/**
+  * @brief opens the mass storage unit over a disk (the usb class calls
+  * 	   msc_usb_reset once the host configures the interface)
+  *
+  * @param  usb_driver		bulk endpoint pair
+  * @param	disk_driver		block device
+  * @param	ro				report write protected and refuse writes
+  *
+  * @retval msc status (FATAL if there is no disk or a transfer is in flight)
+  */
+msc_status_t msc_open(const msc_usb_interface_t *usb_driver, const msc_disk_interface_t *disk_driver, bool ro) {
+	if ((is_open && (state == BOT_XFER)) || !usb_driver || !disk_driver ||
+		!disk_driver->ready || !disk_driver->block_count || !disk_driver->read || !disk_driver->write)
+		return MSC_ERROR_FATAL;
+
+	capacity = disk_driver->block_count();
+	if (!capacity)
+		return MSC_ERROR_FATAL;
+
+	usb = usb_driver;
+	disk = disk_driver;
+	read_only = ro;
+	ejected = false;
+	sense_key = SENSE_NONE;
+	sense_asc = 0U;
+
+	memset(&xfer, 0, sizeof(xfer));
+	memset(&stats, 0, sizeof(stats));
+	usb_tx_done = false;
+	usb_rx_done = false;
+	disk_flag = false;
+	reset_req = false;
+	halt_cleared = false;
+	phase_errors = false;
+	disk_errors = false;
+
+	state = BOT_OFFLINE;
+	is_open = true;
+
+	return MSC_OK;
+}
+
+/**
+  * @brief closes the unit (the card is free for FatFs again once no card
+  * 	   transfer is in flight, see msc_ejected)
+  *
+  * @retval None
+  */
+void msc_close(void) {
+	is_open = false;
+	state = BOT_OFFLINE;
+}
+
+/**
+  * @brief advances the current command (call from the main loop; never blocks)
+  *
+  * @retval msc status (WARN after a phase error, FATAL after a card error)
+  */
+msc_status_t msc_service(void) {
+	bool disk_busy = (state == BOT_XFER) && (xfer.write ? xfer.drain_busy : xfer.fill_busy);
+	msc_status_t status;
+
+	if (!is_open)
+		return MSC_OK;
+
+	if (disk_busy && disk->poll)
+		disk->poll();
+
+	/* Reset: wait for the card to release its buffer, then take a new cbw */
+	if (reset_req && !disk_busy) {
+		reset_req = false;
+		halt_cleared = false;
+		usb_tx_done = false;
+		memset(&xfer, 0, sizeof(xfer));
+		arm_cbw();
+	}
+
+	if (halt_cleared) {
+		halt_cleared = false;
+
+		if (state == BOT_WAIT_HALT) {
+			usb_tx_done = false;
+			state = BOT_STATUS;
+			(void) usb->send((const uint8_t*) &csw, MSC_CSW_LENGTH);
+		} else if (state == BOT_RECOVERY) {
+			usb->stall(true);
+			usb->stall(false);
+		}
+	}
+
+	switch (state) {
+		case BOT_IDLE:
+			if (usb_rx_done) {
+				usb_rx_done = false;
+				command(usb_rx_len);
+			}
+			break;
+
+		case BOT_DATA_IN:
+			if (usb_tx_done)
+				send_csw(CSW_PASSED, csw.residue);
+			break;
+
+		case BOT_XFER:
+			xfer_service();
+			break;
+
+		case BOT_STATUS:
+			if (usb_tx_done)
+				arm_cbw();
+			break;
+
+		default:
+			break;		// offline, or waiting for the host to clear a halt / reset
+	}
+
+	status = disk_errors ? MSC_ERROR_FATAL : phase_errors ? MSC_ERROR_WARN : MSC_OK;
+	disk_errors = false;
+	phase_errors = false;
+
+	return status;
+}
+
+/**
+  * @brief determines if the host ejected the unit (START STOP UNIT) and its
+  * 	   status went out, i.e. the host is done with the card
+  *
+  * @retval boolean
+  */
+bool msc_ejected(void) {
+	return is_open && ejected && (state == BOT_IDLE);
+}
+
+/**
+  * @brief fetches the statistics
+  *
+  * @param  out		statistics buffer to be filled
+  * @retval None
+  */
+void msc_get_stats(msc_stats_t *out) {
+	*out = stats;
+}
+
+/**
+  * @brief usb class callbacks: the transfer started by send / receive has
+  * 	   ended, a stalled endpoint was cleared, the host configured the
+  * 	   interface or reset the unit (isr context)
+  *
+  * @retval None
+  */
+void msc_usb_sent(void) {
+	usb_tx_done = true;
+}
+
+void msc_usb_received(uint32_t len) {
+	usb_rx_len = len;
+	usb_rx_done = true;
+}
+
+void msc_usb_halt_cleared(bool in) {
+	(void) in;
+	halt_cleared = true;
+}
+
+void msc_usb_reset(void) {
+	reset_req = true;
+}
+
+/**
+  * @brief disk driver callback: the transfer started by read / write has
+  * 	   ended (isr context)
+  *
+  * @param  ok		whether all blocks were transferred
+  * @retval None
+  */
+void msc_disk_done(bool ok) {
+	disk_ok = ok;
+	disk_flag = true;
+}
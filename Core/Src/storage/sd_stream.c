@@ -0,0 +1,360 @@
+/*
+ * sd_stream.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "storage/sd_stream.h"
+#include "common/cycles.h"
+
+/**
+  * @brief  Segment Ring (word aligned for the sdio dma)
+  * 		NOTE: queued segments start at send_idx, the segment being filled
+  * 		follows them; queued == SD_STREAM_SEGMENT_COUNT leaves none to fill
+  */
+static uint8_t ring[SD_STREAM_SEGMENT_COUNT][SD_STREAM_SEGMENT_SIZE] __attribute__((aligned(4)));
+static uint32_t seg_used[SD_STREAM_SEGMENT_COUNT];
+static uint32_t send_idx;
+static uint32_t queued;
+
+/**
+  * @brief  Card Region and Transfer State
+  */
+static const sd_card_interface_t *card = NULL;
+static uint32_t next_block;
+static uint32_t region_end;
+static uint32_t inflight;			// segments in the current transfer (0 if idle)
+static uint32_t inflight_blocks;
+static uint32_t inflight_start;		// cycles
+static volatile bool xfer_done;
+static volatile bool xfer_ok;
+static bool is_open;
+static bool closing;
+static bool failed;
+static bool full;
+static bool dropped;				// since the last sd_stream_service
+
+/**
+  * @brief  Statistics
+  */
+static sd_stream_stats_t stats;
+static uint32_t accepted;
+static uint32_t latency_max_cycles;
+static uint64_t busy_cycles;
+
+
+/**
+  * @brief helper function to convert cycles to microseconds
+  *
+  * @retval microseconds
+  */
+static inline uint32_t cycles_to_us(uint64_t cycles) {
+	return (uint32_t) (cycles * 1000000ULL / cycles_hz());
+}
+
+/**
+  * @brief helper function to get the segment being filled
+  *
+  * @retval segment index (SD_STREAM_SEGMENT_COUNT if the ring is full)
+  */
+static inline uint32_t fill_segment(void) {
+	if (queued == SD_STREAM_SEGMENT_COUNT)
+		return SD_STREAM_SEGMENT_COUNT;
+
+	return (send_idx + queued) % SD_STREAM_SEGMENT_COUNT;
+}
+
+/**
+  * @brief helper function to retire the completed transfer and free its segments
+  *
+  * @retval None
+  */
+static void complete_transfer(void) {
+	uint32_t elapsed = cycles_now() - inflight_start;
+
+	busy_cycles += elapsed;
+	if (elapsed > latency_max_cycles)
+		latency_max_cycles = elapsed;
+
+	if (xfer_ok) {
+		++stats.transfers;
+		stats.bytes_written += inflight_blocks * SD_BLOCK_SIZE;
+		next_block += inflight_blocks;
+	} else {
+		++stats.errors;
+		failed = true;
+	}
+
+	for (uint32_t i = 0; i < inflight; ++i) {
+		seg_used[send_idx] = 0U;
+		send_idx = (send_idx + 1U) % SD_STREAM_SEGMENT_COUNT;
+	}
+
+	queued -= inflight;
+	inflight = 0U;
+	xfer_done = false;
+}
+
+/**
+  * @brief helper function to start writing the oldest queued segments: as many
+  * 	   as are adjacent in the ring, up to and including a flushed (partial) one
+  *
+  * @retval None
+  */
+static void start_transfer(void) {
+	uint32_t run = queued;
+	uint32_t blocks = 0U;
+
+	if (send_idx + run > SD_STREAM_SEGMENT_COUNT)
+		run = SD_STREAM_SEGMENT_COUNT - send_idx;
+
+	for (uint32_t i = 0; i < run; ++i) {
+		uint32_t used = seg_used[send_idx + i];
+
+		blocks += (used + SD_BLOCK_SIZE - 1U) / SD_BLOCK_SIZE;
+		if (used < SD_STREAM_SEGMENT_SIZE) {
+			run = i + 1U;
+			break;
+		}
+	}
+
+	if (next_block + blocks > region_end) {
+		full = true;
+		return;
+	}
+
+	xfer_done = false;
+	xfer_ok = false;
+	inflight = run;
+	inflight_blocks = blocks;
+	inflight_start = cycles_now();
+
+	if (!card->write((const uint32_t*) ring[send_idx], next_block, blocks)) {
+		inflight = 0U;
+		++stats.errors;
+		failed = true;
+	}
+}
+
+/**
+  * @brief opens a stream over a contiguous run of card blocks
+  *
+  * @param  card_driver		card to write to
+  * @param	first_block		first block (lba) of the region
+  * @param	block_count		region length in blocks
+  *
+  * @retval sd stream status (FATAL if a transfer is still in flight)
+  */
+sd_stream_status_t sd_stream_open(const sd_card_interface_t *card_driver, uint32_t first_block, uint32_t block_count) {
+	if (inflight || !card_driver || !card_driver->ready || !card_driver->write || !block_count)
+		return SD_STREAM_ERROR_FATAL;
+
+	card = card_driver;
+	next_block = first_block;
+	region_end = first_block + block_count;
+
+	memset(seg_used, 0, sizeof(seg_used));
+	memset(&stats, 0, sizeof(stats));
+	send_idx = 0U;
+	queued = 0U;
+	accepted = 0U;
+	latency_max_cycles = 0U;
+	busy_cycles = 0U;
+	xfer_done = false;
+	closing = false;
+	failed = false;
+	full = false;
+	dropped = false;
+	is_open = true;
+
+	cycles_init();
+
+	return SD_STREAM_OK;
+}
+
+/**
+  * @brief appends bytes to the stream (copies, never waits on the card)
+  * 	   NOTE: not isr safe; bytes that do not fit in the ring are dropped
+  *
+  * @param  data	bytes to append
+  * @param	len		byte count
+  *
+  * @retval bytes accepted
+  */
+uint32_t sd_stream_write(const void *data, uint32_t len) {
+	const uint8_t *src = data;
+	uint32_t left = len;
+
+	if (!is_open || closing || failed || full) {
+		stats.bytes_dropped += len;
+		dropped = true;
+		return 0U;
+	}
+
+	while (left) {
+		uint32_t seg = fill_segment();
+		uint32_t n;
+
+		if (seg == SD_STREAM_SEGMENT_COUNT)
+			break;
+
+		n = SD_STREAM_SEGMENT_SIZE - seg_used[seg];
+		if (n > left)
+			n = left;
+
+		memcpy(&ring[seg][seg_used[seg]], src, n);
+		seg_used[seg] += n;
+		src += n;
+		left -= n;
+
+		if (seg_used[seg] == SD_STREAM_SEGMENT_SIZE)
+			++queued;
+	}
+
+	if (left) {
+		stats.bytes_dropped += left;
+		dropped = true;
+	}
+
+	accepted += len - left;
+
+	return len - left;
+}
+
+/**
+  * @brief fetches the free space in the ring (a write of up to this many
+  * 	   bytes is taken whole)
+  *
+  * @retval bytes
+  */
+uint32_t sd_stream_space(void) {
+	uint32_t seg = fill_segment();
+
+	if (!is_open || closing || failed || full || (seg == SD_STREAM_SEGMENT_COUNT))
+		return 0U;
+
+	return (SD_STREAM_SEGMENT_SIZE - seg_used[seg]) +
+		   (SD_STREAM_SEGMENT_COUNT - queued - 1U) * SD_STREAM_SEGMENT_SIZE;
+}
+
+/**
+  * @brief counts bytes the caller dropped instead of writing (e.g. a record
+  * 	   that would not fit whole)
+  *
+  * @param  len		byte count
+  * @retval None
+  */
+void sd_stream_discard(uint32_t len) {
+	stats.bytes_dropped += len;
+	dropped = true;
+}
+
+/**
+  * @brief retires a completed transfer and starts the next one (call from
+  * 	   the main loop; never blocks)
+  *
+  * @retval sd stream status (WARN if bytes were dropped since the last call
+  * 		or the region is full, FATAL after a card error)
+  */
+sd_stream_status_t sd_stream_service(void) {
+	sd_stream_status_t status = SD_STREAM_OK;
+
+	if (!is_open)
+		return SD_STREAM_OK;
+
+	if (inflight && card->poll)
+		card->poll();
+
+	if (inflight && xfer_done)
+		complete_transfer();
+
+	if (!inflight && queued && !failed && !full && card->ready())
+		start_transfer();
+
+	if (dropped || full)
+		status = SD_STREAM_ERROR_WARN;
+
+	dropped = false;
+
+	return failed ? SD_STREAM_ERROR_FATAL : status;
+}
+
+/**
+  * @brief queues the partially filled segment, padding its last block with zeros
+  * 	   NOTE: the padding is written to the card; the next bytes start a new block
+  *
+  * @retval None
+  */
+void sd_stream_flush(void) {
+	uint32_t seg = fill_segment();
+	uint32_t padded;
+
+	if ((seg == SD_STREAM_SEGMENT_COUNT) || !seg_used[seg])
+		return;
+
+	padded = (seg_used[seg] + SD_BLOCK_SIZE - 1U) / SD_BLOCK_SIZE * SD_BLOCK_SIZE;
+	memset(&ring[seg][seg_used[seg]], 0, padded - seg_used[seg]);
+	seg_used[seg] = padded;
+	++queued;
+}
+
+/**
+  * @brief flushes and stops accepting bytes; keep calling sd_stream_service
+  * 	   until sd_stream_idle
+  *
+  * @retval None
+  */
+void sd_stream_close(void) {
+	if (!is_open)
+		return;
+
+	sd_stream_flush();
+	closing = true;
+}
+
+/**
+  * @brief determines if nothing is left to write (or nothing more can be)
+  *
+  * @retval boolean
+  */
+bool sd_stream_idle(void) {
+	return !inflight && (!queued || failed || full);
+}
+
+/**
+  * @brief fetches the stream length (bytes accepted since open, without padding)
+  *
+  * @retval bytes
+  */
+uint32_t sd_stream_position(void) {
+	return accepted;
+}
+
+/**
+  * @brief fetches the stream statistics
+  *
+  * @param  out		statistics buffer to be filled
+  * @retval None
+  */
+void sd_stream_get_stats(sd_stream_stats_t *out) {
+	*out = stats;
+	out->latency_avg_us = (stats.transfers + stats.errors) ?
+						  cycles_to_us(busy_cycles / (stats.transfers + stats.errors)) : 0U;
+	out->latency_max_us = cycles_to_us(latency_max_cycles);
+	out->throughput_kbps = busy_cycles ?
+						   (uint32_t) ((uint64_t) stats.bytes_written * cycles_hz() / busy_cycles / 1024ULL) : 0U;
+}
+
+/**
+  * @brief card driver callback: the transfer started by sd_card_interface_t
+  * 	   write has ended (isr context)
+  *
+  * @param  ok		whether all blocks were written
+  * @retval None
+  */
+void sd_stream_write_done(bool ok) {
+	xfer_ok = ok;
+	xfer_done = true;
+}
@@ -0,0 +1,502 @@
+/*
+ * bench.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "system/bench.h"
+#include "flight/pid.h"
+#include "flight/attitude.h"
+#include "flight/altitude.h"
+#include "flight/position.h"
+#include "flight/mixer.h"
+#include "flight/rc_input.h"
+#include "esc/esc.h"
+#include "storage/blackbox.h"
+#include "sensors/gps/gps_parser.h"
+#include "esc/esc_telemetry_parser.h"
+#include "common/crc.h"
+#include "sensors/imu/devices/lsm6dsox.h"
+#include "lsm6dsox_reg.h"
+#include "common/cycles.h"
+#include "common/settings.h"
+
+/**
+  * @brief  Benchmark Config Settings
+  */
+#define BENCH						CONFIG_BENCH
+#define THRUST_COMP					CONFIG_THRUST_COMP
+
+/**
+  * @brief  Batch Sizes and Input Set (input count must be a power of 2)
+  */
+#define BENCH_CALLS					256U
+#define BENCH_BATCHES				64U
+#define BENCH_INPUTS				16U
+#define BENCH_INPUTS_MASK			(BENCH_INPUTS - 1U)
+
+_Static_assert((BENCH_INPUTS & BENCH_INPUTS_MASK) == 0U, "bench input count must be a power of 2");
+
+/**
+  * @brief  Fake LSM6DSOX Register File
+  */
+#define FAKE_REGS_SIZE				0x80U
+#define FAKE_CTRL3_C_SW_RESET		0x01U
+#define FAKE_FIFO_WORD_LEN			7U
+#define FAKE_FIFO_WORDS				3U			// gyro, accel, timestamp per odr period
+#define FAKE_TIMESTAMP_STEP			96U			// 2.4 ms in 25 us ticks
+
+/**
+  * @brief  Canned GPS Stream (a whole number of chunks; ~one loop of bytes
+  * 		per chunk at 115200 baud; a solution every 42nd loop is ~10 Hz)
+  */
+#define GPS_STREAM_FRAMES			7U
+#define GPS_STREAM_SIZE				(GPS_STREAM_FRAMES * (UBX_NAV_PVT_LEN + UBX_FRAME_OVERHEAD))
+#define GPS_CHUNK					28U
+#define GPS_SOLUTION_CALLS			42U
+
+_Static_assert((GPS_STREAM_SIZE % GPS_CHUNK) == 0U, "gps stream must be a whole number of chunks");
+
+/**
+  * @brief  Canned ESC Telemetry Stream (one frame per loop, round-robin)
+  */
+#define ESC_TLM_STREAM_FRAMES		BENCH_INPUTS
+#define ESC_TLM_LOOP_US				2398U
+
+/**
+  * @brief  Results (valid once bench_run has completed)
+  */
+static bench_result_t results[BENCH_COUNT];
+static bool have_result[BENCH_COUNT];
+
+#if (BENCH == ENABLED)
+/**
+  * @brief  Kernel Runner Type (calls the kernel n times)
+  */
+typedef void (*bench_runner_t)(uint32_t n);
+
+/**
+  * @brief  Inputs (cycled through so calls see varying data)
+  */
+static imu_6D_t imu_in[BENCH_INPUTS];
+static attitude_est_t est_in[BENCH_INPUTS];
+static attitude_cmd_t cmd_in[BENCH_INPUTS];
+static float throttle_in[BENCH_INPUTS];
+static altitude_est_t alt_in[BENCH_INPUTS];
+static mtr_cmds_t mcmd_in;
+static mtr_cmds_t mcmd_stop;
+static blackbox_record_t rec_in[BENCH_INPUTS];
+static uint8_t frame_out[BLACKBOX_FRAME_MAX];
+static uint8_t gps_stream[GPS_STREAM_SIZE];
+static gps_data_t gps_in;
+
+/**
+  * @brief  Kernel State and Result Sink (keeps results observable)
+  */
+static pid_ctrl_t pid;
+static attitude_est_t est;
+static altitude_cmd_t alt_cmd;
+static gps_parser_t gps_parser;
+static gps_data_t gps_out;
+static uint32_t gps_offset;
+static position_est_t pos;
+static uint32_t pos_calls;
+static uint8_t esc_tlm_stream[ESC_TLM_STREAM_FRAMES][ESC_TLM_FRAME_LEN];
+static esc_tlm_parser_t esc_tlm_parser;
+static esc_tlm_data_t esc_tlm_out;
+static uint64_t esc_tlm_now_us;
+static uint32_t esc_tlm_calls;
+static volatile float sink;
+
+static uint8_t fake_regs[FAKE_REGS_SIZE];
+static uint8_t fake_fifo[FAKE_FIFO_WORDS * FAKE_FIFO_WORD_LEN];
+static uint32_t fake_timestamp;
+static mag_data_t mag_in[BENCH_INPUTS];
+
+
+/**
+  * @brief fake bus register read (fifo output serves the canned words, each
+  * 	   burst one odr period later)
+  *
+  * @retval 0
+  */
+static int32_t fake_read(uint8_t reg, uint8_t *bufp, uint16_t len) {
+	if (reg == LSM6DSOX_FIFO_DATA_OUT_TAG) {
+		fake_timestamp += FAKE_TIMESTAMP_STEP;
+		memcpy(&fake_fifo[2U * FAKE_FIFO_WORD_LEN + 1U], &fake_timestamp, sizeof(fake_timestamp));
+
+		for (uint16_t i = 0; i < len; ++i)
+			bufp[i] = fake_fifo[i % sizeof(fake_fifo)];
+
+		return 0;
+	}
+
+	for (uint16_t i = 0; i < len; ++i)
+		bufp[i] = fake_regs[(reg + i) & (FAKE_REGS_SIZE - 1U)];
+
+	return 0;
+}
+
+/**
+  * @brief fake bus register write (software reset completes immediately)
+  *
+  * @retval 0
+  */
+static int32_t fake_write(uint8_t reg, const uint8_t *bufp, uint16_t len) {
+	for (uint16_t i = 0; i < len; ++i)
+		fake_regs[(reg + i) & (FAKE_REGS_SIZE - 1U)] = bufp[i];
+
+	fake_regs[LSM6DSOX_CTRL3_C] &= (uint8_t) ~FAKE_CTRL3_C_SW_RESET;
+
+	return 0;
+}
+
+static const lsm6dsox_bus_t fake_bus = {
+	.read = fake_read,
+	.write = fake_write
+};
+
+/**
+  * @brief helper function to store a little-endian word
+  *
+  * @retval None
+  */
+static void put_u32(uint8_t *buf, uint32_t offset, uint32_t value) {
+	buf[offset + 0U] = (uint8_t) value;
+	buf[offset + 1U] = (uint8_t) (value >> 8);
+	buf[offset + 2U] = (uint8_t) (value >> 16);
+	buf[offset + 3U] = (uint8_t) (value >> 24);
+}
+
+/**
+  * @brief helper function to build the canned gps stream (3D fix NAV-PVT
+  * 	   frames moving north at 1 m/s) and the estimator's gps solution
+  *
+  * @retval None
+  */
+static void setup_gps_inputs(void) {
+	uint8_t payload[UBX_NAV_PVT_LEN];
+	uint32_t len = 0U;
+
+	memset(payload, 0, sizeof(payload));
+	payload[20] = GPS_FIX_3D;
+	payload[21] = 0x01U;		// gnssFixOK
+	payload[23] = 12U;
+	put_u32(payload, 24U, 85455940U);
+	put_u32(payload, 40U, 800U);
+	put_u32(payload, 48U, 1000U);
+	put_u32(payload, 68U, 100U);
+
+	for (uint32_t i = 0; i < GPS_STREAM_FRAMES; ++i) {
+		put_u32(payload, 0U, 100U * i);
+		put_u32(payload, 28U, 473977420U + 90U * i);
+		len += ubx_frame(UBX_CLASS_NAV, UBX_ID_NAV_PVT, payload, UBX_NAV_PVT_LEN, &gps_stream[len]);
+	}
+
+	gps_in = (gps_data_t) {.lat_e7 = 473977420, .lon_e7 = 85455940, .vel_ned_mms = {1000, 0, 0},
+						   .h_acc_mm = 800U, .s_acc_mms = 100U, .fix = GPS_FIX_3D, .num_sv = 12U,
+						   .vel_valid = true, .fresh = true};
+
+	gps_parser_init(&gps_parser);
+	gps_offset = 0U;
+
+	/* Aligned, so the accelerometer path is timed too */
+	position_estimator_init(&pos, CONFIG_GPS_DELAY_MS * 1000U);
+	pos.heading_aligned = true;
+	pos_calls = 0U;
+}
+
+/**
+  * @brief helper function to fill the input set (deterministic, level-ish
+  * 	   attitude with small disturbances, mid throttle)
+  *
+  * @retval None
+  */
+static void setup_inputs(void) {
+	esc_cmd_props_t props;
+	pid_config_t config = {.Kp = 4.0f, .Ki = 2.0f, .Kd = 0.05f, .Wc = 50.0f, .limit = 200.0f, .integrator_limit = 50.0f};
+
+	for (uint32_t i = 0; i < BENCH_INPUTS; ++i) {
+		float d = (float) i - (float) (BENCH_INPUTS / 2U);
+
+		imu_in[i] = (imu_6D_t) {.accel_x = 10.0f * d, .accel_y = -7.0f * d, .accel_z = 1000.0f - d,
+								.rate_x = 500.0f * d, .rate_y = -300.0f * d, .rate_z = 100.0f * d, .dt = 2398U};
+		est_in[i] = (attitude_est_t) {.roll_angle_deg = 0.5f * d, .pitch_angle_deg = -0.3f * d,
+									  .roll_rate_dps = 2.0f * d, .pitch_rate_dps = -d, .yaw_rate_dps = 0.5f * d};
+		cmd_in[i] = (attitude_cmd_t) {.roll = 5.0f * d, .pitch = -4.0f * d, .yaw = 2.0f * d};
+		throttle_in[i] = 50.0f + d;
+		alt_in[i] = (altitude_est_t) {.altitude_m = 10.0f + 0.05f * d, .climb_rate_mps = 0.1f * d, .valid = true};
+		mag_in[i] = (mag_data_t) {.field_mgauss = {200.0f + 3.0f * d, -20.0f * d, -420.0f + d}, .fresh = ((i & 3U) == 0U)};
+		rec_in[i] = (blackbox_record_t) {.time_us = 2398U * i, .imu = imu_in[i], .est = est_in[i],
+										 .req = {.roll_angle = d, .throttle = throttle_in[i]},
+										 .mcmd = {.mtr1 = 1000.0f + d, .mtr2 = 1010.0f - d, .mtr3 = 990.0f + d, .mtr4 = 1005.0f}};
+	}
+
+	esc_get_command_properties(&props);
+	mcmd_in = (mtr_cmds_t) {.mtr1 = (float) props.liftoff, .mtr2 = (float) props.liftoff,
+							.mtr3 = (float) props.liftoff, .mtr4 = (float) props.liftoff};
+	mcmd_stop = (mtr_cmds_t) {.mtr1 = (float) props.min, .mtr2 = (float) props.min,
+							  .mtr3 = (float) props.min, .mtr4 = (float) props.min};
+
+	pid_init(&pid, &config);
+	memset(&est, 0, sizeof(est));
+	memset(&alt_cmd, 0, sizeof(alt_cmd));
+
+	/* Fake imu: identifies as lsm6dsox, a gyro, accel and timestamp word in the fifo per read */
+	memset(fake_regs, 0, sizeof(fake_regs));
+	fake_regs[LSM6DSOX_WHO_AM_I] = LSM6DSOX_ID;
+	fake_fifo[0U * FAKE_FIFO_WORD_LEN] = (uint8_t) (LSM6DSOX_GYRO_NC_TAG << 3);
+	fake_fifo[1U * FAKE_FIFO_WORD_LEN] = (uint8_t) (LSM6DSOX_XL_NC_TAG << 3);
+	fake_fifo[2U * FAKE_FIFO_WORD_LEN] = (uint8_t) (LSM6DSOX_TIMESTAMP_TAG << 3);
+	for (uint32_t i = 0; i < 6U; ++i) {
+		fake_fifo[0U * FAKE_FIFO_WORD_LEN + 1U + i] = (uint8_t) (0x10U + i);
+		fake_fifo[1U * FAKE_FIFO_WORD_LEN + 1U + i] = (uint8_t) (0x20U + i);
+	}
+	fake_timestamp = 0U;
+
+	setup_gps_inputs();
+
+	/* ESC telemetry frames (crc'd as the escs send them) */
+	for (uint32_t i = 0; i < ESC_TLM_STREAM_FRAMES; ++i) {
+		esc_motor_tlm_t tlm = {.voltage_v = 15.2f - 0.01f * (float) i, .current_a = 4.0f + 0.25f * (float) i,
+							   .erpm = 70000U + 1000U * i, .consumption_mah = (uint16_t) (100U + i),
+							   .temperature_c = (uint8_t) (40U + i)};
+
+		(void) esc_telemetry_frame(&tlm, esc_tlm_stream[i]);
+	}
+	esc_telemetry_parser_init(&esc_tlm_parser, CONFIG_ESC_TLM_TIMEOUT_US, CONFIG_ESC_TLM_STALE_MS * 1000U,
+							  CONFIG_ESC_MOTOR_POLES);
+	esc_tlm_now_us = 0U;
+	esc_tlm_calls = 0U;
+}
+
+/**
+  * @brief  Kernel Runners
+  */
+static void run_pid_update(uint32_t n) {
+	for (uint32_t i = 0; i < n; ++i)
+		sink = pid_update(&pid, cmd_in[i & BENCH_INPUTS_MASK].roll, est_in[i & BENCH_INPUTS_MASK].roll_rate_dps, 0.0024f);
+}
+
+static void run_complementary_filter(uint32_t n) {
+	for (uint32_t i = 0; i < n; ++i)
+		attitude_estimator_update(&imu_in[i & BENCH_INPUTS_MASK], &est);
+
+	sink = est.roll_angle_deg;
+}
+
+static void run_heading_update(uint32_t n) {
+	for (uint32_t i = 0; i < n; ++i)
+		attitude_heading_update(&imu_in[i & BENCH_INPUTS_MASK], &mag_in[i & BENCH_INPUTS_MASK], &est);
+
+	sink = est.heading_deg;
+}
+
+static void run_mixer_update(uint32_t n) {
+	mtr_cmds_t mcmd;
+
+	for (uint32_t i = 0; i < n; ++i) {
+		mixer_update(&mcmd, &cmd_in[i & BENCH_INPUTS_MASK], throttle_in[i & BENCH_INPUTS_MASK]);
+		sink = mcmd.mtr1;
+	}
+}
+
+#if THRUST_COMP == ENABLED
+static void run_thrust_compensate(uint32_t n) {
+	mtr_cmds_t mcmd;
+
+	for (uint32_t i = 0; i < n; ++i) {
+		mcmd = mcmd_in;
+		thrust_compensate(&mcmd, &est_in[i & BENCH_INPUTS_MASK]);
+		sink = mcmd.mtr1;
+	}
+}
+#endif
+
+static void run_map_pulse_to_state_request(uint32_t n) {
+	rc_reqs_t req;
+
+	for (uint32_t i = 0; i < n; ++i) {
+		rc_get_requests(&req);
+		sink = req.throttle;
+	}
+}
+
+static void run_esc_set_motor_commands(uint32_t n) {
+	for (uint32_t i = 0; i < n; ++i)
+		esc_set_motor_commands(&mcmd_stop);
+}
+
+static void run_lsm6dsox_read(uint32_t n) {
+	imu_6D_t imu;
+
+	for (uint32_t i = 0; i < n; ++i) {
+		fake_regs[LSM6DSOX_FIFO_STATUS1] = FAKE_FIFO_WORDS;
+		lsm6dsox_driver.read(&imu);
+		sink = imu.rate_x;
+	}
+}
+
+static void run_altitude_controller_update(uint32_t n) {
+	/* Throttle stick within the deadband: holds altitude */
+	for (uint32_t i = 0; i < n; ++i) {
+		altitude_controller_update(&alt_cmd, &(rc_reqs_t){.throttle = 50.0f + 0.25f * (float) (i & 7U)},
+								   &alt_in[i & BENCH_INPUTS_MASK], ALT_HOLD_MODE, 0.0024f);
+		sink = alt_cmd.throttle;
+	}
+}
+
+static void run_gps_parser_feed(uint32_t n) {
+	uint32_t fresh = 0U;
+
+	for (uint32_t i = 0; i < n; ++i) {
+		fresh += gps_parser_feed(&gps_parser, &gps_stream[gps_offset], GPS_CHUNK, &gps_out);
+		gps_offset = (gps_offset + GPS_CHUNK) % GPS_STREAM_SIZE;
+	}
+
+	sink = (float) fresh;
+}
+
+static void run_crc8(uint32_t n) {
+	uint32_t sum = 0U;
+
+	for (uint32_t i = 0; i < n; ++i)
+		sum += crc8(esc_tlm_stream[i & BENCH_INPUTS_MASK], ESC_TLM_FRAME_LEN - 1U);
+
+	sink = (float) sum;
+}
+
+static void run_esc_telemetry_parser_feed(uint32_t n) {
+	uint32_t frames = 0U;
+
+	for (uint32_t i = 0; i < n; ++i) {
+		esc_tlm_now_us += ESC_TLM_LOOP_US;
+		(void) esc_telemetry_parser_poll(&esc_tlm_parser, esc_tlm_now_us, &esc_tlm_out);
+		frames += esc_telemetry_parser_feed(&esc_tlm_parser, esc_tlm_stream[esc_tlm_calls++ & BENCH_INPUTS_MASK],
+											ESC_TLM_FRAME_LEN, esc_tlm_now_us, &esc_tlm_out);
+	}
+
+	sink = (float) frames;
+}
+
+static void run_position_estimator_update(uint32_t n) {
+	for (uint32_t i = 0; i < n; ++i) {
+		gps_in.fresh = ((++pos_calls % GPS_SOLUTION_CALLS) == 0U);
+		gps_in.lat_e7 = 473977420 + (int32_t) (pos_calls / GPS_SOLUTION_CALLS) * 9;
+		(void) position_estimator_update(&imu_in[i & BENCH_INPUTS_MASK], &est_in[i & BENCH_INPUTS_MASK], &gps_in, &pos);
+	}
+
+	sink = pos.pos_m[0];
+}
+
+static void run_blackbox_encode(uint32_t n) {
+	uint32_t len = 0U;
+
+	for (uint32_t i = 0; i < n; ++i)
+		len += blackbox_encode(&rec_in[i & BENCH_INPUTS_MASK], frame_out);
+
+	sink = (float) len;
+}
+
+/**
+  * @brief  Suite (function names as reported, see bench.h for static kernels;
+  * 		budgets in F405 cycles per call)
+  */
+static const struct {
+	const char *name;
+	bench_runner_t run;
+	uint32_t budget;
+} suite[BENCH_COUNT] = {
+	[BENCH_PID_UPDATE]					= {"pid_update",				run_pid_update,					400U},
+	[BENCH_COMPLEMENTARY_FILTER]		= {"attitude_estimator_update",	run_complementary_filter,		1500U},
+	[BENCH_MIXER_UPDATE]				= {"mixer_update",				run_mixer_update,				150U},
+#if THRUST_COMP == ENABLED
+	[BENCH_THRUST_COMPENSATE]			= {"thrust_compensate",			run_thrust_compensate,			600U},
+#endif
+	[BENCH_MAP_PULSE_TO_STATE_REQUEST]	= {"rc_get_requests",			run_map_pulse_to_state_request,	1200U},
+	[BENCH_ESC_SET_MOTOR_COMMANDS]		= {"esc_set_motor_commands",	run_esc_set_motor_commands,		300U},
+	[BENCH_LSM6DSOX_READ]				= {"lsm6dsox_read",				run_lsm6dsox_read,				1500U},
+	[BENCH_BLACKBOX_ENCODE]				= {"blackbox_encode",			run_blackbox_encode,			1500U},
+	[BENCH_ALTITUDE_CONTROLLER]			= {"altitude_controller_update",	run_altitude_controller_update,	400U},
+	[BENCH_GPS_PARSER_FEED]				= {"gps_parser_feed",			run_gps_parser_feed,			1500U},
+	[BENCH_POSITION_ESTIMATOR]			= {"position_estimator_update",	run_position_estimator_update,	2500U},
+	[BENCH_HEADING_UPDATE]				= {"attitude_heading_update",	run_heading_update,				1500U},
+	[BENCH_CRC8]						= {"crc8",						run_crc8,						120U},
+	[BENCH_ESC_TLM_PARSER_FEED]			= {"esc_telemetry_parser_feed",	run_esc_telemetry_parser_feed,	600U}
+};
+
+/**
+  * @brief helper function to time one kernel (one warm-up batch, then
+  * 	   BENCH_BATCHES timed batches)
+  *
+  * @retval None
+  */
+static void measure(bench_id_t id) {
+	uint64_t sum = 0U;
+	uint32_t start, elapsed, min = UINT32_MAX, max = 0U;
+
+	suite[id].run(BENCH_CALLS);
+
+	for (uint32_t b = 0; b < BENCH_BATCHES; ++b) {
+		start = cycles_now();
+		suite[id].run(BENCH_CALLS);
+		elapsed = cycles_now() - start;
+
+		sum += elapsed;
+		if (elapsed < min)
+			min = elapsed;
+		if (elapsed > max)
+			max = elapsed;
+	}
+
+	results[id] = (bench_result_t) {.name = suite[id].name, .calls = BENCH_CALLS, .batches = BENCH_BATCHES,
+									.min = min, .avg = (uint32_t) (sum / BENCH_BATCHES), .max = max,
+									.budget = suite[id].budget};
+	have_result[id] = true;
+}
+#endif
+
+/**
+  * @brief runs the whole suite (blocking; no-op unless CONFIG_BENCH)
+  * 	   NOTE: call after module init and esc start, before the flight loop
+  *
+  * @retval None
+  */
+void bench_run(void) {
+#if (BENCH == ENABLED)
+	cycles_init();
+	setup_inputs();
+
+	/* lsm6dsox init configures the fake device, the real one is untouched */
+	lsm6dsox_set_bus(&fake_bus);
+	lsm6dsox_driver.init();
+
+	for (uint32_t id = 0; id < BENCH_COUNT; ++id) {
+		if (suite[id].run)
+			measure((bench_id_t) id);
+	}
+
+	lsm6dsox_set_bus(NULL);
+	altitude_controller_reset(&alt_cmd);
+#endif
+}
+
+/**
+  * @brief fetches the result of one kernel
+  *
+  * @param  id		benchmarked kernel
+  * @param	out		result buffer to be filled
+  *
+  * @retval boolean (false if not run)
+  */
+bool bench_get(bench_id_t id, bench_result_t *out) {
+	memset(out, 0, sizeof(*out));
+
+	if ((id >= BENCH_COUNT) || !have_result[id])
+		return false;
+
+	*out = results[id];
+	return true;
+}
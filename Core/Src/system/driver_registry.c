@@ -0,0 +1,74 @@
+/*
+ * driver_registry.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stddef.h>
+#include "system/driver_registry.h"
+
+/**
+  * @brief  Registered Entries (section bounds from the linker; weak, so an
+  * 		image with no driver links with an empty registry)
+  */
+extern const driver_entry_t __start_aqc_drivers[] __attribute__((weak));
+extern const driver_entry_t __stop_aqc_drivers[] __attribute__((weak));
+
+
+/**
+  * @brief gets the registered driver count
+  *
+  * @retval drivers
+  */
+uint32_t driver_count(void) {
+	if ((__start_aqc_drivers == NULL) || (__stop_aqc_drivers == NULL))
+		return 0U;
+
+	return (uint32_t) (__stop_aqc_drivers - __start_aqc_drivers);
+}
+
+/**
+  * @brief gets a registered driver (link order)
+  *
+  * @param  index	entry index (< driver_count())
+  * @retval read-only pointer to entry (NULL if none)
+  */
+const driver_entry_t* driver_get(uint32_t index) {
+	return (index < driver_count()) ? &__start_aqc_drivers[index] : NULL;
+}
+
+/**
+  * @brief probes the drivers of a class on a bus and binds the best match
+  * 	   (its bind hook is handed the bus)
+  *
+  * @param  cls		driver class
+  * @param	bus		read-only pointer to probe bus
+  *
+  * @retval read-only pointer to entry (NULL if nothing matched; its
+  * 		interface is interfaces[bus->instance])
+  */
+const driver_entry_t* driver_bind(driver_class_t cls, const driver_bus_t *bus) {
+	const driver_entry_t *best = NULL;
+	uint8_t best_score = DRIVER_SCORE_NONE;
+	uint32_t count = driver_count();
+
+	for (uint32_t i = 0; i < count; ++i) {
+		const driver_entry_t *entry = &__start_aqc_drivers[i];
+		uint8_t score;
+
+		if ((entry->cls != cls) || (bus->instance >= entry->instances) || !entry->interfaces[bus->instance])
+			continue;
+
+		score = entry->probe ? entry->probe(bus) : DRIVER_SCORE_FALLBACK;
+		if (score > best_score) {
+			best = entry;
+			best_score = score;
+		}
+	}
+
+	if (best && best->bind)
+		best->bind(bus);
+
+	return best;
+}
@@ -0,0 +1,470 @@
+/*
+ * health.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "system/health.h"
+#include "common/time.h"
+#include "common/settings.h"
+#include "comms/link.h"
+#include "comms/messages.h"
+#include "comms/frame.h"
+#include "fatfs.h"
+
+/**
+  * @brief  Health Config Settings
+  */
+#define HEALTH_REPORT_USB			CONFIG_HEALTH_REPORT_USB
+#define HEALTH_REPORT_INTERVAL_MS	CONFIG_HEALTH_REPORT_INTERVAL_MS
+#define HEALTH_PERSIST_SD			CONFIG_HEALTH_PERSIST_SD
+#define HEALTH_LOG_FILE_NAME		"HEALTH.LOG"
+
+/**
+  * @brief  Event Ring / History Sizes (must be powers of 2)
+  */
+#define HEALTH_RING_SIZE			64U
+#define HEALTH_RING_MASK			(HEALTH_RING_SIZE - 1U)
+#define HEALTH_HISTORY_SIZE			128U
+#define HEALTH_HISTORY_MASK			(HEALTH_HISTORY_SIZE - 1U)
+
+#define HEALTH_REPORT_BUFFER_SIZE	512U
+#define HEALTH_REPORT_LINE_MAX		48U
+#define HEALTH_EVENTS_PER_FRAME		(FRAME_PAYLOAD_MAX / sizeof(msg_health_event_t))
+
+_Static_assert((HEALTH_RING_SIZE & HEALTH_RING_MASK) == 0U, "health ring size must be a power of 2");
+_Static_assert((HEALTH_HISTORY_SIZE & HEALTH_HISTORY_MASK) == 0U, "health history size must be a power of 2");
+
+/**
+  * @brief  Event Ring Slot Type
+  * 		NOTE: seq implements a bounded multi-producer/single-consumer queue;
+  * 		a slot is writable when seq == pos and readable when seq == pos + 1
+  */
+typedef struct {
+	volatile uint32_t seq;
+	health_event_t event;
+} health_slot_t;
+
+/**
+  * @brief  Event Ring (written from any context, drained by main loop only)
+  */
+static health_slot_t ring[HEALTH_RING_SIZE];
+static volatile uint32_t ring_head;
+static uint32_t ring_tail;
+static volatile uint32_t ring_dropped;
+
+/**
+  * @brief  Per-Module Counters (counts updated atomically at record time, the
+  * 		last code and time by the single consumer draining the ring)
+  */
+static health_counters_t counters[HEALTH_MODULE_COUNT];
+
+/**
+  * @brief  Event History (main loop only) and Reader Cursors
+  */
+static health_event_t history[HEALTH_HISTORY_SIZE];
+static uint32_t history_head;
+static uint32_t usb_cursor;
+static uint32_t sd_cursor;
+
+/**
+  * @brief  SD Persist Buffer and USB Report Timing
+  */
+static char persist_buffer[HEALTH_REPORT_BUFFER_SIZE];
+static uint32_t last_report_ms;
+
+/**
+  * @brief  Module / Severity Names for Text Summaries
+  */
+static const char *const module_names[HEALTH_MODULE_COUNT] = {
+	[HEALTH_MODULE_SYSTEM]		= "SYS",
+	[HEALTH_MODULE_RX]			= "RX",
+	[HEALTH_MODULE_RC]			= "RC",
+	[HEALTH_MODULE_IMU]			= "IMU",
+	[HEALTH_MODULE_ATTITUDE]	= "ATT",
+	[HEALTH_MODULE_ESC]			= "ESC",
+	[HEALTH_MODULE_STORAGE]		= "SD",
+	[HEALTH_MODULE_PARAMS]		= "PRM",
+	[HEALTH_MODULE_BARO]		= "BAR",
+	[HEALTH_MODULE_GPS]			= "GPS",
+	[HEALTH_MODULE_MAG]			= "MAG",
+	[HEALTH_MODULE_BATTERY]		= "BAT",
+	[HEALTH_MODULE_ESC_TLM]		= "ETL",
+	[HEALTH_MODULE_CRASH]		= "CRS",
+	[HEALTH_MODULE_CONTROL]		= "CTL",
+	[HEALTH_MODULE_ALTITUDE]	= "ALT",
+	[HEALTH_MODULE_POSITION]	= "POS",
+	[HEALTH_MODULE_ALT_HOLD]	= "AHD"
+};
+
+static const char *const severity_names[] = {
+	[HEALTH_SEVERITY_INFO]		= "INFO",
+	[HEALTH_SEVERITY_WARN]		= "WARN",
+	[HEALTH_SEVERITY_FATAL]		= "FATAL"
+};
+
+
+/**
+  * @brief init health subsystem (event ring, counters and history)
+  *
+  * @retval None
+  */
+void health_init(void) {
+	for (uint32_t i = 0; i < HEALTH_RING_SIZE; ++i) {
+		ring[i].seq = i;
+	}
+	ring_head = 0U;
+	ring_tail = 0U;
+	ring_dropped = 0U;
+
+	memset(counters, 0, sizeof(counters));
+
+	history_head = 0U;
+	usb_cursor = 0U;
+	sd_cursor = 0U;
+	last_report_ms = millis();
+}
+
+/**
+  * @brief records a health event (safe to call from any ISR or the main loop)
+  * 	   NOTE: O(1) and allocation-free; a full ring drops the event and counts it
+  *
+  * @param  module		event source module
+  * @param  severity	event severity
+  * @param  code		event code
+  *
+  * @retval boolean (false if the event was dropped)
+  */
+bool health_record(health_module_t module, health_severity_t severity, health_code_t code) {
+	health_slot_t *slot;
+	uint32_t pos, seq;
+	int32_t diff;
+
+	if (module >= HEALTH_MODULE_COUNT)
+		module = HEALTH_MODULE_SYSTEM;
+
+	uint32_t now = millis();
+
+	/* Update counts first so they stay exact even if the ring overflows */
+	if (severity == HEALTH_SEVERITY_FATAL) {
+		__atomic_fetch_add(&counters[module].fatal_count, 1U, __ATOMIC_RELAXED);
+	} else if (severity == HEALTH_SEVERITY_WARN) {
+		__atomic_fetch_add(&counters[module].warn_count, 1U, __ATOMIC_RELAXED);
+	}
+
+	/* Claim a slot (retries only if preempted by another producer) */
+	pos = __atomic_load_n(&ring_head, __ATOMIC_RELAXED);
+	for (;;) {
+		slot = &ring[pos & HEALTH_RING_MASK];
+		seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+		diff = (int32_t)(seq - pos);
+
+		if (diff == 0) {
+			if (__atomic_compare_exchange_n(&ring_head, &pos, pos + 1U, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+
+		} else if (diff < 0) {
+			/* Ring full */
+			__atomic_fetch_add(&ring_dropped, 1U, __ATOMIC_RELAXED);
+			return false;
+
+		} else {
+			pos = __atomic_load_n(&ring_head, __ATOMIC_RELAXED);
+		}
+	}
+
+	/* Fill and publish slot */
+	slot->event.timestamp_ms = now;
+	slot->event.module = (uint8_t) module;
+	slot->event.severity = (uint8_t) severity;
+	slot->event.code = (uint16_t) code;
+	__atomic_store_n(&slot->seq, pos + 1U, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+/**
+  * @brief records a module API status (OK statuses are ignored)
+  *
+  * @param  module	status source module
+  * @param  status	module status value (OK / WARN / FATAL)
+  *
+  * @retval None
+  */
+void health_report(health_module_t module, uint32_t status) {
+	if (status == STATUS_OK)
+		return;
+
+	health_record(module, (status >= STATUS_ERROR_FATAL) ? HEALTH_SEVERITY_FATAL : HEALTH_SEVERITY_WARN, HEALTH_CODE_STATUS);
+}
+
+/**
+  * @brief fetches the counters of a single module
+  *
+  * @param  module	module to fetch counters for
+  * @param	out		counters buffer to be filled
+  *
+  * @retval None
+  */
+void health_get_counters(health_module_t module, health_counters_t *out) {
+	if (module >= HEALTH_MODULE_COUNT) {
+		memset(out, 0, sizeof(*out));
+		return;
+	}
+	*out = counters[module];
+}
+
+/**
+  * @brief gets number of events dropped due to ring overflow
+  *
+  * @retval dropped event count
+  */
+uint32_t health_get_dropped(void) {
+	return ring_dropped;
+}
+
+/**
+  * @brief helper function to move published events from the ring into history
+  * 	   and set the last code and time of their modules (one writer, so
+  * 	   the pair always comes from the same event)
+  * 	   NOTE: at most one ring per call, so producers refilling it cannot keep
+  * 	   the main loop here (nor lap a history reader within one call)
+  *
+  * @retval None
+  */
+static void drain_ring(void) {
+	health_counters_t *c;
+	health_slot_t *slot;
+
+	for (uint32_t n = 0; n < HEALTH_RING_SIZE; ++n) {
+		slot = &ring[ring_tail & HEALTH_RING_MASK];
+		if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != ring_tail + 1U)
+			break;
+
+		history[history_head & HEALTH_HISTORY_MASK] = slot->event;
+		history_head++;
+
+		c = &counters[slot->event.module];
+		c->last_code = slot->event.code;
+		c->last_timestamp_ms = slot->event.timestamp_ms;
+
+		/* Release slot for the producer one lap ahead */
+		__atomic_store_n(&slot->seq, ring_tail + HEALTH_RING_SIZE, __ATOMIC_RELEASE);
+		ring_tail++;
+	}
+}
+
+/**
+  * @brief helper function to advance a history reader past overwritten events
+  *
+  * @param  cursor	pointer to reader cursor
+  * @retval number of events skipped
+  */
+static uint32_t catch_up_cursor(uint32_t *cursor) {
+	uint32_t skipped = 0U;
+
+	if (history_head - *cursor > HEALTH_HISTORY_SIZE) {
+		skipped = history_head - *cursor - HEALTH_HISTORY_SIZE;
+		*cursor = history_head - HEALTH_HISTORY_SIZE;
+	}
+	return skipped;
+}
+
+/**
+  * @brief copies the history events after a reader cursor (main loop only)
+  * 	   NOTE: a reader more than the history behind skips to the oldest kept
+  *
+  * @param  cursor	pointer to reader cursor (0 at init; advanced past the copied events)
+  * @param	out		events buffer to be filled
+  * @param	max		events buffer size
+  *
+  * @retval number of events copied
+  */
+uint32_t health_read_events(uint32_t *cursor, health_event_t *out, uint32_t max) {
+	uint32_t n = 0U;
+
+	catch_up_cursor(cursor);
+
+	while ((n < max) && (*cursor != history_head)) {
+		out[n++] = history[*cursor & HEALTH_HISTORY_MASK];
+		(*cursor)++;
+	}
+
+	return n;
+}
+
+/**
+  * @brief helper function to format the counter summary
+  *
+  * @param  buf		text buffer
+  * @param	size	text buffer size
+  * @param	now		current time (ms)
+  *
+  * @retval number of characters written
+  */
+static size_t format_summary(char *buf, size_t size, uint32_t now) {
+	size_t len;
+
+	len = (size_t) snprintf(buf, size, "HEALTH t=%lu dropped=%lu\r\n",
+							(unsigned long) now, (unsigned long) ring_dropped);
+
+	for (uint32_t m = 0; (m < HEALTH_MODULE_COUNT) && (len < size); ++m) {
+		const health_counters_t *c = &counters[m];
+
+		if ((c->warn_count == 0U) && (c->fatal_count == 0U))
+			continue;
+
+		len += (size_t) snprintf(&buf[len], size - len, "%s w=%lu f=%lu last=0x%04X@%lu\r\n",
+								 module_names[m], (unsigned long) c->warn_count, (unsigned long) c->fatal_count,
+								 c->last_code, (unsigned long) c->last_timestamp_ms);
+	}
+
+	return (len < size) ? len : size - 1U;
+}
+
+/**
+  * @brief helper function to format one event line
+  *
+  * @param  buf		text buffer
+  * @param	size	text buffer size
+  * @param	evt		read-only pointer to event
+  *
+  * @retval number of characters written
+  */
+static size_t format_event(char *buf, size_t size, const health_event_t *evt) {
+	const char *module = (evt->module < HEALTH_MODULE_COUNT) ? module_names[evt->module] : "?";
+	const char *severity = (evt->severity <= HEALTH_SEVERITY_FATAL) ? severity_names[evt->severity] : "?";
+	int len = snprintf(buf, size, "EVT %lu %s %s 0x%04X\r\n",
+					   (unsigned long) evt->timestamp_ms, module, severity, evt->code);
+
+	return (len > 0) ? (size_t) len : 0U;
+}
+
+#if HEALTH_REPORT_USB == ENABLED
+_Static_assert(sizeof(msg_health_summary_t) + HEALTH_MODULE_COUNT * sizeof(msg_health_module_t) <= FRAME_PAYLOAD_MAX,
+			   "health summary must fit one frame");
+
+/**
+  * @brief helper function to queue the counter summary on the USB link
+  *
+  * @param	now		current time (ms)
+  * @retval None
+  */
+static void send_summary(uint32_t now) {
+	uint8_t buf[sizeof(msg_health_summary_t) + HEALTH_MODULE_COUNT * sizeof(msg_health_module_t)];
+	msg_health_summary_t *msg = (msg_health_summary_t*) buf;
+
+	msg->timestamp_ms = now;
+	msg->dropped = ring_dropped;
+	msg->module_count = HEALTH_MODULE_COUNT;
+
+	for (uint32_t m = 0; m < HEALTH_MODULE_COUNT; ++m) {
+		msg->modules[m].warn_count = counters[m].warn_count;
+		msg->modules[m].fatal_count = counters[m].fatal_count;
+		msg->modules[m].last_code = counters[m].last_code;
+	}
+
+	link_send(MSG_HEALTH_SUMMARY, buf, sizeof(buf));
+}
+
+/**
+  * @brief helper function to queue new history events on the USB link
+  *
+  * @retval None
+  */
+static void send_events(void) {
+	msg_health_event_t batch[HEALTH_EVENTS_PER_FRAME];
+	uint32_t n;
+
+	catch_up_cursor(&usb_cursor);
+
+	while (usb_cursor != history_head) {
+		for (n = 0; (n < HEALTH_EVENTS_PER_FRAME) && ((usb_cursor + n) != history_head); ++n) {
+			const health_event_t *evt = &history[(usb_cursor + n) & HEALTH_HISTORY_MASK];
+			batch[n].timestamp_ms = evt->timestamp_ms;
+			batch[n].module = evt->module;
+			batch[n].severity = evt->severity;
+			batch[n].code = evt->code;
+		}
+
+		/* Keep events for the next report if the link is backed up */
+		if (link_send(MSG_HEALTH_EVENTS, batch, (uint16_t)(n * sizeof(msg_health_event_t))) != LINK_OK)
+			return;
+
+		usb_cursor += n;
+	}
+}
+#endif
+
+/**
+  * @brief health main loop service: drains ISR events and queues the
+  * 	   rate-limited summary and new events on the USB link (never blocks)
+  *
+  * @retval None
+  */
+void health_service(void) {
+	drain_ring();
+
+	#if HEALTH_REPORT_USB == ENABLED
+	uint32_t now = millis();
+
+	if ((now - last_report_ms) < HEALTH_REPORT_INTERVAL_MS)
+		return;
+
+	if (!link_is_connected())
+		return;
+
+	last_report_ms = now;
+
+	send_summary(now);
+	send_events();
+	#endif
+}
+
+/**
+  * @brief appends the health summary and all unsaved events to the SD card
+  * 	   NOTE: blocking (file system access); only call while disarmed
+  *
+  * @retval None
+  */
+void health_persist(void) {
+	#if HEALTH_PERSIST_SD == ENABLED
+	uint32_t skipped;
+	size_t len;
+	UINT written;
+	FIL file;
+
+	drain_ring();
+
+	if (f_open(&file, HEALTH_LOG_FILE_NAME, FA_OPEN_APPEND | FA_WRITE) != FR_OK) {
+		health_record(HEALTH_MODULE_STORAGE, HEALTH_SEVERITY_WARN, HEALTH_CODE_PERSIST_FAILED);
+		return;
+	}
+
+	/* Summary */
+	len = format_summary(persist_buffer, sizeof(persist_buffer), millis());
+	f_write(&file, persist_buffer, (UINT) len, &written);
+
+	/* Events not yet persisted */
+	skipped = catch_up_cursor(&sd_cursor);
+	if (skipped) {
+		len = (size_t) snprintf(persist_buffer, sizeof(persist_buffer), "EVT skipped=%lu\r\n", (unsigned long) skipped);
+		f_write(&file, persist_buffer, (UINT) len, &written);
+	}
+
+	while (sd_cursor != history_head) {
+		len = 0U;
+		while ((sd_cursor != history_head) && (sizeof(persist_buffer) - len > HEALTH_REPORT_LINE_MAX)) {
+			len += format_event(&persist_buffer[len], sizeof(persist_buffer) - len, &history[sd_cursor & HEALTH_HISTORY_MASK]);
+			sd_cursor++;
+		}
+		f_write(&file, persist_buffer, (UINT) len, &written);
+	}
+
+	if (f_close(&file) != FR_OK)
+		health_record(HEALTH_MODULE_STORAGE, HEALTH_SEVERITY_WARN, HEALTH_CODE_PERSIST_FAILED);
+	#endif
+}
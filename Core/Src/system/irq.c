@@ -0,0 +1,252 @@
+/*
+ * irq.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "system/irq.h"
+#include "common/cycles.h"
+#include "common/hardware.h"
+#include "common/time.h"
+
+/**
+  * @brief  Latency Test Config Settings
+  */
+#define IRQ_LATENCY_INJECT_INTERVAL_MS	CONFIG_IRQ_LATENCY_INJECT_INTERVAL_MS
+
+/**
+  * @brief  Priority Map Entry Type
+  */
+typedef struct {
+	IRQn_Type irqn;
+	uint32_t preempt;
+} irq_priority_t;
+
+/**
+  * @brief  Priority Map (see irq.h)
+  */
+static const irq_priority_t priority_map[] = {
+	{EXTI0_IRQn,		IRQ_PRIO_IMU_INT},
+	{SysTick_IRQn,		IRQ_PRIO_TICK},
+	{TIM2_IRQn,			IRQ_PRIO_RX_CAPTURE},
+	{TIM3_IRQn,			IRQ_PRIO_RX_CAPTURE},
+	{EXTI2_IRQn,		IRQ_PRIO_RX_SWITCH},
+	{EXTI3_IRQn,		IRQ_PRIO_RX_SWITCH},
+	{SDIO_IRQn,			IRQ_PRIO_SD},
+	{DMA2_Stream3_IRQn,	IRQ_PRIO_SD_DMA},
+	{DMA2_Stream6_IRQn,	IRQ_PRIO_SD_DMA},
+	{OTG_FS_IRQn,		IRQ_PRIO_USB}
+};
+
+_Static_assert(TICK_INT_PRIORITY == IRQ_PRIO_TICK, "stm32f4xx_hal_conf.h tick priority must match the irq map");
+_Static_assert((IRQ_PRIO_IMU_INT < IRQ_PRIO_SD) && (IRQ_PRIO_TICK < IRQ_PRIO_SD) &&
+			   (IRQ_PRIO_RX_CAPTURE < IRQ_PRIO_SD) && (IRQ_PRIO_RX_SWITCH < IRQ_PRIO_SD),
+			   "flight-critical interrupts must preempt storage");
+_Static_assert((IRQ_PRIO_SD < IRQ_PRIO_SD_DMA) && (IRQ_PRIO_SD_DMA < IRQ_PRIO_USB),
+			   "storage must preempt usb");
+
+#if (IRQ_LATENCY_TEST == ENABLED)
+/**
+  * @brief  Per-Source Accumulators (each written by its own isr only)
+  */
+static struct {
+	uint64_t sum;
+	uint32_t count;
+	uint32_t max;
+} acc[IRQ_SRC_COUNT];
+
+/**
+  * @brief  Timer Counter at ISR Entry and CPU Cycles per Timer Tick
+  */
+static volatile uint32_t tim2_entry;
+static volatile uint32_t tim3_entry;
+static uint32_t tim_cycles_per_tick;
+
+/**
+  * @brief  Injected EXTI Event (pin pending and cycle stamp at trigger)
+  */
+static volatile uint16_t inject_pin;
+static volatile uint32_t inject_cycles;
+static uint32_t last_inject_ms;
+
+
+/**
+  * @brief helper function to accumulate one latency sample
+  *
+  * @retval None
+  */
+static void record(irq_source_t src, uint32_t cycles) {
+	acc[src].sum += cycles;
+	++acc[src].count;
+
+	if (cycles > acc[src].max)
+		acc[src].max = cycles;
+}
+
+/**
+  * @brief records systick latency: the counter reloads at the event and
+  * 	   counts down at the cpu clock
+  * 	   NOTE: call first thing in SysTick_Handler
+  *
+  * @retval None
+  */
+void irq_latency_tick(void) {
+	record(IRQ_SRC_TICK, SysTick->LOAD - SysTick->VAL);
+}
+
+/**
+  * @brief latches the timer counter at isr entry (before the hal dispatches
+  * 	   capture callbacks)
+  * 	   NOTE: call first thing in TIMx_IRQHandler
+  *
+  * @param  tim		timer instance
+  * @retval None
+  */
+void irq_latency_timer_enter(const TIM_TypeDef *tim) {
+	if (tim == TIM2)
+		tim2_entry = TIM2->CNT;
+	else if (tim == TIM3)
+		tim3_entry = TIM3->CNT;
+}
+
+/**
+  * @brief records input capture latency: the capture register holds the
+  * 	   counter value at the edge
+  *
+  * @param  tim		timer instance
+  * @param	ccr		captured value
+  *
+  * @retval None
+  */
+void irq_latency_capture(const TIM_TypeDef *tim, uint32_t ccr) {
+	uint32_t entry, ticks;
+
+	if (tim == TIM2)
+		entry = tim2_entry;
+	else if (tim == TIM3)
+		entry = tim3_entry;
+	else
+		return;
+
+	ticks = (entry >= ccr) ? entry - ccr : (tim->ARR - ccr) + entry + 1U; // counter wrapped
+
+	record((tim == TIM2) ? IRQ_SRC_RX_TIM2 : IRQ_SRC_RX_TIM3, ticks * tim_cycles_per_tick);
+}
+
+/**
+  * @brief records latency of an injected exti event (real edges have no
+  * 	   event timestamp and are ignored)
+  * 	   NOTE: call first thing in EXTIx_IRQHandler
+  *
+  * @param  pin		gpio pin of the exti line
+  * @retval None
+  */
+void irq_latency_exti(uint16_t pin) {
+	uint32_t now = cycles_now();
+
+	if (inject_pin != pin)
+		return;
+
+	inject_pin = 0U;
+	record((pin == ARM_Pin) ? IRQ_SRC_RX_EXTI2 : IRQ_SRC_RX_EXTI3, now - inject_cycles);
+}
+
+/**
+  * @brief periodically triggers the rx switch exti lines from software,
+  * 	   alternating between them (the callback re-reads the pin, so the
+  * 	   switch level is unaffected)
+  * 	   NOTE: main loop context only
+  *
+  * @retval None
+  */
+void irq_latency_service(void) {
+	static bool arm_next = true;
+	uint16_t pin;
+
+	if ((inject_pin != 0U) || (millis() - last_inject_ms < IRQ_LATENCY_INJECT_INTERVAL_MS))
+		return;
+
+	last_inject_ms = millis();
+	pin = arm_next ? ARM_Pin : MODE_Pin;
+	arm_next = !arm_next;
+
+	/* Lines are enabled by rx start; a trigger pended before that would
+	   be counted from here to the enable */
+	if (!NVIC_GetEnableIRQ((pin == ARM_Pin) ? EXTI2_IRQn : EXTI3_IRQn))
+		return;
+
+	inject_cycles = cycles_now();
+	inject_pin = pin;
+	EXTI->SWIER = pin;
+}
+#endif
+
+/**
+  * @brief applies the interrupt priority map (does not enable interrupts;
+  * 	   drivers do that when they start)
+  * 	   NOTE: call after the MX_*_Init peripheral setup
+  *
+  * @retval None
+  */
+void irq_init(void) {
+	HAL_NVIC_SetPriorityGrouping(IRQ_PRIORITY_GROUP);
+
+	for (uint32_t i = 0; i < sizeof(priority_map) / sizeof(priority_map[0]); ++i)
+		HAL_NVIC_SetPriority(priority_map[i].irqn, priority_map[i].preempt, 0U);
+
+#if (IRQ_LATENCY_TEST == ENABLED)
+	cycles_init();
+	tim_cycles_per_tick = HAL_RCC_GetHCLKFreq() / Get_TIMxClkRefFreqHz(&htim2);	// rx timers share one clock (pwm_rx)
+	irq_latency_reset();
+	last_inject_ms = millis();
+#endif
+}
+
+/**
+  * @brief fetches latency statistics of a source
+  *
+  * @param  src		latency test source
+  * @param	out		statistics buffer to be filled
+  *
+  * @retval boolean (false if the latency test is not built in)
+  */
+bool irq_latency_get(irq_source_t src, irq_latency_t *out) {
+	memset(out, 0, sizeof(*out));
+
+#if (IRQ_LATENCY_TEST == ENABLED)
+	uint32_t primask;
+
+	if (src >= IRQ_SRC_COUNT)
+		return false;
+
+	/* Snapshot consistently against the isr writing it */
+	primask = __get_PRIMASK();
+	__disable_irq();
+	out->count = acc[src].count;
+	out->max = acc[src].max;
+	out->avg = acc[src].count ? (uint32_t) (acc[src].sum / acc[src].count) : 0U;
+	__set_PRIMASK(primask);
+
+	return true;
+#else
+	(void) src;
+	return false;
+#endif
+}
+
+/**
+  * @brief clears all latency statistics
+  *
+  * @retval None
+  */
+void irq_latency_reset(void) {
+#if (IRQ_LATENCY_TEST == ENABLED)
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	memset(acc, 0, sizeof(acc));
+	__set_PRIMASK(primask);
+#endif
+}
@@ -0,0 +1,86 @@
+/*
+ * profile.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "system/profile.h"
+#include "common/cycles.h"
+
+/**
+  * @brief  Per-Section Accumulators
+  */
+static struct {
+	uint64_t sum;
+	uint32_t count;
+	uint32_t min;
+	uint32_t max;
+} acc[PROFILE_COUNT];
+
+
+/**
+  * @brief init loop profiling (enables the cycle counter)
+  *
+  * @retval None
+  */
+void profile_init(void) {
+	cycles_init();
+	profile_reset();
+}
+
+/**
+  * @brief clears all statistics
+  *
+  * @retval None
+  */
+void profile_reset(void) {
+	memset(acc, 0, sizeof(acc));
+
+	for (uint32_t i = 0; i < PROFILE_COUNT; ++i)
+		acc[i].min = UINT32_MAX;
+}
+
+/**
+  * @brief records one measurement
+  * 	   NOTE: main loop context only
+  *
+  * @param  id		profiled section
+  * @param	cycles	measured cpu cycles
+  *
+  * @retval None
+  */
+void profile_record(profile_id_t id, uint32_t cycles) {
+	if (id >= PROFILE_COUNT)
+		return;
+
+	acc[id].sum += cycles;
+	++acc[id].count;
+
+	if (cycles < acc[id].min)
+		acc[id].min = cycles;
+
+	if (cycles > acc[id].max)
+		acc[id].max = cycles;
+}
+
+/**
+  * @brief fetches statistics of a profiled section
+  *
+  * @param  id		profiled section
+  * @param	out		statistics buffer to be filled
+  *
+  * @retval None
+  */
+void profile_get(profile_id_t id, profile_stats_t *out) {
+	memset(out, 0, sizeof(*out));
+
+	if ((id >= PROFILE_COUNT) || (acc[id].count == 0U))
+		return;
+
+	out->count = acc[id].count;
+	out->min = acc[id].min;
+	out->max = acc[id].max;
+	out->avg = (uint32_t) (acc[id].sum / acc[id].count);
+}
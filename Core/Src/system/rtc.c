@@ -0,0 +1,304 @@
+/*
+ * rtc.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include "stm32f4xx_hal.h"
+#include "system/rtc.h"
+#include "params/params.h"
+#include "common/datetime.h"
+#include "common/settings.h"
+#include "common/time.h"
+
+/*
+ * Register-level driver: the HAL rtc module is not part of this project.
+ */
+
+/**
+  * @brief  RTC Config Settings
+  */
+#define RTC_LSE						CONFIG_RTC_LSE
+#define RTC_LSE_STARTUP_MS			CONFIG_RTC_LSE_STARTUP_MS
+#define RTC_LSI_STARTUP_MS			5U
+#define RTC_INIT_TIMEOUT_MS			10U		// init mode entry and shadow register sync
+
+/**
+  * @brief  Prescalers (1 Hz calendar; async stage kept high for low power)
+  */
+#define RTC_PREDIV_A				127U
+#define RTC_PREDIV_S_LSE			255U	// 32768 Hz / 128 / 256
+#define RTC_PREDIV_S_LSI			249U	// 32000 Hz / 128 / 250
+
+/**
+  * @brief  Write Protection Keys
+  */
+#define RTC_WPR_KEY1				0xCAU
+#define RTC_WPR_KEY2				0x53U
+#define RTC_WPR_LOCK				0xFFU
+
+/**
+  * @brief  RTC State
+  */
+static rtc_source_t source = RTC_SOURCE_NONE;
+static uint32_t boot_id = 0U;
+
+
+/**
+  * @brief helper function to wait for register bits to be set
+  *
+  * @retval boolean (false on timeout)
+  */
+static bool wait_set(volatile uint32_t *reg, uint32_t mask, uint32_t timeout_ms) {
+	uint32_t start = millis();
+
+	while (!(*reg & mask)) {
+		if ((millis() - start) > timeout_ms)
+			return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief helper functions to convert between binary and bcd
+  */
+static inline uint32_t to_bcd(uint32_t v) {
+	return ((v / 10U) << 4) | (v % 10U);
+}
+
+static inline uint8_t from_bcd(uint32_t v) {
+	return (uint8_t) (((v >> 4) & 0x0FU) * 10U + (v & 0x0FU));
+}
+
+/**
+  * @brief helper function to enter init mode (calendar stopped, writable)
+  * 	   NOTE: leaves the registers unlocked; always pair with exit_init
+  *
+  * @retval boolean
+  */
+static bool enter_init(void) {
+	RTC->WPR = RTC_WPR_KEY1;
+	RTC->WPR = RTC_WPR_KEY2;
+
+	RTC->ISR |= RTC_ISR_INIT;
+	return wait_set(&RTC->ISR, RTC_ISR_INITF, RTC_INIT_TIMEOUT_MS);
+}
+
+/**
+  * @brief helper function to restart the calendar and lock the registers
+  *
+  * @retval boolean (false if the shadow registers did not resync)
+  */
+static bool exit_init(void) {
+	RTC->ISR &= ~(RTC_ISR_INIT | RTC_ISR_RSF);
+	RTC->WPR = RTC_WPR_LOCK;
+
+	return wait_set(&RTC->ISR, RTC_ISR_RSF, RTC_INIT_TIMEOUT_MS);
+}
+
+/**
+  * @brief helper function to start the rtc clock on a fresh backup domain
+  *
+  * @retval boolean
+  */
+static bool start_clock(void) {
+	uint32_t prediv_s;
+	bool ok;
+
+	/* Clock selection is locked until the backup domain is reset */
+	if (RCC->BDCR & RCC_BDCR_RTCSEL) {
+		RCC->BDCR |= RCC_BDCR_BDRST;
+		RCC->BDCR &= ~RCC_BDCR_BDRST;
+	}
+
+	#if RTC_LSE == ENABLED
+	RCC->BDCR |= RCC_BDCR_LSEON;
+	if (wait_set(&RCC->BDCR, RCC_BDCR_LSERDY, RTC_LSE_STARTUP_MS)) {
+		RCC->BDCR |= RCC_BDCR_RTCSEL_0 | RCC_BDCR_RTCEN;
+		source = RTC_SOURCE_LSE;
+		prediv_s = RTC_PREDIV_S_LSE;
+	} else
+	#endif
+	{
+		RCC->BDCR &= ~RCC_BDCR_LSEON;
+		RCC->CSR |= RCC_CSR_LSION;
+		if (!wait_set(&RCC->CSR, RCC_CSR_LSIRDY, RTC_LSI_STARTUP_MS))
+			return false;
+
+		RCC->BDCR |= RCC_BDCR_RTCSEL_1 | RCC_BDCR_RTCEN;
+		source = RTC_SOURCE_LSI;
+		prediv_s = RTC_PREDIV_S_LSI;
+	}
+
+	/* Both prescaler fields, in two writes as required */
+	ok = enter_init();
+	if (ok) {
+		RTC->PRER = prediv_s;
+		RTC->PRER |= RTC_PREDIV_A << RTC_PRER_PREDIV_A_Pos;
+	}
+
+	return exit_init() && ok;
+}
+
+/**
+  * @brief starts the rtc (keeps a running calendar) and counts this boot
+  * 	   NOTE: call after params_init; persists the boot counter (flash write)
+  *
+  * @retval rtc status
+  */
+rtc_status_t rtc_init(void) {
+	bool clock_ok = true;
+
+	__HAL_RCC_PWR_CLK_ENABLE();
+	PWR->CR |= PWR_CR_DBP;
+
+	/* Running since an earlier boot: LSI is not in the backup domain, restart it */
+	if (RCC->BDCR & RCC_BDCR_RTCEN) {
+		if ((RCC->BDCR & RCC_BDCR_RTCSEL) == RCC_BDCR_RTCSEL_0) {
+			source = RTC_SOURCE_LSE;
+		} else {
+			RCC->CSR |= RCC_CSR_LSION;
+			clock_ok = wait_set(&RCC->CSR, RCC_CSR_LSIRDY, RTC_LSI_STARTUP_MS);
+			source = RTC_SOURCE_LSI;
+		}
+	} else {
+		clock_ok = start_clock();
+	}
+
+	if (!clock_ok)
+		source = RTC_SOURCE_NONE;
+
+	/* Count Boot */
+	boot_id = params_get_u32(PARAM_SYS_BOOT_COUNT) + 1U;
+	if ((params_set(PARAM_SYS_BOOT_COUNT, (float) boot_id) != PARAM_OK) || (params_save() != PARAM_OK))
+		return clock_ok ? RTC_ERROR_WARN : RTC_ERROR_FATAL;
+
+	return clock_ok ? RTC_OK : RTC_ERROR_FATAL;
+}
+
+/**
+  * @brief determines if the calendar holds a wall time (set since the backup
+  * 	   domain was last powered up)
+  *
+  * @retval boolean
+  */
+bool rtc_is_set(void) {
+	return (source != RTC_SOURCE_NONE) && (RTC->ISR & RTC_ISR_INITS);
+}
+
+/**
+  * @brief fetches the rtc clock source
+  *
+  * @retval rtc source
+  */
+rtc_source_t rtc_get_source(void) {
+	return source;
+}
+
+/**
+  * @brief sets the calendar to a utc wall time
+  *
+  * @param  unix_s	seconds since 1970-01-01 00:00:00 (years 2000..2099)
+  * @retval rtc status (WARN if out of range, FATAL without rtc clock)
+  */
+rtc_status_t rtc_set_unix(uint32_t unix_s) {
+	datetime_t dt;
+	bool ok;
+
+	if (source == RTC_SOURCE_NONE)
+		return RTC_ERROR_FATAL;
+
+	if ((unix_s < DATETIME_UNIX_2000) || (unix_s >= DATETIME_UNIX_2100))
+		return RTC_ERROR_WARN;
+
+	datetime_from_unix(unix_s, &dt);
+
+	ok = enter_init();
+	if (ok) {
+		RTC->TR = (to_bcd(dt.hour) << RTC_TR_HU_Pos) | (to_bcd(dt.minute) << RTC_TR_MNU_Pos) |
+				  (to_bcd(dt.second) << RTC_TR_SU_Pos);
+		RTC->DR = (to_bcd(dt.year - 2000U) << RTC_DR_YU_Pos) | ((uint32_t) dt.weekday << RTC_DR_WDU_Pos) |
+				  (to_bcd(dt.month) << RTC_DR_MU_Pos) | (to_bcd(dt.day) << RTC_DR_DU_Pos);
+		RTC->CR &= ~RTC_CR_FMT;		// 24 hour format
+	}
+
+	return (exit_init() && ok) ? RTC_OK : RTC_ERROR_FATAL;
+}
+
+/**
+  * @brief fetches the wall time
+  *
+  * @param  unix_us		sub-second part buffer to be filled (optional)
+  * @retval seconds since 1970-01-01 00:00:00 (0 if not set)
+  */
+uint32_t rtc_get_unix(uint32_t *unix_us) {
+	uint32_t ssr, tr, dr, prediv_s;
+	datetime_t dt;
+
+	if (unix_us)
+		*unix_us = 0U;
+
+	if (!rtc_is_set())
+		return 0U;
+
+	/* Reading SSR locks TR and DR until DR is read (one consistent instant) */
+	ssr = RTC->SSR & RTC_SSR_SS;
+	tr = RTC->TR;
+	dr = RTC->DR;
+
+	dt.year = (uint16_t) (2000U + from_bcd((dr & (RTC_DR_YT | RTC_DR_YU)) >> RTC_DR_YU_Pos));
+	dt.month = from_bcd((dr & (RTC_DR_MT | RTC_DR_MU)) >> RTC_DR_MU_Pos);
+	dt.day = from_bcd((dr & (RTC_DR_DT | RTC_DR_DU)) >> RTC_DR_DU_Pos);
+	dt.hour = from_bcd((tr & (RTC_TR_HT | RTC_TR_HU)) >> RTC_TR_HU_Pos);
+	dt.minute = from_bcd((tr & (RTC_TR_MNT | RTC_TR_MNU)) >> RTC_TR_MNU_Pos);
+	dt.second = from_bcd((tr & (RTC_TR_ST | RTC_TR_SU)) >> RTC_TR_SU_Pos);
+
+	if (!datetime_is_valid(&dt))
+		return 0U;
+
+	/* Sub-seconds count down from PREDIV_S once per second */
+	prediv_s = RTC->PRER & RTC_PRER_PREDIV_S;
+	if (unix_us && (ssr <= prediv_s))
+		*unix_us = (prediv_s - ssr) * 1000000U / (prediv_s + 1U);
+
+	return datetime_to_unix(&dt);
+}
+
+/**
+  * @brief fetches this boot's id (boot counter value)
+  *
+  * @retval boot id (0 before rtc_init)
+  */
+uint32_t rtc_boot_id(void) {
+	return boot_id;
+}
+
+/**
+  * @brief fetches a time reference (wall time and micros() at one instant)
+  *
+  * @param  out		time reference buffer to be filled
+  * @retval None
+  */
+void rtc_get_time_ref(rtc_time_ref_t *out) {
+	out->boot_id = boot_id;
+	out->unix_s = rtc_get_unix(&out->unix_us);
+	out->clock_us = micros();
+}
+
+/**
+  * @brief fetches the wall time as FAT timestamp (file system dates)
+  *
+  * @retval fat date / time (0 if not set)
+  */
+uint32_t rtc_get_fattime(void) {
+	datetime_t dt;
+	uint32_t unix_s = rtc_get_unix(NULL);
+
+	if (!unix_s)
+		return 0U;
+
+	datetime_from_unix(unix_s, &dt);
+	return datetime_to_fattime(&dt);
+}
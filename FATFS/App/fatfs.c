@@ -45,7 +45,7 @@ void MX_FATFS_Init(void)
 DWORD get_fattime(void)
 {
   /* USER CODE BEGIN get_fattime */
-  return 0;
+  return rtc_get_fattime();	// 0 (1980-01-01) until the rtc is set
   /* USER CODE END get_fattime */
 }
 
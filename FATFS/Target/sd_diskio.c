@@ -22,6 +22,7 @@
 
 /* USER CODE BEGIN firstSection */
 /* can be used to modify / undefine following code or add new definitions */
+#include "storage/card/stm32_sd_card.h"
 /* USER CODE END firstSection*/
 
 /* Includes ------------------------------------------------------------------*/
@@ -476,6 +477,28 @@ DRESULT SD_ioctl(BYTE lun, BYTE cmd, void *buff)
 
 /* USER CODE BEGIN callbackSection */
 /* can be used to modify / following code or add new code */
+/*
+ * The generated completion callbacks below are renamed so these wrappers
+ * also hand each completion to the card driver (it owns the transfer and
+ * clears it here); this section survives a regeneration, they do not
+ */
+static void sd_diskio_write_cplt(void);
+static void sd_diskio_read_cplt(void);
+
+void BSP_SD_WriteCpltCallback(void)
+{
+  sd_diskio_write_cplt();
+  stm32_sd_card_tx_complete();
+}
+
+void BSP_SD_ReadCpltCallback(void)
+{
+  sd_diskio_read_cplt();
+  stm32_sd_card_rx_complete();
+}
+
+#define BSP_SD_WriteCpltCallback	sd_diskio_write_cplt
+#define BSP_SD_ReadCpltCallback		sd_diskio_read_cplt
 /* USER CODE END callbackSection */
 /**
   * @brief Tx Transfer completed callbacks
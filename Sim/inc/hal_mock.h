@@ -0,0 +1,58 @@
+/*
+ * hal_mock.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm32f4xx_hal.h"
+
+/*
+ * Mock side of the HAL handles in common/hardware.h (src/hal_mock.c): the
+ * timer instances hold their compare registers, and each one carries the
+ * clock reference the firmware's common/time.c would compute, the channels
+ * started on it and the status its next start returns. Devices attached to
+ * hi2c1 are register files the HAL i2c transfers read and write (the
+ * register address increments within a transfer, as on the sensors); an
+ * address with nothing attached fails the transfer like a NACK. Tools using
+ * it see the timer macros and calls from shim/hal.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define HAL_MOCK_TIM_CLOCK_HZ	3000000U	// 84 MHz timer clock / (27 + 1)
+#define HAL_MOCK_TIM_PERIOD		(60000U - 1U)	// 50 Hz
+
+#define HAL_MOCK_I2C_DEVICES	2U
+#define HAL_MOCK_I2C_REGS		256U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Mock Timer State Type
+  */
+typedef struct {
+	uint32_t clock_hz;					// Get_TIMxClkRefFreqHz (0: error)
+	uint32_t running;					// started channels (bit TIM_CHANNEL_x / 4)
+	HAL_StatusTypeDef start_status;		// returned by HAL_TIM_PWM_Start
+} hal_mock_tim_t;
+
+/**
+  * @brief  Mock I2C Device Type (register file on hi2c1)
+  */
+typedef struct {
+	uint16_t address;							// 8-bit bus address (0: not attached)
+	uint8_t regs[HAL_MOCK_I2C_REGS];
+	uint8_t self_clearing[HAL_MOCK_I2C_REGS];	// bits that read back 0 after a write (e.g. a reset)
+	uint32_t reads;								// transfers served
+	uint32_t writes;
+} hal_mock_i2c_dev_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void hal_mock_reset(void);
+
+hal_mock_tim_t* hal_mock_tim(const TIM_TypeDef *tim);
+
+hal_mock_i2c_dev_t* hal_mock_i2c_attach(uint16_t address);
@@ -0,0 +1,67 @@
+/*
+ * quad_model.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Rigid-body quadcopter model (X configuration).
+ *
+ * Body frame matches the firmware: x forward, y left, z up; positive roll is
+ * right side down, positive pitch is nose down. Motors are numbered as in the
+ * mixer (1 FL, 2 RL, 3 FR, 4 RR); 1 and 4 spin clockwise seen from above.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define QUAD_MOTOR_COUNT	4U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Quad Model Parameters
+  */
+typedef struct {
+	float mass_kg;
+	float arm_m;				// motor to center distance
+	float inertia_kgm2[3];		// diagonal inertia (x, y, z)
+	float thrust_max_n;			// per motor, at full command
+	float thrust_curve;			// 0 = quadratic, 1 = linear in command
+	float motor_tau_s;			// first-order motor response time constant
+	float yaw_moment_m;			// reaction torque per newton of thrust
+	float drag_linear;			// translational drag (N per m/s)
+	float drag_angular;			// rotational damping (Nm per rad/s)
+	float gravity_mps2;
+} quad_params_t;
+
+/**
+  * @brief  Quad Model State (world frame is x north, y west, z up)
+  */
+typedef struct {
+	float pos_m[3];
+	float vel_mps[3];
+	float quat[4];				// body to world (w, x, y, z)
+	float rate_rps[3];			// body angular rate
+	float accel_mps2[3];		// world acceleration of last step
+	float motor[QUAD_MOTOR_COUNT];	// normalized motor output (0..1)
+	float thrust_n[QUAD_MOTOR_COUNT];
+	bool on_ground;
+} quad_state_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void quad_default_params(quad_params_t *params);
+
+void quad_reset(quad_state_t *state);
+
+void quad_step(quad_state_t *state, const quad_params_t *params, const float cmd[QUAD_MOTOR_COUNT], float dt);
+
+void quad_specific_force(const quad_state_t *state, const quad_params_t *params, float out[3]);
+
+void quad_world_to_body(const quad_state_t *state, const float v[3], float out[3]);
+
+void quad_euler_deg(const quad_state_t *state, float *roll, float *pitch, float *yaw);
@@ -0,0 +1,146 @@
+/*
+ * replay.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "comms/messages.h"
+
+/*
+ * Blackbox replay.
+ *
+ * Loads a capture of the usb telemetry link (raw cobs frames, as written by
+ * a host logger or by the simulator with SITL_TRACE_LINK) and re-runs the
+ * estimator, attitude controller and mixer on the recorded imu and rc data,
+ * exactly as flight_update calls them on target.
+ *
+ * Each MSG_TLM_IMU frame starts a sample; the ATTITUDE, RC and MOTORS frames
+ * that follow belong to it. Captures of the batched firmware stream
+ * (MSG_TLM_BATCH) are aligned on the sample timestamps instead. Replay is only
+ * sample-accurate when the IMU topic was streamed at (or above) the flight
+ * loop rate; repeated IMU frames are dropped, skipped loops are not recovered.
+ *
+ * Typical use:
+ *
+ *   replay_log_t log;
+ *   replay_run_t run;
+ *   replay_load(&log, "flight.bin");
+ *   replay_run(&log, NULL, 0U, &run);
+ *   replay_compare(&log, replay_recorded(&log), run.out, diff);
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define REPLAY_HAVE_ATTITUDE	0x01U
+#define REPLAY_HAVE_RC			0x02U
+#define REPLAY_HAVE_MOTORS		0x04U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Replay Status Type
+  */
+typedef enum {
+	REPLAY_OK			= 0x00U,
+	REPLAY_ERROR_WARN	= 0x01U,
+	REPLAY_ERROR_FATAL	= 0x02U
+} replay_status_t;
+
+/**
+  * @brief  Replay Output Channels (compared between runs)
+  */
+typedef enum {
+	REPLAY_CH_EST_ROLL,
+	REPLAY_CH_EST_PITCH,
+	REPLAY_CH_MTR1,
+	REPLAY_CH_MTR2,
+	REPLAY_CH_MTR3,
+	REPLAY_CH_MTR4,
+	REPLAY_CH_COUNT
+} replay_channel_t;
+
+/**
+  * @brief  Replay Timed Stages
+  */
+typedef enum {
+	REPLAY_STAGE_ESTIMATOR,
+	REPLAY_STAGE_CONTROLLER,
+	REPLAY_STAGE_MIXER,
+	REPLAY_STAGE_COUNT
+} replay_stage_t;
+
+/**
+  * @brief  Recorded Sample (one flight loop)
+  */
+typedef struct {
+	msg_tlm_imu_t imu;
+	msg_tlm_attitude_t att;
+	msg_tlm_rc_t rc;			// carried forward if the loop had no rc frame
+	msg_tlm_motors_t mtr;
+	uint8_t have;				// REPLAY_HAVE_* frames seen for this loop
+} replay_sample_t;
+
+/**
+  * @brief  Loaded Log
+  */
+typedef struct {
+	replay_sample_t *samples;
+	float *recorded;			// count x REPLAY_CH_COUNT (NAN where not recorded)
+	uint32_t count;
+	uint32_t frames;			// frames decoded
+	uint32_t errors;			// crc / framing errors
+	uint32_t duplicates;		// repeated imu frames dropped
+} replay_log_t;
+
+/**
+  * @brief  Parameter Override
+  */
+typedef struct {
+	const char *name;
+	float value;
+} replay_param_t;
+
+/**
+  * @brief  Replay Run Result
+  */
+typedef struct {
+	float *out;					// count x REPLAY_CH_COUNT
+	uint64_t stage_ns[REPLAY_STAGE_COUNT];
+	uint32_t count;
+} replay_run_t;
+
+/**
+  * @brief  Channel Difference Statistics
+  */
+typedef struct {
+	float rms;
+	float max;
+	uint32_t samples;
+} replay_diff_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+replay_status_t replay_load(replay_log_t *log, const char *path);
+
+void replay_free(replay_log_t *log);
+
+replay_status_t replay_run(const replay_log_t *log, const replay_param_t *params, uint32_t param_count, replay_run_t *run);
+
+void replay_run_free(replay_run_t *run);
+
+void replay_compare(const replay_log_t *log, const float *a, const float *b, replay_diff_t diff[REPLAY_CH_COUNT]);
+
+const char *replay_channel_name(replay_channel_t ch);
+
+const char *replay_stage_name(replay_stage_t stage);
+
+/* Exported static inline functions ------------------------------------------*/
+/**
+  * @brief outputs recorded on target (NAN where the frame was missing)
+  */
+static inline const float *replay_recorded(const replay_log_t *log) {
+	return log->recorded;
+}
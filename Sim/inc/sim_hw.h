@@ -0,0 +1,67 @@
+/*
+ * sim_hw.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "sensors/imu/imu.h"
+#include "sensors/baro/baro.h"
+#include "sensors/gps/gps.h"
+#include "sensors/mag/mag.h"
+#include "sensors/battery/battery.h"
+#include "esc/esc.h"
+
+/*
+ * Simulator side of the hardware seams: the sim rx/imu/baro/gps/mag/battery/esc/esc telemetry/flash/sd drivers
+ * expose what the firmware wrote and serve what the physics model produced.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define SIM_RX_CHANNEL_COUNT	6U		// aetr + arm + mode, same as pwm rx
+
+/* Exported functions prototypes ---------------------------------------------*/
+void sim_rx_set_channel(uint8_t ch, uint32_t value);
+
+void sim_imu_set_sample(const imu_6D_t *sample);
+
+void sim_baro_set_sample(const baro_data_t *sample);
+
+void sim_gps_write(const uint8_t *buf, uint32_t len);
+
+uint32_t sim_gps_nav_pvt(const gps_data_t *sol, uint8_t *out);
+
+void sim_mag_set_sample(const float field_mgauss[3]);
+
+void sim_battery_set_sample(float voltage_v, float current_a);
+
+bool sim_esc_is_running(void);
+
+void sim_esc_get_commands(esc_cmds_t *out);
+
+void sim_esc_get_range(uint32_t *min, uint32_t *max);
+
+void sim_esc_set_write_hook(void (*hook)(void));
+
+bool sim_esc_take_telemetry_request(uint8_t *esc);
+
+void sim_esc_telemetry_write(const uint8_t *buf, uint32_t len);
+
+void ram_param_flash_format(void);
+
+void sim_sd_card_format(uint32_t block_count);
+
+const uint8_t *sim_sd_card_image(void);
+
+void sim_sd_card_fail_transfer(uint32_t n);
+
+uint32_t sim_sd_card_block_count(void);
+
+bool sim_sd_card_read_blocks(uint8_t *buf, uint32_t block, uint32_t count);
+
+bool sim_sd_card_write_blocks(const uint8_t *buf, uint32_t block, uint32_t count);
@@ -0,0 +1,24 @@
+/*
+ * sim_sd_diskio.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "ff_gen_drv.h"
+
+/*
+ * FatFs disk driver on the simulated card image (host counterpart of
+ * FATFS/Target/sd_diskio.c). Reads and writes are blocking and untimed, and
+ * fail while a streamed transfer is pending, like the shared sdio bus.
+ */
+
+/* External variables --------------------------------------------------------*/
+extern const Diskio_drvTypeDef sim_sd_diskio;
+
+/* Exported functions prototypes ---------------------------------------------*/
+uint32_t sim_sd_diskio_write_count(void);
@@ -0,0 +1,153 @@
+/*
+ * sitl.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdint.h>
+#include "flight/flight.h"
+#include "quad_model.h"
+
+/*
+ * Software-in-the-loop simulator.
+ *
+ * Links the unmodified flight modules (rc input, attitude and altitude
+ * estimation and control, position estimation, pid, mixer, esc, params) and
+ * closes the loop through sim rx/imu/baro/gps/mag/battery/esc/esc telemetry
+ * drivers and a rigid-body model. Time is simulated, so runs go as fast as
+ * the host allows.
+ *
+ * Typical use:
+ *
+ *   sitl_config_t cfg;
+ *   sitl_default_config(&cfg);
+ *   sitl_init(&cfg);
+ *   sitl_trace_open("run.csv", SITL_TRACE_CSV);
+ *   sitl_set_rc(&rc);
+ *   sitl_step(cfg.loop_hz * 10U);		// 10 s of flight
+ *   sitl_trace_close();
+ *
+ * Parameters can be changed between steps, by name (sitl_set_param) or via
+ * the firmware API (params_set).
+ *
+ * Every loop is checked against properties the flight code must hold for any
+ * input (see check_invariants in sitl.c): rate PID outputs within their
+ * command limits, the applied throttle within the stick range, the mixer
+ * splitting exactly into throttle/roll/pitch/yaw, and applied esc commands
+ * within the esc range. Violations are counted in the state snapshot; seeded
+ * runs with random sticks (aqc_sitl -s fuzz) exercise them over many inputs.
+ *
+ * The crash isr (sensors/imu/crash.h) can be fired inside the next motor
+ * command write (sitl_crash_irq_at_write); the loop then keeps the motors
+ * off on its latch as the firmware main loop does, until the arm switch is
+ * reset (aqc_sitl -s crash).
+ */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  SITL Status Type
+  */
+typedef enum {
+	SITL_OK				= 0x00U,
+	SITL_ERROR_WARN		= 0x01U,
+	SITL_ERROR_FATAL	= 0x02U
+} sitl_status_t;
+
+/**
+  * @brief  SITL Trace Format Type
+  */
+typedef enum {
+	SITL_TRACE_CSV		= 0x00U,
+	SITL_TRACE_BINARY	= 0x01U,	// self-describing header, then float32 records
+	SITL_TRACE_LINK		= 0x02U		// telemetry frames as captured from the usb link (replayable)
+} sitl_trace_format_t;
+
+/**
+  * @brief  SITL Configuration
+  */
+typedef struct {
+	quad_params_t quad;
+	uint32_t loop_hz;				// flight loop rate (imu output data rate)
+	uint32_t physics_substeps;		// model steps per flight loop
+	float gyro_noise_dps;			// white noise, 1 sigma
+	float gyro_bias_dps[3];
+	float accel_noise_mg;			// white noise, 1 sigma
+	float accel_bias_mg[3];
+	float baro_noise_pa;			// white noise, 1 sigma
+	float gps_pos_noise_m;			// gauss-markov (30 s), 1 sigma per axis
+	float gps_vel_noise_mps;		// white noise, 1 sigma per axis
+	uint32_t gps_delay_ms;			// epoch to last byte of its solution
+	float mag_noise_mgauss;			// white noise, 1 sigma per axis
+	float mag_offset_mgauss[3];		// hard iron (body frame, before calibration)
+	uint8_t batt_cells;				// lipo pack, starts charged
+	float batt_capacity_mah;
+	float batt_resistance_ohm;		// pack + wiring
+	float batt_noise_v;				// white noise, 1 sigma (after the adc averaging)
+	uint32_t seed;					// noise generator seed (runs are reproducible)
+} sitl_config_t;
+
+/**
+  * @brief  SITL Stick Inputs (pulse widths as seen by the receiver)
+  */
+typedef struct {
+	uint32_t roll_us;
+	uint32_t pitch_us;
+	uint32_t throttle_us;
+	uint32_t yaw_us;
+	bool arm;
+	mode_status_t mode;				// angle: switch low, else high (mode set by RC_MODE_SW_HIGH)
+} sitl_rc_t;
+
+/**
+  * @brief  SITL State Snapshot (truth and firmware view)
+  */
+typedef struct {
+	uint64_t loops;
+	double time_s;
+	quad_state_t quad;
+	float roll_deg;
+	float pitch_deg;
+	float yaw_deg;
+	flight_data_t flight;
+	flight_status_t status;
+	esc_cmds_t esc;
+	float batt_ocv_v;				// pack open circuit voltage
+	float batt_current_a;
+	float batt_consumed_mah;
+	float motor_rpm[QUAD_MOTOR_COUNT];
+	float motor_current_a[QUAD_MOTOR_COUNT];
+	float esc_temperature_c[QUAD_MOTOR_COUNT];
+	bool crash_latched;				// crash isr latch (see sitl_crash_irq_at_write)
+	uint32_t crash_disarms;			// crash isr disarms since sitl_init
+	uint32_t violations;			// invariant violations since sitl_init
+	const char *violation;			// first violated invariant (NULL if none)
+	uint64_t violation_loop;		// loop of the first violation
+} sitl_state_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void sitl_default_config(sitl_config_t *cfg);
+
+sitl_status_t sitl_init(const sitl_config_t *cfg);
+
+void sitl_set_rc(const sitl_rc_t *rc);
+
+sitl_status_t sitl_step(uint32_t loops);
+
+void sitl_get_state(sitl_state_t *out);
+
+uint64_t sitl_time_us(void);
+
+void sitl_crash_irq_at_write(void);
+
+void sitl_true_position_ne(const sitl_state_t *state, float ne[2]);
+
+sitl_status_t sitl_set_param(const char *name, float value);
+
+sitl_status_t sitl_trace_open(const char *path, sitl_trace_format_t format);
+
+void sitl_trace_close(void);
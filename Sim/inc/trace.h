@@ -0,0 +1,77 @@
+/*
+ * trace.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
+#include <stdio.h>
+#include "sitl.h"
+
+/*
+ * Binary Trace Layout (little endian):
+ *
+ *   | "AQCT" | version u16 | field count u16 | names ('\n' separated, '\0') |
+ *   | record: field count x float32 | record | ... |
+ *
+ * Field names and order match the CSV header, so either format loads into
+ * the same columns.
+ *
+ * Link traces hold the frames the firmware telemetry would send for every
+ * flight loop (IMU, ATTITUDE, RC, MOTORS in topic order), so they read like a
+ * capture of the usb link and can be fed to the replay tool.
+ */
+
+/* Exported macro constants --------------------------------------------------*/
+#define TRACE_VERSION		1U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Trace Record (one per flight loop)
+  */
+typedef struct {
+	float time_s;
+	float phase;
+	float pos_m[3];
+	float vel_mps[3];
+	float roll_deg;
+	float pitch_deg;
+	float yaw_deg;
+	float rate_dps[3];
+	float est_roll_deg;
+	float est_pitch_deg;
+	float est_rate_dps[3];
+	float req_roll_deg;
+	float req_pitch_deg;
+	float req_yaw_dps;
+	float req_throttle_pct;
+	float cmd_roll;
+	float cmd_pitch;
+	float cmd_yaw;
+	float esc[4];
+	float motor[4];
+	float alt_est_m;
+	float climb_est_mps;
+	float alt_target_m;			// estimate while altitude hold is not engaged
+	float throttle_pct;			// applied (stick or altitude hold)
+} trace_record_t;
+
+/**
+  * @brief  Trace Writer Handle
+  */
+typedef struct {
+	FILE *fp;
+	sitl_trace_format_t format;
+	uint8_t seq;
+} trace_t;
+
+/* Exported functions prototypes ---------------------------------------------*/
+bool trace_open(trace_t *t, const char *path, sitl_trace_format_t format);
+
+bool trace_write(trace_t *t, const sitl_state_t *state);
+
+void trace_close(trace_t *t);
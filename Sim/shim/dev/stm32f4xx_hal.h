@@ -0,0 +1,33 @@
+/*
+ * stm32f4xx_hal.h (device driver shim)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/*
+ * Device drivers linked into host tools (aqc_bench builds lsm6dsox.c) call
+ * a few HAL bus functions. This shim adds their declarations on top of the
+ * type-only SITL shim; the definitions live in src/bench_hal.c and are never
+ * reached, since the tools attach a bus override. Only the driver sources
+ * are compiled against this directory, and aqc_registry, which defines its
+ * own to probe the driver on its platform bus (aqc_unit links the i2c mock
+ * of src/hal_mock.c instead, through shim/hal).
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../stm32f4xx_hal.h"
+
+/* Exported macro constants --------------------------------------------------*/
+#define I2C_MEMADD_SIZE_8BIT	0x00000001U
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+									uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+								   uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+void HAL_Delay(uint32_t Delay);
@@ -0,0 +1,21 @@
+/*
+ * stm32f4xx_hal.h (fatfs shim)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/*
+ * FatFs is built for host tools with the firmware's own ffconf.h, which pulls
+ * in the sd bsp header. This shim adds the one HAL type that header names on
+ * top of the type-only SITL shim. Only FatFs and the modules that include
+ * ff.h are compiled against this directory.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../stm32f4xx_hal.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct { uint32_t reserved; } HAL_SD_CardInfoTypeDef;
@@ -0,0 +1,46 @@
+/*
+ * stm32f4xx_hal.h (timer mock shim)
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/*
+ * Protocol drivers linked into host tools (aqc_unit builds pwm_esc.c) start
+ * timer channels and write their compare registers. This shim adds those on
+ * top of the device driver shim (the HAL i2c calls): the compare macro writes
+ * the CCRx fields of the instance like the HAL does, and the timer instances,
+ * handles, start / stop calls and i2c transfers are mocks in src/hal_mock.c
+ * (see inc/hal_mock.h). Only the protocol driver sources, the mock and the
+ * tool are compiled against this directory.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "../dev/stm32f4xx_hal.h"
+
+/* Exported macro constants --------------------------------------------------*/
+#define TIM_CHANNEL_1			0x00000000U
+#define TIM_CHANNEL_2			0x00000004U
+#define TIM_CHANNEL_3			0x00000008U
+#define TIM_CHANNEL_4			0x0000000CU
+
+#define TIM4					(&hal_mock_tim4)
+#define TIM8					(&hal_mock_tim8)
+
+/* Exported macro functions --------------------------------------------------*/
+#define __HAL_TIM_SET_COMPARE(__HANDLE__, __CHANNEL__, __COMPARE__) \
+	(((__CHANNEL__) == TIM_CHANNEL_1) ? ((__HANDLE__)->Instance->CCR1 = (__COMPARE__)) : \
+	 ((__CHANNEL__) == TIM_CHANNEL_2) ? ((__HANDLE__)->Instance->CCR2 = (__COMPARE__)) : \
+	 ((__CHANNEL__) == TIM_CHANNEL_3) ? ((__HANDLE__)->Instance->CCR3 = (__COMPARE__)) : \
+	 ((__HANDLE__)->Instance->CCR4 = (__COMPARE__)))
+
+/* External variables --------------------------------------------------------*/
+extern TIM_TypeDef hal_mock_tim4;
+extern TIM_TypeDef hal_mock_tim8;
+
+/* Exported functions prototypes ---------------------------------------------*/
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel);
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef *htim, uint32_t Channel);
@@ -0,0 +1,38 @@
+/*
+ * stm32f4xx_hal.h (SITL shim)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/*
+ * Minimal stand-in for the ST HAL so that flight headers which pull in
+ * stm32f4xx_hal.h for handle types (e.g. sensors/imu/imu.h) compile on the
+ * host. Only types are provided: no SITL translation unit may call into HAL.
+ * Extend with further opaque handles as headers need them, never with
+ * functions.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+	HAL_OK		= 0x00U,
+	HAL_ERROR	= 0x01U,
+	HAL_BUSY	= 0x02U,
+	HAL_TIMEOUT	= 0x03U
+} HAL_StatusTypeDef;
+
+typedef struct { uint32_t reserved; } I2C_TypeDef;
+typedef struct { I2C_TypeDef *Instance; } I2C_HandleTypeDef;
+
+typedef struct { uint32_t reserved; } SPI_TypeDef;
+typedef struct { SPI_TypeDef *Instance; } SPI_HandleTypeDef;
+
+typedef struct { volatile uint32_t CCR1, CCR2, CCR3, CCR4; } TIM_TypeDef;
+typedef struct { uint32_t Prescaler; uint32_t Period; } TIM_Base_InitTypeDef;
+typedef struct { TIM_TypeDef *Instance; TIM_Base_InitTypeDef Init; uint32_t Channel; } TIM_HandleTypeDef;
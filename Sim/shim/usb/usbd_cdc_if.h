@@ -0,0 +1,39 @@
+/*
+ * usbd_cdc_if.h (usb cdc shim)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#pragma once
+
+/*
+ * The usb link (comms/link.c) linked into host tools (aqc_tlm) sees the
+ * device handle fields and the CDC transmit call it uses. The tool owns
+ * hUsbDeviceFS and CDC_Transmit_FS and plays the host side of the endpoint.
+ * Only the link sources are compiled against this directory.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported macro constants --------------------------------------------------*/
+#define USBD_STATE_DEFAULT		0x01U
+#define USBD_STATE_CONFIGURED	0x03U
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+	USBD_OK		= 0x00U,
+	USBD_BUSY	= 0x01U,
+	USBD_EMEM	= 0x02U,
+	USBD_FAIL	= 0x03U
+} USBD_StatusTypeDef;
+
+typedef struct {
+	volatile uint8_t dev_state;
+	void *pClassData;
+} USBD_HandleTypeDef;
+
+/* Exported functions prototypes ---------------------------------------------*/
+uint8_t CDC_Transmit_FS(uint8_t *Buf, uint16_t Len);
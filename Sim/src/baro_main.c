@@ -0,0 +1,750 @@
+/*
+ * baro_main.c (barometer driver and altitude estimator host test)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sensors/baro/devices/bmp3xx.h"
+#include "flight/altitude.h"
+#include "common/cycles.h"
+#include "common/settings.h"
+
+/*
+ * Runs sensors/baro/devices/bmp3xx.c and flight/altitude.c unmodified against
+ * a fake BMP3xx register file on a virtual clock. The fake device converts
+ * the pressure it is given into raw ADC counts by inverting the datasheet
+ * floating-point compensation, so every sample goes through the driver's
+ * fixed-point compensation on its way to the estimator.
+ *
+ * First the fixed-point compensation is compared with the floating-point
+ * reference over -40..85 degC and 30..110 kPa, then the driver is checked
+ * (device id, calibration, no bus access before a conversion is due, at most
+ * one transaction per loop, conversion rate, a stuck sensor and bus errors):
+ *
+ *   {"mode": "checks", "checks": 29, "failed": 0, "comp_err_max_pa": 0.013, ...}
+ *
+ * then a 40 s flight is flown (climb to 15 m, bob, descend) with the vehicle
+ * banking up to 20 deg, a 20 mg accelerometer bias and sensor noise:
+ *
+ *   {"mode": "flight", "alt_rms_m": 0.031, "baro_alt_rms_m": 0.087,
+ *    "climb_rms_mps": 0.020, "baro_climb_rms_mps": 6.074,
+ *    "body_z_alt_rms_m": 0.185, "body_z_climb_rms_mps": 0.313, ...}
+ *
+ * baro_* is the barometer alone (altitude per sample, climb rate by finite
+ * difference between samples); body_z_* is the estimator fed the body z axis
+ * instead of the earth frame vertical (attitude zeroed).
+ *
+ * -r FILE replays recorded pressure (CSV: time_s,pressure_pa[,temperature_c],
+ * any header lines skipped) through the fake device with the vehicle at rest,
+ * and reports the noise and drift of the baro altitude and of the estimate.
+ *
+ * The exit status is 1 if any check fails.
+ */
+
+/**
+  * @brief  Simulation Setup
+  */
+#define LOOP_HZ					417.0
+#define FLIGHT_SECONDS			40.0
+#define GRAVITY					9.80665
+
+#define BARO_NOISE_PA			1.0		// 1 sigma, standard resolution
+#define ACCEL_NOISE_MG			5.0
+#define ACCEL_BIAS_MG			20.0	// z axis
+#define ATT_NOISE_DEG			0.5		// attitude estimate error, 1 sigma
+#define CONV_FRACTION			0.9		// actual / worst-case conversion time
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+/**
+  * @brief  Calibration of the Fake Device (NVM integers, BMP388-like)
+  */
+static const bmp3xx_calib_t dev_calib = {
+	.t1 = 27000U, .t2 = 19000U, .t3 = -10,
+	.p1 = 600, .p2 = -2800, .p3 = 35, .p4 = 2,
+	.p5 = 25000U, .p6 = 30000U, .p7 = 5, .p8 = -8,
+	.p9 = 16000, .p10 = 10, .p11 = -60
+};
+
+/**
+  * @brief  Virtual Clock
+  */
+static double now;
+
+/**
+  * @brief  Fake Device (register file, conversion in flight, bus accounting)
+  */
+static struct {
+	uint8_t regs[128];
+	double pressure_pa;			// what the sensor sees
+	double temperature_c;
+	bool converting;
+	double trigger_at;
+	double done_at;
+	uint32_t pending_press;
+	uint32_t pending_temp;
+	bool stuck;					// conversions never complete
+	uint32_t fail_next;			// transactions to fail
+	uint32_t loop_transactions;
+	uint32_t max_loop_transactions;
+	uint32_t early_reads;		// status read before the worst-case conversion time
+	uint32_t triggers;
+} dev;
+
+static unsigned checks;
+static unsigned failures;
+static uint32_t rng_state = 1U;
+
+
+/**
+  * @brief firmware clock on the virtual clock
+  */
+uint32_t millis(void) {
+	return (uint32_t) (now / 1000.0);
+}
+
+uint64_t micros(void) {
+	return (uint64_t) now;
+}
+
+static void check(bool cond, const char *what, int line) {
+	checks++;
+
+	if (!cond) {
+		failures++;
+		fprintf(stderr, "baro_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+/**
+  * @brief xorshift32 standard normal sample (Box-Muller)
+  */
+static double rand_normal(void) {
+	double u[2];
+
+	for (int i = 0; i < 2; ++i) {
+		rng_state ^= rng_state << 13;
+		rng_state ^= rng_state >> 17;
+		rng_state ^= rng_state << 5;
+		u[i] = ((double) (rng_state >> 8) + 1.0) / 16777216.0;
+	}
+
+	return sqrt(-2.0 * log(u[0])) * cos(6.283185307179586 * u[1]);
+}
+
+/**
+  * @brief datasheet floating-point compensation (reference)
+  */
+static double ref_t_lin(const bmp3xx_calib_t *c, double ut) {
+	double pd1 = ut - (double) c->t1 * 256.0;
+	return pd1 * ((double) c->t2 / 1073741824.0) + pd1 * pd1 * ((double) c->t3 / 281474976710656.0);
+}
+
+static double ref_pressure(const bmp3xx_calib_t *c, double up, double t) {
+	double p1 = ((double) c->p1 - 16384.0) / 1048576.0;
+	double p2 = ((double) c->p2 - 16384.0) / 536870912.0;
+	double p3 = (double) c->p3 / 4294967296.0;
+	double p4 = (double) c->p4 / 137438953472.0;
+	double p5 = (double) c->p5 * 8.0;
+	double p6 = (double) c->p6 / 64.0;
+	double p7 = (double) c->p7 / 256.0;
+	double p8 = (double) c->p8 / 32768.0;
+	double p9 = (double) c->p9 / 281474976710656.0;
+	double p10 = (double) c->p10 / 281474976710656.0;
+	double p11 = (double) c->p11 / 36893488147419103232.0;
+
+	double out1 = p5 + p6 * t + p7 * t * t + p8 * t * t * t;
+	double out2 = up * (p1 + p2 * t + p3 * t * t + p4 * t * t * t);
+	double out3 = up * up * (p9 + p10 * t) + up * up * up * p11;
+
+	return out1 + out2 + out3;
+}
+
+/**
+  * @brief raw counts the sensor reports for a temperature / pressure
+  * 	   (bisection over the monotonic reference)
+  */
+static uint32_t raw_temp_for(const bmp3xx_calib_t *c, double temp_c) {
+	double lo = 0.0, hi = 16777215.0;
+
+	for (int i = 0; i < 60; ++i) {
+		double mid = 0.5 * (lo + hi);
+		if (ref_t_lin(c, mid) < temp_c)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	return (uint32_t) llround(0.5 * (lo + hi));
+}
+
+static uint32_t raw_press_for(const bmp3xx_calib_t *c, double pressure_pa, double t) {
+	double lo = 0.0, hi = 16777215.0;
+	bool rising = ref_pressure(c, hi, t) > ref_pressure(c, lo, t);
+
+	for (int i = 0; i < 60; ++i) {
+		double mid = 0.5 * (lo + hi);
+		if ((ref_pressure(c, mid, t) < pressure_pa) == rising)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	return (uint32_t) llround(0.5 * (lo + hi));
+}
+
+/**
+  * @brief fake device: stores a raw conversion in the data registers
+  */
+static void dev_store(uint32_t up, uint32_t ut) {
+	dev.regs[BMP3XX_REG_STATUS + 1] = (uint8_t) up;
+	dev.regs[BMP3XX_REG_STATUS + 2] = (uint8_t) (up >> 8);
+	dev.regs[BMP3XX_REG_STATUS + 3] = (uint8_t) (up >> 16);
+	dev.regs[BMP3XX_REG_STATUS + 4] = (uint8_t) ut;
+	dev.regs[BMP3XX_REG_STATUS + 5] = (uint8_t) (ut >> 8);
+	dev.regs[BMP3XX_REG_STATUS + 6] = (uint8_t) (ut >> 16);
+}
+
+static int32_t dev_read(uint8_t reg, uint8_t *bufp, uint16_t len) {
+	dev.loop_transactions++;
+
+	if (dev.fail_next) {
+		dev.fail_next--;
+		return -1;
+	}
+
+	if (reg == BMP3XX_REG_STATUS) {
+		if (dev.converting && ((now - dev.trigger_at) < (double) bmp3xx_conversion_time_us()))
+			dev.early_reads++;
+
+		if (dev.converting && !dev.stuck && (now >= dev.done_at)) {
+			dev_store(dev.pending_press, dev.pending_temp);
+			dev.regs[BMP3XX_REG_STATUS] |= BMP3XX_STATUS_DRDY_PRESS | BMP3XX_STATUS_DRDY_TEMP;
+			dev.converting = false;
+		}
+	}
+
+	memcpy(bufp, &dev.regs[reg], len);
+
+	/* Data ready flags clear on read */
+	if (reg == BMP3XX_REG_STATUS)
+		dev.regs[BMP3XX_REG_STATUS] &= (uint8_t) ~(BMP3XX_STATUS_DRDY_PRESS | BMP3XX_STATUS_DRDY_TEMP);
+
+	return 0;
+}
+
+static int32_t dev_write(uint8_t reg, const uint8_t *bufp, uint16_t len) {
+	dev.loop_transactions++;
+
+	if (dev.fail_next) {
+		dev.fail_next--;
+		return -1;
+	}
+
+	for (uint16_t i = 0; i < len; ++i)
+		dev.regs[reg + i] = bufp[i];
+
+	if ((reg == BMP3XX_REG_PWR_CTRL) && (bufp[0] == BMP3XX_PWR_CTRL_FORCED)) {
+		uint32_t ut = raw_temp_for(&dev_calib, dev.temperature_c);
+
+		dev.pending_temp = ut;
+		dev.pending_press = raw_press_for(&dev_calib, dev.pressure_pa, ref_t_lin(&dev_calib, (double) ut));
+		dev.converting = true;
+		dev.trigger_at = now;
+		dev.done_at = now + CONV_FRACTION * (double) bmp3xx_conversion_time_us();
+		dev.triggers++;
+	}
+
+	return 0;
+}
+
+static const bmp3xx_bus_t dev_bus = {.read = dev_read, .write = dev_write};
+
+/**
+  * @brief fake device: power-on state (chip id, calibration NVM)
+  */
+static void dev_reset(uint8_t chip_id) {
+	const bmp3xx_calib_t *c = &dev_calib;
+	uint8_t *nvm = &dev.regs[BMP3XX_REG_CALIB];
+
+	memset(&dev, 0, sizeof(dev));
+	dev.regs[BMP3XX_REG_CHIP_ID] = chip_id;
+	dev.pressure_pa = 101325.0;
+	dev.temperature_c = 25.0;
+
+	nvm[0] = (uint8_t) c->t1;  nvm[1] = (uint8_t) (c->t1 >> 8);
+	nvm[2] = (uint8_t) c->t2;  nvm[3] = (uint8_t) (c->t2 >> 8);
+	nvm[4] = (uint8_t) c->t3;
+	nvm[5] = (uint8_t) c->p1;  nvm[6] = (uint8_t) ((uint16_t) c->p1 >> 8);
+	nvm[7] = (uint8_t) c->p2;  nvm[8] = (uint8_t) ((uint16_t) c->p2 >> 8);
+	nvm[9] = (uint8_t) c->p3;
+	nvm[10] = (uint8_t) c->p4;
+	nvm[11] = (uint8_t) c->p5; nvm[12] = (uint8_t) (c->p5 >> 8);
+	nvm[13] = (uint8_t) c->p6; nvm[14] = (uint8_t) (c->p6 >> 8);
+	nvm[15] = (uint8_t) c->p7;
+	nvm[16] = (uint8_t) c->p8;
+	nvm[17] = (uint8_t) c->p9; nvm[18] = (uint8_t) ((uint16_t) c->p9 >> 8);
+	nvm[19] = (uint8_t) c->p10;
+	nvm[20] = (uint8_t) c->p11;
+}
+
+/**
+  * @brief runs the driver for a number of flight loops
+  *
+  * @retval fresh samples
+  */
+static uint32_t run_loops(uint32_t loops, baro_data_t *baro, uint32_t *warnings) {
+	uint32_t fresh = 0U;
+
+	for (uint32_t i = 0; i < loops; ++i) {
+		dev.loop_transactions = 0U;
+
+		if (bmp3xx_driver.read(baro) != BARO_OK)
+			(*warnings)++;
+
+		if (dev.loop_transactions > dev.max_loop_transactions)
+			dev.max_loop_transactions = dev.loop_transactions;
+
+		fresh += baro->fresh ? 1U : 0U;
+		now += 1.0e6 / LOOP_HZ;
+	}
+
+	return fresh;
+}
+
+/**
+  * @brief fixed-point compensation against the floating-point reference
+  */
+static void run_compensation(double *p_err_max, double *t_err_max, double *comp_ns) {
+	uint64_t start, cycles = 0U;
+	uint32_t n = 0U;
+	baro_data_t out;
+
+	*p_err_max = 0.0;
+	*t_err_max = 0.0;
+
+	for (double tc = -40.0; tc <= 85.0; tc += 5.0) {
+		uint32_t ut = raw_temp_for(&dev_calib, tc);
+		double t = ref_t_lin(&dev_calib, (double) ut);
+
+		for (double pa = 30000.0; pa <= 110000.0; pa += 2500.0) {
+			uint32_t up = raw_press_for(&dev_calib, pa, t);
+
+			start = cycles_now();
+			bmp3xx_compensate(&dev_calib, up, ut, &out);
+			cycles += cycles_now() - start;
+			n++;
+
+			*p_err_max = fmax(*p_err_max, fabs((double) out.pressure_cpa * 0.01 - ref_pressure(&dev_calib, (double) up, t)));
+			*t_err_max = fmax(*t_err_max, fabs((double) out.temperature_cdeg * 0.01 - t));
+		}
+	}
+
+	*comp_ns = (double) cycles / (double) n;
+}
+
+/**
+  * @brief driver checks
+  */
+static void run_checks(void) {
+	baro_data_t baro = {0};
+	bmp3xx_calib_t cal;
+	uint32_t warnings = 0U;
+	uint32_t fresh;
+	double p_err, t_err, comp_ns;
+
+	bmp3xx_set_bus(&dev_bus);
+
+	/* Compensation */
+	run_compensation(&p_err, &t_err, &comp_ns);
+	CHECK(p_err < 0.05);
+	CHECK(t_err < 0.011);		// output resolution
+
+	/* Device identification and setup */
+	dev_reset(0x00U);
+	CHECK(bmp3xx_driver.init() == BARO_ERROR_FATAL);
+
+	dev_reset(BMP390_CHIP_ID);
+	CHECK(bmp3xx_driver.init() == BARO_OK);
+
+	dev_reset(BMP388_CHIP_ID);
+	CHECK(bmp3xx_driver.init() == BARO_OK);
+	CHECK(dev.regs[BMP3XX_REG_CMD] == BMP3XX_CMD_SOFT_RESET);
+	CHECK(dev.regs[BMP3XX_REG_CONFIG] == 0x00U);
+	CHECK((dev.regs[BMP3XX_REG_OSR] & 0x07U) == (uint8_t) log2((double) CONFIG_BARO_PRESS_OSR));
+	CHECK((dev.regs[BMP3XX_REG_OSR] >> 3) == 0U);
+
+	bmp3xx_parse_calib(&dev.regs[BMP3XX_REG_CALIB], &cal);
+	CHECK(!memcmp(&cal, &dev_calib, sizeof(cal)));
+
+	/* Conversion schedule: 10 s at the loop rate */
+	fresh = run_loops((uint32_t) (10.0 * LOOP_HZ), &baro, &warnings);
+	CHECK(warnings == 0U);
+	CHECK(abs((int) fresh - (int) (10U * CONFIG_BARO_RATE_HZ)) <= 1);
+	CHECK(dev.triggers == fresh || dev.triggers == fresh + 1U);
+	CHECK(dev.max_loop_transactions == 1U);
+	CHECK(dev.early_reads == 0U);
+	CHECK(fabs((double) baro.pressure_cpa * 0.01 - 101325.0) < 0.5);
+	CHECK(abs(baro.temperature_cdeg - 2500) <= 1);
+
+	/* Pressure step shows up within one period plus a conversion */
+	dev.pressure_pa = 90000.0;
+	fresh = 0U;
+	for (uint32_t i = 0; (i < 100U) && !fresh; ++i) {
+		if (run_loops(1U, &baro, &warnings) && (fabs((double) baro.pressure_cpa * 0.01 - 90000.0) < 0.5))
+			fresh = i + 1U;
+	}
+	CHECK(fresh != 0U);
+	CHECK(((double) fresh / LOOP_HZ) <= 1.0 / CONFIG_BARO_RATE_HZ + 1.0e-6 * bmp3xx_conversion_time_us() + 2.0 / LOOP_HZ);
+
+	/* Stuck sensor: warned within two periods, then recovered */
+	dev.stuck = true;
+	warnings = 0U;
+	fresh = run_loops((uint32_t) (2.5 * LOOP_HZ / CONFIG_BARO_RATE_HZ), &baro, &warnings);
+	CHECK(warnings >= 1U);
+	CHECK(fresh <= 1U);
+	CHECK(dev.max_loop_transactions == 1U);
+
+	dev.stuck = false;
+	warnings = 0U;
+	fresh = run_loops((uint32_t) LOOP_HZ, &baro, &warnings);
+	CHECK(warnings == 0U);
+	CHECK(fresh >= CONFIG_BARO_RATE_HZ - 2U);
+
+	/* Bus errors: warned, next conversion still delivered */
+	dev.fail_next = 3U;
+	warnings = 0U;
+	fresh = run_loops((uint32_t) LOOP_HZ, &baro, &warnings);
+	CHECK(warnings >= 1U);
+	CHECK(fresh >= CONFIG_BARO_RATE_HZ - 4U);
+	CHECK(dev.early_reads == 0U);
+
+	/* Deinit resets the device */
+	dev.regs[BMP3XX_REG_CMD] = 0x00U;
+	CHECK(bmp3xx_driver.deinit() == BARO_OK);
+	CHECK(dev.regs[BMP3XX_REG_CMD] == BMP3XX_CMD_SOFT_RESET);
+
+	printf("{\"mode\": \"checks\", \"checks\": %u, \"failed\": %u, \"comp_err_max_pa\": %.3f, "
+		   "\"comp_temp_err_max_c\": %.4f, \"compensate_ns\": %.1f, \"conversion_us\": %u, \"rate_hz\": %u}\n",
+		   checks, failures, p_err, t_err, comp_ns, bmp3xx_conversion_time_us(), CONFIG_BARO_RATE_HZ);
+}
+
+/**
+  * @brief flight profile truth: altitude, climb rate, vertical acceleration
+  * 	   and bank angles at time t (smooth climb to 15 m, bob, descend)
+  */
+static void profile(double t, double *h, double *v, double *a, double *roll, double *pitch) {
+	const double two_pi = 6.283185307179586;
+	double u;
+
+	*h = *v = *a = *roll = *pitch = 0.0;
+
+	if ((t < 5.0) || (t >= 35.0))
+		return;
+
+	*roll = 20.0 * sin(two_pi * 0.4 * (t - 5.0));
+	*pitch = 10.0 * sin(two_pi * 0.25 * (t - 5.0));
+
+	if (t < 15.0) {
+		u = (t - 5.0) / 10.0;
+		*h = 15.0 * (u - sin(two_pi * u) / two_pi);
+		*v = 1.5 * (1.0 - cos(two_pi * u));
+		*a = 0.15 * two_pi * sin(two_pi * u);
+
+	} else if (t < 25.0) {
+		u = two_pi * 0.3 * (t - 15.0);
+		*h = 15.0 + 0.5 * (1.0 - cos(u));
+		*v = 0.5 * two_pi * 0.3 * sin(u);
+		*a = 0.5 * two_pi * 0.3 * two_pi * 0.3 * cos(u);
+
+	} else {
+		u = (t - 25.0) / 10.0;
+		*h = 15.0 - 15.0 * (u - sin(two_pi * u) / two_pi);
+		*v = -1.5 * (1.0 - cos(two_pi * u));
+		*a = -0.15 * two_pi * sin(two_pi * u);
+	}
+}
+
+/**
+  * @brief pressure at a height above the ground (standard atmosphere, ground
+  * 	   at 120 m)
+  */
+static double pressure_at(double h) {
+	return 101325.0 * pow(1.0 - (120.0 + h) / 44330.77, 1.0 / 0.190263);
+}
+
+typedef struct {
+	double sq_alt;
+	double sq_climb;
+	double sq_baro_alt;
+	double sq_baro_climb;
+	double max_alt;
+	uint32_t n;
+	uint32_t baro_n;
+	double est_ns;
+	bool valid_at_zero;			// estimate reported valid before the ground reference
+	double valid_s;
+} flight_metrics_t;
+
+/**
+  * @brief flies the profile through the fake device, the driver and the
+  * 	   estimator (earth frame rotation, or body z only)
+  */
+static void fly(bool rotate, flight_metrics_t *m) {
+	altitude_est_t est = {0};
+	baro_data_t baro = {0};
+	uint32_t warnings = 0U;
+	double prev_baro_alt = 0.0, prev_baro_t = 0.0;
+	bool have_prev = false;
+	uint64_t cycles = 0U;
+	uint32_t loops = (uint32_t) (FLIGHT_SECONDS * LOOP_HZ);
+
+	memset(m, 0, sizeof(*m));
+	rng_state = 1U;
+	now = 0.0;
+
+	dev_reset(BMP390_CHIP_ID);
+	bmp3xx_set_bus(&dev_bus);
+	(void) bmp3xx_driver.init();
+
+	for (uint32_t k = 0; k < loops; ++k) {
+		double t = now * 1.0e-6;
+		double h, v, a, roll, pitch;
+		imu_6D_t imu = {0};
+		attitude_est_t att = {0};
+
+		profile(t, &h, &v, &a, &roll, &pitch);
+
+		/* Thrust along body z carries the vertical and the banked horizontal acceleration */
+		double f = (a + GRAVITY) / (cos(roll * M_PI / 180.0) * cos(pitch * M_PI / 180.0));
+		imu.accel_x = (float) (ACCEL_NOISE_MG * rand_normal());
+		imu.accel_y = (float) (ACCEL_NOISE_MG * rand_normal());
+		imu.accel_z = (float) (f / GRAVITY * 1000.0 + ACCEL_BIAS_MG + ACCEL_NOISE_MG * rand_normal());
+		imu.dt = (uint32_t) lround(1.0e6 / LOOP_HZ);
+
+		if (rotate) {
+			att.roll_angle_deg = (float) (roll + ATT_NOISE_DEG * rand_normal());
+			att.pitch_angle_deg = (float) (pitch + ATT_NOISE_DEG * rand_normal());
+		}
+
+		dev.pressure_pa = pressure_at(h) + BARO_NOISE_PA * rand_normal();
+		dev.temperature_c = 24.0;
+
+		if (bmp3xx_driver.read(&baro) != BARO_OK)
+			warnings++;
+
+		uint64_t start = cycles_now();
+		(void) altitude_estimator_update(&imu, &att, &baro, &est);
+		cycles += cycles_now() - start;
+
+		if (est.valid && (m->valid_s == 0.0))
+			m->valid_s = t;
+
+		/* Ground reference is taken at rest, so errors count from then on */
+		if (est.valid && (t >= 1.0)) {
+			double ea = est.altitude_m - h;
+			double ev = est.climb_rate_mps - v;
+
+			m->sq_alt += ea * ea;
+			m->sq_climb += ev * ev;
+			m->max_alt = fmax(m->max_alt, fabs(ea));
+			m->n++;
+
+			if (baro.fresh) {
+				double baro_alt = altitude_from_pressure((float) baro.pressure_cpa * 0.01f) - est.ref_alt_m;
+				double eb = baro_alt - h;
+
+				m->sq_baro_alt += eb * eb;
+				if (have_prev) {
+					double eb_v = (baro_alt - prev_baro_alt) / (t - prev_baro_t) - v;
+					m->sq_baro_climb += eb_v * eb_v;
+				}
+
+				prev_baro_alt = baro_alt;
+				prev_baro_t = t;
+				have_prev = true;
+				m->baro_n++;
+			}
+		}
+
+		now += 1.0e6 / LOOP_HZ;
+	}
+
+	m->est_ns = (double) cycles / (double) loops;
+	CHECK(warnings == 0U);
+}
+
+/**
+  * @brief flight profile run
+  */
+static void run_flight(void) {
+	flight_metrics_t rot, body;
+
+	fly(true, &rot);
+	fly(false, &body);
+
+	double alt_rms = sqrt(rot.sq_alt / rot.n);
+	double climb_rms = sqrt(rot.sq_climb / rot.n);
+	double baro_alt_rms = sqrt(rot.sq_baro_alt / rot.baro_n);
+	double baro_climb_rms = sqrt(rot.sq_baro_climb / (rot.baro_n - 1U));
+	double body_alt_rms = sqrt(body.sq_alt / body.n);
+	double body_climb_rms = sqrt(body.sq_climb / body.n);
+
+	/* Estimate beats the barometer alone, and earth frame beats body z */
+	CHECK(rot.valid_s > 0.0);
+	CHECK(rot.valid_s <= (CONFIG_ALT_BARO_ZERO_SAMPLES + 1.0) / CONFIG_BARO_RATE_HZ);
+	CHECK(alt_rms < baro_alt_rms);
+	CHECK(climb_rms < 0.1);
+	CHECK(climb_rms < baro_climb_rms / 10.0);
+	CHECK(alt_rms < body_alt_rms);
+	CHECK(climb_rms < body_climb_rms);
+
+	printf("{\"mode\": \"flight\", \"seconds\": %.1f, \"loop_hz\": %.0f, \"baro_hz\": %u, \"tau_s\": %.1f, "
+		   "\"alt_rms_m\": %.3f, \"alt_err_max_m\": %.3f, \"climb_rms_mps\": %.3f, "
+		   "\"baro_alt_rms_m\": %.3f, \"baro_climb_rms_mps\": %.3f, "
+		   "\"body_z_alt_rms_m\": %.3f, \"body_z_climb_rms_mps\": %.3f, \"valid_after_s\": %.2f, \"estimator_ns\": %.1f}\n",
+		   FLIGHT_SECONDS, LOOP_HZ, CONFIG_BARO_RATE_HZ, (double) CONFIG_ALT_FILT_TAU_S,
+		   alt_rms, rot.max_alt, climb_rms, baro_alt_rms, baro_climb_rms,
+		   body_alt_rms, body_climb_rms, rot.valid_s, rot.est_ns);
+}
+
+/**
+  * @brief recorded pressure replay (vehicle at rest)
+  *
+  * @retval false if the file cannot be read
+  */
+static bool run_recording(const char *path) {
+	FILE *fp = fopen(path, "r");
+	char line[256];
+	double *ts = NULL, *ps = NULL, *tcs = NULL;
+	size_t n = 0U, cap = 0U;
+
+	if (!fp) {
+		fprintf(stderr, "cannot open %s\n", path);
+		return false;
+	}
+
+	while (fgets(line, sizeof(line), fp)) {
+		double t, p, tc = 25.0;
+		int fields = sscanf(line, "%lf,%lf,%lf", &t, &p, &tc);
+
+		if (fields < 2)
+			continue;
+
+		if (n == cap) {
+			cap = cap ? 2U * cap : 1024U;
+			ts = realloc(ts, cap * sizeof(double));
+			ps = realloc(ps, cap * sizeof(double));
+			tcs = realloc(tcs, cap * sizeof(double));
+		}
+
+		ts[n] = t;
+		ps[n] = p;
+		tcs[n] = tc;
+		n++;
+	}
+	fclose(fp);
+
+	if (n < 2U) {
+		fprintf(stderr, "%s: no samples\n", path);
+		return false;
+	}
+
+	altitude_est_t est = {0};
+	baro_data_t baro = {0};
+	imu_6D_t imu = {.accel_z = 1000.0f, .dt = (uint32_t) lround(1.0e6 / LOOP_HZ)};
+	attitude_est_t att = {0};
+	double sum_b = 0.0, sq_b = 0.0, sum_a = 0.0, sq_a = 0.0, sum_v = 0.0, sq_v = 0.0;
+	double first_a = 0.0, last_a = 0.0;
+	uint32_t nb = 0U, na = 0U;
+	size_t i = 0U;
+
+	dev_reset(BMP390_CHIP_ID);
+	bmp3xx_set_bus(&dev_bus);
+	now = ts[0] * 1.0e6;
+	(void) bmp3xx_driver.init();
+
+	for (; now <= ts[n - 1U] * 1.0e6; now += 1.0e6 / LOOP_HZ) {
+		double t = now * 1.0e-6;
+
+		/* Sample and hold the recording */
+		while ((i + 1U < n) && (ts[i + 1U] <= t))
+			i++;
+		dev.pressure_pa = ps[i];
+		dev.temperature_c = tcs[i];
+
+		(void) bmp3xx_driver.read(&baro);
+		(void) altitude_estimator_update(&imu, &att, &baro, &est);
+
+		if (!est.valid)
+			continue;
+
+		if (baro.fresh) {
+			double b = est.baro_alt_m;
+			sum_b += b;
+			sq_b += b * b;
+			nb++;
+		}
+
+		if (!na)
+			first_a = est.altitude_m;
+		last_a = est.altitude_m;
+		sum_a += est.altitude_m;
+		sq_a += (double) est.altitude_m * est.altitude_m;
+		sum_v += est.climb_rate_mps;
+		sq_v += (double) est.climb_rate_mps * est.climb_rate_mps;
+		na++;
+	}
+
+	free(ts);
+	free(ps);
+	free(tcs);
+
+	if (!nb || !na) {
+		fprintf(stderr, "%s: too short for a ground reference\n", path);
+		return false;
+	}
+
+	printf("{\"mode\": \"recording\", \"file\": \"%s\", \"samples\": %zu, \"baro_samples\": %u, "
+		   "\"baro_alt_std_m\": %.3f, \"alt_std_m\": %.3f, \"climb_std_mps\": %.3f, \"alt_drift_m\": %.3f}\n",
+		   path, n, nb,
+		   sqrt(fmax(sq_b / nb - (sum_b / nb) * (sum_b / nb), 0.0)),
+		   sqrt(fmax(sq_a / na - (sum_a / na) * (sum_a / na), 0.0)),
+		   sqrt(fmax(sq_v / na - (sum_v / na) * (sum_v / na), 0.0)),
+		   last_a - first_a);
+
+	return true;
+}
+
+static void usage(const char *argv0) {
+	fprintf(stderr, "usage: %s [-r recording.csv]\n"
+					"  recording: time_s,pressure_pa[,temperature_c] per line, vehicle at rest\n", argv0);
+}
+
+int main(int argc, char **argv) {
+	const char *recording = NULL;
+
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "-r") && (i + 1 < argc))
+			recording = argv[++i];
+		else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+
+	cycles_init();
+
+	run_checks();
+	run_flight();
+
+	if (recording && !run_recording(recording))
+		return 2;
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,366 @@
+/*
+ * battery_main.c (battery monitor host test)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sitl.h"
+#include "sensors/battery/battery_monitor.h"
+#include "params/params.h"
+#include "common/settings.h"
+
+/*
+ * First sensors/battery/battery_monitor.c is checked on synthetic samples:
+ * the cell count of 1S to 6S packs at charged, storage and low voltages (and
+ * LiHV), no pack, a fixed count, the detection delay, a pack swap, consumed
+ * charge and energy under jittered sample periods against the exact
+ * integrals, a long gap, and the resistance and resting voltage of a pack
+ * with known resistance under stepped current. Then sensors/battery/battery.c
+ * is run in the simulator on its sim device: update period, detection on the
+ * 4S pack, and the BATT_CELLS parameter applied on change:
+ *
+ *   {"mode": "checks", "checks": 31, "failed": 0, "resistance_mohm": 25.0, ...}
+ *
+ * then a 120 s flight is flown in altitude hold on the simulator's 4S pack
+ * (climbs and descents, ~8 to ~19 A). The resting voltage and the raw voltage
+ * are compared against the pack's open circuit voltage, and the consumed
+ * charge and the resistance estimate against the simulator's:
+ *
+ *   {"mode": "flight", "rest_rms_v": 0.043, "raw_rms_v": 0.369, "mah_err_pct": 0.021, ...}
+ *
+ * The exit status is 1 if any check fails.
+ */
+
+/**
+  * @brief  Simulation Setup
+  */
+#define PERIOD_S				(CONFIG_BATT_PERIOD_MS * 1e-3)
+#define FLIGHT_SECONDS			120.0
+#define SETTLE_SECONDS			10.0
+#define ARM_SECONDS				0.5
+#define ALT_HOLD_SECONDS		1.0
+
+#define PACK_RES_OHM			0.025
+#define PACK_NOISE_V			0.02
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+static unsigned checks;
+static unsigned failures;
+static uint32_t rng_state = 1U;
+
+
+static void check(bool cond, const char *what, int line) {
+	checks++;
+
+	if (!cond) {
+		failures++;
+		fprintf(stderr, "battery_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+/**
+  * @brief xorshift32 uniform sample in (0, 1]
+  */
+static double rand_uniform(void) {
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return ((double) (rng_state >> 8) + 1.0) / 16777216.0;
+}
+
+/**
+  * @brief xorshift32 standard normal sample (Box-Muller)
+  */
+static double rand_normal(void) {
+	double u0 = rand_uniform();
+	double u1 = rand_uniform();
+
+	return sqrt(-2.0 * log(u0)) * cos(6.283185307179586 * u1);
+}
+
+/**
+  * @brief monitor config from the settings
+  */
+static void default_config(battery_monitor_config_t *cfg, uint8_t cells) {
+	cfg->cells = cells;
+	cfg->cell_max_v = CONFIG_BATT_CELL_MAX_V;
+	cfg->present_min_v = CONFIG_BATT_PRESENT_MIN_V;
+	cfg->detect_ms = CONFIG_BATT_DETECT_MS;
+	cfg->sag_tau_s = CONFIG_BATT_SAG_TAU_S;
+	cfg->res_tau_s = CONFIG_BATT_RES_TAU_S;
+}
+
+/**
+  * @brief feeds a constant sample for a span at the update period
+  */
+static void feed(battery_monitor_t *m, double voltage_v, double current_a, double seconds) {
+	for (double t = 0.0; t < seconds; t += PERIOD_S)
+		battery_monitor_update(m, (float) voltage_v, (float) current_a, (float) PERIOD_S);
+}
+
+/**
+  * @brief cell count detected for a pack at rest
+  */
+static uint8_t detect(uint8_t cells, double cell_v) {
+	battery_monitor_config_t cfg;
+	battery_monitor_t m;
+
+	default_config(&cfg, 0U);
+	battery_monitor_init(&m, &cfg);
+	feed(&m, cells * cell_v, 0.5, 1.0);
+
+	return m.state.cells;
+}
+
+/**
+  * @brief monitor checks on synthetic samples
+  *
+  * @param  resistance_mohm		estimate on the stepped current run (filled)
+  * @param	rest_err_v			largest resting voltage error after settling (filled)
+  *
+  * @retval None
+  */
+static void run_monitor_checks(double *resistance_mohm, double *rest_err_v) {
+	static const double cell_v[] = {4.20, 3.85, 3.70};
+	battery_monitor_config_t cfg;
+	battery_monitor_t m;
+	double t, dt, i_prev, i, mah, wh, ocv;
+	bool ok;
+
+	/* Cell count: charged, storage and nearly flat packs; LiHV charged */
+	for (uint32_t k = 0; k < (sizeof(cell_v) / sizeof(cell_v[0])); ++k) {
+		ok = true;
+		for (uint8_t cells = 1U; cells <= 6U; ++cells)
+			ok &= (detect(cells, cell_v[k]) == cells);
+		CHECK(ok);
+	}
+	CHECK((detect(4U, 4.35) == 4U) && (detect(6U, 4.35) == 6U));
+
+	/* Below ~3.63 V per cell 6S reads as 5S (the documented limit) */
+	CHECK(detect(6U, 3.55) == 5U);
+
+	/* No pack (usb power): not present, nothing detected */
+	default_config(&cfg, 0U);
+	battery_monitor_init(&m, &cfg);
+	feed(&m, 0.3, 0.0, 2.0);
+	CHECK(!m.state.present && !m.state.cells && (m.state.cell_voltage_v == 0.0f));
+
+	/* Fixed count holds for a discharged 6S pack */
+	default_config(&cfg, 6U);
+	battery_monitor_init(&m, &cfg);
+	feed(&m, 6.0 * 3.3, 0.5, 1.0);
+	CHECK((m.state.cells == 6U) && (fabsf(m.state.cell_voltage_v - 3.3f) < 0.01f));
+
+	/* Detection waits CONFIG_BATT_DETECT_MS after the pack appeared */
+	default_config(&cfg, 0U);
+	battery_monitor_init(&m, &cfg);
+	feed(&m, 0.3, 0.0, 0.5);
+	feed(&m, 16.4, 0.5, CONFIG_BATT_DETECT_MS * 1e-3 - 2.0 * PERIOD_S);
+	CHECK(m.state.present && !m.state.cells);
+	feed(&m, 16.4, 0.5, 3.0 * PERIOD_S);
+	CHECK(m.state.cells == 4U);
+
+	/* Pack swapped for a 6S on the bench: detected again */
+	feed(&m, 0.3, 0.0, 0.2);
+	CHECK(!m.state.cells);
+	feed(&m, 25.0, 0.5, 1.0);
+	CHECK((m.state.cells == 6U) && (fabsf(m.state.rest_voltage_v - 25.0f) < 0.05f));
+
+	/* Consumed charge and energy: current ramp under jittered periods against
+	 * the exact integrals (trapezoidal is exact on a ramp) */
+	default_config(&cfg, 4U);
+	battery_monitor_init(&m, &cfg);
+	battery_monitor_update(&m, 16.0f, 0.0f, 0.0f);
+	mah = wh = 0.0;
+	i_prev = 0.0;
+	for (t = 0.0; t < 300.0; t += dt) {
+		dt = PERIOD_S * (0.5 + rand_uniform());
+		i = 40.0 * fmin((t + dt) / 300.0, 1.0);
+		battery_monitor_update(&m, 16.0f, (float) i, (float) dt);
+		mah += 0.5 * (i + i_prev) * dt / 3.6;
+		wh += 16.0 * i * dt / 3600.0;
+		i_prev = i;
+	}
+	CHECK(fabs(m.state.consumed_mah - 1666.67) < 0.01 * 1666.67);
+	CHECK(fabs(m.state.consumed_mah - mah) < 1e-3 * mah);
+	CHECK(fabs(m.state.energy_wh - wh) < 1e-3 * wh);
+
+	/* A long gap is integrated as BATT_DT_MAX_S, not as a current spike */
+	mah = m.state.consumed_mah;
+	battery_monitor_update(&m, 16.0f, 40.0f, 5.0f);
+	CHECK(fabs(m.state.consumed_mah - mah - 40.0 * BATT_DT_MAX_S / 3.6) < 0.01);
+
+	/* Resistance and resting voltage: 4S pack discharging at a known
+	 * resistance, current stepping every 0.5..2 s */
+	default_config(&cfg, 0U);
+	battery_monitor_init(&m, &cfg);
+	CHECK(m.state.resistance_mohm == 0.0f);
+	i = 5.0;
+	*rest_err_v = 0.0;
+	for (t = 0.0, dt = 0.0; t < 120.0; t += PERIOD_S) {
+		if (t >= dt) {
+			i = 5.0 + 30.0 * rand_uniform();
+			dt = t + 0.5 + 1.5 * rand_uniform();
+		}
+		ocv = 16.6 - 0.01 * t;
+		battery_monitor_update(&m, (float) (ocv - i * PACK_RES_OHM + PACK_NOISE_V * rand_normal()), (float) i, (float) PERIOD_S);
+		if (t > 30.0)
+			*rest_err_v = fmax(*rest_err_v, fabs(m.state.rest_voltage_v - ocv));
+	}
+	*resistance_mohm = m.state.resistance_mohm;
+	CHECK(fabs(*resistance_mohm - PACK_RES_OHM * 1000.0) < 0.1 * PACK_RES_OHM * 1000.0);
+	CHECK(*rest_err_v < 0.1);
+	CHECK(m.state.cells == 4U);
+
+	/* Steady current: the estimate is kept, not pulled to zero */
+	feed(&m, 15.0, 20.0, 30.0);
+	CHECK(fabsf(m.state.resistance_mohm - (float) *resistance_mohm) < 2.0f);
+}
+
+/**
+  * @brief battery.c in the simulator (sim device)
+  *
+  * @retval None
+  */
+static void run_module_checks(void) {
+	sitl_config_t cfg;
+	sitl_state_t s;
+	battery_data_t prev;
+	uint32_t changes = 0U;
+
+	sitl_default_config(&cfg);
+	CHECK(sitl_init(&cfg) == SITL_OK);
+
+	/* Updated every CONFIG_BATT_PERIOD_MS, held in between */
+	sitl_step(1U);
+	sitl_get_state(&s);
+	prev = s.flight.batt;
+	for (uint32_t n = 0; n < cfg.loop_hz; ++n) {
+		sitl_step(1U);
+		sitl_get_state(&s);
+		if (memcmp(&prev, &s.flight.batt, sizeof(prev)))
+			++changes;
+		prev = s.flight.batt;
+	}
+	CHECK((changes >= 1000U / CONFIG_BATT_PERIOD_MS - 1U) && (changes <= 1000U / CONFIG_BATT_PERIOD_MS + 1U));
+	CHECK(s.status.battery == BATTERY_OK);
+
+	/* Charged 4S pack on the bench */
+	CHECK(s.flight.batt.present && (s.flight.batt.cells == 4U));
+	CHECK(fabsf(s.flight.batt.voltage_v - s.batt_ocv_v) < 0.1f);
+	CHECK(fabs(s.flight.batt.consumed_mah - s.batt_consumed_mah) < 0.05);
+
+	/* Cell count from the parameter, applied on change; 0 detects again */
+	CHECK(sitl_set_param("BATT_CELLS", 3.0f) == SITL_OK);
+	sitl_step(cfg.loop_hz / 10U);
+	sitl_get_state(&s);
+	CHECK(s.flight.batt.cells == 3U);
+	CHECK(sitl_set_param("BATT_CELLS", 0.0f) == SITL_OK);
+	sitl_step(cfg.loop_hz);
+	sitl_get_state(&s);
+	CHECK(s.flight.batt.cells == 4U);
+	CHECK(sitl_set_param("BATT_CELLS", 13.0f) != SITL_OK);
+}
+
+/**
+  * @brief maps a stick deflection (-1..1) to a pulse width
+  */
+static uint32_t stick_us(float x) {
+	float min = (float) params_get_u32(PARAM_RC_PULSE_MIN_US);
+	float max = (float) params_get_u32(PARAM_RC_PULSE_MAX_US);
+
+	x = fminf(fmaxf(x, -1.0f), 1.0f);
+	return (uint32_t) lroundf(0.5f * (min + max) + x * 0.5f * (max - min));
+}
+
+/**
+  * @brief flight in altitude hold on the simulator's pack
+  *
+  * @retval None
+  */
+static void run_flight(void) {
+	static const float climb_pattern[] = {0.6f, 0.0f, -0.4f, 0.0f, 0.8f, -0.6f, 0.0f, 0.3f, -0.3f};
+	sitl_config_t cfg;
+	sitl_state_t s;
+	sitl_rc_t rc;
+	double t, rest_sq = 0.0, raw_sq = 0.0, rest_max = 0.0, i_min = 1e9, i_max = 0.0;
+	uint32_t n = 0U, segment;
+	bool flew = false;
+
+	sitl_default_config(&cfg);
+	if (sitl_init(&cfg) != SITL_OK) {
+		CHECK(false);
+		return;
+	}
+	CHECK(sitl_set_param("RC_MODE_SW_HIGH", (float) ALT_HOLD_MODE) == SITL_OK);
+
+	rc = (sitl_rc_t){.roll_us = stick_us(0.0f), .pitch_us = stick_us(0.0f), .yaw_us = stick_us(0.0f),
+					 .throttle_us = stick_us(-1.0f), .arm = false, .mode = ANGLE_MODE};
+
+	for (uint32_t loop = 0; loop < (uint32_t) ((SETTLE_SECONDS + FLIGHT_SECONDS) * cfg.loop_hz); ++loop) {
+		t = (double) loop / cfg.loop_hz;
+
+		/* Climbs and descents held 3 s each (altitude hold keeps it off the ground) */
+		rc.arm = (t >= ARM_SECONDS);
+		if (t >= ALT_HOLD_SECONDS) {
+			segment = (uint32_t) ((t - ALT_HOLD_SECONDS) / 3.0);
+			rc.mode = ALT_HOLD_MODE;
+			rc.throttle_us = stick_us((segment == 0U) ? 0.8f :
+									  climb_pattern[segment % (sizeof(climb_pattern) / sizeof(climb_pattern[0]))]);
+		}
+		sitl_set_rc(&rc);
+		sitl_step(1U);
+
+		if (t < SETTLE_SECONDS)
+			continue;
+
+		sitl_get_state(&s);
+		flew |= (s.status.phase == FLIGHT_PHASE_FLYING);
+		rest_sq += pow(s.flight.batt.rest_voltage_v - s.batt_ocv_v, 2.0);
+		raw_sq += pow(s.flight.batt.voltage_v - s.batt_ocv_v, 2.0);
+		rest_max = fmax(rest_max, fabs(s.flight.batt.rest_voltage_v - s.batt_ocv_v));
+		i_min = fmin(i_min, s.batt_current_a);
+		i_max = fmax(i_max, s.batt_current_a);
+		++n;
+	}
+
+	CHECK(flew && n);
+	CHECK(s.flight.batt.cells == cfg.batt_cells);
+	CHECK(sqrt(rest_sq / n) < 0.25 * sqrt(raw_sq / n));
+	CHECK(fabs(s.flight.batt.consumed_mah - s.batt_consumed_mah) < 0.01 * s.batt_consumed_mah);
+	CHECK(fabsf(s.flight.batt.resistance_mohm - cfg.batt_resistance_ohm * 1000.0f) < 0.2f * cfg.batt_resistance_ohm * 1000.0f);
+
+	printf("{\"mode\": \"flight\", \"seconds\": %.0f, \"rest_rms_v\": %.3f, \"rest_max_v\": %.3f, \"raw_rms_v\": %.3f, "
+		   "\"current_min_a\": %.1f, \"current_max_a\": %.1f, \"consumed_mah\": %.1f, \"mah_err_pct\": %.3f, "
+		   "\"resistance_mohm\": %.1f, \"cells\": %u}\n",
+		   FLIGHT_SECONDS, sqrt(rest_sq / n), rest_max, sqrt(raw_sq / n), i_min, i_max,
+		   (double) s.flight.batt.consumed_mah,
+		   100.0 * fabs(s.flight.batt.consumed_mah - s.batt_consumed_mah) / s.batt_consumed_mah,
+		   (double) s.flight.batt.resistance_mohm, s.flight.batt.cells);
+}
+
+int main(int argc, char **argv) {
+	double resistance_mohm, rest_err_v;
+
+	(void) argv;
+
+	if (argc > 1) {
+		fprintf(stderr, "usage: %s\n", argv[0]);
+		return 2;
+	}
+
+	run_monitor_checks(&resistance_mohm, &rest_err_v);
+	run_module_checks();
+	printf("{\"mode\": \"checks\", \"checks\": %u, \"failed\": %u, \"resistance_mohm\": %.1f, \"rest_max_err_v\": %.3f}\n",
+		   checks, failures, resistance_mohm, rest_err_v);
+
+	run_flight();
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,29 @@
+/*
+ * bench_hal.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include "../shim/dev/stm32f4xx_hal.h"
+
+/*
+ * HAL bus functions the lsm6dsox driver links against (the bus handles come
+ * from sim_imu.c). They fail: register access goes through lsm6dsox_set_bus.
+ */
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+									uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+	(void) hi2c; (void) DevAddress; (void) MemAddress; (void) MemAddSize; (void) pData; (void) Size; (void) Timeout;
+	return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+								   uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+	(void) hi2c; (void) DevAddress; (void) MemAddress; (void) MemAddSize; (void) pData; (void) Size; (void) Timeout;
+	return HAL_ERROR;
+}
+
+void HAL_Delay(uint32_t Delay) {
+	(void) Delay;
+}
@@ -0,0 +1,162 @@
+/*
+ * bench_main.c (kernel benchmark command line)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sitl.h"
+#include "system/bench.h"
+#include "common/cycles.h"
+#include "comms/frame.h"
+#include "comms/messages.h"
+
+/*
+ * Output is one JSON object per kernel and line, identical for host runs
+ * and target results, so Tools/bench_compare.py can diff two commits:
+ *
+ *   {"kernel": "pid_update", "platform": "host", "clock_hz": 1000000000,
+ *    "calls": 256, "batches": 64, "cycles_per_call_min": 9.1, ...}
+ *
+ * On the host a "cycle" is a nanosecond (see common/cycles.h). The exit
+ * status is 1 if any kernel's best batch exceeds its cycle budget (bench.c).
+ */
+
+
+/**
+  * @brief helper function to print one result as a JSON line
+  *
+  * @retval boolean (true if within budget)
+  */
+static bool print_result(FILE *fp, const char *platform, const char *name, uint32_t clock_hz,
+						 uint32_t calls, uint32_t batches, uint32_t min, uint32_t avg, uint32_t max, uint32_t budget) {
+	double per_call_avg = (double) avg / (double) calls;
+	double per_call_min = (double) min / (double) calls;
+	bool within = !budget || (per_call_min <= (double) budget);
+
+	fprintf(fp, "{\"kernel\": \"%s\", \"platform\": \"%s\", \"clock_hz\": %u, \"calls\": %u, \"batches\": %u, "
+				"\"cycles_per_call_min\": %.3f, \"cycles_per_call_avg\": %.3f, \"cycles_per_call_max\": %.3f, "
+				"\"ns_per_call\": %.3f, \"calls_per_s\": %.0f, \"budget_cycles_per_call\": %u, \"within_budget\": %s}\n",
+			name, platform, clock_hz, calls, batches,
+			per_call_min, per_call_avg, (double) max / (double) calls,
+			per_call_avg * 1.0e9 / (double) clock_hz, (per_call_avg > 0.0) ? (double) clock_hz / per_call_avg : 0.0,
+			budget, within ? "true" : "false");
+
+	if (!within)
+		fprintf(stderr, "%s: %.1f cycles per call over budget (%u)\n", name, per_call_min, budget);
+
+	return within;
+}
+
+/**
+  * @brief helper function to run the suite against the simulator's modules
+  *
+  * @retval exit code
+  */
+static int run_host(FILE *fp) {
+	sitl_config_t cfg;
+	bench_result_t res;
+	int code = 0;
+
+	sitl_default_config(&cfg);
+	if (sitl_init(&cfg) != SITL_OK) {
+		fprintf(stderr, "sitl init failed\n");
+		return 2;
+	}
+
+	bench_run();
+
+	for (uint32_t id = 0; id < BENCH_COUNT; ++id) {
+		if (bench_get((bench_id_t) id, &res) &&
+			!print_result(fp, "host", res.name, cycles_hz(), res.calls, res.batches, res.min, res.avg, res.max, res.budget))
+			code = 1;
+	}
+
+	return code;
+}
+
+/**
+  * @brief helper function to convert target results (MSG_BENCH frames in a
+  * 	   raw capture of the usb link) to JSON lines
+  *
+  * @retval exit code
+  */
+static int decode_capture(FILE *fp, const char *path) {
+	static frame_decoder_t dec;
+	FILE *in = fopen(path, "rb");
+	frame_t frame;
+	msg_bench_t msg;
+	char name[MSG_BENCH_NAME_LEN + 1U];
+	uint32_t found = 0U;
+	int c, code = 0;
+
+	if (!in) {
+		perror(path);
+		return 2;
+	}
+
+	frame_decoder_reset(&dec);
+	while ((c = fgetc(in)) != EOF) {
+		if ((frame_decoder_push(&dec, (uint8_t) c, &frame) != FRAME_OK) ||
+			(frame.msg_id != MSG_BENCH) || (frame.len != sizeof(msg)))
+			continue;
+
+		memcpy(&msg, frame.payload, sizeof(msg));
+		memcpy(name, msg.name, MSG_BENCH_NAME_LEN);
+		name[MSG_BENCH_NAME_LEN] = '\0';
+
+		if (!print_result(fp, "f405", name, msg.clock_hz, msg.calls, msg.batches,
+						  msg.min_cycles, msg.avg_cycles, msg.max_cycles, msg.budget_cycles))
+			code = 1;
+		++found;
+	}
+	fclose(in);
+
+	if (!found) {
+		fprintf(stderr, "%s: no MSG_BENCH frames\n", path);
+		return 1;
+	}
+
+	return code;
+}
+
+static void usage(const char *argv0) {
+	fprintf(stderr,
+			"usage: %s [-o out.jsonl] [-r capture.bin]\n"
+			"  times the flight kernels on this host and prints one JSON line per kernel\n"
+			"  exit status is 1 if a kernel exceeds its cycle budget\n"
+			"  -r       convert target results instead (link capture holding the MSG_BENCH replies)\n",
+			argv0);
+}
+
+int main(int argc, char **argv) {
+	const char *out_path = NULL, *capture = NULL;
+	FILE *fp = stdout;
+	int code;
+
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "-o") && (i + 1 < argc))
+			out_path = argv[++i];
+		else if (!strcmp(argv[i], "-r") && (i + 1 < argc))
+			capture = argv[++i];
+		else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+
+	if (out_path && !(fp = fopen(out_path, "w"))) {
+		perror(out_path);
+		return 2;
+	}
+
+	code = capture ? decode_capture(fp, capture) : run_host(fp);
+
+	if (fp != stdout)
+		fclose(fp);
+
+	return code;
+}
@@ -0,0 +1,390 @@
+/*
+ * blackbox_main.c (blackbox encoder benchmark)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sitl.h"
+#include "params/params.h"
+#include "storage/blackbox.h"
+#include "storage/log_file.h"
+#include "common/cycles.h"
+
+/*
+ * Flies the simulator (altitude hold with stick sweeps), encodes every armed
+ * loop with storage/blackbox.c as the firmware does, decodes the frames again
+ * and reports one JSON line:
+ *
+ *   {"mode": "blackbox", "frames": 24770, "raw_bytes": 2278840,
+ *    "encoded_bytes": 812345, "ratio": 2.81, "encode_cycles_avg": 310, ...}
+ *
+ * raw_bytes is the size of the same records written as structs. Every decoded
+ * value must match its input within half a quantization step (exactly for
+ * integer fields). -d drops every n-th frame the way a full sd ring does, to
+ * check that the stream resynchronizes on the next keyframe. -o writes a log
+ * file (header and frames, like LOGnnnnn.BIN) for Tools/blackbox_decode.py.
+ * The exit status is 1 if decoding does not match.
+ *
+ * On the host a "cycle" is a nanosecond (see common/cycles.h); target
+ * cycles come from the kernel suite (aqc_bench, MSG_BENCH_GET).
+ */
+
+#define ARM_TIME_S			0.5f	// sticks idle, arm switch flipped here
+#define HOVER_ALT_M			1.5f
+#define SWEEP_ROLL_HZ		0.5f
+#define SWEEP_PITCH_HZ		0.7f
+#define SWEEP_YAW_HZ		0.3f
+
+#define DECODE_FIELDS_MAX	64U
+#define DECODE_NAME_MAX		32U
+
+/**
+  * @brief  Decoder State (mirror of the encoder, reads the header's definitions)
+  */
+static struct {
+	uint32_t count;
+	uint16_t interval;
+	uint8_t predictor[DECODE_FIELDS_MAX];
+	uint8_t type[DECODE_FIELDS_MAX];
+	float scale[DECODE_FIELDS_MAX];
+	char name[DECODE_FIELDS_MAX][DECODE_NAME_MAX];
+	uint32_t prev[DECODE_FIELDS_MAX];
+	uint32_t prev2[DECODE_FIELDS_MAX];
+	uint32_t since_key;
+	bool synced;
+} dec;
+
+
+/**
+  * @brief helper function to map a normalized stick deflection to a pulse width
+  *
+  * @retval pulse width (us)
+  */
+static uint32_t stick_us(float x) {
+	float min = (float) params_get_u32(PARAM_RC_PULSE_MIN_US);
+	float max = (float) params_get_u32(PARAM_RC_PULSE_MAX_US);
+
+	x = fminf(fmaxf(x, -1.0f), 1.0f);
+	return (uint32_t) lroundf(0.5f * (min + max) + x * 0.5f * (max - min));
+}
+
+/**
+  * @brief helper function to run the pilot for one flight loop: arms, holds
+  * 	   HOVER_ALT_M with the throttle stick and sweeps roll, pitch and yaw
+  *
+  * @retval None
+  */
+static void pilot(const sitl_state_t *s, float dt) {
+	static float alt_integral;
+	float t = (float) s->time_s;
+	sitl_rc_t rc = {.roll_us = stick_us(0.0f), .pitch_us = stick_us(0.0f), .yaw_us = stick_us(0.0f),
+					.throttle_us = stick_us(-1.0f), .arm = (t >= ARM_TIME_S), .mode = ANGLE_MODE};
+
+	if (s->status.phase == FLIGHT_PHASE_FLYING) {
+		float err = HOVER_ALT_M - s->quad.pos_m[2];
+		alt_integral = fminf(fmaxf(alt_integral + err * dt, -2.0f), 2.0f);
+		rc.throttle_us = stick_us(-0.2f + 0.35f * err + 0.25f * alt_integral - 0.3f * s->quad.vel_mps[2]);
+		rc.roll_us = stick_us(0.3f * sinf(2.0f * (float) M_PI * SWEEP_ROLL_HZ * t));
+		rc.pitch_us = stick_us(0.3f * sinf(2.0f * (float) M_PI * SWEEP_PITCH_HZ * t));
+		rc.yaw_us = stick_us(0.2f * sinf(2.0f * (float) M_PI * SWEEP_YAW_HZ * t));
+	}
+
+	sitl_set_rc(&rc);
+}
+
+/**
+  * @brief helper function to read an unsigned LEB128 varint
+  *
+  * @retval boolean (false if truncated or longer than 32 bits)
+  */
+static bool get_varint(const uint8_t **p, const uint8_t *end, uint32_t *v) {
+	uint32_t shift = 0U;
+
+	*v = 0U;
+	while ((*p < end) && (shift < 35U)) {
+		uint8_t b = *(*p)++;
+
+		*v |= (uint32_t) (b & 0x7FU) << shift;
+		if (!(b & 0x80U))
+			return true;
+		shift += 7U;
+	}
+
+	return false;
+}
+
+/**
+  * @brief helper function to parse the field definitions
+  *
+  * @retval bytes consumed (0 if malformed)
+  */
+static uint32_t decode_header(const uint8_t *buf, uint32_t len) {
+	uint32_t n = 8U;
+
+	if ((len < n) || memcmp(buf, BLACKBOX_MAGIC, 4U) || (buf[4] != BLACKBOX_VERSION) || (buf[5] > DECODE_FIELDS_MAX))
+		return 0U;
+
+	memset(&dec, 0, sizeof(dec));
+	dec.count = buf[5];
+	memcpy(&dec.interval, &buf[6], sizeof(dec.interval));
+
+	for (uint32_t i = 0; i < dec.count; ++i) {
+		const char *name = (const char*) &buf[n + 2U + sizeof(float)];
+		size_t name_len;
+
+		if (n + 2U + sizeof(float) >= len)
+			return 0U;
+
+		name_len = strnlen(name, len - n - 2U - sizeof(float));
+		if ((n + 2U + sizeof(float) + name_len >= len) || (name_len >= DECODE_NAME_MAX))
+			return 0U;
+
+		dec.predictor[i] = buf[n];
+		dec.type[i] = buf[n + 1U];
+		memcpy(&dec.scale[i], &buf[n + 2U], sizeof(float));
+		memcpy(dec.name[i], name, name_len + 1U);
+		n += 2U + sizeof(float) + (uint32_t) name_len + 1U;
+	}
+
+	return n;
+}
+
+/**
+  * @brief helper function to decode one frame into counts
+  *
+  * @retval boolean (false if malformed, or a P frame without a keyframe before it)
+  */
+static bool decode_frame(const uint8_t **p, const uint8_t *end, uint32_t *counts) {
+	uint8_t marker;
+	uint32_t z, pred;
+
+	if (*p >= end)
+		return false;
+
+	marker = *(*p)++;
+	if (marker == BLACKBOX_FRAME_I)
+		dec.since_key = 0U;
+	else if ((marker != BLACKBOX_FRAME_P) || !dec.synced)
+		return false;
+
+	for (uint32_t i = 0; i < dec.count; ++i) {
+		if (!get_varint(p, end, &z))
+			return false;
+
+		if (!dec.since_key)
+			pred = 0U;
+		else if ((dec.predictor[i] == BLACKBOX_PREDICT_LINEAR) && (dec.since_key > 1U))
+			pred = 2U * dec.prev[i] - dec.prev2[i];
+		else
+			pred = dec.prev[i];
+
+		counts[i] = pred + ((z >> 1) ^ (0U - (z & 1U)));
+		dec.prev2[i] = dec.prev[i];
+		dec.prev[i] = counts[i];
+	}
+
+	dec.synced = true;
+	++dec.since_key;
+
+	return true;
+}
+
+/**
+  * @brief helper function to compare a decoded frame with its record (by
+  * 	   field name, so the check does not depend on the encoder's table)
+  *
+  * @param  rec		encoded record
+  * @param	counts	decoded counts
+  * @param	match	cleared if a value is off by more than half a step (plus
+  * 				single precision rounding of the encoder's scaling)
+  *
+  * @retval worst error (quantization steps)
+  */
+static double compare(const blackbox_record_t *rec, const uint32_t *counts, bool *match) {
+	const struct {
+		const char *name;
+		double value;
+	} ref[] = {
+		{"time_us", rec->time_us}, {"imu_dt_us", rec->imu.dt},
+		{"accel_x_mg", rec->imu.accel_x}, {"accel_y_mg", rec->imu.accel_y}, {"accel_z_mg", rec->imu.accel_z},
+		{"gyro_x_mdps", rec->imu.rate_x}, {"gyro_y_mdps", rec->imu.rate_y}, {"gyro_z_mdps", rec->imu.rate_z},
+		{"est_roll_deg", rec->est.roll_angle_deg}, {"est_pitch_deg", rec->est.pitch_angle_deg},
+		{"est_roll_rate_dps", rec->est.roll_rate_dps}, {"est_pitch_rate_dps", rec->est.pitch_rate_dps},
+		{"est_yaw_rate_dps", rec->est.yaw_rate_dps},
+		{"req_roll_deg", rec->req.roll_angle}, {"req_pitch_deg", rec->req.pitch_angle},
+		{"req_roll_rate_dps", rec->req.roll_rate}, {"req_pitch_rate_dps", rec->req.pitch_rate},
+		{"req_yaw_rate_dps", rec->req.yaw_rate}, {"req_throttle_pct", rec->req.throttle},
+		{"motor1", rec->mcmd.mtr1}, {"motor2", rec->mcmd.mtr2}, {"motor3", rec->mcmd.mtr3}, {"motor4", rec->mcmd.mtr4}
+	};
+	double worst = 0.0, err, value;
+	bool found;
+
+	for (uint32_t i = 0; i < dec.count; ++i) {
+		found = false;
+		for (uint32_t j = 0; j < sizeof(ref) / sizeof(ref[0]); ++j) {
+			if (strcmp(dec.name[i], ref[j].name))
+				continue;
+
+			value = (dec.type[i] == BLACKBOX_TYPE_UNSIGNED) ? (double) counts[i] * (double) dec.scale[i] :
+					(double) (int32_t) counts[i] * (double) dec.scale[i];
+			err = fabs(value - ref[j].value) / (double) dec.scale[i];
+			if (err > 0.5 + fabs(ref[j].value / (double) dec.scale[i]) * 2.0 * FLT_EPSILON)
+				*match = false;
+			if (err > worst)
+				worst = err;
+			found = true;
+		}
+
+		*match &= found;
+	}
+
+	return worst;
+}
+
+static void usage(const char *argv0) {
+	fprintf(stderr,
+			"usage: %s [-t seconds] [-s seed] [-d n] [-o log.bin]\n"
+			"  -t   flight time (default 60 s)\n"
+			"  -s   noise seed\n"
+			"  -d   drop every n-th frame (full sd ring), checks keyframe resync\n"
+			"  -o   write a log file (header and frames) for Tools/blackbox_decode.py\n",
+			argv0);
+}
+
+int main(int argc, char **argv) {
+	static uint8_t header[BLACKBOX_HEADER_MAX];
+	uint8_t frame[BLACKBOX_FRAME_MAX];
+	uint32_t counts[DECODE_FIELDS_MAX];
+	float seconds = 60.0f;
+	uint32_t drop = 0U, seed = 0U;
+	const char *out_path = NULL;
+	FILE *out = NULL;
+	sitl_config_t cfg;
+	sitl_state_t s;
+	blackbox_record_t rec;
+	const uint8_t *p;
+	uint64_t encoded = 0U, encode_cycles = 0U;
+	uint32_t frames = 0U, keyframes = 0U, dropped = 0U, decoded = 0U, len, header_len, start, elapsed;
+	uint32_t len_max = 0U, cycles_max = 0U, loops;
+	double worst = 0.0, err;
+	bool ok = true;
+
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "-t") && (i + 1 < argc))
+			seconds = strtof(argv[++i], NULL);
+		else if (!strcmp(argv[i], "-s") && (i + 1 < argc))
+			seed = (uint32_t) strtoul(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "-d") && (i + 1 < argc))
+			drop = (uint32_t) strtoul(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "-o") && (i + 1 < argc))
+			out_path = argv[++i];
+		else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+
+	sitl_default_config(&cfg);
+	if (seed)
+		cfg.seed = seed;
+	if ((seconds <= ARM_TIME_S) || (sitl_init(&cfg) == SITL_ERROR_FATAL)) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	cycles_init();
+
+	/* Definitions once, as at arm time */
+	blackbox_reset();
+	header_len = blackbox_write_header(header, sizeof(header));
+	if (!header_len || (decode_header(header, header_len) != header_len)) {
+		fprintf(stderr, "blackbox header does not parse\n");
+		return 1;
+	}
+
+	if (out_path) {
+		log_file_header_t lh = {.version = LOG_FILE_VERSION, .header_size = sizeof(log_file_header_t), .log_index = 1U};
+
+		memcpy(lh.magic, LOG_FILE_MAGIC, sizeof(lh.magic));
+		out = fopen(out_path, "wb");
+		if (!out || (fwrite(&lh, sizeof(lh), 1, out) != 1) || (fwrite(header, header_len, 1, out) != 1)) {
+			perror(out_path);
+			return 2;
+		}
+	}
+
+	loops = (uint32_t) (seconds * (float) cfg.loop_hz);
+	for (uint32_t n = 0; n < loops; ++n) {
+		sitl_get_state(&s);
+		pilot(&s, 1.0f / (float) cfg.loop_hz);
+		(void) sitl_step(1U);
+		sitl_get_state(&s);
+
+		if (s.status.phase != FLIGHT_PHASE_FLYING)
+			continue;
+
+		rec = (blackbox_record_t) {.time_us = (uint32_t) (s.time_s * 1.0e6), .imu = s.flight.imu,
+								   .est = s.flight.est, .req = s.flight.req, .mcmd = s.flight.mcmd};
+
+		start = cycles_now();
+		len = blackbox_encode(&rec, frame);
+		elapsed = cycles_now() - start;
+
+		++frames;
+		encode_cycles += elapsed;
+		if (elapsed > cycles_max)
+			cycles_max = elapsed;
+		if (len > len_max)
+			len_max = len;
+		if (frame[0] == BLACKBOX_FRAME_I)
+			++keyframes;
+
+		/* Full ring: the frame never reaches the card, the next one is a keyframe */
+		if (drop && !(frames % drop)) {
+			blackbox_reset();
+			++dropped;
+			continue;
+		}
+
+		encoded += len;
+		if (out && (fwrite(frame, len, 1, out) != 1))
+			ok = false;
+
+		p = frame;
+		if (!decode_frame(&p, frame + len, counts) || (p != frame + len)) {
+			ok = false;
+			continue;
+		}
+		++decoded;
+
+		err = compare(&rec, counts, &ok);
+		if (err > worst)
+			worst = err;
+	}
+
+	if (out)
+		fclose(out);
+
+	ok &= (len_max <= BLACKBOX_FRAME_MAX) && frames && (decoded == frames - dropped);
+
+	printf("{\"mode\": \"blackbox\", \"seconds\": %.1f, \"loop_hz\": %u, \"fields\": %u, \"keyframe_interval\": %u, "
+		   "\"frames\": %u, \"keyframes\": %u, \"dropped\": %u, \"header_bytes\": %u, \"raw_bytes\": %llu, "
+		   "\"encoded_bytes\": %llu, \"ratio\": %.2f, \"bytes_per_frame_avg\": %.1f, \"bytes_per_frame_max\": %u, "
+		   "\"raw_kbps\": %.1f, \"encoded_kbps\": %.1f, \"clock_hz\": %u, \"encode_cycles_avg\": %.0f, "
+		   "\"encode_cycles_max\": %u, \"max_error_steps\": %.3f, \"verified\": %s}\n",
+		   (double) seconds, cfg.loop_hz, BLACKBOX_FIELD_COUNT, dec.interval, frames, keyframes, dropped, header_len,
+		   (unsigned long long) (frames - dropped) * BLACKBOX_FIELD_COUNT * 4U, (unsigned long long) encoded,
+		   encoded ? (double) (frames - dropped) * BLACKBOX_FIELD_COUNT * 4.0 / (double) encoded : 0.0,
+		   (frames > dropped) ? (double) encoded / (double) (frames - dropped) : 0.0, len_max,
+		   BLACKBOX_FIELD_COUNT * 4.0 * cfg.loop_hz / 1024.0,
+		   (frames > dropped) ? (double) encoded / (double) (frames - dropped) * cfg.loop_hz / 1024.0 : 0.0,
+		   cycles_hz(), frames ? (double) encode_cycles / frames : 0.0, cycles_max, worst, ok ? "true" : "false");
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,623 @@
+/*
+ * crash_main.c (imu crash detection host test)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sensors/imu/crash.h"
+#include "sensors/imu/devices/lsm6dsox.h"
+#include "sensors/imu/devices/lsm6dsox_fsm.h"
+#include "lsm6dsox_reg.h"
+#include "common/settings.h"
+
+/*
+ * The fsm program encoding (sensors/imu/devices/lsm6dsox_fsm.c) is checked
+ * byte for byte, then the programs crash.c builds are loaded by the lsm6dsox
+ * driver into a fake device with the register banks and page memory of the
+ * part: the programs, their count and start address, the fsm rate, enables,
+ * init request and INT1 routing are read back. The fake runs an interpreter
+ * of the few fsm instructions used over the bytes the driver wrote, and
+ * synthetic 104 Hz traces are fed through it, one line per trace:
+ *
+ *   {"trace": "tumble", "samples": 104, "events": 2, "first_ms": 730, "int1": true}
+ *
+ * Hover and 180 dps maneuvers must fire nothing, an impact must fire on its
+ * sample, a spin above the tumble rate must fire once it has lasted the
+ * tumble time (a short one must not), and a drop must fire free-fall without
+ * INT1 (reported only by default). The status read must release INT1:
+ *
+ *   {"mode": "checks", "checks": 84, "failed": 0}
+ *
+ * The interpreter is this tool's reading of ST AN5273, like the encoder, so
+ * the checks hold the two together; the programs still need a bench check
+ * on the part (crash.h). The exit status is 1 if any check fails.
+ */
+
+/**
+  * @brief  Test Setup (the programs crash.c loads)
+  */
+#define FSM_HZ					104U
+#define PROGRAMS				3U
+#define START_ADDRESS			0x0400U
+#define INT1_MASK				(CRASH_EVENT_IMPACT | CRASH_EVENT_TUMBLE)
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+/**
+  * @brief  Fake Device (user and embedded function banks, 4 kB page memory)
+  */
+#define BANK_SIZE				128U
+#define PAGE_MEM_SIZE			4096U
+#define PAGE_WRITE				0x40U
+#define EMB_FUNC_LIR			0x80U
+#define FSM_EN					0x01U
+#define FSM_INIT				0x01U
+#define INT1_EMB_FUNC			0x02U
+#define INT_CLR_ON_READ			0x40U
+
+/**
+  * @brief  FSM Conditions and Commands (interpreted subset)
+  */
+#define COND_NOP				0x0U
+#define COND_TI3				0x3U
+#define COND_GNTH1				0x5U
+#define COND_LNTH1				0x7U
+#define CMD_CONT				0x22U
+
+typedef struct {
+	uint16_t address;			// first byte in page memory
+	uint8_t size;
+	uint8_t instr;				// first instruction (reset pointer)
+	uint8_t pp;					// program pointer
+	uint8_t timer3;				// TIMER3 (0: none)
+	uint8_t count;				// running timer count
+	float thresh1;
+	uint8_t input;
+	bool valid;
+} fsm_state_t;
+
+static struct {
+	uint8_t user[BANK_SIZE];
+	uint8_t emb[BANK_SIZE];
+	uint8_t mem[PAGE_MEM_SIZE];
+	fsm_state_t fsm[LSM6DSOX_FSM_PROGRAMS_MAX];
+	uint16_t status;			// latched FSM_STATUS_A/B
+	bool int1;
+	uint32_t page_writes;
+	uint32_t dropped_writes;	// page value written without the page write bit
+	uint32_t running_writes;	// page value written while the fsm ran
+	uint32_t inits;
+} dev;
+
+static unsigned checks;
+static unsigned failures;
+
+
+static void check(bool cond, const char *what, int line) {
+	checks++;
+
+	if (!cond) {
+		failures++;
+		fprintf(stderr, "crash_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+/**
+  * @brief half precision bits to float (the tool's own decoder)
+  */
+static float half_to_float(uint16_t h) {
+	int exp = (h >> 10) & 0x1F;
+	float mant = (float) (h & 0x03FFU);
+	float value;
+
+	if (exp == 0)
+		value = ldexpf(mant, -24);
+	else if (exp == 31)
+		value = INFINITY;
+	else
+		value = ldexpf(1.0f + mant / 1024.0f, exp - 15);
+
+	return (h & 0x8000U) ? -value : value;
+}
+
+/**
+  * @brief same rounding as crash.c
+  */
+static uint8_t fsm_samples(uint32_t ms) {
+	uint32_t samples = (ms * FSM_HZ + 500U) / 1000U;
+
+	if (samples == 0U)
+		return 1U;
+
+	return (samples > 255U) ? 255U : (uint8_t) samples;
+}
+
+/**
+  * @brief fake device: register bank selected by FUNC_CFG_ACCESS
+  */
+static uint8_t *bank(uint8_t reg) {
+	if ((reg != LSM6DSOX_FUNC_CFG_ACCESS) && ((dev.user[LSM6DSOX_FUNC_CFG_ACCESS] >> 6) == LSM6DSOX_EMBEDDED_FUNC_BANK))
+		return dev.emb;
+
+	return dev.user;
+}
+
+/**
+  * @brief fake device: parses the loaded programs (fsm init)
+  */
+static void fsm_init(void) {
+	uint16_t address = (uint16_t) (dev.mem[LSM6DSOX_FSM_START_ADD_L] | (dev.mem[LSM6DSOX_FSM_START_ADD_H] << 8));
+	uint8_t programs = dev.mem[LSM6DSOX_FSM_PROGRAMS];
+
+	memset(dev.fsm, 0, sizeof(dev.fsm));
+	dev.inits++;
+
+	for (uint32_t i = 0; (i < programs) && (i < LSM6DSOX_FSM_PROGRAMS_MAX); ++i) {
+		fsm_state_t *p = &dev.fsm[i];
+		const uint8_t *b;
+		uint8_t thresh = 0U, masks = 0U, ltimers = 0U, stimers = 0U, off = 6U;
+
+		if ((address + 6U) > PAGE_MEM_SIZE)
+			break;
+
+		b = &dev.mem[address];
+		p->address = address;
+		p->size = b[2];
+		p->input = b[3] & 0x07U;
+		thresh = b[0] >> 6;
+		masks = (b[0] >> 4) & 0x03U;
+		ltimers = (b[0] >> 2) & 0x03U;
+		stimers = b[0] & 0x03U;
+
+		if (thresh)
+			p->thresh1 = half_to_float((uint16_t) (b[off] | (b[off + 1U] << 8)));
+		p->valid = (thresh == 1U) && (masks == 1U) && (b[off + 2U] == 0x02U);		// THRESH1 on +V
+		off += 2U * thresh + 2U * masks;
+		if (ltimers || stimers)
+			off += ltimers ? 2U : 1U;				// TC
+		off += 2U * ltimers;
+		if (stimers)
+			p->timer3 = b[off];
+		off += stimers;
+
+		p->instr = off;
+		p->pp = off;
+		p->valid &= (p->size > off) && (dev.mem[address + p->size - 1U] == CMD_CONT);
+		address += p->size;
+	}
+}
+
+/**
+  * @brief fake device bus read
+  */
+static int32_t dev_read(uint8_t reg, uint8_t *bufp, uint16_t len) {
+	uint8_t *regs = bank(reg);
+
+	if ((regs == dev.user) && (reg == LSM6DSOX_FSM_STATUS_A_MAINPAGE)) {
+		dev.user[LSM6DSOX_FSM_STATUS_A_MAINPAGE] = (uint8_t) dev.status;
+		dev.user[LSM6DSOX_FSM_STATUS_B_MAINPAGE] = (uint8_t) (dev.status >> 8);
+		memcpy(bufp, &regs[reg], len);
+
+		/* Latched mode: the read clears the status and releases INT1 */
+		if (dev.emb[LSM6DSOX_PAGE_RW] & EMB_FUNC_LIR) {
+			dev.status = 0U;
+			dev.int1 = false;
+		}
+		return 0;
+	}
+
+	for (uint16_t i = 0; i < len; ++i)
+		bufp[i] = regs[(reg + i) & (BANK_SIZE - 1U)];
+
+	return 0;
+}
+
+/**
+  * @brief fake device bus write (page value auto-increments the address)
+  */
+static int32_t dev_write(uint8_t reg, const uint8_t *bufp, uint16_t len) {
+	uint8_t *regs = bank(reg);
+
+	if ((regs == dev.emb) && (reg == LSM6DSOX_PAGE_VALUE)) {
+		for (uint16_t i = 0; i < len; ++i) {
+			if (!(dev.emb[LSM6DSOX_PAGE_RW] & PAGE_WRITE)) {
+				dev.dropped_writes++;
+				continue;
+			}
+			if (dev.emb[LSM6DSOX_EMB_FUNC_EN_B] & FSM_EN)
+				dev.running_writes++;
+
+			dev.mem[((dev.emb[LSM6DSOX_PAGE_SEL] >> 4) << 8) | dev.emb[LSM6DSOX_PAGE_ADDRESS]] = bufp[i];
+			dev.emb[LSM6DSOX_PAGE_ADDRESS]++;
+			dev.page_writes++;
+		}
+		return 0;
+	}
+
+	for (uint16_t i = 0; i < len; ++i)
+		regs[(reg + i) & (BANK_SIZE - 1U)] = bufp[i];
+
+	if (regs == dev.user) {
+		/* Software reset completes at once */
+		dev.user[LSM6DSOX_CTRL3_C] &= (uint8_t) ~0x01U;
+
+	} else if ((reg == LSM6DSOX_EMB_FUNC_INIT_B) && (bufp[0] & FSM_INIT)) {
+		dev.emb[LSM6DSOX_EMB_FUNC_INIT_B] &= (uint8_t) ~FSM_INIT;		// request served at once
+		fsm_init();
+	}
+
+	return 0;
+}
+
+static const lsm6dsox_bus_t dev_bus = {.read = dev_read, .write = dev_write};
+
+/**
+  * @brief fake device: power-on state
+  */
+static void dev_reset(void) {
+	memset(&dev, 0, sizeof(dev));
+	dev.user[LSM6DSOX_WHO_AM_I] = LSM6DSOX_ID;
+	dev.emb[LSM6DSOX_PAGE_SEL] = 0x01U;
+}
+
+/**
+  * @brief evaluates a condition for a program on a sample
+  */
+static bool condition(fsm_state_t *p, uint8_t cond, float v) {
+	switch (cond) {
+	case COND_TI3:
+		return p->count == 0U;
+	case COND_GNTH1:
+		return v > p->thresh1;
+	case COND_LNTH1:
+		return v <= p->thresh1;
+	default:
+		return false;
+	}
+}
+
+/**
+  * @brief loads TIMER3 if the instruction at the program pointer uses it
+  */
+static void enter(fsm_state_t *p) {
+	uint8_t instr = dev.mem[p->address + p->pp];
+
+	if (((instr >> 4) == COND_TI3) || ((instr & 0x0FU) == COND_TI3))
+		p->count = p->timer3;
+}
+
+/**
+  * @brief fake device: one fsm sample (accel in g, gyro in dps)
+  *
+  * @retval programs that fired on the sample
+  */
+static uint16_t dev_fsm_step(const float xl[3], const float gy[3]) {
+	uint16_t enabled = (uint16_t) (dev.emb[LSM6DSOX_FSM_ENABLE_A] | (dev.emb[LSM6DSOX_FSM_ENABLE_B] << 8));
+	uint16_t int1 = (uint16_t) (dev.emb[LSM6DSOX_FSM_INT1_A] | (dev.emb[LSM6DSOX_FSM_INT1_B] << 8));
+	uint16_t fired = 0U;
+
+	if (!(dev.emb[LSM6DSOX_EMB_FUNC_EN_B] & FSM_EN))
+		return 0U;
+
+	for (uint32_t i = 0; i < LSM6DSOX_FSM_PROGRAMS_MAX; ++i) {
+		fsm_state_t *p = &dev.fsm[i];
+		const float *in = (p->input == LSM6DSOX_FSM_IN_GY) ? gy : xl;
+		float v = sqrtf(in[0] * in[0] + in[1] * in[1] + in[2] * in[2]);
+		uint8_t instr;
+
+		if (!p->valid || !(enabled & (1U << i)))
+			continue;
+
+		instr = dev.mem[p->address + p->pp];
+		if (p->count)
+			p->count--;
+
+		if (condition(p, instr >> 4, v)) {
+			p->pp = p->instr;
+			enter(p);
+			continue;
+		}
+
+		if (!condition(p, instr & 0x0FU, v))
+			continue;
+
+		p->pp++;
+		enter(p);
+
+		/* Commands run on the sample that reaches them */
+		if (dev.mem[p->address + p->pp] == CMD_CONT) {
+			fired |= (uint16_t) (1U << i);
+			p->pp = p->instr;
+			enter(p);
+		}
+	}
+
+	dev.status |= fired;
+	if ((fired & int1) && (dev.user[LSM6DSOX_MD1_CFG] & INT1_EMB_FUNC))
+		dev.int1 = true;
+
+	return fired;
+}
+
+/**
+  * @brief half precision conversion and program bytes
+  */
+static void run_encoding_checks(void) {
+	static const uint8_t impact[] = {0x50, 0x00, 12, 0x00, 0x00, 0x00, 0x00, 0x48, 0x02, 0x00, 0x05, 0x22};
+	static const uint8_t held[] = {0x51, 0x00, 15, 0x01, 0x00, 0x00, 0xA0, 0x61, 0x02, 0x00, 0x00, 26, 0x05, 0x73,
+								   0x22};
+	lsm6dsox_fsm_program_t prog;
+
+	CHECK(lsm6dsox_fsm_half(1.0f) == 0x3C00U);
+	CHECK(lsm6dsox_fsm_half(0.5f) == 0x3800U);
+	CHECK(lsm6dsox_fsm_half(8.0f) == 0x4800U);
+	CHECK(lsm6dsox_fsm_half(720.0f) == 0x61A0U);
+	CHECK(lsm6dsox_fsm_half(0.1f) == 0x2E66U);
+	CHECK(lsm6dsox_fsm_half(-2.0f) == 0xC000U);
+	CHECK(lsm6dsox_fsm_half(65504.0f) == 0x7BFFU);
+	CHECK(lsm6dsox_fsm_half(1.0e6f) == 0x7C00U);
+	CHECK(lsm6dsox_fsm_half(1.0e-9f) == 0x0000U);
+	CHECK(fabsf(half_to_float(lsm6dsox_fsm_half(CONFIG_CRASH_FREEFALL_G)) - CONFIG_CRASH_FREEFALL_G) < 1e-3f);
+
+	/* Impact: one crossing fires */
+	memset(&prog, 0xA5, sizeof(prog));
+	CHECK(lsm6dsox_fsm_norm_program(&prog, LSM6DSOX_FSM_IN_XL, true, 8.0f, 0U));
+	CHECK((prog.len == sizeof(impact)) && (memcmp(prog.bytes, impact, sizeof(impact)) == 0));
+
+	/* Held crossing: TIMER3 and the step back */
+	CHECK(lsm6dsox_fsm_norm_program(&prog, LSM6DSOX_FSM_IN_GY, true, 720.0f, 26U));
+	CHECK((prog.len == sizeof(held)) && (memcmp(prog.bytes, held, sizeof(held)) == 0));
+
+	CHECK(lsm6dsox_fsm_norm_program(&prog, LSM6DSOX_FSM_IN_XL, false, 0.35f, 16U));
+	CHECK((prog.len == 15U) && (prog.bytes[12] == 0x07U) && (prog.bytes[13] == 0x53U) && (prog.bytes[11] == 16U));
+
+	/* Thresholds that are not positive numbers are refused */
+	memset(&prog, 0, sizeof(prog));
+	CHECK(!lsm6dsox_fsm_norm_program(&prog, LSM6DSOX_FSM_IN_XL, true, 0.0f, 0U));
+	CHECK(!lsm6dsox_fsm_norm_program(&prog, LSM6DSOX_FSM_IN_XL, true, -1.0f, 0U));
+	CHECK(!lsm6dsox_fsm_norm_program(&prog, LSM6DSOX_FSM_IN_XL, true, NAN, 0U));
+	CHECK(!lsm6dsox_fsm_norm_program(&prog, LSM6DSOX_FSM_IN_XL, true, INFINITY, 0U));
+	CHECK(prog.len == 0U);
+}
+
+/**
+  * @brief the crash.c programs
+  */
+static void build_programs(lsm6dsox_fsm_program_t programs[PROGRAMS]) {
+	CHECK(lsm6dsox_fsm_norm_program(&programs[0], LSM6DSOX_FSM_IN_XL, true, CONFIG_CRASH_IMPACT_G, 0U));
+	CHECK(lsm6dsox_fsm_norm_program(&programs[1], LSM6DSOX_FSM_IN_GY, true, CONFIG_CRASH_TUMBLE_DPS,
+									fsm_samples(CONFIG_CRASH_TUMBLE_MS)));
+	CHECK(lsm6dsox_fsm_norm_program(&programs[2], LSM6DSOX_FSM_IN_XL, false, CONFIG_CRASH_FREEFALL_G,
+									fsm_samples(CONFIG_CRASH_FREEFALL_MS)));
+}
+
+/**
+  * @brief the driver's loader against the fake device
+  */
+static void run_loader_checks(const lsm6dsox_fsm_program_t programs[PROGRAMS]) {
+	lsm6dsox_fsm_program_t empty = {0};
+	uint16_t address = START_ADDRESS, fired = 0xFFFFU;
+	bool stored = true;
+
+	dev_reset();
+	lsm6dsox_set_bus(&dev_bus);
+
+	/* Refused before init and on bad arguments, with nothing written */
+	CHECK(lsm6dsox_fsm_load(programs, PROGRAMS, LSM6DSOX_ODR_FSM_104Hz, INT1_MASK) == IMU_ERROR_FATAL);
+	CHECK(lsm6dsox_fsm_status(&fired) == IMU_ERROR_FATAL);
+	CHECK(lsm6dsox_driver.init() == IMU_OK);
+	CHECK(lsm6dsox_fsm_load(programs, 0U, LSM6DSOX_ODR_FSM_104Hz, INT1_MASK) == IMU_ERROR_FATAL);
+	CHECK(lsm6dsox_fsm_load(programs, LSM6DSOX_FSM_PROGRAMS_MAX + 1U, LSM6DSOX_ODR_FSM_104Hz, INT1_MASK) ==
+		  IMU_ERROR_FATAL);
+	CHECK(lsm6dsox_fsm_load(&empty, 1U, LSM6DSOX_ODR_FSM_104Hz, INT1_MASK) == IMU_ERROR_FATAL);
+	CHECK(dev.page_writes == 0U);
+
+	/* Accel at 16 g so impacts stay in range */
+	CHECK(((dev.user[LSM6DSOX_CTRL1_XL] >> 2) & 0x03U) == LSM6DSOX_16g);
+
+	CHECK(lsm6dsox_fsm_load(programs, PROGRAMS, LSM6DSOX_ODR_FSM_104Hz, INT1_MASK) == IMU_OK);
+
+	/* Programs back to back from the start address, written with the fsm stopped */
+	for (uint32_t i = 0; i < PROGRAMS; ++i) {
+		stored &= (memcmp(&dev.mem[address], programs[i].bytes, programs[i].len) == 0);
+		address += programs[i].len;
+	}
+	CHECK(stored);
+	CHECK(dev.running_writes == 0U);
+	CHECK(dev.dropped_writes == 0U);
+	CHECK(dev.mem[LSM6DSOX_FSM_PROGRAMS] == PROGRAMS);
+	CHECK(dev.mem[LSM6DSOX_FSM_START_ADD_L] == (uint8_t) START_ADDRESS);
+	CHECK(dev.mem[LSM6DSOX_FSM_START_ADD_H] == (uint8_t) (START_ADDRESS >> 8));
+
+	/* Running: enabled, at 104 Hz, initialized once */
+	CHECK(dev.emb[LSM6DSOX_EMB_FUNC_EN_B] & FSM_EN);
+	CHECK(dev.emb[LSM6DSOX_FSM_ENABLE_A] == 0x07U);
+	CHECK(dev.emb[LSM6DSOX_FSM_ENABLE_B] == 0x00U);
+	CHECK(((dev.emb[LSM6DSOX_EMB_FUNC_ODR_CFG_B] >> 3) & 0x03U) == LSM6DSOX_ODR_FSM_104Hz);
+	CHECK(dev.inits == 1U);
+	for (uint32_t i = 0; i < PROGRAMS; ++i)
+		CHECK(dev.fsm[i].valid);
+
+	/* INT1: impact and tumble, latched, cleared by the status read */
+	CHECK(dev.emb[LSM6DSOX_FSM_INT1_A] == INT1_MASK);
+	CHECK(dev.emb[LSM6DSOX_FSM_INT1_B] == 0x00U);
+	CHECK(dev.user[LSM6DSOX_MD1_CFG] & INT1_EMB_FUNC);
+	CHECK(dev.emb[LSM6DSOX_PAGE_RW] & EMB_FUNC_LIR);
+	CHECK(!(dev.emb[LSM6DSOX_PAGE_RW] & PAGE_WRITE));
+	CHECK(dev.user[LSM6DSOX_TAP_CFG0] & INT_CLR_ON_READ);
+	CHECK((dev.user[LSM6DSOX_FUNC_CFG_ACCESS] >> 6) == LSM6DSOX_USER_BANK);
+
+	/* Thresholds as loaded */
+	CHECK(fabsf(dev.fsm[0].thresh1 - CONFIG_CRASH_IMPACT_G) < 1e-2f);
+	CHECK(fabsf(dev.fsm[1].thresh1 - CONFIG_CRASH_TUMBLE_DPS) < 1.0f);
+	CHECK(fabsf(dev.fsm[2].thresh1 - CONFIG_CRASH_FREEFALL_G) < 1e-3f);
+	CHECK((dev.fsm[0].timer3 == 0U) && (dev.fsm[1].timer3 == fsm_samples(CONFIG_CRASH_TUMBLE_MS)) &&
+		  (dev.fsm[2].timer3 == fsm_samples(CONFIG_CRASH_FREEFALL_MS)));
+
+	CHECK(lsm6dsox_fsm_status(&fired) == IMU_OK);
+	CHECK(fired == 0U);
+}
+
+/**
+  * @brief  Trace Type (accel in g, gyro in dps, per fsm sample)
+  */
+typedef void (*trace_fn_t)(uint32_t n, float xl[3], float gy[3]);
+
+static float noise(float amplitude) {
+	return amplitude * (2.0f * (float) rand() / (float) RAND_MAX - 1.0f);
+}
+
+static void hover(uint32_t n, float xl[3], float gy[3]) {
+	(void) n;
+	xl[0] = noise(0.05f);
+	xl[1] = noise(0.05f);
+	xl[2] = 1.0f + noise(0.05f);
+	gy[0] = noise(2.0f);
+	gy[1] = noise(2.0f);
+	gy[2] = noise(2.0f);
+}
+
+static void maneuvers(uint32_t n, float xl[3], float gy[3]) {
+	float t = (float) n / (float) FSM_HZ;
+
+	hover(n, xl, gy);
+	xl[2] = 1.5f + 1.0f * sinf(2.0f * (float) M_PI * 0.7f * t);		// 0.5 .. 2.5 g
+	gy[0] += 180.0f * sinf(2.0f * (float) M_PI * 0.5f * t);
+	gy[1] += 180.0f * cosf(2.0f * (float) M_PI * 0.5f * t);
+}
+
+static void impact(uint32_t n, float xl[3], float gy[3]) {
+	hover(n, xl, gy);
+	if (n == 50U)
+		xl[0] = 12.0f;
+}
+
+static void spin(uint32_t n, float xl[3], float gy[3], float dps, uint32_t ms) {
+	hover(n, xl, gy);
+	if ((n >= 50U) && (n < 50U + ms * FSM_HZ / 1000U))
+		gy[2] = dps;
+}
+
+static void tumble(uint32_t n, float xl[3], float gy[3]) {
+	spin(n, xl, gy, 900.0f, 400U);
+}
+
+static void short_spin(uint32_t n, float xl[3], float gy[3]) {
+	spin(n, xl, gy, 900.0f, 200U);
+}
+
+static void fast_roll(uint32_t n, float xl[3], float gy[3]) {
+	spin(n, xl, gy, 700.0f, 2000U);
+}
+
+static void drop(uint32_t n, float xl[3], float gy[3], uint32_t ms) {
+	hover(n, xl, gy);
+	if ((n >= 50U) && (n < 50U + ms * FSM_HZ / 1000U)) {
+		xl[0] = noise(0.05f);
+		xl[1] = noise(0.05f);
+		xl[2] = noise(0.05f);
+	}
+}
+
+static void freefall(uint32_t n, float xl[3], float gy[3]) {
+	drop(n, xl, gy, 400U);
+}
+
+static void short_drop(uint32_t n, float xl[3], float gy[3]) {
+	drop(n, xl, gy, 100U);
+}
+
+/**
+  * @brief feeds a trace through the fsm
+  *
+  * @retval programs that fired over the trace
+  */
+static uint16_t run_trace(const char *name, trace_fn_t fn, uint32_t samples, uint32_t *first_ms, bool *int1) {
+	uint16_t events = 0U;
+	float xl[3], gy[3];
+
+	*first_ms = 0U;
+	*int1 = false;
+
+	for (uint32_t n = 0; n < samples; ++n) {
+		uint16_t fired;
+
+		fn(n, xl, gy);
+		fired = dev_fsm_step(xl, gy);
+		if (fired && !events)
+			*first_ms = n * 1000U / FSM_HZ;
+		events |= fired;
+		*int1 |= dev.int1;
+	}
+
+	printf("{\"trace\": \"%s\", \"samples\": %u, \"events\": %u, \"first_ms\": %u, \"int1\": %s}\n",
+		   name, samples, events, *first_ms, *int1 ? "true" : "false");
+
+	return events;
+}
+
+/**
+  * @brief synthetic traces through the loaded programs
+  */
+static void run_trace_checks(void) {
+	uint32_t first_ms, ms_50 = 50U * 1000U / FSM_HZ;
+	uint16_t fired;
+	bool int1;
+
+	srand(1);
+
+	CHECK(run_trace("hover", hover, 10U * FSM_HZ, &first_ms, &int1) == 0U);
+	CHECK(!int1);
+	CHECK(run_trace("maneuvers", maneuvers, 10U * FSM_HZ, &first_ms, &int1) == 0U);
+	CHECK(!int1);
+
+	/* Impact: on its sample, INT1 until the status read */
+	CHECK(run_trace("impact", impact, FSM_HZ, &first_ms, &int1) == CRASH_EVENT_IMPACT);
+	CHECK(int1 && (first_ms == ms_50));
+	CHECK(dev.int1);
+	CHECK(lsm6dsox_fsm_status(&fired) == IMU_OK);
+	CHECK(fired == CRASH_EVENT_IMPACT);
+	CHECK(!dev.int1);
+	CHECK((lsm6dsox_fsm_status(&fired) == IMU_OK) && (fired == 0U));
+
+	/* Tumble: once held for the tumble time */
+	CHECK(run_trace("short_spin", short_spin, FSM_HZ, &first_ms, &int1) == 0U);
+	CHECK(run_trace("fast_roll", fast_roll, 3U * FSM_HZ, &first_ms, &int1) == 0U);
+	CHECK(run_trace("tumble", tumble, FSM_HZ, &first_ms, &int1) == CRASH_EVENT_TUMBLE);
+	CHECK(int1);
+	CHECK((first_ms >= ms_50 + CONFIG_CRASH_TUMBLE_MS) && (first_ms <= ms_50 + CONFIG_CRASH_TUMBLE_MS + 20U));
+	CHECK((lsm6dsox_fsm_status(&fired) == IMU_OK) && (fired == CRASH_EVENT_TUMBLE) && !dev.int1);
+
+	/* Free-fall: once held, reported only */
+	CHECK(run_trace("short_drop", short_drop, FSM_HZ, &first_ms, &int1) == 0U);
+	CHECK(run_trace("freefall", freefall, FSM_HZ, &first_ms, &int1) == CRASH_EVENT_FREEFALL);
+	CHECK(!int1);
+	CHECK((first_ms >= ms_50 + CONFIG_CRASH_FREEFALL_MS) && (first_ms <= ms_50 + CONFIG_CRASH_FREEFALL_MS + 20U));
+	CHECK((lsm6dsox_fsm_status(&fired) == IMU_OK) && (fired == CRASH_EVENT_FREEFALL));
+
+	/* Nothing to read once the driver is down */
+	CHECK(lsm6dsox_driver.deinit() == IMU_OK);
+	CHECK(lsm6dsox_fsm_status(&fired) == IMU_ERROR_FATAL);
+}
+
+int main(int argc, char **argv) {
+	lsm6dsox_fsm_program_t programs[PROGRAMS];
+
+	if (argc > 1) {
+		fprintf(stderr, "usage: %s\n", argv[0]);
+		return 2;
+	}
+
+	run_encoding_checks();
+	build_programs(programs);
+	run_loader_checks(programs);
+	run_trace_checks();
+	printf("{\"mode\": \"checks\", \"checks\": %u, \"failed\": %u}\n", checks, failures);
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,459 @@
+/*
+ * esctlm_main.c (esc telemetry host test)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sitl.h"
+#include "sim_hw.h"
+#include "esc/esc_telemetry_parser.h"
+#include "params/params.h"
+#include "common/crc.h"
+#include "common/cycles.h"
+#include "common/settings.h"
+
+/*
+ * First common/crc.c crc8 is checked against the standard check value, and
+ * esc/esc_telemetry_parser.c against hand-built KISS frames: field decoding
+ * and units, every single-bit error rejected, frames split at every byte,
+ * resync after line noise, stray bytes, the request timeout, round-robin
+ * order, stale motor data, dma ring wrap-around, and a long exchange with
+ * corrupted and lost replies in which no frame is credited to the wrong
+ * motor. Then esc/esc_telemetry.c (the sim replacement, unmodified parser) is
+ * run in the simulator:
+ *
+ *   {"mode": "checks", "checks": 49, "failed": 0}
+ *
+ * then the parser's throughput is timed on a long exchange fed one frame per
+ * loop (request bookkeeping included):
+ *
+ *   {"mode": "throughput", "ns_per_byte": 3.26, "ns_per_frame": 32.6, ...}
+ *
+ * then a 30 s flight is flown in altitude hold; the telemetry rpm, current
+ * and temperature are compared against the simulator's motors:
+ *
+ *   {"mode": "flight", "rpm_rms": 22.7, "current_rms_a": 0.096, ...}
+ *
+ * The exit status is 1 if any check fails.
+ */
+
+/**
+  * @brief  Test Setup
+  */
+#define LOOP_US					2398U
+#define TIMEOUT_US				CONFIG_ESC_TLM_TIMEOUT_US
+#define STALE_US				(CONFIG_ESC_TLM_STALE_MS * 1000U)
+#define POLES					CONFIG_ESC_MOTOR_POLES
+#define EXCHANGE_LOOPS			20000U
+#define THROUGHPUT_LOOPS		200000U
+#define FLIGHT_SECONDS			30.0
+#define SETTLE_SECONDS			5.0
+#define ARM_SECONDS				0.5
+#define ALT_HOLD_SECONDS		1.0
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+static unsigned checks;
+static unsigned failures;
+static uint32_t rng_state = 1U;
+
+
+static void check(bool cond, const char *what, int line) {
+	checks++;
+
+	if (!cond) {
+		failures++;
+		fprintf(stderr, "esctlm_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+/**
+  * @brief xorshift32
+  */
+static uint32_t rand_u32(void) {
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return rng_state;
+}
+
+/**
+  * @brief motor telemetry truth of an esc at a loop (distinct per motor)
+  */
+static esc_motor_tlm_t truth(uint8_t motor, uint32_t loop) {
+	return (esc_motor_tlm_t) {.voltage_v = 14.0f + 0.01f * (float) (loop % 200U),
+							  .current_a = (float) motor + 0.01f * (float) (loop % 1000U),
+							  .erpm = 1000U * motor + 100U * (loop % 500U),
+							  .consumption_mah = (uint16_t) (loop / 10U + motor),
+							  .temperature_c = (uint8_t) (30U + motor)};
+}
+
+/**
+  * @brief crc8 (poly 0x07, init 0, no reflection: "123456789" -> 0xF4)
+  */
+static void run_crc_checks(void) {
+	const uint8_t check_str[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+	CHECK(crc8(check_str, sizeof(check_str)) == 0xF4U);
+	CHECK(crc8(check_str, 0U) == CRC8_INIT);
+	CHECK(crc8_update(crc8(check_str, 4U), &check_str[4], 5U) == 0xF4U);
+}
+
+/**
+  * @brief frame layout, units and crc
+  */
+static void run_frame_checks(void) {
+	/* 36 C, 16.08 V, 12.34 A, 567 mAh, 70000 erpm */
+	const uint8_t expect[ESC_TLM_FRAME_LEN - 1U] = {0x24U, 0x06U, 0x48U, 0x04U, 0xD2U, 0x02U, 0x37U, 0x02U, 0xBCU};
+	esc_motor_tlm_t in = {.voltage_v = 16.08f, .current_a = 12.34f, .erpm = 70000U, .consumption_mah = 567U,
+						  .temperature_c = 36U};
+	esc_motor_tlm_t out = {0};
+	uint8_t frame[ESC_TLM_FRAME_LEN];
+	uint32_t rejected = 0U;
+
+	CHECK(esc_telemetry_frame(&in, frame) == ESC_TLM_FRAME_LEN);
+	CHECK(!memcmp(frame, expect, sizeof(expect)));
+	CHECK(frame[ESC_TLM_FRAME_LEN - 1U] == crc8(expect, sizeof(expect)));
+
+	CHECK(esc_telemetry_decode(frame, (float) (POLES / 2U), &out));
+	CHECK((out.temperature_c == 36U) && (out.consumption_mah == 567U) && (out.erpm == 70000U));
+	CHECK((fabsf(out.voltage_v - 16.08f) < 1e-4f) && (fabsf(out.current_a - 12.34f) < 1e-4f));
+	CHECK(fabsf(out.rpm - 70000.0f / (float) (POLES / 2U)) < 1e-2f);
+
+	/* Every single-bit error is caught */
+	for (uint32_t bit = 0; bit < ESC_TLM_FRAME_LEN * 8U; ++bit) {
+		uint8_t bad[ESC_TLM_FRAME_LEN];
+
+		memcpy(bad, frame, sizeof(bad));
+		bad[bit / 8U] ^= (uint8_t) (1U << (bit % 8U));
+		rejected += esc_telemetry_decode(bad, 7.0f, &out) ? 0U : 1U;
+	}
+	CHECK(rejected == ESC_TLM_FRAME_LEN * 8U);
+
+	/* Fields saturate */
+	in = (esc_motor_tlm_t) {.voltage_v = 700.0f, .current_a = -1.0f, .erpm = 10000000U};
+	(void) esc_telemetry_frame(&in, frame);
+	CHECK(esc_telemetry_decode(frame, 7.0f, &out));
+	CHECK((out.voltage_v > 655.0f) && (out.current_a == 0.0f) && (out.erpm == 6553500U));
+}
+
+/**
+  * @brief parser and scheduler on hand-fed exchanges
+  */
+static void run_parser_checks(void) {
+	const uint8_t noise[3] = {0x55U, 0x00U, 0xA7U};
+	esc_tlm_parser_t p;
+	esc_tlm_data_t out;
+	esc_motor_tlm_t t;
+	uint8_t frame[ESC_TLM_FRAME_LEN];
+	uint8_t ring[16];
+	uint32_t tail, head, frames = 0U;
+	uint64_t now = 1000U, frame_us;
+	bool order = true, split = true;
+
+	memset(&out, 0, sizeof(out));
+	esc_telemetry_parser_init(&p, TIMEOUT_US, STALE_US, POLES);
+
+	/* Nothing requested: bytes are dropped */
+	t = truth(0U, 1U);
+	(void) esc_telemetry_frame(&t, frame);
+	CHECK(esc_telemetry_parser_feed(&p, frame, sizeof(frame), now, &out) == 0U);
+	CHECK((p.stats.stray_bytes == ESC_TLM_FRAME_LEN) && (out.fresh == 0U));
+
+	/* Round robin from esc 0, the next request as soon as a frame completed */
+	for (uint32_t n = 0; n < 2U * ESC_COUNT; ++n) {
+		uint8_t m = esc_telemetry_parser_poll(&p, now, &out);
+
+		order &= (m == n % ESC_COUNT);
+		t = truth(m, n);
+		(void) esc_telemetry_frame(&t, frame);
+		frames += esc_telemetry_parser_feed(&p, frame, sizeof(frame), now, &out);
+		now += LOOP_US;
+	}
+	CHECK(order && (frames == 2U * ESC_COUNT));
+	CHECK(out.fresh == 0x0FU);
+	CHECK((p.stats.frames == 2U * ESC_COUNT) && (p.stats.crc_errors == 0U) && (p.stats.timeouts == 0U));
+	CHECK(out.motor[3].valid && (out.motor[3].erpm == truth(3U, 7U).erpm));
+
+	/* Total current over the valid motors */
+	(void) esc_telemetry_parser_poll(&p, now, &out);
+	CHECK(fabsf(out.current_a - (out.motor[0].current_a + out.motor[1].current_a + out.motor[2].current_a +
+								 out.motor[3].current_a)) < 1e-4f);
+
+	/* A frame split at every byte decodes the same (request for esc 0 is out) */
+	esc_telemetry_parser_init(&p, TIMEOUT_US, STALE_US, POLES);
+	for (uint32_t cut = 0; cut <= ESC_TLM_FRAME_LEN; ++cut) {
+		uint8_t m = esc_telemetry_parser_poll(&p, now, &out);
+
+		t = truth(m, 100U + cut);
+		(void) esc_telemetry_frame(&t, frame);
+		out.fresh = 0U;
+		(void) esc_telemetry_parser_feed(&p, frame, cut, now, &out);
+		(void) esc_telemetry_parser_feed(&p, &frame[cut], ESC_TLM_FRAME_LEN - cut, now, &out);
+		split &= (out.fresh == (1U << m)) && (out.motor[m].erpm == t.erpm) &&
+				 (out.motor[m].consumption_mah == t.consumption_mah);
+		now += LOOP_US;
+	}
+	CHECK(split && (p.stats.crc_errors == 0U));
+
+	/* Line noise ahead of the reply: resynced on the frame */
+	esc_telemetry_parser_init(&p, TIMEOUT_US, STALE_US, POLES);
+	memset(&out, 0, sizeof(out));
+	CHECK(esc_telemetry_parser_poll(&p, now, &out) == 0U);
+	t = truth(0U, 42U);
+	(void) esc_telemetry_frame(&t, frame);
+	(void) esc_telemetry_parser_feed(&p, noise, sizeof(noise), now, &out);
+	CHECK(esc_telemetry_parser_feed(&p, frame, sizeof(frame), now, &out) == 1U);
+	CHECK((p.stats.crc_errors == sizeof(noise)) && (out.motor[0].erpm == t.erpm));
+	frame_us = now;
+
+	/* No reply: the request times out and the next esc is asked; a partial
+	 * frame is dropped with it */
+	CHECK(esc_telemetry_parser_poll(&p, now, &out) == 1U);
+	(void) esc_telemetry_parser_feed(&p, frame, 4U, now, &out);
+	CHECK(esc_telemetry_parser_poll(&p, now + TIMEOUT_US - 1U, &out) == ESC_TLM_NO_REQUEST);
+	CHECK(esc_telemetry_parser_poll(&p, now + TIMEOUT_US, &out) == 2U);
+	CHECK((p.stats.timeouts == 1U) && (p.len == 0U));
+	now += TIMEOUT_US;
+
+	/* Motor data expires CONFIG_ESC_TLM_STALE_MS after its frame */
+	(void) esc_telemetry_parser_poll(&p, frame_us + STALE_US - 1U, &out);
+	CHECK(out.motor[0].valid && !out.motor[1].valid && (out.current_a == out.motor[0].current_a));
+	(void) esc_telemetry_parser_poll(&p, frame_us + STALE_US, &out);
+	CHECK(!out.motor[0].valid && (out.current_a == 0.0f));
+
+	/* Ring wrap-around (dma buffer read in place) */
+	esc_telemetry_parser_init(&p, TIMEOUT_US, STALE_US, POLES);
+	memset(&out, 0, sizeof(out));
+	(void) esc_telemetry_parser_poll(&p, now, &out);
+	t = truth(0U, 7U);
+	(void) esc_telemetry_frame(&t, frame);
+	tail = 12U;
+	for (uint32_t i = 0; i < ESC_TLM_FRAME_LEN; ++i)
+		ring[(tail + i) % sizeof(ring)] = frame[i];
+	head = (tail + ESC_TLM_FRAME_LEN) % sizeof(ring);
+	CHECK(esc_telemetry_parser_feed_ring(&p, ring, sizeof(ring), &tail, head, now, &out) == 1U);
+	CHECK((tail == head) && (out.motor[0].erpm == t.erpm));
+}
+
+/**
+  * @brief long exchange with escs that reply to each request, some replies
+  * 	   corrupted (one bit) or lost: every decoded frame must hold the truth
+  * 	   of the motor it is credited to
+  */
+static void run_exchange_checks(void) {
+	esc_tlm_parser_t p;
+	esc_tlm_data_t out;
+	uint8_t frame[ESC_TLM_FRAME_LEN];
+	uint32_t replies = 0U, corrupted = 0U, lost = 0U, wrong = 0U, frames = 0U;
+	uint64_t now = 0U;
+
+	memset(&out, 0, sizeof(out));
+	esc_telemetry_parser_init(&p, TIMEOUT_US, STALE_US, POLES);
+
+	for (uint32_t loop = 0; loop < EXCHANGE_LOOPS; ++loop) {
+		uint8_t m = esc_telemetry_parser_poll(&p, now, &out);
+
+		out.fresh = 0U;
+		if (m != ESC_TLM_NO_REQUEST) {
+			uint32_t r = rand_u32() % 100U;
+			esc_motor_tlm_t t = truth(m, loop);
+
+			(void) esc_telemetry_frame(&t, frame);
+			if (r < 5U) {
+				lost++;
+			} else {
+				if (r < 10U) {
+					frame[rand_u32() % ESC_TLM_FRAME_LEN] ^= (uint8_t) (1U << (rand_u32() % 8U));
+					corrupted++;
+				}
+				replies++;
+				frames += esc_telemetry_parser_feed(&p, frame, sizeof(frame), now, &out);
+				if (out.fresh && ((out.fresh != (1U << m)) || (out.motor[m].erpm != t.erpm) ||
+								  (out.motor[m].consumption_mah != t.consumption_mah)))
+					wrong++;
+			}
+		}
+		now += LOOP_US;
+	}
+
+	CHECK(wrong == 0U);
+	CHECK(frames == replies - corrupted);
+	CHECK(p.stats.timeouts == lost + corrupted);
+	CHECK(p.stats.crc_errors >= corrupted);
+}
+
+/**
+  * @brief esc_telemetry.c in the simulator (sim esc replies to the requests)
+  */
+static void run_module_checks(void) {
+	sitl_config_t cfg;
+	sitl_state_t s;
+	esc_tlm_stats_t st;
+	uint32_t fresh[ESC_COUNT] = {0};
+	bool ok = true;
+
+	sitl_default_config(&cfg);
+	CHECK(sitl_init(&cfg) == SITL_OK);
+
+	for (uint32_t n = 0; n < cfg.loop_hz; ++n) {
+		ok &= (sitl_step(1U) == SITL_OK);
+		sitl_get_state(&s);
+		for (uint32_t m = 0; m < ESC_COUNT; ++m)
+			fresh[m] += (s.flight.esc_tlm.fresh >> m) & 1U;
+	}
+	esc_telemetry_get_stats(&st);
+
+	/* One esc answers per loop: each at a quarter of the loop rate */
+	CHECK(ok && (s.status.esc_tlm == ESC_TLM_OK));
+	CHECK((st.crc_errors == 0U) && (st.timeouts == 0U) && (st.overruns == 0U));
+	for (uint32_t m = 0; m < ESC_COUNT; ++m) {
+		CHECK((fresh[m] + 2U >= cfg.loop_hz / ESC_COUNT) && (fresh[m] <= cfg.loop_hz / ESC_COUNT + 2U));
+		CHECK(s.flight.esc_tlm.motor[m].valid && (s.flight.esc_tlm.motor[m].erpm == 0U));
+	}
+	CHECK(fabsf(s.flight.esc_tlm.motor[0].voltage_v - s.batt_ocv_v) < 0.1f);
+	CHECK(s.flight.esc_tlm.motor[0].temperature_c == 25U);
+}
+
+/**
+  * @brief maps a stick deflection (-1..1) to a pulse width
+  */
+static uint32_t stick_us(float x) {
+	float min = (float) params_get_u32(PARAM_RC_PULSE_MIN_US);
+	float max = (float) params_get_u32(PARAM_RC_PULSE_MAX_US);
+
+	x = fminf(fmaxf(x, -1.0f), 1.0f);
+	return (uint32_t) lroundf(0.5f * (min + max) + x * 0.5f * (max - min));
+}
+
+/**
+  * @brief flight in altitude hold: telemetry against the simulated motors
+  */
+static void run_flight(void) {
+	static const float climb_pattern[] = {0.6f, 0.0f, -0.4f, 0.0f, 0.8f, -0.6f};
+	sitl_config_t cfg;
+	sitl_state_t s;
+	sitl_rc_t rc;
+	esc_tlm_stats_t st;
+	double t, rpm_sq = 0.0, cur_sq = 0.0, rpm_max = 0.0, rpm_mean = 0.0;
+	uint32_t n = 0U, segment, warnings = 0U;
+	bool flew = false, valid = true;
+
+	sitl_default_config(&cfg);
+	if (sitl_init(&cfg) != SITL_OK) {
+		CHECK(false);
+		return;
+	}
+	CHECK(sitl_set_param("RC_MODE_SW_HIGH", (float) ALT_HOLD_MODE) == SITL_OK);
+
+	rc = (sitl_rc_t){.roll_us = stick_us(0.0f), .pitch_us = stick_us(0.0f), .yaw_us = stick_us(0.0f),
+					 .throttle_us = stick_us(-1.0f), .arm = false, .mode = ANGLE_MODE};
+
+	for (uint32_t loop = 0; loop < (uint32_t) ((SETTLE_SECONDS + FLIGHT_SECONDS) * cfg.loop_hz); ++loop) {
+		t = (double) loop / cfg.loop_hz;
+
+		rc.arm = (t >= ARM_SECONDS);
+		if (t >= ALT_HOLD_SECONDS) {
+			segment = (uint32_t) ((t - ALT_HOLD_SECONDS) / 3.0);
+			rc.mode = ALT_HOLD_MODE;
+			rc.throttle_us = stick_us((segment == 0U) ? 0.8f :
+									  climb_pattern[segment % (sizeof(climb_pattern) / sizeof(climb_pattern[0]))]);
+		}
+		sitl_set_rc(&rc);
+		sitl_step(1U);
+
+		sitl_get_state(&s);
+		warnings += (s.status.esc_tlm != ESC_TLM_OK) ? 1U : 0U;
+		if (t < SETTLE_SECONDS)
+			continue;
+
+		flew |= (s.status.phase == FLIGHT_PHASE_FLYING);
+		for (uint32_t m = 0; m < ESC_COUNT; ++m) {
+			double e = (double) s.flight.esc_tlm.motor[m].rpm - (double) s.motor_rpm[m];
+
+			valid &= s.flight.esc_tlm.motor[m].valid;
+			rpm_sq += e * e;
+			rpm_max = fmax(rpm_max, fabs(e));
+			rpm_mean += (double) s.motor_rpm[m];
+			cur_sq += pow((double) s.flight.esc_tlm.motor[m].current_a - (double) s.motor_current_a[m], 2.0);
+		}
+		++n;
+	}
+	esc_telemetry_get_stats(&st);
+
+	/* Telemetry lags the motors by up to one round of requests (~10 ms) */
+	CHECK(flew && valid && n && (warnings == 0U));
+	CHECK(sqrt(rpm_sq / (n * ESC_COUNT)) < 0.02 * rpm_mean / (n * ESC_COUNT));
+	CHECK(sqrt(cur_sq / (n * ESC_COUNT)) < 0.3);
+	CHECK(s.flight.esc_tlm.motor[0].temperature_c > 25U);
+	CHECK(fabsf(s.flight.esc_tlm.current_a - (s.batt_current_a - 0.3f)) < 1.0f);
+
+	printf("{\"mode\": \"flight\", \"seconds\": %.0f, \"rpm_mean\": %.0f, \"rpm_rms\": %.1f, \"rpm_max_err\": %.0f, "
+		   "\"current_rms_a\": %.3f, \"current_sum_a\": %.2f, \"pack_current_a\": %.2f, \"temperature_c\": [%u, %u, %u, %u], "
+		   "\"frames\": %u, \"crc_errors\": %u, \"timeouts\": %u}\n",
+		   FLIGHT_SECONDS, rpm_mean / (n * ESC_COUNT), sqrt(rpm_sq / (n * ESC_COUNT)), rpm_max,
+		   sqrt(cur_sq / (n * ESC_COUNT)), (double) s.flight.esc_tlm.current_a, (double) s.batt_current_a,
+		   s.flight.esc_tlm.motor[0].temperature_c, s.flight.esc_tlm.motor[1].temperature_c,
+		   s.flight.esc_tlm.motor[2].temperature_c, s.flight.esc_tlm.motor[3].temperature_c,
+		   st.frames, st.crc_errors, st.timeouts);
+}
+
+/**
+  * @brief parser throughput on a long exchange, one frame per loop
+  */
+static void run_throughput(void) {
+	uint8_t (*stream)[ESC_TLM_FRAME_LEN] = malloc((size_t) ESC_COUNT * 256U * ESC_TLM_FRAME_LEN);
+	esc_tlm_parser_t p;
+	esc_tlm_data_t out;
+	uint32_t frames = 0U;
+	uint64_t now = 0U;
+
+	for (uint32_t i = 0; i < ESC_COUNT * 256U; ++i) {
+		esc_motor_tlm_t t = truth((uint8_t) (i % ESC_COUNT), i);
+		(void) esc_telemetry_frame(&t, stream[i]);
+	}
+
+	memset(&out, 0, sizeof(out));
+	esc_telemetry_parser_init(&p, TIMEOUT_US, STALE_US, POLES);
+	uint32_t start = cycles_now();
+	for (uint32_t loop = 0; loop < THROUGHPUT_LOOPS; ++loop) {
+		now += LOOP_US;
+		(void) esc_telemetry_parser_poll(&p, now, &out);
+		frames += esc_telemetry_parser_feed(&p, stream[loop % (ESC_COUNT * 256U)], ESC_TLM_FRAME_LEN, now, &out);
+	}
+	double ns = (double) (uint32_t) (cycles_now() - start);
+
+	CHECK((frames == THROUGHPUT_LOOPS) && (p.stats.crc_errors == 0U));
+
+	printf("{\"mode\": \"throughput\", \"frames\": %u, \"ns_per_byte\": %.2f, \"ns_per_frame\": %.1f, "
+		   "\"mb_per_s\": %.1f}\n",
+		   frames, ns / ((double) frames * ESC_TLM_FRAME_LEN), ns / frames,
+		   1.0e3 * (double) frames * ESC_TLM_FRAME_LEN / ns);
+
+	free(stream);
+}
+
+int main(int argc, char **argv) {
+	if (argc > 1) {
+		fprintf(stderr, "usage: %s\n", argv[0]);
+		return 2;
+	}
+
+	cycles_init();
+	run_crc_checks();
+	run_frame_checks();
+	run_parser_checks();
+	run_exchange_checks();
+	run_module_checks();
+	printf("{\"mode\": \"checks\", \"checks\": %u, \"failed\": %u}\n", checks, failures);
+
+	run_throughput();
+	run_flight();
+
+	return failures ? 1 : 0;
+}
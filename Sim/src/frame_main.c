@@ -0,0 +1,525 @@
+/*
+ * frame_main.c (usb link framing host test)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "comms/frame.h"
+#include "common/crc.h"
+
+/*
+ * Runs comms/frame.c (COBS framing with the crc16) unmodified. First the
+ * crc16 against its standard check value, then every payload length with
+ * zeros, no zeros, runs of zeros and random bytes round-trips through the
+ * encoder and the decoder fed one byte at a time; the encoded frame must hold
+ * no zero before its delimiter and fit frame_encoded_size_max. Then the edge
+ * cases:
+ *
+ * - the longest frame (FRAME_PAYLOAD_MAX) and one byte over it (refused)
+ * - the longest COBS block: the raw frame is at most FRAME_RAW_MAX (244)
+ *   bytes, so the encoder never closes a full 254-byte block (code 0xFF); a
+ *   hand-built 0xFF block and a 255-byte run are longer than any frame and
+ *   must come out as an overflow, not in the buffer after it
+ * - encoding across the wrap of a ring (mask)
+ * - a frame cut short by a delimiter, a bad crc (every single-bit error in
+ *   the raw frame), short frames and back-to-back delimiters
+ * - resync after garbage: whatever the noise, the first frame after the
+ *   next delimiter decodes
+ *
+ * then a fuzz of random frames through a line that flips, drops and inserts
+ * bytes: every frame the line left alone (with the delimiter before it
+ * intact) must decode, and a damaged frame may only get through at the rate
+ * a 16-bit crc allows:
+ *
+ *   {"mode": "fuzz", "frames": 200000, "damaged": 43291, "clean": 156508,
+ *    "decoded": 156508, "false_accepts": 0, "missed": 0}
+ *
+ * then the throughput of the encoder and the decoder on the longest frames
+ * with random payloads (host figures; a full-speed cdc link carries at most
+ * about 1.2 MB/s):
+ *
+ *   {"mode": "throughput", "encode_mb_per_s": 327, "decode_mb_per_s": 209,
+ *    "encode_ns_per_frame": 752, "decode_ns_per_frame": 1177}
+ *   {"mode": "checks", "checks": 29, "failed": 0}
+ *
+ * The exit status is 1 if any check fails.
+ */
+
+#define FUZZ_FRAMES				200000U
+#define FUZZ_ERROR_RATE			2000U		// per million bytes
+#define THROUGHPUT_FRAMES		200000U
+#define RING_SIZE				512U
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+static unsigned checks;
+static unsigned failures;
+static uint32_t rng_state = 0x2545F491U;
+
+
+static void check(bool cond, const char *what, int line) {
+	checks++;
+
+	if (!cond) {
+		failures++;
+		fprintf(stderr, "frame_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+static double now_s(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + 1e-9 * (double) ts.tv_nsec;
+}
+
+static uint32_t rng(void) {
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return rng_state;
+}
+
+/**
+  * @brief helper function to feed bytes and keep the last status and frame
+  *
+  * @retval FRAME_OK count
+  */
+static uint32_t feed(frame_decoder_t *dec, const uint8_t *src, size_t n, frame_status_t *last, frame_t *out) {
+	uint32_t ok = 0U;
+
+	for (size_t i = 0; i < n; ++i) {
+		frame_status_t s = frame_decoder_push(dec, src[i], out);
+
+		if (s != FRAME_INCOMPLETE)
+			*last = s;
+		if (s == FRAME_OK)
+			ok++;
+	}
+
+	return ok;
+}
+
+/**
+  * @brief helper function to check an encoded frame decodes to what was sent
+  */
+static bool round_trip(uint8_t msg_id, uint8_t seq, const uint8_t *payload, uint16_t len) {
+	uint8_t enc[FRAME_ENCODED_MAX];
+	frame_decoder_t dec;
+	frame_status_t last = FRAME_INCOMPLETE;
+	frame_t f;
+	size_t n = frame_encode(enc, UINT32_MAX, 0U, msg_id, seq, payload, len);
+
+	if ((n == 0U) || (n > frame_encoded_size_max(len)) || (enc[n - 1U] != FRAME_DELIMITER))
+		return false;
+	if (memchr(enc, 0, n - 1U) != NULL)
+		return false;
+
+	frame_decoder_reset(&dec);
+	if ((feed(&dec, enc, n, &last, &f) != 1U) || (last != FRAME_OK))
+		return false;
+
+	return (f.msg_id == msg_id) && (f.seq == seq) && (f.len == len) && ((len == 0U) || (memcmp(f.payload, payload, len) == 0));
+}
+
+/**
+  * @brief crc16 check value and round trips over every length and pattern
+  */
+static void run_round_trip_checks(void) {
+	static const char check_str[] = "123456789";
+	uint8_t payload[FRAME_PAYLOAD_MAX];
+	bool zeros = true, ones = true, runs = true, random = true, ids = true;
+
+	CHECK(crc16_ccitt((const uint8_t*) check_str, 9U) == 0x29B1U);		// CRC-16/CCITT-FALSE
+
+	for (uint16_t len = 0; len <= FRAME_PAYLOAD_MAX; ++len) {
+		memset(payload, 0, sizeof(payload));
+		zeros &= round_trip(0x10U, (uint8_t) len, payload, len);
+
+		memset(payload, 0xFF, sizeof(payload));
+		ones &= round_trip(0xFFU, 0xFFU, payload, len);
+
+		/* runs of zeros of every length between runs of data */
+		for (uint16_t i = 0; i < len; ++i)
+			payload[i] = ((i % (len / 4U + 2U)) < (len % 7U + 1U)) ? 0U : (uint8_t) (i + 1U);
+		runs &= round_trip(0x00U, 0x00U, payload, len);
+
+		for (uint16_t i = 0; i < len; ++i)
+			payload[i] = (uint8_t) rng();
+		random &= round_trip((uint8_t) rng(), (uint8_t) rng(), payload, len);
+	}
+
+	/* zero header and crc bytes, whatever the payload */
+	for (uint32_t id = 0; id < 256U; ++id)
+		ids &= round_trip((uint8_t) id, (uint8_t) (255U - id), payload, 1U);
+
+	CHECK(zeros);
+	CHECK(ones);
+	CHECK(runs);
+	CHECK(random);
+	CHECK(ids);
+}
+
+/**
+  * @brief the longest frame, oversize frames and the longest COBS block
+  */
+static void run_limit_checks(void) {
+	uint8_t payload[FRAME_PAYLOAD_MAX + 1U];
+	uint8_t enc[FRAME_ENCODED_MAX + 8U];
+	uint8_t block[300];
+	frame_decoder_t dec;
+	frame_status_t last = FRAME_INCOMPLETE;
+	frame_t f;
+	size_t n;
+
+	/* No zero anywhere: one COBS block of FRAME_RAW_MAX bytes */
+	memset(payload, 0x5AU, sizeof(payload));
+	n = frame_encode(enc, UINT32_MAX, 0U, 0x01U, 0x01U, payload, FRAME_PAYLOAD_MAX);
+	CHECK((n <= FRAME_ENCODED_MAX) && (n <= frame_encoded_size_max(FRAME_PAYLOAD_MAX)));
+	CHECK(round_trip(0x01U, 0x01U, payload, FRAME_PAYLOAD_MAX));
+
+	memset(enc, 0xEEU, sizeof(enc));
+	CHECK(frame_encode(enc, UINT32_MAX, 0U, 0x01U, 0x01U, payload, FRAME_PAYLOAD_MAX + 1U) == 0U);
+	CHECK(enc[0] == 0xEEU);		// refused without writing
+
+	/* A full 254-byte block (code 0xFF) is longer than any raw frame */
+	block[0] = 0xFFU;
+	memset(&block[1], 0x33U, 254U);
+	block[255] = FRAME_DELIMITER;
+	frame_decoder_reset(&dec);
+	CHECK((feed(&dec, block, 256U, &last, &f) == 0U) && (last == FRAME_ERROR_OVERFLOW));
+
+	/* 255 bytes of 0x01: every one a code byte, 254 zeros */
+	memset(block, 0x01U, 255U);
+	block[255] = FRAME_DELIMITER;
+	frame_decoder_reset(&dec);
+	CHECK((feed(&dec, block, 256U, &last, &f) == 0U) && (last == FRAME_ERROR_OVERFLOW));
+
+	/* ... and the decoder is clean for the next frame */
+	n = frame_encode(enc, UINT32_MAX, 0U, 0x02U, 0x03U, payload, 4U);
+	CHECK((feed(&dec, enc, n, &last, &f) == 1U) && (f.msg_id == 0x02U) && (f.len == 4U));
+
+	/* A block claiming more bytes than arrive before the delimiter */
+	block[0] = 0x10U;
+	block[1] = 0x01U;
+	block[2] = FRAME_DELIMITER;
+	frame_decoder_reset(&dec);
+	CHECK((feed(&dec, block, 3U, &last, &f) == 0U) && (last == FRAME_ERROR_OVERFLOW));
+}
+
+/**
+  * @brief encoding across the wrap of a ring
+  */
+static void run_ring_checks(void) {
+	uint8_t ring[RING_SIZE];
+	uint8_t lin[FRAME_ENCODED_MAX];
+	uint8_t payload[FRAME_PAYLOAD_MAX];
+	bool same = true, untouched = true;
+
+	for (uint32_t i = 0; i < FRAME_PAYLOAD_MAX; ++i)
+		payload[i] = (i % 5U) ? (uint8_t) rng() : 0U;
+
+	for (uint32_t pos = RING_SIZE - FRAME_ENCODED_MAX; pos < RING_SIZE; pos += 7U) {
+		size_t n, m;
+
+		memset(ring, 0xEEU, sizeof(ring));
+		n = frame_encode(ring, RING_SIZE - 1U, pos, 0x21U, (uint8_t) pos, payload, FRAME_PAYLOAD_MAX);
+		m = frame_encode(lin, UINT32_MAX, 0U, 0x21U, (uint8_t) pos, payload, FRAME_PAYLOAD_MAX);
+
+		same &= (n == m);
+		for (size_t i = 0; i < n; ++i)
+			same &= (ring[(pos + i) & (RING_SIZE - 1U)] == lin[i]);
+		for (size_t i = n; i < RING_SIZE; ++i)
+			untouched &= (ring[(pos + i) & (RING_SIZE - 1U)] == 0xEEU);
+	}
+
+	CHECK(same);
+	CHECK(untouched);
+}
+
+/**
+  * @brief truncated frames, bad crcs, short frames and idle delimiters
+  */
+static void run_error_checks(void) {
+	uint8_t payload[64];
+	uint8_t enc[FRAME_ENCODED_MAX];
+	uint8_t raw[FRAME_RAW_MAX];
+	uint8_t bad[FRAME_ENCODED_MAX];
+	frame_decoder_t dec;
+	frame_status_t last;
+	frame_t f;
+	size_t n, raw_len;
+	bool truncated = true, crc_rejected = true;
+	uint32_t ok;
+
+	for (uint32_t i = 0; i < sizeof(payload); ++i)
+		payload[i] = (i % 9U) ? (uint8_t) (i * 37U) : 0U;
+	n = frame_encode(enc, UINT32_MAX, 0U, 0x42U, 0x07U, payload, sizeof(payload));
+
+	/* Every cut: the bytes so far, then the delimiter */
+	for (size_t cut = 1U; cut < n - 1U; ++cut) {
+		frame_decoder_reset(&dec);
+		last = FRAME_INCOMPLETE;
+		ok = feed(&dec, enc, cut, &last, &f);
+		ok += feed(&dec, &enc[n - 1U], 1U, &last, &f);
+		truncated &= (ok == 0U) && (last != FRAME_OK);
+	}
+	CHECK(truncated);
+
+	/* Every single-bit error in the raw frame (re-encoded with COBS, so
+	 * the framing is intact and only the crc can catch it) */
+	raw[0] = 0x42U;
+	raw[1] = 0x07U;
+	memcpy(&raw[2], payload, sizeof(payload));
+	raw_len = 2U + sizeof(payload);
+	{
+		uint16_t crc = crc16_ccitt(raw, (uint16_t) raw_len);
+		raw[raw_len++] = (uint8_t) (crc & 0xFFU);
+		raw[raw_len++] = (uint8_t) (crc >> 8);
+	}
+
+	for (size_t bit = 0; bit < raw_len * 8U; ++bit) {
+		uint8_t flipped[FRAME_RAW_MAX];
+		uint8_t *p = bad;
+		uint8_t *code = p++;
+		uint8_t c = 1U;
+
+		memcpy(flipped, raw, raw_len);
+		flipped[bit / 8U] ^= (uint8_t) (1U << (bit % 8U));
+
+		/* reference COBS (raw is < 254 bytes, so no full block) */
+		for (size_t i = 0; i < raw_len; ++i) {
+			if (flipped[i] == 0U) {
+				*code = c;
+				code = p++;
+				c = 1U;
+			} else {
+				*p++ = flipped[i];
+				c++;
+			}
+		}
+		*code = c;
+		*p++ = FRAME_DELIMITER;
+
+		frame_decoder_reset(&dec);
+		last = FRAME_INCOMPLETE;
+		crc_rejected &= (feed(&dec, bad, (size_t) (p - bad), &last, &f) == 0U) && (last == FRAME_ERROR_CRC);
+	}
+	CHECK(crc_rejected);
+
+	/* The reference encoder agrees with frame_encode on the good frame */
+	{
+		frame_decoder_reset(&dec);
+		last = FRAME_INCOMPLETE;
+		CHECK((feed(&dec, enc, n, &last, &f) == 1U) && (f.len == sizeof(payload)));
+	}
+
+	/* Short frames: 1..3 raw bytes */
+	for (uint8_t len = 1U; len < FRAME_HEADER_SIZE + FRAME_CRC_SIZE; ++len) {
+		uint8_t s[6] = {(uint8_t) (len + 1U), 0x11U, 0x22U, 0x33U};
+
+		s[len + 1U] = FRAME_DELIMITER;
+		frame_decoder_reset(&dec);
+		last = FRAME_INCOMPLETE;
+		CHECK((feed(&dec, s, len + 2U, &last, &f) == 0U) && (last == FRAME_ERROR_SHORT));
+	}
+
+	/* Back-to-back delimiters are idle, not errors */
+	{
+		uint8_t idle[4] = {0};
+
+		frame_decoder_reset(&dec);
+		last = FRAME_INCOMPLETE;
+		CHECK((feed(&dec, idle, sizeof(idle), &last, &f) == 0U) && (last == FRAME_INCOMPLETE));
+	}
+}
+
+/**
+  * @brief resync: the first frame after the next delimiter decodes
+  */
+static void run_resync_checks(void) {
+	uint8_t stream[512 + FRAME_ENCODED_MAX * 2U];
+	uint8_t payload[32];
+	frame_decoder_t dec;
+	bool resynced = true, nothing_false = true;
+
+	for (uint32_t i = 0; i < sizeof(payload); ++i)
+		payload[i] = (uint8_t) (i * 7U);
+
+	for (uint32_t trial = 0; trial < 2000U; ++trial) {
+		size_t len = rng() % 512U;
+		size_t n = 0U;
+		frame_status_t last = FRAME_INCOMPLETE;
+		frame_t f;
+		uint32_t ok = 0U;
+
+		/* noise (with or without zeros), a delimiter, then the frame */
+		for (size_t i = 0; i < len; ++i)
+			stream[n++] = (trial & 1U) ? (uint8_t) (rng() | 1U) : (uint8_t) rng();
+		stream[n++] = FRAME_DELIMITER;
+		n += frame_encode(&stream[n], UINT32_MAX, 0U, 0x33U, (uint8_t) trial, payload, sizeof(payload));
+
+		frame_decoder_reset(&dec);
+		for (size_t i = 0; i < n; ++i) {
+			frame_status_t s = frame_decoder_push(&dec, stream[i], &f);
+
+			if (s == FRAME_OK) {
+				ok++;
+				nothing_false &= (i == n - 1U);		// noise never decodes (16-bit crc, 2000 trials)
+			}
+			if (s != FRAME_INCOMPLETE)
+				last = s;
+		}
+
+		resynced &= (ok >= 1U) && (last == FRAME_OK) && (f.seq == (uint8_t) trial) && (f.len == sizeof(payload)) &&
+					(memcmp(f.payload, payload, sizeof(payload)) == 0);
+	}
+
+	CHECK(resynced);
+	CHECK(nothing_false);
+}
+
+/**
+  * @brief random frames through a line that flips, drops and inserts bytes
+  */
+static void run_fuzz_checks(void) {
+	static uint8_t payloads[256][FRAME_PAYLOAD_MAX];
+	static uint16_t lengths[256];
+	uint8_t enc[FRAME_ENCODED_MAX];
+	uint8_t line[FRAME_ENCODED_MAX * 2U];
+	frame_decoder_t dec;
+	uint32_t clean = 0U, damaged = 0U, decoded = 0U, false_accepts = 0U, missed = 0U;
+	bool prev_delim_ok = true;
+
+	frame_decoder_reset(&dec);
+
+	for (uint32_t k = 0; k < FUZZ_FRAMES; ++k) {
+		uint8_t seq = (uint8_t) k;
+		uint16_t len = (uint16_t) (rng() % (FRAME_PAYLOAD_MAX + 1U));
+		size_t n, m = 0U;
+		bool hit = false, got = false;
+
+		lengths[seq] = len;
+		for (uint16_t i = 0; i < len; ++i)
+			payloads[seq][i] = (rng() & 3U) ? (uint8_t) rng() : 0U;
+		n = frame_encode(enc, UINT32_MAX, 0U, 0x55U, seq, payloads[seq], len);
+
+		for (size_t i = 0; i < n; ++i) {
+			uint32_t r = rng() % 1000000U;
+
+			if (r < FUZZ_ERROR_RATE / 3U) {
+				line[m++] = (uint8_t) (enc[i] ^ (uint8_t) (1U + rng() % 255U));		// flip
+				hit = true;
+			} else if (r < 2U * FUZZ_ERROR_RATE / 3U) {
+				hit = true;															// drop
+			} else if (r < FUZZ_ERROR_RATE) {
+				line[m++] = (uint8_t) rng();										// insert
+				line[m++] = enc[i];
+				hit = true;
+			} else {
+				line[m++] = enc[i];
+			}
+		}
+
+		for (size_t i = 0; i < m; ++i) {
+			frame_t f;
+
+			if (frame_decoder_push(&dec, line[i], &f) != FRAME_OK)
+				continue;
+
+			/* Anything decoded must be a frame that was sent, intact */
+			if ((f.msg_id == 0x55U) && (f.len == lengths[f.seq]) &&
+				((f.len == 0U) || (memcmp(f.payload, payloads[f.seq], f.len) == 0))) {
+				got |= (f.seq == seq);
+			} else {
+				false_accepts++;
+			}
+		}
+
+		damaged += hit ? 1U : 0U;
+		if (!hit && prev_delim_ok) {
+			clean++;
+			decoded += got ? 1U : 0U;
+			missed += got ? 0U : 1U;
+		}
+
+		/* the next frame starts clean only if this one's delimiter made it */
+		prev_delim_ok = (m > 0U) && (line[m - 1U] == FRAME_DELIMITER) && (n > 0U);
+	}
+
+	printf("{\"mode\": \"fuzz\", \"frames\": %u, \"damaged\": %u, \"clean\": %u, \"decoded\": %u, "
+		   "\"false_accepts\": %u, \"missed\": %u}\n", FUZZ_FRAMES, damaged, clean, decoded, false_accepts, missed);
+
+	/* A 16-bit crc lets about 1 in 65536 damaged frames through */
+	CHECK(false_accepts <= damaged / 16384U);
+	CHECK(missed == 0U);
+	CHECK(clean > FUZZ_FRAMES / 2U);
+}
+
+/**
+  * @brief encoder and decoder throughput on the longest frames
+  */
+static void run_throughput(void) {
+	static uint8_t stream[64U * FRAME_ENCODED_MAX];
+	uint8_t payload[FRAME_PAYLOAD_MAX];
+	frame_decoder_t dec;
+	frame_t f;
+	size_t total = 0U;
+	uint32_t ok = 0U;
+	double t0, enc_s, dec_s;
+
+	for (uint32_t i = 0; i < FRAME_PAYLOAD_MAX; ++i)
+		payload[i] = (uint8_t) rng();
+
+	t0 = now_s();
+	for (uint32_t k = 0; k < THROUGHPUT_FRAMES; ++k) {
+		size_t pos = (k & 63U) * FRAME_ENCODED_MAX;
+
+		total += frame_encode(&stream[pos], UINT32_MAX, 0U, 0x01U, (uint8_t) k, payload, FRAME_PAYLOAD_MAX);
+	}
+	enc_s = now_s() - t0;
+
+	frame_decoder_reset(&dec);
+	t0 = now_s();
+	for (uint32_t k = 0; k < THROUGHPUT_FRAMES / 64U; ++k) {
+		for (uint32_t j = 0; j < 64U; ++j) {
+			const uint8_t *p = &stream[j * FRAME_ENCODED_MAX];
+			size_t i = 0U;
+
+			do {
+				ok += (frame_decoder_push(&dec, p[i], &f) == FRAME_OK) ? 1U : 0U;
+			} while (p[i++] != FRAME_DELIMITER);
+		}
+	}
+	dec_s = now_s() - t0;
+
+	printf("{\"mode\": \"throughput\", \"encode_mb_per_s\": %.0f, \"decode_mb_per_s\": %.0f, "
+		   "\"encode_ns_per_frame\": %.0f, \"decode_ns_per_frame\": %.0f}\n",
+		   (double) total / enc_s * 1e-6, (double) total / dec_s * 1e-6,
+		   enc_s * 1e9 / THROUGHPUT_FRAMES, dec_s * 1e9 / THROUGHPUT_FRAMES);
+
+	CHECK(ok == (THROUGHPUT_FRAMES / 64U) * 64U);
+}
+
+int main(int argc, char **argv) {
+	if (argc > 1) {
+		fprintf(stderr, "usage: %s\n", argv[0]);
+		return 2;
+	}
+
+	run_round_trip_checks();
+	run_limit_checks();
+	run_ring_checks();
+	run_error_checks();
+	run_resync_checks();
+	run_fuzz_checks();
+	run_throughput();
+	printf("{\"mode\": \"checks\", \"checks\": %u, \"failed\": %u}\n", checks, failures);
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,769 @@
+/*
+ * gps_main.c (gps parser and position estimator host test)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sensors/gps/gps_parser.h"
+#include "flight/position.h"
+#include "sim_hw.h"
+#include "common/cycles.h"
+#include "common/settings.h"
+
+/*
+ * Runs sensors/gps/gps_parser.c and flight/position.c unmodified.
+ *
+ * First the parser is checked against canned NMEA sentences with known values
+ * and against UBX NAV-PVT frames encoded from known solutions: split at every
+ * byte boundary, fed byte by byte, through a wrapping ring, with corrupted
+ * checksums, garbage, oversized frames and overlong sentences in between:
+ *
+ *   {"mode": "checks", "checks": 58, "failed": 0}
+ *
+ * then its throughput is timed on long UBX and NMEA streams fed in loop-sized
+ * chunks (28 bytes: one 417 Hz loop at 115200 baud):
+ *
+ *   {"mode": "throughput", "protocol": "ubx", "ns_per_byte": 4.03, "mb_per_s": 248.4, ...}
+ *
+ * then a 60 s flight is flown (circuits with up to ~1.5 m/s^2, heading
+ * swinging by 60 deg) with a 20 mg accelerometer bias, a 0.3 deg/s gyro
+ * bias and sensor noise; the estimator starts 30 deg off in heading. GPS
+ * solutions are streamed through the parser at 10 Hz, arriving
+ * CONFIG_GPS_DELAY_MS after their epoch. Three variants are compared, with
+ * and without delay compensation, and gps alone (last solution held):
+ *
+ *   {"mode": "flight", "variant": "compensated", "pos_rms_m": 0.133, "vel_rms_mps": 0.044, ...}
+ *
+ * A one second gps outage in the middle checks that the estimate is dropped
+ * (and warned) after CONFIG_POS_GPS_TIMEOUT_MS and picked up again.
+ *
+ * -r FILE replays a raw receiver capture (the bytes of the uart, e.g. from a
+ * logic analyzer or a usb-serial adapter) and reports what it decoded.
+ *
+ * The exit status is 1 if any check fails.
+ */
+
+/**
+  * @brief  Simulation Setup
+  */
+#define LOOP_HZ					417.0
+#define FLIGHT_SECONDS			60.0
+#define GRAVITY					9.80665
+#define DEG						(M_PI / 180.0)
+
+#define ORIGIN_LAT_E7			473977420
+#define ORIGIN_LON_E7			85455940
+#define M_PER_DEG_E7			(6378137.0 * M_PI / 180.0 * 1e-7)
+
+#define ACCEL_NOISE_MG			5.0
+#define ACCEL_BIAS_MG			20.0	// x axis
+#define GYRO_NOISE_DPS			0.1
+#define GYRO_BIAS_DPS			0.3		// z axis
+#define ATT_NOISE_DEG			0.5		// attitude estimate error, 1 sigma
+#define GPS_POS_NOISE_M			0.3
+#define GPS_VEL_NOISE_MPS		0.05
+#define HEADING_OFFSET_DEG		30.0	// truth heading at start (estimator starts at 0)
+#define OUTAGE_START_S			40.0
+#define OUTAGE_LEN_S			1.0
+
+#define UART_BYTES_PER_S		((double) CONFIG_GPS_BAUD / 10.0)
+#define CHUNK_BYTES				28U		// bytes per loop at 115200 baud
+#define STREAM_SOLUTIONS		20000U
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+static unsigned checks;
+static unsigned failures;
+static uint32_t rng_state = 1U;
+
+
+static void check(bool cond, const char *what, int line) {
+	checks++;
+
+	if (!cond) {
+		failures++;
+		fprintf(stderr, "gps_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+/**
+  * @brief xorshift32 standard normal sample (Box-Muller)
+  */
+static double rand_normal(void) {
+	double u[2];
+
+	for (int i = 0; i < 2; ++i) {
+		rng_state ^= rng_state << 13;
+		rng_state ^= rng_state >> 17;
+		rng_state ^= rng_state << 5;
+		u[i] = ((double) (rng_state >> 8) + 1.0) / 16777216.0;
+	}
+
+	return sqrt(-2.0 * log(u[0])) * cos(6.283185307179586 * u[1]);
+}
+
+/**
+  * @brief xorshift32 byte
+  */
+static uint8_t rand_byte(void) {
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return (uint8_t) (rng_state >> 24);
+}
+
+/**
+  * @brief appends an nmea sentence ("$" body "*" checksum crlf)
+  *
+  * @retval new length
+  */
+static uint32_t nmea(uint8_t *buf, uint32_t len, const char *body) {
+	uint8_t ck = 0U;
+
+	for (const char *c = body; *c; ++c)
+		ck ^= (uint8_t) *c;
+
+	return len + (uint32_t) sprintf((char*) &buf[len], "$%s*%02X\r\n", body, ck);
+}
+
+/**
+  * @brief a solution with every field set (values as a receiver would report)
+  */
+static gps_data_t sample_solution(uint32_t i) {
+	return (gps_data_t) {
+		.lat_e7 = ORIGIN_LAT_E7 + (int32_t) (i * 37U), .lon_e7 = -ORIGIN_LON_E7 - (int32_t) (i * 11U),
+		.alt_msl_mm = 488123 - (int32_t) i, .vel_ned_mms = {1234 + (int32_t) i, -5678, 90},
+		.h_acc_mm = 1500U, .v_acc_mm = 2500U, .s_acc_mms = 150U, .time_ms = 345600000U + 100U * i,
+		.fix = GPS_FIX_3D, .num_sv = 14U, .vel_valid = true
+	};
+}
+
+static bool same_solution(const gps_data_t *a, const gps_data_t *b) {
+	return (a->lat_e7 == b->lat_e7) && (a->lon_e7 == b->lon_e7) && (a->alt_msl_mm == b->alt_msl_mm) &&
+		   !memcmp(a->vel_ned_mms, b->vel_ned_mms, sizeof(a->vel_ned_mms)) && (a->h_acc_mm == b->h_acc_mm) &&
+		   (a->v_acc_mm == b->v_acc_mm) && (a->s_acc_mms == b->s_acc_mms) && (a->time_ms == b->time_ms) &&
+		   (a->fix == b->fix) && (a->num_sv == b->num_sv) && (a->vel_valid == b->vel_valid);
+}
+
+/**
+  * @brief feeds a buffer in chunks of a given size
+  *
+  * @retval solutions
+  */
+static uint32_t feed_chunked(gps_parser_t *p, const uint8_t *buf, uint32_t len, uint32_t chunk, gps_data_t *out) {
+	uint32_t solutions = 0U;
+
+	for (uint32_t i = 0; i < len; i += chunk)
+		solutions += gps_parser_feed(p, &buf[i], (len - i < chunk) ? len - i : chunk, out);
+
+	return solutions;
+}
+
+/**
+  * @brief nmea checks (canned sentences, values worked out by hand)
+  */
+static void run_nmea_checks(void) {
+	uint8_t buf[512];
+	gps_parser_t p;
+	gps_data_t out = {0};
+	uint32_t len = 0U;
+
+	/* RMC then GGA of the same epoch: one solution with velocity */
+	len = nmea(buf, len, "GPRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W");
+	len = nmea(buf, len, "GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,");
+
+	gps_parser_init(&p);
+	CHECK(gps_parser_feed(&p, buf, len, &out) == 1U);
+	CHECK(out.fresh);
+	CHECK(out.lat_e7 == 481173000);				// 48 deg 7.038 min
+	CHECK(out.lon_e7 == 115166667);				// 11 deg 31 min
+	CHECK(out.alt_msl_mm == 545400);
+	CHECK(out.time_ms == ((12U * 60U + 35U) * 60U + 19U) * 1000U);
+	CHECK(out.fix == GPS_FIX_3D);
+	CHECK(out.num_sv == 8U);
+	CHECK(out.h_acc_mm == (uint32_t) lround(0.9 * CONFIG_GPS_NMEA_UERE_M * 1000.0));
+	CHECK(out.vel_valid);
+	CHECK(abs(out.vel_ned_mms[0] - (int32_t) lround(22.4 * 514.444 * cos(84.4 * DEG))) <= 2);
+	CHECK(abs(out.vel_ned_mms[1] - (int32_t) lround(22.4 * 514.444 * sin(84.4 * DEG))) <= 2);
+	CHECK((p.stats.messages == 2U) && (p.stats.checksum_errors == 0U) && (p.stats.framing_errors == 0U));
+
+	/* South / west, no RMC of this epoch, other sentences ignored */
+	len = nmea(buf, 0U, "GNGSA,A,3,01,02,03,04,05,06,,,,,,,1.8,0.9,1.5");
+	len = nmea(buf, len, "GNGGA,010203.5,3351.50000,S,15112.00000,W,2,12,0.6,-12.25,M,0.0,M,,");
+
+	gps_parser_init(&p);
+	memset(&out, 0, sizeof(out));
+	CHECK(gps_parser_feed(&p, buf, len, &out) == 1U);
+	CHECK(out.lat_e7 == -338583333);
+	CHECK(out.lon_e7 == -1512000000);
+	CHECK(out.alt_msl_mm == -12250);
+	CHECK(out.time_ms == 3723500U);
+	CHECK(out.fix == GPS_FIX_3D);
+	CHECK(!out.vel_valid);
+
+	/* No fix (quality 0), then dead reckoning (6): not a fix */
+	len = nmea(buf, 0U, "GPGGA,123520.00,,,,,0,00,99.9,,M,,M,,");
+	len = nmea(buf, len, "GPGGA,123521.00,4807.038,N,01131.000,E,6,05,1.2,545.4,M,46.9,M,,");
+	gps_parser_init(&p);
+	CHECK(gps_parser_feed(&p, buf, len, &out) == 2U);
+	CHECK(out.fix == GPS_FIX_NONE);
+
+	/* Corrupted checksum: dropped, counted, next sentence fine */
+	len = nmea(buf, 0U, "GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,");
+	buf[20] ^= 0x01U;
+	len = nmea(buf, len, "GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,");
+	gps_parser_init(&p);
+	CHECK(gps_parser_feed(&p, buf, len, &out) == 1U);
+	CHECK(p.stats.checksum_errors == 1U);
+	CHECK(out.lat_e7 == 481173000);
+
+	/* Overlong line (no terminator): framing error, resync on the next '$' */
+	memset(buf, 'A', 200U);
+	buf[0] = '$';
+	len = nmea(buf, 200U, "GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,");
+	gps_parser_init(&p);
+	CHECK(gps_parser_feed(&p, buf, len, &out) == 1U);
+	CHECK(p.stats.framing_errors == 1U);
+}
+
+/**
+  * @brief ubx checks (frames encoded from known solutions)
+  */
+static void run_ubx_checks(void) {
+	uint8_t stream[4096];
+	uint8_t ring[256];
+	gps_data_t sol[8];
+	gps_data_t out = {0};
+	gps_parser_t p;
+	uint32_t len = 0U;
+	uint32_t n;
+
+	/* Round trip */
+	sol[0] = sample_solution(0U);
+	len = sim_gps_nav_pvt(&sol[0], stream);
+	CHECK(len == UBX_NAV_PVT_LEN + UBX_FRAME_OVERHEAD);
+
+	gps_parser_init(&p);
+	CHECK(gps_parser_feed(&p, stream, len, &out) == 1U);
+	CHECK(same_solution(&out, &sol[0]));
+
+	/* Split at every byte boundary of a two frame stream */
+	sol[1] = sample_solution(1U);
+	len += sim_gps_nav_pvt(&sol[1], &stream[len]);
+	n = 0U;
+	for (uint32_t cut = 0; cut <= len; ++cut) {
+		gps_parser_init(&p);
+		memset(&out, 0, sizeof(out));
+		bool ok = (gps_parser_feed(&p, stream, cut, &out) + gps_parser_feed(&p, &stream[cut], len - cut, &out)) == 2U;
+		n += (ok && same_solution(&out, &sol[1])) ? 1U : 0U;
+	}
+	CHECK(n == len + 1U);
+
+	/* Mixed stream: other ubx messages, nmea, garbage (no sync or '$' bytes) in between */
+	len = 0U;
+	for (uint32_t i = 0; i < 8U; ++i) {
+		const uint8_t ack[2] = {UBX_CLASS_CFG, UBX_ID_CFG_RATE};
+
+		sol[i] = sample_solution(i + 2U);
+		len += ubx_frame(UBX_CLASS_ACK, 0x01U, ack, sizeof(ack), &stream[len]);
+		len += sim_gps_nav_pvt(&sol[i], &stream[len]);
+		len = nmea(stream, len, "GPTXT,01,01,02,ANTSTATUS=OK");
+		for (uint32_t k = 0; k < 17U; ++k) {
+			uint8_t b = rand_byte();
+			stream[len++] = ((b == UBX_SYNC1) || (b == '$')) ? 0x00U : b;
+		}
+	}
+
+	gps_data_t whole = {0}, bytewise = {0}, chunked = {0};
+	gps_parser_t pb, pc;
+
+	gps_parser_init(&p);
+	gps_parser_init(&pb);
+	gps_parser_init(&pc);
+	CHECK(gps_parser_feed(&p, stream, len, &whole) == 8U);
+	CHECK(feed_chunked(&pb, stream, len, 1U, &bytewise) == 8U);
+	CHECK(feed_chunked(&pc, stream, len, CHUNK_BYTES, &chunked) == 8U);
+	CHECK(same_solution(&whole, &sol[7]) && same_solution(&bytewise, &sol[7]) && same_solution(&chunked, &sol[7]));
+	CHECK(p.stats.messages == 24U);
+	CHECK(!memcmp(&p.stats, &pb.stats, sizeof(p.stats)) && !memcmp(&p.stats, &pc.stats, sizeof(p.stats)));
+	CHECK(p.stats.checksum_errors == 0U);
+
+	/* Circular buffer: the writer wraps many times, reads in loop-sized steps */
+	uint32_t head = 0U, tail = 0U, solutions = 0U;
+	gps_parser_init(&p);
+	for (uint32_t i = 0; i < len; ) {
+		uint32_t step = (len - i < 23U) ? len - i : 23U;
+
+		for (uint32_t k = 0; k < step; ++k, ++i) {
+			ring[head] = stream[i];
+			head = (head + 1U) % sizeof(ring);
+		}
+		solutions += gps_parser_feed_ring(&p, ring, sizeof(ring), &tail, head, &out);
+	}
+	CHECK(solutions == 8U);
+	CHECK(tail == head);
+	CHECK(same_solution(&out, &sol[7]));
+
+	/* Corrupted payload: dropped and counted, the next frame decodes */
+	len = sim_gps_nav_pvt(&sol[0], stream);
+	stream[30] ^= 0x40U;
+	len += sim_gps_nav_pvt(&sol[1], &stream[len]);
+	gps_parser_init(&p);
+	memset(&out, 0, sizeof(out));
+	CHECK(gps_parser_feed(&p, stream, len, &out) == 1U);
+	CHECK(p.stats.checksum_errors == 1U);
+	CHECK(same_solution(&out, &sol[1]));
+
+	/* Oversized length field: framing error, the next frame decodes */
+	const uint8_t bad[6] = {UBX_SYNC1, UBX_SYNC2, UBX_CLASS_NAV, UBX_ID_NAV_PVT, 0xFFU, 0xFFU};
+	memcpy(stream, bad, sizeof(bad));
+	len = sizeof(bad) + sim_gps_nav_pvt(&sol[2], &stream[sizeof(bad)]);
+	gps_parser_init(&p);
+	CHECK(gps_parser_feed(&p, stream, len, &out) == 1U);
+	CHECK(p.stats.framing_errors == 1U);
+	CHECK(same_solution(&out, &sol[2]));
+
+	/* Truncated frame followed by a full one: resync on the next sync */
+	len = sim_gps_nav_pvt(&sol[3], stream) - 40U;
+	len = nmea(stream, len, "GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,");
+	len += sim_gps_nav_pvt(&sol[4], &stream[len]);
+	gps_parser_init(&p);
+	n = gps_parser_feed(&p, stream, len, &out);
+	CHECK(n >= 1U);
+	CHECK(same_solution(&out, &sol[4]));
+
+	/* Fix only with gnssFixOK; 2D reported as such */
+	sol[5] = sample_solution(5U);
+	sol[5].fix = GPS_FIX_2D;
+	len = sim_gps_nav_pvt(&sol[5], stream);
+	gps_parser_init(&p);
+	CHECK(gps_parser_feed(&p, stream, len, &out) == 1U);
+	CHECK(out.fix == GPS_FIX_2D);
+
+	stream[UBX_FRAME_OVERHEAD - 2U + 21U] = 0x00U;		// flags: gnssFixOK clear
+	len = ubx_frame(UBX_CLASS_NAV, UBX_ID_NAV_PVT, &stream[6], UBX_NAV_PVT_LEN, &stream[256]);
+	CHECK(gps_parser_feed(&p, &stream[256], len, &out) == 1U);
+	CHECK(out.fix == GPS_FIX_NONE);
+}
+
+/**
+  * @brief estimator checks that need no flight (gating, origin, frames)
+  */
+static void run_estimator_checks(void) {
+	position_est_t est;
+	imu_6D_t imu = {.accel_z = 1000.0f, .dt = (uint32_t) lround(1.0e6 / LOOP_HZ)};
+	attitude_est_t att = {0};
+	gps_data_t gps = sample_solution(0U);
+	float ne[2];
+
+	position_estimator_init(&est, 0U);
+
+	/* Too few satellites, 2D, too inaccurate: not used */
+	gps.fresh = true;
+	gps.num_sv = CONFIG_POS_GPS_MIN_SATS - 1U;
+	(void) position_estimator_update(&imu, &att, &gps, &est);
+	gps.num_sv = CONFIG_POS_GPS_MIN_SATS;
+	gps.fix = GPS_FIX_2D;
+	(void) position_estimator_update(&imu, &att, &gps, &est);
+	gps.fix = GPS_FIX_3D;
+	gps.h_acc_mm = (uint32_t) (CONFIG_POS_GPS_MAX_HACC_M * 1000.0f) + 1U;
+	(void) position_estimator_update(&imu, &att, &gps, &est);
+	CHECK(!est.valid);
+
+	/* First fix is the origin */
+	gps.h_acc_mm = 1000U;
+	(void) position_estimator_update(&imu, &att, &gps, &est);
+	CHECK(est.valid);
+	CHECK((fabsf(est.pos_m[0]) < 0.05f) && (fabsf(est.pos_m[1]) < 0.05f));
+
+	/* 100 m north, 100 m east */
+	position_gps_to_ne(&est, gps.lat_e7 + (int32_t) lround(100.0 / M_PER_DEG_E7),
+					   gps.lon_e7 + (int32_t) lround(100.0 / (M_PER_DEG_E7 * cos((double) gps.lat_e7 * 1e-7 * DEG))), ne);
+	CHECK((fabsf(ne[0] - 100.0f) < 0.02f) && (fabsf(ne[1] - 100.0f) < 0.02f));
+
+	/* Across the antimeridian */
+	est.origin_lon_e7 = 1799999990;
+	position_gps_to_ne(&est, est.origin_lat_e7, -1799999990, ne);
+	CHECK((ne[1] > 0.0f) && (ne[1] < 2.0f));
+}
+
+/**
+  * @brief parser throughput on a long stream fed in loop-sized chunks
+  */
+static void run_throughput(const char *protocol, bool ubx) {
+	uint32_t cap = STREAM_SOLUTIONS * 160U;
+	uint8_t *stream = malloc(cap);
+	uint32_t len = 0U;
+	gps_parser_t p;
+	gps_data_t out;
+	char body[128];
+
+	for (uint32_t i = 0; i < STREAM_SOLUTIONS; ++i) {
+		gps_data_t s = sample_solution(i);
+		uint32_t t = 3600U * 10U + i;		// 0.1 s of the day
+
+		if (ubx) {
+			len += sim_gps_nav_pvt(&s, &stream[len]);
+		} else {
+			snprintf(body, sizeof(body), "GPRMC,%02u%02u%02u.%u0,A,4723.86452,N,00832.73564,E,%u.%03u,084.40,230394,,,A",
+					 t / 36000U, (t / 600U) % 60U, (t / 10U) % 60U, t % 10U, 5U + i % 3U, i % 1000U);
+			len = nmea(stream, len, body);
+			snprintf(body, sizeof(body), "GPGGA,%02u%02u%02u.%u0,4723.86452,N,00832.73564,E,1,12,0.8,%u.%02u,M,47.5,M,,",
+					 t / 36000U, (t / 600U) % 60U, (t / 10U) % 60U, t % 10U, 480U + i % 20U, i % 100U);
+			len = nmea(stream, len, body);
+		}
+	}
+
+	gps_parser_init(&p);
+	uint32_t start = cycles_now();
+	uint32_t solutions = feed_chunked(&p, stream, len, CHUNK_BYTES, &out);
+	double ns = (double) (uint32_t) (cycles_now() - start);
+	double ns_per_byte = ns / (double) len;
+
+	CHECK(solutions == STREAM_SOLUTIONS);
+	CHECK((p.stats.checksum_errors == 0U) && (p.stats.framing_errors == 0U));
+
+	printf("{\"mode\": \"throughput\", \"protocol\": \"%s\", \"bytes\": %u, \"solutions\": %u, \"bytes_per_solution\": %.1f, "
+		   "\"ns_per_byte\": %.2f, \"mb_per_s\": %.1f, \"ns_per_loop_at_baud\": %.1f}\n",
+		   protocol, len, solutions, (double) len / solutions, ns_per_byte, 1.0e3 / ns_per_byte,
+		   ns_per_byte * UART_BYTES_PER_S / LOOP_HZ);
+
+	free(stream);
+}
+
+/**
+  * @brief flight profile truth at time t: north/east position, velocity,
+  * 	   acceleration (m, m/s, m/s^2) and heading (deg, clockwise from north)
+  * 	   (at rest for 5 s, then circuits; the heading swings by 60 deg)
+  */
+static void profile(double t, double pos[2], double vel[2], double acc[2], double *heading) {
+	const double w[2] = {0.4, 0.25};
+	const double a[2] = {8.0, 12.0};
+
+	*heading = HEADING_OFFSET_DEG;
+
+	for (int i = 0; i < 2; ++i) {
+		pos[i] = vel[i] = acc[i] = 0.0;
+		if (t < 5.0)
+			continue;
+
+		double u = w[i] * (t - 5.0);
+		pos[i] = a[i] * (1.0 - cos(u));
+		vel[i] = a[i] * w[i] * sin(u);
+		acc[i] = a[i] * w[i] * w[i] * cos(u);
+	}
+
+	if (t >= 5.0)
+		*heading += 60.0 * sin(0.15 * (t - 5.0));
+}
+
+/**
+  * @brief converts a north / east position to latitude / longitude
+  */
+static void ne_to_gps(const double ne[2], int32_t *lat_e7, int32_t *lon_e7) {
+	*lat_e7 = ORIGIN_LAT_E7 + (int32_t) lround(ne[0] / M_PER_DEG_E7);
+	*lon_e7 = ORIGIN_LON_E7 + (int32_t) lround(ne[1] / (M_PER_DEG_E7 * cos(ORIGIN_LAT_E7 * 1e-7 * DEG)));
+}
+
+/**
+  * @brief  GPS Frames on the Wire (a solution is sent while the next epoch is taken)
+  */
+#define WIRE_FRAMES				4U
+
+typedef struct {
+	uint8_t frame[UBX_NAV_PVT_LEN + UBX_FRAME_OVERHEAD];
+	uint32_t len;
+	uint32_t sent;
+	double start_s;
+} wire_frame_t;
+
+typedef enum {
+	VARIANT_COMPENSATED,
+	VARIANT_UNCOMPENSATED,
+	VARIANT_GPS_ONLY
+} variant_t;
+
+typedef struct {
+	double sq_pos;
+	double sq_vel;
+	double max_pos;
+	double sq_heading;
+	uint32_t n;
+	uint32_t heading_n;
+	double aligned_s;
+	uint32_t warnings;
+	bool lost_in_outage;		// invalid during the outage..
+	bool valid_after;			// ..and valid again after it
+	double est_ns;
+} flight_metrics_t;
+
+/**
+  * @brief flies the profile: imu from truth, gps streamed through the parser
+  * 	   (last byte CONFIG_GPS_DELAY_MS after the epoch), then the estimator
+  */
+static void fly(variant_t variant, flight_metrics_t *m) {
+	static position_est_t est;
+	gps_parser_t parser;
+	gps_data_t gps = {0};
+	gps_data_t held = {0};
+	wire_frame_t wire[WIRE_FRAMES];
+	uint32_t wire_head = 0U, wire_count = 0U;
+	double next_epoch = 0.0;
+	double prev_roll = 0.0, prev_pitch = 0.0, prev_heading = HEADING_OFFSET_DEG;
+	uint64_t cycles = 0U;
+	uint32_t loops = (uint32_t) (FLIGHT_SECONDS * LOOP_HZ);
+	const double dt = 1.0 / LOOP_HZ;
+
+	memset(m, 0, sizeof(*m));
+	rng_state = 1U;
+	gps_parser_init(&parser);
+	position_estimator_init(&est, (variant == VARIANT_UNCOMPENSATED) ? 0U : CONFIG_GPS_DELAY_MS * 1000U);
+
+	for (uint32_t k = 0; k < loops; ++k) {
+		double t = k * dt;
+		double pos[2], vel[2], acc[2], heading;
+		imu_6D_t imu = {0};
+		attitude_est_t att = {0};
+
+		profile(t, pos, vel, acc, &heading);
+
+		/* Tilt that produces the acceleration (positive pitch nose down, roll right down) */
+		double h = heading * DEG;
+		double fwd = acc[0] * cos(h) + acc[1] * sin(h);
+		double left = acc[0] * sin(h) - acc[1] * cos(h);
+		double pitch = atan2(fwd, GRAVITY);
+		double roll = atan2(-left, GRAVITY);
+
+		/* Specific force: level frame (fwd, left, g) to body */
+		double sr = sin(roll), cr = cos(roll), sp = sin(pitch), cp = cos(pitch);
+		double bx = cp * fwd - sp * GRAVITY;
+		double by = left;
+		double bz = sp * fwd + cp * GRAVITY;
+		imu.accel_x = (float) (bx / GRAVITY * 1000.0 + ACCEL_BIAS_MG + ACCEL_NOISE_MG * rand_normal());
+		imu.accel_y = (float) ((cr * by + sr * bz) / GRAVITY * 1000.0 + ACCEL_NOISE_MG * rand_normal());
+		imu.accel_z = (float) ((-sr * by + cr * bz) / GRAVITY * 1000.0 + ACCEL_NOISE_MG * rand_normal());
+
+		/* Body rates from the euler rates (yaw counter-clockwise: minus heading) */
+		double droll = (roll - prev_roll) / dt;
+		double dpitch = (pitch - prev_pitch) / dt;
+		double dyaw = -(heading - prev_heading) * DEG / dt;
+		imu.rate_x = (float) (((droll - dyaw * sp) / DEG + GYRO_NOISE_DPS * rand_normal()) * 1000.0);
+		imu.rate_y = (float) (((dpitch * cr + dyaw * sr * cp) / DEG + GYRO_NOISE_DPS * rand_normal()) * 1000.0);
+		imu.rate_z = (float) (((-dpitch * sr + dyaw * cr * cp) / DEG + GYRO_BIAS_DPS + GYRO_NOISE_DPS * rand_normal()) * 1000.0);
+		imu.dt = (uint32_t) lround(dt * 1.0e6);
+		prev_roll = roll;
+		prev_pitch = pitch;
+		prev_heading = heading;
+
+		att.roll_angle_deg = (float) (roll / DEG + ATT_NOISE_DEG * rand_normal());
+		att.pitch_angle_deg = (float) (pitch / DEG + ATT_NOISE_DEG * rand_normal());
+
+		/* GPS epoch: encode, then stream it so its last byte lands CONFIG_GPS_DELAY_MS later */
+		bool outage = (t >= OUTAGE_START_S) && (t < OUTAGE_START_S + OUTAGE_LEN_S);
+		if (t >= next_epoch) {
+			next_epoch += 1.0 / CONFIG_GPS_RATE_HZ;
+
+			if (!outage && (wire_count < WIRE_FRAMES)) {
+				wire_frame_t *f = &wire[(wire_head + wire_count++) % WIRE_FRAMES];
+				double noisy[2] = {pos[0] + GPS_POS_NOISE_M * rand_normal(), pos[1] + GPS_POS_NOISE_M * rand_normal()};
+				gps_data_t sol = {.h_acc_mm = 900U, .v_acc_mm = 1500U, .s_acc_mms = 150U, .fix = GPS_FIX_3D, .num_sv = 12U};
+
+				ne_to_gps(noisy, &sol.lat_e7, &sol.lon_e7);
+				sol.vel_ned_mms[0] = (int32_t) lround((vel[0] + GPS_VEL_NOISE_MPS * rand_normal()) * 1000.0);
+				sol.vel_ned_mms[1] = (int32_t) lround((vel[1] + GPS_VEL_NOISE_MPS * rand_normal()) * 1000.0);
+				sol.time_ms = (uint32_t) lround(t * 1000.0);
+
+				f->len = sim_gps_nav_pvt(&sol, f->frame);
+				f->sent = 0U;
+				f->start_s = t + CONFIG_GPS_DELAY_MS * 1.0e-3 - f->len / UART_BYTES_PER_S;
+			}
+		}
+
+		gps.fresh = false;
+		while (wire_count > 0U) {
+			wire_frame_t *f = &wire[wire_head];
+			double due = (t - f->start_s) * UART_BYTES_PER_S;
+			uint32_t n = (due <= 0.0) ? 0U : (uint32_t) fmin(due, (double) f->len);
+
+			if (n > f->sent) {
+				(void) gps_parser_feed(&parser, &f->frame[f->sent], n - f->sent, &gps);
+				f->sent = n;
+			}
+
+			if (f->sent < f->len)
+				break;
+
+			wire_head = (wire_head + 1U) % WIRE_FRAMES;
+			wire_count--;
+		}
+
+		uint32_t start = cycles_now();
+		if (position_estimator_update(&imu, &att, &gps, &est) != POSITION_OK)
+			m->warnings++;
+		cycles += (uint32_t) (cycles_now() - start);
+
+		if (outage && !est.valid)
+			m->lost_in_outage = true;
+		if ((t > OUTAGE_START_S + OUTAGE_LEN_S + 0.5) && est.valid)
+			m->valid_after = true;
+		if (est.heading_aligned && (m->aligned_s == 0.0))
+			m->aligned_s = t;
+
+		if (gps.fresh)
+			held = gps;
+
+		/* Errors count once the estimate has settled, outside the outage */
+		if (!est.valid || (t < 15.0) || ((t >= OUTAGE_START_S) && (t < OUTAGE_START_S + 3.0)))
+			continue;
+
+		int32_t lat_e7, lon_e7;
+		float truth[2], ep[2], ev[2];
+
+		ne_to_gps(pos, &lat_e7, &lon_e7);
+		position_gps_to_ne(&est, lat_e7, lon_e7, truth);
+
+		if (variant == VARIANT_GPS_ONLY) {
+			float ne[2];
+			position_gps_to_ne(&est, held.lat_e7, held.lon_e7, ne);
+			for (int i = 0; i < 2; ++i) {
+				ep[i] = ne[i] - truth[i];
+				ev[i] = (float) (held.vel_ned_mms[i] * 1.0e-3 - vel[i]);
+			}
+		} else {
+			for (int i = 0; i < 2; ++i) {
+				ep[i] = est.pos_m[i] - truth[i];
+				ev[i] = (float) (est.vel_mps[i] - vel[i]);
+			}
+		}
+
+		double e2 = (double) ep[0] * ep[0] + (double) ep[1] * ep[1];
+		m->sq_pos += e2;
+		m->sq_vel += (double) ev[0] * ev[0] + (double) ev[1] * ev[1];
+		m->max_pos = fmax(m->max_pos, sqrt(e2));
+		m->n++;
+
+		double eh = remainder((double) est.heading_deg - heading, 360.0);
+		m->sq_heading += eh * eh;
+		m->heading_n++;
+	}
+
+	m->est_ns = (double) cycles / (double) loops;
+}
+
+/**
+  * @brief flight profile run (three variants)
+  */
+static void run_flight(void) {
+	static const char *const names[] = {"compensated", "uncompensated", "gps_only"};
+	flight_metrics_t m[3];
+
+	for (int v = 0; v < 3; ++v) {
+		fly((variant_t) v, &m[v]);
+
+		printf("{\"mode\": \"flight\", \"variant\": \"%s\", \"seconds\": %.1f, \"gps_hz\": %u, \"gps_delay_ms\": %u, "
+			   "\"tau_s\": %.1f, \"pos_rms_m\": %.3f, \"pos_err_max_m\": %.3f, \"vel_rms_mps\": %.3f, "
+			   "\"heading_rms_deg\": %.2f, \"aligned_after_s\": %.2f, \"warnings\": %u, \"estimator_ns\": %.1f}\n",
+			   names[v], FLIGHT_SECONDS, CONFIG_GPS_RATE_HZ, CONFIG_GPS_DELAY_MS, (double) CONFIG_POS_FILT_TAU_S,
+			   sqrt(m[v].sq_pos / m[v].n), m[v].max_pos, sqrt(m[v].sq_vel / m[v].n),
+			   sqrt(m[v].sq_heading / m[v].heading_n), m[v].aligned_s, m[v].warnings, m[v].est_ns);
+	}
+
+	flight_metrics_t *comp = &m[VARIANT_COMPENSATED];
+
+	/* Compensation beats none, the fused estimate beats gps alone */
+	CHECK(comp->sq_pos < m[VARIANT_UNCOMPENSATED].sq_pos);
+	CHECK(comp->sq_vel < m[VARIANT_UNCOMPENSATED].sq_vel);
+	CHECK(comp->sq_pos < m[VARIANT_GPS_ONLY].sq_pos);
+	CHECK(comp->sq_vel < m[VARIANT_GPS_ONLY].sq_vel);
+
+	/* Heading found from gps within ~2 s of moving, then held against the gyro bias */
+	CHECK((comp->aligned_s > 5.0) && (comp->aligned_s < 7.5));
+	CHECK(sqrt(comp->sq_heading / comp->heading_n) < 6.0);
+
+	/* Outage: dropped and warned once, then picked up again */
+	CHECK(comp->lost_in_outage);
+	CHECK(comp->valid_after);
+	CHECK(comp->warnings == 1U);
+}
+
+/**
+  * @brief raw receiver capture replay
+  *
+  * @retval false if the file cannot be read
+  */
+static bool run_capture(const char *path) {
+	FILE *fp = fopen(path, "rb");
+	uint8_t buf[CHUNK_BYTES];
+	gps_parser_t p;
+	gps_data_t out = {0}, first = {0};
+	uint32_t fixes = 0U, with_vel = 0U;
+	size_t n;
+
+	if (!fp) {
+		fprintf(stderr, "cannot open %s\n", path);
+		return false;
+	}
+
+	gps_parser_init(&p);
+	while ((n = fread(buf, 1U, sizeof(buf), fp)) > 0U) {
+		if (!gps_parser_feed(&p, buf, (uint32_t) n, &out))
+			continue;
+
+		if (first.fix == GPS_FIX_NONE)
+			first = out;
+		fixes += (out.fix == GPS_FIX_3D) ? 1U : 0U;
+		with_vel += out.vel_valid ? 1U : 0U;
+	}
+	fclose(fp);
+
+	printf("{\"mode\": \"capture\", \"file\": \"%s\", \"bytes\": %u, \"messages\": %u, \"solutions\": %u, "
+		   "\"fixes_3d\": %u, \"with_velocity\": %u, \"checksum_errors\": %u, \"framing_errors\": %u, "
+		   "\"first\": [%.7f, %.7f], \"last\": [%.7f, %.7f], \"last_num_sv\": %u}\n",
+		   path, p.stats.bytes, p.stats.messages, p.stats.solutions, fixes, with_vel,
+		   p.stats.checksum_errors, p.stats.framing_errors,
+		   first.lat_e7 * 1e-7, first.lon_e7 * 1e-7, out.lat_e7 * 1e-7, out.lon_e7 * 1e-7, out.num_sv);
+
+	return true;
+}
+
+static void usage(const char *argv0) {
+	fprintf(stderr, "usage: %s [-r capture.bin]\n"
+					"  capture: raw receiver bytes (ubx and/or nmea)\n", argv0);
+}
+
+int main(int argc, char **argv) {
+	const char *capture = NULL;
+
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "-r") && (i + 1 < argc))
+			capture = argv[++i];
+		else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+
+	cycles_init();
+
+	run_nmea_checks();
+	run_ubx_checks();
+	run_estimator_checks();
+	printf("{\"mode\": \"checks\", \"checks\": %u, \"failed\": %u}\n", checks, failures);
+
+	run_throughput("ubx", true);
+	run_throughput("nmea", false);
+	run_flight();
+
+	if (capture && !run_capture(capture))
+		return 2;
+
+	if (failures)
+		fprintf(stderr, "%u of %u checks failed\n", failures, checks);
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,186 @@
+/*
+ * hal_mock.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "common/time.h"
+#include "common/hardware.h"
+#include "hal_mock.h"
+
+/*
+ * HAL handles of common/hardware.h, the timer calls and clock queries of
+ * the protocol drivers and the i2c transfers of the device drivers, for
+ * tools built against shim/hal. The handles come up as main.c configures
+ * them (TIM4 / TIM8 at 50 Hz from a 3 MHz reference), with nothing on the
+ * i2c bus.
+ */
+
+TIM_TypeDef hal_mock_tim4;
+TIM_TypeDef hal_mock_tim8;
+
+TIM_HandleTypeDef htim2;
+TIM_HandleTypeDef htim3;
+TIM_HandleTypeDef htim4;
+TIM_HandleTypeDef htim8;
+
+I2C_HandleTypeDef hi2c1;
+
+static hal_mock_tim_t tim4_state;
+static hal_mock_tim_t tim8_state;
+static hal_mock_i2c_dev_t i2c_devs[HAL_MOCK_I2C_DEVICES];
+
+
+/**
+  * @brief resets the timers to their configured state (registers cleared,
+  * 	   nothing started) and detaches the i2c devices
+  *
+  * @retval None
+  */
+void hal_mock_reset(void) {
+	memset(&hal_mock_tim4, 0, sizeof(hal_mock_tim4));
+	memset(&hal_mock_tim8, 0, sizeof(hal_mock_tim8));
+
+	htim4 = (TIM_HandleTypeDef){.Instance = TIM4, .Init = {.Prescaler = 27U, .Period = HAL_MOCK_TIM_PERIOD}};
+	htim8 = (TIM_HandleTypeDef){.Instance = TIM8, .Init = {.Prescaler = 27U, .Period = HAL_MOCK_TIM_PERIOD}};
+
+	tim4_state = (hal_mock_tim_t){.clock_hz = HAL_MOCK_TIM_CLOCK_HZ, .start_status = HAL_OK};
+	tim8_state = (hal_mock_tim_t){.clock_hz = HAL_MOCK_TIM_CLOCK_HZ, .start_status = HAL_OK};
+
+	memset(i2c_devs, 0, sizeof(i2c_devs));
+}
+
+/**
+  * @brief gets the mock state of a timer instance
+  *
+  * @param  tim		timer instance
+  * @retval pointer to mock state (NULL if not mocked)
+  */
+hal_mock_tim_t* hal_mock_tim(const TIM_TypeDef *tim) {
+	if (tim == TIM4)
+		return &tim4_state;
+
+	if (tim == TIM8)
+		return &tim8_state;
+
+	return NULL;
+}
+
+/**
+  * @brief attaches a device (registers cleared) to hi2c1
+  *
+  * @param  address		8-bit bus address (not 0)
+  * @retval pointer to device (NULL if the address is taken or no slot is free)
+  */
+hal_mock_i2c_dev_t* hal_mock_i2c_attach(uint16_t address) {
+	hal_mock_i2c_dev_t *free_dev = NULL;
+
+	if (address == 0U)
+		return NULL;
+
+	for (uint32_t i = 0; i < HAL_MOCK_I2C_DEVICES; ++i) {
+		if (i2c_devs[i].address == address)
+			return NULL;
+
+		if (!free_dev && (i2c_devs[i].address == 0U))
+			free_dev = &i2c_devs[i];
+	}
+
+	if (free_dev) {
+		memset(free_dev, 0, sizeof(*free_dev));
+		free_dev->address = address;
+	}
+
+	return free_dev;
+}
+
+/**
+  * @brief helper function to get the device a transfer addresses
+  *
+  * @retval pointer to device (NULL: no acknowledge)
+  */
+static hal_mock_i2c_dev_t* i2c_target(const I2C_HandleTypeDef *hi2c, uint16_t address) {
+	if ((hi2c != &hi2c1) || (address == 0U))
+		return NULL;
+
+	for (uint32_t i = 0; i < HAL_MOCK_I2C_DEVICES; ++i) {
+		if (i2c_devs[i].address == address)
+			return &i2c_devs[i];
+	}
+
+	return NULL;
+}
+
+uint32_t Get_TIMxClkRefFreqHz(const TIM_HandleTypeDef *htim) {
+	const hal_mock_tim_t *state = htim ? hal_mock_tim(htim->Instance) : NULL;
+
+	return state ? state->clock_hz : 0U;
+}
+
+uint32_t Get_TIMxClkRefFreqMHz(const TIM_HandleTypeDef *htim) {
+	uint32_t hz = Get_TIMxClkRefFreqHz(htim);
+
+	return (hz % 1000000U == 0U) ? hz / 1000000U : 0U;		// as common/time.c
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel) {
+	hal_mock_tim_t *state = hal_mock_tim(htim->Instance);
+
+	if (!state)
+		return HAL_ERROR;
+
+	if (state->start_status == HAL_OK)
+		state->running |= 1U << (Channel / 4U);
+
+	return state->start_status;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef *htim, uint32_t Channel) {
+	hal_mock_tim_t *state = hal_mock_tim(htim->Instance);
+
+	if (!state)
+		return HAL_ERROR;
+
+	state->running &= ~(1U << (Channel / 4U));
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+									uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+	hal_mock_i2c_dev_t *dev = i2c_target(hi2c, DevAddress);
+	(void) MemAddSize; (void) Timeout;
+
+	if (!dev)
+		return HAL_ERROR;
+
+	for (uint16_t i = 0; i < Size; ++i) {
+		uint8_t reg = (uint8_t) (MemAddress + i);
+
+		dev->regs[reg] = pData[i] & (uint8_t) ~dev->self_clearing[reg];
+	}
+	dev->writes++;
+
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+								   uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+	hal_mock_i2c_dev_t *dev = i2c_target(hi2c, DevAddress);
+	(void) MemAddSize; (void) Timeout;
+
+	if (!dev)
+		return HAL_ERROR;
+
+	for (uint16_t i = 0; i < Size; ++i)
+		pData[i] = dev->regs[(uint8_t) (MemAddress + i)];
+	dev->reads++;
+
+	return HAL_OK;
+}
+
+void HAL_Delay(uint32_t Delay) {
+	(void) Delay;
+}
@@ -0,0 +1,310 @@
+/*
+ * health_main.c (health event ring host stress test)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "system/health.h"
+#include "comms/frame.h"
+#include "usbd_cdc_if.h"
+
+/*
+ * Runs system/health.c unmodified: health_record is the multi-producer side
+ * of the event ring (ISRs and the main loop on the target), health_service
+ * drains it and health_read_events reads the history behind it.
+ *
+ * First one thread fills the ring: it holds exactly its size, the next
+ * records are dropped and counted, and draining gives the kept events back
+ * in order, and only then is each module's last code and time set, both from
+ * the last event kept. Then producer threads record as fast as they can while a
+ * consumer thread drains, one line:
+ *
+ *   {"mode": "stress", "producers": 4, "events": 800000, "recorded": 769701,
+ *    "dropped": 30299, "received": 769701, "lost": 0, "duplicated": 0,
+ *    "out_of_order": 0, "records_per_s": 1.9e+07}
+ *
+ * Every producer numbers the events it got recorded (the code carries the
+ * number), so the consumer can tell a lost, repeated or reordered event per
+ * producer. The dropped counter must equal the records refused, and the
+ * module counters every record made. A producer finding the ring full yields,
+ * so the consumer gets in on a single core too (the split between recorded
+ * and dropped varies from run to run):
+ *
+ *   {"mode": "checks", "checks": 20, "failed": 0}
+ *
+ * The exit status is 1 if any check fails.
+ */
+
+#define PRODUCERS				4U
+#define EVENTS_PER_PRODUCER		200000U
+#define RING_SIZE				64U		// health.c HEALTH_RING_SIZE
+#define READ_BATCH				32U
+
+#undef CHECK		// system/error.h fatal check; the checks here are counted
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+/**
+  * @brief  Producer State Type
+  */
+typedef struct {
+	pthread_t thread;
+	health_module_t module;
+	uint32_t recorded;
+	uint32_t dropped;
+} producer_t;
+
+/**
+  * @brief  Consumer Tallies (per producer)
+  */
+typedef struct {
+	uint32_t received[PRODUCERS];
+	uint32_t lost;
+	uint32_t duplicated;
+	uint32_t out_of_order;
+	uint32_t foreign;
+} tally_t;
+
+USBD_HandleTypeDef hUsbDeviceFS;		// never configured: health_service only drains
+
+static unsigned checks;
+static unsigned failures;
+static producer_t producers[PRODUCERS];
+static volatile uint32_t producers_done;
+static volatile uint32_t start_flag;
+static uint32_t clock_ms;
+
+
+/**
+  * @brief firmware clock (set by the checks; constant while the threads run:
+  * 	   the events are told apart by their code)
+  */
+uint32_t millis(void) {
+	return clock_ms;
+}
+
+uint64_t micros(void) {
+	return 0U;
+}
+
+void command_handle(const frame_t *frame) {
+	(void) frame;
+}
+
+uint8_t CDC_Transmit_FS(uint8_t *Buf, uint16_t Len) {
+	(void) Buf;
+	(void) Len;
+	return USBD_FAIL;
+}
+
+static void check(bool cond, const char *what, int line) {
+	checks++;
+
+	if (!cond) {
+		failures++;
+		fprintf(stderr, "health_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+static double now_s(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + 1e-9 * (double) ts.tv_nsec;
+}
+
+/**
+  * @brief helper function to get the producer of a module (PRODUCERS if none)
+  */
+static uint32_t producer_of(uint8_t module) {
+	for (uint32_t p = 0; p < PRODUCERS; ++p) {
+		if (producers[p].module == module)
+			return p;
+	}
+
+	return PRODUCERS;
+}
+
+/**
+  * @brief tallies drained events against the numbering of their producer
+  */
+static void tally_events(tally_t *t, const health_event_t *evt, uint32_t n) {
+	for (uint32_t i = 0; i < n; ++i) {
+		uint32_t p = producer_of(evt[i].module);
+		uint16_t expected;
+
+		if (p == PRODUCERS) {
+			t->foreign++;
+			continue;
+		}
+
+		expected = (uint16_t) t->received[p];
+		if (evt[i].code == expected) {
+			t->received[p]++;
+		} else if ((uint16_t) (evt[i].code - expected) < 0x8000U) {
+			t->lost += (uint16_t) (evt[i].code - expected);
+			t->received[p] += (uint16_t) (evt[i].code - expected) + 1U;
+		} else if (evt[i].code == (uint16_t) (expected - 1U)) {
+			t->duplicated++;
+		} else {
+			t->out_of_order++;
+		}
+	}
+}
+
+/**
+  * @brief producer: records its events numbered in the order they got in
+  */
+static void* produce(void *arg) {
+	producer_t *p = arg;
+
+	while (!__atomic_load_n(&start_flag, __ATOMIC_ACQUIRE))
+		;
+
+	for (uint32_t i = 0; i < EVENTS_PER_PRODUCER; ++i) {
+		if (health_record(p->module, HEALTH_SEVERITY_WARN, (health_code_t) (uint16_t) p->recorded)) {
+			p->recorded++;
+		} else {
+			p->dropped++;
+			sched_yield();		// ring full: let the consumer in (also on a single core)
+		}
+	}
+
+	__atomic_fetch_add(&producers_done, 1U, __ATOMIC_RELEASE);
+
+	return NULL;
+}
+
+/**
+  * @brief one thread: the ring holds its size, the rest is dropped and counted
+  */
+static void run_overflow_checks(void) {
+	health_event_t evt[RING_SIZE + 8U];
+	health_counters_t c;
+	uint32_t cursor = 0U;
+	uint32_t kept = 0U, refused = 0U, n;
+	bool in_order = true;
+
+	health_init();
+
+	for (uint32_t i = 0; i < RING_SIZE + 8U; ++i) {
+		clock_ms = 1000U + i;
+		if (health_record(HEALTH_MODULE_IMU, HEALTH_SEVERITY_WARN, (health_code_t) i))
+			kept++;
+		else
+			refused++;
+	}
+
+	CHECK((kept == RING_SIZE) && (refused == 8U));
+	CHECK(health_get_dropped() == 8U);
+
+	health_get_counters(HEALTH_MODULE_IMU, &c);
+	CHECK(c.warn_count == RING_SIZE + 8U);		// counted even when dropped
+	CHECK((c.last_code == 0U) && (c.last_timestamp_ms == 0U));		// set by the drain
+
+	/* Nothing readable before the main loop drains */
+	CHECK(health_read_events(&cursor, evt, RING_SIZE) == 0U);
+
+	health_service();
+	n = health_read_events(&cursor, evt, RING_SIZE + 8U);
+	for (uint32_t i = 0; i < n; ++i)
+		in_order &= (evt[i].code == i) && (evt[i].module == HEALTH_MODULE_IMU);
+
+	CHECK((n == RING_SIZE) && in_order);
+
+	/* The last event kept, code and time as one pair (not a dropped one) */
+	health_get_counters(HEALTH_MODULE_IMU, &c);
+	CHECK((c.last_code == RING_SIZE - 1U) && (c.last_timestamp_ms == 1000U + RING_SIZE - 1U));
+
+	/* Slots are free again after the drain */
+	CHECK(health_record(HEALTH_MODULE_IMU, HEALTH_SEVERITY_FATAL, HEALTH_CODE_STATUS));
+	health_service();
+	CHECK((health_read_events(&cursor, evt, 1U) == 1U) && (evt[0].severity == HEALTH_SEVERITY_FATAL));
+	CHECK(health_get_dropped() == 8U);
+}
+
+/**
+  * @brief producer threads against a draining consumer
+  */
+static void run_stress_checks(void) {
+	health_event_t evt[READ_BATCH];
+	tally_t t = {0};
+	uint32_t cursor = 0U;
+	uint32_t recorded = 0U, dropped = 0U, received = 0U;
+	bool counters_exact = true;
+	double start, elapsed;
+
+	health_init();
+	clock_ms = 0U;
+	producers_done = 0U;
+	start_flag = 0U;
+
+	for (uint32_t p = 0; p < PRODUCERS; ++p) {
+		producers[p] = (producer_t){.module = (health_module_t) (HEALTH_MODULE_RX + p)};
+		CHECK(pthread_create(&producers[p].thread, NULL, produce, &producers[p]) == 0);
+	}
+
+	start = now_s();
+	__atomic_store_n(&start_flag, 1U, __ATOMIC_RELEASE);
+
+	/* Consumer: drain until every producer is done and the ring is empty */
+	for (;;) {
+		bool done = (__atomic_load_n(&producers_done, __ATOMIC_ACQUIRE) == PRODUCERS);
+		uint32_t got = 0U, n;
+
+		health_service();
+		while ((n = health_read_events(&cursor, evt, READ_BATCH)) > 0U) {
+			tally_events(&t, evt, n);
+			got += n;
+		}
+
+		if (done && (got == 0U))
+			break;
+		if (got == 0U)
+			sched_yield();
+	}
+	elapsed = now_s() - start;
+
+	for (uint32_t p = 0; p < PRODUCERS; ++p) {
+		health_counters_t c;
+
+		pthread_join(producers[p].thread, NULL);
+		recorded += producers[p].recorded;
+		dropped += producers[p].dropped;
+		received += t.received[p];
+
+		health_get_counters(producers[p].module, &c);
+		counters_exact &= (c.warn_count == EVENTS_PER_PRODUCER) && (t.received[p] == producers[p].recorded) &&
+						  (c.last_code == (uint16_t) (producers[p].recorded - 1U));
+	}
+
+	printf("{\"mode\": \"stress\", \"producers\": %u, \"events\": %u, \"recorded\": %u, \"dropped\": %u, "
+		   "\"received\": %u, \"lost\": %u, \"duplicated\": %u, \"out_of_order\": %u, \"records_per_s\": %.2g}\n",
+		   PRODUCERS, PRODUCERS * EVENTS_PER_PRODUCER, recorded, dropped, received, t.lost, t.duplicated,
+		   t.out_of_order, (double) (PRODUCERS * EVENTS_PER_PRODUCER) / elapsed);
+
+	CHECK(recorded + dropped == PRODUCERS * EVENTS_PER_PRODUCER);
+	CHECK(received == recorded);
+	CHECK((t.lost == 0U) && (t.duplicated == 0U) && (t.out_of_order == 0U) && (t.foreign == 0U));
+	CHECK(health_get_dropped() == dropped);
+	CHECK(counters_exact);
+	CHECK(recorded > 0U);
+}
+
+int main(int argc, char **argv) {
+	if (argc > 1) {
+		fprintf(stderr, "usage: %s\n", argv[0]);
+		return 2;
+	}
+
+	run_overflow_checks();
+	run_stress_checks();
+	printf("{\"mode\": \"checks\", \"checks\": %u, \"failed\": %u}\n", checks, failures);
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,231 @@
+/*
+ * imu_main.c (imu configuration host test)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "sensors/imu/devices/lsm6dsox.h"
+#include "sensors/imu/devices/lsm6dsox_config.h"
+#include "lsm6dsox_reg.h"
+#include "common/settings.h"
+
+/*
+ * sensors/imu/devices/lsm6dsox_config.c is run over a table of loop rates,
+ * one line per rate with the derived configuration:
+ *
+ *   {"loop_hz": 417, "odr_hz": 833, "bdr_hz": 417, "gy_lpf1": true, "gy_ftype": 1,
+ *    "gy_bw_hz": 192.4, "xl_bw_hz": 41.7, "fifo_watermark": 3, "fifo_max_words": 12}
+ *
+ * Every row must batch at the lowest rate at or above the loop rate, keep
+ * both on-chip bands below the loop Nyquist frequency, and size the fifo
+ * watermark to one loop; a few rows are pinned to known configurations. Then
+ * the lsm6dsox driver is initialized at several loop rates against a fake
+ * register file, and the odr, filter and fifo registers it wrote are read
+ * back, as is its stall limit:
+ *
+ *   {"mode": "checks", "checks": 212, "failed": 0}
+ *
+ * The exit status is 1 if any check fails.
+ */
+
+/**
+  * @brief  Test Setup
+  */
+#define GY_BW_HZ				CONFIG_GY_LPF_CUTOFF_FREQ_HZ
+#define XL_BW_HZ				CONFIG_XL_LPF_CUTOFF_FREQ_HZ
+#define FAKE_REGS_SIZE			128U
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+static const uint32_t loop_rates[] = {12U, 50U, 100U, 208U, 250U, 333U, 417U, 500U, 833U, 1000U, 1667U, 2000U,
+									  3333U, 6667U};
+
+static const float rate_hz[] = {12.5f, 26.0f, 52.0f, 104.0f, 208.0f, 417.0f, 833.0f, 1667.0f, 3333.0f, 6667.0f};
+
+static unsigned checks;
+static unsigned failures;
+static uint8_t fake_regs[FAKE_REGS_SIZE];
+
+
+static void check(bool cond, const char *what, int line) {
+	checks++;
+
+	if (!cond) {
+		failures++;
+		fprintf(stderr, "imu_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+/**
+  * @brief fake bus register read (flat register file)
+  */
+static int32_t fake_read(uint8_t reg, uint8_t *bufp, uint16_t len) {
+	for (uint16_t i = 0; i < len; ++i)
+		bufp[i] = fake_regs[(reg + i) & (FAKE_REGS_SIZE - 1U)];
+
+	return 0;
+}
+
+/**
+  * @brief fake bus register write (software reset completes immediately)
+  */
+static int32_t fake_write(uint8_t reg, const uint8_t *bufp, uint16_t len) {
+	for (uint16_t i = 0; i < len; ++i)
+		fake_regs[(reg + i) & (FAKE_REGS_SIZE - 1U)] = bufp[i];
+
+	fake_regs[LSM6DSOX_CTRL3_C] &= (uint8_t) ~0x01U;
+
+	return 0;
+}
+
+static const lsm6dsox_bus_t fake_bus = {.read = fake_read, .write = fake_write};
+
+/**
+  * @brief derived configurations over the loop rate table
+  */
+static void run_table_checks(void) {
+	lsm6dsox_config_t cfg;
+
+	for (uint32_t i = 0; i < sizeof(loop_rates) / sizeof(loop_rates[0]); ++i) {
+		uint32_t loop_hz = loop_rates[i];
+		float nyquist = 0.5f * (float) loop_hz;
+		uint32_t batches;
+
+		CHECK(lsm6dsox_derive_config(loop_hz, GY_BW_HZ, XL_BW_HZ, &cfg));
+		batches = (uint32_t) ceilf(cfg.bdr_hz / (float) loop_hz);
+
+		/* Batch rate: the lowest at or above the loop rate, from an odr at or above it */
+		CHECK((cfg.bdr_hz >= (float) loop_hz) && ((cfg.bdr_gy == 1U) || (rate_hz[cfg.bdr_gy - 2U] < (float) loop_hz)));
+		CHECK((cfg.bdr_hz == rate_hz[cfg.bdr_gy - 1U]) && (cfg.bdr_xl == (lsm6dsox_bdr_xl_t) cfg.bdr_gy));
+		CHECK((cfg.odr_hz >= cfg.bdr_hz) && (cfg.odr_xl == (lsm6dsox_odr_xl_t) cfg.odr_gy));
+
+		/* Anti-aliasing: both bands below the loop nyquist frequency */
+		CHECK((cfg.gy_bw_hz > 0.0f) && (cfg.gy_bw_hz <= nyquist));
+		CHECK((cfg.xl_bw_hz > 0.0f) && (cfg.xl_bw_hz <= nyquist));
+		CHECK(cfg.gy_lpf1 == (cfg.odr_hz >= 417.0f));
+
+		/* Fifo: one loop's gyro, accel and timestamp words; a stall is a few loops */
+		CHECK(cfg.fifo_watermark == 3U * batches);
+		CHECK((cfg.fifo_max_words >= 2U * cfg.fifo_watermark) && (cfg.fifo_max_words <= LSM6DSOX_FIFO_WORDS_MAX));
+
+		printf("{\"loop_hz\": %u, \"odr_hz\": %.0f, \"bdr_hz\": %.0f, \"gy_lpf1\": %s, \"gy_ftype\": %u, "
+			   "\"gy_bw_hz\": %.1f, \"xl_bw_hz\": %.1f, \"fifo_watermark\": %u, \"fifo_max_words\": %u}\n",
+			   loop_hz, (double) cfg.odr_hz, (double) cfg.bdr_hz, cfg.gy_lpf1 ? "true" : "false",
+			   (unsigned) cfg.gy_ftype, (double) cfg.gy_bw_hz, (double) cfg.xl_bw_hz, cfg.fifo_watermark,
+			   cfg.fifo_max_words);
+	}
+
+	/* Pinned: the default loop runs the filters at twice the batch rate */
+	CHECK(lsm6dsox_derive_config(417U, GY_BW_HZ, XL_BW_HZ, &cfg));
+	CHECK((cfg.odr_gy == LSM6DSOX_GY_ODR_833Hz) && (cfg.bdr_gy == LSM6DSOX_GY_BATCHED_AT_417Hz));
+	CHECK(cfg.gy_lpf1 && (cfg.gy_ftype == LSM6DSOX_VERY_LIGHT) && (fabsf(cfg.gy_bw_hz - 192.4f) < 0.05f));
+	CHECK(cfg.xl_lpf2 == LSM6DSOX_LP_ODR_DIV_20);
+	CHECK((cfg.fifo_watermark == 3U) && (cfg.fifo_max_words == 12U));
+
+	/* Pinned: 1 kHz batches at 1667 Hz (two words of each per loop at times) */
+	CHECK(lsm6dsox_derive_config(1000U, GY_BW_HZ, XL_BW_HZ, &cfg));
+	CHECK((cfg.odr_gy == LSM6DSOX_GY_ODR_6667Hz) && (cfg.bdr_gy == LSM6DSOX_GY_BATCHED_AT_1667Hz));
+	CHECK((cfg.gy_ftype == LSM6DSOX_MEDIUM) && (cfg.xl_lpf2 == LSM6DSOX_LP_ODR_DIV_200));
+	CHECK((cfg.fifo_watermark == 6U) && (cfg.fifo_max_words == 24U));
+
+	/* Pinned: below 417 Hz the gyro band follows the odr alone */
+	CHECK(lsm6dsox_derive_config(100U, GY_BW_HZ, XL_BW_HZ, &cfg));
+	CHECK((cfg.odr_gy == LSM6DSOX_GY_ODR_104Hz) && !cfg.gy_lpf1 && (fabsf(cfg.gy_bw_hz - 33.0f) < 0.05f));
+
+	/* The gyro cutoff narrows the band below the nyquist frequency */
+	CHECK(lsm6dsox_derive_config(417U, 150.0f, XL_BW_HZ, &cfg));
+	CHECK((cfg.gy_bw_hz <= 150.0f) && (cfg.gy_bw_hz > 130.0f));
+
+	/* A cutoff below every band falls back to the narrowest at the batch rate */
+	CHECK(lsm6dsox_derive_config(417U, 1.0f, XL_BW_HZ, &cfg));
+	CHECK((cfg.odr_gy == LSM6DSOX_GY_ODR_417Hz) && (cfg.gy_ftype == LSM6DSOX_LIGHT));
+
+	/* Out of range: refused, nothing written */
+	memset(&cfg, 0xA5, sizeof(cfg));
+	CHECK(!lsm6dsox_derive_config(0U, GY_BW_HZ, XL_BW_HZ, &cfg));
+	CHECK(!lsm6dsox_derive_config(LSM6DSOX_LOOP_HZ_MIN - 1U, GY_BW_HZ, XL_BW_HZ, &cfg));
+	CHECK(!lsm6dsox_derive_config(LSM6DSOX_LOOP_HZ_MAX + 1U, GY_BW_HZ, XL_BW_HZ, &cfg));
+	CHECK(cfg.loop_hz == 0xA5A5A5A5U);
+}
+
+/**
+  * @brief driver registers after init at a loop rate
+  */
+static void run_driver_checks(void) {
+	static const uint32_t driver_rates[] = {50U, 208U, 417U, 1000U, 3333U};
+	imu_6D_t imu = {0};
+
+	lsm6dsox_set_bus(&fake_bus);
+
+	for (uint32_t i = 0; i < sizeof(driver_rates) / sizeof(driver_rates[0]); ++i) {
+		lsm6dsox_ctrl1_xl_t ctrl1_xl;
+		lsm6dsox_ctrl2_g_t ctrl2_g;
+		lsm6dsox_ctrl4_c_t ctrl4_c;
+		lsm6dsox_ctrl6_c_t ctrl6_c;
+		lsm6dsox_ctrl8_xl_t ctrl8_xl;
+		lsm6dsox_fifo_ctrl3_t fifo_ctrl3;
+		lsm6dsox_config_t expect;
+		const lsm6dsox_config_t *cfg;
+		uint16_t watermark;
+
+		memset(fake_regs, 0, sizeof(fake_regs));
+		fake_regs[LSM6DSOX_WHO_AM_I] = LSM6DSOX_ID;
+
+		CHECK(lsm6dsox_set_loop_rate(driver_rates[i]) == IMU_OK);
+		CHECK(lsm6dsox_driver.init() == IMU_OK);
+		CHECK(lsm6dsox_derive_config(driver_rates[i], GY_BW_HZ, XL_BW_HZ, &expect));
+		cfg = lsm6dsox_get_config();
+		CHECK((cfg->loop_hz == expect.loop_hz) && (cfg->odr_gy == expect.odr_gy) && (cfg->bdr_gy == expect.bdr_gy) &&
+			  (cfg->gy_ftype == expect.gy_ftype) && (cfg->xl_lpf2 == expect.xl_lpf2));
+
+		memcpy(&ctrl1_xl, &fake_regs[LSM6DSOX_CTRL1_XL], 1U);
+		memcpy(&ctrl2_g, &fake_regs[LSM6DSOX_CTRL2_G], 1U);
+		memcpy(&ctrl4_c, &fake_regs[LSM6DSOX_CTRL4_C], 1U);
+		memcpy(&ctrl6_c, &fake_regs[LSM6DSOX_CTRL6_C], 1U);
+		memcpy(&ctrl8_xl, &fake_regs[LSM6DSOX_CTRL8_XL], 1U);
+		memcpy(&fifo_ctrl3, &fake_regs[LSM6DSOX_FIFO_CTRL3], 1U);
+		watermark = (uint16_t) (fake_regs[LSM6DSOX_FIFO_CTRL1] | ((fake_regs[LSM6DSOX_FIFO_CTRL2] & 0x01U) << 8));
+
+		CHECK((ctrl1_xl.odr_xl == cfg->odr_xl) && (ctrl2_g.odr_g == cfg->odr_gy));
+		CHECK((fifo_ctrl3.bdr_xl == cfg->bdr_xl) && (fifo_ctrl3.bdr_gy == cfg->bdr_gy));
+		CHECK(watermark == cfg->fifo_watermark);
+		CHECK(ctrl1_xl.lpf2_xl_en && (ctrl8_xl.hpcf_xl == ((uint8_t) cfg->xl_lpf2 & 0x07U)) && !ctrl8_xl.hp_slope_xl_en);
+		CHECK((ctrl4_c.lpf1_sel_g == cfg->gy_lpf1) && (!cfg->gy_lpf1 || (ctrl6_c.ftype == cfg->gy_ftype)));
+
+		/* Stall limit: the first read drops the backlog, then up to the limit is read */
+		fake_regs[LSM6DSOX_FIFO_STATUS1] = 0U;
+		fake_regs[LSM6DSOX_FIFO_STATUS2] = 0U;
+		CHECK(lsm6dsox_driver.read(&imu) == IMU_OK);
+		fake_regs[LSM6DSOX_FIFO_STATUS1] = (uint8_t) cfg->fifo_max_words;
+		CHECK(lsm6dsox_driver.read(&imu) == IMU_OK);
+		fake_regs[LSM6DSOX_FIFO_STATUS1] = (uint8_t) (cfg->fifo_max_words + 1U);
+		CHECK(lsm6dsox_driver.read(&imu) == IMU_ERROR_WARN);
+
+		CHECK(lsm6dsox_driver.deinit() == IMU_OK);
+	}
+
+	/* Out of range rates are refused and leave the rate as it was */
+	CHECK(lsm6dsox_set_loop_rate(LSM6DSOX_LOOP_HZ_MAX + 1U) == IMU_ERROR_FATAL);
+	memset(fake_regs, 0, sizeof(fake_regs));
+	fake_regs[LSM6DSOX_WHO_AM_I] = LSM6DSOX_ID;
+	CHECK((lsm6dsox_driver.init() == IMU_OK) && (lsm6dsox_get_config()->loop_hz == 3333U));
+
+	lsm6dsox_set_bus(NULL);
+}
+
+int main(int argc, char **argv) {
+	if (argc > 1) {
+		fprintf(stderr, "usage: %s\n", argv[0]);
+		return 2;
+	}
+
+	run_table_checks();
+	run_driver_checks();
+	printf("{\"mode\": \"checks\", \"checks\": %u, \"failed\": %u}\n", checks, failures);
+
+	return failures ? 1 : 0;
+}
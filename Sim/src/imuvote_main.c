@@ -0,0 +1,525 @@
+/*
+ * imuvote_main.c (redundant imu voting host test)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "sensors/imu/imu_vote.h"
+#include "sensors/imu/devices/lsm6dsox.h"
+#include "lsm6dsox_reg.h"
+#include "common/settings.h"
+
+/*
+ * sensors/imu/imu_vote.c is fed synthetic instances of a moving craft
+ * (200 dps / 2 g sinusoids plus per-instance noise) at the configured loop
+ * rate, with a fault injected into one of them, one line per scenario:
+ *
+ *   {"scenario": "stuck", "instances": 3, "loops": 2000, "failed": 1, "fail_loop": 520,
+ *    "failovers": 1, "primary": 1, "warns": 18, "err_max_dps": 0.10, "step_max_dps": 0.18}
+ *
+ * err_max is the largest voted rate error against the truth, step_max the
+ * largest loop to loop output change beyond the truth's own. A stuck sensor
+ * must fail within CONFIG_IMU_STUCK_MS, a drifting one among three once it
+ * has been off tolerance for CONFIG_IMU_VOTE_FAULT_MS (the median keeps the
+ * output on the truth meanwhile), a dead one after as many failed reads,
+ * and the output must neither hold nor step at the failover. Two disagreeing
+ * instances only count it, and the last instance is never failed. Then two
+ * lsm6dsox driver instances are run on separate fake buses: init, register
+ * writes, fifo samples and timestamps must not cross between them:
+ *
+ *   {"mode": "checks", "checks": 74, "failed": 0}
+ *
+ * The exit status is 1 if any check fails.
+ */
+
+/**
+  * @brief  Test Setup (the voter as imu.c configures it)
+  */
+#define LOOP_HZ					CONFIG_IMU_LOOP_RATE_HZ
+#define GY_TOL_MDPS				(CONFIG_IMU_VOTE_GY_TOL_DPS * 1000.0f)
+#define XL_TOL_MG				(CONFIG_IMU_VOTE_XL_TOL_G * 1000.0f)
+#define FAULT_LOOPS				((CONFIG_IMU_VOTE_FAULT_MS * LOOP_HZ + 999U) / 1000U)
+#define STUCK_LOOPS				((CONFIG_IMU_STUCK_MS * LOOP_HZ + 999U) / 1000U)
+#define DT_US					(1000000U / LOOP_HZ)
+
+#define LOOPS					2000U
+#define FAULT_START				500U
+#define GY_AMP_MDPS				200000.0f
+#define XL_AMP_MG				2000.0f
+#define MOTION_HZ				2.0f
+#define GY_NOISE_MDPS			100.0f		// uniform, per instance
+#define XL_NOISE_MG				5.0f
+#define DRIFT_MDPS_PER_LOOP		100.0f
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+/**
+  * @brief  Fake Device (flat register file, fifo served from a word queue)
+  */
+#define FAKE_REGS_SIZE			128U
+#define FAKE_FIFO_WORDS			16U
+#define FIFO_WORD_LEN			7U
+
+typedef enum {
+	FAULT_NONE = 0,
+	FAULT_STUCK,
+	FAULT_DRIFT,
+	FAULT_DEAD,
+	FAULT_FLAKY			// every 10th read fails
+} fault_t;
+
+typedef struct {
+	const char *name;
+	uint8_t instances;
+	uint8_t faulty;
+	fault_t fault;
+} scenario_t;
+
+typedef struct {
+	uint32_t fail_loop;		// first loop an instance failed (0: none)
+	uint32_t warns;
+	uint32_t fatals;
+	float err_max_mdps;
+	float step_max_mdps;
+} result_t;
+
+typedef struct {
+	uint8_t regs[FAKE_REGS_SIZE];
+	uint8_t fifo[FAKE_FIFO_WORDS * FIFO_WORD_LEN];
+	uint32_t words;
+	uint32_t writes;
+} fake_dev_t;
+
+static unsigned checks;
+static unsigned failures;
+static uint32_t rng = 0x12345678U;
+static fake_dev_t dev_a;
+static fake_dev_t dev_b;
+
+static const imu_vote_config_t vote_cfg = {
+	.gy_tol_mdps = GY_TOL_MDPS,
+	.xl_tol_mg = XL_TOL_MG,
+	.fault_loops = FAULT_LOOPS,
+	.stuck_loops = STUCK_LOOPS
+};
+
+
+static void check(bool cond, const char *what, int line) {
+	checks++;
+
+	if (!cond) {
+		failures++;
+		fprintf(stderr, "imuvote_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+/**
+  * @brief uniform noise in [-amp, amp] (deterministic)
+  */
+static float noise(float amp) {
+	rng = rng * 1664525U + 1013904223U;
+	return amp * (2.0f * (float) (rng >> 8) / 16777216.0f - 1.0f);
+}
+
+/**
+  * @brief true motion at a loop
+  */
+static void truth(uint32_t loop, imu_6D_t *t) {
+	float ph = 2.0f * (float) M_PI * MOTION_HZ * (float) loop / (float) LOOP_HZ;
+
+	t->accel_x = XL_AMP_MG * sinf(ph);
+	t->accel_y = XL_AMP_MG * cosf(ph);
+	t->accel_z = 1000.0f + 0.5f * XL_AMP_MG * sinf(2.0f * ph);
+	t->rate_x = GY_AMP_MDPS * sinf(ph);
+	t->rate_y = GY_AMP_MDPS * cosf(ph);
+	t->rate_z = 0.5f * GY_AMP_MDPS * sinf(0.5f * ph);
+	t->dt = DT_US;
+}
+
+/**
+  * @brief largest rate axis difference
+  */
+static float rate_diff(const imu_6D_t *a, const imu_6D_t *b) {
+	return fmaxf(fmaxf(fabsf(a->rate_x - b->rate_x), fabsf(a->rate_y - b->rate_y)), fabsf(a->rate_z - b->rate_z));
+}
+
+/**
+  * @brief runs the voter over a scenario
+  */
+static void run_scenario(const scenario_t *sc, imu_vote_t *v, result_t *r) {
+	imu_6D_t samples[IMU_VOTE_INSTANCES_MAX] = {0};
+	imu_status_t status[IMU_VOTE_INSTANCES_MAX];
+	imu_6D_t out = {0}, prev_out = {0}, t, prev_t = {0};
+
+	memset(r, 0, sizeof(*r));
+	imu_vote_init(v, &vote_cfg, sc->instances, (1UL << sc->instances) - 1U);
+
+	for (uint32_t loop = 1; loop <= LOOPS; ++loop) {
+		bool faulted = loop >= FAULT_START;
+		imu_status_t ret;
+
+		truth(loop, &t);
+
+		for (uint8_t i = 0; i < sc->instances; ++i) {
+			status[i] = IMU_OK;
+
+			if ((i == sc->faulty) && faulted && (sc->fault == FAULT_STUCK))
+				continue;
+
+			samples[i] = t;
+			samples[i].accel_x += noise(XL_NOISE_MG);
+			samples[i].accel_y += noise(XL_NOISE_MG);
+			samples[i].accel_z += noise(XL_NOISE_MG);
+			samples[i].rate_x += noise(GY_NOISE_MDPS);
+			samples[i].rate_y += noise(GY_NOISE_MDPS);
+			samples[i].rate_z += noise(GY_NOISE_MDPS);
+
+			if ((i != sc->faulty) || !faulted)
+				continue;
+
+			if (sc->fault == FAULT_DRIFT)
+				samples[i].rate_x += DRIFT_MDPS_PER_LOOP * (float) (loop - FAULT_START);
+			else if (sc->fault == FAULT_DEAD)
+				status[i] = IMU_ERROR_WARN;
+			else if ((sc->fault == FAULT_FLAKY) && ((loop % 10U) == 0U))
+				status[i] = IMU_ERROR_WARN;
+		}
+
+		ret = imu_vote_update(v, samples, status, &out);
+		if (ret == IMU_ERROR_WARN)
+			r->warns++;
+		else if (ret == IMU_ERROR_FATAL)
+			r->fatals++;
+
+		for (uint8_t i = 0; i < sc->instances; ++i) {
+			if ((v->stats[i].state == IMU_INSTANCE_FAILED) && (r->fail_loop == 0U))
+				r->fail_loop = loop;
+		}
+
+		/* Two disagreeing instances follow the primary, not the truth */
+		if ((sc->fault != FAULT_DRIFT) || (sc->instances != 2U) || (loop < FAULT_START))
+			r->err_max_mdps = fmaxf(r->err_max_mdps, rate_diff(&out, &t));
+
+		if (loop > 1U) {
+			float step = fmaxf(fmaxf(fabsf((out.rate_x - prev_out.rate_x) - (t.rate_x - prev_t.rate_x)),
+									 fabsf((out.rate_y - prev_out.rate_y) - (t.rate_y - prev_t.rate_y))),
+							   fabsf((out.rate_z - prev_out.rate_z) - (t.rate_z - prev_t.rate_z)));
+			r->step_max_mdps = fmaxf(r->step_max_mdps, step);
+		}
+
+		prev_out = out;
+		prev_t = t;
+	}
+}
+
+/**
+  * @brief prints a scenario line
+  */
+static void print_result(const scenario_t *sc, const imu_vote_t *v, const result_t *r) {
+	uint32_t failed = 0U;
+
+	for (uint8_t i = 0; i < sc->instances; ++i)
+		failed += (v->stats[i].state == IMU_INSTANCE_FAILED) ? 1U : 0U;
+
+	printf("{\"scenario\": \"%s\", \"instances\": %u, \"loops\": %u, \"failed\": %u, \"fail_loop\": %u, "
+		   "\"failovers\": %u, \"primary\": %u, \"warns\": %u, \"err_max_dps\": %.2f, \"step_max_dps\": %.2f}\n",
+		   sc->name, sc->instances, LOOPS, failed, r->fail_loop, v->failovers, v->primary, r->warns,
+		   r->err_max_mdps / 1000.0f, r->step_max_mdps / 1000.0f);
+}
+
+/**
+  * @brief voting with injected faults
+  */
+static void run_vote_checks(void) {
+	static const scenario_t scenarios[] = {
+		{"clean", 3U, 0U, FAULT_NONE},
+		{"stuck", 3U, 0U, FAULT_STUCK},
+		{"drift", 3U, 1U, FAULT_DRIFT},
+		{"flaky", 3U, 2U, FAULT_FLAKY},
+		{"dead", 3U, 2U, FAULT_DEAD},
+		{"dropout", 2U, 0U, FAULT_DEAD},
+		{"disagree", 2U, 1U, FAULT_DRIFT},
+		{"single_stuck", 1U, 0U, FAULT_STUCK}
+	};
+	const float noise_bound = GY_NOISE_MDPS;
+	const float drift_fail = FAULT_START + GY_TOL_MDPS / DRIFT_MDPS_PER_LOOP + FAULT_LOOPS;
+	imu_vote_t v;
+	result_t r;
+
+	for (uint32_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); ++s) {
+		const scenario_t *sc = &scenarios[s];
+		const imu_instance_stats_t *bad = &v.stats[sc->faulty];
+
+		run_scenario(sc, &v, &r);
+		print_result(sc, &v, &r);
+
+		/* Never lost the output */
+		CHECK(r.fatals == 0U);
+
+		switch (s) {
+			case 0:		// clean: the vote stays within the noise, nothing fires
+				CHECK((r.fail_loop == 0U) && (r.warns == 0U) && (v.failovers == 0U));
+				CHECK(r.err_max_mdps <= noise_bound);
+				CHECK((v.stats[0].disagreements == 0U) && (v.stats[0].reads == LOOPS));
+				break;
+
+			case 1:		// stuck primary: fails within the stuck time, the primary moves on
+				CHECK((bad->state == IMU_INSTANCE_FAILED) && (bad->fault == IMU_FAULT_STUCK));
+				CHECK((r.fail_loop > FAULT_START) && (r.fail_loop <= FAULT_START + STUCK_LOOPS));
+				CHECK((v.primary == 1U) && (v.failovers == 1U));
+				CHECK(r.err_max_mdps <= noise_bound);
+				CHECK(r.step_max_mdps <= 2.0f * noise_bound);
+				CHECK(bad->reads == r.fail_loop);
+				break;
+
+			case 2:		// drift: the median holds the truth until the instance fails
+				CHECK((bad->state == IMU_INSTANCE_FAILED) && (bad->fault == IMU_FAULT_DIVERGED));
+				CHECK((r.fail_loop >= (uint32_t) drift_fail - 2U) && (r.fail_loop <= (uint32_t) drift_fail + 2U));
+				CHECK((v.stats[0].state == IMU_INSTANCE_OK) && (v.stats[2].state == IMU_INSTANCE_OK));
+				CHECK((v.primary == 0U) && (v.failovers == 0U));
+				CHECK(r.err_max_mdps <= noise_bound);
+				CHECK(bad->disagreements == FAULT_LOOPS);
+				CHECK(bad->gy_dev_max_mdps > GY_TOL_MDPS);
+				break;
+
+			case 3:		// flaky: counted, never failed
+				CHECK((bad->state == IMU_INSTANCE_OK) && (r.fail_loop == 0U));
+				CHECK(bad->read_errors == (LOOPS / 10U) - (FAULT_START - 1U) / 10U);
+				CHECK(r.warns == bad->read_errors);
+				CHECK(r.err_max_mdps <= noise_bound);
+				break;
+
+			case 4:		// dead: fails after the fault time of failed reads
+				CHECK((bad->state == IMU_INSTANCE_FAILED) && (bad->fault == IMU_FAULT_READ));
+				CHECK(r.fail_loop == FAULT_START + FAULT_LOOPS - 1U);
+				CHECK(bad->read_errors == FAULT_LOOPS);
+				CHECK(r.warns == FAULT_LOOPS);
+				break;
+
+			case 5:		// dead primary of two: the other carries on in the same loop
+				CHECK((bad->state == IMU_INSTANCE_FAILED) && (bad->fault == IMU_FAULT_READ));
+				CHECK((v.primary == 1U) && (v.failovers == 1U));
+				CHECK(r.err_max_mdps <= noise_bound);
+				CHECK(r.step_max_mdps <= 2.0f * noise_bound);
+				break;
+
+			case 6:		// two disagreeing: no telling which, the primary is kept
+				CHECK((v.stats[0].state == IMU_INSTANCE_OK) && (v.stats[1].state == IMU_INSTANCE_OK));
+				CHECK((v.primary == 0U) && (r.fail_loop == 0U));
+				CHECK(bad->disagreements > 0U);
+				CHECK(v.stats[0].disagreements == 0U);
+				CHECK(r.warns == bad->disagreements);
+				CHECK(r.step_max_mdps <= GY_TOL_MDPS);
+				break;
+
+			case 7:		// last instance: fault seen, kept in use
+				CHECK((bad->state == IMU_INSTANCE_OK) && (bad->fault == IMU_FAULT_STUCK));
+				CHECK(r.warns == (LOOPS - FAULT_START + 1U) / STUCK_LOOPS);
+				break;
+		}
+	}
+
+	/* Offline instances: the primary is the lowest online, none online is fatal */
+	{
+		imu_6D_t samples[IMU_VOTE_INSTANCES_MAX] = {0};
+		imu_status_t status[IMU_VOTE_INSTANCES_MAX] = {IMU_OK, IMU_OK, IMU_OK};
+		imu_6D_t out = {.rate_x = 1.0f};
+
+		imu_vote_init(&v, &vote_cfg, 3U, 0x6U);
+		CHECK((v.primary == 1U) && (v.stats[0].state == IMU_INSTANCE_OFFLINE));
+		samples[1].dt = 111U;
+		samples[2].dt = 222U;
+		CHECK((imu_vote_update(&v, samples, status, &out) == IMU_OK) && (out.dt == 111U));
+		CHECK((v.stats[0].reads == 0U) && (v.stats[1].reads == 1U));
+
+		imu_vote_init(&v, &vote_cfg, 2U, 0x0U);
+		out.rate_x = 1.0f;
+		CHECK((imu_vote_update(&v, samples, status, &out) == IMU_ERROR_FATAL) && (out.rate_x == 1.0f));
+
+		/* Count clamped to the voter's size */
+		imu_vote_init(&v, &vote_cfg, IMU_VOTE_INSTANCES_MAX + 2U, 0xFFU);
+		CHECK(v.count == IMU_VOTE_INSTANCES_MAX);
+
+		/* One instance, one failed read: the output holds, not fatal */
+		imu_vote_init(&v, &vote_cfg, 1U, 0x1U);
+		status[0] = IMU_ERROR_WARN;
+		CHECK((imu_vote_update(&v, samples, status, &out) == IMU_ERROR_WARN) && (out.rate_x == 1.0f));
+	}
+
+	/* Primary voted out among three: the failover loop takes its dt from the
+	 * new primary, not from the sample just voted out */
+	{
+		imu_6D_t samples[IMU_VOTE_INSTANCES_MAX] = {{.dt = 100U}, {.dt = 111U}, {.dt = 222U}};
+		imu_status_t status[IMU_VOTE_INSTANCES_MAX] = {IMU_OK, IMU_OK, IMU_OK};
+		imu_6D_t out = {0};
+		bool old_dt = true;
+
+		imu_vote_init(&v, &vote_cfg, 3U, 0x7U);
+		for (uint32_t loop = 0; loop < FAULT_LOOPS; ++loop) {
+			for (uint8_t i = 0; i < 3U; ++i)
+				samples[i].rate_x = (float) loop;
+			samples[0].rate_x += 10.0f * GY_TOL_MDPS;
+
+			imu_vote_update(&v, samples, status, &out);
+			if (loop + 1U < FAULT_LOOPS)
+				old_dt &= (out.dt == 100U);
+		}
+
+		CHECK(old_dt);
+		CHECK((v.stats[0].state == IMU_INSTANCE_FAILED) && (v.stats[0].fault == IMU_FAULT_DIVERGED) &&
+			  (v.primary == 1U) && (out.dt == 111U));
+	}
+}
+
+/**
+  * @brief fake bus register read (fifo words popped from the queue)
+  */
+static int32_t fake_read(fake_dev_t *d, uint8_t reg, uint8_t *bufp, uint16_t len) {
+	if ((reg == LSM6DSOX_FIFO_DATA_OUT_TAG) && (len <= d->words * FIFO_WORD_LEN)) {
+		memcpy(bufp, d->fifo, len);
+		memmove(d->fifo, &d->fifo[len], d->words * FIFO_WORD_LEN - len);
+		d->words -= len / FIFO_WORD_LEN;
+		d->regs[LSM6DSOX_FIFO_STATUS1] = (uint8_t) d->words;
+		return 0;
+	}
+
+	for (uint16_t i = 0; i < len; ++i)
+		bufp[i] = d->regs[(reg + i) & (FAKE_REGS_SIZE - 1U)];
+
+	return 0;
+}
+
+/**
+  * @brief fake bus register write (software reset completes immediately)
+  */
+static int32_t fake_write(fake_dev_t *d, uint8_t reg, const uint8_t *bufp, uint16_t len) {
+	for (uint16_t i = 0; i < len; ++i)
+		d->regs[(reg + i) & (FAKE_REGS_SIZE - 1U)] = bufp[i];
+
+	d->regs[LSM6DSOX_CTRL3_C] &= (uint8_t) ~0x01U;
+	d->writes++;
+
+	return 0;
+}
+
+static int32_t read_a(uint8_t reg, uint8_t *bufp, uint16_t len) { return fake_read(&dev_a, reg, bufp, len); }
+static int32_t write_a(uint8_t reg, const uint8_t *bufp, uint16_t len) { return fake_write(&dev_a, reg, bufp, len); }
+static int32_t read_b(uint8_t reg, uint8_t *bufp, uint16_t len) { return fake_read(&dev_b, reg, bufp, len); }
+static int32_t write_b(uint8_t reg, const uint8_t *bufp, uint16_t len) { return fake_write(&dev_b, reg, bufp, len); }
+
+static const lsm6dsox_bus_t bus_a = {.read = read_a, .write = write_a};
+static const lsm6dsox_bus_t bus_b = {.read = read_b, .write = write_b};
+
+/**
+  * @brief queues an accel, a gyro and a timestamp word
+  */
+static void push_sample(fake_dev_t *d, int16_t xl, int16_t gy, uint32_t ts) {
+	uint8_t *w = &d->fifo[d->words * FIFO_WORD_LEN];
+
+	memset(w, 0, 3U * FIFO_WORD_LEN);
+	w[0] = (uint8_t) (LSM6DSOX_XL_NC_TAG << 3);
+	for (uint32_t k = 0; k < 3U; ++k) {
+		w[1U + 2U * k] = (uint8_t) xl;
+		w[2U + 2U * k] = (uint8_t) ((uint16_t) xl >> 8);
+	}
+
+	w += FIFO_WORD_LEN;
+	w[0] = (uint8_t) (LSM6DSOX_GYRO_NC_TAG << 3);
+	for (uint32_t k = 0; k < 3U; ++k) {
+		w[1U + 2U * k] = (uint8_t) gy;
+		w[2U + 2U * k] = (uint8_t) ((uint16_t) gy >> 8);
+	}
+
+	w += FIFO_WORD_LEN;
+	w[0] = (uint8_t) (LSM6DSOX_TIMESTAMP_TAG << 3);
+	w[1] = (uint8_t) ts;
+	w[2] = (uint8_t) (ts >> 8);
+	w[3] = (uint8_t) (ts >> 16);
+	w[4] = (uint8_t) (ts >> 24);
+
+	d->words += 3U;
+	d->regs[LSM6DSOX_FIFO_STATUS1] = (uint8_t) d->words;
+	d->regs[LSM6DSOX_FIFO_STATUS2] = 0U;
+}
+
+/**
+  * @brief two lsm6dsox instances on separate fake buses
+  */
+static void run_driver_checks(void) {
+	imu_6D_t a = {0}, b = {0};
+	uint8_t regs_a[FAKE_REGS_SIZE];
+	uint32_t writes_a;
+
+	memset(&dev_a, 0, sizeof(dev_a));
+	memset(&dev_b, 0, sizeof(dev_b));
+	dev_a.regs[LSM6DSOX_WHO_AM_I] = LSM6DSOX_ID;
+	dev_b.regs[LSM6DSOX_WHO_AM_I] = 0x00U;
+
+	lsm6dsox_set_instance_bus(LSM6DSOX_PRIMARY, &bus_a);
+	lsm6dsox_set_instance_bus(LSM6DSOX_SECONDARY, &bus_b);
+	CHECK(lsm6dsox_set_loop_rate(LOOP_HZ) == IMU_OK);
+
+	/* A missing secondary fails alone, without a write to either bus */
+	CHECK(lsm6dsox_driver.init() == IMU_OK);
+	memcpy(regs_a, dev_a.regs, sizeof(regs_a));
+	writes_a = dev_a.writes;
+	CHECK(lsm6dsox_secondary_driver.init() == IMU_ERROR_FATAL);
+	CHECK((dev_b.writes == 0U) && (dev_a.writes == writes_a));
+
+	/* Secondary present: configured like the primary, on its own bus only */
+	dev_b.regs[LSM6DSOX_WHO_AM_I] = LSM6DSOX_ID;
+	CHECK(lsm6dsox_secondary_driver.init() == IMU_OK);
+	CHECK((dev_a.writes == writes_a) && (memcmp(regs_a, dev_a.regs, sizeof(regs_a)) == 0));
+	CHECK((dev_b.regs[LSM6DSOX_CTRL1_XL] == dev_a.regs[LSM6DSOX_CTRL1_XL]) &&
+		  (dev_b.regs[LSM6DSOX_CTRL2_G] == dev_a.regs[LSM6DSOX_CTRL2_G]) &&
+		  (dev_b.regs[LSM6DSOX_FIFO_CTRL3] == dev_a.regs[LSM6DSOX_FIFO_CTRL3]));
+
+	/* Samples and timestamps stay with their instance (reads interleaved) */
+	push_sample(&dev_a, 1000, 100, 1000U);
+	push_sample(&dev_b, -2000, -200, 50000U);
+	CHECK(lsm6dsox_driver.read(&a) == IMU_OK);
+	CHECK(lsm6dsox_secondary_driver.read(&b) == IMU_OK);
+	CHECK((a.accel_x == lsm6dsox_from_fs16_to_mg(1000)) && (a.rate_z == lsm6dsox_from_fs2000_to_mdps(100)));
+	CHECK((b.accel_x == lsm6dsox_from_fs16_to_mg(-2000)) && (b.rate_z == lsm6dsox_from_fs2000_to_mdps(-200)));
+	CHECK((dev_a.words == 0U) && (dev_b.words == 0U));
+
+	push_sample(&dev_a, 1001, 101, 1096U);
+	push_sample(&dev_b, -2001, -201, 50100U);
+	CHECK(lsm6dsox_secondary_driver.read(&b) == IMU_OK);
+	CHECK(lsm6dsox_driver.read(&a) == IMU_OK);
+	CHECK((a.dt == 96U * 25U) && (b.dt == 100U * 25U));
+	CHECK((a.rate_x == lsm6dsox_from_fs2000_to_mdps(101)) && (b.rate_x == lsm6dsox_from_fs2000_to_mdps(-201)));
+
+	/* An overrun on one restarts only its own fifo */
+	dev_b.regs[LSM6DSOX_FIFO_STATUS2] = 0x40U;
+	push_sample(&dev_a, 1002, 102, 1192U);
+	CHECK(lsm6dsox_secondary_driver.read(&b) == IMU_ERROR_WARN);
+	CHECK(lsm6dsox_driver.read(&a) == IMU_OK);
+	CHECK((a.dt == 96U * 25U) && (a.accel_x == lsm6dsox_from_fs16_to_mg(1002)));
+
+	/* Deinit of one leaves the other readable */
+	CHECK(lsm6dsox_secondary_driver.deinit() == IMU_OK);
+	push_sample(&dev_a, 1003, 103, 1288U);
+	CHECK((lsm6dsox_driver.read(&a) == IMU_OK) && (a.accel_x == lsm6dsox_from_fs16_to_mg(1003)));
+	CHECK(lsm6dsox_driver.deinit() == IMU_OK);
+
+	lsm6dsox_set_instance_bus(LSM6DSOX_PRIMARY, NULL);
+	lsm6dsox_set_instance_bus(LSM6DSOX_SECONDARY, NULL);
+}
+
+int main(int argc, char **argv) {
+	if (argc > 1) {
+		fprintf(stderr, "usage: %s\n", argv[0]);
+		return 2;
+	}
+
+	run_vote_checks();
+	run_driver_checks();
+	printf("{\"mode\": \"checks\", \"checks\": %u, \"failed\": %u}\n", checks, failures);
+
+	return failures ? 1 : 0;
+}
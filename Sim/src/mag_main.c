@@ -0,0 +1,747 @@
+/*
+ * mag_main.c (magnetometer driver, calibration and heading fusion host test)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sensors/imu/devices/lsm6dsox.h"
+#include "sensors/mag/devices/lis2mdl.h"
+#include "flight/attitude.h"
+#include "params/params.h"
+#include "sim_hw.h"
+#include "lsm6dsox_reg.h"
+
+/*
+ * Runs sensors/imu/devices/lsm6dsox.c and sensors/mag/devices/lis2mdl.c
+ * unmodified against a fake LSM6DSOX (register banks, fifo, sensor hub
+ * master) with a fake LIS2MDL on its aux bus, on a virtual clock. The fake
+ * imu batches gyro, accel and timestamp words every 417 Hz odr period and,
+ * while the hub is attached, the slave 0 bytes every fourth period (104 Hz).
+ *
+ * First the drivers are checked: device ids and the LIS2MDL setup written
+ * through one-shot hub transactions, an absent magnetometer, the bus
+ * transactions per imu read with and without the hub (the mag bytes come
+ * with the fifo burst), the sample contents and rate, the time step from the
+ * fifo timestamps, a hub nack and a stalled hub. Then the calibration fit
+ * (sensors/mag/mag_cal.c) is checked on readings with known hard and soft
+ * iron, on readings turned about one axis only and on too few readings, and
+ * a calibration session is run through sensors/mag/mag.c:
+ *
+ *   {"mode": "checks", "checks": 51, "failed": 0, "imu_read_transactions": 2, ...}
+ *
+ * then a 120 s flight is flown (heading swinging through turns at up to
+ * 60 deg/s, banking up to 15 deg) with a 0.3 deg/s gyro bias, sensor noise
+ * and the same hard / soft iron. flight/attitude.c's heading is compared for
+ * the calibrated magnetometer (the session's fit), the raw magnetometer and
+ * the gyro alone (started on the true heading):
+ *
+ *   {"mode": "flight", "fused_rms_deg": 1.47, "raw_rms_deg": 15.88, "gyro_rms_deg": 21.10, ...}
+ *
+ * The fused heading trails a yaw gyro bias by bias x CONFIG_MAG_HEADING_TAU_S
+ * (1.5 deg here); the raw magnetometer is off by up to ~40 deg, depending on
+ * the heading.
+ *
+ * The exit status is 1 if any check fails.
+ */
+
+/**
+  * @brief  Simulation Setup
+  */
+#define LOOP_HZ					417.0
+#define ODR_HZ					417.0
+#define FLIGHT_SECONDS			120.0
+#define SETTLE_SECONDS			5.0
+#define CAL_SECONDS				30U
+#define DEG						(M_PI / 180.0)
+
+#define FIELD_N_MGAUSS			216.0	// earth's field (north, west, up)
+#define FIELD_U_MGAUSS			-424.0
+#define MAG_NOISE_MGAUSS		3.0		// 1 sigma
+#define GYRO_NOISE_DPS			0.1
+#define GYRO_BIAS_DPS			0.3		// all axes
+#define ATT_NOISE_DEG			0.5		// attitude estimate error, 1 sigma
+
+#define HUB_PERIODS				4U		// odr periods per hub read
+#define FIFO_WORDS				64U
+#define TIMESTAMP_LSB_US		25.0
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+/**
+  * @brief  Hard / Soft Iron (raw = SOFT * field + HARD)
+  */
+static const double HARD_MGAUSS[3] = {150.0, -90.0, 60.0};
+static const double SOFT[3][3] = {
+	{1.08, 0.04, 0.00},
+	{0.04, 0.94, 0.02},
+	{0.00, 0.02, 1.00}
+};
+
+/**
+  * @brief  Virtual Clock (us)
+  */
+static double now;
+
+/**
+  * @brief  Fake Devices (register banks, fifo, aux bus slave, bus accounting)
+  */
+static struct {
+	uint8_t regs[128];			// user bank
+	uint8_t sh[128];			// sensor hub bank
+	uint8_t emb[128];			// embedded functions bank
+	uint8_t fifo[FIFO_WORDS][7];
+	uint32_t fifo_head;
+	uint32_t fifo_count;
+	bool fifo_overrun;
+	double next_odr_us;
+	uint32_t odr_periods;
+	int16_t gyro_raw[3];
+	int16_t accel_raw[3];
+	bool hub_pending;			// one-shot cycle armed by master_on
+	uint8_t status_master;
+	uint8_t mag[128];			// LIS2MDL
+	bool mag_present;
+	uint32_t mag_resets;
+	uint32_t nack_next;			// hub reads to nack
+	bool hub_stall;				// hub reads stop arriving
+	uint32_t loop_transactions;
+} dev;
+
+static unsigned checks;
+static unsigned failures;
+static uint32_t rng_state = 1U;
+
+
+/**
+  * @brief firmware clock on the virtual clock
+  */
+uint32_t millis(void) {
+	return (uint32_t) (now / 1000.0);
+}
+
+uint64_t micros(void) {
+	return (uint64_t) now;
+}
+
+void delay_ms(uint32_t ms) {
+	now += (double) ms * 1000.0;
+}
+
+static void check(bool cond, const char *what, int line) {
+	checks++;
+
+	if (!cond) {
+		failures++;
+		fprintf(stderr, "mag_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+/**
+  * @brief xorshift32 standard normal sample (Box-Muller)
+  */
+static double rand_normal(void) {
+	double u[2];
+
+	for (int i = 0; i < 2; ++i) {
+		rng_state ^= rng_state << 13;
+		rng_state ^= rng_state >> 17;
+		rng_state ^= rng_state << 5;
+		u[i] = ((double) (rng_state >> 8) + 1.0) / 16777216.0;
+	}
+
+	return sqrt(-2.0 * log(u[0])) * cos(6.283185307179586 * u[1]);
+}
+
+/**
+  * @brief fake LIS2MDL: register write over the aux bus
+  */
+static void mag_write(uint8_t reg, uint8_t value) {
+	if ((reg == LIS2MDL_REG_CFG_A) && (value & LIS2MDL_CFG_A_SOFT_RST)) {
+		dev.mag[LIS2MDL_REG_CFG_A] = 0x03U;		// idle
+		dev.mag[LIS2MDL_REG_CFG_B] = 0x00U;
+		dev.mag[LIS2MDL_REG_CFG_C] = 0x00U;
+		dev.mag_resets++;
+		return;
+	}
+
+	dev.mag[reg & 0x7FU] = value;
+}
+
+/**
+  * @brief fake LIS2MDL: output registers for a field (mG, body frame)
+  */
+static void mag_set_field(const double field_mgauss[3]) {
+	for (uint32_t i = 0; i < 3U; ++i) {
+		int16_t lsb = (int16_t) lround(field_mgauss[i] / LIS2MDL_MGAUSS_PER_LSB);
+
+		dev.mag[LIS2MDL_REG_OUTX_L + 2U * i] = (uint8_t) lsb;
+		dev.mag[LIS2MDL_REG_OUTX_L + 2U * i + 1U] = (uint8_t) ((uint16_t) lsb >> 8);
+	}
+}
+
+/**
+  * @brief fake LSM6DSOX: one sensor hub transaction on slave 0
+  */
+static void hub_transaction(void) {
+	uint8_t addr = dev.sh[LSM6DSOX_SLV0_ADD] >> 1;
+	bool read = dev.sh[LSM6DSOX_SLV0_ADD] & 0x01U;
+	uint8_t reg = dev.sh[LSM6DSOX_SLV0_SUBADD];
+	uint32_t len = dev.sh[LSM6DSOX_SLV0_CONFIG] & 0x07U;
+
+	if (!dev.mag_present || (addr != LIS2MDL_I2C_ADD_7BIT)) {
+		dev.status_master = 0x01U | 0x08U;		// endop, slave0_nack
+		return;
+	}
+
+	if (read)
+		memcpy(&dev.sh[LSM6DSOX_SENSOR_HUB_1], &dev.mag[reg], len);
+	else
+		mag_write(reg, dev.sh[LSM6DSOX_DATAWRITE_SLV0]);
+
+	dev.status_master = 0x01U;
+}
+
+/**
+  * @brief fake LSM6DSOX: pushes a fifo word (tag, 6 data bytes)
+  */
+static void fifo_push(uint8_t tag, const uint8_t data[6]) {
+	if (dev.fifo_count == FIFO_WORDS) {
+		dev.fifo_overrun = true;
+		return;
+	}
+
+	uint8_t *word = dev.fifo[(dev.fifo_head + dev.fifo_count) % FIFO_WORDS];
+	word[0] = (uint8_t) (tag << 3);
+	memcpy(&word[1], data, 6U);
+	dev.fifo_count++;
+}
+
+static void put_i16x3(uint8_t out[6], const int16_t v[3]) {
+	for (uint32_t i = 0; i < 3U; ++i) {
+		out[2U * i] = (uint8_t) v[i];
+		out[2U * i + 1U] = (uint8_t) ((uint16_t) v[i] >> 8);
+	}
+}
+
+/**
+  * @brief fake LSM6DSOX: batches the odr periods up to the virtual clock
+  */
+static void dev_tick(void) {
+	while (dev.next_odr_us <= now) {
+		uint32_t ticks = (uint32_t) (dev.next_odr_us / TIMESTAMP_LSB_US);
+		uint8_t data[6] = {0};
+
+		put_i16x3(data, dev.gyro_raw);
+		fifo_push(LSM6DSOX_GYRO_NC_TAG, data);
+		put_i16x3(data, dev.accel_raw);
+		fifo_push(LSM6DSOX_XL_NC_TAG, data);
+		memset(data, 0, sizeof(data));
+		memcpy(data, &ticks, sizeof(ticks));
+		fifo_push(LSM6DSOX_TIMESTAMP_TAG, data);
+
+		/* Hub reads slave 0 every fourth period, batched after the sensors */
+		if ((dev.sh[LSM6DSOX_MASTER_CONFIG] & 0x04U) && (dev.sh[LSM6DSOX_SLV0_CONFIG] & 0x08U) &&
+			((++dev.odr_periods % HUB_PERIODS) == 0U) && !dev.hub_stall) {
+			if (!dev.mag_present || dev.nack_next) {
+				if (dev.nack_next)
+					dev.nack_next--;
+				memset(data, 0, sizeof(data));
+				fifo_push(LSM6DSOX_SENSORHUB_NACK_TAG, data);
+			} else {
+				fifo_push(LSM6DSOX_SENSORHUB_SLAVE0_TAG, &dev.mag[dev.sh[LSM6DSOX_SLV0_SUBADD]]);
+			}
+		}
+
+		dev.next_odr_us += 1.0e6 / ODR_HZ;
+	}
+}
+
+/**
+  * @brief fake LSM6DSOX: register bank selected by FUNC_CFG_ACCESS
+  */
+static uint8_t* bank(uint8_t reg) {
+	if (reg == LSM6DSOX_FUNC_CFG_ACCESS)
+		return dev.regs;
+
+	switch ((dev.regs[LSM6DSOX_FUNC_CFG_ACCESS] >> 6) & 0x03U) {
+		case LSM6DSOX_SENSOR_HUB_BANK:
+			return dev.sh;
+		case LSM6DSOX_EMBEDDED_FUNC_BANK:
+			return dev.emb;
+		default:
+			return dev.regs;
+	}
+}
+
+static int32_t dev_read(uint8_t reg, uint8_t *bufp, uint16_t len) {
+	uint8_t *regs = bank(reg);
+
+	dev.loop_transactions++;
+
+	if (regs == dev.sh) {
+		if (reg == LSM6DSOX_STATUS_MASTER) {
+			if (dev.hub_pending && (dev.sh[LSM6DSOX_MASTER_CONFIG] & 0x04U)) {
+				hub_transaction();
+				dev.hub_pending = false;
+			}
+			dev.sh[LSM6DSOX_STATUS_MASTER] = dev.status_master;
+		}
+
+	} else if (regs == dev.regs) {
+		/* Fifo output address: words pop as they are read */
+		if (reg == LSM6DSOX_FIFO_DATA_OUT_TAG) {
+			for (uint16_t i = 0; i < len; i += 7U) {
+				memset(&bufp[i], 0, 7U);
+				if (dev.fifo_count) {
+					memcpy(&bufp[i], dev.fifo[dev.fifo_head], 7U);
+					dev.fifo_head = (dev.fifo_head + 1U) % FIFO_WORDS;
+					dev.fifo_count--;
+				}
+			}
+			return 0;
+		}
+
+		dev.regs[LSM6DSOX_FIFO_STATUS1] = (uint8_t) dev.fifo_count;
+		dev.regs[LSM6DSOX_FIFO_STATUS2] = (uint8_t) (((dev.fifo_count >> 8) & 0x03U) | (dev.fifo_overrun ? 0x40U : 0x00U));
+	}
+
+	memcpy(bufp, &regs[reg], len);
+
+	return 0;
+}
+
+static int32_t dev_write(uint8_t reg, const uint8_t *bufp, uint16_t len) {
+	uint8_t *regs = bank(reg);
+
+	dev.loop_transactions++;
+
+	if ((regs == dev.sh) && (reg == LSM6DSOX_MASTER_CONFIG)) {
+		if (!(dev.sh[LSM6DSOX_MASTER_CONFIG] & 0x04U) && (bufp[0] & 0x04U)) {
+			dev.hub_pending = true;
+			dev.status_master = 0x00U;
+		}
+	}
+
+	for (uint16_t i = 0; i < len; ++i)
+		regs[reg + i] = bufp[i];
+
+	if (regs == dev.regs) {
+		/* Software reset completes at once */
+		if (reg == LSM6DSOX_CTRL3_C)
+			dev.regs[LSM6DSOX_CTRL3_C] &= (uint8_t) ~0x01U;
+
+		/* Bypass mode empties the fifo */
+		if ((reg == LSM6DSOX_FIFO_CTRL4) && ((bufp[0] & 0x07U) == 0U)) {
+			dev.fifo_count = 0U;
+			dev.fifo_overrun = false;
+		}
+	}
+
+	return 0;
+}
+
+static const lsm6dsox_bus_t dev_bus = {.read = dev_read, .write = dev_write};
+
+/**
+  * @brief fake devices: power-on state
+  */
+static void dev_reset(bool mag_present) {
+	memset(&dev, 0, sizeof(dev));
+	dev.regs[LSM6DSOX_WHO_AM_I] = LSM6DSOX_ID;
+	dev.mag[LIS2MDL_REG_WHO_AM_I] = LIS2MDL_ID;
+	dev.mag[LIS2MDL_REG_CFG_A] = 0x03U;
+	dev.mag_present = mag_present;
+	dev.next_odr_us = now + 1.0e6 / ODR_HZ;
+}
+
+/**
+  * @brief runs the drivers for a number of flight loops
+  *
+  * @retval fresh mag samples
+  */
+static uint32_t run_loops(uint32_t loops, imu_6D_t *imu, mag_data_t *mag, uint32_t *warnings, uint32_t *max_transactions) {
+	uint32_t fresh = 0U;
+
+	for (uint32_t i = 0; i < loops; ++i) {
+		now += 1.0e6 / LOOP_HZ;
+		dev_tick();
+
+		dev.loop_transactions = 0U;
+		if (lsm6dsox_driver.read(imu) != IMU_OK)
+			(*warnings)++;
+
+		if (dev.loop_transactions > *max_transactions)
+			*max_transactions = dev.loop_transactions;
+
+		if (mag) {
+			if (lis2mdl_driver.read(mag) != MAG_OK)
+				(*warnings)++;
+			fresh += mag->fresh ? 1U : 0U;
+		}
+	}
+
+	return fresh;
+}
+
+/**
+  * @brief distorted raw reading of a body-frame field
+  */
+static void distort(const double field[3], double noise_mgauss, double raw[3]) {
+	for (uint32_t i = 0; i < 3U; ++i) {
+		raw[i] = HARD_MGAUSS[i] + noise_mgauss * rand_normal();
+		for (uint32_t j = 0; j < 3U; ++j)
+			raw[i] += SOFT[i][j] * field[j];
+	}
+}
+
+/**
+  * @brief earth's field in a random body orientation
+  */
+static void random_field(double field[3]) {
+	double strength = hypot(FIELD_N_MGAUSS, FIELD_U_MGAUSS);
+	double norm;
+
+	do {
+		for (uint32_t i = 0; i < 3U; ++i)
+			field[i] = rand_normal();
+		norm = sqrt(field[0] * field[0] + field[1] * field[1] + field[2] * field[2]);
+	} while (norm < 1e-6);
+
+	for (uint32_t i = 0; i < 3U; ++i)
+		field[i] *= strength / norm;
+}
+
+/**
+  * @brief largest deviation of soft_iron * SOFT from a scaled identity
+  * 	   (share of the scale)
+  */
+static double soft_iron_error(const mag_calibration_t *cal) {
+	double m[3][3], scale = 0.0, err = 0.0;
+
+	for (uint32_t i = 0; i < 3U; ++i) {
+		for (uint32_t j = 0; j < 3U; ++j) {
+			m[i][j] = 0.0;
+			for (uint32_t k = 0; k < 3U; ++k)
+				m[i][j] += (double) cal->soft_iron[i][k] * SOFT[k][j];
+		}
+		scale += m[i][i] / 3.0;
+	}
+
+	for (uint32_t i = 0; i < 3U; ++i)
+		for (uint32_t j = 0; j < 3U; ++j)
+			err = fmax(err, fabs(m[i][j] - ((i == j) ? scale : 0.0)) / scale);
+
+	return err;
+}
+
+/**
+  * @brief device, hub, fifo and fit checks; then a calibration session
+  */
+static void run_checks(void) {
+	imu_6D_t imu = {0};
+	mag_data_t mag = {0};
+	uint32_t warnings = 0U, max_tr = 0U, max_tr_hub = 0U, fresh;
+	double offset_err = 0.0, soft_err;
+	double dt_sum = 0.0;
+	uint32_t dt_n = 0U;
+	bool dt_ok = true;
+	mag_cal_t cal;
+	mag_cal_fit_t fit;
+	mag_cal_report_t report;
+
+	lsm6dsox_set_bus(&dev_bus);
+
+	/* Absent magnetometer: init fails, the imu keeps reading in two transactions */
+	dev_reset(false);
+	CHECK(lsm6dsox_driver.init() == IMU_OK);
+	CHECK(lis2mdl_driver.init() == MAG_ERROR_FATAL);
+	run_loops(100U, &imu, NULL, &warnings, &max_tr);
+	CHECK(warnings == 0U);
+	CHECK(max_tr == 2U);
+
+	/* Imu alone: sample contents and time step from the fifo timestamps */
+	dev_reset(true);
+	dev.gyro_raw[0] = 100; dev.gyro_raw[1] = -200; dev.gyro_raw[2] = 300;
+	dev.accel_raw[0] = 1000; dev.accel_raw[1] = -2000; dev.accel_raw[2] = 16384;
+	CHECK(lsm6dsox_driver.init() == IMU_OK);
+	max_tr = 0U;
+	for (uint32_t i = 0; i < 200U; ++i) {
+		imu.dt = 0U;
+		run_loops(1U, &imu, NULL, &warnings, &max_tr);
+		if (i < 2U)
+			continue;
+		dt_ok &= (imu.dt == 2375U) || (imu.dt == 2400U);
+		dt_sum += (double) imu.dt;
+		dt_n++;
+	}
+	CHECK(warnings == 0U);
+	CHECK(max_tr == 2U);
+	CHECK(dt_ok);
+	CHECK(fabs(dt_sum / dt_n - 1.0e6 / ODR_HZ) < 15.0);
+	CHECK(fabsf(imu.rate_x - lsm6dsox_from_fs2000_to_mdps(100)) < 1e-3f);
+	CHECK(fabsf(imu.rate_z - lsm6dsox_from_fs2000_to_mdps(300)) < 1e-3f);
+	CHECK(fabsf(imu.accel_y - lsm6dsox_from_fs16_to_mg(-2000)) < 1e-3f);
+	CHECK(fabsf(imu.accel_z - lsm6dsox_from_fs16_to_mg(16384)) < 1e-3f);
+
+	/* Magnetometer setup through one-shot hub transactions */
+	CHECK(lis2mdl_driver.init() == MAG_OK);
+	CHECK(dev.mag_resets == 1U);
+	CHECK(dev.mag[LIS2MDL_REG_CFG_A] == LIS2MDL_CFG_A_VALUE);
+	CHECK(dev.mag[LIS2MDL_REG_CFG_B] == LIS2MDL_CFG_B_VALUE);
+	CHECK(dev.mag[LIS2MDL_REG_CFG_C] == LIS2MDL_CFG_C_VALUE);
+	CHECK(dev.sh[LSM6DSOX_SLV0_SUBADD] == LIS2MDL_REG_OUTX_L);
+	CHECK(lsm6dsox_hub_write(LIS2MDL_I2C_ADD_7BIT, LIS2MDL_REG_CFG_A, 0U) == IMU_ERROR_FATAL);	// attached
+
+	/* Hub samples arrive with the fifo burst at 104 Hz, no extra transactions */
+	mag_set_field((const double[3]){300.0, -150.0, -451.5});
+	warnings = 0U;
+	fresh = run_loops((uint32_t) LOOP_HZ, &imu, &mag, &warnings, &max_tr_hub);
+	CHECK(warnings == 0U);
+	CHECK(max_tr_hub == 2U);
+	CHECK(abs((int) fresh - (int) (LOOP_HZ / HUB_PERIODS)) <= 1);
+	CHECK(mag.raw_mgauss[0] == 300.0f);
+	CHECK(mag.raw_mgauss[1] == -150.0f);
+	CHECK(mag.raw_mgauss[2] == -451.5f);
+
+	/* A nack is warned once */
+	dev.nack_next = 1U;
+	warnings = 0U;
+	fresh = run_loops(100U, &imu, &mag, &warnings, &max_tr_hub);
+	CHECK(warnings == 1U);
+	CHECK(fresh >= 22U);
+
+	/* A stalled hub is warned once (~100 ms), then picked up again */
+	dev.hub_stall = true;
+	warnings = 0U;
+	fresh = run_loops(200U, &imu, &mag, &warnings, &max_tr_hub);
+	CHECK(fresh == 0U);
+	CHECK(warnings == 1U);
+	dev.hub_stall = false;
+	warnings = 0U;
+	fresh = run_loops(100U, &imu, &mag, &warnings, &max_tr_hub);
+	CHECK(warnings == 0U);
+	CHECK(fresh >= 24U);
+
+	/* Detached: imu alone again */
+	CHECK(lis2mdl_driver.deinit() == MAG_OK);
+	fresh = run_loops(100U, &imu, &mag, &warnings, &max_tr_hub);
+	CHECK(fresh == 0U);
+	CHECK(!(dev.sh[LSM6DSOX_MASTER_CONFIG] & 0x04U));
+
+	lsm6dsox_set_bus(NULL);
+
+	/* Fit: offset and soft iron recovered from readings in all orientations */
+	mag_cal_reset(&cal);
+	for (uint32_t i = 0; i < 2000U; ++i) {
+		double field[3], raw[3];
+
+		random_field(field);
+		distort(field, MAG_NOISE_MGAUSS, raw);
+		mag_cal_add(&cal, (const float[3]){(float) raw[0], (float) raw[1], (float) raw[2]});
+	}
+	CHECK(mag_cal_solve(&cal, &fit) == MAG_CAL_OK);
+	for (uint32_t i = 0; i < 3U; ++i)
+		offset_err = fmax(offset_err, fabs(fit.cal.offset_mgauss[i] - HARD_MGAUSS[i]));
+	soft_err = soft_iron_error(&fit.cal);
+	CHECK(offset_err < 3.0);
+	CHECK(soft_err < 0.01);
+	CHECK(fit.fit_error_pct < 1.5f);
+	CHECK(fabsf(fit.field_mgauss - (float) hypot(FIELD_N_MGAUSS, FIELD_U_MGAUSS)) < 0.05f * fit.field_mgauss);
+
+	/* Fit refused: turned about the vertical only */
+	mag_cal_reset(&cal);
+	for (uint32_t i = 0; i < 2000U; ++i) {
+		double yaw = 2.0 * M_PI * i / 2000.0, raw[3];
+		double field[3] = {FIELD_N_MGAUSS * cos(yaw), -FIELD_N_MGAUSS * sin(yaw), FIELD_U_MGAUSS};
+
+		distort(field, MAG_NOISE_MGAUSS, raw);
+		mag_cal_add(&cal, (const float[3]){(float) raw[0], (float) raw[1], (float) raw[2]});
+	}
+	CHECK(mag_cal_solve(&cal, &fit) == MAG_CAL_POOR_COVERAGE);
+
+	/* Fit refused: too few readings */
+	mag_cal_reset(&cal);
+	for (uint32_t i = 0; i < 50U; ++i) {
+		double field[3], raw[3];
+
+		random_field(field);
+		distort(field, MAG_NOISE_MGAUSS, raw);
+		mag_cal_add(&cal, (const float[3]){(float) raw[0], (float) raw[1], (float) raw[2]});
+	}
+	CHECK(mag_cal_solve(&cal, &fit) == MAG_CAL_TOO_FEW_SAMPLES);
+
+	/* Session through mag.c (simulated device): fit stored in the parameters */
+	CHECK(mag_init() == MAG_OK);
+	CHECK(mag_calibration_start(CAL_SECONDS));
+	CHECK(mag_calibration_is_running());
+	CHECK(!mag_calibration_start(0U));
+	for (uint32_t i = 0; mag_calibration_is_running() && (i < (CAL_SECONDS + 1U) * (uint32_t) LOOP_HZ); ++i) {
+		now += 1.0e6 / LOOP_HZ;
+		if ((i % HUB_PERIODS) == 0U) {
+			double field[3], raw[3];
+
+			random_field(field);
+			distort(field, MAG_NOISE_MGAUSS, raw);
+			sim_mag_set_sample((const float[3]){(float) raw[0], (float) raw[1], (float) raw[2]});
+		}
+		mag_read(&mag);
+	}
+	mag_calibration_get(&report);
+	CHECK(report.state == MAG_CAL_STATE_DONE);
+	CHECK(report.result == MAG_CAL_OK);
+	CHECK(fabsf(params_get_float(PARAM_MAG_OFFSET_X) - (float) HARD_MGAUSS[0]) < 3.0f);
+	CHECK(fabsf(params_get_float(PARAM_MAG_OFFSET_Z) - (float) HARD_MGAUSS[2]) < 3.0f);
+
+	/* Calibrated readings: the field strength in any orientation */
+	{
+		double err_max = 0.0;
+
+		for (uint32_t i = 0; i < 100U; ++i) {
+			double field[3], raw[3];
+
+			random_field(field);
+			distort(field, 0.0, raw);
+			sim_mag_set_sample((const float[3]){(float) raw[0], (float) raw[1], (float) raw[2]});
+			mag_read(&mag);
+			err_max = fmax(err_max, fabs(hypotf(hypotf(mag.field_mgauss[0], mag.field_mgauss[1]), mag.field_mgauss[2]) -
+											 report.fit.field_mgauss) / report.fit.field_mgauss);
+		}
+		CHECK(err_max < 0.01);
+	}
+
+	printf("{\"mode\": \"checks\", \"checks\": %u, \"failed\": %u, \"imu_read_transactions\": %u, "
+		   "\"imu_read_transactions_hub\": %u, \"dt_mean_us\": %.1f, \"fit_offset_err_mgauss\": %.2f, "
+		   "\"fit_soft_iron_err\": %.4f, \"session_samples\": %lu, \"session_fit_error_pct\": %.2f, "
+		   "\"session_axis_ratio\": %.3f}\n",
+		   checks, failures, max_tr, max_tr_hub, dt_sum / dt_n, offset_err, soft_err,
+		   (unsigned long) report.fit.samples, report.fit.fit_error_pct, report.fit.axis_ratio);
+}
+
+/**
+  * @brief heading error statistics
+  */
+typedef struct {
+	double sq_sum;
+	double max;
+	uint32_t n;
+} heading_err_t;
+
+static void heading_err_add(heading_err_t *e, const attitude_est_t *est, double truth_deg) {
+	double err = fmod(est->heading_deg - truth_deg + 540.0, 360.0) - 180.0;
+
+	e->sq_sum += err * err;
+	e->max = fmax(e->max, fabs(err));
+	e->n++;
+}
+
+/**
+  * @brief heading flight: calibrated magnetometer, raw magnetometer and gyro
+  * 	   alone through flight/attitude.c
+  */
+static void run_flight(void) {
+	attitude_est_t fused = {0}, raw_est = {0}, gyro = {0};
+	heading_err_t fused_err = {0}, raw_err = {0}, gyro_err = {0};
+	mag_data_t mag = {0}, raw_mag = {0}, no_mag = {0};
+	imu_6D_t imu = {0};
+	double yaw = 0.0;		// counter-clockwise from north
+	double dt = 1.0 / LOOP_HZ;
+	uint32_t loops = (uint32_t) (FLIGHT_SECONDS * LOOP_HZ);
+
+	imu.dt = (uint32_t) lround(dt * 1e6);
+
+	for (uint32_t i = 0; i < loops; ++i) {
+		double t = i * dt;
+		double w = 2.0 * M_PI;
+
+		/* Turns, banking */
+		double yaw_rate = (40.0 * sin(w * t / 25.0) + 20.0 * sin(w * t / 9.0)) * DEG;
+		double roll = 15.0 * DEG * sin(w * t / 7.0);
+		double pitch = 10.0 * DEG * sin(w * t / 11.0 + 1.0);
+		double roll_rate = 15.0 * DEG * (w / 7.0) * cos(w * t / 7.0);
+		double pitch_rate = 10.0 * DEG * (w / 11.0) * cos(w * t / 11.0 + 1.0);
+		double sr = sin(roll), cr = cos(roll), sp = sin(pitch), cp = cos(pitch);
+
+		/* Body rates (FLU) from the euler rates */
+		double p = roll_rate - yaw_rate * sp;
+		double q = pitch_rate * cr + yaw_rate * sr * cp;
+		double r = -pitch_rate * sr + yaw_rate * cr * cp;
+
+		yaw += yaw_rate * dt;
+
+		imu.rate_x = (float) ((p / DEG + GYRO_BIAS_DPS + GYRO_NOISE_DPS * rand_normal()) * 1000.0);
+		imu.rate_y = (float) ((q / DEG + GYRO_BIAS_DPS + GYRO_NOISE_DPS * rand_normal()) * 1000.0);
+		imu.rate_z = (float) ((r / DEG + GYRO_BIAS_DPS + GYRO_NOISE_DPS * rand_normal()) * 1000.0);
+
+		/* Attitude estimate (roll, pitch) as the estimator would hold it */
+		fused.roll_angle_deg = (float) (roll / DEG + ATT_NOISE_DEG * rand_normal());
+		fused.pitch_angle_deg = (float) (pitch / DEG + ATT_NOISE_DEG * rand_normal());
+		raw_est.roll_angle_deg = gyro.roll_angle_deg = fused.roll_angle_deg;
+		raw_est.pitch_angle_deg = gyro.pitch_angle_deg = fused.pitch_angle_deg;
+
+		/* Earth's field in the body frame at the hub rate (yaw, then pitch, then roll) */
+		if ((i % HUB_PERIODS) == 0U) {
+			double sy = sin(yaw), cy = cos(yaw);
+			double n = FIELD_N_MGAUSS, u = FIELD_U_MGAUSS;
+			double l1[3] = {cy * n, -sy * n, u};
+			double l2[3] = {cp * l1[0] - sp * l1[2], l1[1], sp * l1[0] + cp * l1[2]};
+			double body[3] = {l2[0], cr * l2[1] + sr * l2[2], -sr * l2[1] + cr * l2[2]};
+			double raw[3];
+
+			distort(body, MAG_NOISE_MGAUSS, raw);
+			sim_mag_set_sample((const float[3]){(float) raw[0], (float) raw[1], (float) raw[2]});
+		}
+
+		mag_read(&mag);
+		raw_mag = mag;
+		memcpy(raw_mag.field_mgauss, mag.raw_mgauss, sizeof(raw_mag.field_mgauss));
+
+		attitude_heading_update(&imu, &mag, &fused);
+		attitude_heading_update(&imu, &raw_mag, &raw_est);
+		attitude_heading_update(&imu, &no_mag, &gyro);
+
+		if (t >= SETTLE_SECONDS) {
+			double truth = fmod(-yaw / DEG + 720.0, 360.0);
+
+			heading_err_add(&fused_err, &fused, truth);
+			heading_err_add(&raw_err, &raw_est, truth);
+			heading_err_add(&gyro_err, &gyro, truth);
+		}
+	}
+
+	CHECK(fused.heading_valid);
+	CHECK(!gyro.heading_valid);
+	CHECK(sqrt(fused_err.sq_sum / fused_err.n) < 2.0);
+	CHECK(fused_err.sq_sum < raw_err.sq_sum);
+	CHECK(fused_err.sq_sum < gyro_err.sq_sum);
+
+	printf("{\"mode\": \"flight\", \"seconds\": %.0f, \"fused_rms_deg\": %.2f, \"fused_max_deg\": %.2f, "
+		   "\"raw_rms_deg\": %.2f, \"raw_max_deg\": %.2f, \"gyro_rms_deg\": %.2f, \"gyro_max_deg\": %.2f}\n",
+		   FLIGHT_SECONDS, sqrt(fused_err.sq_sum / fused_err.n), fused_err.max,
+		   sqrt(raw_err.sq_sum / raw_err.n), raw_err.max,
+		   sqrt(gyro_err.sq_sum / gyro_err.n), gyro_err.max);
+}
+
+int main(int argc, char **argv) {
+	(void) argv;
+
+	if (argc > 1) {
+		fprintf(stderr, "usage: %s\n", argv[0]);
+		return 2;
+	}
+
+	/* Calibration and heading settings from the parameter defaults */
+	ram_param_flash_format();
+	if (params_init() == PARAM_ERROR_FATAL)
+		return 2;
+	attitude_controller_init();
+
+	run_checks();
+	run_flight();
+
+	return failures ? 1 : 0;
+}
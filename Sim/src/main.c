@@ -0,0 +1,460 @@
+/*
+ * main.c (SITL command line)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sitl.h"
+#include "params/params.h"
+
+/**
+  * @brief  Scenario Constants
+  */
+#define ARM_TIME_S			0.5f	// sticks idle, arm switch flipped here
+#define HOVER_ALT_M			1.5f
+#define CRASH_TILT_DEG		75.0f
+#define SETTLE_TIME_S		4.0f	// metrics start once the climb has settled
+
+#define STEP_ANGLE_DEG		8.0f	// within the default rc angle range
+#define STEP_LEN_S			0.5f
+#define STEP_ROLL_T_S		5.0f
+#define STEP_PITCH_T_S		7.0f
+#define STEP_YAW_T_S		9.0f
+
+#define ALT_HOLD_T_S		4.5f	// alt hold: switched in here, throttle stick centered..
+#define CLIMB_T_S			8.0f	// ..full stick climb..
+#define CLIMB_LEN_S			0.5f
+#define CLIMB_SETTLE_S		1.5f	// ..not scored until settled..
+#define ALT_EXIT_T_S		10.5f	// ..and back to angle mode (stick pilot)
+
+#define CRASH_IRQ_T_S		5.0f	// crash: isr fired inside a motor command write here..
+#define CRASH_ACK_T_S		6.5f	// ..arm switch off here (latch cleared)..
+#define CRASH_ACK_LEN_S		0.5f	// ..and on again after this long (flies again)
+
+#define FUZZ_HOLD_MIN_S		0.05f	// random stick inputs are held this long..
+#define FUZZ_HOLD_MAX_S		0.5f	// ..up to this long
+
+/**
+  * @brief  Scenario Type
+  */
+typedef enum {
+	SCENARIO_HOVER,
+	SCENARIO_STEP,
+	SCENARIO_ALT_HOLD,	// steps flown in altitude hold, one climb, then back to the stick
+	SCENARIO_FUZZ,		// random sticks and mode switches (invariant checks only)
+	SCENARIO_CRASH		// hover, crash isr inside a motor write, arm switch reset, hover again
+} scenario_t;
+
+/**
+  * @brief  Run Metrics
+  */
+typedef struct {
+	float max_tilt_deg;
+	float sq_err_deg;			// squared attitude tracking error (sum)
+	float max_alt_err_m;		// after settling (alt hold: vs the held altitude)
+	float max_thr_step_pct;		// largest applied throttle change in one loop, after settling
+	float hover_thr_pct;		// learned by the firmware, end of run
+	float sq_alt_est_err_m;		// squared altitude estimation error (sum)
+	float sq_pos_est_err_m;		// squared horizontal position estimation error (sum)
+	uint32_t pos_samples;		// ..while the position estimate is valid
+	float sq_hdg_est_err_deg;	// squared heading estimation error (sum)
+	uint32_t hdg_samples;		// ..while the heading estimate is valid
+	uint32_t samples;
+	uint32_t violations;		// flight code invariants (see sitl.h)
+	const char *violation;
+	double violation_s;
+	bool flew;
+	bool crashed;
+	uint32_t crash_disarms;		// crash scenario: isr disarms..
+	uint32_t motors_after_cut;	// ..loops with a motor above minimum while latched..
+	bool flew_after_cut;		// ..and flying again after the arm switch reset
+} metrics_t;
+
+/**
+  * @brief  Parameter Override (NAME=VALUE on the command line)
+  */
+typedef struct {
+	const char *name;
+	float value;
+} override_t;
+
+#define OVERRIDES_MAX		32U
+
+/**
+  * @brief  Fuzz Pilot State (reseeded per run)
+  */
+static uint32_t fuzz_state = 1U;
+static mode_status_t fuzz_mode_high;
+
+
+/**
+  * @brief helper function: xorshift32 uniform sample in [-1, 1]
+  *
+  * @retval sample
+  */
+static float fuzz_uniform(void) {
+	fuzz_state ^= fuzz_state << 13;
+	fuzz_state ^= fuzz_state >> 17;
+	fuzz_state ^= fuzz_state << 5;
+	return (float)(fuzz_state >> 8) / 8388607.5f - 1.0f;
+}
+
+/**
+  * @brief helper function to map a normalized stick deflection to a pulse width
+  *
+  * @param  x		deflection (-1..1, 0 centered)
+  * @retval pulse width (us)
+  */
+static uint32_t stick_us(float x) {
+	float min = (float) params_get_u32(PARAM_RC_PULSE_MIN_US);
+	float max = (float) params_get_u32(PARAM_RC_PULSE_MAX_US);
+
+	x = fminf(fmaxf(x, -1.0f), 1.0f);
+	return (uint32_t) lroundf(0.5f * (min + max) + x * 0.5f * (max - min));
+}
+
+/**
+  * @brief helper function to run the scripted pilot for one flight loop:
+  * 	   arms, climbs to and holds HOVER_ALT_M with the throttle stick, and
+  * 	   (step scenario) applies attitude and yaw steps; the alt hold scenario
+  * 	   flies the steps in altitude hold with the stick centered
+  *
+  * @param  scenario	scenario being flown
+  * @param	s			read-only pointer to current state
+  * @param	dt			flight loop period (s)
+  * @param	roll_ref	roll angle reference buffer (deg, for tracking error)
+  * @param	pitch_ref	pitch angle reference buffer (deg, for tracking error)
+  * @param	alt_ref		altitude reference buffer (m, NAN while not scored)
+  *
+  * @retval None
+  */
+static void pilot(scenario_t scenario, const sitl_state_t *s, float dt, float *roll_ref, float *pitch_ref,
+				  float *alt_ref) {
+	static float alt_integral;
+	sitl_rc_t rc = {.roll_us = stick_us(0.0f), .pitch_us = stick_us(0.0f), .yaw_us = stick_us(0.0f),
+					.throttle_us = stick_us(-1.0f), .arm = false, .mode = ANGLE_MODE};
+	float t = (float) s->time_s;
+	float roll = 0.0f, pitch = 0.0f, yaw = 0.0f;
+
+	*roll_ref = 0.0f;
+	*pitch_ref = 0.0f;
+	*alt_ref = HOVER_ALT_M;
+
+	if (t < ARM_TIME_S) {
+		alt_integral = 0.0f;
+		sitl_set_rc(&rc);
+		return;
+	}
+
+	rc.arm = !((scenario == SCENARIO_CRASH) && (t >= CRASH_ACK_T_S) && (t < CRASH_ACK_T_S + CRASH_ACK_LEN_S));
+
+	if ((scenario == SCENARIO_ALT_HOLD) && (t >= ALT_HOLD_T_S) && (t < ALT_EXIT_T_S)) {
+		/* Firmware altitude hold: stick centered, one full stick climb */
+		bool climbing = (t >= CLIMB_T_S) && (t < CLIMB_T_S + CLIMB_LEN_S);
+		bool settling = (t >= CLIMB_T_S) && (t < CLIMB_T_S + CLIMB_SETTLE_S);
+
+		rc.mode = ALT_HOLD_MODE;
+		rc.throttle_us = stick_us(climbing ? 1.0f : 0.0f);
+		*alt_ref = (s->flight.alt_cmd.engaged && !settling) ? s->flight.alt_cmd.target_alt_m : NAN;
+
+	} else if (s->status.phase == FLIGHT_PHASE_FLYING) {
+		/* Altitude hold on the throttle stick (PI + velocity damping) */
+		float err = HOVER_ALT_M - s->quad.pos_m[2];
+		alt_integral = fminf(fmaxf(alt_integral + err * dt, -2.0f), 2.0f);
+		rc.throttle_us = stick_us(-0.2f + 0.35f * err + 0.25f * alt_integral - 0.3f * s->quad.vel_mps[2]);
+		if ((scenario == SCENARIO_ALT_HOLD) && (t >= ALT_EXIT_T_S))
+			*alt_ref = NAN;
+	}
+
+	if ((scenario == SCENARIO_STEP) || (scenario == SCENARIO_ALT_HOLD)) {
+		if ((t >= STEP_ROLL_T_S) && (t < STEP_ROLL_T_S + STEP_LEN_S))
+			roll = STEP_ANGLE_DEG;
+		else if ((t >= STEP_PITCH_T_S) && (t < STEP_PITCH_T_S + STEP_LEN_S))
+			pitch = -STEP_ANGLE_DEG;
+		else if ((t >= STEP_YAW_T_S) && (t < STEP_YAW_T_S + STEP_LEN_S))
+			yaw = 0.5f;
+	}
+
+	rc.roll_us = stick_us(roll / params_get_float(PARAM_RC_ROLL_MAX_DEG));
+	rc.pitch_us = stick_us(pitch / params_get_float(PARAM_RC_PITCH_MAX_DEG));
+	rc.yaw_us = stick_us(yaw);
+
+	*roll_ref = roll;
+	*pitch_ref = pitch;
+
+	sitl_set_rc(&rc);
+}
+
+/**
+  * @brief helper function to run the fuzz pilot for one flight loop: arms
+  * 	   with idle sticks, then random stick deflections and mode held for
+  * 	   random durations, occasionally flipping the arm switch off
+  *
+  * @param  s			read-only pointer to current state
+  * @param	dt			flight loop period (s)
+  *
+  * @retval None
+  */
+static void fuzz_pilot(const sitl_state_t *s, float dt) {
+	static sitl_rc_t rc;
+	static float hold_s;
+
+	if (s->loops == 0U)
+		hold_s = 0.0f;
+
+	hold_s -= dt;
+	if (hold_s > 0.0f)
+		return;
+
+	hold_s = FUZZ_HOLD_MIN_S + 0.5f * (fuzz_uniform() + 1.0f) * (FUZZ_HOLD_MAX_S - FUZZ_HOLD_MIN_S);
+
+	/* Not flying: idle sticks, arm switch toggled (reset) once the arm time has passed */
+	if (s->status.phase != FLIGHT_PHASE_FLYING) {
+		rc = (sitl_rc_t){.roll_us = stick_us(0.0f), .pitch_us = stick_us(0.0f), .yaw_us = stick_us(0.0f),
+						 .throttle_us = stick_us(-1.0f), .mode = ANGLE_MODE,
+						 .arm = ((float) s->time_s >= ARM_TIME_S) && !rc.arm};
+	} else {
+		rc.roll_us = stick_us(fuzz_uniform());
+		rc.pitch_us = stick_us(fuzz_uniform());
+		rc.throttle_us = stick_us(fuzz_uniform());
+		rc.yaw_us = stick_us(fuzz_uniform());
+		rc.mode = (fuzz_uniform() < 0.0f) ? ANGLE_MODE : fuzz_mode_high;
+		rc.arm = (fuzz_uniform() > -0.9f);
+	}
+
+	sitl_set_rc(&rc);
+}
+
+/**
+  * @brief helper function to run one scenario
+  *
+  * @retval sitl status
+  */
+static sitl_status_t run(scenario_t scenario, float duration_s, const sitl_config_t *cfg,
+						 const override_t *ov, uint32_t ov_count,
+						 const char *trace_path, sitl_trace_format_t format, metrics_t *m) {
+	sitl_status_t status;
+	sitl_state_t s;
+	esc_cmd_props_t esc_props;
+	float roll_ref, pitch_ref, alt_ref, prev_throttle = 0.0f;
+	bool crash_fired = false;
+	uint32_t loops = (uint32_t)(duration_s * (float) cfg->loop_hz);
+
+	memset(m, 0, sizeof(*m));
+	fuzz_state = cfg->seed ? cfg->seed : 1U;
+
+	if (sitl_init(cfg) == SITL_ERROR_FATAL)
+		return SITL_ERROR_FATAL;
+
+	/* Mode switch high: alt hold when flown, alternating per seed when fuzzed */
+	fuzz_mode_high = (fuzz_state & 1U) ? ALT_HOLD_MODE : RATE_MODE;
+	if ((scenario == SCENARIO_ALT_HOLD) || ((scenario == SCENARIO_FUZZ) && (fuzz_mode_high == ALT_HOLD_MODE)))
+		sitl_set_param("RC_MODE_SW_HIGH", (float) ALT_HOLD_MODE);
+
+	for (uint32_t i = 0; i < ov_count; ++i) {
+		if (sitl_set_param(ov[i].name, ov[i].value) != SITL_OK) {
+			fprintf(stderr, "rejected %s=%g\n", ov[i].name, (double) ov[i].value);
+			return SITL_ERROR_FATAL;
+		}
+	}
+
+	if (trace_path && (sitl_trace_open(trace_path, format) != SITL_OK)) {
+		fprintf(stderr, "cannot open %s\n", trace_path);
+		return SITL_ERROR_FATAL;
+	}
+
+	esc_get_command_properties(&esc_props);
+
+	status = SITL_OK;
+	for (uint32_t n = 0; n < loops; ++n) {
+		sitl_get_state(&s);
+		if (scenario == SCENARIO_FUZZ) {
+			fuzz_pilot(&s, 1.0f / (float) cfg->loop_hz);
+			roll_ref = s.roll_deg;
+			pitch_ref = s.pitch_deg;
+			alt_ref = NAN;
+		} else {
+			pilot(scenario, &s, 1.0f / (float) cfg->loop_hz, &roll_ref, &pitch_ref, &alt_ref);
+		}
+
+		if ((scenario == SCENARIO_CRASH) && !crash_fired && (s.time_s >= CRASH_IRQ_T_S)) {
+			sitl_crash_irq_at_write();
+			crash_fired = true;
+		}
+
+		if (sitl_step(1U) != SITL_OK)
+			status = SITL_ERROR_WARN;
+
+		sitl_get_state(&s);
+		if (s.crash_latched && ((s.esc.esc1 > esc_props.min) || (s.esc.esc2 > esc_props.min) ||
+								(s.esc.esc3 > esc_props.min) || (s.esc.esc4 > esc_props.min)))
+			m->motors_after_cut++;
+		m->flew_after_cut |= crash_fired && (s.time_s > CRASH_ACK_T_S + CRASH_ACK_LEN_S) &&
+							 (s.status.phase == FLIGHT_PHASE_FLYING) && !s.quad.on_ground;
+		float tilt = fmaxf(fabsf(s.roll_deg), fabsf(s.pitch_deg));
+		m->max_tilt_deg = fmaxf(m->max_tilt_deg, tilt);
+		m->flew |= !s.quad.on_ground;
+		m->crashed |= (tilt > CRASH_TILT_DEG);
+
+		if (s.time_s > SETTLE_TIME_S) {
+			float er = s.roll_deg - roll_ref;
+			float ep = s.pitch_deg - pitch_ref;
+			m->sq_err_deg += er * er + ep * ep;
+			if (!isnan(alt_ref))
+				m->max_alt_err_m = fmaxf(m->max_alt_err_m, fabsf(s.quad.pos_m[2] - alt_ref));
+			m->max_thr_step_pct = fmaxf(m->max_thr_step_pct, fabsf(s.flight.alt_cmd.throttle - prev_throttle));
+			float ea = s.flight.alt.altitude_m - s.quad.pos_m[2];	// ground at z = 0
+			m->sq_alt_est_err_m += ea * ea;
+			if (s.flight.pos.valid) {
+				float ne[2];
+				sitl_true_position_ne(&s, ne);
+				float en = s.flight.pos.pos_m[0] - ne[0];
+				float ee = s.flight.pos.pos_m[1] - ne[1];
+				m->sq_pos_est_err_m += en * en + ee * ee;
+				++m->pos_samples;
+			}
+			if (s.flight.est.heading_valid) {
+				/* True heading is clockwise from north, model yaw counter-clockwise */
+				float eh = fmodf(s.flight.est.heading_deg + s.yaw_deg + 540.0f, 360.0f) - 180.0f;
+				m->sq_hdg_est_err_deg += eh * eh;
+				++m->hdg_samples;
+			}
+			++m->samples;
+		}
+		prev_throttle = s.flight.alt_cmd.throttle;
+	}
+
+	sitl_get_state(&s);
+	m->hover_thr_pct = s.flight.alt_cmd.hover_throttle;
+	m->crash_disarms = s.crash_disarms;
+	m->violations = s.violations;
+	m->violation = s.violation;
+	m->violation_s = (double) s.violation_loop / (double) cfg->loop_hz;
+
+	sitl_trace_close();
+
+	return status;
+}
+
+static void usage(const char *argv0) {
+	fprintf(stderr,
+			"usage: %s [-s hover|step|althold|fuzz|crash] [-t seconds] [-o trace] [-f csv|bin|link] [-n runs]\n"
+			"          [-r loop_hz] [-e seed] [-q] [NAME=VALUE ...]\n"
+			"  NAME=VALUE overrides a registry parameter (e.g. ROLL_RATE_P=0.4)\n"
+			"  exit status is non-zero if the quad never flew or exceeded %.0f deg tilt (hover, step, althold)\n"
+			"  or if the flight code broke an invariant (any scenario, see sitl.h); crash fails if a motor\n"
+			"  ran after the crash isr cut them, or the quad did not fly again after the arm switch reset\n",
+			argv0, (double) CRASH_TILT_DEG);
+}
+
+int main(int argc, char **argv) {
+	scenario_t scenario = SCENARIO_STEP;
+	sitl_trace_format_t format = SITL_TRACE_CSV;
+	const char *trace_path = NULL;
+	float duration_s = 12.0f;
+	uint32_t runs = 1U;
+	bool quiet = false;
+	override_t ov[OVERRIDES_MAX];
+	uint32_t ov_count = 0U;
+	sitl_config_t cfg;
+	metrics_t m;
+	int fail = 0;
+
+	sitl_default_config(&cfg);
+
+	for (int i = 1; i < argc; ++i) {
+		const char *a = argv[i];
+		const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+		char *eq = strchr(a, '=');
+
+		if (eq && (a[0] != '-') && (ov_count < OVERRIDES_MAX)) {
+			*eq = '\0';
+			ov[ov_count].name = a;
+			ov[ov_count].value = strtof(eq + 1, NULL);
+			++ov_count;
+			continue;
+		}
+
+		if (!strcmp(a, "-q")) {
+			quiet = true;
+			continue;
+		}
+
+		if (!v || (a[0] != '-')) {
+			usage(argv[0]);
+			return 2;
+		}
+		++i;
+
+		if (!strcmp(a, "-s"))
+			scenario = !strcmp(v, "hover") ? SCENARIO_HOVER : !strcmp(v, "fuzz") ? SCENARIO_FUZZ :
+					   !strcmp(v, "althold") ? SCENARIO_ALT_HOLD : !strcmp(v, "crash") ? SCENARIO_CRASH :
+					   SCENARIO_STEP;
+		else if (!strcmp(a, "-t"))
+			duration_s = strtof(v, NULL);
+		else if (!strcmp(a, "-o"))
+			trace_path = v;
+		else if (!strcmp(a, "-f"))
+			format = !strcmp(v, "bin") ? SITL_TRACE_BINARY : !strcmp(v, "link") ? SITL_TRACE_LINK : SITL_TRACE_CSV;
+		else if (!strcmp(a, "-n"))
+			runs = (uint32_t) strtoul(v, NULL, 10);
+		else if (!strcmp(a, "-r"))
+			cfg.loop_hz = (uint32_t) strtoul(v, NULL, 10);
+		else if (!strcmp(a, "-e"))
+			cfg.seed = (uint32_t) strtoul(v, NULL, 10);
+		else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+
+	clock_t start = clock();
+
+	for (uint32_t r = 0; r < runs; ++r) {
+		/* Only the first run is traced; each run gets its own noise seed */
+		sitl_status_t status = run(scenario, duration_s, &cfg, ov, ov_count, (r == 0U) ? trace_path : NULL, format, &m);
+		++cfg.seed;
+
+		if (status == SITL_ERROR_FATAL)
+			return 2;
+
+		/* Fuzzed sticks may well crash; only the invariants must hold */
+		bool failed = (m.violations != 0U) || ((scenario != SCENARIO_FUZZ) && (!m.flew || m.crashed));
+		if (scenario == SCENARIO_CRASH)
+			failed |= (m.crash_disarms != 1U) || (m.motors_after_cut != 0U) || !m.flew_after_cut;
+		if (failed)
+			fail = 1;
+
+		if (!quiet) {
+			printf("run %u: %s max_tilt=%.2f deg att_rms=%.3f deg max_alt_err=%.3f m alt_est_rms=%.3f m pos_est_rms=%.3f m hdg_est_rms=%.2f deg",
+				   r, failed ? "FAIL" : "ok", (double) m.max_tilt_deg,
+				   (double) (m.samples ? sqrtf(m.sq_err_deg / (float) m.samples) : 0.0f),
+				   (double) m.max_alt_err_m,
+				   (double) (m.samples ? sqrtf(m.sq_alt_est_err_m / (float) m.samples) : 0.0f),
+				   (double) (m.pos_samples ? sqrtf(m.sq_pos_est_err_m / (float) m.pos_samples) : 0.0f),
+				   (double) (m.hdg_samples ? sqrtf(m.sq_hdg_est_err_deg / (float) m.hdg_samples) : 0.0f));
+			if (scenario == SCENARIO_ALT_HOLD)
+				printf(" max_thr_step=%.2f %% hover_thr=%.1f %%", (double) m.max_thr_step_pct, (double) m.hover_thr_pct);
+			if (scenario == SCENARIO_CRASH)
+				printf(" crash_disarms=%u motors_after_cut=%u flew_after_cut=%d", m.crash_disarms,
+					   m.motors_after_cut, m.flew_after_cut);
+			printf("%s\n", (status == SITL_ERROR_WARN) ? " (module warnings)" : "");
+		}
+
+		if (m.violations)
+			printf("run %u: %u invariant violations, first \"%s\" at %.3f s (seed %u)\n",
+				   r, m.violations, m.violation, m.violation_s, cfg.seed - 1U);
+	}
+
+	double wall_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+	double sim_s = (double) duration_s * runs;
+	printf("simulated %.1f s in %.3f s (%.0fx real time)\n", sim_s, wall_s, (wall_s > 0.0) ? sim_s / wall_s : 0.0);
+
+	return fail;
+}
@@ -0,0 +1,796 @@
+/*
+ * msc_main.c (usb mass storage host test)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "storage/msc.h"
+
+/*
+ * Plays the usb host against storage/msc.c: commands go in as bulk-only
+ * transport wrappers over a fake endpoint pair, the unit serves a ram disk,
+ * and both sides take time on a virtual clock (usb bulk at full speed, card
+ * command overhead plus per-block time). msc_service runs once per flight
+ * loop, as in the firmware main loop.
+ *
+ * First the SCSI command set is checked, including its error paths (sense
+ * data, residues, stalls, phase errors, an invalid cbw and reset recovery, a
+ * card error in the middle of a transfer, write protection, eject):
+ *
+ *   {"mode": "scsi", "checks": 63, "failed": 0}
+ *
+ * then a sequential read and write of the whole disk report the rate the
+ * double-buffered data path reaches on the model:
+ *
+ *   {"mode": "read", "bytes": 8388608, "command_blocks": 128, "loop_hz": 417,
+ *    "seconds": 11.048, "kb_per_s": 741.5, "usb_busy": 0.76, "overlapped": 896,
+ *    "verified": true}
+ *
+ * usb_busy is the share of the time data was on the bus; what is left is
+ * mostly commands and buffers waiting for the next flight loop (-l).
+ *
+ * The exit status is 1 if any check or data comparison fails.
+ */
+
+/**
+  * @brief  Timing Model (microseconds)
+  */
+#define USB_BYTES_PER_US		1.0		// full speed bulk, ~1 MB/s after protocol overhead
+#define USB_TRANSFER_US			50.0	// token / handshake latency per transfer
+#define CARD_CMD_US				150.0
+#define CARD_READ_BLOCK_US		25.0	// ~20 MB/s at 4-bit 48 MHz
+#define CARD_WRITE_BLOCK_US		60.0
+#define CARD_WRITE_BUSY_US		400.0	// programming after each multi-block write
+#define TIMEOUT_US				5.0e6
+
+#define DISK_BLOCKS_DEFAULT		16384U	// 8 MB
+#define COMMAND_BLOCKS			128U	// 64 KB per READ(10) / WRITE(10), like a linux host
+#define NEVER					1.0e300
+#define NO_BLOCK				0xFFFFFFFFU
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+/**
+  * @brief  Virtual Clock and Flight Loop
+  */
+static double now;
+static double loop_us;
+static double next_service;
+
+/**
+  * @brief  Ram Disk
+  */
+static uint8_t *image;
+static uint32_t disk_blocks = DISK_BLOCKS_DEFAULT;
+static uint32_t fail_block = NO_BLOCK;
+static struct {
+	bool busy;
+	bool write;
+	uint8_t *buf;
+	uint32_t block;
+	uint32_t count;
+	double done_at;
+} card;
+
+/**
+  * @brief  Endpoint Pair (device side)
+  */
+static struct {
+	const uint8_t *tx_buf;
+	uint32_t tx_len;
+	bool tx_armed;
+	double tx_at;				// NEVER until the host reads
+	uint8_t *rx_buf;
+	uint32_t rx_len;
+	bool rx_armed;
+	double rx_at;
+	bool stalled_in;
+	bool stalled_out;
+	double busy_us;				// bytes on the bus
+} ep;
+
+/**
+  * @brief  Host Side of the Current Phase
+  */
+static struct {
+	bool in_active;
+	uint8_t *in_dst;
+	uint32_t in_want;
+	uint32_t in_got;
+	bool in_end;				// full length or short packet
+	bool out_active;
+	const uint8_t *out_src;
+	uint32_t out_left;
+	uint32_t tag;
+} host;
+
+/**
+  * @brief  Bulk-Only Transaction Result
+  */
+typedef struct {
+	bool csw_valid;
+	uint8_t status;
+	uint32_t residue;
+	uint32_t data_len;
+	bool data_stalled;
+} bot_result_t;
+
+static uint32_t checks, failures;
+
+
+/**
+  * @brief helper function to record one check
+  *
+  * @retval None
+  */
+static void check(bool cond, const char *what, int line) {
+	++checks;
+	if (!cond) {
+		++failures;
+		fprintf(stderr, "msc_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+/**
+  * @brief ram disk driver (msc_disk_interface_t)
+  */
+static bool disk_ready(void) {
+	return !card.busy;
+}
+
+static uint32_t disk_block_count(void) {
+	return disk_blocks;
+}
+
+static bool disk_start(uint8_t *buf, uint32_t block, uint32_t count, bool write) {
+	if (card.busy || ((uint64_t) block + count > disk_blocks))
+		return false;
+
+	card.busy = true;
+	card.write = write;
+	card.buf = buf;
+	card.block = block;
+	card.count = count;
+	card.done_at = now + CARD_CMD_US + count * (write ? CARD_WRITE_BLOCK_US : CARD_READ_BLOCK_US) +
+				   (write ? CARD_WRITE_BUSY_US : 0.0);
+	return true;
+}
+
+static bool disk_read(uint32_t *buf, uint32_t block, uint32_t count) {
+	return disk_start((uint8_t*) buf, block, count, false);
+}
+
+static bool disk_write(const uint32_t *buf, uint32_t block, uint32_t count) {
+	return disk_start((uint8_t*) buf, block, count, true);
+}
+
+static const msc_disk_interface_t ram_disk = {
+	.ready = disk_ready,
+	.block_count = disk_block_count,
+	.read = disk_read,
+	.write = disk_write
+};
+
+/**
+  * @brief endpoint driver (msc_usb_interface_t)
+  */
+static bool usb_send(const uint8_t *buf, uint32_t len) {
+	if (ep.stalled_in || ep.tx_armed)
+		return false;
+
+	ep.tx_buf = buf;
+	ep.tx_len = len;
+	ep.tx_armed = true;
+	ep.tx_at = NEVER;
+	return true;
+}
+
+static bool usb_receive(uint8_t *buf, uint32_t len) {
+	if (ep.stalled_out)
+		return false;
+
+	ep.rx_buf = buf;
+	ep.rx_len = len;
+	ep.rx_armed = true;
+	ep.rx_at = NEVER;
+	return true;
+}
+
+static void usb_stall(bool in) {
+	if (in) {
+		ep.stalled_in = true;
+		ep.tx_armed = false;
+	} else {
+		ep.stalled_out = true;
+		ep.rx_armed = false;
+	}
+}
+
+static const msc_usb_interface_t fake_usb = {
+	.send = usb_send,
+	.receive = usb_receive,
+	.stall = usb_stall
+};
+
+/**
+  * @brief helper function to start bus transfers both sides are ready for
+  *
+  * @retval None
+  */
+static void schedule(void) {
+	double us;
+
+	if (ep.tx_armed && (ep.tx_at == NEVER) && host.in_active && !host.in_end) {
+		us = ep.tx_len / USB_BYTES_PER_US;
+		ep.tx_at = now + USB_TRANSFER_US + us;
+		ep.busy_us += us;
+	}
+
+	if (ep.rx_armed && (ep.rx_at == NEVER) && host.out_active && host.out_left) {
+		us = ((ep.rx_len < host.out_left) ? ep.rx_len : host.out_left) / USB_BYTES_PER_US;
+		ep.rx_at = now + USB_TRANSFER_US + us;
+		ep.busy_us += us;
+	}
+}
+
+/**
+  * @brief helper function to advance the clock to the next event and run it
+  * 	   (card or bus transfer completing, or the next flight loop)
+  *
+  * @retval None
+  */
+static void step(void) {
+	double t = next_service;
+	uint32_t n, len;
+	bool fail;
+
+	schedule();
+
+	if (card.busy && (card.done_at < t))
+		t = card.done_at;
+	if (ep.tx_armed && (ep.tx_at < t))
+		t = ep.tx_at;
+	if (ep.rx_armed && (ep.rx_at < t))
+		t = ep.rx_at;
+
+	now = t;
+
+	if (card.busy && (card.done_at <= now)) {
+		len = card.count * MSC_BLOCK_SIZE;
+		fail = (fail_block >= card.block) && (fail_block < card.block + card.count);
+
+		if (!fail && card.write)
+			memcpy(&image[(size_t) card.block * MSC_BLOCK_SIZE], card.buf, len);
+		else if (!fail)
+			memcpy(card.buf, &image[(size_t) card.block * MSC_BLOCK_SIZE], len);
+
+		card.busy = false;
+		msc_disk_done(!fail);
+	}
+
+	if (ep.tx_armed && (ep.tx_at <= now)) {
+		len = ep.tx_len;
+		n = host.in_want - host.in_got;
+		if (n > len)
+			n = len;
+
+		memcpy(&host.in_dst[host.in_got], ep.tx_buf, n);
+		host.in_got += n;
+		host.in_end = (len % MSC_PACKET_SIZE) || !len || (host.in_got == host.in_want);
+
+		ep.tx_armed = false;
+		msc_usb_sent();
+	}
+
+	if (ep.rx_armed && (ep.rx_at <= now)) {
+		n = (ep.rx_len < host.out_left) ? ep.rx_len : host.out_left;
+
+		memcpy(ep.rx_buf, host.out_src, n);
+		host.out_src += n;
+		host.out_left -= n;
+
+		ep.rx_armed = false;
+		msc_usb_received(n);
+	}
+
+	if (next_service <= now) {
+		(void) msc_service();
+		next_service += loop_us;
+	}
+}
+
+/**
+  * @brief helper functions to run the clock until a phase ends (false on timeout)
+  */
+static bool wait_in(void) {
+	double deadline = now + TIMEOUT_US;
+
+	while (!host.in_end && !ep.stalled_in && (now < deadline))
+		step();
+
+	return host.in_end || ep.stalled_in;
+}
+
+static bool wait_out(void) {
+	double deadline = now + TIMEOUT_US;
+
+	while (host.out_left && !ep.stalled_out && (now < deadline))
+		step();
+
+	return !host.out_left || ep.stalled_out;
+}
+
+static bool wait_cbw_armed(void) {
+	double deadline = now + TIMEOUT_US;
+
+	while (!ep.rx_armed && (now < deadline))
+		step();
+
+	return ep.rx_armed;
+}
+
+/**
+  * @brief helper functions to start a host phase
+  */
+static void host_in(uint8_t *dst, uint32_t len) {
+	memset(&host, 0, offsetof(__typeof__(host), tag));
+	host.in_active = true;
+	host.in_dst = dst;
+	host.in_want = len;
+}
+
+static void host_out(const uint8_t *src, uint32_t len) {
+	memset(&host, 0, offsetof(__typeof__(host), tag));
+	host.out_active = true;
+	host.out_src = src;
+	host.out_left = len;
+}
+
+/**
+  * @brief helper function to clear a stalled endpoint (CLEAR_FEATURE halt)
+  *
+  * @retval None
+  */
+static void clear_halt(bool in) {
+	if (in)
+		ep.stalled_in = false;
+	else
+		ep.stalled_out = false;
+
+	msc_usb_halt_cleared(in);
+}
+
+/**
+  * @brief helper function to run reset recovery (bulk-only mass storage
+  * 	   reset, then the class clears both halts)
+  *
+  * @retval boolean (unit takes a new cbw)
+  */
+static bool reset_recovery(void) {
+	memset(&host, 0, offsetof(__typeof__(host), tag));
+	ep.stalled_in = false;
+	ep.stalled_out = false;
+	ep.tx_armed = false;
+	ep.rx_armed = false;
+
+	msc_usb_reset();
+
+	return wait_cbw_armed();
+}
+
+/**
+  * @brief helper function to build a command block wrapper
+  *
+  * @retval None
+  */
+static void put_le32(uint8_t *p, uint32_t v) {
+	p[0] = (uint8_t) v;
+	p[1] = (uint8_t) (v >> 8);
+	p[2] = (uint8_t) (v >> 16);
+	p[3] = (uint8_t) (v >> 24);
+}
+
+static uint32_t get_le32(const uint8_t *p) {
+	return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static uint32_t get_be32(const uint8_t *p) {
+	return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+
+/**
+  * @brief helper function to run one command through the bulk-only transport:
+  * 	   cbw, data phase (host direction and length as given), csw
+  *
+  * @param  cb		command block (up to 16 bytes)
+  * @param	cb_len	command block length
+  * @param	lun		logical unit
+  * @param	in		data phase direction
+  * @param	data	data to send / buffer to receive into
+  * @param	len		bytes the host expects to move
+  *
+  * @retval transaction result (csw_valid false after reset recovery)
+  */
+static bot_result_t transact_lun(const uint8_t *cb, uint8_t cb_len, uint8_t lun, bool in, void *data, uint32_t len) {
+	uint8_t cbw[MSC_CBW_LENGTH] = {0};
+	uint8_t csw[MSC_CSW_LENGTH + 3U];
+	bot_result_t res = {0};
+
+	host.tag++;
+	put_le32(&cbw[0], 0x43425355U);
+	put_le32(&cbw[4], host.tag);
+	put_le32(&cbw[8], len);
+	cbw[12] = in ? 0x80U : 0x00U;
+	cbw[13] = lun;
+	cbw[14] = cb_len;
+	memcpy(&cbw[15], cb, cb_len);
+
+	/* Command */
+	host_out(cbw, sizeof(cbw));
+	if (!wait_out())
+		return res;
+
+	/* Data */
+	if (len && in) {
+		host_in(data, len);
+		if (!wait_in())
+			return res;
+		res.data_len = host.in_got;
+		if (ep.stalled_in) {
+			res.data_stalled = true;
+			clear_halt(true);
+		}
+	} else if (len) {
+		host_out(data, len);
+		if (!wait_out())
+			return res;
+		res.data_len = len - host.out_left;
+		if (ep.stalled_out) {
+			res.data_stalled = true;
+			clear_halt(false);
+		}
+	}
+
+	/* Status (one retry after a stall, then reset recovery) */
+	for (int i = 0; i < 2; ++i) {
+		host_in(csw, sizeof(csw));
+		if (!wait_in())
+			return res;
+		if (!ep.stalled_in)
+			break;
+		clear_halt(true);
+	}
+
+	if (ep.stalled_in || (host.in_got != MSC_CSW_LENGTH) || (get_le32(&csw[0]) != 0x53425355U) ||
+		(get_le32(&csw[4]) != host.tag)) {
+		(void) reset_recovery();
+		return res;
+	}
+
+	res.csw_valid = true;
+	res.residue = get_le32(&csw[8]);
+	res.status = csw[12];
+
+	return res;
+}
+
+static bot_result_t transact(const uint8_t *cb, uint8_t cb_len, bool in, void *data, uint32_t len) {
+	return transact_lun(cb, cb_len, 0U, in, data, len);
+}
+
+/**
+  * @brief helper function to fetch the sense data of the last error
+  *
+  * @retval sense key << 8 | additional sense code (0xFFFF if the command failed)
+  */
+static uint32_t request_sense(void) {
+	uint8_t cb[6] = {0x03U, 0U, 0U, 0U, 18U, 0U};
+	uint8_t r[18];
+	bot_result_t res = transact(cb, sizeof(cb), true, r, sizeof(r));
+
+	if (!res.csw_valid || res.status || (res.data_len != sizeof(r)) || (r[0] != 0x70U))
+		return 0xFFFFU;
+
+	return ((uint32_t) (r[2] & 0x0FU) << 8) | r[12];
+}
+
+/**
+  * @brief helper functions to issue READ(10) / WRITE(10)
+  */
+static bot_result_t rw10(bool write, uint32_t lba, uint32_t blocks, void *data, uint32_t len, bool in) {
+	uint8_t cb[10] = {write ? 0x2AU : 0x28U, 0U, (uint8_t) (lba >> 24), (uint8_t) (lba >> 16),
+					  (uint8_t) (lba >> 8), (uint8_t) lba, 0U, (uint8_t) (blocks >> 8), (uint8_t) blocks, 0U};
+
+	return transact(cb, sizeof(cb), in, data, len);
+}
+
+static bot_result_t read10(uint32_t lba, uint32_t blocks, void *data) {
+	return rw10(false, lba, blocks, data, blocks * MSC_BLOCK_SIZE, true);
+}
+
+static bot_result_t write10(uint32_t lba, uint32_t blocks, const void *data) {
+	return rw10(true, lba, blocks, (void*) data, blocks * MSC_BLOCK_SIZE, false);
+}
+
+/**
+  * @brief helper function to fill a buffer with a position dependent pattern
+  *
+  * @retval None
+  */
+static void pattern(uint8_t *buf, uint32_t lba, uint32_t blocks, uint32_t seed) {
+	for (uint32_t i = 0; i < blocks * MSC_BLOCK_SIZE; ++i)
+		buf[i] = (uint8_t) ((lba * MSC_BLOCK_SIZE + i) * 2654435761U >> 24) ^ (uint8_t) seed;
+}
+
+/**
+  * @brief helper function to (re)open the unit and let the host configure it
+  *
+  * @retval boolean
+  */
+static bool open_unit(bool read_only) {
+	msc_close();
+	memset(&ep, 0, sizeof(ep));
+
+	if (msc_open(&fake_usb, &ram_disk, read_only) != MSC_OK)
+		return false;
+
+	msc_usb_reset();
+	return wait_cbw_armed();
+}
+
+/**
+  * @brief checks the SCSI command set and the transport error paths
+  *
+  * @retval None
+  */
+static void run_scsi(void) {
+	static uint8_t data[64U * MSC_BLOCK_SIZE], back[64U * MSC_BLOCK_SIZE];
+	uint8_t r[256];
+	bot_result_t res;
+	uint32_t last = disk_blocks - 1U;
+
+	CHECK(open_unit(false));
+
+	/* INQUIRY: exact length, then a larger allocation (short packet, residue) */
+	res = transact((uint8_t[]){0x12U, 0U, 0U, 0U, 36U, 0U}, 6U, true, r, 36U);
+	CHECK(res.csw_valid && !res.status && !res.residue && (res.data_len == 36U));
+	CHECK((r[0] == 0x00U) && (r[1] & 0x80U) && (r[4] == 31U) && !memcmp(&r[8], "AQC-1", 5U));
+
+	res = transact((uint8_t[]){0x12U, 0U, 0U, 0U, 255U, 0U}, 6U, true, r, 255U);
+	CHECK(res.csw_valid && !res.status && (res.data_len == 36U) && (res.residue == 219U) && !res.data_stalled);
+
+	/* INQUIRY with nothing to return: in stalled, whole length as residue */
+	res = transact((uint8_t[]){0x12U, 0U, 0U, 0U, 0U, 0U}, 6U, true, r, 64U);
+	CHECK(res.csw_valid && !res.status && res.data_stalled && (res.residue == 64U));
+
+	/* INQUIRY with no data phase: device has data, host expects none (case 2) */
+	res = transact((uint8_t[]){0x12U, 0U, 0U, 0U, 36U, 0U}, 6U, true, NULL, 0U);
+	CHECK(res.csw_valid && (res.status == 2U));
+	CHECK(reset_recovery());
+
+	/* INQUIRY vital product data: not supported */
+	res = transact((uint8_t[]){0x12U, 1U, 0x80U, 0U, 36U, 0U}, 6U, true, r, 36U);
+	CHECK(res.csw_valid && (res.status == 1U) && res.data_stalled);
+	CHECK(request_sense() == 0x524U);
+
+	/* TEST UNIT READY, PREVENT ALLOW MEDIUM REMOVAL, SYNCHRONIZE CACHE */
+	res = transact((uint8_t[]){0x00U, 0U, 0U, 0U, 0U, 0U}, 6U, false, NULL, 0U);
+	CHECK(res.csw_valid && !res.status);
+	res = transact((uint8_t[]){0x1EU, 0U, 0U, 0U, 1U, 0U}, 6U, false, NULL, 0U);
+	CHECK(res.csw_valid && !res.status);
+	res = transact((uint8_t[]){0x35U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U}, 10U, false, NULL, 0U);
+	CHECK(res.csw_valid && !res.status);
+
+	/* READ CAPACITY(10) */
+	res = transact((uint8_t[]){0x25U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U}, 10U, true, r, 8U);
+	CHECK(res.csw_valid && !res.status && (res.data_len == 8U));
+	CHECK((get_be32(&r[0]) == last) && (get_be32(&r[4]) == MSC_BLOCK_SIZE));
+
+	/* READ FORMAT CAPACITIES (windows asks for 252 bytes) */
+	res = transact((uint8_t[]){0x23U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 252U, 0U}, 10U, true, r, 252U);
+	CHECK(res.csw_valid && !res.status && (res.data_len == 12U) && (res.residue == 240U));
+	CHECK((r[3] == 8U) && (get_be32(&r[4]) == disk_blocks) && (r[8] == 0x02U) && ((get_be32(&r[8]) & 0xFFFFFFU) == MSC_BLOCK_SIZE));
+
+	/* MODE SENSE(6) / (10): writable */
+	res = transact((uint8_t[]){0x1AU, 0U, 0x3FU, 0U, 192U, 0U}, 6U, true, r, 192U);
+	CHECK(res.csw_valid && !res.status && (res.data_len == 4U) && (r[0] == 3U) && !(r[2] & 0x80U));
+	res = transact((uint8_t[]){0x5AU, 0U, 0x3FU, 0U, 0U, 0U, 0U, 0U, 8U, 0U}, 10U, true, r, 8U);
+	CHECK(res.csw_valid && !res.status && (res.data_len == 8U) && (r[1] == 6U) && !(r[3] & 0x80U));
+
+	/* WRITE(10) / READ(10) over several buffers and a partial last one */
+	pattern(data, 100U, 40U, 0x5AU);
+	res = write10(100U, 40U, data);
+	CHECK(res.csw_valid && !res.status && !res.residue && !res.data_stalled);
+	CHECK(!memcmp(&image[100U * MSC_BLOCK_SIZE], data, 40U * MSC_BLOCK_SIZE));
+
+	memset(back, 0, sizeof(back));
+	res = read10(100U, 40U, back);
+	CHECK(res.csw_valid && !res.status && !res.residue && (res.data_len == 40U * MSC_BLOCK_SIZE));
+	CHECK(!memcmp(back, data, 40U * MSC_BLOCK_SIZE));
+
+	/* Last block, zero blocks, VERIFY(10) */
+	res = read10(last, 1U, back);
+	CHECK(res.csw_valid && !res.status && !memcmp(back, &image[(size_t) last * MSC_BLOCK_SIZE], MSC_BLOCK_SIZE));
+	res = read10(0U, 0U, NULL);
+	CHECK(res.csw_valid && !res.status);
+	res = transact((uint8_t[]){0x2FU, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 8U, 0U}, 10U, false, NULL, 0U);
+	CHECK(res.csw_valid && !res.status);
+
+	/* Out of range: failed, in stalled, sense reported once */
+	res = read10(last, 2U, back);
+	CHECK(res.csw_valid && (res.status == 1U) && res.data_stalled && (res.residue == 2U * MSC_BLOCK_SIZE));
+	CHECK(request_sense() == 0x521U);
+	CHECK(request_sense() == 0x000U);
+	res = transact((uint8_t[]){0x2FU, 0U, 0xFFU, 0xFFU, 0xFFU, 0xFFU, 0U, 0U, 1U, 0U}, 10U, false, NULL, 0U);
+	CHECK(res.csw_valid && (res.status == 1U));
+	CHECK(request_sense() == 0x521U);
+
+	/* Unsupported opcode, unsupported lun */
+	res = transact((uint8_t[]){0xA0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U}, 12U, false, NULL, 0U);
+	CHECK(res.csw_valid && (res.status == 1U));
+	CHECK(request_sense() == 0x520U);
+	res = transact_lun((uint8_t[]){0x00U, 0U, 0U, 0U, 0U, 0U}, 6U, 1U, false, NULL, 0U);
+	CHECK(res.csw_valid && (res.status == 1U));
+	CHECK(request_sense() == 0x525U);
+
+	/* Host and device disagree: length (cases 7, 13), direction (case 10) */
+	res = rw10(false, 0U, 4U, back, 3U * MSC_BLOCK_SIZE, true);
+	CHECK(res.csw_valid && (res.status == 2U) && res.data_stalled);
+	CHECK(reset_recovery());
+	res = rw10(false, 0U, 4U, data, 4U * MSC_BLOCK_SIZE, false);
+	CHECK(res.csw_valid && (res.status == 2U) && res.data_stalled && !res.data_len);
+	CHECK(reset_recovery());
+
+	res = rw10(true, 0U, 4U, data, 3U * MSC_BLOCK_SIZE, false);
+	CHECK(res.csw_valid && (res.status == 2U) && res.data_stalled);
+	CHECK(reset_recovery());
+
+	/* Invalid cbw: both pipes stay stalled until reset recovery */
+	{
+		uint8_t bad[MSC_CBW_LENGTH] = {'X', 'X', 'X', 'X'};
+		uint8_t csw[MSC_CSW_LENGTH];
+
+		host_out(bad, sizeof(bad));
+		CHECK(wait_out());
+		host_in(csw, sizeof(csw));
+		CHECK(wait_in() && ep.stalled_in && ep.stalled_out);
+		clear_halt(true);
+		host_in(csw, sizeof(csw));
+		CHECK(wait_in() && ep.stalled_in && !host.in_got);
+		CHECK(reset_recovery());
+		res = transact((uint8_t[]){0x00U, 0U, 0U, 0U, 0U, 0U}, 6U, false, NULL, 0U);
+		CHECK(res.csw_valid && !res.status);
+	}
+
+	/* Card error in the third buffer of a read: the first two reach the host */
+	fail_block = 1000U + 2U * MSC_BUFFER_BLOCKS + 3U;
+	res = read10(1000U, 64U, back);
+	CHECK(res.csw_valid && (res.status == 1U) && res.data_stalled);
+	CHECK((res.data_len == 2U * MSC_BUFFER_SIZE) && (res.residue == 64U * MSC_BLOCK_SIZE - 2U * MSC_BUFFER_SIZE));
+	CHECK(request_sense() == 0x311U);
+
+	/* Card error in the second buffer of a write: out stalled, the rest discarded */
+	fail_block = 2000U + MSC_BUFFER_BLOCKS + 1U;
+	pattern(data, 2000U, 64U, 0xA5U);
+	res = write10(2000U, 64U, data);
+	CHECK(res.csw_valid && (res.status == 1U) && res.data_stalled);
+	CHECK(res.residue == 64U * MSC_BLOCK_SIZE - MSC_BUFFER_SIZE);
+	CHECK(!memcmp(&image[2000U * MSC_BLOCK_SIZE], data, MSC_BUFFER_SIZE));
+	CHECK(request_sense() == 0x30CU);
+	fail_block = NO_BLOCK;
+
+	/* Still serving after the errors */
+	res = read10(100U, 40U, back);
+	CHECK(res.csw_valid && !res.status && !memcmp(back, &image[100U * MSC_BLOCK_SIZE], 40U * MSC_BLOCK_SIZE));
+
+	/* Eject: status goes out, then the unit reports no medium */
+	res = transact((uint8_t[]){0x1BU, 0U, 0U, 0U, 0x02U, 0U}, 6U, false, NULL, 0U);
+	CHECK(res.csw_valid && !res.status);
+	CHECK(wait_cbw_armed() && msc_ejected());
+	res = transact((uint8_t[]){0x00U, 0U, 0U, 0U, 0U, 0U}, 6U, false, NULL, 0U);
+	CHECK(res.csw_valid && (res.status == 1U));
+	CHECK(request_sense() == 0x23AU);
+	res = read10(0U, 1U, back);
+	CHECK(res.csw_valid && (res.status == 1U) && res.data_stalled);
+
+	/* Write protected: reported by MODE SENSE, writes refused, card untouched */
+	CHECK(open_unit(true));
+	res = transact((uint8_t[]){0x1AU, 0U, 0x3FU, 0U, 4U, 0U}, 6U, true, r, 4U);
+	CHECK(res.csw_valid && !res.status && (r[2] & 0x80U));
+	memcpy(back, &image[100U * MSC_BLOCK_SIZE], 4U * MSC_BLOCK_SIZE);
+	pattern(data, 100U, 4U, 0x11U);
+	res = write10(100U, 4U, data);
+	CHECK(res.csw_valid && (res.status == 1U) && res.data_stalled);
+	CHECK(request_sense() == 0x727U);
+	CHECK(!memcmp(back, &image[100U * MSC_BLOCK_SIZE], 4U * MSC_BLOCK_SIZE));
+
+	printf("{\"mode\": \"scsi\", \"checks\": %u, \"failed\": %u}\n", checks, failures);
+}
+
+/**
+  * @brief writes then reads back the whole disk in COMMAND_BLOCKS commands
+  * 	   and reports the rates on the timing model
+  *
+  * @retval boolean (data verified)
+  */
+static bool run_rate(bool write) {
+	static uint8_t data[COMMAND_BLOCKS * MSC_BLOCK_SIZE], back[COMMAND_BLOCKS * MSC_BLOCK_SIZE];
+	uint64_t bytes = (uint64_t) disk_blocks * MSC_BLOCK_SIZE;
+	double start, busy;
+	bot_result_t res;
+	msc_stats_t st;
+	bool ok = open_unit(false);
+
+	start = now;
+	busy = ep.busy_us;
+
+	for (uint32_t lba = 0; ok && (lba < disk_blocks); lba += COMMAND_BLOCKS) {
+		uint32_t n = (disk_blocks - lba < COMMAND_BLOCKS) ? disk_blocks - lba : COMMAND_BLOCKS;
+
+		pattern(data, lba, n, 0x3CU);
+		res = write ? write10(lba, n, data) : read10(lba, n, back);
+		ok = res.csw_valid && !res.status && !res.residue;
+		ok &= !memcmp(write ? &image[(size_t) lba * MSC_BLOCK_SIZE] : back, data, n * MSC_BLOCK_SIZE);
+	}
+
+	msc_get_stats(&st);
+
+	printf("{\"mode\": \"%s\", \"bytes\": %llu, \"command_blocks\": %u, \"loop_hz\": %.0f, \"seconds\": %.3f, "
+		   "\"kb_per_s\": %.1f, \"usb_busy\": %.2f, \"overlapped\": %u, \"verified\": %s}\n",
+		   write ? "write" : "read", (unsigned long long) bytes, COMMAND_BLOCKS, 1.0e6 / loop_us,
+		   (now - start) * 1.0e-6, (double) bytes / 1024.0 / ((now - start) * 1.0e-6),
+		   (ep.busy_us - busy) / (now - start), st.overlapped, ok ? "true" : "false");
+
+	return ok;
+}
+
+static void usage(const char *argv0) {
+	fprintf(stderr,
+			"usage: %s [-b blocks] [-l loop_hz]\n"
+			"  -b   ram disk size in blocks (default %u)\n"
+			"  -l   flight loop rate msc_service runs at (default 417 Hz)\n",
+			argv0, DISK_BLOCKS_DEFAULT);
+}
+
+int main(int argc, char **argv) {
+	double loop_hz = 417.0;
+	bool ok;
+
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "-b") && (i + 1 < argc))
+			disk_blocks = (uint32_t) strtoul(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "-l") && (i + 1 < argc))
+			loop_hz = strtod(argv[++i], NULL);
+		else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+
+	if ((disk_blocks < 4096U) || (loop_hz <= 0.0)) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	image = calloc(disk_blocks, MSC_BLOCK_SIZE);
+	if (!image)
+		return 2;
+
+	loop_us = 1.0e6 / loop_hz;
+	now = 0.0;
+	next_service = loop_us;
+
+	run_scsi();
+	ok = !failures;
+	ok &= run_rate(true);
+	ok &= run_rate(false);
+
+	free(image);
+
+	return ok ? 0 : 1;
+}
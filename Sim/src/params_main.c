@@ -0,0 +1,722 @@
+/*
+ * params_main.c (parameter storage host test)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_hw.h"
+#include "params/params.h"
+#include "params/param_storage.h"
+#include "params/flash/ram_param_flash.h"
+#include "common/crc.h"
+
+/*
+ * Runs params/param_storage.c unmodified on src/ram_param_flash.c behind a
+ * flash that can lose power: every erase and programmed word spends one unit
+ * of a budget, and when it runs out the call fails and nothing more is
+ * written (optionally after tearing the word in progress: half its bits).
+ * After each cut the storage is rebooted (init and load) and compared with
+ * what was saved:
+ *
+ * - append: saves go behind the last record of the active bank, and the
+ *   last write of a key wins
+ * - compaction and bank switching: a full bank is compacted into the other
+ *   one with the next sequence number, back and forth, and the newest bank
+ *   wins at boot
+ * - power loss during compaction, at every word: the header is programmed
+ *   last, so the old bank loads whole until the new header's crc is in
+ *   (only its reserved word follows), then the new one does
+ * - crc rejection: a record with a bad crc is skipped (the older value of
+ *   its key stays) and a bank with a bad header crc is ignored
+ * - a write torn in the middle of a record: the older value stays, and the
+ *   next save goes behind the burnt slot
+ *
+ * Then params/params.c loads banks written by the previous storage version
+ * (v1: ESC_LIFTOFF_PCT up to 60, now up to the lowest ESC_LIMIT_PCT of 50),
+ * migrates them and rewrites them as the current version on the next save;
+ * ordered pairs (esc idle below liftoff, rc pulse min below max) refuse a
+ * set that would cross them and fall back to their defaults if a bank
+ * loads them crossed; the parameter names must fit MSG_PARAM_DESC and be
+ * unique:
+ *
+ *   {"mode": "checks", "checks": 68, "failed": 0}
+ *
+ * The exit status is 1 if any check fails.
+ */
+
+#define KEY_BASE				0x1000U		// storage test keys (not in the registry)
+#define KEYS					64U
+#define LIVE_KEYS				12U
+#define STORAGE_MAGIC			0x50435141UL	// param_storage.c
+#define HEADER_SIZE				16U
+#define RECORD_SIZE				8U
+#define KEY_ESC_IDLE_PCT		0x0300U		// params.c
+#define KEY_ESC_LIFTOFF_PCT		0x0301U
+#define KEY_ROLL_RATE_P			0x0220U
+#define KEY_UNKNOWN				0x7FFEU
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+/**
+  * @brief  Stored Key Set Type (what a save stored, or what a load applied)
+  */
+typedef struct {
+	bool set[KEYS];
+	uint32_t value[KEYS];
+} image_t;
+
+/**
+  * @brief  Bank Header Type (param_storage.c layout)
+  */
+typedef struct {
+	uint32_t magic;
+	uint32_t seq;
+	uint16_t version;
+	uint16_t crc;
+	uint32_t reserved;
+} header_t;
+
+static unsigned checks;
+static unsigned failures;
+
+static param_flash_interface_t fault_flash;
+static int32_t budget = -1;		// erases and words left before power loss (-1: no limit)
+static bool tear;				// a cut word gets half its bits programmed
+
+static image_t model;			// saved so far
+static image_t loaded;			// applied by the last load
+static uint32_t snap[PARAM_STORAGE_BANK_COUNT][4096U / 4U];
+
+
+static void check(bool cond, const char *what, int line) {
+	checks++;
+
+	if (!cond) {
+		failures++;
+		fprintf(stderr, "params_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+/**
+  * @brief helper function to spend one unit of the power budget
+  *
+  * @retval boolean (true once the power is gone)
+  */
+static bool power_cut(void) {
+	if (budget < 0)
+		return false;
+	if (budget == 0)
+		return true;
+
+	budget--;
+	return false;
+}
+
+static bool fault_erase(uint8_t bank) {
+	if (power_cut())
+		return false;
+
+	return ram_param_flash.erase(bank);
+}
+
+static bool fault_program(uint8_t bank, uint32_t offset, const uint32_t *words, uint32_t count) {
+	for (uint32_t i = 0; i < count; ++i) {
+		if (power_cut()) {
+			if (tear) {
+				uint32_t half = words[i] | 0xFFFF0000UL;
+				ram_param_flash.program(bank, offset + 4U * i, &half, 1U);
+			}
+			return false;
+		}
+
+		if (!ram_param_flash.program(bank, offset + 4U * i, &words[i], 1U))
+			return false;
+	}
+
+	return true;
+}
+
+static bool apply_loaded(uint16_t key, uint32_t value) {
+	if ((key < KEY_BASE) || (key >= KEY_BASE + KEYS))
+		return false;
+
+	loaded.set[key - KEY_BASE] = true;
+	loaded.value[key - KEY_BASE] = value;
+	return true;
+}
+
+/**
+  * @brief helper function to boot the storage on the fault flash (power on)
+  *
+  * @retval load status
+  */
+static param_storage_status_t reboot(void) {
+	param_storage_status_t status;
+
+	budget = -1;
+	tear = false;
+	memset(&loaded, 0, sizeof(loaded));
+
+	status = param_storage_init(&fault_flash);
+	if (status != PARAM_STORAGE_OK)
+		return status;
+
+	return param_storage_load(apply_loaded);
+}
+
+/**
+  * @brief helper function to save changes (every stored key is live) and
+  * 	   update the model if they got in
+  *
+  * @retval save status
+  */
+static param_storage_status_t save(const param_entry_t *changed, uint32_t count) {
+	image_t next = model;
+	param_entry_t live[KEYS];
+	uint32_t live_count = 0U;
+	param_storage_status_t status;
+
+	for (uint32_t i = 0; i < count; ++i) {
+		next.set[changed[i].key - KEY_BASE] = true;
+		next.value[changed[i].key - KEY_BASE] = changed[i].value;
+	}
+
+	for (uint32_t k = 0; k < KEYS; ++k) {
+		if (next.set[k])
+			live[live_count++] = (param_entry_t){.key = (uint16_t) (KEY_BASE + k), .value = next.value[k]};
+	}
+
+	status = param_storage_save(changed, count, live, live_count);
+	if (status == PARAM_STORAGE_OK)
+		model = next;
+
+	return status;
+}
+
+static param_storage_status_t save_one(uint16_t key, uint32_t value) {
+	const param_entry_t e = {.key = key, .value = value};
+	return save(&e, 1U);
+}
+
+static bool same_image(const image_t *a, const image_t *b) {
+	for (uint32_t k = 0; k < KEYS; ++k) {
+		if ((a->set[k] != b->set[k]) || (a->set[k] && (a->value[k] != b->value[k])))
+			return false;
+	}
+
+	return true;
+}
+
+static void read_header(uint8_t bank, header_t *hdr) {
+	memcpy(hdr, ram_param_flash.bank_addr(bank), sizeof(*hdr));
+}
+
+static bool header_valid(const header_t *hdr) {
+	return (hdr->magic == STORAGE_MAGIC) && (hdr->crc == crc16_ccitt((const uint8_t*) hdr, 10U));
+}
+
+/**
+  * @brief helper function to get the bank a boot would pick
+  *
+  * @retval bank (PARAM_STORAGE_BANK_COUNT if none)
+  */
+static uint8_t newest_bank(void) {
+	header_t h[PARAM_STORAGE_BANK_COUNT];
+	uint8_t best = PARAM_STORAGE_BANK_COUNT;
+
+	for (uint8_t b = 0; b < PARAM_STORAGE_BANK_COUNT; ++b) {
+		read_header(b, &h[b]);
+		if (header_valid(&h[b]) && ((best == PARAM_STORAGE_BANK_COUNT) || ((int32_t) (h[b].seq - h[best].seq) > 0)))
+			best = b;
+	}
+
+	return best;
+}
+
+/**
+  * @brief helper function to count the programmed record slots of a bank
+  */
+static uint32_t used_slots(uint8_t bank) {
+	const uint8_t *p = ram_param_flash.bank_addr(bank);
+	uint32_t n = 0U;
+
+	for (uint32_t off = HEADER_SIZE; off + RECORD_SIZE <= ram_param_flash.bank_size; off += RECORD_SIZE) {
+		for (uint32_t i = 0; i < RECORD_SIZE; ++i) {
+			if (p[off + i] != 0xFFU) {
+				n++;
+				break;
+			}
+		}
+	}
+
+	return n;
+}
+
+static uint32_t record_offset(uint32_t slot) {
+	return HEADER_SIZE + slot * RECORD_SIZE;
+}
+
+/**
+  * @brief helper function to clear one bit of a programmed word (flash can)
+  */
+static void clear_bit(uint8_t bank, uint32_t offset, uint32_t bit) {
+	uint32_t w = ~(1UL << bit);
+	ram_param_flash.program(bank, offset, &w, 1U);
+}
+
+static void snapshot(void) {
+	for (uint8_t b = 0; b < PARAM_STORAGE_BANK_COUNT; ++b)
+		memcpy(snap[b], ram_param_flash.bank_addr(b), ram_param_flash.bank_size);
+}
+
+static void restore(void) {
+	for (uint8_t b = 0; b < PARAM_STORAGE_BANK_COUNT; ++b) {
+		ram_param_flash.erase(b);
+		ram_param_flash.program(b, 0U, snap[b], ram_param_flash.bank_size / 4U);
+	}
+}
+
+/**
+  * @brief helper function to start from blank storage
+  */
+static void format(void) {
+	ram_param_flash_format();
+	memset(&model, 0, sizeof(model));
+	reboot();
+}
+
+/**
+  * @brief helper function to store the first LIVE_KEYS keys (first save on
+  * 	   blank storage: compacted into bank 0)
+  */
+static void store_live_keys(void) {
+	param_entry_t e[LIVE_KEYS];
+
+	for (uint32_t k = 0; k < LIVE_KEYS; ++k)
+		e[k] = (param_entry_t){.key = (uint16_t) (KEY_BASE + k), .value = 100U + k};
+
+	save(e, LIVE_KEYS);
+}
+
+/**
+  * @brief appends behind the last record, last write wins
+  */
+static void run_append_checks(void) {
+	const param_entry_t first[3] = {{KEY_BASE + 0U, 1U}, {KEY_BASE + 1U, 2U}, {KEY_BASE + 2U, 3U}};
+	const param_entry_t pair[2] = {{KEY_BASE + 1U, 21U}, {KEY_BASE + 3U, 4U}};
+	header_t h;
+	param_storage_status_t status;
+
+	format();
+	CHECK((reboot() == PARAM_STORAGE_OK) && same_image(&loaded, &model));		// blank: nothing
+
+	CHECK(save(first, 3U) == PARAM_STORAGE_OK);
+	read_header(0U, &h);
+	CHECK(header_valid(&h) && (h.seq == 1U) && (h.version == PARAM_STORAGE_VERSION) && (used_slots(0U) == 3U));
+	CHECK(used_slots(1U) == 0U);
+
+	CHECK(save_one(KEY_BASE + 1U, 20U) == PARAM_STORAGE_OK);
+	CHECK(save(pair, 2U) == PARAM_STORAGE_OK);
+	CHECK(save(NULL, 0U) == PARAM_STORAGE_OK);
+	CHECK((used_slots(0U) == 6U) && (used_slots(1U) == 0U) && (newest_bank() == 0U));
+
+	status = reboot();
+	CHECK((status == PARAM_STORAGE_OK) && same_image(&loaded, &model) && (loaded.value[1] == 21U));
+
+	/* Appends continue behind the replayed records after a reboot */
+	CHECK(save_one(KEY_BASE + 2U, 30U) == PARAM_STORAGE_OK);
+	CHECK((used_slots(0U) == 7U) && (reboot() == PARAM_STORAGE_OK) && same_image(&loaded, &model));
+}
+
+/**
+  * @brief full banks are compacted into the other bank, back and forth
+  */
+static void run_compaction_checks(void) {
+	const uint32_t slots = (ram_param_flash.bank_size - HEADER_SIZE) / RECORD_SIZE;
+	uint32_t saves[3] = {0};
+	uint32_t seqs[3] = {0};
+	uint8_t banks[3] = {0};
+	uint32_t n = 0U;
+	bool models_match = true;
+
+	format();
+	store_live_keys();
+
+	/* Single changes until the active bank has switched three times */
+	for (uint32_t sw = 0, i = 0; (sw < 3U) && (i < 4U * slots); ++i) {
+		uint8_t before = newest_bank();
+		header_t h;
+
+		if (save_one((uint16_t) (KEY_BASE + (i % LIVE_KEYS)), 1000U + i) != PARAM_STORAGE_OK)
+			break;
+		n++;
+
+		if (newest_bank() != before) {
+			read_header(newest_bank(), &h);
+			saves[sw] = n;
+			seqs[sw] = h.seq;
+			banks[sw] = newest_bank();
+			sw++;
+			n = 0U;
+
+			reboot();
+			models_match &= same_image(&loaded, &model);
+		}
+	}
+
+	/* The first switch comes when the bank holding LIVE_KEYS is full */
+	CHECK(saves[0] == slots - LIVE_KEYS + 1U);
+	CHECK(saves[1] == slots - LIVE_KEYS + 1U);
+	CHECK((banks[0] == 1U) && (banks[1] == 0U) && (banks[2] == 1U));
+	CHECK((seqs[0] == 2U) && (seqs[1] == 3U) && (seqs[2] == 4U));
+	CHECK(used_slots(newest_bank()) == LIVE_KEYS);		// live set only
+	CHECK(models_match);
+
+	/* The other bank still holds a valid, older header */
+	{
+		header_t h;
+
+		read_header((uint8_t) (1U - newest_bank()), &h);
+		CHECK(header_valid(&h) && (h.seq == seqs[1]));
+	}
+}
+
+/**
+  * @brief power loss at every step of a compaction (header last)
+  */
+static void run_power_loss_checks(void) {
+	const uint32_t slots = (ram_param_flash.bank_size - HEADER_SIZE) / RECORD_SIZE;
+	const param_entry_t changes[2] = {{KEY_BASE + 0U, 999U}, {KEY_BASE + LIVE_KEYS, 7U}};
+	image_t old_model, new_model;
+	uint32_t steps = 0U, old_loads = 0U, new_loads = 0U, bad_loads = 0U;
+	bool torn_ok = true;
+
+	format();
+	store_live_keys();
+	for (uint32_t i = 0; i < slots - LIVE_KEYS; ++i)
+		save_one((uint16_t) (KEY_BASE + (i % LIVE_KEYS)), 2000U + i);
+	CHECK((used_slots(0U) == slots) && (newest_bank() == 0U));		// full: the next save compacts
+
+	snapshot();
+	old_model = model;
+	new_model = model;
+	for (uint32_t i = 0; i < 2U; ++i) {
+		new_model.set[changes[i].key - KEY_BASE] = true;
+		new_model.value[changes[i].key - KEY_BASE] = changes[i].value;
+	}
+
+	/* The header is valid once its crc word is in (the reserved word after it
+	 * is not checked), so the save can fail with the new bank complete */
+	for (int32_t cut = 0; cut < 200; ++cut) {
+		param_storage_status_t status;
+		bool header_in;
+
+		restore();
+		reboot();
+		model = old_model;
+		budget = cut;
+		status = save(changes, 2U);
+		reboot();
+
+		if (status == PARAM_STORAGE_OK) {
+			steps = (uint32_t) cut;
+			new_loads += same_image(&loaded, &new_model) ? 1U : 0U;
+			break;
+		}
+
+		header_in = (newest_bank() == 1U);
+		if (!header_in && same_image(&loaded, &old_model))
+			old_loads++;
+		else if (header_in && same_image(&loaded, &new_model))
+			new_loads++;
+		else
+			bad_loads++;
+
+		/* The same cut tearing the word in progress */
+		restore();
+		reboot();
+		model = old_model;
+		budget = cut;
+		tear = true;
+		save(changes, 2U);
+		reboot();
+		torn_ok &= (newest_bank() == 0U) ? same_image(&loaded, &old_model) : same_image(&loaded, &new_model);
+	}
+
+	/* erase + (LIVE_KEYS + 1) records + header; old until the header crc */
+	CHECK(steps == 1U + (LIVE_KEYS + 1U) * 2U + HEADER_SIZE / 4U);
+	CHECK((old_loads == steps - 1U) && (new_loads == 2U) && (bad_loads == 0U));
+	CHECK(torn_ok);
+
+	/* After a cut before the header crc, the next save redoes the compaction */
+	restore();
+	reboot();
+	model = old_model;
+	budget = (int32_t) steps - 2;
+	CHECK(save(changes, 2U) != PARAM_STORAGE_OK);
+	CHECK((reboot() == PARAM_STORAGE_OK) && same_image(&loaded, &old_model));
+	CHECK(save(changes, 2U) == PARAM_STORAGE_OK);
+	CHECK((reboot() == PARAM_STORAGE_OK) && same_image(&loaded, &new_model) && (newest_bank() == 1U));
+}
+
+/**
+  * @brief bad record crcs skip the record, bad header crcs the bank
+  */
+static void run_crc_checks(void) {
+	image_t expect;
+
+	format();
+	save_one(KEY_BASE + 0U, 1U);		// slot 0 (compacted)
+	save_one(KEY_BASE + 1U, 10U);		// slot 1
+	save_one(KEY_BASE + 1U, 11U);		// slot 2
+	save_one(KEY_BASE + 2U, 20U);		// slot 3
+
+	/* A bit lost in the value of the last K1 record: the older value stays */
+	clear_bit(0U, record_offset(2U) + 4U, 3U);
+	expect = model;
+	expect.value[1] = 10U;
+	CHECK((reboot() == PARAM_STORAGE_ERROR_WARN) && same_image(&loaded, &expect));
+
+	/* ... and in the key of the only K2 record: K2 is not restored */
+	clear_bit(0U, record_offset(3U), 12U);
+	expect.set[2] = false;
+	CHECK((reboot() == PARAM_STORAGE_ERROR_WARN) && same_image(&loaded, &expect));
+
+	/* Later saves still append and load */
+	CHECK(save_one(KEY_BASE + 2U, 21U) == PARAM_STORAGE_OK);
+	expect.set[2] = true;
+	expect.value[2] = 21U;
+	CHECK((reboot() == PARAM_STORAGE_ERROR_WARN) && same_image(&loaded, &expect));
+
+	/* Compaction rewrites what loaded (params.c compacts its values), so the
+	 * bad records are gone from the new bank */
+	model = expect;
+	for (uint32_t i = 0; (i < 1000U) && (newest_bank() == 0U); ++i)
+		save_one(KEY_BASE + 3U, 30U + i);
+	CHECK((newest_bank() == 1U) && (reboot() == PARAM_STORAGE_OK) && same_image(&loaded, &model));
+
+	/* A bad header crc on the newest bank: the older bank loads */
+	{
+		header_t h;
+		uint32_t bit = 16U;
+
+		read_header(1U, &h);
+		while (!(h.crc & (1U << (bit - 16U))))
+			bit++;
+		clear_bit(1U, 8U, bit);			// a set bit of the crc of bank 1
+
+		read_header(0U, &h);
+		CHECK(header_valid(&h) && (newest_bank() == 0U));
+		CHECK((reboot() == PARAM_STORAGE_ERROR_WARN) && loaded.set[0] && (loaded.value[0] == 1U));
+	}
+}
+
+/**
+  * @brief a record torn by a power cut in the middle of its write
+  */
+static void run_torn_write_checks(void) {
+	image_t before;
+	bool kept = true, warned = true, appended = true;
+
+	format();
+	save_one(KEY_BASE + 0U, 1U);
+	save_one(KEY_BASE + 1U, 2U);
+	save_one(KEY_BASE + 1U, 3U);
+	snapshot();
+	before = model;
+
+	for (uint32_t cut = 0; cut < 2U; ++cut) {
+		for (uint32_t torn = 0; torn < 2U; ++torn) {
+			param_storage_status_t status;
+			bool slot_burnt = (cut > 0U) || torn;
+
+			restore();
+			reboot();
+			model = before;
+			budget = (int32_t) cut;
+			tear = torn;
+			CHECK(save_one(KEY_BASE + 1U, 4U) != PARAM_STORAGE_OK);
+
+			status = reboot();
+			kept &= same_image(&loaded, &before);
+			warned &= (status == (slot_burnt ? PARAM_STORAGE_ERROR_WARN : PARAM_STORAGE_OK));
+
+			/* The next save goes behind the burnt slot */
+			model = before;
+			save_one(KEY_BASE + 0U, 5U);
+			status = reboot();
+			appended &= same_image(&loaded, &model) && (used_slots(0U) == (slot_burnt ? 4U : 3U) + 1U);
+			appended &= (status == (slot_burnt ? PARAM_STORAGE_ERROR_WARN : PARAM_STORAGE_OK));
+		}
+	}
+
+	CHECK(kept);
+	CHECK(warned);
+	CHECK(appended);
+}
+
+/**
+  * @brief helper function to write a bank as an older or newer firmware did
+  */
+static void write_bank(uint8_t bank, uint16_t version, uint32_t seq, const param_entry_t *e, uint32_t n) {
+	header_t h = {.magic = STORAGE_MAGIC, .seq = seq, .version = version, .reserved = 0xFFFFFFFFUL};
+
+	ram_param_flash.erase(bank);
+
+	for (uint32_t i = 0; i < n; ++i) {
+		const uint8_t buf[6] = {(uint8_t) e[i].key, (uint8_t) (e[i].key >> 8),
+								(uint8_t) e[i].value, (uint8_t) (e[i].value >> 8),
+								(uint8_t) (e[i].value >> 16), (uint8_t) (e[i].value >> 24)};
+		const uint32_t words[2] = {(uint32_t) e[i].key | ((uint32_t) crc16_ccitt(buf, sizeof(buf)) << 16), e[i].value};
+
+		ram_param_flash.program(bank, HEADER_SIZE + i * RECORD_SIZE, words, 2U);
+	}
+
+	h.crc = crc16_ccitt((const uint8_t*) &h, 10U);
+	ram_param_flash.program(bank, 0U, (const uint32_t*) &h, HEADER_SIZE / 4U);
+}
+
+static uint32_t f2u(float f) {
+	uint32_t u;
+	memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+/**
+  * @brief banks of the previous storage version through params.c
+  */
+static void run_migration_checks(void) {
+	const float liftoff_def = params_get_def(PARAM_ESC_CMD_LIFTOFF_PCT)->def;
+	param_entry_t v1[3] = {
+		{KEY_ESC_LIFTOFF_PCT, f2u(55.0f)},
+		{KEY_ROLL_RATE_P, f2u(0.5f)},
+		{KEY_UNKNOWN, 1U}				// removed parameter: ignored
+	};
+	header_t h;
+
+	CHECK(PARAM_STORAGE_VERSION == 2U);
+
+	/* v1 liftoff above the new cap is clamped, not dropped to the default */
+	ram_param_flash_format();
+	write_bank(0U, 1U, 5U, v1, 3U);
+	CHECK(params_init() == PARAM_OK);
+	CHECK(params_get_float(PARAM_ESC_CMD_LIFTOFF_PCT) == 50.0f);
+	CHECK(params_get_float(PARAM_ROLL_RATE_P) == 0.5f);
+
+	/* The next save rewrites the bank as the current version */
+	CHECK(params_set(PARAM_ROLL_RATE_P, 0.6f) == PARAM_OK);
+	CHECK(params_save() == PARAM_OK);
+	read_header(1U, &h);
+	CHECK(header_valid(&h) && (h.version == PARAM_STORAGE_VERSION) && (h.seq == 6U));
+	CHECK((params_init() == PARAM_OK) && (params_get_float(PARAM_ESC_CMD_LIFTOFF_PCT) == 50.0f) &&
+		  (params_get_float(PARAM_ROLL_RATE_P) == 0.6f));
+
+	/* v1 values within the cap are kept as they are */
+	v1[0].value = f2u(45.0f);
+	ram_param_flash_format();
+	write_bank(0U, 1U, 1U, v1, 2U);
+	CHECK((params_init() == PARAM_OK) && (params_get_float(PARAM_ESC_CMD_LIFTOFF_PCT) == 45.0f));
+
+	/* A NaN is not clamped into a value */
+	v1[0].value = f2u(NAN);
+	ram_param_flash_format();
+	write_bank(0U, 1U, 1U, v1, 1U);
+	CHECK((params_init() == PARAM_ERROR_WARN) && (params_get_float(PARAM_ESC_CMD_LIFTOFF_PCT) == liftoff_def));
+
+	/* Current version records are not migrated: out of bounds is rejected */
+	v1[0].value = f2u(55.0f);
+	ram_param_flash_format();
+	write_bank(0U, PARAM_STORAGE_VERSION, 1U, v1, 1U);
+	CHECK((params_init() == PARAM_ERROR_WARN) && (params_get_float(PARAM_ESC_CMD_LIFTOFF_PCT) == liftoff_def));
+
+	/* Newer firmware's bank: left alone, defaults in effect */
+	v1[0].value = f2u(30.0f);
+	ram_param_flash_format();
+	write_bank(0U, PARAM_STORAGE_VERSION + 1U, 1U, v1, 1U);
+	CHECK((params_init() == PARAM_OK) && (params_get_float(PARAM_ESC_CMD_LIFTOFF_PCT) == liftoff_def));
+}
+
+/**
+  * @brief esc pair bounds, ordered pairs and parameter names
+  */
+static void run_registry_checks(void) {
+	const param_def_t *idle = params_get_def(PARAM_ESC_CMD_IDLE_PCT);
+	const param_def_t *liftoff = params_get_def(PARAM_ESC_CMD_LIFTOFF_PCT);
+	const param_def_t *limit = params_get_def(PARAM_ESC_CMD_LIMIT_PCT);
+	const param_def_t *pulse_min = params_get_def(PARAM_RC_PULSE_MIN_US);
+	const param_def_t *pulse_max = params_get_def(PARAM_RC_PULSE_MAX_US);
+	param_entry_t crossed[2] = {
+		{KEY_ESC_IDLE_PCT, f2u(30.0f)},
+		{KEY_ESC_LIFTOFF_PCT, f2u(20.0f)}		// each within its range, idle above liftoff
+	};
+	bool short_names = true, unique = true, unprefixed = true;
+
+	ram_param_flash_format();
+	params_init();
+
+	/* Idle and liftoff can never be set above the limit */
+	CHECK((idle->max <= limit->min) && (liftoff->max <= limit->min));
+	CHECK(params_set(PARAM_ESC_CMD_LIMIT_PCT, limit->min) == PARAM_OK);
+	CHECK(params_set(PARAM_ESC_CMD_LIFTOFF_PCT, limit->min + 1.0f) == PARAM_ERROR_WARN);
+	CHECK(params_set(PARAM_ESC_CMD_LIFTOFF_PCT, liftoff->max) == PARAM_OK);
+
+	/* Idle stays below liftoff, set from either side */
+	CHECK(params_set(PARAM_ESC_CMD_LIFTOFF_PCT, 20.0f) == PARAM_OK);
+	CHECK(params_set(PARAM_ESC_CMD_IDLE_PCT, 20.0f) == PARAM_ERROR_WARN);
+	CHECK(params_set(PARAM_ESC_CMD_IDLE_PCT, 19.0f) == PARAM_OK);
+	CHECK((params_set(PARAM_ESC_CMD_LIFTOFF_PCT, 10.0f) == PARAM_ERROR_WARN) &&
+		  (params_get_float(PARAM_ESC_CMD_LIFTOFF_PCT) == 20.0f));
+
+	/* The rc pulse ranges cannot meet, so the span stays positive */
+	CHECK((pulse_min->max < pulse_max->min) && (pulse_min->def < pulse_max->def));
+
+	/* A bank with a crossed pair loads both defaults */
+	ram_param_flash_format();
+	write_bank(0U, PARAM_STORAGE_VERSION, 1U, crossed, 2U);
+	CHECK(params_init() == PARAM_ERROR_WARN);
+	CHECK((params_get_float(PARAM_ESC_CMD_IDLE_PCT) == idle->def) &&
+		  (params_get_float(PARAM_ESC_CMD_LIFTOFF_PCT) == liftoff->def));
+
+	/* Names fit the descriptor whole and are found by name (sitl, replay) */
+	for (uint32_t a = 0; a < PARAM_COUNT; ++a) {
+		const char *na = params_get_def((param_id_t) a)->name;
+
+		short_names &= (strlen(na) > 0U) && (strlen(na) <= PARAM_NAME_LEN_MAX);
+		unprefixed &= (strncmp(na, "PARAM_", 6U) != 0);
+		for (uint32_t b = a + 1U; b < PARAM_COUNT; ++b)
+			unique &= (strcmp(na, params_get_def((param_id_t) b)->name) != 0);
+	}
+
+	CHECK(short_names);
+	CHECK(unique);
+	CHECK(unprefixed);
+	CHECK(strcmp(params_get_def(PARAM_PITCH_ANGLE_I_CMD_LIM)->name, "PITCH_ANG_I_LIM") == 0);
+}
+
+int main(int argc, char **argv) {
+	if (argc > 1) {
+		fprintf(stderr, "usage: %s\n", argv[0]);
+		return 2;
+	}
+
+	fault_flash = ram_param_flash;
+	fault_flash.erase = fault_erase;
+	fault_flash.program = fault_program;
+	CHECK(ram_param_flash.bank_size <= sizeof(snap[0]));
+
+	run_append_checks();
+	run_compaction_checks();
+	run_power_loss_checks();
+	run_crc_checks();
+	run_torn_write_checks();
+	run_migration_checks();
+	run_registry_checks();
+	printf("{\"mode\": \"checks\", \"checks\": %u, \"failed\": %u}\n", checks, failures);
+
+	return failures ? 1 : 0;
+}
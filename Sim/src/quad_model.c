@@ -0,0 +1,227 @@
+/*
+ * quad_model.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <string.h>
+#include "quad_model.h"
+
+/**
+  * @brief helper function to rotate a vector by a quaternion (v' = q v q*)
+  *
+  * @retval None
+  */
+static void quat_rotate(const float q[4], const float v[3], float out[3]) {
+	const float w = q[0], x = q[1], y = q[2], z = q[3];
+
+	out[0] = (1.0f - 2.0f * (y * y + z * z)) * v[0] + 2.0f * (x * y - w * z) * v[1] + 2.0f * (x * z + w * y) * v[2];
+	out[1] = 2.0f * (x * y + w * z) * v[0] + (1.0f - 2.0f * (x * x + z * z)) * v[1] + 2.0f * (y * z - w * x) * v[2];
+	out[2] = 2.0f * (x * z - w * y) * v[0] + 2.0f * (y * z + w * x) * v[1] + (1.0f - 2.0f * (x * x + y * y)) * v[2];
+}
+
+/**
+  * @brief helper function to rotate a vector by a conjugate quaternion (v' = q* v q)
+  *
+  * @retval None
+  */
+static void quat_rotate_inv(const float q[4], const float v[3], float out[3]) {
+	const float qc[4] = {q[0], -q[1], -q[2], -q[3]};
+	quat_rotate(qc, v, out);
+}
+
+/**
+  * @brief helper function to integrate body rates into the attitude quaternion
+  *
+  * @retval None
+  */
+static void quat_integrate(float q[4], const float w[3], float dt) {
+	const float h = 0.5f * dt;
+	float n;
+	float dq[4] = {
+		-q[1] * w[0] - q[2] * w[1] - q[3] * w[2],
+		 q[0] * w[0] + q[2] * w[2] - q[3] * w[1],
+		 q[0] * w[1] - q[1] * w[2] + q[3] * w[0],
+		 q[0] * w[2] + q[1] * w[1] - q[2] * w[0]
+	};
+
+	for (uint32_t i = 0; i < 4U; ++i)
+		q[i] += dq[i] * h;
+
+	n = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+	for (uint32_t i = 0; i < 4U; ++i)
+		q[i] /= n;
+}
+
+/**
+  * @brief fills model parameters for a ~600 g, 5 inch class airframe
+  * 	   (hovers near 40 % motor command)
+  *
+  * @param  params	model parameters buffer to be filled
+  * @retval None
+  */
+void quad_default_params(quad_params_t *params) {
+	params->mass_kg = 0.6f;
+	params->arm_m = 0.11f;
+	params->inertia_kgm2[0] = 5e-3f;
+	params->inertia_kgm2[1] = 5e-3f;
+	params->inertia_kgm2[2] = 4.5e-3f;
+	params->thrust_max_n = 6.0f;
+	params->thrust_curve = 0.3f;
+	params->motor_tau_s = 0.03f;
+	params->yaw_moment_m = 0.016f;
+	params->drag_linear = 0.5f;
+	params->drag_angular = 2.0e-3f;
+	params->gravity_mps2 = 9.80665f;
+}
+
+/**
+  * @brief resets state: level, at rest on the ground at the origin
+  *
+  * @param  state	model state
+  * @retval None
+  */
+void quad_reset(quad_state_t *state) {
+	memset(state, 0, sizeof(*state));
+	state->quat[0] = 1.0f;
+	state->on_ground = true;
+}
+
+/**
+  * @brief advances the model by one time step
+  *
+  * @param  state	model state
+  * @param	params	model parameters
+  * @param	cmd		normalized motor commands (0..1, clamped)
+  * @param	dt		time step (s)
+  *
+  * @retval None
+  */
+void quad_step(quad_state_t *state, const quad_params_t *params, const float cmd[QUAD_MOTOR_COUNT], float dt) {
+	const float *I = params->inertia_kgm2;
+	const float a = params->arm_m * 0.70710678f;	// X frame lever arm
+	const float alpha = 1.0f - expf(-dt / params->motor_tau_s);
+	float *w = state->rate_rps;
+	float *T = state->thrust_n;
+	float thrust = 0.0f;
+	float torque[3];
+	float force_b[3];
+	float force_w[3];
+
+	/* Motors: first-order lag towards command, then thrust curve */
+	for (uint32_t i = 0; i < QUAD_MOTOR_COUNT; ++i) {
+		float u = fminf(fmaxf(cmd[i], 0.0f), 1.0f);
+		float m;
+
+		state->motor[i] += (u - state->motor[i]) * alpha;
+		m = state->motor[i];
+		T[i] = params->thrust_max_n * ((1.0f - params->thrust_curve) * m * m + params->thrust_curve * m);
+		thrust += T[i];
+	}
+
+	/* Body torques (see mixer for motor layout and spin directions) */
+	torque[0] = a * (T[0] + T[1] - T[2] - T[3]) - params->drag_angular * w[0];
+	torque[1] = a * (-T[0] + T[1] - T[2] + T[3]) - params->drag_angular * w[1];
+	torque[2] = params->yaw_moment_m * (T[0] - T[1] - T[2] + T[3]) - params->drag_angular * w[2];
+
+	/* Translational dynamics in world frame */
+	force_b[0] = 0.0f;
+	force_b[1] = 0.0f;
+	force_b[2] = thrust;
+	quat_rotate(state->quat, force_b, force_w);
+
+	for (uint32_t i = 0; i < 3U; ++i)
+		state->accel_mps2[i] = (force_w[i] - params->drag_linear * state->vel_mps[i]) / params->mass_kg;
+	state->accel_mps2[2] -= params->gravity_mps2;
+
+	/* Ground contact: resting until thrust exceeds weight */
+	if (state->on_ground && (state->accel_mps2[2] <= 0.0f)) {
+		memset(state->accel_mps2, 0, sizeof(state->accel_mps2));
+		memset(state->vel_mps, 0, sizeof(state->vel_mps));
+		memset(state->rate_rps, 0, sizeof(state->rate_rps));
+		return;
+	}
+	state->on_ground = false;
+
+	/* Rotational dynamics (Euler's equations, diagonal inertia) */
+	const float dw[3] = {
+		(torque[0] - (I[2] - I[1]) * w[1] * w[2]) / I[0],
+		(torque[1] - (I[0] - I[2]) * w[2] * w[0]) / I[1],
+		(torque[2] - (I[1] - I[0]) * w[0] * w[1]) / I[2]
+	};
+
+	for (uint32_t i = 0; i < 3U; ++i) {
+		w[i] += dw[i] * dt;
+		state->vel_mps[i] += state->accel_mps2[i] * dt;
+		state->pos_m[i] += state->vel_mps[i] * dt;
+	}
+
+	quat_integrate(state->quat, w, dt);
+
+	/* Touchdown: stop and settle level on the landing gear, keep heading */
+	if (state->pos_m[2] <= 0.0f) {
+		float roll, pitch, yaw;
+
+		quad_euler_deg(state, &roll, &pitch, &yaw);
+		yaw *= 0.5f * 3.14159265f / 180.0f;
+
+		state->pos_m[2] = 0.0f;
+		memset(state->vel_mps, 0, sizeof(state->vel_mps));
+		memset(state->rate_rps, 0, sizeof(state->rate_rps));
+		memset(state->accel_mps2, 0, sizeof(state->accel_mps2));
+		state->quat[0] = cosf(yaw);
+		state->quat[1] = 0.0f;
+		state->quat[2] = 0.0f;
+		state->quat[3] = sinf(yaw);
+		state->on_ground = true;
+	}
+}
+
+/**
+  * @brief computes the specific force an accelerometer would measure
+  *
+  * @param  state	model state
+  * @param	params	model parameters
+  * @param	out		body frame specific force (m/s^2), +z when level at rest
+  *
+  * @retval None
+  */
+void quad_specific_force(const quad_state_t *state, const quad_params_t *params, float out[3]) {
+	const float f_w[3] = {state->accel_mps2[0], state->accel_mps2[1], state->accel_mps2[2] + params->gravity_mps2};
+	quat_rotate_inv(state->quat, f_w, out);
+}
+
+/**
+  * @brief rotates a world frame vector into the body frame
+  *
+  * @param  state	model state
+  * @param	v		world frame vector
+  * @param	out		body frame vector
+  *
+  * @retval None
+  */
+void quad_world_to_body(const quad_state_t *state, const float v[3], float out[3]) {
+	quat_rotate_inv(state->quat, v, out);
+}
+
+/**
+  * @brief computes Euler angles (z-y-x) in the firmware sign convention
+  *
+  * @param  state	model state
+  * @param	roll	roll angle (deg, right side down positive)
+  * @param	pitch	pitch angle (deg, nose down positive)
+  * @param	yaw		heading (deg, counter-clockwise from above positive)
+  *
+  * @retval None
+  */
+void quad_euler_deg(const quad_state_t *state, float *roll, float *pitch, float *yaw) {
+	const float w = state->quat[0], x = state->quat[1], y = state->quat[2], z = state->quat[3];
+	const float r2d = 180.0f / 3.14159265f;
+	float s = fminf(fmaxf(2.0f * (w * y - z * x), -1.0f), 1.0f);
+
+	*roll = atan2f(2.0f * (w * x + y * z), 1.0f - 2.0f * (x * x + y * y)) * r2d;
+	*pitch = asinf(s) * r2d;
+	*yaw = atan2f(2.0f * (w * z + x * y), 1.0f - 2.0f * (y * y + z * z)) * r2d;
+}
@@ -0,0 +1,91 @@
+/*
+ * ram_param_flash.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "params/flash/ram_param_flash.h"
+#include "sim_hw.h"
+
+/**
+  * @brief  Emulated Bank Size (plenty for the registry, small enough to
+  * 		exercise compaction in long runs)
+  */
+#define RAM_PARAM_BANK_SIZE		4096U
+
+/**
+  * @brief  Emulated Flash Banks
+  */
+static uint8_t banks[PARAM_STORAGE_BANK_COUNT][RAM_PARAM_BANK_SIZE];
+static bool formatted;
+
+
+/**
+  * @brief erases all banks (blank storage, as on a freshly flashed board)
+  *
+  * @retval None
+  */
+void ram_param_flash_format(void) {
+	memset(banks, 0xFF, sizeof(banks));
+	formatted = true;
+}
+
+/**
+  * @brief helper function to start from erased banks on first access
+  *
+  * @retval None
+  */
+static inline void ensure_formatted(void) {
+	if (!formatted)
+		ram_param_flash_format();
+}
+
+static const uint8_t *ram_bank_addr(uint8_t bank) {
+	ensure_formatted();
+	return banks[bank];
+}
+
+static bool ram_erase(uint8_t bank) {
+	if (bank >= PARAM_STORAGE_BANK_COUNT)
+		return false;
+
+	ensure_formatted();
+
+	memset(banks[bank], 0xFF, RAM_PARAM_BANK_SIZE);
+	return true;
+}
+
+/**
+  * @brief programs words like NOR flash: bits can only be cleared
+  *
+  * @retval boolean
+  */
+static bool ram_program(uint8_t bank, uint32_t offset, const uint32_t *words, uint32_t count) {
+	uint32_t cell;
+
+	if ((bank >= PARAM_STORAGE_BANK_COUNT) || (offset % 4U) ||
+		((offset + count * 4U) > RAM_PARAM_BANK_SIZE))
+		return false;
+
+	ensure_formatted();
+
+	for (uint32_t i = 0; i < count; ++i) {
+		memcpy(&cell, &banks[bank][offset + i * 4U], sizeof(cell));
+		cell &= words[i];
+		memcpy(&banks[bank][offset + i * 4U], &cell, sizeof(cell));
+	}
+
+	return true;
+}
+
+/**
+  * @brief ram param flash driver initialization
+  */
+const param_flash_interface_t ram_param_flash = {
+	.bank_size = RAM_PARAM_BANK_SIZE,
+	.bank_addr = ram_bank_addr,
+	.erase = ram_erase,
+	.program = ram_program
+};
@@ -0,0 +1,430 @@
+/*
+ * registry_main.c (driver registry host test)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include "system/driver_registry.h"
+#include "sensors/imu/devices/lsm6dsox.h"
+#include "rx/rx.h"
+#include "rx/protocols/sim_rx.h"
+#include "esc/protocols/sim_esc.h"
+#include "lsm6dsox_reg.h"
+#include "common/settings.h"
+#include "sim_hw.h"
+
+/*
+ * system/driver_registry.c binds the drivers linked into this tool: the
+ * lsm6dsox driver on a fake bus, the sim rx and esc drivers, and fake imu
+ * and rx drivers registered below. First every entry is listed and checked
+ * for a sane shape, one line each:
+ *
+ *   {"driver": "lsm6dsox", "class": "imu", "instances": 2, "probe": true}
+ *
+ * Then the imu class is bound as imu.c binds it, with the devices present
+ * on the bus varied: a detected driver beats a weaker match, nothing
+ * present binds nothing, an instance a driver does not have skips it, and
+ * no probe writes to the bus. The bound interface is the driver's own and
+ * runs init. The lsm6dsox is then probed on a fake i2c handle through its
+ * platform bus (the HAL calls below): a probe leaves the instance as it
+ * was, and only a bind gives it the bus and address init talks to. Last,
+ * the rx class falls back to the sim driver until the fake rx is detected,
+ * through rx.c:
+ *
+ *   {"mode": "checks", "checks": 55, "failed": 0}
+ *
+ * The exit status is 1 if any check fails.
+ */
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+/**
+  * @brief  Fake LSM6DSOX (flat register file; software reset completes immediately)
+  */
+#define FAKE_REGS_SIZE			128U
+
+typedef struct {
+	uint8_t regs[FAKE_REGS_SIZE];
+	uint32_t writes;
+} fake_dev_t;
+
+/**
+  * @brief  Fake Chip (another imu on the same bus, probed through bus.handle)
+  */
+#define FAKE_IMU_ID				0x5AU
+#define FAKE_IMU_SCORE			(DRIVER_SCORE_DETECTED / 2U)	// a weaker match (e.g. a compatible id)
+
+typedef struct {
+	uint8_t id;
+	uint32_t probes;
+} fake_chip_t;
+
+/**
+  * @brief  Fake I2C Bus (the lsm6dsox platform bus: the fake device at any
+  * 		address on fake_i2c, nothing on any other handle)
+  */
+#define FAKE_I2C_ADDR			0x6AU
+#define FAKE_I2C_ADDR_OTHER		0x42U
+
+typedef struct {
+	const I2C_HandleTypeDef *handle;	// last access
+	uint16_t address;
+	uint32_t accesses;
+} fake_i2c_log_t;
+
+static unsigned checks;
+static unsigned failures;
+static fake_dev_t dev;
+static fake_chip_t chip;
+static I2C_HandleTypeDef fake_i2c;
+static fake_i2c_log_t i2c_log;
+static bool fake_rx_present;		// the fake rx "answers" its autobaud probe
+static uint32_t fake_imu_inits;
+
+
+static void check(bool cond, const char *what, int line) {
+	checks++;
+
+	if (!cond) {
+		failures++;
+		fprintf(stderr, "registry_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+static int32_t fake_read(uint8_t reg, uint8_t *bufp, uint16_t len) {
+	for (uint16_t i = 0; i < len; ++i)
+		bufp[i] = dev.regs[(reg + i) & (FAKE_REGS_SIZE - 1U)];
+
+	return 0;
+}
+
+static int32_t fake_write(uint8_t reg, const uint8_t *bufp, uint16_t len) {
+	for (uint16_t i = 0; i < len; ++i)
+		dev.regs[(reg + i) & (FAKE_REGS_SIZE - 1U)] = bufp[i];
+
+	dev.regs[LSM6DSOX_CTRL3_C] &= (uint8_t) ~0x01U;
+	dev.writes++;
+
+	return 0;
+}
+
+static const lsm6dsox_bus_t fake_bus = {.read = fake_read, .write = fake_write};
+
+/*
+ * HAL bus functions the lsm6dsox driver links against (in place of
+ * bench_hal.c), logging each access
+ */
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+									uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+	(void) MemAddSize; (void) Timeout;
+
+	i2c_log = (fake_i2c_log_t) {.handle = hi2c, .address = DevAddress, .accesses = i2c_log.accesses + 1U};
+	if (hi2c != &fake_i2c)
+		return HAL_ERROR;
+
+	fake_write((uint8_t) MemAddress, pData, Size);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress,
+								   uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+	(void) MemAddSize; (void) Timeout;
+
+	i2c_log = (fake_i2c_log_t) {.handle = hi2c, .address = DevAddress, .accesses = i2c_log.accesses + 1U};
+	if (hi2c != &fake_i2c)
+		return HAL_ERROR;
+
+	fake_read((uint8_t) MemAddress, pData, Size);
+	return HAL_OK;
+}
+
+void HAL_Delay(uint32_t Delay) {
+	(void) Delay;
+}
+
+/**
+  * @brief  Fake IMU Driver (one instance)
+  */
+static uint8_t fake_imu_probe(const driver_bus_t *bus) {
+	if (bus->handle != &chip)
+		return DRIVER_SCORE_NONE;
+
+	chip.probes++;
+
+	return (chip.id == FAKE_IMU_ID) ? FAKE_IMU_SCORE : DRIVER_SCORE_NONE;
+}
+
+static imu_status_t fake_imu_init(void) { fake_imu_inits++; return IMU_OK; }
+static imu_status_t fake_imu_deinit(void) { return IMU_OK; }
+static imu_status_t fake_imu_read(void *data) { (void) data; return IMU_OK; }
+
+static const imu_interface_t fake_imu_driver = {
+	.init = fake_imu_init,
+	.deinit = fake_imu_deinit,
+	.read = fake_imu_read
+};
+
+DRIVER_REGISTER(fake_imu_entry) = {
+	.name = "fake_imu",
+	.cls = DRIVER_CLASS_IMU,
+	.instances = 1U,
+	.probe = fake_imu_probe,
+	.interfaces = {&fake_imu_driver}
+};
+
+/**
+  * @brief  Fake Rx Driver (detected when present, as a serial receiver
+  * 		answering at some baud rate would be)
+  */
+#define FAKE_RX_CHANNEL			1234U
+
+static uint8_t fake_rx_probe(const driver_bus_t *bus) {
+	(void) bus;
+	return fake_rx_present ? DRIVER_SCORE_DETECTED : DRIVER_SCORE_NONE;
+}
+
+static rx_status_t fake_rx_ok(void) { return RX_OK; }
+static uint32_t fake_rx_get_channel(const uint8_t ch) { (void) ch; return FAKE_RX_CHANNEL; }
+
+static const rx_protocol_interface_t fake_rx_driver = {
+	.init = fake_rx_ok,
+	.deinit = fake_rx_ok,
+	.start = fake_rx_ok,
+	.stop = fake_rx_ok,
+	.get_channel = fake_rx_get_channel
+};
+
+DRIVER_REGISTER(fake_rx_entry) = {
+	.name = "fake_rx",
+	.cls = DRIVER_CLASS_RX,
+	.instances = 1U,
+	.probe = fake_rx_probe,
+	.interfaces = {&fake_rx_driver}
+};
+
+/**
+  * @brief helper function to get a class name
+  */
+static const char* class_name(driver_class_t cls) {
+	switch (cls) {
+		case DRIVER_CLASS_IMU: return "imu";
+		case DRIVER_CLASS_RX: return "rx";
+		case DRIVER_CLASS_ESC: return "esc";
+		default: return "?";
+	}
+}
+
+/**
+  * @brief helper function to get a registered entry by name
+  */
+static const driver_entry_t* find(const char *name, driver_class_t cls) {
+	for (uint32_t i = 0; i < driver_count(); ++i) {
+		const driver_entry_t *e = driver_get(i);
+
+		if ((e->cls == cls) && (strcmp(e->name, name) == 0))
+			return e;
+	}
+
+	return NULL;
+}
+
+/**
+  * @brief helper function to get the name of a bound entry ("none" if nothing)
+  */
+static const char* bound_name(driver_class_t cls, const void *handle, uint8_t instance) {
+	const driver_bus_t bus = {.handle = handle, .address = 0U, .instance = instance};
+	const driver_entry_t *e = driver_bind(cls, &bus);
+
+	return e ? e->name : "none";
+}
+
+/**
+  * @brief lists the registered entries and checks their shape
+  */
+static void run_list_checks(void) {
+	uint32_t count = driver_count();
+
+	CHECK(count == 5U);		// the fakes, lsm6dsox, sim rx and sim esc
+	CHECK(driver_get(count) == NULL);
+
+	for (uint32_t i = 0; i < count; ++i) {
+		const driver_entry_t *e = driver_get(i);
+		bool shaped = e->name && (e->cls < DRIVER_CLASS_COUNT) &&
+					  (e->instances >= 1U) && (e->instances <= DRIVER_INSTANCES_MAX);
+
+		for (uint8_t k = 0; shaped && (k < e->instances); ++k)
+			shaped = (e->interfaces[k] != NULL);
+
+		printf("{\"driver\": \"%s\", \"class\": \"%s\", \"instances\": %u, \"probe\": %s}\n",
+			   e->name, class_name(e->cls), e->instances, e->probe ? "true" : "false");
+		CHECK(shaped);
+	}
+
+	CHECK(find("lsm6dsox", DRIVER_CLASS_IMU) && find("fake_imu", DRIVER_CLASS_IMU));
+	CHECK(find("sim", DRIVER_CLASS_RX) && find("fake_rx", DRIVER_CLASS_RX));
+	CHECK(find("sim", DRIVER_CLASS_ESC));
+}
+
+/**
+  * @brief binds the imu class with the devices on the bus varied
+  */
+static void run_imu_checks(void) {
+	const driver_bus_t bus = {.handle = &chip, .address = 0U, .instance = 0U};
+	const driver_entry_t *e;
+
+	memset(&dev, 0, sizeof(dev));
+	memset(&chip, 0, sizeof(chip));
+	lsm6dsox_set_instance_bus(LSM6DSOX_PRIMARY, &fake_bus);
+	lsm6dsox_set_instance_bus(LSM6DSOX_SECONDARY, &fake_bus);
+
+	/* Nothing on the bus: nothing bound (imu.c takes the instance offline) */
+	CHECK(strcmp(bound_name(DRIVER_CLASS_IMU, &chip, 0U), "none") == 0);
+	CHECK(chip.probes == 1U);
+
+	/* The weaker match alone is bound */
+	chip.id = FAKE_IMU_ID;
+	e = driver_bind(DRIVER_CLASS_IMU, &bus);
+	CHECK(e && (strcmp(e->name, "fake_imu") == 0) && (e->interfaces[0] == &fake_imu_driver));
+
+	/* The lsm6dsox read back beats it, for both instances */
+	dev.regs[LSM6DSOX_WHO_AM_I] = LSM6DSOX_ID;
+	e = driver_bind(DRIVER_CLASS_IMU, &bus);
+	CHECK(e && (strcmp(e->name, "lsm6dsox") == 0) && (e->interfaces[0] == &lsm6dsox_driver));
+	CHECK(strcmp(bound_name(DRIVER_CLASS_IMU, &chip, 1U), "lsm6dsox") == 0);
+	CHECK(find("lsm6dsox", DRIVER_CLASS_IMU)->interfaces[1] == &lsm6dsox_secondary_driver);
+
+	/* Instance 1 skips the one-instance driver (not even probed) */
+	dev.regs[LSM6DSOX_WHO_AM_I] = 0x00U;
+	chip.probes = 0U;
+	CHECK(strcmp(bound_name(DRIVER_CLASS_IMU, &chip, 1U), "none") == 0);
+	CHECK(chip.probes == 0U);
+	CHECK(strcmp(bound_name(DRIVER_CLASS_IMU, &chip, DRIVER_INSTANCES_MAX), "none") == 0);
+
+	/* A wrong id is not detected, and no probe wrote to the bus */
+	dev.regs[LSM6DSOX_WHO_AM_I] = (uint8_t) (LSM6DSOX_ID + 1U);
+	chip.id = 0x00U;
+	CHECK(strcmp(bound_name(DRIVER_CLASS_IMU, &chip, 0U), "none") == 0);
+	CHECK(dev.writes == 0U);
+
+	/* Binding is repeatable (the same entry for the same bus) */
+	dev.regs[LSM6DSOX_WHO_AM_I] = LSM6DSOX_ID;
+	chip.id = FAKE_IMU_ID;
+	e = driver_bind(DRIVER_CLASS_IMU, &bus);
+	CHECK(e == driver_bind(DRIVER_CLASS_IMU, &bus));
+
+	/* The bound interface runs the driver (imu.c calls it from here on) */
+	if (e) {
+		const imu_interface_t *imu = e->interfaces[0];
+
+		CHECK(lsm6dsox_set_loop_rate(CONFIG_IMU_LOOP_RATE_HZ) == IMU_OK);
+		CHECK(imu->init() == IMU_OK);
+		CHECK((dev.writes > 0U) && (fake_imu_inits == 0U));
+		CHECK((dev.regs[LSM6DSOX_CTRL1_XL] >> 4) == ((uint8_t) lsm6dsox_get_config()->odr_xl & 0x0FU));
+		CHECK(imu->deinit() == IMU_OK);
+	}
+
+	/* Through the fake's own interface once it is the only one there */
+	dev.regs[LSM6DSOX_WHO_AM_I] = 0x00U;
+	e = driver_bind(DRIVER_CLASS_IMU, &bus);
+	CHECK(e && (((const imu_interface_t*) e->interfaces[0])->init() == IMU_OK) && (fake_imu_inits == 1U));
+
+	lsm6dsox_set_instance_bus(LSM6DSOX_PRIMARY, NULL);
+	lsm6dsox_set_instance_bus(LSM6DSOX_SECONDARY, NULL);
+}
+
+/**
+  * @brief probes and binds the lsm6dsox on its platform bus (no override)
+  */
+static void run_platform_checks(void) {
+	const driver_entry_t *lsm = find("lsm6dsox", DRIVER_CLASS_IMU);
+	const driver_bus_t bus = {.handle = &fake_i2c, .address = FAKE_I2C_ADDR, .instance = 0U};
+	const driver_bus_t other = {.handle = &fake_i2c, .address = FAKE_I2C_ADDR_OTHER, .instance = 0U};
+	const driver_bus_t secondary = {.handle = &fake_i2c, .address = 0U, .instance = 1U};
+
+	memset(&dev, 0, sizeof(dev));
+	memset(&i2c_log, 0, sizeof(i2c_log));
+	if (!lsm)
+		return;
+
+	/* No platform bus yet, as at boot (the imu checks bound one) */
+	lsm6dsox_set_platform(LSM6DSOX_PRIMARY, NULL, LSM6DSOX_I2C_ADD_L);
+	lsm6dsox_set_platform(LSM6DSOX_SECONDARY, NULL, LSM6DSOX_I2C_ADD_H);
+
+	/* Nothing detected: the probe read the bus, the instance got none of it */
+	dev.regs[LSM6DSOX_WHO_AM_I] = (uint8_t) (LSM6DSOX_ID + 1U);
+	CHECK(driver_bind(DRIVER_CLASS_IMU, &bus) == NULL);
+	CHECK((i2c_log.accesses > 0U) && (i2c_log.handle == &fake_i2c) && (i2c_log.address == FAKE_I2C_ADDR));
+	i2c_log.accesses = 0U;
+	CHECK(lsm6dsox_driver.init() == IMU_ERROR_FATAL);
+	CHECK(i2c_log.accesses == 0U);
+
+	/* Detected by a bare probe (as driver_bind scores it): still not bound */
+	dev.regs[LSM6DSOX_WHO_AM_I] = LSM6DSOX_ID;
+	CHECK(lsm->probe(&bus) == DRIVER_SCORE_DETECTED);
+	i2c_log.accesses = 0U;
+	CHECK(lsm6dsox_driver.init() == IMU_ERROR_FATAL);
+	CHECK(i2c_log.accesses == 0U);
+
+	/* Bound: init talks to the bus and address it was probed on */
+	CHECK(driver_bind(DRIVER_CLASS_IMU, &bus) == lsm);
+	CHECK(lsm6dsox_set_loop_rate(CONFIG_IMU_LOOP_RATE_HZ) == IMU_OK);
+	CHECK(lsm6dsox_driver.init() == IMU_OK);
+	CHECK((i2c_log.handle == &fake_i2c) && (i2c_log.address == FAKE_I2C_ADDR) && (dev.writes > 0U));
+	CHECK(lsm6dsox_driver.deinit() == IMU_OK);
+
+	/* A later probe elsewhere does not move the bound instance */
+	CHECK(lsm->probe(&other) == DRIVER_SCORE_DETECTED);
+	CHECK((lsm6dsox_driver.init() == IMU_OK) && (i2c_log.address == FAKE_I2C_ADDR));
+	CHECK(lsm6dsox_driver.deinit() == IMU_OK);
+
+	/* Address 0 binds the instance at its own (the secondary is SA0 high) */
+	CHECK(driver_bind(DRIVER_CLASS_IMU, &secondary) == lsm);
+	CHECK((lsm6dsox_secondary_driver.init() == IMU_OK) && (i2c_log.address == LSM6DSOX_I2C_ADD_H));
+	CHECK(lsm6dsox_secondary_driver.deinit() == IMU_OK);
+}
+
+/**
+  * @brief binds the rx and esc classes (fallbacks and a detected protocol)
+  */
+static void run_protocol_checks(void) {
+	const driver_entry_t *e;
+
+	/* No receiver detected: the fallback without a probe */
+	fake_rx_present = false;
+	CHECK(strcmp(bound_name(DRIVER_CLASS_RX, NULL, 0U), "sim") == 0);
+	CHECK(rx_init() == RX_OK);
+	sim_rx_set_channel(1U, 1500U);
+	CHECK(rx_get_channel(1U) == 1500U);
+	CHECK(rx_deinit() == RX_OK);
+
+	/* A detected receiver beats the fallback */
+	fake_rx_present = true;
+	CHECK(strcmp(bound_name(DRIVER_CLASS_RX, NULL, 0U), "fake_rx") == 0);
+	CHECK(rx_init() == RX_OK);
+	CHECK(rx_get_channel(1U) == FAKE_RX_CHANNEL);
+	CHECK(rx_deinit() == RX_OK);
+	fake_rx_present = false;
+
+	/* The esc class has only the fallback */
+	e = driver_bind(DRIVER_CLASS_ESC, &(const driver_bus_t){0});
+	CHECK(e && (e->interfaces[0] == &sim_esc_driver) && !sim_esc_is_running());
+}
+
+int main(int argc, char **argv) {
+	if (argc > 1) {
+		fprintf(stderr, "usage: %s\n", argv[0]);
+		return 2;
+	}
+
+	run_list_checks();
+	run_imu_checks();
+	run_platform_checks();
+	run_protocol_checks();
+	printf("{\"mode\": \"checks\", \"checks\": %u, \"failed\": %u}\n", checks, failures);
+
+	return failures ? 1 : 0;
+}
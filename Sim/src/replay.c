@@ -0,0 +1,547 @@
+/*
+ * replay.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <fcntl.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "replay.h"
+#include "sitl.h"
+#include "comms/frame.h"
+#include "flight/mixer.h"
+#include "common/maths.h"
+#include "common/settings.h"
+
+/**
+  * @brief Thrust Compensation Config Setting (same as flight.c)
+  */
+#define THRUST_COMP			CONFIG_THRUST_COMP
+
+/**
+  * @brief  Channel and Stage Names (replay_channel_t / replay_stage_t order)
+  */
+static const char *const channel_names[REPLAY_CH_COUNT] = {
+	"est_roll_deg", "est_pitch_deg", "mtr1", "mtr2", "mtr3", "mtr4"
+};
+
+static const char *const stage_names[REPLAY_STAGE_COUNT] = {
+	"estimator", "controller", "mixer"
+};
+
+/**
+  * @brief  Batched Topic Samples (MSG_TLM_BATCH; ATTITUDE, RC and MOTORS are
+  * 		kept apart and merged into the loops by timestamp once loaded)
+  */
+typedef enum {
+	BATCHED_ATTITUDE,
+	BATCHED_RC,
+	BATCHED_MOTORS,
+	BATCHED_COUNT
+} batched_topic_t;
+
+typedef struct {
+	uint8_t *data;
+	uint32_t count;
+	uint32_t capacity;
+} sample_list_t;
+
+static const struct {
+	uint8_t msg_id;
+	uint8_t size;
+	size_t offset;				// in replay_sample_t
+	uint8_t have;
+} batched_topics[BATCHED_COUNT] = {
+	[BATCHED_ATTITUDE]	= {MSG_TLM_ATTITUDE, sizeof(msg_tlm_attitude_t), offsetof(replay_sample_t, att), REPLAY_HAVE_ATTITUDE},
+	[BATCHED_RC]		= {MSG_TLM_RC, sizeof(msg_tlm_rc_t), offsetof(replay_sample_t, rc), REPLAY_HAVE_RC},
+	[BATCHED_MOTORS]	= {MSG_TLM_MOTORS, sizeof(msg_tlm_motors_t), offsetof(replay_sample_t, mtr), REPLAY_HAVE_MOTORS}
+};
+
+
+/**
+  * @brief helper function to read a monotonic timestamp
+  *
+  * @retval time (ns)
+  */
+static uint64_t now_ns(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/**
+  * @brief helper function to append an empty sample (grows the array)
+  *
+  * @retval pointer to new sample (NULL if out of memory)
+  */
+static replay_sample_t *append_sample(replay_log_t *log, uint32_t *capacity) {
+	replay_sample_t *s;
+
+	if (log->count == *capacity) {
+		uint32_t n = *capacity ? (*capacity * 2U) : 4096U;
+		replay_sample_t *p = realloc(log->samples, n * sizeof(*p));
+
+		if (!p)
+			return NULL;
+
+		log->samples = p;
+		*capacity = n;
+	}
+
+	s = &log->samples[log->count++];
+	memset(s, 0, sizeof(*s));
+
+	return s;
+}
+
+/**
+  * @brief helper function to append one batched sample to its topic list
+  *
+  * @retval boolean (false if out of memory)
+  */
+static bool append_batched(sample_list_t *list, const uint8_t *sample, uint8_t size) {
+	if (list->count == list->capacity) {
+		uint32_t n = list->capacity ? (list->capacity * 2U) : 4096U;
+		uint8_t *p = realloc(list->data, (size_t) n * size);
+
+		if (!p)
+			return false;
+
+		list->data = p;
+		list->capacity = n;
+	}
+
+	memcpy(&list->data[(size_t) list->count++ * size], sample, size);
+	return true;
+}
+
+/**
+  * @brief helper function to start the loop of one imu sample
+  *
+  * @retval boolean (false if out of memory)
+  */
+static bool add_imu(replay_log_t *log, uint32_t *capacity, const uint8_t *payload) {
+	replay_sample_t *cur = log->count ? &log->samples[log->count - 1U] : NULL;
+	replay_sample_t *s;
+	msg_tlm_imu_t imu;
+
+	memcpy(&imu, payload, sizeof(imu));
+
+	/* Same sample re-sent (stream faster than the loop) */
+	if (cur && !memcmp(&cur->imu, &imu, sizeof(imu))) {
+		++log->duplicates;
+		return true;
+	}
+
+	s = append_sample(log, capacity);
+	if (!s)
+		return false;
+
+	s->imu = imu;
+
+	/* RC changes at stick rate; carry it over until a new frame arrives */
+	if (log->count > 1U)
+		s->rc = log->samples[log->count - 2U].rc;
+
+	return true;
+}
+
+/**
+  * @brief helper function to unpack one MSG_TLM_BATCH frame (imu samples start
+  * 	   loops as single frames do, the other topics wait for the merge)
+  *
+  * @retval boolean (false if out of memory)
+  */
+static bool add_batch(replay_log_t *log, uint32_t *capacity, sample_list_t *batched, const frame_t *f) {
+	msg_tlm_batch_t hdr;
+	uint32_t t;
+
+	if (f->len < sizeof(hdr))
+		return true;
+	memcpy(&hdr, f->payload, sizeof(hdr));
+
+	if (hdr.msg_id == MSG_TLM_IMU) {
+		if (f->len != sizeof(hdr) + hdr.count * sizeof(msg_tlm_imu_t))
+			return true;
+
+		for (uint32_t i = 0; i < hdr.count; ++i) {
+			if (!add_imu(log, capacity, &f->payload[sizeof(hdr) + i * sizeof(msg_tlm_imu_t)]))
+				return false;
+		}
+		return true;
+	}
+
+	for (t = 0; (t < BATCHED_COUNT) && (batched_topics[t].msg_id != hdr.msg_id); ++t);
+	if ((t == BATCHED_COUNT) || (f->len != sizeof(hdr) + hdr.count * batched_topics[t].size))
+		return true;
+
+	for (uint32_t i = 0; i < hdr.count; ++i) {
+		if (!append_batched(&batched[t], &f->payload[sizeof(hdr) + i * batched_topics[t].size], batched_topics[t].size))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief helper function to merge batched samples into the loops with the
+  * 	   same timestamp (ms stamps are unique per loop below a 1 kHz loop);
+  * 	   rc is carried forward as with single frames
+  *
+  * @retval None
+  */
+static void merge_batched(replay_log_t *log, const sample_list_t *batched) {
+	for (uint32_t t = 0; t < BATCHED_COUNT; ++t) {
+		const uint8_t *last = NULL;
+		uint32_t j = 0U;
+
+		for (uint32_t i = 0; i < log->count; ++i) {
+			replay_sample_t *s = &log->samples[i];
+			uint8_t *dst = (uint8_t*) s + batched_topics[t].offset;
+			uint32_t ts;
+
+			/* Per topic samples are in time order, like the loops */
+			for (; j < batched[t].count; ++j) {
+				const uint8_t *sample = &batched[t].data[(size_t) j * batched_topics[t].size];
+
+				memcpy(&ts, sample, sizeof(ts));
+				if (ts > s->imu.timestamp_ms)
+					break;
+
+				last = sample;
+				if (ts == s->imu.timestamp_ms) {
+					memcpy(dst, sample, batched_topics[t].size);
+					s->have |= batched_topics[t].have;
+				}
+			}
+
+			if ((t == BATCHED_RC) && last && !(s->have & REPLAY_HAVE_RC))
+				memcpy(dst, last, batched_topics[t].size);
+		}
+	}
+}
+
+/**
+  * @brief helper function to attach one decoded frame to the log
+  *
+  * @retval boolean (false if out of memory)
+  */
+static bool add_frame(replay_log_t *log, uint32_t *capacity, sample_list_t *batched, const frame_t *f) {
+	replay_sample_t *cur = log->count ? &log->samples[log->count - 1U] : NULL;
+
+	++log->frames;
+
+	switch (f->msg_id) {
+		case MSG_TLM_BATCH:
+			return add_batch(log, capacity, batched, f);
+		case MSG_TLM_IMU:
+			if ((f->len == sizeof(msg_tlm_imu_t)) && !add_imu(log, capacity, f->payload))
+				return false;
+			break;
+		case MSG_TLM_ATTITUDE:
+			if (cur && (f->len == sizeof(cur->att))) {
+				memcpy(&cur->att, f->payload, sizeof(cur->att));
+				cur->have |= REPLAY_HAVE_ATTITUDE;
+			}
+			break;
+		case MSG_TLM_RC:
+			if (cur && (f->len == sizeof(cur->rc))) {
+				memcpy(&cur->rc, f->payload, sizeof(cur->rc));
+				cur->have |= REPLAY_HAVE_RC;
+			}
+			break;
+		case MSG_TLM_MOTORS:
+			if (cur && (f->len == sizeof(cur->mtr))) {
+				memcpy(&cur->mtr, f->payload, sizeof(cur->mtr));
+				cur->have |= REPLAY_HAVE_MOTORS;
+			}
+			break;
+		default:
+			break;
+	}
+
+	return true;
+}
+
+/**
+  * @brief helper function to tabulate the outputs recorded on target
+  *
+  * @retval boolean (false if out of memory)
+  */
+static bool tabulate_recorded(replay_log_t *log) {
+	log->recorded = malloc((size_t) log->count * REPLAY_CH_COUNT * sizeof(float) + 1U);
+	if (!log->recorded)
+		return false;
+
+	for (uint32_t i = 0; i < log->count; ++i) {
+		const replay_sample_t *s = &log->samples[i];
+		float *o = &log->recorded[(size_t) i * REPLAY_CH_COUNT];
+		bool att = s->have & REPLAY_HAVE_ATTITUDE;
+		bool mtr = s->have & REPLAY_HAVE_MOTORS;
+
+		o[REPLAY_CH_EST_ROLL] = att ? s->att.roll_deg : NAN;
+		o[REPLAY_CH_EST_PITCH] = att ? s->att.pitch_deg : NAN;
+		for (uint32_t m = 0; m < 4U; ++m)
+			o[REPLAY_CH_MTR1 + m] = mtr ? s->mtr.mtr[m] : NAN;
+	}
+
+	return true;
+}
+
+/**
+  * @brief memory-maps and decodes a link capture
+  * 	   NOTE: frames are decoded straight out of the mapping; only the
+  * 	   per-loop samples are kept once the file is unmapped
+  *
+  * @param  log		log buffer to be filled
+  * @param	path	capture file path
+  *
+  * @retval replay status (WARN if frames were corrupt or dropped)
+  */
+replay_status_t replay_load(replay_log_t *log, const char *path) {
+	sample_list_t batched[BATCHED_COUNT] = {0};
+	frame_decoder_t dec;
+	frame_t frame;
+	struct stat st;
+	const uint8_t *map;
+	uint32_t capacity = 0U;
+	bool ok = true;
+	int fd;
+
+	memset(log, 0, sizeof(*log));
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return REPLAY_ERROR_FATAL;
+
+	if ((fstat(fd, &st) != 0) || (st.st_size == 0)) {
+		close(fd);
+		return REPLAY_ERROR_FATAL;
+	}
+
+	map = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return REPLAY_ERROR_FATAL;
+
+	madvise((void*) map, (size_t) st.st_size, MADV_SEQUENTIAL);
+
+	frame_decoder_reset(&dec);
+	for (off_t i = 0; ok && (i < st.st_size); ++i) {
+		switch (frame_decoder_push(&dec, map[i], &frame)) {
+			case FRAME_INCOMPLETE:
+				break;
+			case FRAME_OK:
+				ok = add_frame(log, &capacity, batched, &frame);
+				break;
+			default:
+				++log->errors;
+				break;
+		}
+	}
+
+	munmap((void*) map, (size_t) st.st_size);
+
+	if (ok)
+		merge_batched(log, batched);
+	for (uint32_t t = 0; t < BATCHED_COUNT; ++t)
+		free(batched[t].data);
+
+	if (!ok || !tabulate_recorded(log) || (log->count == 0U)) {
+		replay_free(log);
+		return REPLAY_ERROR_FATAL;
+	}
+
+	return log->errors ? REPLAY_ERROR_WARN : REPLAY_OK;
+}
+
+/**
+  * @brief releases a loaded log
+  *
+  * @param  log		loaded log
+  * @retval None
+  */
+void replay_free(replay_log_t *log) {
+	free(log->samples);
+	free(log->recorded);
+	memset(log, 0, sizeof(*log));
+}
+
+/**
+  * @brief re-runs estimator -> controller -> mixer over a loaded log on a
+  * 	   freshly initialized firmware (defaults + overrides), timing each stage
+  * 	   NOTE: arm state is applied one loop late, as on target (flight_update
+  * 	   arms/disarms after the mixer has run)
+  *
+  * @param  log			loaded log
+  * @param	params		parameter overrides (may be NULL)
+  * @param	param_count	number of overrides
+  * @param	run			run result buffer to be filled (release with replay_run_free)
+  *
+  * @retval replay status (FATAL if init failed or an override was rejected)
+  */
+replay_status_t replay_run(const replay_log_t *log, const replay_param_t *params, uint32_t param_count, replay_run_t *run) {
+	sitl_config_t cfg;
+	sitl_rc_t rc = {.roll_us = 1500U, .pitch_us = 1500U, .throttle_us = 1000U, .yaw_us = 1500U};
+	attitude_est_t est = {0};
+	attitude_cmd_t cmd;
+	mtr_cmds_t mcmd;
+	rc_reqs_t req;
+	imu_6D_t imu;
+	bool armed = false;
+	uint64_t t0, t1;
+
+	memset(run, 0, sizeof(*run));
+
+	/* Reuse the simulator bring-up to reset every firmware module */
+	sitl_default_config(&cfg);
+	if (sitl_init(&cfg) != SITL_OK)
+		return REPLAY_ERROR_FATAL;
+
+	for (uint32_t i = 0; i < param_count; ++i) {
+		if (sitl_set_param(params[i].name, params[i].value) != SITL_OK)
+			return REPLAY_ERROR_FATAL;
+	}
+
+	run->out = malloc((size_t) log->count * REPLAY_CH_COUNT * sizeof(float) + 1U);
+	if (!run->out)
+		return REPLAY_ERROR_FATAL;
+	run->count = log->count;
+
+	for (uint32_t i = 0; i < log->count; ++i) {
+		const replay_sample_t *s = &log->samples[i];
+		float *o = &run->out[(size_t) i * REPLAY_CH_COUNT];
+
+		/* Arm state left behind by the previous loop */
+		if (i && (armed != (bool) s[-1].rc.armed)) {
+			armed = s[-1].rc.armed;
+			if (armed)
+				esc_arm();
+			else
+				esc_disarm();
+		}
+
+		rc.arm = armed;
+		rc.mode = (s->rc.mode == RATE_MODE) ? RATE_MODE : ANGLE_MODE;
+		sitl_set_rc(&rc);
+
+		imu.accel_x = s->imu.accel_mg[0];
+		imu.accel_y = s->imu.accel_mg[1];
+		imu.accel_z = s->imu.accel_mg[2];
+		imu.rate_x = s->imu.rate_mdps[0];
+		imu.rate_y = s->imu.rate_mdps[1];
+		imu.rate_z = s->imu.rate_mdps[2];
+		imu.dt = s->imu.dt;
+
+		req.roll_angle = s->rc.roll_deg;
+		req.pitch_angle = s->rc.pitch_deg;
+		req.roll_rate = s->rc.roll_rate_dps;
+		req.pitch_rate = s->rc.pitch_rate_dps;
+		req.yaw_rate = s->rc.yaw_rate_dps;
+		req.throttle = s->rc.throttle_pct;
+
+		/* Same calls, same order as flight_update */
+		t0 = now_ns();
+		attitude_estimator_update(&imu, &est);
+		t1 = now_ns();
+		run->stage_ns[REPLAY_STAGE_ESTIMATOR] += t1 - t0;
+
+		attitude_controller_update(&cmd, &req, &est, USEC_TO_SEC((float) imu.dt));
+		t0 = now_ns();
+		run->stage_ns[REPLAY_STAGE_CONTROLLER] += t0 - t1;
+
+		mixer_update(&mcmd, &cmd, req.throttle);
+		#if THRUST_COMP == ENABLED
+		thrust_compensate(&mcmd, &est);
+		#endif
+		t1 = now_ns();
+		run->stage_ns[REPLAY_STAGE_MIXER] += t1 - t0;
+
+		o[REPLAY_CH_EST_ROLL] = est.roll_angle_deg;
+		o[REPLAY_CH_EST_PITCH] = est.pitch_angle_deg;
+		o[REPLAY_CH_MTR1] = mcmd.mtr1;
+		o[REPLAY_CH_MTR2] = mcmd.mtr2;
+		o[REPLAY_CH_MTR3] = mcmd.mtr3;
+		o[REPLAY_CH_MTR4] = mcmd.mtr4;
+	}
+
+	return REPLAY_OK;
+}
+
+/**
+  * @brief releases a run result
+  *
+  * @param  run		run result
+  * @retval None
+  */
+void replay_run_free(replay_run_t *run) {
+	free(run->out);
+	memset(run, 0, sizeof(*run));
+}
+
+/**
+  * @brief computes per-channel rms and max |a - b| (samples where either side
+  * 	   is NAN are skipped)
+  *
+  * @param  log		loaded log (sample count)
+  * @param	a		outputs, count x REPLAY_CH_COUNT
+  * @param	b		outputs, count x REPLAY_CH_COUNT
+  * @param	diff	difference statistics buffer to be filled
+  *
+  * @retval None
+  */
+void replay_compare(const replay_log_t *log, const float *a, const float *b, replay_diff_t diff[REPLAY_CH_COUNT]) {
+	double sq[REPLAY_CH_COUNT] = {0};
+
+	memset(diff, 0, REPLAY_CH_COUNT * sizeof(*diff));
+
+	for (uint32_t i = 0; i < log->count; ++i) {
+		for (uint32_t ch = 0; ch < REPLAY_CH_COUNT; ++ch) {
+			float va = a[(size_t) i * REPLAY_CH_COUNT + ch];
+			float vb = b[(size_t) i * REPLAY_CH_COUNT + ch];
+			float d;
+
+			if (isnan(va) || isnan(vb))
+				continue;
+
+			d = fabsf(va - vb);
+			sq[ch] += (double) d * (double) d;
+			diff[ch].max = fmaxf(diff[ch].max, d);
+			++diff[ch].samples;
+		}
+	}
+
+	for (uint32_t ch = 0; ch < REPLAY_CH_COUNT; ++ch) {
+		if (diff[ch].samples)
+			diff[ch].rms = (float) sqrt(sq[ch] / (double) diff[ch].samples);
+	}
+}
+
+/**
+  * @brief fetches a channel name (csv columns and reports)
+  *
+  * @param  ch		output channel
+  * @retval channel name
+  */
+const char *replay_channel_name(replay_channel_t ch) {
+	return (ch < REPLAY_CH_COUNT) ? channel_names[ch] : "?";
+}
+
+/**
+  * @brief fetches a stage name
+  *
+  * @param  stage	timed stage
+  * @retval stage name
+  */
+const char *replay_stage_name(replay_stage_t stage) {
+	return (stage < REPLAY_STAGE_COUNT) ? stage_names[stage] : "?";
+}
@@ -0,0 +1,324 @@
+/*
+ * replay_main.c (replay command line)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <libgen.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "replay.h"
+
+/**
+  * @brief  Limits
+  */
+#define OVERRIDES_MAX		32U
+#define REPORT_MAX			4096U
+
+/**
+  * @brief  Variant (parameter set replayed against every log)
+  */
+typedef struct {
+	replay_param_t params[OVERRIDES_MAX];
+	uint32_t count;
+} variant_t;
+
+/**
+  * @brief  Batch Job (one forked worker per log)
+  */
+typedef struct {
+	const char *path;
+	pid_t pid;
+	int fd;					// read end of the report pipe
+	char report[REPORT_MAX];
+	size_t len;
+	int exit_code;
+} job_t;
+
+
+/**
+  * @brief helper function to parse NAME=VALUE into a variant
+  *
+  * @retval boolean
+  */
+static bool add_override(variant_t *v, char *arg) {
+	char *eq = strchr(arg, '=');
+
+	if (!eq || (v->count >= OVERRIDES_MAX))
+		return false;
+
+	*eq = '\0';
+	v->params[v->count].name = arg;
+	v->params[v->count].value = strtof(eq + 1, NULL);
+	++v->count;
+
+	return true;
+}
+
+/**
+  * @brief helper function to print a diff table row per channel
+  *
+  * @retval None
+  */
+static void print_diff(FILE *fp, const char *title, const replay_diff_t diff[REPLAY_CH_COUNT]) {
+	fprintf(fp, "  %s\n", title);
+	for (uint32_t ch = 0; ch < REPLAY_CH_COUNT; ++ch)
+		fprintf(fp, "    %-14s rms %-10.4g max %-10.4g (%u samples)\n", replay_channel_name(ch),
+				(double) diff[ch].rms, (double) diff[ch].max, diff[ch].samples);
+}
+
+/**
+  * @brief helper function to write the per-sample outputs as csv
+  *
+  * @retval boolean
+  */
+static bool write_csv(const char *dir, const char *log_path, const replay_log_t *log,
+					  const replay_run_t *a, const replay_run_t *b) {
+	const float *cols[3] = {replay_recorded(log), a->out, b ? b->out : NULL};
+	const char *tags[3] = {"rec", "a", "b"};
+	char base[256], path[512];
+	FILE *fp;
+
+	snprintf(base, sizeof(base), "%s", log_path);
+	snprintf(path, sizeof(path), "%s/%s.csv", dir, basename(base));
+
+	fp = fopen(path, "w");
+	if (!fp)
+		return false;
+
+	fprintf(fp, "time_ms");
+	for (uint32_t c = 0; c < 3U; ++c) {
+		for (uint32_t ch = 0; cols[c] && (ch < REPLAY_CH_COUNT); ++ch)
+			fprintf(fp, ",%s_%s", tags[c], replay_channel_name(ch));
+	}
+	fprintf(fp, "\n");
+
+	for (uint32_t i = 0; i < log->count; ++i) {
+		fprintf(fp, "%u", log->samples[i].imu.timestamp_ms);
+		for (uint32_t c = 0; c < 3U; ++c) {
+			for (uint32_t ch = 0; cols[c] && (ch < REPLAY_CH_COUNT); ++ch)
+				fprintf(fp, ",%.6g", (double) cols[c][(size_t) i * REPLAY_CH_COUNT + ch]);
+		}
+		fprintf(fp, "\n");
+	}
+
+	fclose(fp);
+	return true;
+}
+
+/**
+  * @brief helper function to replay one log and report to fp (runs in the
+  * 	   forked worker; firmware modules are global, so one log per process)
+  *
+  * @retval exit code (0 ok, 1 replay diverged from recording, 2 error)
+  */
+static int process_log(FILE *fp, const char *path, const variant_t *va, const variant_t *vb,
+					   const char *csv_dir, float tolerance) {
+	replay_log_t log;
+	replay_run_t a, b;
+	replay_diff_t diff[REPLAY_CH_COUNT];
+	replay_status_t status;
+	int code = 0;
+
+	status = replay_load(&log, path);
+	if (status == REPLAY_ERROR_FATAL) {
+		fprintf(fp, "%s: cannot load\n", path);
+		return 2;
+	}
+
+	fprintf(fp, "%s: %u samples (%u frames, %u errors, %u duplicates)\n",
+			path, log.count, log.frames, log.errors, log.duplicates);
+
+	if (replay_run(&log, va->params, va->count, &a) != REPLAY_OK) {
+		fprintf(fp, "  replay A failed (rejected override?)\n");
+		replay_free(&log);
+		return 2;
+	}
+
+	fprintf(fp, "  timing (ns/sample):");
+	for (uint32_t s = 0; s < REPLAY_STAGE_COUNT; ++s)
+		fprintf(fp, " %s %.1f", replay_stage_name(s), (double) a.stage_ns[s] / (double) a.count);
+	fprintf(fp, "\n");
+
+	replay_compare(&log, replay_recorded(&log), a.out, diff);
+	print_diff(fp, va->count ? "A vs recorded" : "replay vs recorded", diff);
+
+	/* Without overrides, replay must reproduce the recording */
+	if (!va->count) {
+		for (uint32_t ch = 0; ch < REPLAY_CH_COUNT; ++ch) {
+			if (diff[ch].max > tolerance)
+				code = 1;
+		}
+	}
+
+	if (vb->count) {
+		if (replay_run(&log, vb->params, vb->count, &b) != REPLAY_OK) {
+			fprintf(fp, "  replay B failed (rejected override?)\n");
+			replay_run_free(&a);
+			replay_free(&log);
+			return 2;
+		}
+
+		replay_compare(&log, a.out, b.out, diff);
+		print_diff(fp, "A vs B", diff);
+	}
+
+	if (csv_dir && !write_csv(csv_dir, path, &log, &a, vb->count ? &b : NULL)) {
+		fprintf(fp, "  cannot write csv to %s\n", csv_dir);
+		code = 2;
+	}
+
+	if (vb->count)
+		replay_run_free(&b);
+	replay_run_free(&a);
+	replay_free(&log);
+
+	return code;
+}
+
+/**
+  * @brief helper function to fork a worker for one log
+  *
+  * @retval boolean
+  */
+static bool start_job(job_t *job, const variant_t *va, const variant_t *vb, const char *csv_dir, float tolerance) {
+	int fds[2];
+
+	if (pipe(fds) != 0)
+		return false;
+
+	job->pid = fork();
+	if (job->pid < 0) {
+		close(fds[0]);
+		close(fds[1]);
+		return false;
+	}
+
+	if (job->pid == 0) {
+		FILE *fp = fdopen(fds[1], "w");
+		int code = 2;
+
+		close(fds[0]);
+		if (fp) {
+			code = process_log(fp, job->path, va, vb, csv_dir, tolerance);
+			fclose(fp);
+		}
+		_exit(code);
+	}
+
+	close(fds[1]);
+	job->fd = fds[0];
+
+	return true;
+}
+
+/**
+  * @brief helper function to collect a worker's report and exit code
+  * 	   NOTE: drains the pipe before reaping, so long reports cannot block
+  * 	   the worker
+  *
+  * @retval None
+  */
+static void finish_job(job_t *job) {
+	char sink[256];
+	ssize_t n;
+	int wstatus;
+
+	while ((n = read(job->fd, (job->len < REPORT_MAX - 1U) ? job->report + job->len : sink,
+					 (job->len < REPORT_MAX - 1U) ? REPORT_MAX - 1U - job->len : sizeof(sink))) > 0) {
+		if (job->len < REPORT_MAX - 1U)
+			job->len += (size_t) n;
+	}
+	job->report[job->len] = '\0';
+	close(job->fd);
+
+	waitpid(job->pid, &wstatus, 0);
+	job->exit_code = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 2;
+}
+
+static void usage(const char *argv0) {
+	fprintf(stderr,
+			"usage: %s [-j jobs] [-o csv_dir] [-T tolerance] [-A NAME=VALUE ...] [-B NAME=VALUE ...] log ...\n"
+			"  replays link captures (see aqc_sitl -f link) through estimator, controller and mixer\n"
+			"  -A/-B    parameter overrides for variant A (compared to the recording) and B (compared to A)\n"
+			"  exit status is non-zero if a plain replay diverges from the recording by more than tolerance\n",
+			argv0);
+}
+
+int main(int argc, char **argv) {
+	variant_t va = {0}, vb = {0};
+	const char *csv_dir = NULL;
+	float tolerance = 1e-3f;
+	long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	job_t *job;
+	uint32_t count = 0U, started = 0U, finished = 0U;
+	int fail = 0;
+
+	job = calloc((size_t) argc, sizeof(*job));
+	if (!job)
+		return 2;
+
+	for (int i = 1; i < argc; ++i) {
+		const char *a = argv[i];
+		char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+		if (a[0] != '-') {
+			job[count++].path = a;
+			continue;
+		}
+
+		if (!v) {
+			usage(argv[0]);
+			return 2;
+		}
+		++i;
+
+		if (!strcmp(a, "-j"))
+			jobs = strtol(v, NULL, 10);
+		else if (!strcmp(a, "-o"))
+			csv_dir = v;
+		else if (!strcmp(a, "-T"))
+			tolerance = strtof(v, NULL);
+		else if (!strcmp(a, "-A") && add_override(&va, v))
+			continue;
+		else if (!strcmp(a, "-B") && add_override(&vb, v))
+			continue;
+		else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+
+	if (!count) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	if (jobs < 1)
+		jobs = 1;
+
+	/* Keep up to jobs workers running; reports are printed in log order */
+	while (finished < count) {
+		while ((started < count) && ((started - finished) < (uint32_t) jobs)) {
+			if (!start_job(&job[started], &va, &vb, csv_dir, tolerance)) {
+				perror("fork");
+				return 2;
+			}
+			++started;
+		}
+
+		finish_job(&job[finished]);
+		fputs(job[finished].report, stdout);
+		fail = (job[finished].exit_code > fail) ? job[finished].exit_code : fail;
+		++finished;
+	}
+
+	free(job);
+
+	return fail;
+}
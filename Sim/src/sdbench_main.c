@@ -0,0 +1,446 @@
+/*
+ * sdbench_main.c (sd streaming write benchmark)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "storage/sd_stream.h"
+#include "storage/log_file.h"
+#include "storage/card/sim_sd_card.h"
+#include "common/datetime.h"
+#include "sim_sd_diskio.h"
+#include "sim_hw.h"
+
+/*
+ * Streams a synthetic log through storage/sd_stream.c into the simulated card
+ * (Sim/src/sim_sd_card.c) and reports one JSON line:
+ *
+ *   {"mode": "stream", "bytes": 16777216, "mb_per_s": 7.64,
+ *    "card_mb_per_s": 7.64, "latency_avg_us": 2044, "latency_max_us": 52385,
+ *    "bytes_dropped": 0, "verified": true, ...}
+ *
+ * The producer writes small records at a fixed rate (-r, KB/s), like a
+ * logger on the flight loop, where a full ring drops bytes. Unpaced (-r 0)
+ * it waits for ring space instead, measuring the card path itself.
+ * The card image is checked against the accepted bytes afterwards. -b runs
+ * the old path instead: one blocking single-block write per 512 bytes.
+ * The exit status is 1 if the image does not match, a write failed, or
+ * bytes were dropped at a fixed rate.
+ *
+ * -l records log files on a FAT volume through storage/log_file.c instead,
+ * timing arm (preallocation) and disarm (drain, truncate), and fails if
+ * FatFs wrote to the card while armed or a file does not read back. Each
+ * log gets a simulated wall time; its header and FAT timestamp are checked
+ * against libc (gmtime_r), as is common/datetime.c over 2000..2099.
+ */
+
+#define SDBENCH_BLOCKS_SPARE	256U						// room for flush padding
+#define SDBENCH_LOG_SLACK		(1024U * 1024U)				// preallocated beyond each log
+#define SDBENCH_FS_OVERHEAD		(4U * 1024U * 1024U)		// fat, root directory, alignment
+#define SDBENCH_UNIX_START		1792843200U					// 2026-10-24 12:00:00 utc
+#define SDBENCH_FLIGHT_SPACING	(86400U * 37U + 3671U)		// wall time between logs
+#define SDBENCH_DATETIME_STEP	(86400U + 3607U)			// datetime sweep stride
+
+
+/**
+  * @brief helper function: monotonic wall time
+  *
+  * @retval seconds
+  */
+static double now_s(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + (double) ts.tv_nsec * 1.0e-9;
+}
+
+/**
+  * @brief helper function: test pattern byte at a stream offset
+  *
+  * @retval byte
+  */
+static inline uint8_t pattern(uint32_t offset) {
+	return (uint8_t) (offset ^ (offset >> 8) ^ (offset >> 16) ^ 0xA5U);
+}
+
+/**
+  * @brief  Simulated Wall Clock (FatFs timestamps)
+  */
+static uint32_t sim_unix_s = 0U;
+
+
+/**
+  * @brief FatFs timestamp hook (the firmware's reads the rtc)
+  *
+  * @retval fat date / time
+  */
+DWORD get_fattime(void) {
+	datetime_t dt;
+
+	datetime_from_unix(sim_unix_s, &dt);
+	return datetime_to_fattime(&dt);
+}
+
+/**
+  * @brief helper function to run the stream (or the log file on top of it)
+  *
+  * @retval boolean (false after a card error)
+  */
+static bool service(bool log) {
+	if (log)
+		return log_file_service() != LOG_FILE_ERROR_FATAL;
+
+	return sd_stream_service() != SD_STREAM_ERROR_FATAL;
+}
+
+/**
+  * @brief helper function to write total bytes in records at rate_kbps, through
+  * 	   the log file manager or straight into the stream
+  *
+  * @retval boolean (false after a card error)
+  */
+static bool produce(uint8_t *buf, uint32_t total, uint32_t record, uint32_t rate_kbps, bool log) {
+	uint32_t produced = 0U, len;
+	double start = now_s();
+	bool failed = false;
+
+	while (produced < total) {
+		if (rate_kbps && ((double) produced > (now_s() - start) * rate_kbps * 1024.0)) {
+			failed |= !service(log);
+			continue;
+		}
+
+		/* Pattern follows the accepted bytes, so drops leave no gap on the card */
+		len = (total - produced < record) ? total - produced : record;
+		for (uint32_t i = 0; i < len; ++i)
+			buf[i] = pattern(sd_stream_position() + i);
+
+		/* Unpaced: wait for ring space instead of dropping, to measure the card path */
+		while (!rate_kbps && (sd_stream_space() < len) && !failed)
+			failed |= !service(log);
+
+		if (log)
+			log_file_write(buf, len);
+		else
+			sd_stream_write(buf, len);
+		produced += len;
+
+		failed |= !service(log);
+	}
+
+	return !failed;
+}
+
+/**
+  * @brief helper function to stream total bytes in records at rate_kbps
+  *
+  * @retval exit code
+  */
+static int run_stream(uint32_t total, uint32_t record, uint32_t rate_kbps) {
+	uint8_t *buf = malloc(record);
+	sd_stream_stats_t st;
+	const uint8_t *img;
+	bool verified = true, failed;
+	double start, elapsed;
+
+	if (!buf || (sd_stream_open(&sim_sd_card, 0U, total / SD_BLOCK_SIZE + SDBENCH_BLOCKS_SPARE) != SD_STREAM_OK))
+		return 2;
+
+	start = now_s();
+	failed = !produce(buf, total, record, rate_kbps, false);
+
+	sd_stream_close();
+	while (!sd_stream_idle())
+		failed |= (sd_stream_service() == SD_STREAM_ERROR_FATAL);
+
+	elapsed = now_s() - start;
+	sd_stream_get_stats(&st);
+
+	img = sim_sd_card_image();
+	for (uint32_t i = 0; i < sd_stream_position() && !failed; ++i) {
+		if (img[i] != pattern(i)) {
+			verified = false;
+			break;
+		}
+	}
+
+	printf("{\"mode\": \"stream\", \"bytes\": %u, \"record\": %u, \"rate_kbps\": %u, \"seconds\": %.3f, "
+		   "\"mb_per_s\": %.2f, \"card_mb_per_s\": %.2f, \"transfers\": %u, \"latency_avg_us\": %u, "
+		   "\"latency_max_us\": %u, \"bytes_written\": %u, \"bytes_dropped\": %u, \"errors\": %u, \"verified\": %s}\n",
+		   sd_stream_position(), record, rate_kbps, elapsed,
+		   (double) sd_stream_position() / elapsed / 1048576.0, (double) st.throughput_kbps / 1024.0,
+		   st.transfers, st.latency_avg_us, st.latency_max_us, st.bytes_written, st.bytes_dropped, st.errors,
+		   (verified && !failed) ? "true" : "false");
+
+	free(buf);
+
+	if (!verified || failed || st.errors)
+		return 1;
+
+	return (rate_kbps && st.bytes_dropped) ? 1 : 0;
+}
+
+/**
+  * @brief helper function to write total bytes the way the fatfs template
+  * 	   does for unaligned buffers: one blocking single-block write at a time
+  *
+  * @retval exit code
+  */
+static int run_blocking(uint32_t total) {
+	static uint32_t block[SD_BLOCK_SIZE / sizeof(uint32_t)];
+	uint32_t blocks = total / SD_BLOCK_SIZE;
+	double start, elapsed, worst = 0.0, t;
+
+	start = now_s();
+	for (uint32_t b = 0; b < blocks; ++b) {
+		t = now_s();
+		if (!sim_sd_card.write(block, b, 1U))
+			return 1;
+
+		while (!sim_sd_card.ready())
+			sim_sd_card.poll();
+
+		t = now_s() - t;
+		if (t > worst)
+			worst = t;
+	}
+	elapsed = now_s() - start;
+
+	printf("{\"mode\": \"blocking\", \"bytes\": %u, \"seconds\": %.3f, \"mb_per_s\": %.2f, \"latency_max_us\": %.0f}\n",
+		   blocks * SD_BLOCK_SIZE, elapsed, (double) (blocks * SD_BLOCK_SIZE) / elapsed / 1048576.0, worst * 1.0e6);
+
+	return 0;
+}
+
+/**
+  * @brief helper function to check common/datetime.c against libc
+  *
+  * @retval boolean
+  */
+static bool verify_datetime(void) {
+	datetime_t dt;
+	struct tm tm;
+
+	for (uint64_t t = DATETIME_UNIX_2000; t < DATETIME_UNIX_2100; t += SDBENCH_DATETIME_STEP) {
+		time_t tt = (time_t) t;
+
+		datetime_from_unix((uint32_t) t, &dt);
+		gmtime_r(&tt, &tm);
+
+		if ((dt.year != tm.tm_year + 1900) || (dt.month != tm.tm_mon + 1) || (dt.day != tm.tm_mday) ||
+			(dt.hour != tm.tm_hour) || (dt.minute != tm.tm_min) || (dt.second != tm.tm_sec) ||
+			(dt.weekday != (tm.tm_wday ? tm.tm_wday : 7)) || !datetime_is_valid(&dt) ||
+			(datetime_to_unix(&dt) != (uint32_t) t))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief helper function to check a log's FAT timestamp against libc
+  *
+  * @retval boolean
+  */
+static bool verify_fattime(const char *name, uint32_t unix_s) {
+	time_t tt = (time_t) unix_s;
+	FILINFO info;
+	struct tm tm;
+
+	if (f_stat(name, &info) != FR_OK)
+		return false;
+
+	gmtime_r(&tt, &tm);
+
+	return (info.fdate == (((tm.tm_year - 80) << 9) | ((tm.tm_mon + 1) << 5) | tm.tm_mday)) &&
+		   (info.ftime == ((tm.tm_hour << 11) | (tm.tm_min << 5) | (tm.tm_sec / 2)));
+}
+
+/**
+  * @brief helper function to read a log back through FatFs and compare its
+  * 	   header with the time reference and its records with the pattern
+  *
+  * @retval boolean
+  */
+static bool verify_log(const char *name, uint32_t len, const rtc_time_ref_t *ref) {
+	static uint8_t chunk[4096];
+	uint32_t offset = sizeof(log_file_header_t);
+	log_file_header_t hdr;
+	bool ok;
+	UINT n;
+	FIL fil;
+
+	if (f_open(&fil, name, FA_READ) != FR_OK)
+		return false;
+
+	ok = (f_size(&fil) == offset + len) && (f_read(&fil, &hdr, sizeof(hdr), &n) == FR_OK) && (n == sizeof(hdr)) &&
+		 !memcmp(hdr.magic, LOG_FILE_MAGIC, sizeof(hdr.magic)) && (hdr.version == LOG_FILE_VERSION) &&
+		 (hdr.header_size == sizeof(hdr)) && (hdr.log_index == strtoul(&name[3], NULL, 10)) &&
+		 (hdr.boot_id == ref->boot_id) && (hdr.unix_s == ref->unix_s) && (hdr.unix_us == ref->unix_us) &&
+		 (hdr.clock_us == ref->clock_us);
+
+	/* Records continue the stream offsets after the header */
+	while (ok && (offset < sizeof(hdr) + len)) {
+		if ((f_read(&fil, chunk, sizeof(chunk), &n) != FR_OK) || !n)
+			ok = false;
+
+		for (UINT i = 0; ok && (i < n); ++i)
+			ok = (chunk[i] == pattern(offset + i));
+
+		offset += n;
+	}
+
+	(void) f_close(&fil);
+
+	return ok;
+}
+
+/**
+  * @brief helper function to record flights log files of total bytes each on
+  * 	   a FAT formatted card, the way the firmware does between arm and disarm
+  *
+  * @retval exit code
+  */
+static int run_log(uint32_t total, uint32_t record, uint32_t flights, const char *image_path) {
+	static BYTE work[_MAX_SS];
+	uint8_t *buf = malloc(record);
+	log_file_status_t start_status, stop_status;
+	uint32_t fs_writes, fs_writes_armed;
+	rtc_time_ref_t ref = {.boot_id = 1U};
+	datetime_t dt;
+	double t, start_ms, stop_ms;
+	bool verified, ok = true;
+	char path[4];
+	FATFS fs;
+	FILE *fp;
+
+	if (!verify_datetime()) {
+		fprintf(stderr, "datetime conversion does not match libc\n");
+		ok = false;
+	}
+
+	if (!buf || FATFS_LinkDriver(&sim_sd_diskio, path) ||
+		(f_mkfs(path, FM_ANY, 0, work, sizeof(work)) != FR_OK) || (f_mount(&fs, path, 1) != FR_OK))
+		return 2;
+
+	for (uint32_t f = 0; f < flights; ++f) {
+		/* Arm (at a simulated wall time; the clock counts from the last arm) */
+		sim_unix_s = SDBENCH_UNIX_START + f * SDBENCH_FLIGHT_SPACING;
+		ref.unix_s = sim_unix_s;
+		ref.unix_us = 250000U * f;
+		ref.clock_us = (uint64_t) (now_s() * 1.0e6);
+
+		t = now_s();
+		start_status = log_file_start(&sim_sd_card, total + SDBENCH_LOG_SLACK, &ref);
+		start_ms = (now_s() - t) * 1.0e3;
+		if (start_status == LOG_FILE_ERROR_FATAL)
+			return 1;
+
+		/* Fly: nothing but streamed data may reach the card */
+		fs_writes = sim_sd_diskio_write_count();
+		ok &= produce(buf, total, record, 0U, true);
+		fs_writes_armed = sim_sd_diskio_write_count() - fs_writes;
+
+		/* Disarm */
+		t = now_s();
+		stop_status = log_file_stop();
+		stop_ms = (now_s() - t) * 1.0e3;
+
+		verified = (stop_status == LOG_FILE_OK) && verify_log(log_file_name(), total, &ref) &&
+				   verify_fattime(log_file_name(), sim_unix_s);
+		ok &= verified && (start_status == LOG_FILE_OK) && !fs_writes_armed;
+
+		datetime_from_unix(ref.unix_s, &dt);
+		printf("{\"mode\": \"log\", \"file\": \"%s\", \"time\": \"%04u-%02u-%02uT%02u:%02u:%02uZ\", \"bytes\": %u, "
+			   "\"record\": %u, \"start_ms\": %.2f, \"stop_ms\": %.2f, \"fs_writes_armed\": %u, \"verified\": %s}\n",
+			   log_file_name(), dt.year, dt.month, dt.day, dt.hour, dt.minute, dt.second, total, record,
+			   start_ms, stop_ms, fs_writes_armed, verified ? "true" : "false");
+	}
+
+	(void) f_mount(NULL, path, 0);
+	free(buf);
+
+	if (image_path) {
+		fp = fopen(image_path, "wb");
+		if (!fp || (fwrite(sim_sd_card_image(), SD_BLOCK_SIZE, sim_sd_card_block_count(), fp) != sim_sd_card_block_count()))
+			ok = false;
+		if (fp)
+			fclose(fp);
+	}
+
+	return ok ? 0 : 1;
+}
+
+static void usage(const char *argv0) {
+	fprintf(stderr,
+			"usage: %s [-m MB] [-s record_bytes] [-r KB/s] [-f n] [-b] [-l flights [-o image]]\n"
+			"  -m   stream length (default 16 MB)\n"
+			"  -s   bytes per sd_stream_write (default 64, at most one segment)\n"
+			"  -r   producer rate, 0 for as fast as possible (default 0)\n"
+			"  -f   fail the n-th card write (error path)\n"
+			"  -b   blocking single-block writes instead (baseline)\n"
+			"  -l   record this many log files on a FAT volume instead (storage/log_file.c)\n"
+			"  -o   save the card image after -l (mountable, e.g. with mtools)\n",
+			argv0);
+}
+
+int main(int argc, char **argv) {
+	uint32_t mb = 16U, record = 64U, rate_kbps = 0U, fail = 0U, flights = 0U;
+	const char *image_path = NULL;
+	bool blocking = false;
+	uint32_t total;
+
+	for (int i = 1; i < argc; ++i) {
+		const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+		if (!strcmp(argv[i], "-b")) {
+			blocking = true;
+			continue;
+		}
+
+		if (!v) {
+			usage(argv[0]);
+			return 2;
+		}
+		++i;
+
+		if (!strcmp(argv[i - 1], "-m"))
+			mb = (uint32_t) strtoul(v, NULL, 10);
+		else if (!strcmp(argv[i - 1], "-s"))
+			record = (uint32_t) strtoul(v, NULL, 10);
+		else if (!strcmp(argv[i - 1], "-r"))
+			rate_kbps = (uint32_t) strtoul(v, NULL, 10);
+		else if (!strcmp(argv[i - 1], "-f"))
+			fail = (uint32_t) strtoul(v, NULL, 10);
+		else if (!strcmp(argv[i - 1], "-l"))
+			flights = (uint32_t) strtoul(v, NULL, 10);
+		else if (!strcmp(argv[i - 1], "-o"))
+			image_path = v;
+		else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+
+	if (!mb || !record || (record > SD_STREAM_SEGMENT_SIZE)) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	total = mb * 1024U * 1024U;
+
+	if (flights) {
+		sim_sd_card_format((flights * (total + SDBENCH_LOG_SLACK) + SDBENCH_FS_OVERHEAD) / SD_BLOCK_SIZE);
+		sim_sd_card_fail_transfer(fail);
+		return run_log(total, record, flights, image_path);
+	}
+
+	sim_sd_card_format(total / SD_BLOCK_SIZE + SDBENCH_BLOCKS_SPARE);
+	sim_sd_card_fail_transfer(fail);
+
+	return blocking ? run_blocking(total) : run_stream(total, record, rate_kbps);
+}
@@ -0,0 +1,62 @@
+/*
+ * sim_baro.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ *
+ * Replaces Core/Src/sensors/baro/baro.c in the SITL build: serves the sample
+ * synthesized by the simulator (fresh once per published conversion).
+ */
+
+#include "sensors/baro/baro.h"
+#include "sim_hw.h"
+
+/**
+  * @brief  Baro Comm Peripheral Handle Pointers (unused on host)
+  */
+const I2C_HandleTypeDef* baro_phi2c = NULL;
+
+const void* baro_platform_handle = NULL;
+
+/**
+  * @brief  Latest Simulated Sample
+  */
+static baro_data_t sample;
+static bool pending;
+
+
+/**
+  * @brief publishes the next baro conversion
+  *
+  * @param  s	read-only pointer to baro sample
+  * @retval None
+  */
+void sim_baro_set_sample(const baro_data_t *s) {
+	sample = *s;
+	pending = true;
+}
+
+baro_status_t baro_init(void) {
+	pending = false;
+	return BARO_OK;
+}
+
+baro_status_t baro_deinit(void) {
+	return BARO_OK;
+}
+
+/**
+  * @brief baro API call to read baro data
+  *
+  * @param  data	pointer to baro data handle
+  * @retval baro status
+  */
+baro_status_t baro_read(void *data) {
+	baro_data_t *baro = (baro_data_t*) data;
+
+	*baro = sample;
+	baro->fresh = pending;
+	pending = false;
+
+	return BARO_OK;
+}
@@ -0,0 +1,65 @@
+/*
+ * sim_battery.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ *
+ * Sim battery device (selected by CONFIG_BATTERY_DEVICE in the SITL build):
+ * serves the pack voltage and current of the simulator's battery model, so
+ * battery.c and its monitor run unchanged on top of it.
+ */
+
+#include "sensors/battery/devices/sim_battery.h"
+#include "sim_hw.h"
+
+/**
+  * @brief  Latest Simulated Sample
+  */
+static float sample_voltage_v;
+static float sample_current_a;
+
+
+/**
+  * @brief publishes the pack voltage and current (as averaged by the adc)
+  *
+  * @param  voltage_v	pack voltage
+  * @param	current_a	pack current (discharge positive)
+  *
+  * @retval None
+  */
+void sim_battery_set_sample(float voltage_v, float current_a) {
+	sample_voltage_v = voltage_v;
+	sample_current_a = current_a;
+}
+
+static battery_status_t sim_battery_init(void) {
+	return BATTERY_OK;
+}
+
+static battery_status_t sim_battery_deinit(void) {
+	return BATTERY_OK;
+}
+
+/**
+  * @brief reads the simulated sample
+  *
+  * @param  data	pointer to battery data handle (voltage and current filled)
+  * @retval battery status
+  */
+static battery_status_t sim_battery_read(void *data) {
+	battery_data_t *batt = (battery_data_t*) data;
+
+	batt->voltage_v = sample_voltage_v;
+	batt->current_a = sample_current_a;
+
+	return BATTERY_OK;
+}
+
+/**
+  * @brief sim battery driver initialization
+  */
+const battery_interface_t sim_battery_driver = {
+	.init = sim_battery_init,
+	.deinit = sim_battery_deinit,
+	.read = sim_battery_read
+};
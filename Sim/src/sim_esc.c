@@ -0,0 +1,173 @@
+/*
+ * sim_esc.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stdbool.h>
+#include "esc/protocols/sim_esc.h"
+#include "sim_hw.h"
+#include "system/driver_registry.h"
+
+/**
+  * @brief  Simulated Command Range (matches pwm esc timer counts, 1-2 ms @ 3 MHz)
+  */
+#define SIM_ESC_CMD_MIN		3000U
+#define SIM_ESC_CMD_MAX		6000U
+
+/**
+  * @brief  Simulated Output State
+  */
+static esc_cmds_t out;
+static bool running;
+static uint8_t telemetry_request;		// esc index + 1 (0: none)
+static void (*write_hook)(void);		// one-shot interrupt inside the next command write
+
+
+/**
+  * @brief fetches whether outputs are started
+  *
+  * @retval boolean
+  */
+bool sim_esc_is_running(void) {
+	return running;
+}
+
+/**
+  * @brief fetches the commands currently applied to the motors
+  *
+  * @param  o	esc commands buffer to be filled
+  * @retval None
+  */
+void sim_esc_get_commands(esc_cmds_t *o) {
+	*o = out;
+}
+
+/**
+  * @brief takes the pending telemetry request (the esc that is to reply)
+  *
+  * @param  esc		esc index buffer to be filled (0-based)
+  * @retval boolean (false if none is pending)
+  */
+bool sim_esc_take_telemetry_request(uint8_t *esc) {
+	if (telemetry_request == 0U)
+		return false;
+
+	*esc = telemetry_request - 1U;
+	telemetry_request = 0U;
+
+	return true;
+}
+
+/**
+  * @brief fetches the simulated command range
+  *
+  * @param  min		minimum esc command buffer
+  * @param	max		maximum esc command buffer
+  *
+  * @retval None
+  */
+void sim_esc_get_range(uint32_t *min, uint32_t *max) {
+	*min = SIM_ESC_CMD_MIN;
+	*max = SIM_ESC_CMD_MAX;
+}
+
+/**
+  * @brief sets a function to run as an interrupt inside the next command
+  * 	   write: once the commands are taken and before they reach the motors
+  * 	   (a timer compare store that lands after the isr returns)
+  *
+  * @param  hook	function to run once (NULL: none)
+  * @retval None
+  */
+void sim_esc_set_write_hook(void (*hook)(void)) {
+	write_hook = hook;
+}
+
+static void set_all(uint32_t cmd) {
+	out.esc1 = cmd;
+	out.esc2 = cmd;
+	out.esc3 = cmd;
+	out.esc4 = cmd;
+}
+
+static esc_status_t sim_esc_init(uint32_t *esc_cmd_min, uint32_t *esc_cmd_max) {
+	*esc_cmd_min = SIM_ESC_CMD_MIN;
+	*esc_cmd_max = SIM_ESC_CMD_MAX;
+	set_all(SIM_ESC_CMD_MIN);
+	running = false;
+	telemetry_request = 0U;
+	write_hook = NULL;
+
+	return ESC_OK;
+}
+
+static esc_status_t sim_esc_deinit(void) {
+	set_all(0U);
+	running = false;
+
+	return ESC_OK;
+}
+
+static esc_status_t sim_esc_start(uint32_t esc_cmd_min) {
+	set_all(esc_cmd_min);
+	running = true;
+
+	return ESC_OK;
+}
+
+static esc_status_t sim_esc_stop(void) {
+	running = false;
+
+	return ESC_OK;
+}
+
+static void sim_esc_arm(uint32_t esc_cmd_idle) {
+	set_all(esc_cmd_idle);
+}
+
+static void sim_esc_disarm(uint32_t esc_cmd_min) {
+	set_all(esc_cmd_min);
+}
+
+static void sim_esc_set_commands(const esc_cmds_t *cmd) {
+	esc_cmds_t next = *cmd;
+	void (*hook)(void) = write_hook;
+
+	if (hook) {
+		write_hook = NULL;
+		hook();
+	}
+
+	out = next;
+}
+
+static void sim_esc_request_telemetry(uint8_t esc) {
+	telemetry_request = esc + 1U;
+}
+
+/**
+  * @brief sim esc driver initialization
+  */
+const esc_protocol_interface_t sim_esc_driver = {
+	.init = sim_esc_init,
+	.deinit = sim_esc_deinit,
+	.start = sim_esc_start,
+	.stop = sim_esc_stop,
+	.arm = sim_esc_arm,
+	.disarm = sim_esc_disarm,
+	.set_commands = sim_esc_set_commands,
+	.request_telemetry = sim_esc_request_telemetry
+};
+
+/**
+  * @brief sim esc driver registration (the only esc driver in the sim build)
+  */
+DRIVER_REGISTER(sim_esc_entry) = {
+	.name = "sim",
+	.cls = DRIVER_CLASS_ESC,
+	.instances = 1U,
+	.probe = NULL,
+	.interfaces = {&sim_esc_driver}
+};
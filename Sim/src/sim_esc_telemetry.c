@@ -0,0 +1,114 @@
+/*
+ * sim_esc_telemetry.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ *
+ * Replaces Core/Src/esc/esc_telemetry.c in the SITL build: the simulator
+ * writes the frames of the requested esc into a ring standing in for the dma
+ * buffer, and esc_telemetry_read hands them to the unmodified parser in
+ * place, as the firmware does.
+ */
+
+#include "esc/esc_telemetry.h"
+#include "esc/esc_telemetry_parser.h"
+#include "common/time.h"
+#include "common/settings.h"
+#include "sim_hw.h"
+
+/**
+  * @brief  Receive Ring (same size as the firmware's dma buffer)
+  */
+#define SIM_ESC_TLM_RING_SIZE	256U
+
+/**
+  * @brief  Simulated Telemetry Line State
+  */
+static uint8_t ring[SIM_ESC_TLM_RING_SIZE];
+static uint32_t ring_head;
+static uint32_t ring_tail;
+static uint32_t overruns;
+static esc_tlm_parser_t parser;
+static bool running;
+
+
+/**
+  * @brief receives bytes from the simulated escs (bytes the firmware did not
+  * 	   read in time are overwritten, as by the dma)
+  *
+  * @param  buf		read-only pointer to bytes
+  * @param	len		number of bytes
+  *
+  * @retval None
+  */
+void sim_esc_telemetry_write(const uint8_t *buf, uint32_t len) {
+	for (uint32_t i = 0; i < len; ++i) {
+		ring[ring_head] = buf[i];
+		ring_head = (ring_head + 1U) % SIM_ESC_TLM_RING_SIZE;
+		if (ring_head == ring_tail) {
+			ring_tail = (ring_tail + 1U) % SIM_ESC_TLM_RING_SIZE;
+			overruns++;
+		}
+	}
+}
+
+esc_tlm_status_t esc_telemetry_init(void) {
+	esc_tlm_data_t unused;
+
+	ring_head = 0U;
+	ring_tail = 0U;
+	overruns = 0U;
+	running = false;
+	esc_telemetry_parser_init(&parser, CONFIG_ESC_TLM_TIMEOUT_US, CONFIG_ESC_TLM_STALE_MS * 1000U, CONFIG_ESC_MOTOR_POLES);
+
+	if (esc_request_telemetry(esc_telemetry_parser_poll(&parser, micros(), &unused)) != ESC_OK)
+		return ESC_TLM_ERROR_WARN;
+
+	running = true;
+	return ESC_TLM_OK;
+}
+
+esc_tlm_status_t esc_telemetry_deinit(void) {
+	running = false;
+	return ESC_TLM_OK;
+}
+
+/**
+  * @brief esc telemetry API call to parse what arrived since the last call and
+  * 	   request the next frame
+  *
+  * @param  data	pointer to esc telemetry data handle
+  * @retval esc telemetry status (WARN on lost, corrupted or missing frames and
+  * 		on an overheated esc)
+  */
+esc_tlm_status_t esc_telemetry_read(esc_tlm_data_t *data) {
+	uint32_t errors = parser.stats.crc_errors + parser.stats.timeouts + overruns;
+	esc_tlm_status_t status = ESC_TLM_OK;
+	uint64_t now = micros();
+	uint8_t motor;
+
+	data->fresh = 0U;
+	if (!running)
+		return ESC_TLM_OK;
+
+	(void) esc_telemetry_parser_feed_ring(&parser, ring, SIM_ESC_TLM_RING_SIZE, &ring_tail, ring_head, now, data);
+
+	motor = esc_telemetry_parser_poll(&parser, now, data);
+	if ((motor != ESC_TLM_NO_REQUEST) && (esc_request_telemetry(motor) != ESC_OK))
+		status = ESC_TLM_ERROR_WARN;
+
+	if ((parser.stats.crc_errors + parser.stats.timeouts + overruns) != errors)
+		status = ESC_TLM_ERROR_WARN;
+
+	for (uint32_t m = 0; m < ESC_COUNT; ++m) {
+		if (data->motor[m].valid && (data->motor[m].temperature_c > CONFIG_ESC_TLM_TEMP_MAX_C))
+			status = ESC_TLM_ERROR_WARN;
+	}
+
+	return status;
+}
+
+void esc_telemetry_get_stats(esc_tlm_stats_t *out) {
+	*out = parser.stats;
+	out->overruns = overruns;
+}
@@ -0,0 +1,126 @@
+/*
+ * sim_gps.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ *
+ * Replaces Core/Src/sensors/gps/gps.c in the SITL build: the simulator writes
+ * receiver bytes into a ring standing in for the dma buffer, and gps_read
+ * hands them to the unmodified parser in place, as the firmware does.
+ */
+
+#include <string.h>
+#include "sensors/gps/gps.h"
+#include "sensors/gps/gps_parser.h"
+#include "sim_hw.h"
+
+/**
+  * @brief  Receive Ring (same size as the firmware's dma buffer)
+  */
+#define SIM_GPS_RING_SIZE		1024U
+
+/**
+  * @brief  Simulated Receiver State
+  */
+static uint8_t ring[SIM_GPS_RING_SIZE];
+static uint32_t ring_head;
+static uint32_t ring_tail;
+static uint32_t overruns;
+static gps_parser_t parser;
+
+
+/**
+  * @brief helper function to store a little-endian word
+  *
+  * @retval None
+  */
+static void put_u32(uint8_t *buf, uint32_t offset, uint32_t value) {
+	buf[offset + 0U] = (uint8_t) value;
+	buf[offset + 1U] = (uint8_t) (value >> 8);
+	buf[offset + 2U] = (uint8_t) (value >> 16);
+	buf[offset + 3U] = (uint8_t) (value >> 24);
+}
+
+/**
+  * @brief encodes a navigation solution as a ubx NAV-PVT frame (the fields
+  * 	   the parser decodes; gnssFixOK set with a 2D/3D fix)
+  *
+  * @param  sol		read-only pointer to solution
+  * @param	out		frame buffer (UBX_NAV_PVT_LEN + UBX_FRAME_OVERHEAD bytes)
+  *
+  * @retval frame length
+  */
+uint32_t sim_gps_nav_pvt(const gps_data_t *sol, uint8_t *out) {
+	uint8_t payload[UBX_NAV_PVT_LEN];
+
+	memset(payload, 0, sizeof(payload));
+	put_u32(payload, 0U, sol->time_ms);
+	payload[20] = sol->fix;
+	payload[21] = (sol->fix != GPS_FIX_NONE) ? 0x01U : 0x00U;
+	payload[23] = sol->num_sv;
+	put_u32(payload, 24U, (uint32_t) sol->lon_e7);
+	put_u32(payload, 28U, (uint32_t) sol->lat_e7);
+	put_u32(payload, 32U, (uint32_t) sol->alt_msl_mm);
+	put_u32(payload, 36U, (uint32_t) sol->alt_msl_mm);
+	put_u32(payload, 40U, sol->h_acc_mm);
+	put_u32(payload, 44U, sol->v_acc_mm);
+	put_u32(payload, 48U, (uint32_t) sol->vel_ned_mms[0]);
+	put_u32(payload, 52U, (uint32_t) sol->vel_ned_mms[1]);
+	put_u32(payload, 56U, (uint32_t) sol->vel_ned_mms[2]);
+	put_u32(payload, 68U, sol->s_acc_mms);
+
+	return ubx_frame(UBX_CLASS_NAV, UBX_ID_NAV_PVT, payload, UBX_NAV_PVT_LEN, out);
+}
+
+/**
+  * @brief receives bytes from the simulated receiver (bytes the firmware did
+  * 	   not read in time are overwritten, as by the dma)
+  *
+  * @param  buf		read-only pointer to bytes
+  * @param	len		number of bytes
+  *
+  * @retval None
+  */
+void sim_gps_write(const uint8_t *buf, uint32_t len) {
+	for (uint32_t i = 0; i < len; ++i) {
+		ring[ring_head] = buf[i];
+		ring_head = (ring_head + 1U) % SIM_GPS_RING_SIZE;
+		if (ring_head == ring_tail) {
+			ring_tail = (ring_tail + 1U) % SIM_GPS_RING_SIZE;
+			overruns++;
+		}
+	}
+}
+
+gps_status_t gps_init(void) {
+	ring_head = 0U;
+	ring_tail = 0U;
+	overruns = 0U;
+	gps_parser_init(&parser);
+	return GPS_OK;
+}
+
+gps_status_t gps_deinit(void) {
+	return GPS_OK;
+}
+
+/**
+  * @brief gps API call to parse what arrived since the last call
+  *
+  * @param  data	pointer to gps data handle
+  * @retval gps status (WARN on lost or corrupted data)
+  */
+gps_status_t gps_read(void *data) {
+	gps_data_t *gps = (gps_data_t*) data;
+	uint32_t errors = parser.stats.checksum_errors + parser.stats.framing_errors + overruns;
+
+	gps->fresh = false;
+	(void) gps_parser_feed_ring(&parser, ring, SIM_GPS_RING_SIZE, &ring_tail, ring_head, gps);
+
+	return ((parser.stats.checksum_errors + parser.stats.framing_errors + overruns) != errors) ? GPS_ERROR_WARN : GPS_OK;
+}
+
+void gps_get_stats(gps_stats_t *out) {
+	*out = parser.stats;
+	out->overruns = overruns;
+}
@@ -0,0 +1,54 @@
+/*
+ * sim_imu.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ *
+ * Replaces Core/Src/sensors/imu/imu.c in the SITL build: serves the sample
+ * synthesized by the simulator (accel in mg, rates in mdps, dt in us).
+ */
+
+#include "sensors/imu/imu.h"
+#include "sim_hw.h"
+
+/**
+  * @brief  IMU Comm Peripheral Handle Pointers (unused on host)
+  */
+const I2C_HandleTypeDef* phi2c = NULL;
+
+const void* platform_handle = NULL;
+
+/**
+  * @brief  Latest Simulated Sample
+  */
+static imu_6D_t sample;
+
+
+/**
+  * @brief publishes the next imu sample
+  *
+  * @param  s	read-only pointer to imu sample
+  * @retval None
+  */
+void sim_imu_set_sample(const imu_6D_t *s) {
+	sample = *s;
+}
+
+imu_status_t imu_init(void) {
+	return IMU_OK;
+}
+
+imu_status_t imu_deinit(void) {
+	return IMU_OK;
+}
+
+/**
+  * @brief imu API call to read imu data
+  *
+  * @param  data	pointer to imu 6D data handle
+  * @retval imu status
+  */
+imu_status_t imu_read(void *data) {
+	*(imu_6D_t*) data = sample;
+	return IMU_OK;
+}
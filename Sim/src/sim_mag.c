@@ -0,0 +1,66 @@
+/*
+ * sim_mag.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ *
+ * Sim mag device (selected by CONFIG_MAG_DEVICE in the SITL build): serves the
+ * raw reading synthesized by the simulator, so mag.c and its calibration run
+ * unchanged on top of it.
+ */
+
+#include <string.h>
+#include "sensors/mag/devices/sim_mag.h"
+#include "sim_hw.h"
+
+/**
+  * @brief  Latest Simulated Reading
+  */
+static float sample[3];
+static bool pending;
+
+
+/**
+  * @brief publishes the next mag reading
+  *
+  * @param  field_mgauss	raw field in the body frame
+  * @retval None
+  */
+void sim_mag_set_sample(const float field_mgauss[3]) {
+	memcpy(sample, field_mgauss, sizeof(sample));
+	pending = true;
+}
+
+static mag_status_t sim_mag_init(void) {
+	pending = false;
+	return MAG_OK;
+}
+
+static mag_status_t sim_mag_deinit(void) {
+	return MAG_OK;
+}
+
+/**
+  * @brief reads the simulated mag reading
+  *
+  * @param  data	pointer to mag data handle
+  * @retval mag status
+  */
+static mag_status_t sim_mag_read(void *data) {
+	mag_data_t *mag = (mag_data_t*) data;
+
+	memcpy(mag->raw_mgauss, sample, sizeof(sample));
+	mag->fresh = pending;
+	pending = false;
+
+	return MAG_OK;
+}
+
+/**
+  * @brief sim mag driver initialization
+  */
+const mag_interface_t sim_mag_driver = {
+	.init = sim_mag_init,
+	.deinit = sim_mag_deinit,
+	.read = sim_mag_read
+};
@@ -0,0 +1,83 @@
+/*
+ * sim_rx.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include "rx/protocols/sim_rx.h"
+#include "sim_hw.h"
+#include "system/driver_registry.h"
+
+/**
+  * @brief  Simulated Channel Values (1-based like pwm rx: pulse us on aetr,
+  * 		logical level on arm/mode)
+  */
+static uint32_t channels[SIM_RX_CHANNEL_COUNT + 1U];
+
+
+/**
+  * @brief sets a simulated channel value
+  *
+  * @param  ch		channel (1..SIM_RX_CHANNEL_COUNT)
+  * @param	value	pulse width (us) or logical level
+  *
+  * @retval None
+  */
+void sim_rx_set_channel(uint8_t ch, uint32_t value) {
+	if ((ch == 0U) || (ch > SIM_RX_CHANNEL_COUNT))
+		return;
+
+	channels[ch] = value;
+}
+
+static rx_status_t sim_rx_init(void) {
+	return RX_OK;
+}
+
+static rx_status_t sim_rx_deinit(void) {
+	return RX_OK;
+}
+
+static rx_status_t sim_rx_start(void) {
+	return RX_OK;
+}
+
+static rx_status_t sim_rx_stop(void) {
+	return RX_OK;
+}
+
+/**
+  * @brief get simulated channel value
+  *
+  * @param  ch		channel to get value from
+  * @retval channel value (0 if invalid channel requested)
+  */
+static uint32_t sim_rx_get_channel(const uint8_t ch) {
+	if ((ch == 0U) || (ch > SIM_RX_CHANNEL_COUNT))
+		return 0U;
+
+	return channels[ch];
+}
+
+/**
+  * @brief sim rx driver initialization
+  */
+const rx_protocol_interface_t sim_rx_driver = {
+	.init = sim_rx_init,
+	.deinit = sim_rx_deinit,
+	.start = sim_rx_start,
+	.stop = sim_rx_stop,
+	.get_channel = sim_rx_get_channel
+};
+
+/**
+  * @brief sim rx driver registration (the only rx driver in the sim build)
+  */
+DRIVER_REGISTER(sim_rx_entry) = {
+	.name = "sim",
+	.cls = DRIVER_CLASS_RX,
+	.instances = 1U,
+	.probe = NULL,
+	.interfaces = {&sim_rx_driver}
+};
@@ -0,0 +1,181 @@
+/*
+ * sim_sd_card.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "storage/card/sim_sd_card.h"
+#include "common/cycles.h"
+#include "sim_hw.h"
+
+/**
+  * @brief  Card Timing Model (ns; roughly a class 10 card on a 24 MHz 4-bit bus)
+  */
+#define SIM_SD_CMD_NS			200000U		// command + response + card setup per write
+#define SIM_SD_BLOCK_NS			45000U		// bus transfer and programming per block
+#define SIM_SD_ERASE_NS			400000U		// erase before programming, unless pre-erased
+#define SIM_SD_STALL_NS			50000000U	// internal housekeeping (wear leveling)..
+#define SIM_SD_STALL_BYTES		(2U * 1024U * 1024U)	// ..once per this many bytes
+
+/**
+  * @brief  Card State
+  */
+static uint8_t *image;
+static uint32_t image_blocks;
+static uint64_t programmed;			// bytes since format (drives the stalls)
+static uint32_t fail_at;			// transfer number to fail (0: never)
+static uint32_t transfer_count;
+
+/**
+  * @brief  Pending Transfer (data lands on completion, so a buffer reused
+  * 		early shows up as corrupted data)
+  */
+static const uint32_t *pend_buf;
+static uint32_t pend_block;
+static uint32_t pend_count;
+static uint32_t pend_start;
+static uint32_t pend_ns;
+static bool pending;
+
+
+/**
+  * @brief (re)creates a blank card
+  *
+  * @param  block_count		card size in blocks
+  * @retval None
+  */
+void sim_sd_card_format(uint32_t block_count) {
+	free(image);
+	image = calloc(block_count, SD_BLOCK_SIZE);
+	image_blocks = image ? block_count : 0U;
+	programmed = 0U;
+	fail_at = 0U;
+	transfer_count = 0U;
+	pending = false;
+}
+
+/**
+  * @brief fetches the card contents
+  *
+  * @retval read-only pointer to block 0
+  */
+const uint8_t *sim_sd_card_image(void) {
+	return image;
+}
+
+/**
+  * @brief makes the n-th write from now on fail (0 disables)
+  *
+  * @param  n	transfer number (1: next)
+  * @retval None
+  */
+void sim_sd_card_fail_transfer(uint32_t n) {
+	fail_at = n ? transfer_count + n : 0U;
+}
+
+/**
+  * @brief fetches the card size
+  *
+  * @retval blocks
+  */
+uint32_t sim_sd_card_block_count(void) {
+	return image_blocks;
+}
+
+/**
+  * @brief blocking block read (file system access, untimed)
+  * 	   NOTE: fails while a streamed transfer is pending, like the real bus
+  *
+  * @param  buf		destination (count blocks)
+  * @param	block	first block
+  * @param	count	block count
+  *
+  * @retval boolean
+  */
+bool sim_sd_card_read_blocks(uint8_t *buf, uint32_t block, uint32_t count) {
+	if (pending || ((uint64_t) block + count > image_blocks))
+		return false;
+
+	memcpy(buf, image + (size_t) block * SD_BLOCK_SIZE, (size_t) count * SD_BLOCK_SIZE);
+	return true;
+}
+
+/**
+  * @brief blocking block write (file system access, untimed)
+  * 	   NOTE: fails while a streamed transfer is pending, like the real bus
+  *
+  * @param  buf		source (count blocks)
+  * @param	block	first block
+  * @param	count	block count
+  *
+  * @retval boolean
+  */
+bool sim_sd_card_write_blocks(const uint8_t *buf, uint32_t block, uint32_t count) {
+	if (pending || ((uint64_t) block + count > image_blocks))
+		return false;
+
+	memcpy(image + (size_t) block * SD_BLOCK_SIZE, buf, (size_t) count * SD_BLOCK_SIZE);
+	return true;
+}
+
+/**
+  * @brief completes the pending transfer once its modeled time has passed
+  * 	   (stands in for the sdio interrupt; called from sd_stream_service)
+  *
+  * @retval None
+  */
+static void sim_sd_card_poll(void) {
+	bool ok;
+
+	if (!pending || ((cycles_now() - pend_start) < pend_ns))
+		return;
+
+	ok = (transfer_count != fail_at);
+	if (ok)
+		memcpy(image + (size_t) pend_block * SD_BLOCK_SIZE, pend_buf, (size_t) pend_count * SD_BLOCK_SIZE);
+
+	pending = false;
+	sd_stream_write_done(ok);
+}
+
+static bool sim_sd_card_ready(void) {
+	return image && !pending;
+}
+
+static bool sim_sd_card_write(const uint32_t *buf, uint32_t block, uint32_t count) {
+	uint64_t before = programmed;
+
+	if (pending || !count || ((uintptr_t) buf & 0x3U) || ((uint64_t) block + count > image_blocks))
+		return false;
+
+	pend_buf = buf;
+	pend_block = block;
+	pend_count = count;
+	pend_start = cycles_now();
+	pend_ns = SIM_SD_CMD_NS + count * SIM_SD_BLOCK_NS;
+
+	/* Single-block writes are never pre-erased (no ACMD23) */
+	if (count == 1U)
+		pend_ns += SIM_SD_ERASE_NS;
+
+	programmed += (uint64_t) count * SD_BLOCK_SIZE;
+	if ((programmed / SIM_SD_STALL_BYTES) != (before / SIM_SD_STALL_BYTES))
+		pend_ns += SIM_SD_STALL_NS;
+
+	++transfer_count;
+	pending = true;
+
+	return true;
+}
+
+/**
+  * @brief sim sd card driver initialization
+  */
+const sd_card_interface_t sim_sd_card = {
+	.ready = sim_sd_card_ready,
+	.write = sim_sd_card_write,
+	.poll = sim_sd_card_poll
+};
@@ -0,0 +1,90 @@
+/*
+ * sim_sd_diskio.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include "sim_sd_diskio.h"
+#include "storage/sd_stream.h"
+#include "sim_hw.h"
+
+/**
+  * @brief  Driver State
+  */
+static DSTATUS stat = STA_NOINIT;
+static uint32_t write_count;		// disk_write calls (file system metadata and data)
+
+
+static DSTATUS sim_sd_initialize(BYTE lun) {
+	(void) lun;
+
+	stat = sim_sd_card_block_count() ? 0U : STA_NOINIT;
+	return stat;
+}
+
+static DSTATUS sim_sd_status(BYTE lun) {
+	(void) lun;
+
+	return stat;
+}
+
+static DRESULT sim_sd_read(BYTE lun, BYTE *buff, DWORD sector, UINT count) {
+	(void) lun;
+
+	return sim_sd_card_read_blocks(buff, sector, count) ? RES_OK : RES_ERROR;
+}
+
+static DRESULT sim_sd_write(BYTE lun, const BYTE *buff, DWORD sector, UINT count) {
+	(void) lun;
+
+	++write_count;
+	return sim_sd_card_write_blocks(buff, sector, count) ? RES_OK : RES_ERROR;
+}
+
+static DRESULT sim_sd_ioctl(BYTE lun, BYTE cmd, void *buff) {
+	(void) lun;
+
+	if (stat & STA_NOINIT)
+		return RES_NOTRDY;
+
+	switch (cmd) {
+		case CTRL_SYNC:
+			return RES_OK;
+
+		case GET_SECTOR_COUNT:
+			*(DWORD*) buff = sim_sd_card_block_count();
+			return RES_OK;
+
+		case GET_SECTOR_SIZE:
+			*(WORD*) buff = SD_BLOCK_SIZE;
+			return RES_OK;
+
+		case GET_BLOCK_SIZE:
+			*(DWORD*) buff = 1U;		// erase block in sectors (unknown)
+			return RES_OK;
+
+		default:
+			return RES_PARERR;
+	}
+}
+
+/**
+  * @brief fetches the number of disk_write calls so far
+  *
+  * @retval count
+  */
+uint32_t sim_sd_diskio_write_count(void) {
+	return write_count;
+}
+
+/**
+  * @brief sim sd fatfs driver initialization
+  */
+const Diskio_drvTypeDef sim_sd_diskio = {
+	sim_sd_initialize,
+	sim_sd_status,
+	sim_sd_read,
+	sim_sd_write,
+	sim_sd_ioctl
+};
@@ -0,0 +1,31 @@
+/*
+ * sim_time.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ *
+ * Replaces the clocks of Core/Src/common/time.c in the SITL build: they run
+ * on simulated time. Tools that keep their own clock define millis() and
+ * micros() themselves, and this file is then not linked from the library.
+ */
+
+#include <stdint.h>
+#include "sitl.h"
+
+/**
+  * @brief gets the simulated time
+  *
+  * @retval time since sitl_init (ms)
+  */
+uint32_t millis(void) {
+	return (uint32_t) (sitl_time_us() / 1000U);
+}
+
+/**
+  * @brief gets the simulated time
+  *
+  * @retval time since sitl_init (us)
+  */
+uint64_t micros(void) {
+	return sitl_time_us();
+}
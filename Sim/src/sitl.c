@@ -0,0 +1,799 @@
+/*
+ * sitl.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <math.h>
+#include <string.h>
+#include "sitl.h"
+#include "sim_hw.h"
+#include "trace.h"
+#include "params/params.h"
+#include "flight/mixer.h"
+#include "sensors/gps/gps_parser.h"
+#include "esc/esc_telemetry_parser.h"
+#include "rx/rx.h"
+#include "esc/esc.h"
+#include "common/maths.h"
+#include "common/settings.h"
+
+/**
+  * @brief  Rx Channel Map (AETR, arm, mode; same as rc_input)
+  */
+#define SIM_CH_ROLL			1U
+#define SIM_CH_PITCH		2U
+#define SIM_CH_THROTTLE		3U
+#define SIM_CH_YAW			4U
+#define SIM_CH_ARM			5U
+#define SIM_CH_MODE			6U
+
+/**
+  * @brief  Two-Position Switch Levels (as reported by pwm rx)
+  */
+#define SIM_SWITCH_LOW		1U
+#define SIM_SWITCH_HIGH		2U
+
+/**
+  * @brief  Invariant Tolerance (motor command counts; float rounding)
+  */
+#define SIM_INVARIANT_TOL	1.0e-2f
+
+/**
+  * @brief  Simulated GPS Receiver (NAV-PVT over a 115200 baud uart, world
+  * 		origin at SIM_GPS_ORIGIN, x north, y west)
+  */
+#define SIM_GPS_ORIGIN_LAT_E7	473977420
+#define SIM_GPS_ORIGIN_LON_E7	85455940
+#define SIM_GPS_ORIGIN_MSL_M	488.0
+#define SIM_GPS_M_PER_DEG_E7	(6378137.0 * 3.14159265358979 / 180.0 * 1e-7)
+#define SIM_GPS_POS_CORR_S		30.0f		// gauss-markov position error correlation time
+#define SIM_GPS_BYTES_PER_S		((double) CONFIG_GPS_BAUD / 10.0)
+#define SIM_GPS_QUEUE_LEN		4U
+#define SIM_GPS_FRAME_LEN		(UBX_NAV_PVT_LEN + UBX_FRAME_OVERHEAD)
+
+/**
+  * @brief  Simulated Magnetometer (lis2mdl odr; earth field at the gps origin,
+  * 		world frame: 216 mG north, 424 mG down)
+  */
+#define SIM_MAG_RATE_HZ			100U
+#define SIM_MAG_FIELD_N_MGAUSS	216.0f
+#define SIM_MAG_FIELD_U_MGAUSS	(-424.0f)
+
+/**
+  * @brief  Simulated Battery (lipo open circuit voltage per cell at 0, 10 .. 100 %
+  * 		charge; current: electronics plus each motor ~ command^1.5)
+  */
+#define SIM_BATT_OCV_POINTS		11U
+#define SIM_BATT_IDLE_A			0.3f
+#define SIM_BATT_MOTOR_MAX_A	15.0f
+
+/**
+  * @brief  Simulated ESC Telemetry (rpm ~ sqrt of the normalized thrust; esc
+  * 		temperature first-order towards ambient + current x rise)
+  */
+#define SIM_ESC_RPM_MAX			24000.0f
+#define SIM_ESC_AMBIENT_C		25.0f
+#define SIM_ESC_TEMP_RISE_C_PER_A	3.0f
+#define SIM_ESC_TEMP_TAU_S		20.0f
+
+/**
+  * @brief  Simulated GPS Frame in Flight
+  */
+typedef struct {
+	uint8_t frame[SIM_GPS_FRAME_LEN];
+	uint32_t len;
+	uint32_t sent;
+	double start_s;					// first byte on the wire
+} sim_gps_frame_t;
+
+/**
+  * @brief  Simulator State
+  */
+static sitl_config_t config;
+static quad_state_t quad;
+static flight_data_t flight;
+static flight_status_t flight_status;
+static uint64_t loop_count;
+static uint32_t rng_state;
+static uint32_t baro_rng_state;		// own stream: imu noise is the same with or without baro
+static double next_baro_s;
+static uint32_t gps_rng_state;		// own stream, as baro
+static double next_gps_s;
+static float gps_pos_err_m[2];		// gauss-markov position error
+static uint32_t mag_rng_state;		// own stream, as baro
+static double next_mag_s;
+static uint32_t batt_rng_state;		// own stream, as baro
+static float batt_current_a;
+static float batt_consumed_mah;
+static float motor_current_a[QUAD_MOTOR_COUNT];
+static float esc_consumed_mah[QUAD_MOTOR_COUNT];
+static float esc_temperature_c[QUAD_MOTOR_COUNT];
+static sim_gps_frame_t gps_queue[SIM_GPS_QUEUE_LEN];
+static uint32_t gps_queue_head;
+static uint32_t gps_queue_count;
+static trace_t trace;
+static uint32_t violations;
+static const char *violation;
+static uint64_t violation_loop;
+static volatile bool crash_latched;		// crash isr model (see crash_irq)
+static volatile uint32_t crash_disarms;
+
+
+/**
+  * @brief helper function: xorshift32 uniform sample in (0, 1]
+  *
+  * @param  state	generator state
+  * @retval sample
+  */
+static float rand_uniform(uint32_t *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return ((float)(*state >> 8) + 1.0f) / 16777216.0f;
+}
+
+/**
+  * @brief helper function: standard normal sample (Box-Muller)
+  *
+  * @param  state	generator state
+  * @retval sample
+  */
+static float rand_normal(uint32_t *state) {
+	float u1 = rand_uniform(state);
+	float u2 = rand_uniform(state);
+	return sqrtf(-2.0f * logf(u1)) * cosf(6.28318531f * u2);
+}
+
+/**
+  * @brief helper function to synthesize the imu sample the firmware reads
+  * 	   (accel in mg, rates in mdps, dt in us; same as the lsm6dsox driver)
+  *
+  * @retval None
+  */
+static void publish_imu_sample(void) {
+	const float r2d = 180.0f / 3.14159265f;
+	float f_b[3];
+	imu_6D_t s;
+
+	quad_specific_force(&quad, &config.quad, f_b);
+
+	s.accel_x = f_b[0] / config.quad.gravity_mps2 * 1000.0f + config.accel_bias_mg[0] + config.accel_noise_mg * rand_normal(&rng_state);
+	s.accel_y = f_b[1] / config.quad.gravity_mps2 * 1000.0f + config.accel_bias_mg[1] + config.accel_noise_mg * rand_normal(&rng_state);
+	s.accel_z = f_b[2] / config.quad.gravity_mps2 * 1000.0f + config.accel_bias_mg[2] + config.accel_noise_mg * rand_normal(&rng_state);
+
+	s.rate_x = (quad.rate_rps[0] * r2d + config.gyro_bias_dps[0] + config.gyro_noise_dps * rand_normal(&rng_state)) * 1000.0f;
+	s.rate_y = (quad.rate_rps[1] * r2d + config.gyro_bias_dps[1] + config.gyro_noise_dps * rand_normal(&rng_state)) * 1000.0f;
+	s.rate_z = (quad.rate_rps[2] * r2d + config.gyro_bias_dps[2] + config.gyro_noise_dps * rand_normal(&rng_state)) * 1000.0f;
+
+	s.dt = (uint32_t) lroundf(1.0e6f / (float) config.loop_hz);
+
+	sim_imu_set_sample(&s);
+}
+
+/**
+  * @brief helper function to synthesize a baro conversion at CONFIG_BARO_RATE_HZ
+  * 	   (standard atmosphere over the model altitude, ground at sea level)
+  *
+  * @retval None
+  */
+static void publish_baro_sample(void) {
+	double now_s = (double) loop_count / (double) config.loop_hz;
+	float pressure_pa;
+
+	if (now_s < next_baro_s)
+		return;
+	next_baro_s += 1.0 / (double) CONFIG_BARO_RATE_HZ;
+
+	pressure_pa = 101325.0f * powf(1.0f - quad.pos_m[2] / 44330.77f, 1.0f / 0.190263f) +
+				  config.baro_noise_pa * rand_normal(&baro_rng_state);
+
+	sim_baro_set_sample(&(baro_data_t){.pressure_cpa = (uint32_t) lroundf(pressure_pa * 100.0f),
+									   .temperature_cdeg = 2500});
+}
+
+/**
+  * @brief helper function to synthesize a magnetometer sample at
+  * 	   SIM_MAG_RATE_HZ (earth field rotated into the body frame, plus the
+  * 	   configured hard iron and noise)
+  *
+  * @retval None
+  */
+static void publish_mag_sample(void) {
+	static const float field_w[3] = {SIM_MAG_FIELD_N_MGAUSS, 0.0f, SIM_MAG_FIELD_U_MGAUSS};
+	double now_s = (double) loop_count / (double) config.loop_hz;
+	float field_b[3];
+
+	if (now_s < next_mag_s)
+		return;
+	next_mag_s += 1.0 / (double) SIM_MAG_RATE_HZ;
+
+	quad_world_to_body(&quad, field_w, field_b);
+	for (uint32_t i = 0; i < 3U; ++i)
+		field_b[i] += config.mag_offset_mgauss[i] + config.mag_noise_mgauss * rand_normal(&mag_rng_state);
+
+	sim_mag_set_sample(field_b);
+}
+
+/**
+  * @brief helper function to get the pack open circuit voltage at the
+  * 	   charge left
+  *
+  * @retval voltage
+  */
+static float battery_ocv(void) {
+	static const float cell_ocv_v[SIM_BATT_OCV_POINTS] = {
+		3.30f, 3.55f, 3.68f, 3.73f, 3.77f, 3.80f, 3.84f, 3.90f, 3.98f, 4.07f, 4.20f
+	};
+	float soc = constrainf(1.0f - batt_consumed_mah / config.batt_capacity_mah, 0.0f, 1.0f);
+	float x = soc * (float) (SIM_BATT_OCV_POINTS - 1U);
+	uint32_t i = (uint32_t) x;
+
+	if (i >= (SIM_BATT_OCV_POINTS - 1U))
+		return cell_ocv_v[SIM_BATT_OCV_POINTS - 1U] * (float) config.batt_cells;
+
+	return (cell_ocv_v[i] + (x - (float) i) * (cell_ocv_v[i + 1U] - cell_ocv_v[i])) * (float) config.batt_cells;
+}
+
+/**
+  * @brief helper function to draw the pack current for one loop period
+  *
+  * @param  mcmd	normalized motor commands applied over it
+  * @retval None
+  */
+static void battery_draw(const float mcmd[QUAD_MOTOR_COUNT]) {
+	const float dt = 1.0f / (float) config.loop_hz;
+	const float a = dt / (SIM_ESC_TEMP_TAU_S + dt);
+
+	batt_current_a = SIM_BATT_IDLE_A;
+	for (uint32_t i = 0; i < QUAD_MOTOR_COUNT; ++i) {
+		motor_current_a[i] = SIM_BATT_MOTOR_MAX_A * powf(constrainf(mcmd[i], 0.0f, 1.0f), 1.5f);
+		esc_consumed_mah[i] += motor_current_a[i] * dt / 3.6f;
+		esc_temperature_c[i] += a * (SIM_ESC_AMBIENT_C + SIM_ESC_TEMP_RISE_C_PER_A * motor_current_a[i] -
+									 esc_temperature_c[i]);
+		batt_current_a += motor_current_a[i];
+	}
+
+	batt_consumed_mah += batt_current_a * dt / 3.6f;
+}
+
+/**
+  * @brief helper function to publish the pack voltage (sagging by current x
+  * 	   resistance) and current, as the adc averages would read them
+  *
+  * @retval None
+  */
+static void publish_battery_sample(void) {
+	float voltage_v = battery_ocv() - batt_current_a * config.batt_resistance_ohm +
+					  config.batt_noise_v * rand_normal(&batt_rng_state);
+
+	sim_battery_set_sample(voltage_v, batt_current_a);
+}
+
+/**
+  * @brief helper function to get the motor rpm (from the motor output, which
+  * 	   lags the command)
+  *
+  * @param  motor	motor index
+  * @retval rpm
+  */
+static float motor_rpm(uint32_t motor) {
+	return SIM_ESC_RPM_MAX * sqrtf(constrainf(quad.motor[motor], 0.0f, 1.0f));
+}
+
+/**
+  * @brief helper function to reply to the esc telemetry request of this loop
+  * 	   with a frame of the requested esc (sent well within a loop period at
+  * 	   CONFIG_ESC_TLM_BAUD)
+  *
+  * @retval None
+  */
+static void publish_esc_telemetry(void) {
+	uint8_t frame[ESC_TLM_FRAME_LEN];
+	esc_motor_tlm_t tlm = {0};
+	uint8_t m;
+
+	if (!sim_esc_take_telemetry_request(&m) || (m >= QUAD_MOTOR_COUNT))
+		return;
+
+	tlm.voltage_v = battery_ocv() - batt_current_a * config.batt_resistance_ohm;
+	tlm.current_a = motor_current_a[m];
+	tlm.consumption_mah = (uint16_t) esc_consumed_mah[m];
+	tlm.erpm = (uint32_t) (motor_rpm(m) * (float) (CONFIG_ESC_MOTOR_POLES / 2U));
+	tlm.temperature_c = (uint8_t) lroundf(esc_temperature_c[m]);
+
+	sim_esc_telemetry_write(frame, esc_telemetry_frame(&tlm, frame));
+}
+
+/**
+  * @brief helper function to convert a world position (x north, y west) to
+  * 	   latitude / longitude
+  *
+  * @param  pos		world position
+  * @param	lat_e7	latitude buffer to be filled (1e-7 deg)
+  * @param	lon_e7	longitude buffer to be filled (1e-7 deg)
+  *
+  * @retval None
+  */
+static void world_to_gps(const float pos[2], int32_t *lat_e7, int32_t *lon_e7) {
+	double lon_scale = cos((double) SIM_GPS_ORIGIN_LAT_E7 * 1e-7 * 3.14159265358979 / 180.0);
+
+	*lat_e7 = SIM_GPS_ORIGIN_LAT_E7 + (int32_t) lround((double) pos[0] / SIM_GPS_M_PER_DEG_E7);
+	*lon_e7 = SIM_GPS_ORIGIN_LON_E7 + (int32_t) lround(-(double) pos[1] / (SIM_GPS_M_PER_DEG_E7 * lon_scale));
+}
+
+/**
+  * @brief helper function to synthesize a NAV-PVT solution at CONFIG_GPS_RATE_HZ
+  * 	   and stream it to the firmware at the uart rate, the last byte
+  * 	   config.gps_delay_ms after the epoch it describes
+  *
+  * @retval None
+  */
+static void publish_gps_sample(void) {
+	double now_s = (double) loop_count / (double) config.loop_hz;
+
+	if (now_s >= next_gps_s) {
+		const float period_s = 1.0f / (float) CONFIG_GPS_RATE_HZ;
+		const float a = expf(-period_s / SIM_GPS_POS_CORR_S);
+		gps_data_t sol = {0};
+		float pos[2];
+
+		next_gps_s += (double) period_s;
+
+		for (uint32_t i = 0; i < 2U; ++i) {
+			gps_pos_err_m[i] = a * gps_pos_err_m[i] +
+							   config.gps_pos_noise_m * sqrtf(1.0f - a * a) * rand_normal(&gps_rng_state);
+			pos[i] = quad.pos_m[i] + gps_pos_err_m[i];
+		}
+
+		world_to_gps(pos, &sol.lat_e7, &sol.lon_e7);
+		sol.alt_msl_mm = (int32_t) lround((SIM_GPS_ORIGIN_MSL_M + (double) quad.pos_m[2]) * 1000.0);
+		sol.vel_ned_mms[0] = (int32_t) lroundf((quad.vel_mps[0] + config.gps_vel_noise_mps * rand_normal(&gps_rng_state)) * 1000.0f);
+		sol.vel_ned_mms[1] = (int32_t) lroundf((-quad.vel_mps[1] + config.gps_vel_noise_mps * rand_normal(&gps_rng_state)) * 1000.0f);
+		sol.vel_ned_mms[2] = (int32_t) lroundf(-quad.vel_mps[2] * 1000.0f);
+		sol.h_acc_mm = (uint32_t) lroundf(fmaxf(3.0f * config.gps_pos_noise_m, 1.0f) * 1000.0f);
+		sol.v_acc_mm = 2U * sol.h_acc_mm;
+		sol.s_acc_mms = (uint32_t) lroundf(fmaxf(3.0f * config.gps_vel_noise_mps, 0.1f) * 1000.0f);
+		sol.time_ms = (uint32_t) llround(now_s * 1000.0);
+		sol.fix = GPS_FIX_3D;
+		sol.num_sv = 12U;
+
+		if (gps_queue_count < SIM_GPS_QUEUE_LEN) {
+			uint32_t idx = (gps_queue_head + gps_queue_count++) % SIM_GPS_QUEUE_LEN;
+
+			gps_queue[idx].len = sim_gps_nav_pvt(&sol, gps_queue[idx].frame);
+			gps_queue[idx].sent = 0U;
+			gps_queue[idx].start_s = now_s + (double) config.gps_delay_ms * 1e-3 -
+									 (double) gps_queue[idx].len / SIM_GPS_BYTES_PER_S;
+		}
+	}
+
+	/* Stream the bytes due by now, one frame after the other */
+	while (gps_queue_count > 0U) {
+		sim_gps_frame_t *q = &gps_queue[gps_queue_head];
+		double due = (now_s - q->start_s) * SIM_GPS_BYTES_PER_S;
+		uint32_t n = (due <= 0.0) ? 0U : (uint32_t) fmin(due, (double) q->len);
+
+		if (n > q->sent) {
+			sim_gps_write(&q->frame[q->sent], n - q->sent);
+			q->sent = n;
+		}
+
+		if (q->sent < q->len)
+			break;
+
+		gps_queue_head = (gps_queue_head + 1U) % SIM_GPS_QUEUE_LEN;
+		gps_queue_count--;
+
+		/* The next frame cannot start before this one ended */
+		if (gps_queue_count > 0U)
+			gps_queue[gps_queue_head].start_s = fmax(gps_queue[gps_queue_head].start_s,
+													 q->start_s + (double) q->len / SIM_GPS_BYTES_PER_S);
+	}
+}
+
+/**
+  * @brief helper function to map applied esc commands to normalized motor commands
+  *
+  * @retval None
+  */
+static void read_motor_commands(float out[QUAD_MOTOR_COUNT]) {
+	uint32_t min, max;
+	esc_cmds_t esc;
+
+	sim_esc_get_range(&min, &max);
+	sim_esc_get_commands(&esc);
+
+	if (!sim_esc_is_running()) {
+		memset(out, 0, QUAD_MOTOR_COUNT * sizeof(float));
+		return;
+	}
+
+	out[0] = ((float) esc.esc1 - (float) min) / (float)(max - min);
+	out[1] = ((float) esc.esc2 - (float) min) / (float)(max - min);
+	out[2] = ((float) esc.esc3 - (float) min) / (float)(max - min);
+	out[3] = ((float) esc.esc4 - (float) min) / (float)(max - min);
+}
+
+/**
+  * @brief helper function to record an invariant violation
+  *
+  * @param  ok		whether the invariant holds
+  * @param	name	invariant name
+  *
+  * @retval None
+  */
+static void expect(bool ok, const char *name) {
+	if (ok)
+		return;
+
+	if (!violations) {
+		violation = name;
+		violation_loop = loop_count;
+	}
+	++violations;
+}
+
+/**
+  * @brief helper function to check the properties every flight loop must
+  * 	   hold, whatever the inputs
+  *
+  * @retval None
+  */
+static void check_invariants(void) {
+	const attitude_cmd_t *cmd = &flight.cmd;
+	const attitude_cmd_t zero = {0};
+	mtr_cmds_t mix, base;
+	esc_cmd_props_t props;
+	esc_cmds_t esc;
+	uint32_t floor;
+
+	/* Rate PID outputs are clamped to their command limits */
+	expect(fabsf(cmd->roll) <= map_pct_to_mtr_span(params_get_float(PARAM_ROLL_RATE_CMD_LIM)) + SIM_INVARIANT_TOL,
+		   "roll rate pid output within limit");
+	expect(fabsf(cmd->pitch) <= map_pct_to_mtr_span(params_get_float(PARAM_PITCH_RATE_CMD_LIM)) + SIM_INVARIANT_TOL,
+		   "pitch rate pid output within limit");
+	expect(fabsf(cmd->yaw) <= map_pct_to_mtr_span(params_get_float(PARAM_YAW_RATE_CMD_LIM)) + SIM_INVARIANT_TOL,
+		   "yaw rate pid output within limit");
+
+	/* Applied throttle (stick or altitude hold) stays within the stick range */
+	expect(inrangef(flight.alt_cmd.throttle, THROTTLE_MIN_PCT, THROTTLE_MAX_PCT), "throttle within range");
+
+	/* Mixer outputs split back into throttle, roll, pitch and yaw */
+	mixer_update(&mix, cmd, flight.alt_cmd.throttle);
+	mixer_update(&base, &zero, flight.alt_cmd.throttle);
+	expect(fabsf((mix.mtr1 + mix.mtr2 + mix.mtr3 + mix.mtr4) - 4.0f * base.mtr1) <= 4.0f * SIM_INVARIANT_TOL,
+		   "mixer outputs sum to throttle");
+	expect(fabsf((mix.mtr1 + mix.mtr2 - mix.mtr3 - mix.mtr4) - 4.0f * cmd->roll) <= 4.0f * SIM_INVARIANT_TOL,
+		   "mixer roll split");
+	expect(fabsf((mix.mtr2 + mix.mtr4 - mix.mtr1 - mix.mtr3) - 4.0f * cmd->pitch) <= 4.0f * SIM_INVARIANT_TOL,
+		   "mixer pitch split");
+	expect(fabsf((mix.mtr1 + mix.mtr4 - mix.mtr2 - mix.mtr3) - 4.0f * cmd->yaw) <= 4.0f * SIM_INVARIANT_TOL,
+		   "mixer yaw split");
+
+	/* Applied esc commands stay within the esc range (idle while flying) */
+	if (!sim_esc_is_running())
+		return;
+
+	esc_get_command_properties(&props);
+	sim_esc_get_commands(&esc);
+	floor = (flight_status.phase == FLIGHT_PHASE_FLYING) ? props.idle : props.min;
+
+	expect(inrange_u32(esc.esc1, floor, props.limit) && inrange_u32(esc.esc2, floor, props.limit) &&
+		   inrange_u32(esc.esc3, floor, props.limit) && inrange_u32(esc.esc4, floor, props.limit),
+		   "esc commands within range");
+}
+
+/**
+  * @brief fills the default configuration (default quad model, 417 Hz loop
+  * 	   like the lsm6dsox odr, datasheet-order sensor noise)
+  *
+  * @param  cfg		configuration buffer to be filled
+  * @retval None
+  */
+void sitl_default_config(sitl_config_t *cfg) {
+	memset(cfg, 0, sizeof(*cfg));
+	quad_default_params(&cfg->quad);
+	cfg->loop_hz = 417U;
+	cfg->physics_substeps = 8U;
+	cfg->gyro_noise_dps = 0.1f;
+	cfg->accel_noise_mg = 5.0f;
+	cfg->baro_noise_pa = 1.0f;
+	cfg->gps_pos_noise_m = 0.5f;
+	cfg->gps_vel_noise_mps = 0.05f;
+	cfg->gps_delay_ms = CONFIG_GPS_DELAY_MS;
+	cfg->mag_noise_mgauss = 3.0f;
+	cfg->batt_cells = 4U;
+	cfg->batt_capacity_mah = 1500.0f;
+	cfg->batt_resistance_ohm = 0.025f;
+	cfg->batt_noise_v = 0.02f;
+	cfg->seed = 1U;
+}
+
+/**
+  * @brief (re)initializes the simulator and the firmware modules in the same
+  * 	   order as main; parameter storage starts blank, so defaults apply
+  *
+  * @param  cfg		read-only pointer to configuration
+  * @retval sitl status
+  */
+sitl_status_t sitl_init(const sitl_config_t *cfg) {
+	if ((cfg->loop_hz == 0U) || (cfg->physics_substeps == 0U) || (cfg->batt_capacity_mah <= 0.0f))
+		return SITL_ERROR_FATAL;
+
+	config = *cfg;
+	rng_state = cfg->seed ? cfg->seed : 1U;
+	baro_rng_state = ~rng_state;
+	next_baro_s = 0.0;
+	gps_rng_state = rng_state * 2654435761U;
+	next_gps_s = 0.0;
+	gps_pos_err_m[0] = 0.0f;
+	gps_pos_err_m[1] = 0.0f;
+	mag_rng_state = rng_state * 2246822519U;
+	next_mag_s = 0.0;
+	batt_rng_state = rng_state * 3266489917U;
+	batt_current_a = SIM_BATT_IDLE_A;
+	batt_consumed_mah = 0.0f;
+	for (uint32_t i = 0; i < QUAD_MOTOR_COUNT; ++i) {
+		motor_current_a[i] = 0.0f;
+		esc_consumed_mah[i] = 0.0f;
+		esc_temperature_c[i] = SIM_ESC_AMBIENT_C;
+	}
+	gps_queue_head = 0U;
+	gps_queue_count = 0U;
+	loop_count = 0U;
+	violations = 0U;
+	violation = NULL;
+	violation_loop = 0U;
+	crash_latched = false;
+	crash_disarms = 0U;
+	memset(&flight_status, 0, sizeof(flight_status));
+	quad_reset(&quad);
+
+	/* Idle sticks, disarmed, angle mode */
+	sitl_set_rc(&(sitl_rc_t){.roll_us = 1500U, .pitch_us = 1500U, .throttle_us = 1000U, .yaw_us = 1500U,
+							 .arm = false, .mode = ANGLE_MODE});
+
+	ram_param_flash_format();
+	if (params_init() == PARAM_ERROR_FATAL)
+		return SITL_ERROR_FATAL;
+
+	flight_init(&flight);
+
+	if ((esc_init() != ESC_OK) || (esc_start() != ESC_OK))
+		return SITL_ERROR_FATAL;
+
+	if (esc_telemetry_init() != ESC_TLM_OK)
+		return SITL_ERROR_FATAL;
+
+	if ((rx_init() != RX_OK) || (rx_start() != RX_OK))
+		return SITL_ERROR_FATAL;
+
+	if (rc_init() != RC_REQ_OK)
+		return SITL_ERROR_FATAL;
+
+	if (imu_init() != IMU_OK)
+		return SITL_ERROR_FATAL;
+
+	if (baro_init() != BARO_OK)
+		return SITL_ERROR_FATAL;
+
+	if (gps_init() != GPS_OK)
+		return SITL_ERROR_FATAL;
+
+	if (mag_init() != MAG_OK)
+		return SITL_ERROR_FATAL;
+
+	if (battery_init() != BATTERY_OK)
+		return SITL_ERROR_FATAL;
+
+	mixer_init();
+	attitude_controller_init();
+	altitude_controller_init();
+
+	publish_imu_sample();
+	publish_baro_sample();
+	publish_gps_sample();
+	publish_mag_sample();
+	publish_battery_sample();
+
+	return SITL_OK;
+}
+
+/**
+  * @brief sets the stick/switch inputs seen by the receiver
+  * 	   NOTE: any mode but angle flips the two-position mode switch high,
+  * 	   which selects the RC_MODE_SW_HIGH parameter's mode
+  *
+  * @param  rc		read-only pointer to stick inputs
+  * @retval None
+  */
+void sitl_set_rc(const sitl_rc_t *rc) {
+	sim_rx_set_channel(SIM_CH_ROLL, rc->roll_us);
+	sim_rx_set_channel(SIM_CH_PITCH, rc->pitch_us);
+	sim_rx_set_channel(SIM_CH_THROTTLE, rc->throttle_us);
+	sim_rx_set_channel(SIM_CH_YAW, rc->yaw_us);
+	sim_rx_set_channel(SIM_CH_ARM, rc->arm ? SIM_SWITCH_HIGH : SIM_SWITCH_LOW);
+	sim_rx_set_channel(SIM_CH_MODE, (rc->mode == ANGLE_MODE) ? SIM_SWITCH_LOW : SIM_SWITCH_HIGH);
+}
+
+/**
+  * @brief runs flight loop iterations, each followed by the physics substeps
+  * 	   covering one loop period
+  *
+  * @param  loops	number of flight loop iterations
+  * @retval sitl status (WARN if any module reported a warning)
+  */
+sitl_status_t sitl_step(uint32_t loops) {
+	sitl_status_t status = SITL_OK;
+	const float dt = 1.0f / ((float) config.loop_hz * (float) config.physics_substeps);
+	float mcmd[QUAD_MOTOR_COUNT];
+	sitl_state_t snapshot;
+
+	for (uint32_t n = 0; n < loops; ++n) {
+		/* Crash latch kept as the firmware main loop does (crash_service) */
+		if (!rc_is_armed()) {
+			crash_latched = false;
+			esc_unlock();
+		}
+		flight.kill = crash_latched;
+
+		flight_update(&flight, &flight_status);
+
+		if ((flight_status.rc != RC_REQ_OK) || (flight_status.imu != IMU_OK) || (flight_status.baro != BARO_OK) ||
+			(flight_status.gps != GPS_OK) || (flight_status.mag != MAG_OK) || (flight_status.battery != BATTERY_OK) ||
+			(flight_status.position != POSITION_OK) || (flight_status.altitude != ALTITUDE_OK) ||
+			(flight_status.alt_hold != ALTITUDE_OK) || (flight_status.estimator != ATTITUDE_OK) ||
+			(flight_status.controller != ATTITUDE_OK) || (flight_status.esc != ESC_OK) ||
+			(flight_status.esc_tlm != ESC_TLM_OK))
+			status = SITL_ERROR_WARN;
+
+		check_invariants();
+		publish_esc_telemetry();
+
+		read_motor_commands(mcmd);
+		battery_draw(mcmd);
+		for (uint32_t i = 0; i < config.physics_substeps; ++i)
+			quad_step(&quad, &config.quad, mcmd, dt);
+
+		++loop_count;
+		publish_imu_sample();
+		publish_baro_sample();
+		publish_gps_sample();
+		publish_mag_sample();
+		publish_battery_sample();
+
+		if (trace.fp) {
+			sitl_get_state(&snapshot);
+			if (!trace_write(&trace, &snapshot))
+				status = SITL_ERROR_WARN;
+		}
+	}
+
+	return status;
+}
+
+/**
+  * @brief fetches a snapshot of the simulated and firmware state
+  *
+  * @param  out		state buffer to be filled
+  * @retval None
+  */
+void sitl_get_state(sitl_state_t *out) {
+	out->loops = loop_count;
+	out->time_s = (double) loop_count / (double) config.loop_hz;
+	out->quad = quad;
+	quad_euler_deg(&quad, &out->roll_deg, &out->pitch_deg, &out->yaw_deg);
+	out->flight = flight;
+	out->status = flight_status;
+	sim_esc_get_commands(&out->esc);
+	out->batt_ocv_v = battery_ocv();
+	out->batt_current_a = batt_current_a;
+	out->batt_consumed_mah = batt_consumed_mah;
+	for (uint32_t i = 0; i < QUAD_MOTOR_COUNT; ++i) {
+		out->motor_rpm[i] = motor_rpm(i);
+		out->motor_current_a[i] = motor_current_a[i];
+		out->esc_temperature_c[i] = esc_temperature_c[i];
+	}
+	out->crash_latched = crash_latched;
+	out->crash_disarms = crash_disarms;
+	out->violations = violations;
+	out->violation = violation;
+	out->violation_loop = violation_loop;
+}
+
+/**
+  * @brief crash isr as crash_irq_handler runs it on the target (its EXTI
+  * 	   line and imu programs are not simulated)
+  *
+  * @retval None
+  */
+static void crash_irq(void) {
+	if (esc_is_armed()) {
+		esc_lock();
+		crash_latched = true;
+		crash_disarms++;
+	}
+}
+
+/**
+  * @brief fires the crash isr inside the next motor command write: after the
+  * 	   flight loop checked its kill flag and the esc layer took the
+  * 	   commands, before they reach the motors
+  *
+  * @retval None
+  */
+void sitl_crash_irq_at_write(void) {
+	sim_esc_set_write_hook(crash_irq);
+}
+
+/**
+  * @brief gets the simulated time (flight loops run so far)
+  *
+  * @retval time since sitl_init (us)
+  */
+uint64_t sitl_time_us(void) {
+	return loop_count * 1000000U / config.loop_hz;
+}
+
+/**
+  * @brief gets the true horizontal position in the position estimator's frame
+  * 	   (north / east of its origin, the first fix it accepted)
+  *
+  * @param  state	read-only pointer to state snapshot
+  * @param	ne		north / east buffer to be filled (m)
+  *
+  * @retval None
+  */
+void sitl_true_position_ne(const sitl_state_t *state, float ne[2]) {
+	int32_t lat_e7, lon_e7;
+
+	world_to_gps(state->quad.pos_m, &lat_e7, &lon_e7);
+	position_gps_to_ne(&state->flight.pos, lat_e7, lon_e7, ne);
+}
+
+/**
+  * @brief sets a registry parameter by name (as listed by MSG_PARAM_DESC)
+  *
+  * @param  name		parameter name
+  * @param	value		new value
+  *
+  * @retval sitl status (FATAL if unknown, WARN if rejected)
+  */
+sitl_status_t sitl_set_param(const char *name, float value) {
+	for (uint32_t id = 0; id < PARAM_COUNT; ++id) {
+		if (strcmp(params_get_def((param_id_t) id)->name, name) != 0)
+			continue;
+
+		return (params_set((param_id_t) id, value) == PARAM_OK) ? SITL_OK : SITL_ERROR_WARN;
+	}
+
+	return SITL_ERROR_FATAL;
+}
+
+/**
+  * @brief starts tracing every flight loop to a file
+  *
+  * @param  path		output file path
+  * @param	format		csv or binary
+  *
+  * @retval sitl status
+  */
+sitl_status_t sitl_trace_open(const char *path, sitl_trace_format_t format) {
+	trace_close(&trace);
+
+	if (!trace_open(&trace, path, format))
+		return SITL_ERROR_FATAL;
+
+	return SITL_OK;
+}
+
+/**
+  * @brief stops tracing and closes the trace file
+  *
+  * @retval None
+  */
+void sitl_trace_close(void) {
+	trace_close(&trace);
+}
@@ -0,0 +1,650 @@
+/*
+ * tlm_main.c (live telemetry host test and throughput benchmark)
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "comms/telemetry.h"
+#include "comms/link.h"
+#include "comms/frame.h"
+#include "comms/messages.h"
+#include "common/cycles.h"
+#include "common/settings.h"
+#include "usbd_cdc_if.h"
+
+/*
+ * Runs comms/telemetry.c and comms/link.c unmodified against a fake CDC
+ * endpoint: CDC_Transmit_FS starts a transfer that completes after its bytes
+ * went over the bus (bulk bandwidth on a virtual clock), then the completion
+ * hook runs and the host decodes the frames. telemetry_service and
+ * link_service run once per flight loop, as in the firmware main loop. The
+ * flight data sources carry the loop index, so the host can tell which loop
+ * every sample was taken on.
+ *
+ * First packing, decimation and overflow accounting are checked (full
+ * batches, sequence gaps equal to the dropped count, acks still getting
+ * through a saturated link, a host that stops reading, a disconnect):
+ *
+ *   {"mode": "checks", "checks": 42, "failed": 0}
+ *
+ * then all six topics stream at the loop rate for ten seconds:
+ *
+ *   {"mode": "throughput", "loop_hz": 417, "usb_kb_per_s": 1000, "seconds": 10.0,
+ *    "samples_per_s": 2499.9, "dropped": 0, "wire_kb_per_s": 80.0,
+ *    "frames_per_s": 357.6, "transfers_per_s": 215.1, "bytes_per_sample": 32.76,
+ *    "unbatched_bytes_per_sample": 37.33, ...}
+ *
+ * unbatched_bytes_per_sample is one frame per sample (the per-topic messages
+ * before batching), and service_ns is the host time of telemetry_service plus
+ * link_service per loop.
+ *
+ * The exit status is 1 if any check fails or samples were dropped in the
+ * throughput run.
+ */
+
+/**
+  * @brief  Timing Model (microseconds)
+  */
+#define USB_BYTES_PER_US		1.0		// full speed bulk, ~1 MB/s after protocol overhead
+#define USB_TRANSFER_US			50.0	// token / handshake latency per transfer
+#define USB_PACKET_SIZE			64U
+
+#define THROUGHPUT_SECONDS		10.0
+#define ACK_LOOPS				40U		// ~10 Hz of command replies
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+/**
+  * @brief  Virtual Clock and Flight Loop
+  */
+static double now;
+static double loop_us;
+static uint32_t loop_index;
+static uint32_t base_loop;		// loop rate last changed
+static double base_us;
+
+/**
+  * @brief  Flight Data Sources (every field holds the loop index)
+  */
+static imu_6D_t imu;
+static attitude_est_t est;
+static rc_reqs_t req;
+static mtr_cmds_t mcmd;
+static battery_data_t batt;
+static esc_tlm_data_t esc_tlm;
+
+/**
+  * @brief  USB Device and CDC Endpoint (device side)
+  */
+USBD_HandleTypeDef hUsbDeviceFS;
+
+static struct {
+	double bytes_per_us;
+	bool busy;
+	const uint8_t *buf;
+	uint32_t len;
+	double done_at;
+	double paused_until;		// host not reading (transfer held)
+	double refused_until;		// class busy (transmit refused)
+	double busy_us;
+	uint32_t transfers;
+	uint32_t packets;
+	uint32_t busy_returns;
+	uint32_t len_max;
+	uint64_t bytes;
+} usb;
+
+/**
+  * @brief  Host Side (decoded frames, per topic sequence and loop tracking)
+  */
+static frame_decoder_t dec;
+
+static struct {
+	uint32_t frames;
+	uint32_t crc_errors;
+	uint32_t acks;
+	uint32_t batches[TELEMETRY_TOPIC_COUNT];
+	uint32_t samples[TELEMETRY_TOPIC_COUNT];
+	uint32_t gaps[TELEMETRY_TOPIC_COUNT];			// samples missing per sequence numbers
+	uint32_t next_seq[TELEMETRY_TOPIC_COUNT];
+	bool seq_valid[TELEMETRY_TOPIC_COUNT];
+	int64_t last_loop[TELEMETRY_TOPIC_COUNT];
+	uint32_t spacing_min[TELEMETRY_TOPIC_COUNT];	// loops between samples
+	uint32_t spacing_max[TELEMETRY_TOPIC_COUNT];
+	uint32_t count_max[TELEMETRY_TOPIC_COUNT];		// samples in one batch
+	double latency_max_us;							// sample loop -> host decoded
+	uint32_t bad_samples;
+} host;
+
+static unsigned checks;
+static unsigned failures;
+
+static const uint8_t sample_ids[TELEMETRY_TOPIC_COUNT] = {
+	MSG_TLM_IMU, MSG_TLM_ATTITUDE, MSG_TLM_RC, MSG_TLM_MOTORS, MSG_TLM_BATTERY, MSG_TLM_ESC
+};
+static const uint8_t sample_sizes[TELEMETRY_TOPIC_COUNT] = {
+	sizeof(msg_tlm_imu_t), sizeof(msg_tlm_attitude_t), sizeof(msg_tlm_rc_t), sizeof(msg_tlm_motors_t),
+	sizeof(msg_tlm_battery_t), sizeof(msg_tlm_esc_t)
+};
+
+
+/**
+  * @brief firmware clock on the virtual clock
+  */
+uint32_t millis(void) {
+	return (uint32_t) (now / 1000.0);
+}
+
+uint64_t micros(void) {
+	return (uint64_t) now;
+}
+
+/**
+  * @brief command dispatch (the host sends no commands here)
+  */
+void command_handle(const frame_t *frame) {
+	(void) frame;
+}
+
+/**
+  * @brief CDC transmit: one transfer at a time, done once its bytes went
+  * 	   over the bus
+  */
+uint8_t CDC_Transmit_FS(uint8_t *Buf, uint16_t Len) {
+	if (usb.busy || (now < usb.refused_until)) {
+		usb.busy_returns++;
+		return USBD_BUSY;
+	}
+
+	usb.busy = true;
+	usb.buf = Buf;
+	usb.len = Len;
+	usb.done_at = now + USB_TRANSFER_US + Len / usb.bytes_per_us;
+
+	return USBD_OK;
+}
+
+static void check(bool cond, const char *what, int line) {
+	checks++;
+
+	if (!cond) {
+		failures++;
+		fprintf(stderr, "tlm_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+/**
+  * @brief sets the flight loop rate from the current loop on
+  */
+static void set_loop_rate(double hz) {
+	base_loop = loop_index;
+	base_us = now;
+	loop_us = 1.0e6 / hz;
+}
+
+/**
+  * @brief virtual time of a flight loop
+  */
+static double loop_time(int64_t loop) {
+	return base_us + (double) (loop - (int64_t) base_loop) * loop_us;
+}
+
+/**
+  * @brief loop index a sample was taken on (every source field holds it)
+  */
+static int64_t sample_loop(uint8_t topic, const uint8_t *sample) {
+	switch (topic) {
+		case TELEMETRY_TOPIC_IMU: {
+			msg_tlm_imu_t s;
+			memcpy(&s, sample, sizeof(s));
+			return (s.accel_mg[0] == s.rate_mdps[2]) ? (int64_t) s.accel_mg[0] : -1;
+		}
+
+		case TELEMETRY_TOPIC_ATTITUDE: {
+			msg_tlm_attitude_t s;
+			memcpy(&s, sample, sizeof(s));
+			return (s.roll_deg == s.yaw_rate_dps) ? (int64_t) s.roll_deg : -1;
+		}
+
+		case TELEMETRY_TOPIC_RC: {
+			msg_tlm_rc_t s;
+			memcpy(&s, sample, sizeof(s));
+			return (s.roll_deg == s.throttle_pct) ? (int64_t) s.roll_deg : -1;
+		}
+
+		case TELEMETRY_TOPIC_MOTORS: {
+			msg_tlm_motors_t s;
+			memcpy(&s, sample, sizeof(s));
+			return (s.mtr[0] == s.mtr[3]) ? (int64_t) s.mtr[0] : -1;
+		}
+
+		case TELEMETRY_TOPIC_BATTERY: {
+			msg_tlm_battery_t s;
+			memcpy(&s, sample, sizeof(s));
+			return (s.voltage_v == s.energy_wh) ? (int64_t) s.voltage_v : -1;
+		}
+
+		default: {
+			msg_tlm_esc_t s;
+			memcpy(&s, sample, sizeof(s));
+			return (s.rpm[0] == s.current_a[3]) ? (int64_t) s.rpm[0] : -1;
+		}
+	}
+}
+
+/**
+  * @brief host: checks one batch (layout, sequence, sample loops and times)
+  */
+static void host_batch(const frame_t *frame) {
+	msg_tlm_batch_t hdr;
+	uint8_t topic;
+
+	if (frame->len < sizeof(hdr)) {
+		host.bad_samples++;
+		return;
+	}
+
+	memcpy(&hdr, frame->payload, sizeof(hdr));
+
+	for (topic = 0; (topic < TELEMETRY_TOPIC_COUNT) && (sample_ids[topic] != hdr.msg_id); ++topic);
+	if ((topic == TELEMETRY_TOPIC_COUNT) || !hdr.count ||
+		(frame->len != sizeof(hdr) + (uint32_t) hdr.count * sample_sizes[topic])) {
+		host.bad_samples++;
+		return;
+	}
+
+	if (host.seq_valid[topic])
+		host.gaps[topic] += (uint16_t) (hdr.seq - host.next_seq[topic]);
+	host.next_seq[topic] = (uint16_t) (hdr.seq + hdr.count);
+	host.seq_valid[topic] = true;
+
+	host.batches[topic]++;
+	if (hdr.count > host.count_max[topic])
+		host.count_max[topic] = hdr.count;
+
+	for (uint32_t i = 0; i < hdr.count; ++i) {
+		const uint8_t *sample = &frame->payload[sizeof(hdr) + i * sample_sizes[topic]];
+		int64_t loop = sample_loop(topic, sample);
+		uint32_t timestamp_ms;
+		uint32_t spacing;
+
+		memcpy(&timestamp_ms, sample, sizeof(timestamp_ms));
+
+		/* Taken on a past loop, in order, stamped with that loop's time */
+		if ((loop < 0) || (loop <= host.last_loop[topic]) || (loop > (int64_t) loop_index) ||
+			(timestamp_ms != (uint32_t) (loop_time(loop) / 1000.0))) {
+			host.bad_samples++;
+			continue;
+		}
+
+		if (host.last_loop[topic] >= 0) {
+			spacing = (uint32_t) (loop - host.last_loop[topic]);
+			if (spacing < host.spacing_min[topic])
+				host.spacing_min[topic] = spacing;
+			if (spacing > host.spacing_max[topic])
+				host.spacing_max[topic] = spacing;
+		}
+
+		if ((now - loop_time(loop)) > host.latency_max_us)
+			host.latency_max_us = now - loop_time(loop);
+
+		host.last_loop[topic] = loop;
+		host.samples[topic]++;
+	}
+}
+
+/**
+  * @brief host: resets the decoder and all per topic tracking
+  */
+static void host_reset(void) {
+	memset(&host, 0, sizeof(host));
+	frame_decoder_reset(&dec);
+
+	for (uint32_t t = 0; t < TELEMETRY_TOPIC_COUNT; ++t) {
+		host.last_loop[t] = -1;
+		host.spacing_min[t] = UINT32_MAX;
+	}
+}
+
+/**
+  * @brief usb: completes the transfer in flight once due (and the host reads)
+  */
+static void usb_poll(void) {
+	frame_t frame;
+
+	if (!usb.busy || (now < usb.done_at) || (now < usb.paused_until))
+		return;
+
+	for (uint32_t i = 0; i < usb.len; ++i) {
+		switch (frame_decoder_push(&dec, usb.buf[i], &frame)) {
+			case FRAME_OK:
+				host.frames++;
+				if (frame.msg_id == MSG_TLM_BATCH)
+					host_batch(&frame);
+				else if (frame.msg_id == MSG_ACK)
+					host.acks++;
+				break;
+
+			case FRAME_INCOMPLETE:
+				break;
+
+			default:
+				host.crc_errors++;
+				break;
+		}
+	}
+
+	usb.busy_us += USB_TRANSFER_US + usb.len / usb.bytes_per_us;
+	usb.bytes += usb.len;
+	usb.packets += (usb.len + USB_PACKET_SIZE - 1U) / USB_PACKET_SIZE;
+	usb.transfers++;
+	if (usb.len > usb.len_max)
+		usb.len_max = usb.len;
+	usb.busy = false;
+
+	link_transmit_complete_isr();
+}
+
+/**
+  * @brief sets the usb device state (a disconnect aborts the transfer in flight)
+  */
+static void usb_connect(bool connected) {
+	hUsbDeviceFS.dev_state = connected ? USBD_STATE_CONFIGURED : USBD_STATE_DEFAULT;
+
+	if (!connected) {
+		usb.busy = false;
+		frame_decoder_reset(&dec);
+	}
+}
+
+/**
+  * @brief runs flight loops for a time span
+  *
+  * @param  seconds		span
+  * @param	service_ns	accumulated host time of the two services (or NULL)
+  * @param	service_max	longest single loop (or NULL)
+  * @param	ack			queue a MSG_ACK every ACK_LOOPS loops next to telemetry
+  *
+  * @retval acks the link refused
+  */
+static uint32_t run(double seconds, double *service_ns, uint32_t *service_max, bool ack) {
+	double end = now + seconds * 1.0e6;
+	uint32_t refused = 0U;
+	uint32_t start, elapsed;
+
+	while (now < end) {
+		loop_index++;
+		now = loop_time(loop_index);
+
+		/* Completions that happened during the last loop period */
+		usb_poll();
+
+		imu.accel_x = imu.rate_z = (float) loop_index;
+		est.roll_angle_deg = est.yaw_rate_dps = (float) loop_index;
+		req.roll_angle = req.throttle = (float) loop_index;
+		mcmd.mtr1 = mcmd.mtr4 = (float) loop_index;
+		batt.voltage_v = batt.energy_wh = (float) loop_index;
+		esc_tlm.motor[0].rpm = esc_tlm.motor[3].current_a = (float) loop_index;
+
+		start = cycles_now();
+		telemetry_service();
+		if (ack && !(loop_index % ACK_LOOPS) && (link_send(MSG_ACK, &(msg_ack_t){MSG_PING, ACK_OK}, sizeof(msg_ack_t)) != LINK_OK))
+			refused++;
+		link_service();
+		elapsed = cycles_now() - start;
+
+		if (service_ns)
+			*service_ns += elapsed;
+		if (service_max && (elapsed > *service_max))
+			*service_max = elapsed;
+	}
+
+	return refused;
+}
+
+/**
+  * @brief lets the link drain (streams stopped)
+  */
+static void drain(void) {
+	run(0.5, NULL, NULL, false);
+}
+
+/**
+  * @brief starts one stream on a fresh link and host
+  */
+static void restart(void) {
+	telemetry_stop_all();
+	link_init();
+	usb_connect(true);
+	usb.busy = false;
+	usb.paused_until = 0.0;
+	usb.refused_until = 0.0;
+	usb.len_max = 0U;
+	usb.bytes_per_us = USB_BYTES_PER_US;
+	host_reset();
+}
+
+static uint32_t total(const uint32_t *per_topic) {
+	uint32_t sum = 0U;
+
+	for (uint32_t t = 0; t < TELEMETRY_TOPIC_COUNT; ++t)
+		sum += per_topic[t];
+
+	return sum;
+}
+
+/**
+  * @brief packing, decimation and overflow accounting checks
+  */
+static void run_checks(void) {
+	telemetry_stats_t st[TELEMETRY_TOPIC_COUNT];
+	uint32_t loops, refused, dropped, busy_returns;
+	link_stats_t ls;
+
+	/* Packing: every loop sampled, full batches, nothing lost */
+	restart();
+	CHECK(telemetry_set_rate(TELEMETRY_TOPIC_IMU, 417U));
+	loops = loop_index;
+	run(2.0, NULL, NULL, false);
+	loops = loop_index - loops;
+	telemetry_get_stats(TELEMETRY_TOPIC_IMU, &st[0]);
+	CHECK(!st[0].dropped && (st[0].samples == host.samples[0]) && (st[0].batches == host.batches[0]));
+	CHECK(host.samples[0] + 7U >= loops);
+	CHECK((host.spacing_min[0] == 1U) && (host.spacing_max[0] == 1U));
+	CHECK(host.count_max[0] == (FRAME_PAYLOAD_MAX - sizeof(msg_tlm_batch_t)) / sizeof(msg_tlm_imu_t));
+	CHECK(host.samples[0] == host.batches[0] * host.count_max[0]);
+	CHECK(!host.gaps[0] && !host.bad_samples && !host.crc_errors);
+
+	/* Decimation: 100 Hz off a 417 Hz loop takes every 4th or 5th loop */
+	restart();
+	CHECK(telemetry_set_rate(TELEMETRY_TOPIC_ATTITUDE, 100U));
+	run(2.0, NULL, NULL, false);
+	CHECK((host.samples[1] >= 197U) && (host.samples[1] <= 201U));
+	CHECK((host.spacing_min[1] == 4U) && (host.spacing_max[1] == 5U));
+
+	/* Above the loop rate: one sample per loop, no bursts */
+	restart();
+	CHECK(telemetry_set_rate(TELEMETRY_TOPIC_MOTORS, 500U));
+	run(1.0, NULL, NULL, false);
+	CHECK((host.spacing_min[3] == 1U) && (host.spacing_max[3] == 1U));
+
+	/* Low rate: single-sample batches sent once CONFIG_TELEMETRY_BATCH_MS old */
+	restart();
+	CHECK(telemetry_set_rate(TELEMETRY_TOPIC_RC, 10U));
+	run(2.0, NULL, NULL, false);
+	CHECK((host.samples[2] >= 19U) && (host.count_max[2] == 1U));
+	CHECK(host.latency_max_us < (CONFIG_TELEMETRY_BATCH_MS * 1000.0) + 3.0 * loop_us);
+
+	/* Invalid rates and topics refused; stop ends the stream */
+	CHECK(!telemetry_set_rate(TELEMETRY_TOPIC_COUNT, 10U));
+	CHECK(!telemetry_set_rate(TELEMETRY_TOPIC_RC, CONFIG_TELEMETRY_RATE_MAX_HZ + 1U));
+	CHECK(telemetry_set_rate(TELEMETRY_TOPIC_RC, 0U));
+	drain();
+	dropped = host.samples[2];
+	run(0.5, NULL, NULL, false);
+	CHECK(host.samples[2] == dropped);
+
+	/* Host stops reading for 60 ms, then the class refuses transmits
+	 * (USBD_BUSY) for 60 ms: batches wait in the ring, then leave coalesced
+	 * in one transfer */
+	restart();
+	CHECK(telemetry_set_rate(TELEMETRY_TOPIC_IMU, 417U));
+	run(0.5, NULL, NULL, false);
+	usb.paused_until = now + 60000.0;
+	run(0.5, NULL, NULL, false);
+	CHECK(usb.len_max > 2U * FRAME_ENCODED_MAX);
+	usb.len_max = 0U;
+	usb.refused_until = now + 60000.0;
+	busy_returns = usb.busy_returns;
+	run(0.5, NULL, NULL, false);
+	CHECK((usb.busy_returns > busy_returns) && (usb.len_max > 2U * FRAME_ENCODED_MAX));
+	telemetry_get_stats(TELEMETRY_TOPIC_IMU, &st[0]);
+	CHECK(!st[0].dropped && !host.gaps[0] && !host.bad_samples);
+
+	/* Slow host, all topics at max: drops counted per topic, matching the
+	 * sequence gaps, the link itself never refuses, acks still get through */
+	restart();
+	usb.bytes_per_us = 0.008;
+	for (uint32_t t = 0; t < TELEMETRY_TOPIC_COUNT; ++t)
+		CHECK(telemetry_set_rate((telemetry_topic_t) t, CONFIG_TELEMETRY_RATE_MAX_HZ));
+	refused = run(2.0, NULL, NULL, true);
+	usb.bytes_per_us = USB_BYTES_PER_US;
+	refused += run(1.0, NULL, NULL, true);
+	for (uint32_t t = 0; t < TELEMETRY_TOPIC_COUNT; ++t)
+		telemetry_get_stats((telemetry_topic_t) t, &st[t]);
+	telemetry_stop_all();
+	drain();
+	link_get_stats(&ls);
+	CHECK(st[0].dropped && st[1].dropped && st[2].dropped && st[3].dropped && st[4].dropped && st[5].dropped);
+	for (uint32_t t = 0; t < TELEMETRY_TOPIC_COUNT; ++t) {
+		CHECK(!host.seq_valid[t] || (host.gaps[t] == st[t].dropped));
+	}
+	CHECK(!refused && !ls.tx_dropped && (host.acks == ls.tx_frames - total(host.batches)));
+	CHECK(!host.bad_samples && !host.crc_errors);
+
+	/* Disconnect: samples dropped while no host, stream resumes in sequence */
+	restart();
+	CHECK(telemetry_set_rate(TELEMETRY_TOPIC_IMU, 417U));
+	run(0.5, NULL, NULL, false);
+	usb_connect(false);
+	dropped = host.frames;
+	run(0.2, NULL, NULL, false);
+	CHECK(host.frames == dropped);
+	telemetry_get_stats(TELEMETRY_TOPIC_IMU, &st[0]);
+	CHECK(st[0].dropped >= 80U);
+	usb_connect(true);
+	host.seq_valid[0] = false;
+	dropped = host.samples[0];
+	run(0.5, NULL, NULL, false);
+	CHECK((host.samples[0] - dropped > 190U) && !host.gaps[0] && !host.bad_samples);
+
+	telemetry_stop_all();
+
+	printf("{\"mode\": \"checks\", \"checks\": %u, \"failed\": %u}\n", checks, failures);
+}
+
+/**
+  * @brief all topics at the loop rate over a full-speed host
+  *
+  * @param	usb_kb_per_s	bulk bandwidth
+  * @retval boolean (nothing dropped)
+  */
+static bool run_throughput(double usb_kb_per_s) {
+	uint8_t ring[512];
+	uint8_t payload[FRAME_PAYLOAD_MAX] = {0};
+	telemetry_stats_t st;
+	double service_ns = 0.0, start, seconds, unbatched = 0.0;
+	uint32_t service_max = 0U, loops, samples = 0U, dropped = 0U, frames;
+	uint64_t bytes;
+
+	restart();
+	usb.bytes_per_us = usb_kb_per_s * 1024.0 / 1.0e6;
+	usb.busy_returns = 0U;
+	usb.transfers = 0U;
+	usb.packets = 0U;
+	usb.busy_us = 0.0;
+
+	for (uint32_t t = 0; t < TELEMETRY_TOPIC_COUNT; ++t) {
+		(void) telemetry_set_rate((telemetry_topic_t) t, CONFIG_TELEMETRY_RATE_MAX_HZ);
+		unbatched += frame_encode(ring, sizeof(ring) - 1U, 0U, sample_ids[t], 0U, payload, sample_sizes[t]);
+	}
+
+	start = now;
+	loops = loop_index;
+	bytes = usb.bytes;
+	run(THROUGHPUT_SECONDS, &service_ns, &service_max, false);
+	seconds = (now - start) * 1.0e-6;
+	loops = loop_index - loops;
+	bytes = usb.bytes - bytes;
+
+	for (uint32_t t = 0; t < TELEMETRY_TOPIC_COUNT; ++t) {
+		telemetry_get_stats((telemetry_topic_t) t, &st);
+		samples += st.samples;
+		dropped += st.dropped;
+	}
+	frames = host.frames;
+
+	printf("{\"mode\": \"throughput\", \"loop_hz\": %.0f, \"usb_kb_per_s\": %.0f, \"seconds\": %.1f, "
+		   "\"samples_per_s\": %.1f, \"dropped\": %u, \"wire_kb_per_s\": %.1f, \"frames_per_s\": %.1f, "
+		   "\"transfers_per_s\": %.1f, \"bytes_per_sample\": %.2f, \"unbatched_bytes_per_sample\": %.2f, "
+		   "\"samples_per_packet\": %.2f, \"usb_busy\": %.2f, \"cdc_busy_returns\": %u, "
+		   "\"service_ns_avg\": %.0f, \"service_ns_max\": %u}\n",
+		   1.0e6 / loop_us, usb_kb_per_s, seconds, samples / seconds, dropped,
+		   (double) bytes / 1024.0 / seconds, frames / seconds, usb.transfers / seconds,
+		   (double) bytes / samples, unbatched / TELEMETRY_TOPIC_COUNT, (double) samples / usb.packets,
+		   usb.busy_us / (now - start), usb.busy_returns, service_ns / loops, service_max);
+
+	telemetry_stop_all();
+
+	return !dropped && !host.bad_samples && !host.crc_errors;
+}
+
+static void usage(const char *argv0) {
+	fprintf(stderr,
+			"usage: %s [-l loop_hz] [-u usb_kb_per_s]\n"
+			"  -l   flight loop rate the services run at (default 417 Hz)\n"
+			"  -u   bulk bandwidth of the throughput run (default 1000 KB/s)\n",
+			argv0);
+}
+
+int main(int argc, char **argv) {
+	double loop_hz = 417.0;
+	double usb_kb_per_s = 1000.0;
+	bool ok;
+
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "-l") && (i + 1 < argc))
+			loop_hz = strtod(argv[++i], NULL);
+		else if (!strcmp(argv[i], "-u") && (i + 1 < argc))
+			usb_kb_per_s = strtod(argv[++i], NULL);
+		else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+
+	if ((loop_hz < 50.0) || (loop_hz > 10000.0) || (usb_kb_per_s <= 0.0)) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	cycles_init();
+	hUsbDeviceFS.pClassData = &usb;
+	telemetry_init(&(telemetry_sources_t){.imu = &imu, .est = &est, .req = &req, .mcmd = &mcmd, .batt = &batt,
+										  .esc_tlm = &esc_tlm});
+
+	/* The checks assume the 417 Hz flight loop */
+	set_loop_rate(417.0);
+	run_checks();
+	ok = !failures;
+
+	set_loop_rate(loop_hz);
+	ok &= run_throughput(usb_kb_per_s);
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+/*
+ * trace.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: charlieroman
+ */
+
+#include <string.h>
+#include "trace.h"
+#include "comms/frame.h"
+#include "comms/messages.h"
+#include "esc/esc.h"
+
+/**
+  * @brief  Trace Field Names (trace_record_t order)
+  */
+static const char *const field_names[] = {
+	"time_s", "phase",
+	"pos_x_m", "pos_y_m", "pos_z_m",
+	"vel_x_mps", "vel_y_mps", "vel_z_mps",
+	"roll_deg", "pitch_deg", "yaw_deg",
+	"rate_x_dps", "rate_y_dps", "rate_z_dps",
+	"est_roll_deg", "est_pitch_deg",
+	"est_rate_x_dps", "est_rate_y_dps", "est_rate_z_dps",
+	"req_roll_deg", "req_pitch_deg", "req_yaw_dps", "req_throttle_pct",
+	"cmd_roll", "cmd_pitch", "cmd_yaw",
+	"esc1", "esc2", "esc3", "esc4",
+	"motor1", "motor2", "motor3", "motor4",
+	"alt_est_m", "climb_est_mps", "alt_target_m", "throttle_pct"
+};
+
+#define TRACE_FIELD_COUNT	(sizeof(field_names) / sizeof(field_names[0]))
+
+_Static_assert(sizeof(trace_record_t) == TRACE_FIELD_COUNT * sizeof(float), "trace field names out of sync with record");
+
+
+/**
+  * @brief helper function to write the binary header
+  *
+  * @retval boolean
+  */
+static bool write_binary_header(FILE *fp) {
+	const uint16_t meta[2] = {TRACE_VERSION, (uint16_t) TRACE_FIELD_COUNT};
+
+	if (fwrite("AQCT", 1, 4, fp) != 4)
+		return false;
+
+	if (fwrite(meta, sizeof(meta), 1, fp) != 1)
+		return false;
+
+	for (size_t i = 0; i < TRACE_FIELD_COUNT; ++i) {
+		if (fprintf(fp, "%s%c", field_names[i], (i + 1 < TRACE_FIELD_COUNT) ? '\n' : '\0') < 0)
+			return false;
+	}
+
+	return true;
+}
+
+/**
+  * @brief opens a trace file and writes its header
+  *
+  * @param  t		trace handle
+  * @param	path	output file path
+  * @param	format	csv or binary
+  *
+  * @retval boolean
+  */
+bool trace_open(trace_t *t, const char *path, sitl_trace_format_t format) {
+	t->fp = fopen(path, (format == SITL_TRACE_CSV) ? "w" : "wb");
+	t->format = format;
+	t->seq = 0U;
+
+	if (!t->fp)
+		return false;
+
+	if (format == SITL_TRACE_BINARY)
+		return write_binary_header(t->fp);
+
+	if (format == SITL_TRACE_LINK)
+		return true;
+
+	for (size_t i = 0; i < TRACE_FIELD_COUNT; ++i)
+		fprintf(t->fp, "%s%c", field_names[i], (i + 1 < TRACE_FIELD_COUNT) ? ',' : '\n');
+
+	return true;
+}
+
+/**
+  * @brief helper function to fill a trace record from a state snapshot
+  *
+  * @retval None
+  */
+static void trace_fill(trace_record_t *rec, const sitl_state_t *state) {
+	const float r2d = 180.0f / 3.14159265f;
+	const flight_data_t *fd = &state->flight;
+
+	rec->time_s = (float) state->time_s;
+	rec->phase = (float) state->status.phase;
+
+	for (uint32_t i = 0; i < 3U; ++i) {
+		rec->pos_m[i] = state->quad.pos_m[i];
+		rec->vel_mps[i] = state->quad.vel_mps[i];
+		rec->rate_dps[i] = state->quad.rate_rps[i] * r2d;
+	}
+
+	rec->roll_deg = state->roll_deg;
+	rec->pitch_deg = state->pitch_deg;
+	rec->yaw_deg = state->yaw_deg;
+
+	rec->est_roll_deg = fd->est.roll_angle_deg;
+	rec->est_pitch_deg = fd->est.pitch_angle_deg;
+	rec->est_rate_dps[0] = fd->est.roll_rate_dps;
+	rec->est_rate_dps[1] = fd->est.pitch_rate_dps;
+	rec->est_rate_dps[2] = fd->est.yaw_rate_dps;
+
+	rec->req_roll_deg = fd->req.roll_angle;
+	rec->req_pitch_deg = fd->req.pitch_angle;
+	rec->req_yaw_dps = fd->req.yaw_rate;
+	rec->req_throttle_pct = fd->req.throttle;
+
+	rec->cmd_roll = fd->cmd.roll;
+	rec->cmd_pitch = fd->cmd.pitch;
+	rec->cmd_yaw = fd->cmd.yaw;
+
+	rec->esc[0] = (float) state->esc.esc1;
+	rec->esc[1] = (float) state->esc.esc2;
+	rec->esc[2] = (float) state->esc.esc3;
+	rec->esc[3] = (float) state->esc.esc4;
+
+	for (uint32_t i = 0; i < QUAD_MOTOR_COUNT; ++i)
+		rec->motor[i] = state->quad.motor[i];
+
+	rec->alt_est_m = fd->alt.altitude_m;
+	rec->climb_est_mps = fd->alt.climb_rate_mps;
+	rec->alt_target_m = fd->alt_cmd.engaged ? fd->alt_cmd.target_alt_m : fd->alt.altitude_m;
+	rec->throttle_pct = fd->alt_cmd.throttle;
+}
+
+/**
+  * @brief helper function to append one encoded frame
+  *
+  * @retval boolean
+  */
+static bool write_frame(trace_t *t, uint8_t msg_id, const void *payload, uint16_t len) {
+	uint8_t buf[FRAME_ENCODED_MAX];
+	size_t n = frame_encode(buf, UINT32_MAX, 0U, msg_id, t->seq++, payload, len);
+
+	return (n != 0U) && (fwrite(buf, 1, n, t->fp) == n);
+}
+
+/**
+  * @brief helper function to append the telemetry frames of one flight loop
+  *
+  * @retval boolean
+  */
+static bool write_link_frames(trace_t *t, const sitl_state_t *state) {
+	const flight_data_t *fd = &state->flight;
+	const uint32_t now = (uint32_t) (state->time_s * 1000.0);
+
+	const msg_tlm_imu_t imu = {
+		.timestamp_ms = now,
+		.accel_mg = {fd->imu.accel_x, fd->imu.accel_y, fd->imu.accel_z},
+		.rate_mdps = {fd->imu.rate_x, fd->imu.rate_y, fd->imu.rate_z},
+		.dt = fd->imu.dt
+	};
+	const msg_tlm_attitude_t att = {
+		.timestamp_ms = now,
+		.roll_deg = fd->est.roll_angle_deg,
+		.pitch_deg = fd->est.pitch_angle_deg,
+		.roll_rate_dps = fd->est.roll_rate_dps,
+		.pitch_rate_dps = fd->est.pitch_rate_dps,
+		.yaw_rate_dps = fd->est.yaw_rate_dps
+	};
+	const msg_tlm_rc_t rc = {
+		.timestamp_ms = now,
+		.roll_deg = fd->req.roll_angle,
+		.pitch_deg = fd->req.pitch_angle,
+		.roll_rate_dps = fd->req.roll_rate,
+		.pitch_rate_dps = fd->req.pitch_rate,
+		.yaw_rate_dps = fd->req.yaw_rate,
+		.throttle_pct = fd->req.throttle,
+		.mode = (uint8_t) rc_get_flight_mode(),
+		.armed = esc_is_armed() ? 1U : 0U
+	};
+	const msg_tlm_motors_t mtr = {
+		.timestamp_ms = now,
+		.mtr = {fd->mcmd.mtr1, fd->mcmd.mtr2, fd->mcmd.mtr3, fd->mcmd.mtr4}
+	};
+
+	return write_frame(t, MSG_TLM_IMU, &imu, sizeof(imu)) &&
+		   write_frame(t, MSG_TLM_ATTITUDE, &att, sizeof(att)) &&
+		   write_frame(t, MSG_TLM_RC, &rc, sizeof(rc)) &&
+		   write_frame(t, MSG_TLM_MOTORS, &mtr, sizeof(mtr));
+}
+
+/**
+  * @brief appends one flight loop to the trace
+  *
+  * @param  t		trace handle
+  * @param	state	read-only pointer to state snapshot
+  *
+  * @retval boolean
+  */
+bool trace_write(trace_t *t, const sitl_state_t *state) {
+	trace_record_t rec;
+	const float *f = (const float*) &rec;
+
+	if (!t->fp)
+		return false;
+
+	if (t->format == SITL_TRACE_LINK)
+		return write_link_frames(t, state);
+
+	trace_fill(&rec, state);
+
+	if (t->format == SITL_TRACE_BINARY)
+		return fwrite(&rec, sizeof(rec), 1, t->fp) == 1;
+
+	for (size_t i = 0; i < TRACE_FIELD_COUNT; ++i)
+		fprintf(t->fp, "%.6g%c", (double) f[i], (i + 1 < TRACE_FIELD_COUNT) ? ',' : '\n');
+
+	return !ferror(t->fp);
+}
+
+/**
+  * @brief flushes and closes the trace file
+  *
+  * @param  t		trace handle
+  * @retval None
+  */
+void trace_close(trace_t *t) {
+	if (t->fp)
+		fclose(t->fp);
+
+	t->fp = NULL;
+}
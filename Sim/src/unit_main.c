@@ -0,0 +1,771 @@
+/*
+ * unit_main.c (flight kernel unit sweeps)
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: charlieroman
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flight/pid.h"
+#include "flight/mixer.h"
+#include "flight/rc_input.h"
+#include "esc/esc.h"
+#include "rx/rx.h"
+#include "rx/protocols/sim_rx.h"
+#include "sensors/imu/devices/lsm6dsox.h"
+#include "lsm6dsox_reg.h"
+#include "params/params.h"
+#include "common/maths.h"
+#include "common/hardware.h"
+#include "system/driver_registry.h"
+#include "sim_hw.h"
+#include "hal_mock.h"
+
+/*
+ * Sweeps the flight kernels one by one, below what a flight exercises: the
+ * SITL scenarios stay the net for how they work together, these go after
+ * the inputs a flight never produces. Every sweep draws random, extreme
+ * (+-FLT_MAX, +-inf, denormals) and NaN inputs, and the raw bit patterns of
+ * random floats:
+ *
+ * - common/maths.h: the clamps, range tests, map, average, sign and min /
+ *   max helpers, including the u32 clamp at the ends of its range
+ * - flight/pid.c: the output stays finite and inside its limit and the
+ *   integrator inside its own, a non-finite input or timestep holds the
+ *   controller (a twin fed only the finite steps ends in the same state),
+ *   a saturating error winds nothing up, bad gains / limits / cutoffs leave
+ *   it finite, and a resync or a reconfigure kicks nothing
+ * - flight/mixer.c: the motor commands split back into throttle, roll, pitch
+ *   and yaw, and 0 % / 100 % throttle land on idle / the throttle ceiling
+ * - esc/esc.c on esc/protocols/pwm_esc.c, the only ESC driver linked in,
+ *   against the timers of src/hal_mock.c: commands in range reach their
+ *   compare register (ESC1 TIM4 CH4, ESC2 TIM4 CH3, ESC3 TIM8 CH1, ESC4 TIM8
+ *   CH2) as they are; below idle, negative and NaN ones are sanitized to
+ *   idle, above the limit and infinite ones to the limit, with a warning;
+ *   init refuses mismatched or unusable timers, and start a failing channel
+ * - the chain: random attitude errors through the rate PIDs, the mixer and
+ *   the ESC never put a register outside idle..limit
+ * - flight/rc_input.c on the sim rx: random and extreme pulse widths keep
+ *   every request inside its RC_*_MAX limit and the throttle inside 0..100 %;
+ *   a pulse outside the valid range is rejected (warning, stick neutral,
+ *   throttle low), one inside it but past the pulse span is clamped to its
+ *   end; a changed span applies; the mode switch maps low to angle, high to
+ *   RC_MODE_SW_HIGH and anything else to invalid, the arm switch only high
+ * - sensors/imu/devices/lsm6dsox.c on the i2c bus of src/hal_mock.c: init
+ *   over the HAL reads the id, resets and configures the sensor at its
+ *   address, and refuses a wrong id or an address with nothing there
+ *
+ *   {"mode": "checks", "checks": 77, "failed": 0}
+ *
+ * The exit status is 1 if any check fails.
+ */
+
+#define SWEEP_SAMPLES			200000U
+#define PID_DT_S				0.001f
+
+#undef CHECK		// system/error.h fatal check; the checks here are counted
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+static unsigned checks;
+static unsigned failures;
+static uint32_t rng_state = 0x9E3779B9U;
+
+/**
+  * @brief  Extreme Inputs (swept next to the random ones)
+  */
+static const float extremes[] = {
+	0.0f, -0.0f, 1.0f, -1.0f, FLT_MIN, -FLT_MIN, 1e-45f, -1e-45f, FLT_MAX, -FLT_MAX,
+	INFINITY, -INFINITY, NAN, -NAN, 1e30f, -1e30f, 4294967296.0f, 4294967040.0f
+};
+
+#define EXTREMES_COUNT			(sizeof(extremes) / sizeof(extremes[0]))
+
+
+static void check(bool cond, const char *what, int line) {
+	checks++;
+
+	if (!cond) {
+		failures++;
+		fprintf(stderr, "unit_main.c:%d: check failed: %s\n", line, what);
+	}
+}
+
+/**
+  * @brief xorshift32 (fixed seed: failures reproduce)
+  */
+static uint32_t rng(void) {
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return rng_state;
+}
+
+/**
+  * @brief helper function to get a uniform float in [lo, hi]
+  */
+static float rng_range(float lo, float hi) {
+	return lo + (hi - lo) * ((float) (rng() >> 8) / (float) (1U << 24));
+}
+
+/**
+  * @brief helper function to get a hostile float: a random bit pattern, an
+  * 	   extreme or a plain value, in about equal parts
+  */
+static float rng_hostile(float plain) {
+	uint32_t bits;
+	float val;
+
+	switch (rng() % 3U) {
+	case 0U:
+		bits = rng();
+		memcpy(&val, &bits, sizeof(val));
+		return val;
+	case 1U:
+		return extremes[rng() % EXTREMES_COUNT];
+	default:
+		return rng_range(-plain, plain);
+	}
+}
+
+/**
+  * @brief common/maths.h helpers
+  */
+static void run_maths_checks(void) {
+	bool clamps = true, ranges = true, maps = true;
+
+	for (uint32_t i = 0; i < SWEEP_SAMPLES; ++i) {
+		float lo = rng_range(-1e6f, 1e6f), hi = lo + rng_range(0.0f, 1e6f);
+		float val = rng_hostile(2e6f);
+		float out = constrainf(val, lo, hi);
+		uint32_t ulo = rng() >> 1, uhi = ulo + (rng() >> 1), uval = rng();
+		uint32_t uout = constrain_u32(uval, ulo, uhi);
+
+		if (isnan(val))
+			clamps &= isnan(out);		// passes NaN: callers guard it
+		else
+			clamps &= inrangef(out, lo, hi) && ((out == val) == inrangef(val, lo, hi));
+
+		clamps &= inrange_u32(uout, ulo, uhi) && ((uout == uval) == inrange_u32(uval, ulo, uhi));
+
+		ranges &= (inrangef(val, lo, hi) == ((val >= lo) && (val <= hi)));
+
+		/* map: the ends land on the ends, anything between in between */
+		val = rng_range(lo, hi);
+		if (hi - lo > 1.0f) {
+			out = mapf(val, lo, hi, -100.0f, 100.0f);
+			maps &= (fabsf(mapf(lo, lo, hi, -100.0f, 100.0f) + 100.0f) <= 1e-3f) &&
+					(fabsf(mapf(hi, lo, hi, -100.0f, 100.0f) - 100.0f) <= 1e-3f) &&
+					(out >= -100.001f) && (out <= 100.001f);
+		}
+	}
+
+	CHECK(clamps);
+	CHECK(ranges);
+	CHECK(maps);
+
+	/* Extremes */
+	CHECK(constrainf(INFINITY, -1.0f, 1.0f) == 1.0f);
+	CHECK(constrainf(-INFINITY, -1.0f, 1.0f) == -1.0f);
+	CHECK(constrainf(FLT_MAX, -FLT_MAX, FLT_MAX) == FLT_MAX);
+	CHECK(!inrangef(NAN, -FLT_MAX, FLT_MAX) && !inrangef(INFINITY, -FLT_MAX, FLT_MAX));
+
+	/* The u32 clamp keeps every value exact (a float return rounds above 2^24) */
+	CHECK(constrain_u32(UINT32_MAX, 0U, UINT32_MAX) == UINT32_MAX);
+	CHECK(constrain_u32(16777217U, 0U, UINT32_MAX) == 16777217U);
+	CHECK((constrain_u32(0U, 1U, 2U) == 1U) && (constrain_u32(3U, 1U, 2U) == 2U));
+
+	CHECK((signumf(NAN) == 0) && (signumf(-0.0f) == 0) && (signumf(-FLT_MIN) == -1) && (signumf(INFINITY) == 1));
+	CHECK((SIGN(-3) == -1) && (SIGN(0.0f) == 0) && (SIGN(NAN) == 0) && (SIGN(1e-45f) == 1));
+	CHECK((MIN(-2, 3) == -2) && (MAX(-2, 3) == 3) && (ABS(-FLT_MAX) == FLT_MAX) && (ABS(INT32_MIN + 1) == INT32_MAX));
+
+	{
+		const float same[5] = {7.5f, 7.5f, 7.5f, 7.5f, 7.5f};
+		const float big[2] = {FLT_MAX, -FLT_MAX};
+
+		CHECK((avgf(same, 5U) == 7.5f) && (avgf(big, 2U) == 0.0f));
+	}
+
+	CHECK(all_equal_u32(5U, 5U, 5U, 5U) && !all_equal_u32(5U, 5U, 5U, 6U) && !all_equal_u32(0U, 5U, 5U, 5U));
+}
+
+/**
+  * @brief helper function to check a controller's state is bounded
+  */
+static bool pid_bounded(const pid_ctrl_t *pid, float out) {
+	return isfinite(out) && (fabsf(out) <= pid->limit) && !isnan(pid->out) &&
+		   isfinite(pid->integrator) && (fabsf(pid->integrator) <= pid->integrator_limit) &&
+		   isfinite(pid->differentiator) && isfinite(pid->prev_error) && isfinite(pid->prev_measurement);
+}
+
+/**
+  * @brief flight/pid.c
+  */
+static void run_pid_checks(void) {
+	const pid_config_t nominal = {.Kp = 2.0f, .Ki = 5.0f, .Kd = 0.05f, .Wc = 40.0f, .limit = 300.0f, .integrator_limit = 30.0f};
+	pid_ctrl_t pid, twin, ref;
+	bool bounded = true, held = true, same = true;
+	float out, twin_out = 0.0f;
+
+	/* Hostile inputs and timesteps: bounded throughout, and a non-finite
+	 * step leaves the state as a twin that never saw it */
+	pid_init(&pid, &nominal);
+	pid_init(&twin, &nominal);
+	for (uint32_t i = 0; i < SWEEP_SAMPLES; ++i) {
+		float sp = rng_hostile(500.0f), meas = rng_hostile(500.0f);
+		float dt = (rng() % 8U) ? PID_DT_S : rng_hostile(0.01f);
+		bool finite_step = isfinite(sp - meas) && isfinite(meas) && (dt > 0.0f) && isfinite(dt);
+
+		ref = pid;
+		out = pid_update(&pid, sp, meas, dt);
+		bounded &= pid_bounded(&pid, out);
+
+		if (finite_step) {
+			twin_out = pid_update(&twin, sp, meas, dt);
+			same &= (out == twin_out) && (memcmp(&pid, &twin, sizeof(pid)) == 0);
+		} else {
+			held &= (memcmp(&pid, &ref, sizeof(pid)) == 0) && (out == constrainf(ref.out, -pid.limit, pid.limit));
+		}
+	}
+
+	CHECK(bounded);
+	CHECK(held);
+	CHECK(same);
+
+	/* Saturating error: pinned at the limit, integrator wound up once at
+	 * most, and the opposite error pins the other limit at once */
+	{
+		float wound;
+		bool pinned = true;
+
+		pid_init(&pid, &nominal);
+		pid_update(&pid, 1e6f, 0.0f, PID_DT_S);
+		wound = pid.integrator;
+
+		for (uint32_t i = 0; i < 10000U; ++i)
+			pinned &= (pid_update(&pid, 1e6f, 0.0f, PID_DT_S) == nominal.limit);
+
+		CHECK(pinned && (pid.integrator == wound));
+		CHECK(pid_update(&pid, -1e6f, 0.0f, PID_DT_S) == -nominal.limit);
+
+		pid_init(&pid, &nominal);
+		pid_update(&pid, FLT_MAX, -FLT_MAX, PID_DT_S);		// error overflows to inf: held
+		CHECK(pid_bounded(&pid, pid.out) && (pid.integrator == 0.0f));
+	}
+
+	/* Bad gains, limits and cutoffs */
+	{
+		const float bad[] = {NAN, INFINITY, -INFINITY, -1.0f, 0.0f, FLT_MAX, -FLT_MAX};
+		bool sane = true;
+
+		for (uint32_t i = 0; i < 2000U; ++i) {
+			pid_config_t cfg = nominal;
+			float *field[] = {&cfg.Kp, &cfg.Ki, &cfg.Kd, &cfg.Wc, &cfg.limit, &cfg.integrator_limit};
+
+			for (uint32_t f = 0; f < 6U; ++f) {
+				if (rng() % 2U)
+					*field[f] = bad[rng() % (sizeof(bad) / sizeof(bad[0]))];
+			}
+
+			pid_init(&pid, &cfg);
+			sane &= isfinite(pid.Kp) && isfinite(pid.Ki) && isfinite(pid.Kd) && isfinite(pid.tau) &&
+					(pid.tau >= 0.0f) && (pid.limit >= 0.0f) && (pid.integrator_limit >= 0.0f);
+
+			for (uint32_t s = 0; s < 50U; ++s) {
+				out = pid_update(&pid, rng_range(-1e6f, 1e6f), rng_range(-1e6f, 1e6f), PID_DT_S);
+				sane &= pid_bounded(&pid, out);
+			}
+		}
+
+		CHECK(sane);
+	}
+
+	/* Resync: no derivative kick and no integrator carried over */
+	{
+		pid_init(&pid, &nominal);
+		for (uint32_t i = 0; i < 1000U; ++i)
+			pid_update(&pid, rng_range(-200.0f, 200.0f), rng_range(-200.0f, 200.0f), PID_DT_S);
+
+		pid_resync(&pid, 50.0f, 20.0f);
+		out = pid_update(&pid, 50.0f, 20.0f, PID_DT_S);
+		CHECK((pid.differentiator == 0.0f) &&
+			  (fabsf(out - nominal.Kp * 30.0f) <= nominal.Ki * 30.0f * PID_DT_S + 1e-3f));
+	}
+
+	/* Reconfigure in flight: state kept, integrator inside the new limit */
+	{
+		pid_config_t tight = nominal;
+
+		pid_init(&pid, &nominal);
+		for (uint32_t i = 0; i < 1000U; ++i)
+			pid_update(&pid, 10.0f, 0.0f, PID_DT_S);
+
+		tight.integrator_limit = 1.0f;
+		ref = pid;
+		pid_configure(&pid, &tight);
+		CHECK((pid.integrator == 1.0f) && (pid.prev_error == ref.prev_error) &&
+			  (pid.differentiator == ref.differentiator));
+	}
+}
+
+/**
+  * @brief helper function to read the compare registers in esc order
+  */
+static void read_ccrs(uint32_t ccr[ESC_COUNT]) {
+	ccr[0] = hal_mock_tim4.CCR4;
+	ccr[1] = hal_mock_tim4.CCR3;
+	ccr[2] = hal_mock_tim8.CCR1;
+	ccr[3] = hal_mock_tim8.CCR2;
+}
+
+/**
+  * @brief helper function to check every compare register holds a value
+  */
+static bool ccrs_equal(uint32_t value) {
+	uint32_t ccr[ESC_COUNT];
+
+	read_ccrs(ccr);
+	return all_equal_u32(ccr[0], ccr[1], ccr[2], ccr[3]) && (ccr[0] == value);
+}
+
+/**
+  * @brief helper function to check the compare registers outside the esc
+  * 	   channels were never written
+  */
+static bool others_untouched(void) {
+	return (hal_mock_tim4.CCR1 == 0U) && (hal_mock_tim4.CCR2 == 0U) &&
+		   (hal_mock_tim8.CCR3 == 0U) && (hal_mock_tim8.CCR4 == 0U);
+}
+
+/**
+  * @brief helper function to init (and start) the esc on fresh timers
+  */
+static esc_status_t esc_bringup(void) {
+	esc_status_t status;
+
+	esc_deinit();
+	hal_mock_reset();
+
+	status = esc_init();
+	if (status != ESC_OK)
+		return status;
+
+	return esc_start();
+}
+
+/**
+  * @brief esc/esc.c on the pwm driver and the mock timers
+  */
+static void run_esc_checks(void) {
+	esc_cmd_props_t props;
+	uint32_t esc_drivers = 0U;
+	bool pwm = false;
+
+	for (uint32_t i = 0; i < driver_count(); ++i) {
+		const driver_entry_t *entry = driver_get(i);
+
+		if (entry->cls == DRIVER_CLASS_ESC) {
+			esc_drivers++;
+			pwm |= (strcmp(entry->name, "pwm") == 0);
+		}
+	}
+	CHECK((esc_drivers == 1U) && pwm);
+
+	/* Bring-up: 1..2 ms on a 3 MHz reference, outputs at the minimum */
+	CHECK(esc_bringup() == ESC_OK);
+	esc_get_command_properties(&props);
+	CHECK((props.min == 3000U) && (props.max == 6000U) &&
+		  (props.min < props.idle) && (props.idle <= props.liftoff) && (props.liftoff <= props.limit) &&
+		  (props.limit <= props.max));
+	CHECK(ccrs_equal(props.min) && others_untouched());
+	CHECK((hal_mock_tim(TIM4)->running == 0xCU) && (hal_mock_tim(TIM8)->running == 0x3U));
+
+	CHECK((esc_arm() == ESC_OK) && ccrs_equal(props.idle) && esc_is_armed());
+
+	/* Wiring: each motor on its own channel */
+	{
+		const mtr_cmds_t mcmd = {(float) props.idle, (float) props.idle + 1.0f, (float) props.idle + 2.0f,
+								 (float) props.idle + 3.0f};
+		uint32_t ccr[ESC_COUNT];
+
+		CHECK(esc_set_motor_commands(&mcmd) == ESC_OK);
+		read_ccrs(ccr);
+		CHECK((ccr[0] == props.idle) && (ccr[1] == props.idle + 1U) && (ccr[2] == props.idle + 2U) &&
+			  (ccr[3] == props.idle + 3U) && others_untouched());
+	}
+
+	/* Sanitizing: the extremes on every channel */
+	{
+		const struct { float mtr; bool low; } cases[] = {
+			{(float) props.idle - 1.0f, true}, {0.0f, true}, {-0.0f, true}, {-1.0f, true}, {-FLT_MAX, true},
+			{-INFINITY, true}, {NAN, true}, {-NAN, true}, {1e-45f, true},
+			{(float) props.limit + 1.0f, false}, {FLT_MAX, false}, {INFINITY, false}, {4294967296.0f, false},
+			{4294967040.0f, false}, {1e30f, false}
+		};
+		bool sanitized = true;
+
+		for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+			const mtr_cmds_t mcmd = {cases[i].mtr, cases[i].mtr, cases[i].mtr, cases[i].mtr};
+
+			sanitized &= (esc_set_motor_commands(&mcmd) == ESC_ERROR_WARN) &&
+						 ccrs_equal(cases[i].low ? props.idle : props.limit);
+		}
+
+		CHECK(sanitized);
+	}
+
+	/* Random and hostile commands: registers inside idle..limit, exact when
+	 * the command was, and a warning exactly when one was not */
+	{
+		bool inside = true, exact = true, warned = true;
+
+		for (uint32_t i = 0; i < SWEEP_SAMPLES; ++i) {
+			mtr_cmds_t mcmd;
+			float *mtr[ESC_COUNT] = {&mcmd.mtr1, &mcmd.mtr2, &mcmd.mtr3, &mcmd.mtr4};
+			uint32_t ccr[ESC_COUNT];
+			bool in_range = true;
+			esc_status_t status;
+
+			for (uint32_t m = 0; m < ESC_COUNT; ++m) {
+				*mtr[m] = (rng() % 2U) ? rng_range((float) props.idle, (float) props.limit) : rng_hostile(1e4f);
+				in_range &= inrangef(floorf(*mtr[m]), (float) props.idle, (float) props.limit);
+			}
+
+			status = esc_set_motor_commands(&mcmd);
+			read_ccrs(ccr);
+
+			for (uint32_t m = 0; m < ESC_COUNT; ++m) {
+				inside &= inrange_u32(ccr[m], props.idle, props.limit);
+				if (inrangef(floorf(*mtr[m]), (float) props.idle, (float) props.limit))
+					exact &= (ccr[m] == (uint32_t) *mtr[m]);
+			}
+			warned &= ((status == ESC_OK) == in_range) && (status != ESC_ERROR_FATAL);
+		}
+
+		CHECK(inside);
+		CHECK(exact);
+		CHECK(warned && others_untouched());
+	}
+
+	CHECK((esc_disarm() == ESC_OK) && ccrs_equal(props.min) && !esc_is_armed());
+	CHECK((esc_stop() == ESC_OK) && (hal_mock_tim(TIM4)->running == 0U) && (hal_mock_tim(TIM8)->running == 0U));
+
+	/* Timers init refuses: mismatched periods, clocks, a clock off whole
+	 * MHz, and a period too short for the longest valid pulse */
+	esc_deinit();
+	hal_mock_reset();
+	htim8.Init.Period = HAL_MOCK_TIM_PERIOD - 1U;
+	CHECK(esc_init() == ESC_ERROR_FATAL);
+
+	esc_deinit();
+	hal_mock_reset();
+	hal_mock_tim(TIM4)->clock_hz = 2 * HAL_MOCK_TIM_CLOCK_HZ;
+	CHECK(esc_init() == ESC_ERROR_FATAL);
+
+	esc_deinit();
+	hal_mock_reset();
+	hal_mock_tim(TIM4)->clock_hz = 3500000U;
+	hal_mock_tim(TIM8)->clock_hz = 3500000U;
+	CHECK(esc_init() == ESC_ERROR_FATAL);
+
+	esc_deinit();
+	hal_mock_reset();
+	hal_mock_tim(TIM4)->clock_hz = 0U;
+	hal_mock_tim(TIM8)->clock_hz = 0U;
+	CHECK(esc_init() == ESC_ERROR_FATAL);
+
+	esc_deinit();
+	hal_mock_reset();
+	htim4.Init.Period = 5000U;		// 600 Hz: 1.67 ms frame
+	htim8.Init.Period = 5000U;
+	CHECK(esc_init() == ESC_ERROR_FATAL);
+
+	/* Start refuses a channel that fails to start */
+	esc_deinit();
+	hal_mock_reset();
+	hal_mock_tim(TIM8)->start_status = HAL_ERROR;
+	CHECK((esc_init() == ESC_OK) && (esc_start() == ESC_ERROR_FATAL));
+
+	/* Left up for the mixer and the chain */
+	CHECK(esc_bringup() == ESC_OK);
+	esc_arm();
+}
+
+/**
+  * @brief flight/mixer.c (on the esc brought up above)
+  */
+static void run_mixer_checks(void) {
+	esc_cmd_props_t props;
+	float spans, ceiling;
+	bool split = true, under_limit = true;
+	mtr_cmds_t mcmd;
+	attitude_cmd_t acmd = {0};
+
+	mixer_init();
+	esc_get_command_properties(&props);
+	spans = map_pct_to_mtr_span(params_get_float(PARAM_ROLL_RATE_CMD_LIM)) +
+			map_pct_to_mtr_span(params_get_float(PARAM_PITCH_RATE_CMD_LIM)) +
+			map_pct_to_mtr_span(params_get_float(PARAM_YAW_RATE_CMD_LIM));
+	ceiling = (float) props.limit - spans;
+
+	mixer_update(&mcmd, &acmd, THROTTLE_MIN_PCT);
+	CHECK((mcmd.mtr1 == (float) props.idle) && (mcmd.mtr2 == (float) props.idle) &&
+		  (mcmd.mtr3 == (float) props.idle) && (mcmd.mtr4 == (float) props.idle));
+
+	mixer_update(&mcmd, &acmd, THROTTLE_MAX_PCT);
+	CHECK((mcmd.mtr1 == ceiling) && (mcmd.mtr2 == ceiling) && (mcmd.mtr3 == ceiling) && (mcmd.mtr4 == ceiling));
+
+	for (uint32_t i = 0; i < SWEEP_SAMPLES; ++i) {
+		float throttle = rng_range(THROTTLE_MIN_PCT, THROTTLE_MAX_PCT);
+		float expect = mapf(throttle, THROTTLE_MIN_PCT, THROTTLE_MAX_PCT, (float) props.idle, ceiling);
+		float tol = 1e-3f;
+
+		acmd.roll = rng_range(-1.0f, 1.0f) * map_pct_to_mtr_span(params_get_float(PARAM_ROLL_RATE_CMD_LIM));
+		acmd.pitch = rng_range(-1.0f, 1.0f) * map_pct_to_mtr_span(params_get_float(PARAM_PITCH_RATE_CMD_LIM));
+		acmd.yaw = rng_range(-1.0f, 1.0f) * map_pct_to_mtr_span(params_get_float(PARAM_YAW_RATE_CMD_LIM));
+		mixer_update(&mcmd, &acmd, throttle);
+
+		/* FL, RL, FR, RR (see mixer_update) */
+		split &= (fabsf((mcmd.mtr1 + mcmd.mtr2 + mcmd.mtr3 + mcmd.mtr4) / 4.0f - expect) <= tol) &&
+				 (fabsf((mcmd.mtr1 + mcmd.mtr2 - mcmd.mtr3 - mcmd.mtr4) / 4.0f - acmd.roll) <= tol) &&
+				 (fabsf((-mcmd.mtr1 + mcmd.mtr2 - mcmd.mtr3 + mcmd.mtr4) / 4.0f - acmd.pitch) <= tol) &&
+				 (fabsf((mcmd.mtr1 - mcmd.mtr2 - mcmd.mtr3 + mcmd.mtr4) / 4.0f - acmd.yaw) <= tol);
+
+		under_limit &= (mcmd.mtr1 <= (float) props.limit + tol) && (mcmd.mtr2 <= (float) props.limit + tol) &&
+					   (mcmd.mtr3 <= (float) props.limit + tol) && (mcmd.mtr4 <= (float) props.limit + tol);
+	}
+
+	CHECK(split);
+	CHECK(under_limit);
+
+	/* A non-finite throttle reaches the esc as NaN and stops at idle there */
+	mixer_update(&mcmd, &(attitude_cmd_t){0}, NAN);
+	CHECK(isnan(mcmd.mtr1) && (esc_set_motor_commands(&mcmd) == ESC_ERROR_WARN) && ccrs_equal(props.idle));
+}
+
+/**
+  * @brief the chain: rate pids (configured as attitude.c does) -> mixer -> esc
+  */
+static void run_chain_checks(void) {
+	static const param_id_t params_of[3][6] = {
+		{PARAM_ROLL_RATE_P, PARAM_ROLL_RATE_I, PARAM_ROLL_RATE_D, PARAM_ROLL_RATE_D_LPF_HZ,
+		 PARAM_ROLL_RATE_CMD_LIM, PARAM_ROLL_RATE_I_CMD_LIM},
+		{PARAM_PITCH_RATE_P, PARAM_PITCH_RATE_I, PARAM_PITCH_RATE_D, PARAM_PITCH_RATE_D_LPF_HZ,
+		 PARAM_PITCH_RATE_CMD_LIM, PARAM_PITCH_RATE_I_CMD_LIM},
+		{PARAM_YAW_RATE_P, PARAM_YAW_RATE_I, PARAM_YAW_RATE_D, PARAM_YAW_RATE_D_LPF_HZ,
+		 PARAM_YAW_RATE_CMD_LIM, PARAM_YAW_RATE_I_CMD_LIM}
+	};
+	esc_cmd_props_t props;
+	pid_ctrl_t rate[3];
+	bool inside = true, never_fatal = true;
+
+	esc_get_command_properties(&props);
+
+	for (uint32_t a = 0; a < 3U; ++a) {
+		const pid_config_t cfg = {
+			.Kp = params_get_float(params_of[a][0]),
+			.Ki = params_get_float(params_of[a][1]),
+			.Kd = params_get_float(params_of[a][2]),
+			.Wc = params_get_float(params_of[a][3]),
+			.limit = map_pct_to_mtr_span(params_get_float(params_of[a][4])),
+			.integrator_limit = map_pct_to_mtr_span(params_get_float(params_of[a][5]))
+		};
+
+		pid_init(&rate[a], &cfg);
+	}
+
+	for (uint32_t i = 0; i < SWEEP_SAMPLES; ++i) {
+		attitude_cmd_t acmd;
+		mtr_cmds_t mcmd;
+		uint32_t ccr[ESC_COUNT];
+
+		acmd.roll = pid_update(&rate[0], rng_hostile(2000.0f), rng_hostile(2000.0f), PID_DT_S);
+		acmd.pitch = pid_update(&rate[1], rng_hostile(2000.0f), rng_hostile(2000.0f), PID_DT_S);
+		acmd.yaw = pid_update(&rate[2], rng_hostile(2000.0f), rng_hostile(2000.0f), PID_DT_S);
+		mixer_update(&mcmd, &acmd, (rng() % 16U) ? rng_range(THROTTLE_MIN_PCT, THROTTLE_MAX_PCT) : rng_hostile(100.0f));
+
+		never_fatal &= (esc_set_motor_commands(&mcmd) != ESC_ERROR_FATAL);
+		read_ccrs(ccr);
+		for (uint32_t m = 0; m < ESC_COUNT; ++m)
+			inside &= inrange_u32(ccr[m], props.idle, props.limit);
+	}
+
+	CHECK(inside && never_fatal);
+}
+
+/**
+  * @brief helper function to draw a pulse width (mostly around the valid
+  * 	   range, sometimes anywhere)
+  */
+static uint32_t rng_pulse(void) {
+	static const uint32_t edges[] = {
+		0U, 1U, PWM_PULSE_VALID_MIN_US - 1U, PWM_PULSE_VALID_MIN_US, PWM_PULSE_VALID_MAX_US,
+		PWM_PULSE_VALID_MAX_US + 1U, 0x7FFFFFFFU, 0xFFFFFFFFU
+	};
+
+	switch (rng() % 8U) {
+		case 0U: return edges[rng() % (sizeof(edges) / sizeof(edges[0]))];
+		case 1U: return rng();
+		default: return 800U + rng() % 1400U;
+	}
+}
+
+/**
+  * @brief helper function to get what a channel maps to: the stick at
+  * 	   neutral (throttle low) for an invalid pulse, else the pulse clamped to
+  * 	   the span, as a -1..1 stick (0..1 throttle)
+  */
+static float expected_stick(uint32_t pulse, bool throttle, uint32_t min_us, uint32_t max_us) {
+	if (!inrange_u32(pulse, PWM_PULSE_VALID_MIN_US, PWM_PULSE_VALID_MAX_US))
+		return 0.0f;
+
+	pulse = constrain_u32(pulse, min_us, max_us);
+	return throttle ? ((float) (pulse - min_us) / (float) (max_us - min_us))
+					: mapf((float) pulse, (float) min_us, (float) max_us, -1.0f, 1.0f);
+}
+
+/**
+  * @brief flight/rc_input.c on the sim rx (pulses in on aetr, levels on arm / mode)
+  */
+static void run_rc_checks(void) {
+	const float roll_deg = params_get_float(PARAM_RC_ROLL_MAX_DEG);
+	const float roll_dps = params_get_float(PARAM_RC_ROLL_MAX_DPS);
+	const float pitch_deg = params_get_float(PARAM_RC_PITCH_MAX_DEG);
+	const float pitch_dps = params_get_float(PARAM_RC_PITCH_MAX_DPS);
+	const float yaw_dps = params_get_float(PARAM_RC_YAW_MAX_DPS);
+	const uint32_t min_us = params_get_u32(PARAM_RC_PULSE_MIN_US);
+	const uint32_t max_us = params_get_u32(PARAM_RC_PULSE_MAX_US);
+	const float tol = 1e-3f;
+	bool bounded = true, mapped = true, rejected = true;
+	rc_reqs_t req;
+
+	CHECK((rx_init() == RX_OK) && (rx_start() == RX_OK) && (rc_init() == RC_REQ_OK));
+
+	for (uint32_t i = 0; i < SWEEP_SAMPLES; ++i) {
+		uint32_t pulse[4];
+		bool invalid = false;
+		rc_req_status_t status;
+
+		for (uint8_t ch = 0; ch < 4U; ++ch) {
+			pulse[ch] = rng_pulse();
+			sim_rx_set_channel(ch + 1U, pulse[ch]);
+			invalid |= !inrange_u32(pulse[ch], PWM_PULSE_VALID_MIN_US, PWM_PULSE_VALID_MAX_US);
+		}
+		status = rc_get_requests(&req);
+
+		/* Inside the limits, whatever came in (aetr: roll, pitch, throttle, yaw) */
+		bounded &= (fabsf(req.roll_angle) <= roll_deg) && (fabsf(req.roll_rate) <= roll_dps) &&
+				   (fabsf(req.pitch_angle) <= pitch_deg) && (fabsf(req.pitch_rate) <= pitch_dps) &&
+				   (fabsf(req.yaw_rate) <= yaw_dps) &&
+				   (req.throttle >= THROTTLE_MIN_PCT) && (req.throttle <= THROTTLE_MAX_PCT);
+
+		/* Rejected (neutral, with a warning) or clamped to the span */
+		rejected &= ((status == RC_REQ_ERROR_WARN) == invalid);
+		mapped &= (fabsf(req.roll_angle - roll_deg * expected_stick(pulse[0], false, min_us, max_us)) <= tol * roll_deg) &&
+				  (fabsf(req.roll_rate - roll_dps * expected_stick(pulse[0], false, min_us, max_us)) <= tol * roll_dps) &&
+				  (fabsf(req.pitch_angle - pitch_deg * expected_stick(pulse[1], false, min_us, max_us)) <= tol * pitch_deg) &&
+				  (fabsf(req.throttle - THROTTLE_MAX_PCT * expected_stick(pulse[2], true, min_us, max_us)) <= tol * THROTTLE_MAX_PCT) &&
+				  (fabsf(req.yaw_rate - yaw_dps * expected_stick(pulse[3], false, min_us, max_us)) <= tol * yaw_dps);
+	}
+
+	CHECK(bounded);
+	CHECK(rejected);
+	CHECK(mapped);
+
+	/* A narrower span applies at once (its change listener) */
+	CHECK(params_set(PARAM_RC_PULSE_MIN_US, 1100.0f) == PARAM_OK);
+	sim_rx_set_channel(1U, 1050U);
+	sim_rx_set_channel(2U, 1500U);
+	sim_rx_set_channel(3U, 1050U);
+	sim_rx_set_channel(4U, 1500U);
+	CHECK((rc_get_requests(&req) == RC_REQ_OK) && (req.roll_angle == -roll_deg) && (req.throttle == THROTTLE_MIN_PCT));
+	CHECK(rc_is_throttle_idle(req.throttle));
+	CHECK(params_set(PARAM_RC_PULSE_MIN_US, (float) min_us) == PARAM_OK);
+
+	/* The mode switch: low angle, high the configured mode, anything else invalid */
+	for (uint32_t high = RATE_MODE; high <= ALT_HOLD_MODE; ++high) {
+		bool switched = true;
+
+		CHECK(params_set(PARAM_RC_MODE_SWITCH_HIGH, (float) high) == PARAM_OK);
+		for (uint32_t level = 0U; level <= 8U; ++level) {
+			mode_status_t expect = (level == 1U) ? ANGLE_MODE : (level == 2U) ? (mode_status_t) high : INVALID_MODE;
+
+			sim_rx_set_channel(6U, (level == 8U) ? 0xFFFFFFFFU : level);
+			switched &= (rc_get_flight_mode() == expect);
+		}
+		CHECK(switched);
+	}
+	CHECK(params_set(PARAM_RC_MODE_SWITCH_HIGH, params_get_def(PARAM_RC_MODE_SWITCH_HIGH)->def) == PARAM_OK);
+
+	/* The arm switch arms only high */
+	sim_rx_set_channel(5U, 2U);
+	CHECK(rc_is_armed());
+	sim_rx_set_channel(5U, 1U);
+	CHECK(!rc_is_armed());
+	sim_rx_set_channel(5U, 3U);
+	CHECK(!rc_is_armed());
+	sim_rx_set_channel(5U, 0U);
+}
+
+/**
+  * @brief sensors/imu/devices/lsm6dsox.c on the mock i2c bus
+  */
+static void run_i2c_checks(void) {
+	hal_mock_i2c_dev_t *imu;
+
+	hal_mock_reset();
+	imu = hal_mock_i2c_attach(LSM6DSOX_I2C_ADD_L);
+	CHECK(imu && (hal_mock_i2c_attach(LSM6DSOX_I2C_ADD_L) == NULL));
+	if (!imu)
+		return;
+
+	imu->regs[LSM6DSOX_WHO_AM_I] = LSM6DSOX_ID;
+	imu->self_clearing[LSM6DSOX_CTRL3_C] = 0x01U;		// SW_RESET
+
+	lsm6dsox_set_platform(LSM6DSOX_PRIMARY, &hi2c1, LSM6DSOX_I2C_ADD_L);
+	lsm6dsox_set_platform(LSM6DSOX_SECONDARY, &hi2c1, LSM6DSOX_I2C_ADD_H);
+	CHECK(lsm6dsox_set_loop_rate(CONFIG_IMU_LOOP_RATE_HZ) == IMU_OK);
+
+	/* Init reads the id and configures the sensor over the bus */
+	CHECK(lsm6dsox_driver.init() == IMU_OK);
+	CHECK((imu->reads > 0U) && (imu->writes > 0U));
+	CHECK((imu->regs[LSM6DSOX_CTRL1_XL] >> 4) == ((uint8_t) lsm6dsox_get_config()->odr_xl & 0x0FU));
+	CHECK((imu->regs[LSM6DSOX_CTRL2_G] >> 4) == ((uint8_t) lsm6dsox_get_config()->odr_gy & 0x0FU));
+	CHECK((imu->regs[LSM6DSOX_CTRL3_C] & 0x40U) != 0U);		// BDU
+	CHECK(lsm6dsox_driver.deinit() == IMU_OK);
+
+	/* Nothing at the secondary address, then a wrong id: refused, nothing written */
+	imu->writes = 0U;
+	CHECK(lsm6dsox_secondary_driver.init() == IMU_ERROR_FATAL);
+	imu->regs[LSM6DSOX_WHO_AM_I] = (uint8_t) (LSM6DSOX_ID + 1U);
+	CHECK((lsm6dsox_driver.init() == IMU_ERROR_FATAL) && (imu->writes == 0U));
+
+	lsm6dsox_set_platform(LSM6DSOX_PRIMARY, NULL, LSM6DSOX_I2C_ADD_L);
+	lsm6dsox_set_platform(LSM6DSOX_SECONDARY, NULL, LSM6DSOX_I2C_ADD_H);
+}
+
+int main(int argc, char **argv) {
+	if (argc > 1) {
+		fprintf(stderr, "usage: %s\n", argv[0]);
+		return 2;
+	}
+
+	/* ESC and rate limits from the parameter defaults */
+	ram_param_flash_format();
+	if (params_init() == PARAM_ERROR_FATAL)
+		return 2;
+
+	run_maths_checks();
+	run_pid_checks();
+	run_esc_checks();
+	run_mixer_checks();
+	run_chain_checks();
+	run_rc_checks();
+	run_i2c_checks();
+	printf("{\"mode\": \"checks\", \"checks\": %u, \"failed\": %u}\n", checks, failures);
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+#
+# bench_compare.py
+#
+#  Created on: Oct 18, 2026
+#      Author: charlieroman
+#
+# Compares two kernel benchmark results (JSON lines from Sim/build/aqc_bench,
+# host runs or target results converted with -r) and flags regressions of the
+# best-batch cycles per call beyond a tolerance.
+#
+#   Sim/build/aqc_bench -o before.jsonl      # on the base commit
+#   Sim/build/aqc_bench -o after.jsonl       # on the change
+#   Tools/bench_compare.py before.jsonl after.jsonl [-t 5]
+#
+# Exit status is 1 if any kernel got slower than the tolerance (percent).
+#
+
+import json
+import sys
+
+METRIC = 'cycles_per_call_min'	# best batch: least disturbed by interrupts / scheduling
+
+
+def load(path):
+    """returns {(kernel, platform): result}"""
+    results = {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line:
+                r = json.loads(line)
+                results[(r['kernel'], r['platform'])] = r
+    return results
+
+
+def main(argv):
+    args = list(argv[1:])
+    tolerance = 5.0
+
+    if '-t' in args:
+        i = args.index('-t')
+        tolerance = float(args[i + 1])
+        del args[i:i + 2]
+
+    if len(args) != 2:
+        sys.stderr.write('usage: %s before.jsonl after.jsonl [-t percent]\n' % argv[0])
+        return 2
+
+    before, after = load(args[0]), load(args[1])
+    regressed = False
+
+    print('%-28s %-9s %12s %12s %8s' % ('kernel', 'platform', 'before', 'after', 'change'))
+    for key in sorted(set(before) | set(after)):
+        if key not in before or key not in after:
+            print('%-28s %-9s %s' % (key[0], key[1], 'only in ' + (args[0] if key in before else args[1])))
+            continue
+
+        a, b = before[key][METRIC], after[key][METRIC]
+        change = 100.0 * (b - a) / a if a else 0.0
+        flag = ''
+        if change > tolerance:
+            flag = '  REGRESSION'
+            regressed = True
+
+        print('%-28s %-9s %12.3f %12.3f %+7.1f%%%s' % (key[0], key[1], a, b, change, flag))
+
+    return 1 if regressed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+#
+# blackbox_decode.py
+#
+#  Created on: Oct 18, 2026
+#      Author: charlieroman
+#
+# Decodes a flight log (LOGnnnnn.BIN: log header, blackbox field definitions,
+# frames; see storage/log_file.h and storage/blackbox.h) into CSV, or into
+# columns (one float64 array per field in a numpy .npz, written without numpy:
+# np.load('flight.npz')['gyro_x_mdps']).
+#
+#   Tools/blackbox_decode.py LOG00001.BIN > flight.csv
+#   Tools/blackbox_decode.py LOG00001.BIN -f npz -o flight.npz
+#
+# Values are in the units of the field names (counts times scale). If the
+# rtc was set, a wall_time_s column (unix seconds) is added from the log
+# header's clock offset. Undecodable bytes are skipped up to the next
+# keyframe and reported on stderr.
+#
+
+import struct
+import sys
+import zipfile
+
+LOG_HEADER = struct.Struct('<4sHHIIIIQ')	# log_file_header_t
+LOG_MAGIC = b'AQCL'
+BB_MAGIC = b'AQCB'
+BB_VERSION = 1
+FRAME_I, FRAME_P = ord('I'), ord('P')
+PREDICT_LINEAR = 1
+TYPE_UNSIGNED = 1
+MASK32 = 0xFFFFFFFF
+
+
+def parse_definitions(buf, pos):
+    """returns (fields, keyframe interval, position after the definitions)"""
+    if buf[pos:pos + 4] != BB_MAGIC or buf[pos + 4] != BB_VERSION:
+        raise ValueError('no blackbox definitions at offset %d' % pos)
+
+    count = buf[pos + 5]
+    interval = struct.unpack_from('<H', buf, pos + 6)[0]
+    pos += 8
+
+    fields = []
+    for _ in range(count):
+        predictor, ftype = buf[pos], buf[pos + 1]
+        scale = struct.unpack_from('<f', buf, pos + 2)[0]
+        end = buf.index(0, pos + 6)
+        fields.append({'name': buf[pos + 6:end].decode(), 'predictor': predictor, 'type': ftype, 'scale': scale})
+        pos = end + 1
+
+    return fields, interval, pos
+
+
+class Decoder:
+    def __init__(self, fields):
+        self.fields = fields
+        self.prev = [0] * len(fields)
+        self.prev2 = [0] * len(fields)
+        self.since_key = None		# None: waiting for a keyframe
+
+    def frame(self, buf, pos):
+        """decodes the frame at pos; returns (counts, next position), raises on malformed data"""
+        marker = buf[pos]
+        if marker == FRAME_I:
+            since_key = 0
+        elif marker == FRAME_P and self.since_key is not None:
+            since_key = self.since_key
+        else:
+            raise ValueError('no frame at offset %d' % pos)
+        pos += 1
+
+        counts = []
+        for i, f in enumerate(self.fields):
+            z, shift = 0, 0
+            while True:
+                b = buf[pos]
+                pos += 1
+                z |= (b & 0x7F) << shift
+                if not b & 0x80:
+                    break
+                shift += 7
+                if shift > 28:
+                    raise ValueError('varint too long at offset %d' % pos)
+
+            if since_key == 0:
+                pred = 0
+            elif f['predictor'] == PREDICT_LINEAR and since_key > 1:
+                pred = 2 * self.prev[i] - self.prev2[i]
+            else:
+                pred = self.prev[i]
+
+            counts.append((pred + ((z >> 1) ^ -(z & 1))) & MASK32)
+
+        # Commit only whole frames
+        for i, c in enumerate(counts):
+            self.prev2[i] = self.prev[i]
+            self.prev[i] = c
+        self.since_key = since_key + 1
+        return counts, pos
+
+
+def decode(buf):
+    """returns (column names, rows, skipped bytes)"""
+    pos, wall = 0, None
+    if buf[:4] == LOG_MAGIC:
+        _, _, header_size, _, _, unix_s, unix_us, clock_us = LOG_HEADER.unpack_from(buf)
+        pos = header_size
+        if unix_s:
+            wall = (unix_s + unix_us / 1e6, clock_us & MASK32)
+
+    fields, _, pos = parse_definitions(buf, pos)
+    dec = Decoder(fields)
+    time_idx = next((i for i, f in enumerate(fields) if f['name'] == 'time_us'), None)
+    names = [f['name'] for f in fields] + (['wall_time_s'] if wall and time_idx is not None else [])
+
+    rows, skipped = [], 0
+    while pos < len(buf):
+        try:
+            counts, pos = dec.frame(buf, pos)
+        except (ValueError, IndexError):
+            # Resync on the next keyframe
+            dec.since_key = None
+            pos += 1
+            skipped += 1
+            continue
+
+        row = []
+        for c, f in zip(counts, fields):
+            if f['type'] != TYPE_UNSIGNED and c & 0x80000000:
+                c -= 1 << 32
+            row.append(c * f['scale'] if f['scale'] != 1.0 else c)
+        if len(names) > len(fields):
+            row.append(wall[0] + ((counts[time_idx] - wall[1]) & MASK32) / 1e6)
+        rows.append(row)
+
+    return names, rows, skipped
+
+
+def write_npz(path, names, rows):
+    """one .npy member (little endian float64 vector) per column"""
+    with zipfile.ZipFile(path, 'w', zipfile.ZIP_DEFLATED) as z:
+        for i, name in enumerate(names):
+            header = "{'descr': '<f8', 'fortran_order': False, 'shape': (%d,), }" % len(rows)
+            header += ' ' * (63 - (10 + len(header)) % 64) + '\n'		# data 64-byte aligned
+            data = struct.pack('<%dd' % len(rows), *(float(r[i]) for r in rows))
+            z.writestr(name + '.npy', b'\x93NUMPY\x01\x00' + struct.pack('<H', len(header)) + header.encode() + data)
+
+
+def main(argv):
+    args = list(argv[1:])
+    fmt, out_path = 'csv', None
+
+    for opt in ('-f', '-o'):
+        if opt in args:
+            i = args.index(opt)
+            if opt == '-f':
+                fmt = args[i + 1]
+            else:
+                out_path = args[i + 1]
+            del args[i:i + 2]
+
+    if len(args) != 1 or fmt not in ('csv', 'npz') or (fmt == 'npz' and not out_path):
+        sys.stderr.write('usage: %s LOG.BIN [-f csv|npz] [-o out]\n' % argv[0])
+        return 2
+
+    with open(args[0], 'rb') as f:
+        names, rows, skipped = decode(f.read())
+
+    if skipped:
+        sys.stderr.write('%s: skipped %d undecodable bytes\n' % (args[0], skipped))
+
+    if fmt == 'npz':
+        write_npz(out_path, names, rows)
+    else:
+        out = open(out_path, 'w') if out_path else sys.stdout
+        fmts = ['%.6f' if n == 'wall_time_s' else '%.6g' for n in names]
+        out.write(','.join(names) + '\n')
+        for r in rows:
+            out.write(','.join((f % v) if isinstance(v, float) else str(v) for f, v in zip(fmts, r)) + '\n')
+        if out_path:
+            out.close()
+
+    sys.stderr.write('%s: %d frames, %d fields\n' % (args[0], len(rows), len(names)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+#
+# log_index.py
+#
+#  Created on: Oct 18, 2026
+#      Author: charlieroman
+#
+# Lists flight logs (LOGnnnnn.BIN, storage/log_file.h) by their headers in
+# flight order: by boot id, then microsecond clock. Both are monotonic, so the
+# order holds whether or not the rtc was set; wall time is shown where it was.
+#
+#   Tools/log_index.py /media/sdcard/LOG*.BIN
+#
+# The clock offset maps a record's micros() timestamp to wall time:
+#   wall_us = unix_s * 1000000 + unix_us + (t_us - clock_us)
+#
+
+import datetime
+import struct
+import sys
+
+HEADER = struct.Struct('<4sHHIIIIQ')	# log_file_header_t
+MAGIC = b'AQCL'
+
+
+def read_header(path):
+    """returns the header fields as a dict, or None if not a log"""
+    with open(path, 'rb') as f:
+        raw = f.read(HEADER.size)
+    if len(raw) < HEADER.size:
+        return None
+
+    magic, version, size, index, boot_id, unix_s, unix_us, clock_us = HEADER.unpack(raw)
+    if magic != MAGIC:
+        return None
+
+    return {'path': path, 'version': version, 'header_size': size, 'index': index, 'boot_id': boot_id,
+            'unix_s': unix_s, 'unix_us': unix_us, 'clock_us': clock_us}
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write('usage: %s LOGnnnnn.BIN ...\n' % argv[0])
+        return 2
+
+    headers = []
+    for path in argv[1:]:
+        h = read_header(path)
+        if h is None:
+            sys.stderr.write('%s: not a flight log\n' % path)
+            continue
+        headers.append(h)
+
+    print('%-24s %6s %8s %-27s %16s' % ('file', 'index', 'boot', 'wall time (utc)', 'clock_us'))
+    for h in sorted(headers, key=lambda h: (h['boot_id'], h['clock_us'])):
+        if h['unix_s']:
+            wall = datetime.datetime.fromtimestamp(h['unix_s'] + h['unix_us'] / 1e6, datetime.timezone.utc)
+            wall = wall.strftime('%Y-%m-%dT%H:%M:%S.%f')[:-3] + 'Z'
+        else:
+            wall = 'not set'
+
+        print('%-24s %6u %8u %-27s %16u' % (h['path'], h['index'], h['boot_id'], wall, h['clock_us']))
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
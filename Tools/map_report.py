@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+#
+# map_report.py
+#
+#  Created on: Oct 18, 2026
+#      Author: charlieroman
+#
+# Summarizes a GNU ld map file (Debug/f405-aqc-1-flight-controller.map):
+# memory region usage and what was placed in CCM RAM (.ccmram / .ccmbss) and
+# SRAM-executed code (.RamFunc), per object file.
+#
+#   Tools/map_report.py Debug/f405-aqc-1-flight-controller.map
+#   Tools/map_report.py before.map after.map     # placement diff
+#
+
+import re
+import sys
+from collections import defaultdict
+
+FAST_SECTIONS = ('.ccmram', '.ccmbss', '.RamFunc')
+OUTPUT_SECTIONS = ('.isr_vector', '.text', '.rodata', '.data', '.ccmram', '.ccmbss', '.bss', '._user_heap_stack')
+
+RE_REGION = re.compile(r'^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+\S+\s*$')
+RE_OUTPUT = re.compile(r'^(\.\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)')
+RE_INPUT = re.compile(r'^ (\.\S+?)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S+)')
+RE_INPUT_NAME = re.compile(r'^ (\.\S+)\s*$')
+RE_INPUT_CONT = re.compile(r'^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S+)')
+
+
+def parse(path):
+    """returns (regions {name: (origin, length)}, outputs {name: (addr, size)},
+    placed {fast section: {object: size}})"""
+    regions, outputs = {}, {}
+    placed = defaultdict(lambda: defaultdict(int))
+    in_regions = in_map = False
+    pending = None
+
+    with open(path, errors='replace') as f:
+        for line in f:
+            line = line.rstrip('\n')
+
+            if line.startswith('Memory Configuration'):
+                in_regions = True
+                continue
+            if line.startswith('Linker script and memory map'):
+                in_regions, in_map = False, True
+                continue
+
+            if in_regions:
+                m = RE_REGION.match(line)
+                if m and m.group(1) != 'Name':
+                    regions[m.group(1)] = (int(m.group(2), 16), int(m.group(3), 16))
+                continue
+
+            if not in_map:
+                continue
+
+            m = RE_OUTPUT.match(line)
+            if m and m.group(1) in OUTPUT_SECTIONS:
+                outputs[m.group(1)] = (int(m.group(2), 16), int(m.group(3), 16))
+                continue
+
+            # input sections: on one line, or the name alone when it is long
+            m = RE_INPUT.match(line)
+            if m:
+                name, size, obj = m.group(1), int(m.group(3), 16), m.group(4)
+            elif RE_INPUT_NAME.match(line):
+                pending = RE_INPUT_NAME.match(line).group(1)
+                continue
+            elif pending and RE_INPUT_CONT.match(line):
+                m = RE_INPUT_CONT.match(line)
+                name, size, obj = pending, int(m.group(2), 16), m.group(3)
+            else:
+                pending = None
+                continue
+
+            pending = None
+            for fast in FAST_SECTIONS:
+                if (name == fast) or name.startswith(fast + '.'):
+                    placed[fast][obj.split('/')[-1]] += size
+
+    return regions, outputs, placed
+
+
+def region_of(regions, addr):
+    for name, (origin, length) in regions.items():
+        if origin <= addr < origin + length:
+            return name
+    return '?'
+
+
+def report(path):
+    regions, outputs, placed = parse(path)
+    used = defaultdict(int)
+
+    for name, (addr, size) in outputs.items():
+        used[region_of(regions, addr)] += size
+
+    # .data (and the .RamFunc code in it) also occupies its load image in FLASH
+    if '.data' in outputs and 'FLASH' in regions:
+        used['FLASH'] += outputs['.data'][1]
+    if '.ccmram' in outputs and 'FLASH' in regions:
+        used['FLASH'] += outputs['.ccmram'][1]
+
+    print('%s' % path)
+    print('  %-8s %10s %10s %6s' % ('region', 'used', 'size', 'use'))
+    for name, (origin, length) in regions.items():
+        if name == '*default*' or length == 0:
+            continue
+        print('  %-8s %10d %10d %5.1f%%' % (name, used[name], length, 100.0 * used[name] / length))
+
+    for fast in FAST_SECTIONS:
+        objs = placed.get(fast, {})
+        print('  %s: %d bytes' % (fast, sum(objs.values())))
+        for obj, size in sorted(objs.items(), key=lambda kv: -kv[1]):
+            print('    %6d  %s' % (size, obj))
+
+    return placed
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write('usage: %s file.map [other.map]\n' % argv[0])
+        return 2
+
+    before = report(argv[1])
+    if len(argv) == 2:
+        return 0
+
+    print()
+    after = report(argv[2])
+    print()
+    print('placement change (%s -> %s)' % (argv[1], argv[2]))
+    for fast in FAST_SECTIONS:
+        objs = set(before.get(fast, {})) | set(after.get(fast, {}))
+        for obj in sorted(objs):
+            a, b = before.get(fast, {}).get(obj, 0), after.get(fast, {}).get(obj, 0)
+            if a != b:
+                print('  %-9s %-32s %6d -> %6d' % (fast, obj, a, b))
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))